@@ -28,6 +28,10 @@ RETRO_BEGIN_DECLS
 
 #define AUDIO_MAX_RATIO                16
 
+/* Frames pushed through the whole flush pipeline at a time,
+ * so each stage works on data the previous one left in cache. */
+#define AUDIO_FLUSH_BLOCK_FRAMES       256
+
 #define AUDIO_MIXER_MAX_STREAMS        16
 
 #define AUDIO_MIXER_MAX_SYSTEM_STREAMS (AUDIO_MIXER_MAX_STREAMS + 8)
@@ -85,6 +89,8 @@ typedef struct audio_statistics
    float std_deviation_percentage;
    float close_to_underrun;
    float close_to_blocking;
+   unsigned underruns;
+   unsigned overruns;
 } audio_statistics_t;
 
 RETRO_END_DECLS
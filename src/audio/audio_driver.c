@@ -76,7 +76,8 @@ audio_driver_t audio_null = {
    NULL,
    NULL,
    NULL, /* write_avail */
-   NULL
+   NULL,
+   NULL  /* xruns */
 };
 
 audio_driver_t *audio_drivers[] = {
@@ -238,6 +239,8 @@ static void report_audio_buffer_statistics(void)
    audio_stats.std_deviation_percentage  = 0.0f;
    audio_stats.close_to_underrun         = 0.0f;
    audio_stats.close_to_blocking         = 0.0f;
+   audio_stats.underruns                 = 0;
+   audio_stats.overruns                  = 0;
 
    if (!audio_compute_buffer_statistics(&audio_stats))
       return;
@@ -245,11 +248,14 @@ static void report_audio_buffer_statistics(void)
    RARCH_LOG("[Audio]: Average audio buffer saturation: %.2f %%,"
          " standard deviation (percentage points): %.2f %%.\n"
          "[Audio]: Amount of time spent close to underrun: %.2f %%."
-         " Close to blocking: %.2f %%.\n",
+         " Close to blocking: %.2f %%.\n"
+         "[Audio]: Underruns: %u. Overruns: %u.\n",
          audio_stats.average_buffer_saturation,
          audio_stats.std_deviation_percentage,
          audio_stats.close_to_underrun,
-         audio_stats.close_to_blocking);
+         audio_stats.close_to_blocking,
+         audio_stats.underruns,
+         audio_stats.overruns);
 }
 #endif
 
@@ -305,6 +311,10 @@ static bool audio_driver_deinit_internal(bool audio_enable)
       memalign_free(audio_st->output_samples_buf);
    audio_st->output_samples_buf = NULL;
 
+   if (audio_st->output_samples_s16_buf)
+      memalign_free(audio_st->output_samples_s16_buf);
+   audio_st->output_samples_s16_buf = NULL;
+
 #ifdef HAVE_DSP_FILTER
    audio_driver_dsp_filter_free();
 #endif
@@ -391,6 +401,11 @@ bool audio_driver_find_driver(
  *
  * Writes audio samples to audio driver. Will first
  * perform DSP processing (if enabled) and resampling.
+ *
+ * The input is pushed through every stage in blocks of
+ * AUDIO_FLUSH_BLOCK_FRAMES, rather than one full pass over
+ * the buffer per stage, and only handed to the driver
+ * once all of it has been processed.
  **/
 static void audio_driver_flush(
       audio_driver_state_t *audio_st,
@@ -400,45 +415,19 @@ static void audio_driver_flush(
       bool is_slowmotion, bool is_fastmotion)
 {
    struct resampler_data src_data;
+   size_t frames                     = samples >> 1;
+   size_t output_frames              = 0;
+   bool use_float                    = (audio_st->flags & AUDIO_FLAG_USE_FLOAT) ? true : false;
+#ifdef HAVE_AUDIOMIXER
+   bool mixer_active                 = (audio_st->flags & AUDIO_FLAG_MIXER_ACTIVE) ? true : false;
+   bool mixer_override               = true;
+   float mixer_gain                  = 0.0f;
+#endif
    float audio_volume_gain           = (audio_st->mute_enable ||
          (audio_fastforward_mute && is_fastmotion))
                ? 0.0f 
                : audio_st->volume_gain;
 
-   src_data.data_out                 = NULL;
-   src_data.output_frames            = 0;
-
-   convert_s16_to_float(audio_st->input_data, data, samples,
-         audio_volume_gain);
-
-   src_data.data_in                  = audio_st->input_data;
-   src_data.input_frames             = samples >> 1;
-
-#ifdef HAVE_DSP_FILTER
-   if (audio_st->dsp)
-   {
-      struct retro_dsp_data dsp_data;
-
-      dsp_data.input                 = NULL;
-      dsp_data.input_frames          = 0;
-      dsp_data.output                = NULL;
-      dsp_data.output_frames         = 0;
-
-      dsp_data.input                 = audio_st->input_data;
-      dsp_data.input_frames          = (unsigned)(samples >> 1);
-
-      retro_dsp_filter_process(audio_st->dsp, &dsp_data);
-
-      if (dsp_data.output)
-      {
-         src_data.data_in            = dsp_data.output;
-         src_data.input_frames       = dsp_data.output_frames;
-      }
-   }
-#endif
-
-   src_data.data_out                 = audio_st->output_samples_buf;
-
    if (audio_st->flags & AUDIO_FLAG_CONTROL)
    {
       /* Readjust the audio input rate. */
@@ -494,46 +483,79 @@ static void audio_driver_flush(
     * trying to do anything. Just leave the ratio as-is,
     * and hope for the best... */
 
-   audio_st->resampler->process(
-         audio_st->resampler_data, &src_data);
-
 #ifdef HAVE_AUDIOMIXER
-   if (audio_st->flags & AUDIO_FLAG_MIXER_ACTIVE)
+   if (mixer_active && !audio_st->mixer_mute_enable)
    {
-      bool override                       = true;
-      float mixer_gain                    = 0.0f;
-      bool audio_driver_mixer_mute_enable = audio_st->mixer_mute_enable;
-
-      if (!audio_driver_mixer_mute_enable)
-      {
-         if (audio_st->mixer_volume_gain == 1.0f)
-            override                      = false;
-         mixer_gain                       = audio_st->mixer_volume_gain;
-            
-      }
-      audio_mixer_mix(audio_st->output_samples_buf,
-            src_data.output_frames, mixer_gain, override);
+      if (audio_st->mixer_volume_gain == 1.0f)
+         mixer_override             = false;
+      mixer_gain                    = audio_st->mixer_volume_gain;
    }
 #endif
 
+   while (frames)
    {
-      const void *output_data = audio_st->output_samples_buf;
-      unsigned output_frames  = (unsigned)src_data.output_frames;
+      size_t block                   = (frames > AUDIO_FLUSH_BLOCK_FRAMES)
+         ? AUDIO_FLUSH_BLOCK_FRAMES
+         : frames;
+      float *block_out               = audio_st->output_samples_buf
+         + (output_frames << 1);
 
-      if (audio_st->flags & AUDIO_FLAG_USE_FLOAT)
-         output_frames       *= sizeof(float);
-      else
+      convert_s16_to_float(audio_st->input_data, data, block << 1,
+            audio_volume_gain);
+
+      src_data.data_in               = audio_st->input_data;
+      src_data.input_frames          = block;
+
+#ifdef HAVE_DSP_FILTER
+      if (audio_st->dsp)
       {
-         convert_float_to_s16(audio_st->output_samples_conv_buf,
-               (const float*)output_data, output_frames * 2);
+         struct retro_dsp_data dsp_data;
 
-         output_data          = audio_st->output_samples_conv_buf;
-         output_frames       *= sizeof(int16_t);
+         dsp_data.input              = audio_st->input_data;
+         dsp_data.input_frames       = (unsigned)block;
+         dsp_data.output             = NULL;
+         dsp_data.output_frames      = 0;
+
+         retro_dsp_filter_process(audio_st->dsp, &dsp_data);
+
+         if (dsp_data.output)
+         {
+            src_data.data_in         = dsp_data.output;
+            src_data.input_frames    = dsp_data.output_frames;
+         }
       }
+#endif
 
-      audio_st->current_audio->write(audio_st->context_audio_data,
-            output_data, output_frames * 2);
+      src_data.data_out              = block_out;
+      src_data.output_frames         = 0;
+
+      audio_st->resampler->process(
+            audio_st->resampler_data, &src_data);
+
+#ifdef HAVE_AUDIOMIXER
+      if (mixer_active)
+         audio_mixer_mix(block_out, src_data.output_frames,
+               mixer_gain, mixer_override);
+#endif
+
+      if (!use_float)
+         convert_float_to_s16(
+               audio_st->output_samples_s16_buf + (output_frames << 1),
+               block_out, src_data.output_frames << 1);
+
+      output_frames                 += src_data.output_frames;
+      data                          += block << 1;
+      frames                        -= block;
    }
+
+   if (use_float)
+      audio_st->current_audio->write(audio_st->context_audio_data,
+            audio_st->output_samples_buf,
+            output_frames * 2 * sizeof(float));
+   else
+      audio_st->current_audio->write(audio_st->context_audio_data,
+            audio_st->output_samples_s16_buf,
+            output_frames * 2 * sizeof(int16_t));
 }
 
 #ifdef HAVE_AUDIOMIXER
@@ -725,6 +747,10 @@ bool audio_driver_init_internal(
    audio_driver_st.output_samples_buf = (float*)samples_buf;
    audio_driver_st.flags             &= ~AUDIO_FLAG_CONTROL;
 
+   if (!(audio_driver_st.output_samples_s16_buf = (int16_t*)
+            memalign_alloc(64, outsamples_max * sizeof(int16_t))))
+      goto error;
+
    if (
             !audio_cb_inited
          && (audio_driver_st.flags & AUDIO_FLAG_ACTIVE)
@@ -1779,6 +1805,14 @@ bool audio_compute_buffer_statistics(audio_statistics_t *stats)
          (unsigned)audio_st->free_samples_count,
          AUDIO_BUFFER_FREE_SAMPLES_COUNT);
 
+   stats->underruns              = 0;
+   stats->overruns               = 0;
+   if (     audio_st->current_audio
+         && audio_st->current_audio->xruns
+         && audio_st->context_audio_data)
+      audio_st->current_audio->xruns(audio_st->context_audio_data,
+            &stats->underruns, &stats->overruns);
+
    if (samples < 3)
       return false;
 
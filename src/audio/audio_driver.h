@@ -156,6 +156,11 @@ typedef struct audio_driver
    size_t (*write_avail)(void *data);
 
    size_t (*buffer_size)(void *data);
+
+   /* Optional. Number of times the device ran dry (underruns)
+    * and of writes that had to drop samples because the buffer
+    * was full (overruns), since init. */
+   void (*xruns)(void *data, unsigned *underruns, unsigned *overruns);
 } audio_driver_t;
 
 enum audio_driver_state_flags
@@ -177,6 +182,9 @@ typedef struct
 
    struct string_list *devices_list;
    float  *output_samples_buf;
+   /* Final s16 output; output_samples_conv_buf cannot be
+    * reused for it, as it also holds the flush input. */
+   int16_t *output_samples_s16_buf;
 #ifdef HAVE_REWIND
    int16_t *rewind_buf;
 #endif
@@ -250,6 +250,17 @@ static ssize_t audio_thread_write(void *data, const void *buf, size_t size)
    return ret;
 }
 
+static void audio_thread_xruns(void *data,
+      unsigned *underruns, unsigned *overruns)
+{
+   audio_thread_t *thr = (audio_thread_t*)data;
+
+   if (!thr || !thr->driver->xruns)
+      return;
+
+   thr->driver->xruns(thr->driver_data, underruns, overruns);
+}
+
 static const audio_driver_t audio_thread = {
    NULL,
    audio_thread_write,
@@ -262,6 +273,9 @@ static const audio_driver_t audio_thread = {
    "audio-thread",
    NULL, /* No point in using rate control with threaded audio. */
    NULL,
+   NULL,
+   NULL,
+   audio_thread_xruns
 };
 
 /**
@@ -29,6 +29,8 @@ typedef struct alsa
    snd_pcm_t *pcm;
    size_t buffer_size;
    unsigned int frame_bits;
+   unsigned underruns;
+   unsigned overruns;
    bool nonblock;
    bool has_float;
    bool can_pause;
@@ -203,13 +205,18 @@ static ssize_t alsa_write(void *data, const void *buf_, size_t size_)
 
          if (frames == -EPIPE || frames == -EINTR || frames == -ESTRPIPE)
          {
+            if (frames == -EPIPE)
+               alsa->underruns++;
             if (snd_pcm_recover(alsa->pcm, frames, 1) < 0)
                return -1;
 
             break;
          }
          else if (frames == -EAGAIN)
+         {
+            alsa->overruns++;
             break;
+         }
          else if (frames < 0)
             return -1;
 
@@ -229,6 +236,8 @@ static ssize_t alsa_write(void *data, const void *buf_, size_t size_)
 
          if (rc == -EPIPE || rc == -ESTRPIPE || rc == -EINTR)
          {
+            if (rc == -EPIPE)
+               alsa->underruns++;
             if (snd_pcm_recover(alsa->pcm, rc, 1) < 0)
                return -1;
             continue;
@@ -238,6 +247,8 @@ static ssize_t alsa_write(void *data, const void *buf_, size_t size_)
 
          if (frames == -EPIPE || frames == -EINTR || frames == -ESTRPIPE)
          {
+            if (frames == -EPIPE)
+               alsa->underruns++;
             if (snd_pcm_recover(alsa->pcm, frames, 1) < 0)
                return -1;
 
@@ -356,6 +367,14 @@ static size_t alsa_buffer_size(void *data)
    return alsa->buffer_size;
 }
 
+static void alsa_xruns(void *data,
+      unsigned *underruns, unsigned *overruns)
+{
+   alsa_t *alsa = (alsa_t*)data;
+   *underruns   = alsa->underruns;
+   *overruns    = alsa->overruns;
+}
+
 static void *alsa_device_list_new(void *data)
 {
    void **hints, **n;
@@ -428,4 +447,5 @@ audio_driver_t audio_alsa = {
    alsa_device_list_free,
    alsa_write_avail,
    alsa_buffer_size,
+   alsa_xruns
 };
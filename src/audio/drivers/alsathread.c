@@ -21,7 +21,7 @@
 #include <alsa/asoundlib.h>
 
 #include <rthreads/rthreads.h>
-#include <queues/fifo_queue.h>
+#include <queues/spsc_queue.h>
 #include <string/stdstring.h>
 
 #include "../audio_driver.h"
@@ -33,14 +33,18 @@
 typedef struct alsa_thread
 {
    snd_pcm_t *pcm;
-   fifo_buffer_t *buffer;
+   spsc_queue_t *buffer;
    sthread_t *worker_thread;
-   slock_t *fifo_lock;
    scond_t *cond;
    slock_t *cond_lock;
    size_t buffer_size;
    size_t period_size;
+   int64_t period_usec;
    snd_pcm_uframes_t period_frames;
+   /* Written by the worker thread only. */
+   unsigned underruns;
+   /* Written by the writer only. */
+   unsigned overruns;
    bool nonblock;
    bool is_paused;
    bool has_float;
@@ -60,24 +64,26 @@ static void alsa_worker_thread(void *data)
 
    while (!alsa->thread_dead)
    {
-      size_t avail;
-      size_t fifo_size;
       snd_pcm_sframes_t frames;
-      slock_lock(alsa->fifo_lock);
-      avail     = FIFO_READ_AVAIL(alsa->buffer);
-      fifo_size = MIN(alsa->period_size, avail);
-      fifo_read(alsa->buffer, buf, fifo_size);
+      size_t fifo_size = spsc_queue_read(alsa->buffer,
+            buf, alsa->period_size);
       scond_signal(alsa->cond);
-      slock_unlock(alsa->fifo_lock);
 
       /* If underrun, fill rest with silence. */
-      memset(buf + fifo_size, 0, alsa->period_size - fifo_size);
+      if (fifo_size < alsa->period_size)
+      {
+         if (!alsa->is_paused)
+            alsa->underruns++;
+         memset(buf + fifo_size, 0, alsa->period_size - fifo_size);
+      }
 
       frames = snd_pcm_writei(alsa->pcm, buf, alsa->period_frames);
 
       if (frames == -EPIPE || frames == -EINTR ||
             frames == -ESTRPIPE)
       {
+         if (frames == -EPIPE)
+            alsa->underruns++;
          if (snd_pcm_recover(alsa->pcm, frames, 1) < 0)
          {
             RARCH_ERR("[ALSA]: (#2) Failed to recover from error (%s)\n",
@@ -135,11 +141,9 @@ static void alsa_thread_free(void *data)
          sthread_join(alsa->worker_thread);
       }
       if (alsa->buffer)
-         fifo_free(alsa->buffer);
+         spsc_queue_free(alsa->buffer);
       if (alsa->cond)
          scond_free(alsa->cond);
-      if (alsa->fifo_lock)
-         slock_free(alsa->fifo_lock);
       if (alsa->cond_lock)
          slock_free(alsa->cond_lock);
       if (alsa->pcm)
@@ -203,6 +207,7 @@ static void *alsa_thread_init(const char *device,
 
    alsa->buffer_size = snd_pcm_frames_to_bytes(alsa->pcm, buffer_size);
    alsa->period_size = snd_pcm_frames_to_bytes(alsa->pcm, alsa->period_frames);
+   alsa->period_usec = (int64_t)alsa->period_frames * 1000000 / rate;
 
    TRY_ALSA(snd_pcm_sw_params_malloc(&sw_params));
    TRY_ALSA(snd_pcm_sw_params_current(alsa->pcm, sw_params));
@@ -213,11 +218,10 @@ static void *alsa_thread_init(const char *device,
    snd_pcm_hw_params_free(params);
    snd_pcm_sw_params_free(sw_params);
 
-   alsa->fifo_lock = slock_new();
    alsa->cond_lock = slock_new();
    alsa->cond = scond_new();
-   alsa->buffer = fifo_new(alsa->buffer_size);
-   if (!alsa->fifo_lock || !alsa->cond_lock || !alsa->cond || !alsa->buffer)
+   alsa->buffer = spsc_queue_new(alsa->buffer_size);
+   if (!alsa->cond_lock || !alsa->cond || !alsa->buffer)
       goto error;
 
    alsa->worker_thread = sthread_create(alsa_worker_thread, alsa);
@@ -251,16 +255,9 @@ static ssize_t alsa_thread_write(void *data, const void *buf, size_t size)
 
    if (alsa->nonblock)
    {
-      size_t avail;
-      size_t write_amt;
-
-      slock_lock(alsa->fifo_lock);
-      avail           = FIFO_WRITE_AVAIL(alsa->buffer);
-      write_amt       = MIN(avail, size);
-
-      fifo_write(alsa->buffer, buf, write_amt);
-      slock_unlock(alsa->fifo_lock);
-
+      size_t write_amt = spsc_queue_write(alsa->buffer, buf, size);
+      if (write_amt < size)
+         alsa->overruns++;
       return write_amt;
    }
    else
@@ -268,26 +265,22 @@ static ssize_t alsa_thread_write(void *data, const void *buf, size_t size)
       size_t written = 0;
       while (written < size && !alsa->thread_dead)
       {
-         size_t avail;
-         slock_lock(alsa->fifo_lock);
-         avail = FIFO_WRITE_AVAIL(alsa->buffer);
+         size_t write_amt = spsc_queue_write(alsa->buffer,
+               (const char*)buf + written, size - written);
 
-         if (avail == 0)
+         if (write_amt == 0)
          {
-            slock_unlock(alsa->fifo_lock);
+            /* The worker signals without taking the lock,
+             * so a wakeup can slip past; never wait longer
+             * than one period for it. */
             slock_lock(alsa->cond_lock);
-            if (!alsa->thread_dead)
-               scond_wait(alsa->cond, alsa->cond_lock);
+            if (     !alsa->thread_dead
+                  && spsc_queue_write_avail(alsa->buffer) == 0)
+               scond_wait_timeout(alsa->cond, alsa->cond_lock,
+                     alsa->period_usec);
             slock_unlock(alsa->cond_lock);
          }
-         else
-         {
-            size_t write_amt = MIN(size - written, avail);
-            fifo_write(alsa->buffer,
-                  (const char*)buf + written, write_amt);
-            slock_unlock(alsa->fifo_lock);
-            written += write_amt;
-         }
+         written += write_amt;
       }
       return written;
    }
@@ -328,14 +321,10 @@ static bool alsa_thread_start(void *data, bool is_shutdown)
 static size_t alsa_thread_write_avail(void *data)
 {
    alsa_thread_t *alsa = (alsa_thread_t*)data;
-   size_t val;
 
    if (alsa->thread_dead)
       return 0;
-   slock_lock(alsa->fifo_lock);
-   val = FIFO_WRITE_AVAIL(alsa->buffer);
-   slock_unlock(alsa->fifo_lock);
-   return val;
+   return spsc_queue_write_avail(alsa->buffer);
 }
 
 static size_t alsa_thread_buffer_size(void *data)
@@ -344,6 +333,14 @@ static size_t alsa_thread_buffer_size(void *data)
    return alsa->buffer_size;
 }
 
+static void alsa_thread_xruns(void *data,
+      unsigned *underruns, unsigned *overruns)
+{
+   alsa_thread_t *alsa = (alsa_thread_t*)data;
+   *underruns          = alsa->underruns;
+   *overruns           = alsa->overruns;
+}
+
 static void *alsa_thread_device_list_new(void *data)
 {
    void **hints, **n;
@@ -416,4 +413,5 @@ audio_driver_t audio_alsathread = {
    alsa_thread_device_list_free,
    alsa_thread_write_avail,
    alsa_thread_buffer_size,
+   alsa_thread_xruns
 };
@@ -32,6 +32,10 @@ typedef struct
    pa_context *context;
    pa_stream *stream;
    size_t buffer_size;
+   /* Written from the mainloop thread only. */
+   unsigned underruns;
+   /* Written by the writer only. */
+   unsigned overruns;
    bool nonblock;
    bool success;
    bool is_paused;
@@ -126,11 +130,12 @@ static void stream_latency_update_cb(pa_stream *s, void *data)
 
 static void underrun_update_cb(pa_stream *s, void *data)
 {
-#if 0
    pa_t *pa = (pa_t*)data;
 
    (void)s;
 
+   pa->underruns++;
+#if 0
    RARCH_LOG("[PulseAudio]: Underrun (Buffer: %u, Writable size: %u).\n",
          (unsigned)pa->buffer_size,
          (unsigned)pa_stream_writable_size(pa->stream));
@@ -265,7 +270,10 @@ static ssize_t pulse_write(void *data, const void *buf_, size_t size)
       else if (!pa->nonblock)
          pa_threaded_mainloop_wait(pa->mainloop);
       else
+      {
+         pa->overruns++;
          break;
+      }
    }
 
    pa_threaded_mainloop_unlock(pa->mainloop);
@@ -352,6 +360,14 @@ static size_t pulse_buffer_size(void *data)
    return pa->buffer_size;
 }
 
+static void pulse_xruns(void *data,
+      unsigned *underruns, unsigned *overruns)
+{
+   pa_t *pa   = (pa_t*)data;
+   *underruns = pa->underruns;
+   *overruns  = pa->overruns;
+}
+
 audio_driver_t audio_pulse = {
    pulse_init,
    pulse_write,
@@ -366,4 +382,5 @@ audio_driver_t audio_pulse = {
    NULL,
    pulse_write_avail,
    pulse_buffer_size,
+   pulse_xruns
 };
@@ -21,7 +21,7 @@
 
 #include <boolean.h>
 #include <rthreads/rthreads.h>
-#include <queues/fifo_queue.h>
+#include <queues/spsc_queue.h>
 #include <retro_inline.h>
 #include <retro_math.h>
 
@@ -37,7 +37,14 @@ typedef struct sdl_audio
    slock_t *lock;
    scond_t *cond;
 #endif
-   fifo_buffer_t *buffer;
+   spsc_queue_t *buffer;
+   /* Written by the SDL callback thread only. */
+   unsigned underruns;
+   /* Written by the writer only. */
+   unsigned overruns;
+   /* Worst-case time the callback takes to drain a
+    * buffer, used to bound lost wakeups in write. */
+   int64_t wait_usec;
    bool nonblock;
    bool is_paused;
 } sdl_audio_t;
@@ -45,16 +52,18 @@ typedef struct sdl_audio
 static void sdl_audio_cb(void *data, Uint8 *stream, int len)
 {
    sdl_audio_t  *sdl = (sdl_audio_t*)data;
-   size_t      avail = FIFO_READ_AVAIL(sdl->buffer);
-   size_t write_size = len > (int)avail ? avail : len;
-
-   fifo_read(sdl->buffer, stream, write_size);
+   size_t write_size = spsc_queue_read(sdl->buffer, stream, len);
 #ifdef HAVE_THREADS
    scond_signal(sdl->cond);
 #endif
 
    /* If underrun, fill rest with silence. */
-   memset(stream + write_size, 0, len - write_size);
+   if (write_size < (size_t)len)
+   {
+      if (!sdl->is_paused)
+         sdl->underruns++;
+      memset(stream + write_size, 0, len - write_size);
+   }
 }
 
 static INLINE int find_num_frames(int rate, int latency)
@@ -129,14 +138,21 @@ static void *sdl_audio_init(const char *device,
    /* Create a buffer twice as big as needed and prefill the buffer. */
    bufsize     = out.samples * 4 * sizeof(int16_t);
    tmp         = calloc(1, bufsize);
-   sdl->buffer = fifo_new(bufsize);
+   if (!(sdl->buffer = spsc_queue_new(bufsize)))
+   {
+      free(tmp);
+      SDL_CloseAudio();
+      goto error;
+   }
 
    if (tmp)
    {
-      fifo_write(sdl->buffer, tmp, bufsize);
+      spsc_queue_write(sdl->buffer, tmp, bufsize);
       free(tmp);
    }
 
+   sdl->wait_usec = (int64_t)out.samples * 1000000 / out.freq;
+
    SDL_PauseAudio(0);
    return sdl;
 
@@ -152,14 +168,9 @@ static ssize_t sdl_audio_write(void *data, const void *buf, size_t size)
 
    if (sdl->nonblock)
    {
-      size_t avail, write_amt;
-
-      SDL_LockAudio();
-      avail = FIFO_WRITE_AVAIL(sdl->buffer);
-      write_amt = avail > size ? size : avail;
-      fifo_write(sdl->buffer, buf, write_amt);
-      SDL_UnlockAudio();
-      ret = write_amt;
+      ret = spsc_queue_write(sdl->buffer, buf, size);
+      if ((size_t)ret < size)
+         sdl->overruns++;
    }
    else
    {
@@ -167,27 +178,22 @@ static ssize_t sdl_audio_write(void *data, const void *buf, size_t size)
 
       while (written < size)
       {
-         size_t avail;
-
-         SDL_LockAudio();
-         avail = FIFO_WRITE_AVAIL(sdl->buffer);
+         size_t write_amt = spsc_queue_write(sdl->buffer,
+               (const char*)buf + written, size - written);
 
-         if (avail == 0)
+         if (write_amt == 0)
          {
-            SDL_UnlockAudio();
 #ifdef HAVE_THREADS
+            /* The callback signals without taking the lock,
+             * so a wakeup can slip past; never wait longer
+             * than one buffer for it. */
             slock_lock(sdl->lock);
-            scond_wait(sdl->cond, sdl->lock);
+            if (spsc_queue_write_avail(sdl->buffer) == 0)
+               scond_wait_timeout(sdl->cond, sdl->lock, sdl->wait_usec);
             slock_unlock(sdl->lock);
 #endif
          }
-         else
-         {
-            size_t write_amt = size - written > avail ? avail : size - written;
-            fifo_write(sdl->buffer, (const char*)buf + written, write_amt);
-            SDL_UnlockAudio();
-            written += write_amt;
-         }
+         written += write_amt;
       }
       ret = written;
    }
@@ -235,7 +241,7 @@ static void sdl_audio_free(void *data)
 
    if (sdl)
    {
-      fifo_free(sdl->buffer);
+      spsc_queue_free(sdl->buffer);
 #ifdef HAVE_THREADS
       slock_free(sdl->lock);
       scond_free(sdl->cond);
@@ -252,9 +258,22 @@ static bool sdl_audio_use_float(void *data)
 
 static size_t sdl_audio_write_avail(void *data)
 {
-   /* stub */
-   (void)data;
-   return 0;
+   sdl_audio_t *sdl = (sdl_audio_t*)data;
+   return spsc_queue_write_avail(sdl->buffer);
+}
+
+static size_t sdl_audio_buffer_size(void *data)
+{
+   sdl_audio_t *sdl = (sdl_audio_t*)data;
+   return spsc_queue_size(sdl->buffer);
+}
+
+static void sdl_audio_xruns(void *data,
+      unsigned *underruns, unsigned *overruns)
+{
+   sdl_audio_t *sdl = (sdl_audio_t*)data;
+   *underruns       = sdl->underruns;
+   *overruns        = sdl->overruns;
 }
 
 audio_driver_t audio_sdl = {
@@ -274,5 +293,6 @@ audio_driver_t audio_sdl = {
    NULL,
    NULL,
    sdl_audio_write_avail,
-   NULL
+   sdl_audio_buffer_size,
+   sdl_audio_xruns
 };
@@ -715,6 +715,22 @@ bool command_version(command_t *cmd, const char* arg)
    return true;
 }
 
+#ifdef HAVE_REWIND
+bool command_rewind_seek(command_t *cmd, const char *arg)
+{
+   char reply[64];
+   runloop_state_t *runloop_st = runloop_state_get_ptr();
+   unsigned frames             = (unsigned)strtoul(arg, NULL, 10);
+   bool ret                    = frames && state_manager_seek_back(
+         &runloop_st->rewind_st, frames);
+
+   snprintf(reply, sizeof(reply), "REWIND_SEEK %u %s\n",
+         frames, ret ? "OK" : "-1");
+   cmd->replier(cmd, reply, strlen(reply));
+   return true;
+}
+#endif
+
 static const rarch_memory_descriptor_t* command_memory_get_descriptor(const rarch_memory_map_t* mmap, unsigned address, size_t* offset)
 {
    const rarch_memory_descriptor_t* desc = mmap->descriptors;
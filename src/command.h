@@ -438,6 +438,9 @@ bool command_write_ram(command_t *cmd, const char *arg);
 #endif
 bool command_read_memory(command_t *cmd, const char *arg);
 bool command_write_memory(command_t *cmd, const char *arg);
+#ifdef HAVE_REWIND
+bool command_rewind_seek(command_t *cmd, const char *arg);
+#endif
 uint8_t *command_memory_get_pointer(
       const rarch_system_info_t* system,
       unsigned address,
@@ -462,6 +465,9 @@ static const struct cmd_action_map action_map[] = {
 #endif
    { "READ_CORE_MEMORY", command_read_memory,      "<address> <number of bytes>" },
    { "WRITE_CORE_MEMORY",command_write_memory,     "<address> <byte1> <byte2> ..." },
+#ifdef HAVE_REWIND
+   { "REWIND_SEEK",      command_rewind_seek,      "<number of frames>" },
+#endif
 };
 
 static const struct cmd_map map[] = {
@@ -1193,6 +1193,16 @@
 #define DEFAULT_REWIND_GRANULARITY 1
 #endif
 
+/* Diff and compress rewind states on a worker thread,
+ * leaving only serialization on the main thread. Frames
+ * are skipped rather than stalled if the worker falls behind. */
+#define DEFAULT_REWIND_THREADED false
+
+/* Keep only the most recent part of the rewind buffer as plain
+ * deltas and deflate older history, with periodic keyframes.
+ * Gives a much longer rewind window for the same buffer size. */
+#define DEFAULT_REWIND_TIERED false
+
 /* Pause gameplay when window loses focus. */
 #if defined(EMSCRIPTEN)
 #define DEFAULT_PAUSE_NONACTIVE false
@@ -1213,6 +1223,11 @@
 #define DEFAULT_AUTOSAVE_INTERVAL 0
 #endif
 
+/* Journal the blocks an autosave changes before writing
+ * them, so a save interrupted by a crash or power loss
+ * is completed the next time the SRAM is loaded */
+#define DEFAULT_AUTOSAVE_JOURNAL false
+
 /* Netplay lobby filters */
 #define DEFAULT_NETPLAY_SHOW_ONLY_CONNECTABLE     true
 #define DEFAULT_NETPLAY_SHOW_ONLY_INSTALLED_CORES false
@@ -1323,6 +1338,13 @@
 
 /* Hide warning messages when using the Run Ahead feature. */
 #define DEFAULT_RUN_AHEAD_HIDE_WARNINGS false
+
+/* Treat the Run Ahead frame count as an upper bound, and pick
+ * the largest depth that keeps Run Ahead within a share of
+ * the frame period, measured over the last few frames. */
+#define DEFAULT_RUN_AHEAD_ADAPTIVE false
+/* Share of the frame period, in percent. */
+#define DEFAULT_RUN_AHEAD_ADAPTIVE_BUDGET 60
 /* Hide warning messages when using Preemptive Frames. */
 #define DEFAULT_PREEMPT_HIDE_WARNINGS   false
 
@@ -1371,6 +1393,11 @@
 /* When creating/updating playlists, compress written data */
 #define DEFAULT_PLAYLIST_COMPRESSION false
 
+/* Keep a binary cache file next to each playlist,
+ * which is loaded instead of the playlist itself
+ * while the playlist is unchanged */
+#define DEFAULT_PLAYLIST_BINARY_CACHE false
+
 #ifdef HAVE_MENU
 /* Specify when to display 'core name' inline on playlist entries */
 #define DEFAULT_PLAYLIST_SHOW_INLINE_CORE_NAME PLAYLIST_INLINE_CORE_DISPLAY_HIST_FAV
@@ -1386,6 +1413,10 @@
 
 #define DEFAULT_SCAN_WITHOUT_CORE_MATCH false
 
+/* Number of decompressed hunks each CHD image
+ * keeps in memory while it is scanned */
+#define DEFAULT_SCAN_CHD_CACHE_SIZE 16
+
 #ifdef __WINRT__
 /* Be paranoid about WinRT file I/O performance, and leave this disabled by
  * default */
@@ -198,6 +198,7 @@ typedef struct settings
       unsigned bundle_assets_extract_version_current;
       unsigned bundle_assets_extract_last_version;
       unsigned content_history_size;
+      unsigned scan_chd_cache_size;
       unsigned frontend_log_level;
       unsigned libretro_log_level;
       unsigned rewind_granularity;
@@ -308,6 +309,7 @@ typedef struct settings
 #endif
 
       unsigned run_ahead_frames;
+      unsigned run_ahead_adaptive_budget;
 
       unsigned midi_volume;
       unsigned streaming_mode;
@@ -878,6 +880,8 @@ typedef struct settings
       bool history_list_enable;
       bool playlist_entry_rename;
       bool rewind_enable;
+      bool rewind_threaded;
+      bool rewind_tiered;
       bool fastforward_frameskip;
       bool vrr_runloop_enable;
       bool apply_cheats_after_toggle;
@@ -885,6 +889,7 @@ typedef struct settings
       bool run_ahead_enabled;
       bool run_ahead_secondary_instance;
       bool run_ahead_hide_warnings;
+      bool run_ahead_adaptive;
       bool preemptive_frames_enable;
       bool preemptive_frames_hide_warnings;
       bool pause_nonactive;
@@ -895,6 +900,7 @@ typedef struct settings
       bool savestate_auto_load;
       bool savestate_thumbnail_enable;
       bool save_file_compression;
+      bool autosave_journal;
       bool savestate_file_compression;
       bool network_cmd_enable;
       bool stdin_cmd_enable;
@@ -943,6 +949,7 @@ typedef struct settings
       bool sustained_performance_mode;
       bool playlist_use_old_format;
       bool playlist_compression;
+      bool playlist_binary_cache;
       bool content_runtime_log;
       bool content_runtime_log_aggregate;
 
@@ -21,14 +21,26 @@
 #include <file/file_path.h>
 #include <streams/file_stream.h>
 #include <streams/interface_stream.h>
-#include <formats/rjson.h>
 #include <lists/dir_list.h>
 #include <file/archive_file.h>
+#include <array/rbuf.h>
+#include <array/rhmap.h>
+#include <encodings/crc32.h>
 
 #ifdef HAVE_CONFIG_H
 #include "config.h"
 #endif
 
+#ifdef HAVE_MMAP
+#include <memmap.h>
+#endif
+
+#if defined(HAVE_MMAP) && defined(HAVE_MMAN)
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 #include "retroarch.h"
 #include "verbosity.h"
 
@@ -47,45 +59,140 @@
 /* Core Info Cache START */
 /*************************/
 
-#define CORE_INFO_CACHE_VERSION "1.2"
-#define CORE_INFO_CACHE_DEFAULT_CAPACITY 8
+/* Binary core info cache
+ * > One fixed size record per core, followed by
+ *   tables of string lists, list elements and
+ *   firmware, then a pool of NUL terminated
+ *   strings. Everything refers to strings by
+ *   offset into the pool, identical strings are
+ *   stored once
+ * > The file is mapped (or read in one go) and
+ *   core info strings point straight into it.
+ *   String lists and firmware of all cores are
+ *   carved from a single arena, so loading a
+ *   cached core allocates nothing but its path
+ * > Data is stored in native byte order - a cache
+ *   written by another platform fails the magic
+ *   check and is rebuilt */
+
+#define CORE_INFO_CACHE_MAGIC   0x43494352 /* "RCIC" */
+#define CORE_INFO_CACHE_VERSION 2
+#define CORE_INFO_CACHE_NULL    0xFFFFFFFF
+
+enum core_info_cache_string
+{
+   CORE_INFO_CACHE_DISPLAY_NAME = 0,
+   CORE_INFO_CACHE_DISPLAY_VERSION,
+   CORE_INFO_CACHE_CORE_NAME,
+   CORE_INFO_CACHE_SYSTEM_MANUFACTURER,
+   CORE_INFO_CACHE_SYSTEMNAME,
+   CORE_INFO_CACHE_SYSTEM_ID,
+   CORE_INFO_CACHE_SUPPORTED_EXTENSIONS,
+   CORE_INFO_CACHE_AUTHORS,
+   CORE_INFO_CACHE_PERMISSIONS,
+   CORE_INFO_CACHE_LICENSES,
+   CORE_INFO_CACHE_CATEGORIES,
+   CORE_INFO_CACHE_DATABASES,
+   CORE_INFO_CACHE_NOTES,
+   CORE_INFO_CACHE_REQUIRED_HW_API,
+   CORE_INFO_CACHE_DESCRIPTION,
+   CORE_INFO_CACHE_CORE_FILE_ID,
+   CORE_INFO_CACHE_STRING_LAST
+};
+
+enum core_info_cache_list
+{
+   CORE_INFO_CACHE_CATEGORIES_LIST = 0,
+   CORE_INFO_CACHE_DATABASES_LIST,
+   CORE_INFO_CACHE_NOTE_LIST,
+   CORE_INFO_CACHE_SUPPORTED_EXTENSIONS_LIST,
+   CORE_INFO_CACHE_AUTHORS_LIST,
+   CORE_INFO_CACHE_PERMISSIONS_LIST,
+   CORE_INFO_CACHE_LICENSES_LIST,
+   CORE_INFO_CACHE_REQUIRED_HW_API_LIST,
+   CORE_INFO_CACHE_LIST_LAST
+};
 
-/* TODO/FIXME: Apparently rzip compression is an issue on UWP */
-#if defined(HAVE_ZLIB) && !(defined(__WINRT__) || defined(WINAPI_FAMILY) && WINAPI_FAMILY == WINAPI_FAMILY_PHONE_APP)
-#define CORE_INFO_CACHE_COMPRESS
-#endif
+enum core_info_cache_flags
+{
+   CORE_INFO_CACHE_FLAG_HAS_INFO                      = (1 << 0),
+   CORE_INFO_CACHE_FLAG_SUPPORTS_NO_GAME              = (1 << 1),
+   CORE_INFO_CACHE_FLAG_SINGLE_PURPOSE                = (1 << 2),
+   CORE_INFO_CACHE_FLAG_DATABASE_MATCH_ARCHIVE_MEMBER = (1 << 3),
+   CORE_INFO_CACHE_FLAG_IS_EXPERIMENTAL               = (1 << 4)
+};
 
 typedef struct
 {
-   core_info_t *items;
-   size_t length;
-   size_t capacity;
-   char *version;
-   bool refresh;
-} core_info_cache_list_t;
+   uint32_t magic;
+   uint32_t version;
+   uint32_t crc;          /* Everything after the header */
+   uint32_t count;        /* Core records */
+   uint32_t list_count;   /* String lists */
+   uint32_t elem_count;   /* String list elements */
+   uint32_t firmware_count;
+   uint32_t strings_size;
+} core_info_cache_header_t;
 
 typedef struct
 {
-   core_info_t *core_info;
-   core_info_cache_list_t *core_info_cache_list;
-   char **current_string_val;
-   struct string_list **current_string_list_val;
-   uint32_t *current_entry_uint_val;
-   bool *current_entry_bool_val;
-   unsigned array_depth;
-   unsigned object_depth;
-   bool to_core_file_id;
-   bool to_firmware;
-} CCJSONContext;
+   uint32_t strings[CORE_INFO_CACHE_STRING_LAST];
+   /* Index into the list table */
+   uint32_t lists[CORE_INFO_CACHE_LIST_LAST];
+   /* 'firmware_count' consecutive firmware records */
+   uint32_t firmware;
+   uint32_t firmware_count;
+   uint32_t core_file_id_hash;
+   uint32_t savestate_support_level;
+   uint32_t flags;
+   uint32_t reserved;
+} core_info_cache_record_t;
+
+typedef struct
+{
+   /* 'count' consecutive entries of the element table */
+   uint32_t first;
+   uint32_t count;
+} core_info_cache_range_t;
+
+typedef struct
+{
+   uint32_t path;
+   uint32_t desc;
+   uint32_t optional;
+   uint32_t reserved;
+} core_info_cache_firmware_t;
+
+struct core_info_cache
+{
+   uint8_t *data;
+   size_t size;
+   /* String lists, their elements and firmware
+    * of every cached core */
+   uint8_t *arena;
+   size_t arena_size;
+   size_t arena_used;
+   /* Set for each record claimed by an installed core */
+   uint8_t *installed;
+   size_t installed_count;
+   const core_info_cache_record_t *records;
+   const core_info_cache_range_t *lists;
+   const uint32_t *elems;
+   const core_info_cache_firmware_t *firmware;
+   char *strings;
+   core_info_cache_header_t header;
+   bool mapped;
+};
+
+typedef struct
+{
+   char *strings;       /* RBUF */
+   uint32_t *offsets;   /* RHMAP, string -> offset */
+   bool failed;
+} core_info_cache_writer_t;
 
 /* Forward declarations */
-static void core_info_free(core_info_t* info);
 static uint32_t core_info_hash_string(const char *str);
-#ifdef HAVE_CORE_INFO_CACHE
-static core_info_cache_list_t *core_info_cache_list_new(void);
-#endif
-static void core_info_cache_add(core_info_cache_list_t *list,
-      core_info_t *info, bool transfer);
 
 static core_info_state_t core_info_st = {
 #ifdef HAVE_COMPRESSION
@@ -96,1126 +203,670 @@ static core_info_state_t core_info_st = {
    NULL
 };
 
-#ifdef HAVE_CORE_INFO_CACHE
-/* JSON Handlers START */
-
-static bool CCJSONObjectMemberHandler(void *context,
-      const char *pValue, size_t length)
-{
-   CCJSONContext *pCtx = (CCJSONContext *)context;
-
-   if (   (pCtx->object_depth == 2)
-       && (pCtx->array_depth  == 1)
-       && length)
-   {
-      pCtx->current_string_val      = NULL;
-      pCtx->current_string_list_val = NULL;
-      pCtx->current_entry_uint_val  = NULL;
-      pCtx->current_entry_bool_val  = NULL;
-      pCtx->to_core_file_id         = false;
-      pCtx->to_firmware             = false;
-
-      switch (pValue[0])
-      {
-         case 'a':
-            if (string_is_equal(pValue,      "authors"))
-            {
-               pCtx->current_string_val      = &pCtx->core_info->authors;
-               pCtx->current_string_list_val = &pCtx->core_info->authors_list;
-            }
-            break;
-         case 'c':
-            if (string_is_equal(pValue,      "categories"))
-            {
-               pCtx->current_string_val      = &pCtx->core_info->categories;
-               pCtx->current_string_list_val = &pCtx->core_info->categories_list;
-            }
-            else if (string_is_equal(pValue, "core_name"))
-               pCtx->current_string_val      = &pCtx->core_info->core_name;
-            else if (string_is_equal(pValue, "core_file_id"))
-               pCtx->to_core_file_id         = true;
-            break;
-         case 'd':
-            if (string_is_equal(pValue,      "display_name"))
-               pCtx->current_string_val      = &pCtx->core_info->display_name;
-            else if (string_is_equal(pValue, "display_version"))
-               pCtx->current_string_val      = &pCtx->core_info->display_version;
-            else if (string_is_equal(pValue, "databases"))
-            {
-               pCtx->current_string_val      = &pCtx->core_info->databases;
-               pCtx->current_string_list_val = &pCtx->core_info->databases_list;
-            }
-            else if (string_is_equal(pValue, "description"))
-               pCtx->current_string_val      = &pCtx->core_info->description;
-            else if (string_is_equal(pValue, "database_match_archive_member"))
-               pCtx->current_entry_bool_val  = &pCtx->core_info->database_match_archive_member;
-            break;
-         case 'f':
-            if (string_is_equal(pValue,      "firmware"))
-               pCtx->to_firmware             = true;
-            break;
-         case 'h':
-            if (string_is_equal(pValue,      "has_info"))
-               pCtx->current_entry_bool_val  = &pCtx->core_info->has_info;
-            break;
-         case 'l':
-            if (string_is_equal(pValue,      "licenses"))
-            {
-               pCtx->current_string_val      = &pCtx->core_info->licenses;
-               pCtx->current_string_list_val = &pCtx->core_info->licenses_list;
-            }
-            else if (string_is_equal(pValue, "is_experimental"))
-               pCtx->current_entry_bool_val  = &pCtx->core_info->is_experimental;
-            break;
-         case 'n':
-            if (string_is_equal(pValue,      "notes"))
-            {
-               pCtx->current_string_val      = &pCtx->core_info->notes;
-               pCtx->current_string_list_val = &pCtx->core_info->note_list;
-            }
-            break;
-         case 'p':
-            if (string_is_equal(pValue,      "permissions"))
-            {
-               pCtx->current_string_val      = &pCtx->core_info->permissions;
-               pCtx->current_string_list_val = &pCtx->core_info->permissions_list;
-            }
-            break;
-         case 'r':
-            if (string_is_equal(pValue,      "required_hw_api"))
-            {
-               pCtx->current_string_val      = &pCtx->core_info->required_hw_api;
-               pCtx->current_string_list_val = &pCtx->core_info->required_hw_api_list;
-            }
-            break;
-         case 's':
-            if (string_is_equal(pValue,      "system_manufacturer"))
-               pCtx->current_string_val      = &pCtx->core_info->system_manufacturer;
-            else if (string_is_equal(pValue, "systemname"))
-               pCtx->current_string_val      = &pCtx->core_info->systemname;
-            else if (string_is_equal(pValue, "system_id"))
-               pCtx->current_string_val      = &pCtx->core_info->system_id;
-            else if (string_is_equal(pValue, "supported_extensions"))
-            {
-               pCtx->current_string_val      = &pCtx->core_info->supported_extensions;
-               pCtx->current_string_list_val = &pCtx->core_info->supported_extensions_list;
-            }
-            else if (string_is_equal(pValue, "supports_no_game"))
-               pCtx->current_entry_bool_val  = &pCtx->core_info->supports_no_game;
-            else if (string_is_equal(pValue, "single_purpose"))
-               pCtx->current_entry_bool_val  = &pCtx->core_info->single_purpose;
-            else if (string_is_equal(pValue, "savestate_support_level"))
-               pCtx->current_entry_uint_val  = &pCtx->core_info->savestate_support_level;
-            break;
-      }
-   }
-   else if (   (pCtx->object_depth == 3)
-            && (pCtx->array_depth  == 1)
-            && length)
-   {
-      pCtx->current_string_val      = NULL;
-      pCtx->current_entry_uint_val  = NULL;
-
-      if (pCtx->to_core_file_id)
-      {
-         if (string_is_equal(pValue,      "str"))
-            pCtx->current_string_val         = &pCtx->core_info->core_file_id.str;
-         else if (string_is_equal(pValue, "hash"))
-            pCtx->current_entry_uint_val     = &pCtx->core_info->core_file_id.hash;
-      }
-   }
-   else if (   (pCtx->object_depth == 3)
-            && (pCtx->array_depth  == 2)
-            && length)
-   {
-      pCtx->current_string_val               = NULL;
-      pCtx->current_entry_bool_val           = NULL;
-
-      if (pCtx->to_firmware && (pCtx->core_info->firmware_count > 0))
-      {
-         size_t firmware_idx                 = pCtx->core_info->firmware_count - 1;
-
-         if (string_is_equal(pValue,      "path"))
-            pCtx->current_string_val         = &pCtx->core_info->firmware[firmware_idx].path;
-         else if (string_is_equal(pValue, "desc"))
-            pCtx->current_string_val         = &pCtx->core_info->firmware[firmware_idx].desc;
-         else if (string_is_equal(pValue, "optional"))
-            pCtx->current_entry_bool_val     = &pCtx->core_info->firmware[firmware_idx].optional;
-      }
-   }
-   else if (   (pCtx->object_depth == 1)
-            && (pCtx->array_depth  == 0)
-            && length)
-   {
-      pCtx->current_string_val               = NULL;
-
-      if (string_is_equal(pValue,         "version"))
-         pCtx->current_string_val            = &pCtx->core_info_cache_list->version;
+static char **core_info_cache_string_ptr(core_info_t *info, unsigned i)
+{
+   switch (i)
+   {
+      case CORE_INFO_CACHE_DISPLAY_NAME:
+         return &info->display_name;
+      case CORE_INFO_CACHE_DISPLAY_VERSION:
+         return &info->display_version;
+      case CORE_INFO_CACHE_CORE_NAME:
+         return &info->core_name;
+      case CORE_INFO_CACHE_SYSTEM_MANUFACTURER:
+         return &info->system_manufacturer;
+      case CORE_INFO_CACHE_SYSTEMNAME:
+         return &info->systemname;
+      case CORE_INFO_CACHE_SYSTEM_ID:
+         return &info->system_id;
+      case CORE_INFO_CACHE_SUPPORTED_EXTENSIONS:
+         return &info->supported_extensions;
+      case CORE_INFO_CACHE_AUTHORS:
+         return &info->authors;
+      case CORE_INFO_CACHE_PERMISSIONS:
+         return &info->permissions;
+      case CORE_INFO_CACHE_LICENSES:
+         return &info->licenses;
+      case CORE_INFO_CACHE_CATEGORIES:
+         return &info->categories;
+      case CORE_INFO_CACHE_DATABASES:
+         return &info->databases;
+      case CORE_INFO_CACHE_NOTES:
+         return &info->notes;
+      case CORE_INFO_CACHE_REQUIRED_HW_API:
+         return &info->required_hw_api;
+      case CORE_INFO_CACHE_DESCRIPTION:
+         return &info->description;
+      case CORE_INFO_CACHE_CORE_FILE_ID:
+      default:
+         break;
    }
 
-   return true;
+   return &info->core_file_id.str;
 }
 
-static bool CCJSONStringHandler(void *context,
-      const char *pValue, size_t length)
+static struct string_list **core_info_cache_list_ptr(
+      core_info_t *info, unsigned i)
 {
-   CCJSONContext *pCtx = (CCJSONContext*)context;
-
-   if (     pCtx->current_string_val 
-         && length 
-         && !string_is_empty(pValue))
+   switch (i)
    {
-      if (*pCtx->current_string_val)
-         free(*pCtx->current_string_val);
-      *pCtx->current_string_val = strdup(pValue);
-
-      if (pCtx->current_string_list_val)
-      {
-         if (*pCtx->current_string_list_val)
-            string_list_free(*pCtx->current_string_list_val);
-         *pCtx->current_string_list_val = 
-            string_split(*pCtx->current_string_val, "|");
-      }
+      case CORE_INFO_CACHE_CATEGORIES_LIST:
+         return &info->categories_list;
+      case CORE_INFO_CACHE_DATABASES_LIST:
+         return &info->databases_list;
+      case CORE_INFO_CACHE_NOTE_LIST:
+         return &info->note_list;
+      case CORE_INFO_CACHE_SUPPORTED_EXTENSIONS_LIST:
+         return &info->supported_extensions_list;
+      case CORE_INFO_CACHE_AUTHORS_LIST:
+         return &info->authors_list;
+      case CORE_INFO_CACHE_PERMISSIONS_LIST:
+         return &info->permissions_list;
+      case CORE_INFO_CACHE_LICENSES_LIST:
+         return &info->licenses_list;
+      case CORE_INFO_CACHE_REQUIRED_HW_API_LIST:
+      default:
+         break;
    }
 
-   pCtx->current_string_val      = NULL;
-   pCtx->current_string_list_val = NULL;
-
-   return true;
+   return &info->required_hw_api_list;
 }
 
-static bool CCJSONNumberHandler(void *context,
-      const char *pValue, size_t length)
+/* Returns true if 'ptr' belongs to the cache,
+ * rather than to the heap */
+static bool core_info_cache_owns(const core_info_cache_t *cache,
+      const void *ptr)
 {
-   CCJSONContext *pCtx              = (CCJSONContext*)context;
-
-   if (pCtx->current_entry_uint_val)
-      *pCtx->current_entry_uint_val = string_to_unsigned(pValue);
+   uintptr_t addr = (uintptr_t)ptr;
 
-   pCtx->current_entry_uint_val     = NULL;
+   if (!cache || !ptr)
+      return false;
 
-   return true;
+   return (   addr >= (uintptr_t)cache->data
+           && addr <  (uintptr_t)cache->data + cache->size)
+       || (   addr >= (uintptr_t)cache->arena
+           && addr <  (uintptr_t)cache->arena + cache->arena_size);
 }
 
-static bool CCJSONBoolHandler(void *context, bool value)
+static void core_info_cache_get_path(const char *info_dir,
+      const char *file_name, char *s, size_t len)
 {
-   CCJSONContext *pCtx              = (CCJSONContext *)context;
-
-   if (pCtx->current_entry_bool_val)
-      *pCtx->current_entry_bool_val = value;
-
-   pCtx->current_entry_bool_val     = NULL;
-
-   return true;
+   if (string_is_empty(info_dir))
+      strlcpy(s, file_name, len);
+   else
+      fill_pathname_join_special(s, info_dir, file_name, len);
 }
 
-static bool CCJSONStartObjectHandler(void *context)
+static void core_info_cache_free(core_info_cache_t *cache)
 {
-   CCJSONContext *pCtx = (CCJSONContext*)context;
-
-   pCtx->object_depth++;
-
-   if (     (pCtx->object_depth == 1) 
-         && (pCtx->array_depth  == 0))
-   {
-      if (pCtx->core_info_cache_list)
-         return false;
-      if (!(pCtx->core_info_cache_list = core_info_cache_list_new()))
-         return false;
-   }
-   else if ((pCtx->object_depth == 2) 
-         && (pCtx->array_depth  == 1))
-   {
-      if (pCtx->core_info)
-      {
-         core_info_free(pCtx->core_info);
-         free(pCtx->core_info);
-         pCtx->core_info = NULL;
-      }
-
-      if (!(pCtx->core_info = (core_info_t*)calloc(1, sizeof(core_info_t))))
-         return false;
+   if (!cache)
+      return;
 
-      /* Assume all cores have 'full' savestate support
-       * by default */
-      pCtx->core_info->savestate_support_level =
-            CORE_INFO_SAVESTATE_DETERMINISTIC;
-   }
-   else if ((pCtx->object_depth == 3) 
-         && (pCtx->array_depth  == 2))
-   {
-      if (pCtx->to_firmware)
-      {
-         size_t new_idx            = pCtx->core_info->firmware_count;
-         core_info_firmware_t *tmp = (core_info_firmware_t*)
-               realloc(pCtx->core_info->firmware,
-                      (pCtx->core_info->firmware_count + 1) 
-                     * sizeof(core_info_firmware_t));
-
-         if (!tmp)
-            return false;
-
-         tmp[new_idx].path              = NULL;
-         tmp[new_idx].desc              = NULL;
-         tmp[new_idx].missing           = false;
-         tmp[new_idx].optional          = false;
-
-         pCtx->core_info->firmware      = tmp;
-         pCtx->core_info->firmware_count++;
-      }
-   }
+#if defined(HAVE_MMAP) && defined(HAVE_MMAN)
+   if (cache->mapped)
+      munmap(cache->data, cache->size);
+   else
+#endif
+      free(cache->data);
 
-   return true;
+   free(cache->arena);
+   free(cache->installed);
+   free(cache);
 }
 
-static bool CCJSONEndObjectHandler(void *context)
+static const char *core_info_cache_get_string(
+      const core_info_cache_t *cache, uint32_t offset, bool *valid)
 {
-   CCJSONContext *pCtx = (CCJSONContext*)context;
-
-   if (     (pCtx->object_depth == 2) 
-         && (pCtx->array_depth  == 1)
-         && (pCtx->core_info))
+   if (offset == CORE_INFO_CACHE_NULL)
+      return NULL;
+   if (offset >= cache->header.strings_size)
    {
-      core_info_cache_add(
-            pCtx->core_info_cache_list, pCtx->core_info, true);
-      free(pCtx->core_info);
-      pCtx->core_info = NULL;
+      *valid = false;
+      return NULL;
    }
-   else if ((pCtx->object_depth == 3) 
-         && (pCtx->array_depth == 1))
-      pCtx->to_core_file_id = false;
-
-   pCtx->object_depth--;
-
-   return true;
+   return cache->strings + offset;
 }
 
-static bool CCJSONStartArrayHandler(void *context)
+/* Checks that every offset and index of the
+ * cache is within bounds, so that records can
+ * later be resolved without any checks */
+static bool core_info_cache_validate(const core_info_cache_t *cache)
 {
-   CCJSONContext *pCtx = (CCJSONContext*)context;
-   pCtx->array_depth++;
-   return true;
-}
+   size_t i, j;
+   bool valid = true;
+   const core_info_cache_header_t *header = &cache->header;
 
-static bool CCJSONEndArrayHandler(void *context)
-{
-   CCJSONContext *pCtx = (CCJSONContext*)context;
+   for (i = 0; i < header->elem_count && valid; i++)
+      core_info_cache_get_string(cache, cache->elems[i], &valid);
 
-   if ((pCtx->object_depth == 2) && (pCtx->array_depth == 2))
-      pCtx->to_firmware = false;
+   for (i = 0; i < header->list_count && valid; i++)
+      if (     cache->lists[i].first > header->elem_count
+            || cache->lists[i].count > header->elem_count
+               - cache->lists[i].first)
+         valid = false;
 
-   pCtx->array_depth--;
+   for (i = 0; i < header->firmware_count && valid; i++)
+   {
+      core_info_cache_get_string(cache, cache->firmware[i].path, &valid);
+      core_info_cache_get_string(cache, cache->firmware[i].desc, &valid);
+   }
 
-   return true;
-}
+   for (i = 0; i < header->count && valid; i++)
+   {
+      const core_info_cache_record_t *record = &cache->records[i];
 
-/* JSON Handlers END */
-#endif
+      for (j = 0; j < CORE_INFO_CACHE_STRING_LAST; j++)
+         core_info_cache_get_string(cache, record->strings[j], &valid);
 
-/* Note: 'dst' must be zero initialised, or memory
- * leaks will occur */
-static void core_info_copy(core_info_t *src, core_info_t *dst)
-{
-   dst->path                      = src->path                 ? strdup(src->path)                 : NULL;
-   dst->display_name              = src->display_name         ? strdup(src->display_name)         : NULL;
-   dst->display_version           = src->display_version      ? strdup(src->display_version)      : NULL;
-   dst->core_name                 = src->core_name            ? strdup(src->core_name)            : NULL;
-   dst->system_manufacturer       = src->system_manufacturer  ? strdup(src->system_manufacturer)  : NULL;
-   dst->systemname                = src->systemname           ? strdup(src->systemname)           : NULL;
-   dst->system_id                 = src->system_id            ? strdup(src->system_id)            : NULL;
-   dst->supported_extensions      = src->supported_extensions ? strdup(src->supported_extensions) : NULL;
-   dst->authors                   = src->authors              ? strdup(src->authors)              : NULL;
-   dst->permissions               = src->permissions          ? strdup(src->permissions)          : NULL;
-   dst->licenses                  = src->licenses             ? strdup(src->licenses)             : NULL;
-   dst->categories                = src->categories           ? strdup(src->categories)           : NULL;
-   dst->databases                 = src->databases            ? strdup(src->databases)            : NULL;
-   dst->notes                     = src->notes                ? strdup(src->notes)                : NULL;
-   dst->required_hw_api           = src->required_hw_api      ? strdup(src->required_hw_api)      : NULL;
-   dst->description               = src->description          ? strdup(src->description)          : NULL;
-
-   dst->categories_list           = src->categories_list           ? string_list_clone(src->categories_list)           : NULL;
-   dst->databases_list            = src->databases_list            ? string_list_clone(src->databases_list)            : NULL;
-   dst->note_list                 = src->note_list                 ? string_list_clone(src->note_list)                 : NULL;
-   dst->supported_extensions_list = src->supported_extensions_list ? string_list_clone(src->supported_extensions_list) : NULL;
-   dst->authors_list              = src->authors_list              ? string_list_clone(src->authors_list)              : NULL;
-   dst->permissions_list          = src->permissions_list          ? string_list_clone(src->permissions_list)          : NULL;
-   dst->licenses_list             = src->licenses_list             ? string_list_clone(src->licenses_list)             : NULL;
-   dst->required_hw_api_list      = src->required_hw_api_list      ? string_list_clone(src->required_hw_api_list)      : NULL;
-
-   if (src->firmware_count > 0)
-   {
-      dst->firmware = (core_info_firmware_t*)calloc(src->firmware_count,
-            sizeof(core_info_firmware_t));
-
-      if (dst->firmware)
-      {
-         size_t i;
+      for (j = 0; j < CORE_INFO_CACHE_LIST_LAST; j++)
+         if (     record->lists[j] != CORE_INFO_CACHE_NULL
+               && record->lists[j] >= header->list_count)
+            valid = false;
 
-         dst->firmware_count = src->firmware_count;
+      if (     record->firmware_count
+            && (   record->firmware > header->firmware_count
+                || record->firmware_count > header->firmware_count
+                   - record->firmware))
+         valid = false;
 
-         for (i = 0; i < src->firmware_count; i++)
-         {
-            dst->firmware[i].path     = src->firmware[i].path ? strdup(src->firmware[i].path) : NULL;
-            dst->firmware[i].desc     = src->firmware[i].desc ? strdup(src->firmware[i].desc) : NULL;
-            dst->firmware[i].missing  = src->firmware[i].missing;
-            dst->firmware[i].optional = src->firmware[i].optional;
-         }
-      }
-      else
-         dst->firmware_count = 0;
+      /* Records are looked up by core file id */
+      if (record->strings[CORE_INFO_CACHE_CORE_FILE_ID]
+            == CORE_INFO_CACHE_NULL)
+         valid = false;
    }
 
-   dst->core_file_id.str              = src->core_file_id.str 
-      ? strdup(src->core_file_id.str) : NULL;
-   dst->core_file_id.hash             = src->core_file_id.hash;
-
-   dst->savestate_support_level       = src->savestate_support_level;
-   dst->has_info                      = src->has_info;
-   dst->supports_no_game              = src->supports_no_game;
-   dst->single_purpose                = src->single_purpose;
-   dst->database_match_archive_member = src->database_match_archive_member;
-   dst->is_experimental               = src->is_experimental;
-   dst->is_locked                     = src->is_locked;
-   dst->is_standalone_exempt          = src->is_standalone_exempt;
-   dst->is_installed                  = src->is_installed;
+   return valid;
 }
 
-/* Like core_info_copy, but transfers 'ownership'
- * of internal objects/data structures from 'src'
- * to 'dst' */
-static void core_info_transfer(core_info_t *src, core_info_t *dst)
+#ifdef HAVE_CORE_INFO_CACHE
+/* Returns NULL if there is no usable cache
+ * (missing, stale version, corrupt or a
+ * refresh was requested) */
+static core_info_cache_t *core_info_cache_read(const char *info_dir)
 {
-   dst->path                      = src->path;
-   src->path                      = NULL;
-
-   dst->display_name              = src->display_name;
-   src->display_name              = NULL;
-
-   dst->display_version           = src->display_version;
-   src->display_version           = NULL;
-
-   dst->core_name                 = src->core_name;
-   src->core_name                 = NULL;
-
-   dst->system_manufacturer       = src->system_manufacturer;
-   src->system_manufacturer       = NULL;
-
-   dst->systemname                = src->systemname;
-   src->systemname                = NULL;
-
-   dst->system_id                 = src->system_id;
-   src->system_id                 = NULL;
+   size_t tables_size;
+   core_info_cache_t *cache = NULL;
+   char file_path[PATH_MAX_LENGTH];
 
-   dst->supported_extensions      = src->supported_extensions;
-   src->supported_extensions      = NULL;
+   /* Check whether a 'force refresh' file
+    * is present */
+   core_info_cache_get_path(info_dir,
+         FILE_PATH_CORE_INFO_CACHE_REFRESH, file_path, sizeof(file_path));
 
-   dst->authors                   = src->authors;
-   src->authors                   = NULL;
+   if (path_is_valid(file_path))
+      return NULL;
 
-   dst->permissions               = src->permissions;
-   src->permissions               = NULL;
+   core_info_cache_get_path(info_dir,
+         FILE_PATH_CORE_INFO_CACHE, file_path, sizeof(file_path));
 
-   dst->licenses                  = src->licenses;
-   src->licenses                  = NULL;
+   if (!(cache = (core_info_cache_t*)calloc(1, sizeof(*cache))))
+      return NULL;
 
-   dst->categories                = src->categories;
-   src->categories                = NULL;
+#if defined(HAVE_MMAP) && defined(HAVE_MMAN)
+   {
+      struct stat buf;
+      int fd = open(file_path, O_RDONLY);
 
-   dst->databases                 = src->databases;
-   src->databases                 = NULL;
+      if (fd < 0)
+         goto error;
 
-   dst->notes                     = src->notes;
-   src->notes                     = NULL;
+      if (     fstat(fd, &buf) == 0
+            && buf.st_size >= (off_t)sizeof(cache->header))
+      {
+         /* Private writable mapping: core info strings
+          * are not const, pages are copied if written to */
+         void *addr = mmap(NULL, (size_t)buf.st_size,
+               PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
 
-   dst->required_hw_api           = src->required_hw_api;
-   src->required_hw_api           = NULL;
+         if (addr != MAP_FAILED)
+         {
+            cache->data   = (uint8_t*)addr;
+            cache->size   = (size_t)buf.st_size;
+            cache->mapped = true;
+         }
+      }
 
-   dst->description               = src->description;
-   src->description               = NULL;
+      close(fd);
+   }
+#endif
 
-   dst->categories_list           = src->categories_list;
-   src->categories_list           = NULL;
+   if (!cache->data)
+   {
+      void *buf   = NULL;
+      int64_t len = 0;
 
-   dst->databases_list            = src->databases_list;
-   src->databases_list            = NULL;
+      if (     !path_is_valid(file_path)
+            || !filestream_read_file(file_path, &buf, &len))
+         goto error;
 
-   dst->note_list                 = src->note_list;
-   src->note_list                 = NULL;
+      cache->data = (uint8_t*)buf;
+      cache->size = (size_t)len;
+   }
 
-   dst->supported_extensions_list = src->supported_extensions_list;
-   src->supported_extensions_list = NULL;
+   if (cache->size < sizeof(cache->header))
+      goto invalid;
 
-   dst->authors_list              = src->authors_list;
-   src->authors_list              = NULL;
+   memcpy(&cache->header, cache->data, sizeof(cache->header));
 
-   dst->permissions_list          = src->permissions_list;
-   src->permissions_list          = NULL;
+   if (     cache->header.magic   != CORE_INFO_CACHE_MAGIC
+         || cache->header.version != CORE_INFO_CACHE_VERSION)
+   {
+      RARCH_WARN("[Core Info] Core info cache has invalid version"
+            " - forcing refresh (required v%u)\n",
+            CORE_INFO_CACHE_VERSION);
+      goto error;
+   }
 
-   dst->licenses_list             = src->licenses_list;
-   src->licenses_list             = NULL;
+   /* All tables are arrays of uint32_t - check
+    * their total size before multiplying out */
+   if (     cache->header.count          > cache->size
+         || cache->header.list_count     > cache->size
+         || cache->header.elem_count     > cache->size
+         || cache->header.firmware_count > cache->size)
+      goto invalid;
+
+   tables_size = cache->header.count * sizeof(*cache->records)
+         + cache->header.list_count     * sizeof(*cache->lists)
+         + cache->header.elem_count     * sizeof(*cache->elems)
+         + cache->header.firmware_count * sizeof(*cache->firmware);
+
+   if (     tables_size > cache->size - sizeof(cache->header)
+         || cache->size - sizeof(cache->header) - tables_size
+            != cache->header.strings_size)
+      goto invalid;
+
+   cache->records  = (const core_info_cache_record_t*)
+      (cache->data + sizeof(cache->header));
+   cache->lists    = (const core_info_cache_range_t*)
+      (cache->records + cache->header.count);
+   cache->elems    = (const uint32_t*)
+      (cache->lists + cache->header.list_count);
+   cache->firmware = (const core_info_cache_firmware_t*)
+      (cache->elems + cache->header.elem_count);
+   cache->strings  = (char*)(cache->firmware + cache->header.firmware_count);
+
+   /* Every in-bounds offset is then a valid string */
+   if (     cache->header.strings_size
+         && cache->strings[cache->header.strings_size - 1] != '\0')
+      goto invalid;
+
+   if (encoding_crc32(0, cache->data + sizeof(cache->header),
+            cache->size - sizeof(cache->header)) != cache->header.crc)
+      goto invalid;
+
+   if (!core_info_cache_validate(cache))
+      goto invalid;
+
+   cache->arena_size = cache->header.list_count
+         * sizeof(struct string_list)
+         + cache->header.elem_count
+         * sizeof(struct string_list_elem)
+         + cache->header.firmware_count
+         * sizeof(core_info_firmware_t);
+
+   if (cache->arena_size && !(cache->arena =
+            (uint8_t*)calloc(1, cache->arena_size)))
+      goto error;
 
-   dst->required_hw_api_list      = src->required_hw_api_list;
-   src->required_hw_api_list      = NULL;
+   if (cache->header.count && !(cache->installed =
+            (uint8_t*)calloc(cache->header.count, sizeof(uint8_t))))
+      goto error;
 
-   dst->firmware                  = src->firmware;
-   dst->firmware_count            = src->firmware_count;
-   src->firmware                  = NULL;
-   src->firmware_count            = 0;
+   return cache;
 
-   dst->core_file_id.str              = src->core_file_id.str;
-   src->core_file_id.str              = NULL;
-   dst->core_file_id.hash             = src->core_file_id.hash;
+invalid:
+   RARCH_WARN("[Core Info] Core info cache is corrupt - forcing refresh\n");
+error:
+   core_info_cache_free(cache);
+   return NULL;
+}
+#endif
 
-   dst->savestate_support_level       = src->savestate_support_level;
-   dst->has_info                      = src->has_info;
-   dst->supports_no_game              = src->supports_no_game;
-   dst->single_purpose                = src->single_purpose;
-   dst->database_match_archive_member = src->database_match_archive_member;
-   dst->is_experimental               = src->is_experimental;
-   dst->is_locked                     = src->is_locked;
-   dst->is_standalone_exempt          = src->is_standalone_exempt;
-   dst->is_installed                  = src->is_installed;
+static void *core_info_cache_alloc(core_info_cache_t *cache, size_t size)
+{
+   void *ptr = cache->arena + cache->arena_used;
+   cache->arena_used += size;
+   return ptr;
 }
 
-static void core_info_cache_list_free(
-      core_info_cache_list_t *core_info_cache_list)
+/* Points 'info' at the cached core data. Each
+ * record is only ever resolved once, so the
+ * arena always has room */
+static void core_info_cache_resolve(core_info_cache_t *cache,
+      size_t idx, core_info_t *info)
 {
-   size_t i;
+   size_t i, j;
+   bool valid                             = true;
+   const core_info_cache_record_t *record = &cache->records[idx];
 
-   if (!core_info_cache_list)
-      return;
+   for (i = 0; i < CORE_INFO_CACHE_STRING_LAST; i++)
+      *core_info_cache_string_ptr(info, (unsigned)i) =
+            (char*)core_info_cache_get_string(cache,
+                  record->strings[i], &valid);
 
-   for (i = 0; i < core_info_cache_list->length; i++)
+   for (i = 0; i < CORE_INFO_CACHE_LIST_LAST; i++)
    {
-      core_info_t* info = (core_info_t*)&core_info_cache_list->items[i];
-      core_info_free(info);
-   }
-
-   free(core_info_cache_list->items);
+      struct string_list *list;
+      const core_info_cache_range_t *range;
 
-   if (core_info_cache_list->version)
-      free(core_info_cache_list->version);
-
-   free(core_info_cache_list);
-}
+      if (record->lists[i] == CORE_INFO_CACHE_NULL)
+         continue;
 
-static core_info_t *core_info_cache_find(
-      core_info_cache_list_t *list, char *core_file_id)
-{
-   uint32_t hash;
-   size_t i;
+      range       = &cache->lists[record->lists[i]];
+      list        = (struct string_list*)core_info_cache_alloc(cache,
+            sizeof(*list));
+      list->elems = (struct string_list_elem*)core_info_cache_alloc(cache,
+            range->count * sizeof(*list->elems));
+      list->size  = range->count;
+      list->cap   = range->count;
 
-   if (  !list
-       || string_is_empty(core_file_id))
-      return NULL;
+      for (j = 0; j < range->count; j++)
+         list->elems[j].data = (char*)core_info_cache_get_string(cache,
+               cache->elems[range->first + j], &valid);
 
-   hash = core_info_hash_string(core_file_id);
+      *core_info_cache_list_ptr(info, (unsigned)i) = list;
+   }
 
-   for (i = 0; i < list->length; i++)
+   if (record->firmware_count)
    {
-      core_info_t *info = (core_info_t*)&list->items[i];
-
-      if (!info)
-         continue;
+      info->firmware       = (core_info_firmware_t*)core_info_cache_alloc(
+            cache, record->firmware_count * sizeof(*info->firmware));
+      info->firmware_count = record->firmware_count;
 
-      if (  (info->core_file_id.hash == hash)
-          && string_is_equal(info->core_file_id.str, core_file_id))
+      for (i = 0; i < record->firmware_count; i++)
       {
-         info->is_installed = true;
-         return info;
+         const core_info_cache_firmware_t *firmware =
+               &cache->firmware[record->firmware + i];
+
+         info->firmware[i].path     = (char*)core_info_cache_get_string(
+               cache, firmware->path, &valid);
+         info->firmware[i].desc     = (char*)core_info_cache_get_string(
+               cache, firmware->desc, &valid);
+         info->firmware[i].optional = firmware->optional != 0;
       }
    }
 
-   return NULL;
+   info->core_file_id.hash             = record->core_file_id_hash;
+   info->savestate_support_level       = record->savestate_support_level;
+   info->has_info                      =
+         (record->flags & CORE_INFO_CACHE_FLAG_HAS_INFO) != 0;
+   info->supports_no_game              =
+         (record->flags & CORE_INFO_CACHE_FLAG_SUPPORTS_NO_GAME) != 0;
+   info->single_purpose                =
+         (record->flags & CORE_INFO_CACHE_FLAG_SINGLE_PURPOSE) != 0;
+   info->database_match_archive_member =
+         (record->flags & CORE_INFO_CACHE_FLAG_DATABASE_MATCH_ARCHIVE_MEMBER) != 0;
+   info->is_experimental               =
+         (record->flags & CORE_INFO_CACHE_FLAG_IS_EXPERIMENTAL) != 0;
+   info->is_installed                  = true;
 }
 
-static void core_info_cache_add(
-      core_info_cache_list_t *list, core_info_t *info,
-      bool transfer)
+/* Returns the index of the record of the
+ * specified core, or -1 if it isn't cached */
+static int core_info_cache_find(core_info_cache_t *cache,
+      const char *core_file_id)
 {
-   core_info_t *info_cache = NULL;
-
-   if (   !list
-       || !info
-       || (info->core_file_id.hash == 0)
-       || string_is_empty(info->core_file_id.str))
-      return;
+   size_t i;
+   uint32_t hash;
 
-   if (list->length >= list->capacity)
-   {
-      size_t prev_capacity   = list->capacity;
-      core_info_t *items_tmp = (core_info_t*)realloc(list->items,
-            (list->capacity << 1) * sizeof(core_info_t));
+   if (!cache || string_is_empty(core_file_id))
+      return -1;
 
-      if (!items_tmp)
-         return;
+   hash = core_info_hash_string(core_file_id);
 
-      list->capacity         = list->capacity << 1;
-      list->items            = items_tmp;
+   for (i = 0; i < cache->header.count; i++)
+   {
+      const core_info_cache_record_t *record = &cache->records[i];
 
-      memset(&list->items[prev_capacity], 0,
-            (list->capacity - prev_capacity) * sizeof(core_info_t));
+      if (     !cache->installed[i]
+            && (record->core_file_id_hash == hash)
+            && string_is_equal(cache->strings
+                  + record->strings[CORE_INFO_CACHE_CORE_FILE_ID],
+                  core_file_id))
+      {
+         cache->installed[i] = 1;
+         cache->installed_count++;
+         return (int)i;
+      }
    }
 
-   info_cache = (core_info_t*)&list->items[list->length];
-
-   if (transfer)
-      core_info_transfer(info, info_cache);
-   else
-      core_info_copy(info, info_cache);
-
-   list->length++;
+   return -1;
 }
 
 #ifdef HAVE_CORE_INFO_CACHE
-static core_info_cache_list_t *core_info_cache_list_new(void)
+static uint32_t core_info_cache_add_string(
+      core_info_cache_writer_t *writer, const char *str)
 {
-   core_info_cache_list_t *core_info_cache_list = 
-      (core_info_cache_list_t *)malloc(sizeof(*core_info_cache_list));
-   if (!core_info_cache_list)
-      return NULL;
+   size_t str_len;
+   uint32_t offset;
+
+   if (!str)
+      return CORE_INFO_CACHE_NULL;
+
+   if (RHMAP_HAS_STR(writer->offsets, str))
+      return RHMAP_GET_STR(writer->offsets, str);
 
-   core_info_cache_list->length = 0;
-   core_info_cache_list->items  = (core_info_t *)
-      calloc(CORE_INFO_CACHE_DEFAULT_CAPACITY,
-            sizeof(core_info_t));
+   str_len = strlen(str) + 1;
+   offset  = (uint32_t)RBUF_LEN(writer->strings);
 
-   if (!core_info_cache_list->items)
+   if (!RBUF_TRYFIT(writer->strings, offset + str_len))
    {
-      core_info_cache_list_free(core_info_cache_list);
-      return NULL;
+      writer->failed = true;
+      return CORE_INFO_CACHE_NULL;
    }
 
-   core_info_cache_list->capacity = CORE_INFO_CACHE_DEFAULT_CAPACITY;
-   core_info_cache_list->refresh  = false;
-   core_info_cache_list->version  = NULL;
+   RBUF_RESIZE(writer->strings, offset + str_len);
+   memcpy(writer->strings + offset, str, str_len);
+   RHMAP_SET_STR(writer->offsets, str, offset);
 
-   return core_info_cache_list;
+   return offset;
 }
 
-static core_info_cache_list_t *core_info_cache_read(const char *info_dir)
+/* Writes the cache from the cores of 'list'. The
+ * previous cache may still be mapped, so the new
+ * one replaces the file instead of truncating it */
+static bool core_info_cache_write(core_info_list_t *list, const char *info_dir)
 {
-   intfstream_t *file                           = NULL;
-   rjson_t *parser                              = NULL;
-   CCJSONContext context                        = {0};
-   core_info_cache_list_t *core_info_cache_list = NULL;
+   size_t i, j;
+   core_info_cache_header_t header;
+   core_info_cache_writer_t writer;
+   core_info_cache_record_t *records     = NULL;
+   core_info_cache_range_t *ranges       = NULL; /* RBUF */
+   uint32_t *elems                       = NULL; /* RBUF */
+   core_info_cache_firmware_t *firmware  = NULL; /* RBUF */
+   uint8_t *data                         = NULL;
+   size_t count                          = 0;
+   size_t data_size                      = 0;
+   bool success                          = false;
    char file_path[PATH_MAX_LENGTH];
+   char tmp_path[PATH_MAX_LENGTH];
 
-   /* Check whether a 'force refresh' file
-    * is present */
-   if (string_is_empty(info_dir))
-      strlcpy(file_path,
-            FILE_PATH_CORE_INFO_CACHE_REFRESH, sizeof(file_path));
-   else
-      fill_pathname_join_special(file_path,
-            info_dir, FILE_PATH_CORE_INFO_CACHE_REFRESH,
-            sizeof(file_path));
-
-   if (path_is_valid(file_path))
-      return core_info_cache_list_new();
-
-   /* Open info cache file */
-   if (string_is_empty(info_dir))
-      strlcpy(file_path, FILE_PATH_CORE_INFO_CACHE, sizeof(file_path));
-   else
-      fill_pathname_join_special(file_path, info_dir,
-            FILE_PATH_CORE_INFO_CACHE,
-            sizeof(file_path));
+   if (!list)
+      return false;
 
-#if defined(HAVE_ZLIB)
-   file = intfstream_open_rzip_file(file_path,
-         RETRO_VFS_FILE_ACCESS_READ);
-#else
-   file = intfstream_open_file(file_path,
-         RETRO_VFS_FILE_ACCESS_READ,
-         RETRO_VFS_FILE_ACCESS_HINT_NONE);
-#endif
+   writer.strings = NULL;
+   writer.offsets = NULL;
+   writer.failed  = false;
 
-   if (!file)
-      return core_info_cache_list_new();
+   if (list->count && !(records = (core_info_cache_record_t*)
+            calloc(list->count, sizeof(*records))))
+      return false;
 
-   /* Parse info cache file */
-   if (!(parser = rjson_open_stream(file)))
+   for (i = 0; i < list->count && !writer.failed; i++)
    {
-      RARCH_ERR("[Core Info] Failed to create JSON parser\n");
-      goto end;
-   }
+      core_info_t *info                = &list->list[i];
+      core_info_cache_record_t *record = &records[count];
 
-   rjson_set_options(parser,
-           RJSON_OPTION_ALLOW_UTF8BOM
-         | RJSON_OPTION_ALLOW_COMMENTS
-         | RJSON_OPTION_ALLOW_UNESCAPED_CONTROL_CHARACTERS
-         | RJSON_OPTION_REPLACE_INVALID_ENCODING);
-
-   if (rjson_parse(parser, &context,
-         CCJSONObjectMemberHandler,
-         CCJSONStringHandler,
-         CCJSONNumberHandler,
-         CCJSONStartObjectHandler,
-         CCJSONEndObjectHandler,
-         CCJSONStartArrayHandler,
-         CCJSONEndArrayHandler,
-         CCJSONBoolHandler,
-         NULL) /* Unused null handler */
-         != RJSON_DONE)
-   {
-      RARCH_WARN("[Core Info] Error parsing chunk:\n---snip---\n%.*s\n---snip---\n",
-            rjson_get_source_context_len(parser),
-            rjson_get_source_context_buf(parser));
-      RARCH_WARN("[Core Info] Error: Invalid JSON at line %d, column %d - %s.\n",
-            (int)rjson_get_source_line(parser),
-            (int)rjson_get_source_column(parser),
-            (*rjson_get_error(parser) 
-             ? rjson_get_error(parser) 
-             : "format error"));
-
-      /* Info cache is corrupt - discard it */
-      core_info_cache_list_free(context.core_info_cache_list);
-      core_info_cache_list = core_info_cache_list_new();
-   }
-   else
-      core_info_cache_list = context.core_info_cache_list;
-
-   rjson_free(parser);
+      if (     !info->is_installed
+            || string_is_empty(info->core_file_id.str))
+         continue;
 
-   /* Clean up leftovers in the event of
-    * a parsing error */
-   if (context.core_info)
-   {
-      core_info_free(context.core_info);
-      free(context.core_info);
-   }
+      for (j = 0; j < CORE_INFO_CACHE_STRING_LAST; j++)
+         record->strings[j] = core_info_cache_add_string(&writer,
+               *core_info_cache_string_ptr(info, (unsigned)j));
 
-   if (!core_info_cache_list)
-      goto end;
+      for (j = 0; j < CORE_INFO_CACHE_LIST_LAST; j++)
+      {
+         size_t k;
+         core_info_cache_range_t range;
+         const struct string_list *str_list =
+               *core_info_cache_list_ptr(info, (unsigned)j);
 
-   /* If info cache file has the wrong version
-    * number, discard it */
-   if (    string_is_empty(core_info_cache_list->version)
-       || !string_is_equal(core_info_cache_list->version,
-            CORE_INFO_CACHE_VERSION))
-   {
-      RARCH_WARN("[Core Info] Core info cache has invalid version"
-            " - forcing refresh (required v%s, found v%s)\n",
-            CORE_INFO_CACHE_VERSION,
-            core_info_cache_list->version);
+         record->lists[j] = CORE_INFO_CACHE_NULL;
 
-      core_info_cache_list_free(context.core_info_cache_list);
-      core_info_cache_list = core_info_cache_list_new();
-   }
+         if (!str_list)
+            continue;
 
-end:
-   intfstream_close(file);
-   free(file);
+         range.first = (uint32_t)RBUF_LEN(elems);
+         range.count = (uint32_t)str_list->size;
 
-   return core_info_cache_list;
-}
-#endif
+         for (k = 0; k < str_list->size; k++)
+         {
+            uint32_t offset = core_info_cache_add_string(&writer,
+                  str_list->elems[k].data ? str_list->elems[k].data : "");
+            if (!RBUF_TRYFIT(elems, RBUF_LEN(elems) + 1))
+               writer.failed = true;
+            else
+               RBUF_PUSH(elems, offset);
+         }
 
-static bool core_info_cache_write(core_info_cache_list_t *list, const char *info_dir)
-{
-   intfstream_t *file    = NULL;
-   rjsonwriter_t *writer = NULL;
-   bool success          = false;
-   char file_path[PATH_MAX_LENGTH];
-   size_t i, j;
+         if (!RBUF_TRYFIT(ranges, RBUF_LEN(ranges) + 1))
+            writer.failed = true;
+         else
+         {
+            record->lists[j] = (uint32_t)RBUF_LEN(ranges);
+            RBUF_PUSH(ranges, range);
+         }
+      }
 
-   if (!list)
-      return false;
+      record->firmware       = (uint32_t)RBUF_LEN(firmware);
+      record->firmware_count = (uint32_t)info->firmware_count;
 
-   /* Open info cache file */
-   if (string_is_empty(info_dir))
-      strlcpy(file_path, FILE_PATH_CORE_INFO_CACHE, sizeof(file_path));
-   else
-      fill_pathname_join_special(file_path, info_dir,
-            FILE_PATH_CORE_INFO_CACHE,
-            sizeof(file_path));
+      for (j = 0; j < info->firmware_count; j++)
+      {
+         core_info_cache_firmware_t fw;
+
+         fw.path     = core_info_cache_add_string(&writer,
+               info->firmware[j].path);
+         fw.desc     = core_info_cache_add_string(&writer,
+               info->firmware[j].desc);
+         fw.optional = info->firmware[j].optional ? 1 : 0;
+         fw.reserved = 0;
+
+         if (!RBUF_TRYFIT(firmware, RBUF_LEN(firmware) + 1))
+            writer.failed = true;
+         else
+            RBUF_PUSH(firmware, fw);
+      }
 
-#if defined(CORE_INFO_CACHE_COMPRESS)
-   file = intfstream_open_rzip_file(file_path,
-         RETRO_VFS_FILE_ACCESS_WRITE);
-#else
-   file = intfstream_open_file(file_path,
-         RETRO_VFS_FILE_ACCESS_WRITE,
-         RETRO_VFS_FILE_ACCESS_HINT_NONE);
-#endif
+      record->core_file_id_hash       = info->core_file_id.hash;
+      record->savestate_support_level = info->savestate_support_level;
+      record->flags                   = 0;
+      if (info->has_info)
+         record->flags |= CORE_INFO_CACHE_FLAG_HAS_INFO;
+      if (info->supports_no_game)
+         record->flags |= CORE_INFO_CACHE_FLAG_SUPPORTS_NO_GAME;
+      if (info->single_purpose)
+         record->flags |= CORE_INFO_CACHE_FLAG_SINGLE_PURPOSE;
+      if (info->database_match_archive_member)
+         record->flags |= CORE_INFO_CACHE_FLAG_DATABASE_MATCH_ARCHIVE_MEMBER;
+      if (info->is_experimental)
+         record->flags |= CORE_INFO_CACHE_FLAG_IS_EXPERIMENTAL;
 
-   if (!file)
-   {
-      RARCH_ERR("[Core Info] Failed to write to core info cache file: %s\n", file_path);
-      return false;
+      count++;
    }
 
-   /* Write info cache */
-   if (!(writer = rjsonwriter_open_stream(file)))
+   if (writer.failed || RBUF_LEN(writer.strings) >= CORE_INFO_CACHE_NULL)
    {
-      RARCH_ERR("[Core Info] Failed to create JSON writer\n");
+      RARCH_ERR("[Core Info] Ran out of memory while building core info cache\n");
       goto end;
    }
 
-#if defined(CORE_INFO_CACHE_COMPRESS)
-   /* When compressing info cache, human readability
-    * is not a factor - can skip all indentation
-    * and new line characters */
-   rjsonwriter_set_options(writer, RJSONWRITER_OPTION_SKIP_WHITESPACE);
-#endif
+   memset(&header, 0, sizeof(header));
+   header.magic          = CORE_INFO_CACHE_MAGIC;
+   header.version        = CORE_INFO_CACHE_VERSION;
+   header.count          = (uint32_t)count;
+   header.list_count     = (uint32_t)RBUF_LEN(ranges);
+   header.elem_count     = (uint32_t)RBUF_LEN(elems);
+   header.firmware_count = (uint32_t)RBUF_LEN(firmware);
+   header.strings_size   = (uint32_t)RBUF_LEN(writer.strings);
 
-   rjsonwriter_raw(writer, "{", 1);
-   rjsonwriter_raw(writer, "\n", 1);
-   rjsonwriter_add_spaces(writer, 2);
-   rjsonwriter_add_string(writer, "version");
-   rjsonwriter_raw(writer, ":", 1);
-   rjsonwriter_raw(writer, " ", 1);
-   rjsonwriter_add_string(writer, CORE_INFO_CACHE_VERSION);
-   rjsonwriter_raw(writer, ",", 1);
-   rjsonwriter_raw(writer, "\n", 1);
-   rjsonwriter_add_spaces(writer, 2);
-   rjsonwriter_add_string(writer, "items");
-   rjsonwriter_raw(writer, ":", 1);
-   rjsonwriter_raw(writer, " ", 1);
-   rjsonwriter_raw(writer, "[", 1);
-   rjsonwriter_raw(writer, "\n", 1);
-
-   for (i = 0; i < list->length; i++)
-   {
-      core_info_t* info = &list->items[i];
-
-      if (!info || !info->is_installed)
-         continue;
+   data_size = sizeof(header)
+         + header.count          * sizeof(*records)
+         + header.list_count     * sizeof(*ranges)
+         + header.elem_count     * sizeof(*elems)
+         + header.firmware_count * sizeof(*firmware)
+         + header.strings_size;
 
-      if (i > 0)
-      {
-         rjsonwriter_raw(writer, ",", 1);
-         rjsonwriter_raw(writer, "\n", 1);
-      }
+   if (!(data = (uint8_t*)malloc(data_size)))
+      goto end;
 
-      rjsonwriter_add_spaces(writer, 4);
-      rjsonwriter_raw(writer, "{", 1);
-      rjsonwriter_raw(writer, "\n", 1);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "display_name");
-      rjsonwriter_raw(writer, ":", 1);
-      rjsonwriter_raw(writer, " ", 1);
-      rjsonwriter_add_string(writer, info->display_name);
-      rjsonwriter_raw(writer, ",", 1);
-      rjsonwriter_raw(writer, "\n", 1);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "display_version");
-      rjsonwriter_raw(writer, ":", 1);
-      rjsonwriter_raw(writer, " ", 1);
-      rjsonwriter_add_string(writer, info->display_version);
-      rjsonwriter_raw(writer, ",", 1);
-      rjsonwriter_raw(writer, "\n", 1);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "core_name");
-      rjsonwriter_raw(writer, ":", 1);
-      rjsonwriter_raw(writer, " ", 1);
-      rjsonwriter_add_string(writer, info->core_name);
-      rjsonwriter_raw(writer, ",", 1);
-      rjsonwriter_raw(writer, "\n", 1);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "system_manufacturer");
-      rjsonwriter_raw(writer, ":", 1);
-      rjsonwriter_raw(writer, " ", 1);
-      rjsonwriter_add_string(writer, info->system_manufacturer);
-      rjsonwriter_raw(writer, ",", 1);
-      rjsonwriter_raw(writer, "\n", 1);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "systemname");
-      rjsonwriter_raw(writer, ":", 1);
-      rjsonwriter_raw(writer, " ", 1);
-      rjsonwriter_add_string(writer, info->systemname);
-      rjsonwriter_raw(writer, ",", 1);
-      rjsonwriter_raw(writer, "\n", 1);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "system_id");
-      rjsonwriter_raw(writer, ":", 1);
-      rjsonwriter_raw(writer, " ", 1);
-      rjsonwriter_add_string(writer, info->system_id);
-      rjsonwriter_raw(writer, ",", 1);
-      rjsonwriter_raw(writer, "\n", 1);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "supported_extensions");
-      rjsonwriter_raw(writer, ":", 1);
-      rjsonwriter_raw(writer, " ", 1);
-      rjsonwriter_add_string(writer, info->supported_extensions);
-      rjsonwriter_raw(writer, ",", 1);
-      rjsonwriter_raw(writer, "\n", 1);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "authors");
-      rjsonwriter_raw(writer, ":", 1);
-      rjsonwriter_raw(writer, " ", 1);
-      rjsonwriter_add_string(writer, info->authors);
-      rjsonwriter_raw(writer, ",", 1);
-      rjsonwriter_raw(writer, "\n", 1);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "permissions");
-      rjsonwriter_raw(writer, ":", 1);
-      rjsonwriter_raw(writer, " ", 1);
-      rjsonwriter_add_string(writer, info->permissions);
-      rjsonwriter_raw(writer, ",", 1);
-      rjsonwriter_raw(writer, "\n", 1);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "licenses");
-      rjsonwriter_raw(writer, ":", 1);
-      rjsonwriter_raw(writer, " ", 1);
-      rjsonwriter_add_string(writer, info->licenses);
-      rjsonwriter_raw(writer, ",", 1);
-      rjsonwriter_raw(writer, "\n", 1);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "categories");
-      rjsonwriter_raw(writer, ":", 1);
-      rjsonwriter_raw(writer, " ", 1);
-      rjsonwriter_add_string(writer, info->categories);
-      rjsonwriter_raw(writer, ",", 1);
-      rjsonwriter_raw(writer, "\n", 1);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "databases");
-      rjsonwriter_raw(writer, ":", 1);
-      rjsonwriter_raw(writer, " ", 1);
-      rjsonwriter_add_string(writer, info->databases);
-      rjsonwriter_raw(writer, ",", 1);
-      rjsonwriter_raw(writer, "\n", 1);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "notes");
-      rjsonwriter_raw(writer, ":", 1);
-      rjsonwriter_raw(writer, " ", 1);
-      rjsonwriter_add_string(writer, info->notes);
-      rjsonwriter_raw(writer, ",", 1);
-      rjsonwriter_raw(writer, "\n", 1);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "required_hw_api");
-      rjsonwriter_raw(writer, ":", 1);
-      rjsonwriter_raw(writer, " ", 1);
-      rjsonwriter_add_string(writer, info->required_hw_api);
-      rjsonwriter_raw(writer, ",", 1);
-      rjsonwriter_raw(writer, "\n", 1);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "description");
-      rjsonwriter_raw(writer, ":", 1);
-      rjsonwriter_raw(writer, " ", 1);
-      rjsonwriter_add_string(writer, info->description);
-      rjsonwriter_raw(writer, ",", 1);
-      rjsonwriter_raw(writer, "\n", 1);
-
-      if (info->firmware_count > 0)
-      {
-         rjsonwriter_add_spaces(writer, 6);
-         rjsonwriter_add_string(writer, "firmware");
-         rjsonwriter_raw(writer, ":", 1);
-         rjsonwriter_raw(writer, " ", 1);
-         rjsonwriter_raw(writer, "[", 1);
-         rjsonwriter_raw(writer, "\n", 1);
-
-         for (j = 0; j < info->firmware_count; j++)
-         {
-            rjsonwriter_add_spaces(writer, 8);
-            rjsonwriter_raw(writer, "{", 1);
-            rjsonwriter_raw(writer, "\n", 1);
-            rjsonwriter_add_spaces(writer, 10);
-            rjsonwriter_add_string(writer, "path");
-            rjsonwriter_raw(writer, ":", 1);
-            rjsonwriter_raw(writer, " ", 1);
-            rjsonwriter_add_string(writer, info->firmware[j].path);
-            rjsonwriter_raw(writer, ",", 1);
-            rjsonwriter_raw(writer, "\n", 1);
-            rjsonwriter_add_spaces(writer, 10);
-            rjsonwriter_add_string(writer, "desc");
-            rjsonwriter_raw(writer, ":", 1);
-            rjsonwriter_raw(writer, " ", 1);
-            rjsonwriter_add_string(writer, info->firmware[j].desc);
-            rjsonwriter_raw(writer, ",", 1);
-            rjsonwriter_raw(writer, "\n", 1);
-            rjsonwriter_add_spaces(writer, 10);
-            rjsonwriter_add_string(writer, "optional");
-            rjsonwriter_raw(writer, ":", 1);
-            rjsonwriter_raw(writer, " ", 1);
-            {
-               bool value = info->firmware[j].optional;
-               rjsonwriter_raw(writer, (value ? "true" : "false"), (value ? 4 : 5));
-            }
-            rjsonwriter_raw(writer, "\n", 1);
-            rjsonwriter_add_spaces(writer, 8);
-            rjsonwriter_raw(writer, "}", 1);
-
-            if (j < info->firmware_count - 1)
-               rjsonwriter_raw(writer, ",", 1);
-
-            rjsonwriter_raw(writer, "\n", 1);
-         }
+   {
+      uint8_t *out = data + sizeof(header);
 
-         rjsonwriter_add_spaces(writer, 6);
-         rjsonwriter_raw(writer, "]", 1);
-         rjsonwriter_raw(writer, ",", 1);
-         rjsonwriter_raw(writer, "\n", 1);
-      }
+      memcpy(out, records,  header.count          * sizeof(*records));
+      out += header.count          * sizeof(*records);
+      if (header.list_count)
+         memcpy(out, ranges,   header.list_count     * sizeof(*ranges));
+      out += header.list_count     * sizeof(*ranges);
+      if (header.elem_count)
+         memcpy(out, elems,    header.elem_count     * sizeof(*elems));
+      out += header.elem_count     * sizeof(*elems);
+      if (header.firmware_count)
+         memcpy(out, firmware, header.firmware_count * sizeof(*firmware));
+      out += header.firmware_count * sizeof(*firmware);
+      if (header.strings_size)
+         memcpy(out, writer.strings, header.strings_size);
+   }
 
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "core_file_id");
-      rjsonwriter_raw(writer, ":", 1);
-      rjsonwriter_raw(writer, "\n", 1);
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_raw(writer, "{", 1);
-      rjsonwriter_raw(writer, "\n", 1);
-      rjsonwriter_add_spaces(writer, 8);
-      rjsonwriter_add_string(writer, "str");
-      rjsonwriter_raw(writer, ":", 1);
-      rjsonwriter_raw(writer, " ", 1);
-      rjsonwriter_add_string(writer, info->core_file_id.str);
-      rjsonwriter_raw(writer, ",", 1);
-      rjsonwriter_raw(writer, "\n", 1);
-      rjsonwriter_add_spaces(writer, 8);
-      rjsonwriter_add_string(writer, "hash");
-      rjsonwriter_raw(writer, ":", 1);
-      rjsonwriter_raw(writer, " ", 1);
-      rjsonwriter_rawf(writer, "%u", info->core_file_id.hash);
-      rjsonwriter_raw(writer, "\n", 1);
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_raw(writer, "}", 1);
-      rjsonwriter_raw(writer, ",", 1);
-      rjsonwriter_raw(writer, "\n", 1);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "firmware_count");
-      rjsonwriter_raw(writer, ":", 1);
-      rjsonwriter_raw(writer, " ", 1);
-      rjsonwriter_rawf(writer, "%u", info->firmware_count);
-      rjsonwriter_raw(writer, ",", 1);
-      rjsonwriter_raw(writer, "\n", 1);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "savestate_support_level");
-      rjsonwriter_raw(writer, ":", 1);
-      rjsonwriter_raw(writer, " ", 1);
-      rjsonwriter_rawf(writer, "%u", info->savestate_support_level);
-      rjsonwriter_raw(writer, ",", 1);
-      rjsonwriter_raw(writer, "\n", 1);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "has_info");
-      rjsonwriter_raw(writer, ":", 1);
-      rjsonwriter_raw(writer, " ", 1);
-      {
-         bool value = info->has_info;
-         rjsonwriter_raw(writer, (value ? "true" : "false"), (value ? 4 : 5));
-      }
-      rjsonwriter_raw(writer, ",", 1);
-      rjsonwriter_raw(writer, "\n", 1);
+   header.crc = encoding_crc32(0, data + sizeof(header),
+         data_size - sizeof(header));
+   memcpy(data, &header, sizeof(header));
 
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "supports_no_game");
-      rjsonwriter_raw(writer, ":", 1);
-      rjsonwriter_raw(writer, " ", 1);
-      {
-         bool value = info->supports_no_game;
-         rjsonwriter_raw(writer, (value ? "true" : "false"), (value ? 4 : 5));
-      }
-      rjsonwriter_raw(writer, ",", 1);
-      rjsonwriter_raw(writer, "\n", 1);
+   core_info_cache_get_path(info_dir,
+         FILE_PATH_CORE_INFO_CACHE, file_path, sizeof(file_path));
+   strlcpy(tmp_path, file_path, sizeof(tmp_path));
+   strlcat(tmp_path, ".tmp",    sizeof(tmp_path));
 
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "single_purpose");
-      rjsonwriter_raw(writer, ":", 1);
-      rjsonwriter_raw(writer, " ", 1);
-      {
-         bool value = info->single_purpose;
-         rjsonwriter_raw(writer, (value ? "true" : "false"), (value ? 4 : 5));
-      }
-      rjsonwriter_raw(writer, ",", 1);
-      rjsonwriter_raw(writer, "\n", 1);
-
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "database_match_archive_member");
-      rjsonwriter_raw(writer, ":", 1);
-      rjsonwriter_raw(writer, " ", 1);
-      {
-         bool value = info->database_match_archive_member;
-         rjsonwriter_raw(writer, (value ? "true" : "false"), (value ? 4 : 5));
-      }
-      rjsonwriter_raw(writer, ",", 1);
-      rjsonwriter_raw(writer, "\n", 1);
+   if (!filestream_write_file(tmp_path, data, (int64_t)data_size))
+   {
+      RARCH_ERR("[Core Info] Failed to write to core info cache file: %s\n", file_path);
+      goto end;
+   }
 
-      rjsonwriter_add_spaces(writer, 6);
-      rjsonwriter_add_string(writer, "is_experimental");
-      rjsonwriter_raw(writer, ":", 1);
-      rjsonwriter_raw(writer, " ", 1);
+   if (filestream_rename(tmp_path, file_path) != 0)
+   {
+      /* Platforms that cannot rename over an existing file */
+      filestream_delete(file_path);
+      if (filestream_rename(tmp_path, file_path) != 0)
       {
-         bool value = info->is_experimental;
-         rjsonwriter_raw(writer, (value ? "true" : "false"), (value ? 4 : 5));
+         filestream_delete(tmp_path);
+         RARCH_ERR("[Core Info] Failed to write to core info cache file: %s\n", file_path);
+         goto end;
       }
-      rjsonwriter_raw(writer, "\n", 1);
-
-      rjsonwriter_add_spaces(writer, 4);
-      rjsonwriter_raw(writer, "}", 1);
    }
 
-   rjsonwriter_raw(writer, "\n", 1);
-   rjsonwriter_add_spaces(writer, 2);
-   rjsonwriter_raw(writer, "]", 1);
-   rjsonwriter_raw(writer, "\n", 1);
-   rjsonwriter_raw(writer, "}", 1);
-   rjsonwriter_raw(writer, "\n", 1);
-   rjsonwriter_free(writer);
-
    RARCH_LOG("[Core Info] Wrote to cache file: %s\n", file_path);
    success = true;
 
    /* Remove 'force refresh' file, if required */
-   if (string_is_empty(info_dir))
-      strlcpy(file_path,
-            FILE_PATH_CORE_INFO_CACHE_REFRESH, sizeof(file_path));
-   else
-      fill_pathname_join_special(file_path,
-            info_dir, FILE_PATH_CORE_INFO_CACHE_REFRESH,
-            sizeof(file_path));
+   core_info_cache_get_path(info_dir,
+         FILE_PATH_CORE_INFO_CACHE_REFRESH, file_path, sizeof(file_path));
 
    if (path_is_valid(file_path))
       filestream_delete(file_path);
 
 end:
-   intfstream_close(file);
-   free(file);
-
-   list->refresh = false;
+   free(data);
+   free(records);
+   RBUF_FREE(ranges);
+   RBUF_FREE(elems);
+   RBUF_FREE(firmware);
+   RBUF_FREE(writer.strings);
+   RHMAP_FREE(writer.offsets);
    return success;
 }
-
-static void core_info_check_uninstalled(core_info_cache_list_t *list)
-{
-   size_t i;
-
-   if (!list)
-      return;
-
-   for (i = 0; i < list->length; i++)
-   {
-      core_info_t *info = (core_info_t *)&list->items[i];
-
-      if (!info)
-         continue;
-
-      if (!info->is_installed)
-      {
-         list->refresh = true;
-         return;
-      }
-   }
-}
+#endif
 
 /* When called, generates a temporary file
  * that will force an info cache refresh the
@@ -1909,34 +1560,31 @@ static void core_info_list_resolve_all_extensions(
 #endif
 }
 
-static void core_info_free(core_info_t* info)
+/* Frees all data of 'info' that is not
+ * part of 'cache' */
+static void core_info_free(core_info_t* info,
+      const core_info_cache_t *cache)
 {
    size_t i;
 
    free(info->path);
-   free(info->core_name);
-   free(info->systemname);
-   free(info->system_id);
-   free(info->system_manufacturer);
-   free(info->display_name);
-   free(info->display_version);
-   free(info->supported_extensions);
-   free(info->authors);
-   free(info->permissions);
-   free(info->licenses);
-   free(info->categories);
-   free(info->databases);
-   free(info->notes);
-   free(info->required_hw_api);
-   free(info->description);
-   string_list_free(info->supported_extensions_list);
-   string_list_free(info->authors_list);
-   string_list_free(info->note_list);
-   string_list_free(info->permissions_list);
-   string_list_free(info->licenses_list);
-   string_list_free(info->categories_list);
-   string_list_free(info->databases_list);
-   string_list_free(info->required_hw_api_list);
+
+   for (i = 0; i < CORE_INFO_CACHE_STRING_LAST; i++)
+   {
+      char *str = *core_info_cache_string_ptr(info, (unsigned)i);
+      if (!core_info_cache_owns(cache, str))
+         free(str);
+   }
+
+   for (i = 0; i < CORE_INFO_CACHE_LIST_LAST; i++)
+   {
+      struct string_list *list = *core_info_cache_list_ptr(info, (unsigned)i);
+      if (!core_info_cache_owns(cache, list))
+         string_list_free(list);
+   }
+
+   if (core_info_cache_owns(cache, info->firmware))
+      return;
 
    for (i = 0; i < info->firmware_count; i++)
    {
@@ -1948,8 +1596,6 @@ static void core_info_free(core_info_t* info)
       info->firmware[i].desc = NULL;
    }
    free(info->firmware);
-
-   free(info->core_file_id.str);
 }
 
 static void core_info_list_free(core_info_list_t *core_info_list)
@@ -1962,9 +1608,10 @@ static void core_info_list_free(core_info_list_t *core_info_list)
    for (i = 0; i < core_info_list->count; i++)
    {
       core_info_t *info = (core_info_t*)&core_info_list->list[i];
-      core_info_free(info);
+      core_info_free(info, core_info_list->cache);
    }
 
+   core_info_cache_free(core_info_list->cache);
    free(core_info_list->all_ext);
    free(core_info_list->list);
    free(core_info_list);
@@ -1980,7 +1627,10 @@ static core_info_list_t *core_info_list_new(const char *path,
    size_t i;
    core_info_t *core_info                       = NULL;
    core_info_list_t *core_info_list             = NULL;
-   core_info_cache_list_t *core_info_cache_list = NULL;
+   core_info_cache_t *cache                     = NULL;
+#ifdef HAVE_CORE_INFO_CACHE
+   bool cache_refresh                           = false;
+#endif
    const char *info_dir                         = libretro_info_dir;
    core_path_list_t *path_list                  = core_info_path_list_new(
          path, exts, dir_show_hidden_files);
@@ -1994,6 +1644,7 @@ static core_info_list_t *core_info_list_new(const char *path,
    core_info_list->count      = 0;
    core_info_list->info_count = 0;
    core_info_list->all_ext    = NULL;
+   core_info_list->cache      = NULL;
 
    if (!(core_info = (core_info_t*)calloc(path_list->core_list->size,
          sizeof(*core_info))))
@@ -2006,12 +1657,14 @@ static core_info_list_t *core_info_list_new(const char *path,
    core_info_list->count = path_list->core_list->size;
 
 #ifdef HAVE_CORE_INFO_CACHE
-   /* Read core info cache, if enabled */
+   /* Read core info cache, if enabled
+    * > Owned by the list from here on, since
+    *   cached cores point into it */
    if (enable_cache)
    {
-      core_info_cache_list = core_info_cache_read(info_dir);
-      if (!core_info_cache_list)
-         goto error;
+      cache                 = core_info_cache_read(info_dir);
+      core_info_list->cache = cache;
+      cache_refresh         = !cache;
    }
 #endif
 
@@ -2030,20 +1683,17 @@ static core_info_list_t *core_info_list_new(const char *path,
 
       /* If info cache is available, search for
        * current core */
-      if (core_info_cache_list)
+      if (cache)
       {
-         core_info_t *info_cache = core_info_cache_find(
-               core_info_cache_list, core_file_id);
+         int idx = core_info_cache_find(cache, core_file_id);
 
-         if (info_cache)
+         if (idx >= 0)
          {
-            core_info_copy(info_cache, info);
+            core_info_cache_resolve(cache, (size_t)idx, info);
 
             /* Core path is 'dynamic', and cannot
              * be cached (i.e. core directory may
              * change between runs) */
-            if (info->path)
-               free(info->path);
             info->path = strdup(base_path);
 
             /* Core lock status is 'dynamic', and
@@ -2103,15 +1753,13 @@ static core_info_list_t *core_info_list_new(const char *path,
 
       info->is_installed = true;
 
+#ifdef HAVE_CORE_INFO_CACHE
       /* If info cache is enabled and we reach this
        * point, current core is uncached
-       * > Add it to the list, and trigger a cache
-       *   refresh */
-      if (core_info_cache_list)
-      {
-         core_info_cache_add(core_info_cache_list, info, false);
-         core_info_cache_list->refresh = true;
-      }
+       * > Trigger a cache refresh */
+      if (enable_cache)
+         cache_refresh = true;
+#endif
    }
 
    core_info_list_resolve_all_extensions(core_info_list);
@@ -2123,16 +1771,17 @@ static core_info_list_t *core_info_list_new(const char *path,
     * > Write new cache to disk if updates are
     *   required */
    *cache_supported = true;
-   if (core_info_cache_list)
+#ifdef HAVE_CORE_INFO_CACHE
+   if (enable_cache)
    {
-      core_info_check_uninstalled(core_info_cache_list);
+      if (cache && cache->installed_count < cache->header.count)
+         cache_refresh = true;
 
-      if (core_info_cache_list->refresh)
+      if (cache_refresh)
          *cache_supported = core_info_cache_write(
-               core_info_cache_list, info_dir);
-
-      core_info_cache_list_free(core_info_cache_list);
+               core_info_list, info_dir);
    }
+#endif
 
    core_info_path_list_free(path_list);
    return core_info_list;
@@ -122,10 +122,15 @@ typedef struct
    bool is_experimental;
 } core_updater_info_t;
 
+typedef struct core_info_cache core_info_cache_t;
+
 typedef struct
 {
    core_info_t *list;
    char *all_ext;
+   /* Cache the cores were loaded from, their
+    * strings point into it */
+   core_info_cache_t *cache;
    size_t count;
    size_t info_count;
 } core_info_list_t;
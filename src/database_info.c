@@ -30,6 +30,16 @@
 #include "core_info.h"
 #include "database_info.h"
 
+/* The database itself is only open while the index is built
+ * and while records are read for a lookup that has a match,
+ * as a scan keeps an index of every database around. */
+struct database_info_index
+{
+   libretrodb_t *db;
+   libretrodb_key_index_t *idx;
+   char *rdb_path;
+};
+
 int database_info_build_query_enum(char *s, size_t len,
       enum database_query_type type,
       const char *path)
@@ -466,30 +476,23 @@ char *bin_to_hex_alloc(const uint8_t *data, size_t len)
    return ret;
 }
 
-static int database_cursor_iterate(libretrodb_cursor_t *cur,
+static int database_info_parse_item(struct rmsgpack_dom_value *item,
       database_info_t *db_info)
 {
    unsigned i;
-   struct rmsgpack_dom_value item;
    const char* str                = NULL;
 
-   if (libretrodb_cursor_read_item(cur, &item) != 0)
-      return -1;
-
-   if (item.type != RDT_MAP)
-   {
-      rmsgpack_dom_value_free(&item);
+   if (item->type != RDT_MAP)
       return 1;
-   }
 
    db_info->analog_supported       = -1;
    db_info->rumble_supported       = -1;
    db_info->coop_supported         = -1;
 
-   for (i = 0; i < item.val.map.len; i++)
+   for (i = 0; i < item->val.map.len; i++)
    {
-      struct rmsgpack_dom_value *key = &item.val.map.items[i].key;
-      struct rmsgpack_dom_value *val = &item.val.map.items[i].value;
+      struct rmsgpack_dom_value *key = &item->val.map.items[i].key;
+      struct rmsgpack_dom_value *val = &item->val.map.items[i].value;
       const char *val_string         = NULL;
 
       if (!key || !val)
@@ -706,9 +709,22 @@ static int database_cursor_iterate(libretrodb_cursor_t *cur,
                (uint8_t*)val->val.binary.buff, val->val.binary.len);
    }
 
+   return 0;
+}
+
+static int database_cursor_iterate(libretrodb_cursor_t *cur,
+      database_info_t *db_info)
+{
+   int ret;
+   struct rmsgpack_dom_value item;
+
+   if (libretrodb_cursor_read_item(cur, &item) != 0)
+      return -1;
+
+   ret = database_info_parse_item(&item, db_info);
    rmsgpack_dom_value_free(&item);
 
-   return 0;
+   return ret;
 }
 
 static int database_cursor_open(libretrodb_t *db,
@@ -833,6 +849,94 @@ void database_info_free(database_info_handle_t *db)
       string_list_free(db->list);
 }
 
+static void database_info_entry_free(database_info_t *info)
+{
+   if (info->name)
+      free(info->name);
+   if (info->rom_name)
+      free(info->rom_name);
+   if (info->serial)
+      free(info->serial);
+   if (info->genre)
+      free(info->genre);
+   if (info->category)
+      free(info->category);
+   if (info->language)
+      free(info->language);
+   if (info->region)
+      free(info->region);
+   if (info->score)
+      free(info->score);
+   if (info->media)
+      free(info->media);
+   if (info->controls)
+      free(info->controls);
+   if (info->artstyle)
+      free(info->artstyle);
+   if (info->gameplay)
+      free(info->gameplay);
+   if (info->narrative)
+      free(info->narrative);
+   if (info->pacing)
+      free(info->pacing);
+   if (info->perspective)
+      free(info->perspective);
+   if (info->setting)
+      free(info->setting);
+   if (info->visual)
+      free(info->visual);
+   if (info->vehicular)
+      free(info->vehicular);
+   if (info->description)
+      free(info->description);
+   if (info->publisher)
+      free(info->publisher);
+   if (info->developer)
+      string_list_free(info->developer);
+   if (info->origin)
+      free(info->origin);
+   if (info->franchise)
+      free(info->franchise);
+   if (info->edge_magazine_review)
+      free(info->edge_magazine_review);
+
+   if (info->cero_rating)
+      free(info->cero_rating);
+   if (info->pegi_rating)
+      free(info->pegi_rating);
+   if (info->enhancement_hw)
+      free(info->enhancement_hw);
+   if (info->elspa_rating)
+      free(info->elspa_rating);
+   if (info->esrb_rating)
+      free(info->esrb_rating);
+   if (info->bbfc_rating)
+      free(info->bbfc_rating);
+   if (info->sha1)
+      free(info->sha1);
+   if (info->md5)
+      free(info->md5);
+
+   info->name                 = NULL;
+   info->rom_name             = NULL;
+   info->serial               = NULL;
+   info->genre                = NULL;
+   info->description          = NULL;
+   info->publisher            = NULL;
+   info->developer            = NULL;
+   info->origin               = NULL;
+   info->franchise            = NULL;
+   info->edge_magazine_review = NULL;
+   info->cero_rating          = NULL;
+   info->pegi_rating          = NULL;
+   info->enhancement_hw       = NULL;
+   info->elspa_rating         = NULL;
+   info->esrb_rating          = NULL;
+   info->bbfc_rating          = NULL; 
+   info->sha1                 = NULL;
+   info->md5                  = NULL;
+}
+
 database_info_list_t *database_info_list_new(
       const char *rdb_path, const char *query)
 {
@@ -871,88 +975,7 @@ database_info_list_t *database_info_list_new(
 
          if (!new_ptr)
          {
-            if (db_info.bbfc_rating)
-               free(db_info.bbfc_rating);
-            if (db_info.cero_rating)
-               free(db_info.cero_rating);
-            if (db_info.description)
-               free(db_info.description);
-            if (db_info.edge_magazine_review)
-               free(db_info.edge_magazine_review);
-            if (db_info.elspa_rating)
-               free(db_info.elspa_rating);
-            if (db_info.enhancement_hw)
-               free(db_info.enhancement_hw);
-            if (db_info.esrb_rating)
-               free(db_info.esrb_rating);
-            if (db_info.franchise)
-               free(db_info.franchise);
-            if (db_info.genre)
-               free(db_info.genre);
-            if (db_info.category)
-               free(db_info.category);
-            if (db_info.language)
-               free(db_info.language);
-            if (db_info.region)
-               free(db_info.region);
-            if (db_info.score)
-               free(db_info.score);
-            if (db_info.media)
-               free(db_info.media);
-            if (db_info.controls)
-               free(db_info.controls);
-            if (db_info.artstyle)
-               free(db_info.artstyle);
-            if (db_info.gameplay)
-               free(db_info.gameplay);
-            if (db_info.narrative)
-               free(db_info.narrative);
-            if (db_info.pacing)
-               free(db_info.pacing);
-            if (db_info.perspective)
-               free(db_info.perspective);
-            if (db_info.setting)
-               free(db_info.setting);
-            if (db_info.visual)
-               free(db_info.visual);
-            if (db_info.vehicular)
-               free(db_info.vehicular);
-            if (db_info.name)
-               free(db_info.name);
-            if (db_info.origin)
-               free(db_info.origin);
-            if (db_info.pegi_rating)
-               free(db_info.pegi_rating);
-            if (db_info.publisher)
-               free(db_info.publisher);
-            if (db_info.rom_name)
-               free(db_info.rom_name);
-            if (db_info.serial)
-               free(db_info.serial);
-            if (db_info.md5)
-               free(db_info.md5);
-            if (db_info.sha1)
-               free(db_info.sha1);
-
-            db_info.name                 = NULL;
-            db_info.rom_name             = NULL;
-            db_info.serial               = NULL;
-            db_info.genre                = NULL;
-            db_info.description          = NULL;
-            db_info.publisher            = NULL;
-            db_info.developer            = NULL;
-            db_info.origin               = NULL;
-            db_info.franchise            = NULL;
-            db_info.edge_magazine_review = NULL;
-            db_info.cero_rating          = NULL;
-            db_info.pegi_rating          = NULL;
-            db_info.enhancement_hw       = NULL;
-            db_info.elspa_rating         = NULL;
-            db_info.esrb_rating          = NULL;
-            db_info.bbfc_rating          = NULL; 
-            db_info.sha1                 = NULL;
-            db_info.md5                  = NULL;
-
+            database_info_entry_free(&db_info);
             database_info_list_free(database_info_list);
             free(database_info);
             free(database_info_list);
@@ -993,94 +1016,131 @@ void database_info_list_free(database_info_list_t *database_info_list)
       return;
 
    for (i = 0; i < database_info_list->count; i++)
+      database_info_entry_free(&database_info_list->list[i]);
+
+   free(database_info_list->list);
+}
+
+static bool database_info_index_open(database_info_index_t *index)
+{
+   if (!(index->db = libretrodb_new()))
+      return false;
+
+   if (libretrodb_open(index->rdb_path, index->db) != 0)
    {
-      database_info_t *info = &database_info_list->list[i];
-
-      if (info->name)
-         free(info->name);
-      if (info->rom_name)
-         free(info->rom_name);
-      if (info->serial)
-         free(info->serial);
-      if (info->genre)
-         free(info->genre);
-      if (info->category)
-         free(info->category);
-      if (info->language)
-         free(info->language);
-      if (info->region)
-         free(info->region);
-      if (info->score)
-         free(info->score);
-      if (info->media)
-         free(info->media);
-      if (info->controls)
-         free(info->controls);
-      if (info->artstyle)
-         free(info->artstyle);
-      if (info->gameplay)
-         free(info->gameplay);
-      if (info->narrative)
-         free(info->narrative);
-      if (info->pacing)
-         free(info->pacing);
-      if (info->perspective)
-         free(info->perspective);
-      if (info->setting)
-         free(info->setting);
-      if (info->visual)
-         free(info->visual);
-      if (info->vehicular)
-         free(info->vehicular);
-      if (info->description)
-         free(info->description);
-      if (info->publisher)
-         free(info->publisher);
-      if (info->developer)
-         string_list_free(info->developer);
-      if (info->origin)
-         free(info->origin);
-      if (info->franchise)
-         free(info->franchise);
-      if (info->edge_magazine_review)
-         free(info->edge_magazine_review);
-
-      if (info->cero_rating)
-         free(info->cero_rating);
-      if (info->pegi_rating)
-         free(info->pegi_rating);
-      if (info->enhancement_hw)
-         free(info->enhancement_hw);
-      if (info->elspa_rating)
-         free(info->elspa_rating);
-      if (info->esrb_rating)
-         free(info->esrb_rating);
-      if (info->bbfc_rating)
-         free(info->bbfc_rating);
-      if (info->sha1)
-         free(info->sha1);
-      if (info->md5)
-         free(info->md5);
-
-      info->name                 = NULL;
-      info->rom_name             = NULL;
-      info->serial               = NULL;
-      info->genre                = NULL;
-      info->description          = NULL;
-      info->publisher            = NULL;
-      info->developer            = NULL;
-      info->origin               = NULL;
-      info->franchise            = NULL;
-      info->edge_magazine_review = NULL;
-      info->cero_rating          = NULL;
-      info->pegi_rating          = NULL;
-      info->enhancement_hw       = NULL;
-      info->elspa_rating         = NULL;
-      info->esrb_rating          = NULL;
-      info->bbfc_rating          = NULL; 
-      info->sha1                 = NULL;
-      info->md5                  = NULL;
+      libretrodb_free(index->db);
+      index->db = NULL;
+      return false;
    }
 
-   free(database_info_list->list);
+   return true;
+}
+
+static void database_info_index_close(database_info_index_t *index)
+{
+   if (!index->db)
+      return;
+
+   libretrodb_close(index->db);
+   libretrodb_free(index->db);
+   index->db = NULL;
+}
+
+database_info_index_t *database_info_index_new(const char *rdb_path,
+      const char *field_name, const char *cache_dir)
+{
+   char cache_path[PATH_MAX_LENGTH];
+   database_info_index_t *index = (database_info_index_t*)
+      calloc(1, sizeof(*index));
+
+   if (!index)
+      return NULL;
+
+   cache_path[0] = '\0';
+
+   /* <cache_dir>/<database>.<field>.idx */
+   if (!string_is_empty(cache_dir))
+   {
+      char cache_name[NAME_MAX_LENGTH];
+      fill_pathname(cache_name, path_basename(rdb_path), "",
+            sizeof(cache_name));
+      path_remove_extension(cache_name);
+      strlcat(cache_name, ".", sizeof(cache_name));
+      strlcat(cache_name, field_name, sizeof(cache_name));
+      strlcat(cache_name, ".idx", sizeof(cache_name));
+      fill_pathname_join_special(cache_path, cache_dir, cache_name,
+            sizeof(cache_path));
+   }
+
+   if (!(index->rdb_path = strdup(rdb_path)))
+      goto error;
+
+   if (!database_info_index_open(index))
+      goto error;
+
+   index->idx = libretrodb_key_index_new(index->db, field_name,
+         string_is_empty(cache_path) ? NULL : cache_path);
+   database_info_index_close(index);
+
+   if (!index->idx)
+      goto error;
+
+   return index;
+
+error:
+   database_info_index_free(index);
+   return NULL;
+}
+
+void database_info_index_free(database_info_index_t *index)
+{
+   if (!index)
+      return;
+
+   libretrodb_key_index_free(index->idx);
+   database_info_index_close(index);
+   free(index->rdb_path);
+   free(index);
+}
+
+bool database_info_index_lookup(database_info_index_t *index,
+      const void *key, size_t len, database_info_list_t *list)
+{
+   size_t pos   = 0;
+   bool success = true;
+   struct rmsgpack_dom_value item;
+
+   if (!libretrodb_key_index_may_contain(index->idx, key, len))
+      return true;
+
+   /* Nothing to add if the database went away since */
+   if (!database_info_index_open(index))
+      return true;
+
+   while (libretrodb_key_index_find(index->db, index->idx,
+            key, len, &pos, &item) == 0)
+   {
+      database_info_t db_info  = {0};
+      database_info_t *new_ptr = NULL;
+      int ret                  = database_info_parse_item(&item, &db_info);
+
+      rmsgpack_dom_value_free(&item);
+
+      if (ret != 0)
+         continue;
+
+      if (!(new_ptr = (database_info_t*)realloc(list->list,
+                  (list->count + 1) * sizeof(database_info_t))))
+      {
+         database_info_entry_free(&db_info);
+         success = false;
+         break;
+      }
+
+      list->list = new_ptr;
+      memcpy(&list->list[list->count++], &db_info, sizeof(db_info));
+   }
+
+   database_info_index_close(index);
+   return success;
 }
@@ -136,9 +136,28 @@ typedef struct
    size_t count;
 } database_info_list_t;
 
+typedef struct database_info_index database_info_index_t;
+
 database_info_list_t *database_info_list_new(const char *rdb_path,
       const char *query);
 
+/* Opens @rdb_path and loads an index of @field_name
+ * ("crc", "serial", "name", ...) for it. The index is
+ * built with one pass over the database and cached in
+ * @cache_dir, if not NULL, for the following scans.
+ * The database is closed again once the index is built. */
+database_info_index_t *database_info_index_new(const char *rdb_path,
+      const char *field_name, const char *cache_dir);
+
+void database_info_index_free(database_info_index_t *index);
+
+/* Appends the entries whose indexed field equals @key
+ * to @list, opening the database only for as long as
+ * it takes to read them. Returns false on allocation
+ * failure. */
+bool database_info_index_lookup(database_info_index_t *index,
+      const void *key, size_t len, database_info_list_t *list);
+
 void database_info_list_free(database_info_list_t *list);
 
 database_info_handle_t *database_info_dir_init(const char *dir,
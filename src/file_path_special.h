@@ -48,6 +48,8 @@ RETRO_BEGIN_DECLS
 #define FILE_PATH_STATE_EXTENSION ".state"
 #define FILE_PATH_LPL_EXTENSION ".lpl"
 #define FILE_PATH_LPL_EXTENSION_NO_DOT "lpl"
+#define FILE_PATH_LPL_CACHE_EXTENSION ".lplc"
+#define FILE_PATH_JOURNAL_EXTENSION ".journal"
 #define FILE_PATH_PNG_EXTENSION ".png"
 #define FILE_PATH_MP3_EXTENSION ".mp3"
 #define FILE_PATH_FLAC_EXTENSION ".flac"
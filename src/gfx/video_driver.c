@@ -856,6 +856,8 @@ video_pixel_scaler_t *video_driver_pixel_converter_init(
          " and will be slower. For 15/16-bit, RGB565"
          " format is preferred.\n");
 
+   pixconv_init_simd();
+
    if (!(scalr = (video_pixel_scaler_t*)malloc(sizeof(*scalr))))
       goto error;
 
@@ -4017,6 +4019,8 @@ void video_driver_frame(const void *data, unsigned width,
       audio_stats.std_deviation_percentage   = 0.0f;
       audio_stats.close_to_underrun          = 0.0f;
       audio_stats.close_to_blocking          = 0.0f;
+      audio_stats.underruns                  = 0;
+      audio_stats.overruns                   = 0;
 
       video_monitor_fps_statistics(NULL, &stddev, NULL);
 
@@ -4052,7 +4056,7 @@ void video_driver_frame(const void *data, unsigned width,
             sizeof(video_info.stat_text),
             "Video Statistics:\n -Frame rate: %6.2f fps\n -Frame time: %6.2f ms\n -Frame time deviation: %.3f %%\n"
             " -Frame count: %" PRIu64"\n -Frame delay (target/effective): %u/%u ms\n%s -Viewport: %d x %d x %3.2f\n"
-            "Audio Statistics:\n -Average buffer saturation: %.2f %%\n -Standard deviation: %.2f %%\n -Time spent close to underrun: %.2f %%\n -Time spent close to blocking: %.2f %%\n -Sample count: %d\n"
+            "Audio Statistics:\n -Average buffer saturation: %.2f %%\n -Standard deviation: %.2f %%\n -Time spent close to underrun: %.2f %%\n -Time spent close to blocking: %.2f %%\n -Sample count: %d\n -Underruns/overruns: %u/%u\n"
             "Core Geometry:\n -Size: %u x %u\n -Max Size: %u x %u\n -Aspect: %3.2f\nCore Timing:\n -FPS: %3.2f\n -Sample Rate: %6.2f\n",
             last_fps,
             frame_time / 1000.0f,
@@ -4069,6 +4073,8 @@ void video_driver_frame(const void *data, unsigned width,
             audio_stats.close_to_underrun,
             audio_stats.close_to_blocking,
             audio_stats.samples,
+            audio_stats.underruns,
+            audio_stats.overruns,
             av_info->geometry.base_width,
             av_info->geometry.base_height,
             av_info->geometry.max_width,
@@ -57,54 +57,222 @@ struct rarch_softfilter
    enum retro_pixel_format pix_fmt, out_pix_fmt;
 
    struct softfilter_work_packet *packets;
+   unsigned num_packets;
    unsigned threads;
 
 #ifdef HAVE_THREADS
-   struct filter_thread_data *thread_data;
+   struct softfilter_pool *pool;
 #endif
 };
 
 #ifdef HAVE_THREADS
 #include <rthreads/rthreads.h>
 
-struct filter_thread_data
+/* Worker threads shared by every softfilter. Packets are handed
+ * out one at a time, so a filter can split a frame into more
+ * slices than there are threads, and the thread calling
+ * rarch_softfilter_process() works on them as well. */
+struct softfilter_pool
 {
-   sthread_t *thread;
-   const struct softfilter_work_packet *packet;
-   scond_t *cond;
+   sthread_t **threads;
+   slock_t *submit_lock;
    slock_t *lock;
+   scond_t *work_cond;
+   scond_t *done_cond;
+   const struct softfilter_work_packet *packets;
    void *userdata;
+   unsigned num_threads;
+   unsigned num_packets;
+   unsigned next_packet;
+   unsigned pending;
+   unsigned refcount;
    bool die;
-   bool done;
 };
 
-static void filter_thread_loop(void *data)
+static struct softfilter_pool *softfilter_pool = NULL;
+
+/* Runs packets until there are none left to hand out.
+ * Called with pool->lock held. */
+static void softfilter_pool_run(struct softfilter_pool *pool)
+{
+   while (pool->next_packet < pool->num_packets)
+   {
+      const struct softfilter_work_packet *packet =
+         &pool->packets[pool->next_packet++];
+      void *userdata = pool->userdata;
+
+      slock_unlock(pool->lock);
+      if (packet->work)
+         packet->work(userdata, packet->thread_data);
+      slock_lock(pool->lock);
+
+      if (--pool->pending == 0)
+         scond_signal(pool->done_cond);
+   }
+}
+
+static void softfilter_pool_loop(void *data)
 {
-   struct filter_thread_data *thr = (struct filter_thread_data*)data;
+   struct softfilter_pool *pool = (struct softfilter_pool*)data;
 
+   slock_lock(pool->lock);
    for (;;)
    {
-      bool die;
-      slock_lock(thr->lock);
-      while (thr->done && !thr->die)
-         scond_wait(thr->cond, thr->lock);
-      die = thr->die;
-      slock_unlock(thr->lock);
-
-      if (die)
+      while (!pool->die && pool->next_packet >= pool->num_packets)
+         scond_wait(pool->work_cond, pool->lock);
+
+      if (pool->die)
          break;
 
-      if (thr->packet && thr->packet->work)
-         thr->packet->work(thr->userdata, thr->packet->thread_data);
+      softfilter_pool_run(pool);
+   }
+   slock_unlock(pool->lock);
+}
+
+static void softfilter_pool_free(struct softfilter_pool *pool)
+{
+   unsigned i;
+
+   if (pool->lock)
+   {
+      slock_lock(pool->lock);
+      pool->die = true;
+      scond_broadcast(pool->work_cond);
+      slock_unlock(pool->lock);
+   }
+
+   for (i = 0; i < pool->num_threads; i++)
+      sthread_join(pool->threads[i]);
+   free(pool->threads);
+
+   if (pool->submit_lock)
+      slock_free(pool->submit_lock);
+   if (pool->lock)
+      slock_free(pool->lock);
+   if (pool->work_cond)
+      scond_free(pool->work_cond);
+   if (pool->done_cond)
+      scond_free(pool->done_cond);
+   free(pool);
+}
+
+/* Returns the shared pool with at least num_threads workers,
+ * creating it on first use. If threads can't be added, the
+ * packets run on the workers there are. */
+static struct softfilter_pool *softfilter_pool_acquire(unsigned num_threads)
+{
+   struct softfilter_pool *pool = softfilter_pool;
+
+   if (!pool)
+   {
+      if (!(pool = (struct softfilter_pool*)calloc(1, sizeof(*pool))))
+         return NULL;
+
+      pool->submit_lock = slock_new();
+      pool->lock        = slock_new();
+      pool->work_cond   = scond_new();
+      pool->done_cond   = scond_new();
 
-      slock_lock(thr->lock);
-      thr->done = true;
-      scond_signal(thr->cond);
-      slock_unlock(thr->lock);
+      if (     !pool->submit_lock || !pool->lock
+            || !pool->work_cond   || !pool->done_cond)
+      {
+         softfilter_pool_free(pool);
+         return NULL;
+      }
+
+      softfilter_pool = pool;
    }
+
+   if (num_threads > pool->num_threads)
+   {
+      sthread_t **threads = (sthread_t**)realloc(pool->threads,
+            num_threads * sizeof(*threads));
+
+      if (threads)
+      {
+         pool->threads = threads;
+         while (pool->num_threads < num_threads)
+         {
+            sthread_t *thread = sthread_create(softfilter_pool_loop, pool);
+            if (!thread)
+               break;
+            pool->threads[pool->num_threads++] = thread;
+         }
+      }
+   }
+
+   pool->refcount++;
+   return pool;
+}
+
+static void softfilter_pool_release(struct softfilter_pool *pool)
+{
+   if (--pool->refcount)
+      return;
+   softfilter_pool_free(pool);
+   softfilter_pool = NULL;
+}
+
+static void softfilter_pool_process(struct softfilter_pool *pool,
+      const struct softfilter_work_packet *packets, unsigned num_packets,
+      void *userdata)
+{
+   slock_lock(pool->submit_lock);
+   slock_lock(pool->lock);
+
+   pool->packets     = packets;
+   pool->userdata    = userdata;
+   pool->num_packets = num_packets;
+   pool->next_packet = 0;
+   pool->pending     = num_packets;
+   scond_broadcast(pool->work_cond);
+
+   softfilter_pool_run(pool);
+   while (pool->pending)
+      scond_wait(pool->done_cond, pool->lock);
+
+   slock_unlock(pool->lock);
+   slock_unlock(pool->submit_lock);
 }
 #endif
 
+/* Frames are split into slices whose input and output fit in
+ * roughly this much of a core's L2 cache... */
+#define SOFTFILTER_SLICE_BYTES    (256 * 1024)
+/* ...but no thinner than this many input rows, as filters
+ * read the rows at the edges of a slice twice. */
+#define SOFTFILTER_SLICE_MIN_ROWS 16
+
+static unsigned softfilter_num_slices(rarch_softfilter_t *filt,
+      unsigned threads)
+{
+   size_t bytes;
+   unsigned slices;
+   unsigned out_width  = 0;
+   unsigned out_height = 0;
+   unsigned max_slices = filt->max_height / SOFTFILTER_SLICE_MIN_ROWS;
+   size_t in_bpp       = filt->pix_fmt == RETRO_PIXEL_FORMAT_XRGB8888
+      ? 4 : 2;
+   size_t out_bpp      = filt->out_pix_fmt == RETRO_PIXEL_FORMAT_XRGB8888
+      ? 4 : 2;
+
+   rarch_softfilter_get_max_output_size(filt, &out_width, &out_height);
+
+   bytes  = (size_t)filt->max_width * filt->max_height * in_bpp
+          + (size_t)out_width * out_height * out_bpp;
+   slices = (unsigned)((bytes + SOFTFILTER_SLICE_BYTES - 1)
+         / SOFTFILTER_SLICE_BYTES);
+
+   /* Give every thread the same number of slices */
+   slices = ((slices + threads - 1) / threads) * threads;
+   if (slices > max_slices)
+      slices = max_slices;
+   if (slices < threads)
+      slices = threads;
+
+   return slices;
+}
+
 static const struct softfilter_implementation *
 softfilter_find_implementation(rarch_softfilter_t *filt, const char *ident)
 {
@@ -135,12 +303,10 @@ static bool create_softfilter_graph(rarch_softfilter_t *filt,
       softfilter_simd_mask_t cpu_features,
       unsigned threads)
 {
-   unsigned input_fmts, input_fmt, output_fmts, i = 0;
+   unsigned input_fmts, input_fmt, output_fmts, num_packets;
    struct config_file_userdata userdata;
    char key[64], name[64];
 
-   (void)i;
-
    key[0] = name[0] = '\0';
 
    snprintf(key, sizeof(key), "filter");
@@ -208,29 +374,65 @@ static bool create_softfilter_graph(rarch_softfilter_t *filt,
    filt->max_width = max_width;
    filt->max_height = max_height;
 
+   if (threads == RARCH_SOFTFILTER_THREADS_AUTO)
+      threads = cpu_features_get_core_amount();
+   if (!threads)
+      threads = 1;
+
    filt->impl_data = filt->impl->create(
          &softfilter_config, input_fmt, input_fmt, max_width, max_height,
-         threads != RARCH_SOFTFILTER_THREADS_AUTO ? threads :
-         cpu_features_get_core_amount(), cpu_features,
-         &userdata);
+         threads, cpu_features, &userdata);
    if (!filt->impl_data)
    {
       RARCH_ERR("Failed to create softfilter state.\n");
       return false;
    }
 
-   threads = filt->impl->query_num_threads(filt->impl_data);
-   if (!threads)
+   num_packets = filt->impl->query_num_threads(filt->impl_data);
+   if (!num_packets)
    {
       RARCH_ERR("Invalid number of threads.\n");
       return false;
    }
 
-   filt->threads = threads;
-   RARCH_LOG("Using %u threads for softfilter.\n", threads);
+   /* A filter that takes as many packets as it is offered can
+    * be split further, into slices that stay in cache. Since
+    * packets are handed out one at a time, more slices than
+    * threads also evens out the load between the threads. */
+   if (num_packets == threads)
+   {
+      unsigned slices = softfilter_num_slices(filt, threads);
+
+      if (slices > num_packets)
+      {
+         void *impl_data = filt->impl->create(
+               &softfilter_config, input_fmt, input_fmt,
+               max_width, max_height, slices, cpu_features, &userdata);
+
+         if (impl_data)
+         {
+            filt->impl->destroy(filt->impl_data);
+            filt->impl_data = impl_data;
+            num_packets     = filt->impl->query_num_threads(impl_data);
+            if (!num_packets)
+            {
+               RARCH_ERR("Invalid number of threads.\n");
+               return false;
+            }
+         }
+      }
+   }
+
+   if (threads > num_packets)
+      threads = num_packets;
+
+   filt->num_packets = num_packets;
+   filt->threads     = threads;
+   RARCH_LOG("Using %u threads and %u slices for softfilter.\n",
+         threads, num_packets);
 
    filt->packets = (struct softfilter_work_packet*)
-      calloc(threads, sizeof(*filt->packets));
+      calloc(num_packets, sizeof(*filt->packets));
    if (!filt->packets)
    {
       RARCH_ERR("Failed to allocate softfilter packets.\n");
@@ -238,29 +440,11 @@ static bool create_softfilter_graph(rarch_softfilter_t *filt,
    }
 
 #ifdef HAVE_THREADS
-   if (filt->threads > 1)
+   /* The calling thread is one of the workers */
+   if (threads > 1)
    {
-      filt->thread_data = (struct filter_thread_data*)
-         calloc(threads, sizeof(*filt->thread_data));
-      if (!filt->thread_data)
-         return false;
-
-      for (i = 0; i < threads; i++)
-      {
-         filt->thread_data[i].userdata = filt->impl_data;
-         filt->thread_data[i].done     = true;
-
-         filt->thread_data[i].lock     = slock_new();
-         if (!filt->thread_data[i].lock)
-            return false;
-         filt->thread_data[i].cond     = scond_new();
-         if (!filt->thread_data[i].cond)
-            return false;
-         filt->thread_data[i].thread   = sthread_create(
-               filter_thread_loop, &filt->thread_data[i]);
-         if (!filt->thread_data[i].thread)
-            return false;
-      }
+      if (!(filt->pool = softfilter_pool_acquire(threads - 1)))
+         RARCH_WARN("Failed to create softfilter threads.\n");
    }
 #endif
 
@@ -501,26 +685,12 @@ void rarch_softfilter_free(rarch_softfilter_t *filt)
       if (filt->plugs[i].lib)
          dylib_close(filt->plugs[i].lib);
    }
-   free(filt->plugs);
 #endif
+   free(filt->plugs);
 
 #ifdef HAVE_THREADS
-   if (filt->threads > 1)
-   {
-      for (i = 0; i < filt->threads; i++)
-      {
-         if (!filt->thread_data[i].thread)
-            continue;
-         slock_lock(filt->thread_data[i].lock);
-         filt->thread_data[i].die = true;
-         scond_signal(filt->thread_data[i].cond);
-         slock_unlock(filt->thread_data[i].lock);
-         sthread_join(filt->thread_data[i].thread);
-         slock_free(filt->thread_data[i].lock);
-         scond_free(filt->thread_data[i].cond);
-      }
-      free(filt->thread_data);
-   }
+   if (filt->pool)
+      softfilter_pool_release(filt->pool);
 #endif
 
    if (filt->conf)
@@ -566,36 +736,14 @@ void rarch_softfilter_process(rarch_softfilter_t *filt,
             output, output_stride, input, width, height, input_stride);
 
 #ifdef HAVE_THREADS
-   if (filt->threads > 1)
+   if (filt->pool)
    {
-      /* Fire off workers */
-      for (i = 0; i < filt->threads; i++)
-      {
-#if 0
-         RARCH_LOG("Firing off filter thread %u ...\n", i);
-#endif
-         filt->thread_data[i].packet = &filt->packets[i];
-         slock_lock(filt->thread_data[i].lock);
-         filt->thread_data[i].done = false;
-         scond_signal(filt->thread_data[i].cond);
-         slock_unlock(filt->thread_data[i].lock);
-      }
-
-      /* Wait for workers */
-      for (i = 0; i < filt->threads; i++)
-      {
-#if 0
-         RARCH_LOG("Waiting for filter thread %u ...\n", i);
-#endif
-         slock_lock(filt->thread_data[i].lock);
-         while (!filt->thread_data[i].done)
-            scond_wait(filt->thread_data[i].cond, filt->thread_data[i].lock);
-         slock_unlock(filt->thread_data[i].lock);
-      }
+      softfilter_pool_process(filt->pool, filt->packets,
+            filt->num_packets, filt->impl_data);
       return;
    }
 #endif
 
-   for (i = 0; i < filt->threads; i++)
+   for (i = 0; i < filt->num_packets; i++)
       filt->packets[i].work(filt->impl_data, filt->packets[i].thread_data);
 }
@@ -35,8 +35,8 @@ struct softfilter_thread_data
    unsigned colfmt;
    unsigned width;
    unsigned height;
-   int first;
-   int last;
+   unsigned y_start;
+   unsigned frame_height;
 };
 
 struct filter_data
@@ -76,7 +76,7 @@ static void *twoxsai_generic_create(const struct softfilter_config *config,
       return NULL;
    filt->workers = (struct softfilter_thread_data*)
       calloc(threads, sizeof(struct softfilter_thread_data));
-   filt->threads = 1;
+   filt->threads = threads;
    filt->in_fmt  = in_fmt;
    if (!filt->workers)
    {
@@ -118,12 +118,12 @@ static void twoxsai_generic_destroy(void *data)
 
 #define twoxsai_result(A, B, C, D) (((A) != (C) || (A) != (D)) - ((B) != (C) || (B) != (D)));
 
-#define twoxsai_declare_variables(typename_t, in, nextline) \
+#define twoxsai_declare_variables(typename_t, in, prevline, nextline, nextline2) \
          typename_t product, product1, product2; \
-         typename_t colorI = *(in - nextline - 1); \
-         typename_t colorE = *(in - nextline + 0); \
-         typename_t colorF = *(in - nextline + 1); \
-         typename_t colorJ = *(in - nextline + 2); \
+         typename_t colorI = *(in - prevline - 1); \
+         typename_t colorE = *(in - prevline + 0); \
+         typename_t colorF = *(in - prevline + 1); \
+         typename_t colorJ = *(in - prevline + 2); \
          typename_t colorG = *(in - 1); \
          typename_t colorA = *(in + 0); \
          typename_t colorB = *(in + 1); \
@@ -132,9 +132,9 @@ static void twoxsai_generic_destroy(void *data)
          typename_t colorC = *(in + nextline + 0); \
          typename_t colorD = *(in + nextline + 1); \
          typename_t colorL = *(in + nextline + 2); \
-         typename_t colorM = *(in + nextline + nextline - 1); \
-         typename_t colorN = *(in + nextline + nextline + 0); \
-         typename_t colorO = *(in + nextline + nextline + 1);
+         typename_t colorM = *(in + nextline2 - 1); \
+         typename_t colorN = *(in + nextline2 + 0); \
+         typename_t colorO = *(in + nextline2 + 1);
 
 #ifndef twoxsai_function
 #define twoxsai_function(result_cb, interpolate_cb, interpolate2_cb) \
@@ -225,20 +225,24 @@ static void twoxsai_generic_destroy(void *data)
 #endif
 
 static void twoxsai_generic_xrgb8888(unsigned width, unsigned height,
-      int first, int last, uint32_t *src,
+      unsigned y, unsigned frame_height, uint32_t *src,
       unsigned src_stride, uint32_t *dst, unsigned dst_stride)
 {
    unsigned finish;
-   unsigned nextline = (last) ? 0 : src_stride;
 
-   for (; height; height--)
+   for (; height; height--, y++)
    {
+      /* Offsets of the rows around this one, clamped to the frame */
+      unsigned prevline  = (y > 0) ? src_stride : 0;
+      unsigned nextline  = (y + 1 < frame_height) ? src_stride : 0;
+      unsigned nextline2 = (y + 2 < frame_height)
+         ? nextline + src_stride : nextline;
       uint32_t *in  = (uint32_t*)src;
       uint32_t *out = (uint32_t*)dst;
 
       for (finish = width; finish; finish -= 1)
       {
-         twoxsai_declare_variables(uint32_t, in, nextline);
+         twoxsai_declare_variables(uint32_t, in, prevline, nextline, nextline2);
 
          /*
           * Map of the pixels:           I|E F|J
@@ -257,20 +261,24 @@ static void twoxsai_generic_xrgb8888(unsigned width, unsigned height,
 }
 
 static void twoxsai_generic_rgb565(unsigned width, unsigned height,
-      int first, int last, uint16_t *src,
+      unsigned y, unsigned frame_height, uint16_t *src,
       unsigned src_stride, uint16_t *dst, unsigned dst_stride)
 {
    unsigned finish;
-   unsigned nextline = (last) ? 0 : src_stride;
 
-   for (; height; height--)
+   for (; height; height--, y++)
    {
+      /* Offsets of the rows around this one, clamped to the frame */
+      unsigned prevline  = (y > 0) ? src_stride : 0;
+      unsigned nextline  = (y + 1 < frame_height) ? src_stride : 0;
+      unsigned nextline2 = (y + 2 < frame_height)
+         ? nextline + src_stride : nextline;
       uint16_t *in  = (uint16_t*)src;
       uint16_t *out = (uint16_t*)dst;
 
       for (finish = width; finish; finish -= 1)
       {
-         twoxsai_declare_variables(uint16_t, in, nextline);
+         twoxsai_declare_variables(uint16_t, in, prevline, nextline, nextline2);
 
          /*
           * Map of the pixels:           I|E F|J
@@ -298,7 +306,7 @@ static void twoxsai_work_cb_rgb565(void *data, void *thread_data)
    unsigned height = thr->height;
 
    twoxsai_generic_rgb565(width, height,
-         thr->first, thr->last, input,
+         thr->y_start, thr->frame_height, input,
          (unsigned)(thr->in_pitch / SOFTFILTER_BPP_RGB565),
          output,
          (unsigned)(thr->out_pitch / SOFTFILTER_BPP_RGB565));
@@ -314,7 +322,7 @@ static void twoxsai_work_cb_xrgb8888(void *data, void *thread_data)
    unsigned height = thr->height;
 
    twoxsai_generic_xrgb8888(width, height,
-         thr->first, thr->last, input,
+         thr->y_start, thr->frame_height, input,
          (unsigned)(thr->in_pitch / SOFTFILTER_BPP_XRGB8888),
          output,
          (unsigned)(thr->out_pitch / SOFTFILTER_BPP_XRGB8888));
@@ -344,11 +352,10 @@ static void twoxsai_generic_packets(void *data,
       thr->width = width;
       thr->height = y_end - y_start;
 
-      /* Workers need to know if they can access pixels
-       * outside their given buffer.
-       */
-      thr->first = y_start;
-      thr->last = y_end == height;
+      /* Workers read up to two rows past their slice,
+       * and need to know where the frame ends. */
+      thr->y_start      = y_start;
+      thr->frame_height = height;
 
       if (filt->in_fmt == SOFTFILTER_FMT_RGB565)
          packets[i].work = twoxsai_work_cb_rgb565;
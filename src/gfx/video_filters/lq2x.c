@@ -17,6 +17,15 @@
 #include "softfilter.h"
 #include <stdlib.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define LQ2X_HAVE_NEON
+#include <arm_neon.h>
+#endif
+
 #ifdef RARCH_INTERNAL
 #define softfilter_get_implementation lq2x_get_implementation
 #define softfilter_thread_data lq2x_softfilter_thread_data
@@ -25,6 +34,15 @@
 
 #define LQ2X_SCALE 2
 
+/* Expands one row of pixels into two. The rows above and below
+ * are the row itself at the top and bottom of the frame. */
+typedef void (*lq2x_row_xrgb8888_t)(uint32_t *out0, uint32_t *out1,
+      const uint32_t *up, const uint32_t *src, const uint32_t *down,
+      unsigned width);
+typedef void (*lq2x_row_rgb565_t)(uint16_t *out0, uint16_t *out1,
+      const uint16_t *up, const uint16_t *src, const uint16_t *down,
+      unsigned width);
+
 struct softfilter_thread_data
 {
    void *out_data;
@@ -43,6 +61,8 @@ struct filter_data
    unsigned threads;
    struct softfilter_thread_data *workers;
    unsigned in_fmt;
+   lq2x_row_xrgb8888_t row_xrgb8888;
+   lq2x_row_rgb565_t row_rgb565;
 };
 
 static unsigned lq2x_generic_input_fmts(void)
@@ -61,26 +81,262 @@ static unsigned lq2x_generic_threads(void *data)
    return filt->threads;
 }
 
+/* Expands pixels [x, end) of a row, blending C halfway towards
+ * A or E where scale2x would pick them */
+#define LQ2X_PIXELS(typename_t, mask, out0, out1, up, src, down, x, end, width) \
+   for (; x < end; x++) \
+   { \
+      typename_t A = up[x]; \
+      typename_t B = (x > 0)         ? src[x - 1] : src[x]; \
+      typename_t C = src[x]; \
+      typename_t D = (x < width - 1) ? src[x + 1] : src[x]; \
+      typename_t E = down[x]; \
+      typename_t c = C; \
+      \
+      if (A != E && B != D) \
+      { \
+         out0[(x << 1)]     = (A == B ? ((C + A - ((C ^ A) & mask)) >> 1) : c); \
+         out0[(x << 1) + 1] = (A == D ? ((C + A - ((C ^ A) & mask)) >> 1) : c); \
+         out1[(x << 1)]     = (E == B ? ((C + E - ((C ^ E) & mask)) >> 1) : c); \
+         out1[(x << 1) + 1] = (E == D ? ((C + E - ((C ^ E) & mask)) >> 1) : c); \
+      } \
+      else \
+      { \
+         out0[(x << 1)]     = c; \
+         out0[(x << 1) + 1] = c; \
+         out1[(x << 1)]     = c; \
+         out1[(x << 1) + 1] = c; \
+      } \
+   }
+
+static void lq2x_row_xrgb8888(uint32_t *out0, uint32_t *out1,
+      const uint32_t *up, const uint32_t *src, const uint32_t *down,
+      unsigned width)
+{
+   unsigned x = 0;
+   LQ2X_PIXELS(uint32_t, 0x0421, out0, out1, up, src, down, x, width, width)
+}
+
+static void lq2x_row_rgb565(uint16_t *out0, uint16_t *out1,
+      const uint16_t *up, const uint16_t *src, const uint16_t *down,
+      unsigned width)
+{
+   unsigned x = 0;
+   LQ2X_PIXELS(uint16_t, 0x0821, out0, out1, up, src, down, x, width, width)
+}
+
+/* The SIMD rows do the first and last pixels the plain way.
+ *
+ * (C + A - ((C ^ A) & mask)) >> 1 is computed as
+ * (C & A) + (((C ^ A) & ~mask) >> 1), which can't overflow
+ * a lane. The plain XRGB8888 sum wraps at 32 bits before the
+ * shift, which only ever clears the top bit, so that is
+ * masked off to match. */
+
+#if defined(__SSE2__)
+/* (m & a) | (~m & b) */
+#define LQ2X_SELECT_SSE2(m, a, b) \
+   _mm_xor_si128(b, _mm_and_si128(m, _mm_xor_si128(a, b)))
+
+static void lq2x_row_xrgb8888_sse2(uint32_t *out0, uint32_t *out1,
+      const uint32_t *up, const uint32_t *src, const uint32_t *down,
+      unsigned width)
+{
+   unsigned x        = 0;
+   unsigned end      = 1;
+   const __m128i lsb = _mm_set1_epi32(0x0421);
+   const __m128i top = _mm_set1_epi32(0x7FFFFFFF);
+   LQ2X_PIXELS(uint32_t, 0x0421, out0, out1, up, src, down, x, end, width)
+
+   for (; x + 4 < width; x += 4)
+   {
+      __m128i A    = _mm_loadu_si128((const __m128i*)(up   + x));
+      __m128i B    = _mm_loadu_si128((const __m128i*)(src  + x - 1));
+      __m128i C    = _mm_loadu_si128((const __m128i*)(src  + x));
+      __m128i D    = _mm_loadu_si128((const __m128i*)(src  + x + 1));
+      __m128i E    = _mm_loadu_si128((const __m128i*)(down + x));
+      __m128i keep = _mm_or_si128(_mm_cmpeq_epi32(A, E),
+            _mm_cmpeq_epi32(B, D));
+      __m128i CA   = _mm_and_si128(top, _mm_add_epi32(_mm_and_si128(C, A),
+               _mm_srli_epi32(_mm_andnot_si128(lsb, _mm_xor_si128(C, A)), 1)));
+      __m128i CE   = _mm_and_si128(top, _mm_add_epi32(_mm_and_si128(C, E),
+               _mm_srli_epi32(_mm_andnot_si128(lsb, _mm_xor_si128(C, E)), 1)));
+      __m128i p0   = LQ2X_SELECT_SSE2(
+            _mm_andnot_si128(keep, _mm_cmpeq_epi32(A, B)), CA, C);
+      __m128i p1   = LQ2X_SELECT_SSE2(
+            _mm_andnot_si128(keep, _mm_cmpeq_epi32(A, D)), CA, C);
+      __m128i p2   = LQ2X_SELECT_SSE2(
+            _mm_andnot_si128(keep, _mm_cmpeq_epi32(E, B)), CE, C);
+      __m128i p3   = LQ2X_SELECT_SSE2(
+            _mm_andnot_si128(keep, _mm_cmpeq_epi32(E, D)), CE, C);
+
+      _mm_storeu_si128((__m128i*)(out0 + (x << 1)),
+            _mm_unpacklo_epi32(p0, p1));
+      _mm_storeu_si128((__m128i*)(out0 + (x << 1) + 4),
+            _mm_unpackhi_epi32(p0, p1));
+      _mm_storeu_si128((__m128i*)(out1 + (x << 1)),
+            _mm_unpacklo_epi32(p2, p3));
+      _mm_storeu_si128((__m128i*)(out1 + (x << 1) + 4),
+            _mm_unpackhi_epi32(p2, p3));
+   }
+
+   LQ2X_PIXELS(uint32_t, 0x0421, out0, out1, up, src, down, x, width, width)
+}
+
+static void lq2x_row_rgb565_sse2(uint16_t *out0, uint16_t *out1,
+      const uint16_t *up, const uint16_t *src, const uint16_t *down,
+      unsigned width)
+{
+   unsigned x        = 0;
+   unsigned end      = 1;
+   const __m128i lsb = _mm_set1_epi16(0x0821);
+   LQ2X_PIXELS(uint16_t, 0x0821, out0, out1, up, src, down, x, end, width)
+
+   for (; x + 8 < width; x += 8)
+   {
+      __m128i A    = _mm_loadu_si128((const __m128i*)(up   + x));
+      __m128i B    = _mm_loadu_si128((const __m128i*)(src  + x - 1));
+      __m128i C    = _mm_loadu_si128((const __m128i*)(src  + x));
+      __m128i D    = _mm_loadu_si128((const __m128i*)(src  + x + 1));
+      __m128i E    = _mm_loadu_si128((const __m128i*)(down + x));
+      __m128i keep = _mm_or_si128(_mm_cmpeq_epi16(A, E),
+            _mm_cmpeq_epi16(B, D));
+      __m128i CA   = _mm_add_epi16(_mm_and_si128(C, A),
+            _mm_srli_epi16(_mm_andnot_si128(lsb, _mm_xor_si128(C, A)), 1));
+      __m128i CE   = _mm_add_epi16(_mm_and_si128(C, E),
+            _mm_srli_epi16(_mm_andnot_si128(lsb, _mm_xor_si128(C, E)), 1));
+      __m128i p0   = LQ2X_SELECT_SSE2(
+            _mm_andnot_si128(keep, _mm_cmpeq_epi16(A, B)), CA, C);
+      __m128i p1   = LQ2X_SELECT_SSE2(
+            _mm_andnot_si128(keep, _mm_cmpeq_epi16(A, D)), CA, C);
+      __m128i p2   = LQ2X_SELECT_SSE2(
+            _mm_andnot_si128(keep, _mm_cmpeq_epi16(E, B)), CE, C);
+      __m128i p3   = LQ2X_SELECT_SSE2(
+            _mm_andnot_si128(keep, _mm_cmpeq_epi16(E, D)), CE, C);
+
+      _mm_storeu_si128((__m128i*)(out0 + (x << 1)),
+            _mm_unpacklo_epi16(p0, p1));
+      _mm_storeu_si128((__m128i*)(out0 + (x << 1) + 8),
+            _mm_unpackhi_epi16(p0, p1));
+      _mm_storeu_si128((__m128i*)(out1 + (x << 1)),
+            _mm_unpacklo_epi16(p2, p3));
+      _mm_storeu_si128((__m128i*)(out1 + (x << 1) + 8),
+            _mm_unpackhi_epi16(p2, p3));
+   }
+
+   LQ2X_PIXELS(uint16_t, 0x0821, out0, out1, up, src, down, x, width, width)
+}
+#endif
+
+#ifdef LQ2X_HAVE_NEON
+static void lq2x_row_xrgb8888_neon(uint32_t *out0, uint32_t *out1,
+      const uint32_t *up, const uint32_t *src, const uint32_t *down,
+      unsigned width)
+{
+   unsigned x           = 0;
+   unsigned end         = 1;
+   const uint32x4_t lsb = vdupq_n_u32(0x0421);
+   const uint32x4_t top = vdupq_n_u32(0x7FFFFFFF);
+   LQ2X_PIXELS(uint32_t, 0x0421, out0, out1, up, src, down, x, end, width)
+
+   for (; x + 4 < width; x += 4)
+   {
+      uint32x4x2_t row0, row1;
+      uint32x4_t A    = vld1q_u32(up   + x);
+      uint32x4_t B    = vld1q_u32(src  + x - 1);
+      uint32x4_t C    = vld1q_u32(src  + x);
+      uint32x4_t D    = vld1q_u32(src  + x + 1);
+      uint32x4_t E    = vld1q_u32(down + x);
+      uint32x4_t keep = vorrq_u32(vceqq_u32(A, E), vceqq_u32(B, D));
+      uint32x4_t CA   = vandq_u32(top, vaddq_u32(vandq_u32(C, A),
+               vshrq_n_u32(vbicq_u32(veorq_u32(C, A), lsb), 1)));
+      uint32x4_t CE   = vandq_u32(top, vaddq_u32(vandq_u32(C, E),
+               vshrq_n_u32(vbicq_u32(veorq_u32(C, E), lsb), 1)));
+
+      row0.val[0]     = vbslq_u32(vbicq_u32(vceqq_u32(A, B), keep), CA, C);
+      row0.val[1]     = vbslq_u32(vbicq_u32(vceqq_u32(A, D), keep), CA, C);
+      row1.val[0]     = vbslq_u32(vbicq_u32(vceqq_u32(E, B), keep), CE, C);
+      row1.val[1]     = vbslq_u32(vbicq_u32(vceqq_u32(E, D), keep), CE, C);
+
+      vst2q_u32(out0 + (x << 1), row0);
+      vst2q_u32(out1 + (x << 1), row1);
+   }
+
+   LQ2X_PIXELS(uint32_t, 0x0421, out0, out1, up, src, down, x, width, width)
+}
+
+static void lq2x_row_rgb565_neon(uint16_t *out0, uint16_t *out1,
+      const uint16_t *up, const uint16_t *src, const uint16_t *down,
+      unsigned width)
+{
+   unsigned x           = 0;
+   unsigned end         = 1;
+   const uint16x8_t lsb = vdupq_n_u16(0x0821);
+   LQ2X_PIXELS(uint16_t, 0x0821, out0, out1, up, src, down, x, end, width)
+
+   for (; x + 8 < width; x += 8)
+   {
+      uint16x8x2_t row0, row1;
+      uint16x8_t A    = vld1q_u16(up   + x);
+      uint16x8_t B    = vld1q_u16(src  + x - 1);
+      uint16x8_t C    = vld1q_u16(src  + x);
+      uint16x8_t D    = vld1q_u16(src  + x + 1);
+      uint16x8_t E    = vld1q_u16(down + x);
+      uint16x8_t keep = vorrq_u16(vceqq_u16(A, E), vceqq_u16(B, D));
+      uint16x8_t CA   = vaddq_u16(vandq_u16(C, A),
+            vshrq_n_u16(vbicq_u16(veorq_u16(C, A), lsb), 1));
+      uint16x8_t CE   = vaddq_u16(vandq_u16(C, E),
+            vshrq_n_u16(vbicq_u16(veorq_u16(C, E), lsb), 1));
+
+      row0.val[0]     = vbslq_u16(vbicq_u16(vceqq_u16(A, B), keep), CA, C);
+      row0.val[1]     = vbslq_u16(vbicq_u16(vceqq_u16(A, D), keep), CA, C);
+      row1.val[0]     = vbslq_u16(vbicq_u16(vceqq_u16(E, B), keep), CE, C);
+      row1.val[1]     = vbslq_u16(vbicq_u16(vceqq_u16(E, D), keep), CE, C);
+
+      vst2q_u16(out0 + (x << 1), row0);
+      vst2q_u16(out1 + (x << 1), row1);
+   }
+
+   LQ2X_PIXELS(uint16_t, 0x0821, out0, out1, up, src, down, x, width, width)
+}
+#endif
+
 static void *lq2x_generic_create(const struct softfilter_config *config,
       unsigned in_fmt, unsigned out_fmt,
       unsigned max_width, unsigned max_height,
       unsigned threads, softfilter_simd_mask_t simd, void *userdata)
 {
    struct filter_data *filt = (struct filter_data*)calloc(1, sizeof(*filt));
-   (void)simd;
    (void)config;
    (void)userdata;
    if (!filt)
       return NULL;
    filt->workers = (struct softfilter_thread_data*)
       calloc(threads, sizeof(struct softfilter_thread_data));
-   filt->threads = 1;
+   filt->threads = threads;
    filt->in_fmt  = in_fmt;
    if (!filt->workers)
    {
       free(filt);
       return NULL;
    }
+
+   filt->row_xrgb8888 = lq2x_row_xrgb8888;
+   filt->row_rgb565   = lq2x_row_rgb565;
+#if defined(__SSE2__)
+   if (simd & SOFTFILTER_SIMD_SSE2)
+   {
+      filt->row_xrgb8888 = lq2x_row_xrgb8888_sse2;
+      filt->row_rgb565   = lq2x_row_rgb565_sse2;
+   }
+#endif
+#ifdef LQ2X_HAVE_NEON
+   if (simd & SOFTFILTER_SIMD_NEON)
+   {
+      filt->row_xrgb8888 = lq2x_row_xrgb8888_neon;
+      filt->row_rgb565   = lq2x_row_rgb565_neon;
+   }
+#endif
    return filt;
 }
 
@@ -103,126 +359,58 @@ static void lq2x_generic_destroy(void *data)
    free(filt);
 }
 
-static void lq2x_generic_rgb565(unsigned width, unsigned height,
-      int first, int last, uint16_t *src,
-      unsigned src_stride, uint16_t *dst, unsigned dst_stride)
+static void lq2x_work_cb_rgb565(void *data, void *thread_data)
 {
-   unsigned x, y;
-   uint16_t *out0 = (uint16_t*)dst;
-   uint16_t *out1 = (uint16_t*)(dst + dst_stride);
+   struct filter_data *filt = (struct filter_data*)data;
+   struct softfilter_thread_data *thr =
+      (struct softfilter_thread_data*)thread_data;
+   size_t in_stride         = thr->in_pitch / SOFTFILTER_BPP_RGB565;
+   size_t out_stride        = thr->out_pitch / SOFTFILTER_BPP_RGB565;
+   const uint16_t *input    = (const uint16_t*)thr->in_data;
+   uint16_t *output         = (uint16_t*)thr->out_data;
+   unsigned y;
 
-   for (y = 0; y < height; y++)
+   for (y = 0; y < thr->height; y++)
    {
-      int prevline = (y == 0 ? 0 : src_stride);
-      int nextline = (y == height - 1 || last) ? 0 : src_stride;
-
-      for (x = 0; x < width; x++)
-      {
-         uint16_t A = *(src - prevline);
-         uint16_t B = (x > 0) ? *(src - 1) : *src;
-         uint16_t C = *src;
-         uint16_t D = (x < width - 1) ? *(src + 1) : *src;
-         uint16_t E = *(src++ + nextline);
-         uint16_t c = C;
-
-         if (A != E && B != D)
-         {
-            *out0++ = (A == B ? ((C + A - ((C ^ A) & 0x0821)) >> 1) : c);
-            *out0++ = (A == D ? ((C + A - ((C ^ A) & 0x0821)) >> 1) : c);
-            *out1++ = (E == B ? ((C + E - ((C ^ E) & 0x0821)) >> 1) : c);
-            *out1++ = (E == D ? ((C + E - ((C ^ E) & 0x0821)) >> 1) : c);
-         }
-         else
-         {
-            *out0++ = c;
-            *out0++ = c;
-            *out1++ = c;
-            *out1++ = c;
-         }
-      }
-
-      src  += src_stride - width;
-      out0 += dst_stride + dst_stride - (width << 1);
-      out1 += dst_stride + dst_stride - (width << 1);
+      /* Rows at the edges of a slice read the neighbouring
+       * slices; only the edges of the frame are clamped */
+      const uint16_t *up   = (y == 0 && thr->first)
+         ? input : input - in_stride;
+      const uint16_t *down = (y == thr->height - 1 && thr->last)
+         ? input : input + in_stride;
+
+      filt->row_rgb565(output, output + out_stride,
+            up, input, down, thr->width);
+
+      input  += in_stride;
+      output += out_stride * LQ2X_SCALE;
    }
 }
 
-static void lq2x_generic_xrgb8888(unsigned width, unsigned height,
-      int first, int last, uint32_t *src,
-      unsigned src_stride, uint32_t *dst, unsigned dst_stride)
+static void lq2x_work_cb_xrgb8888(void *data, void *thread_data)
 {
-   unsigned x, y;
-   uint32_t *out0 = (uint32_t*)dst;
-   uint32_t *out1 = (uint32_t*)(dst + dst_stride);
+   struct filter_data *filt = (struct filter_data*)data;
+   struct softfilter_thread_data *thr =
+      (struct softfilter_thread_data*)thread_data;
+   size_t in_stride         = thr->in_pitch / SOFTFILTER_BPP_XRGB8888;
+   size_t out_stride        = thr->out_pitch / SOFTFILTER_BPP_XRGB8888;
+   const uint32_t *input    = (const uint32_t*)thr->in_data;
+   uint32_t *output         = (uint32_t*)thr->out_data;
+   unsigned y;
 
-   for (y = 0; y < height; y++)
+   for (y = 0; y < thr->height; y++)
    {
-      int prevline = (y == 0 ? 0 : src_stride);
-      int nextline = (y == height - 1 || last) ? 0 : src_stride;
-
-      for (x = 0; x < width; x++)
-      {
-         uint32_t A = *(src - prevline);
-         uint32_t B = (x > 0) ? *(src - 1) : *src;
-         uint32_t C = *src;
-         uint32_t D = (x < width - 1) ? *(src + 1) : *src;
-         uint32_t E = *(src++ + nextline);
-         uint32_t c = C;
-
-         if (A != E && B != D)
-         {
-            *out0++ = (A == B ? (C + A - ((C ^ A) & 0x0421)) >> 1 : c);
-            *out0++ = (A == D ? (C + A - ((C ^ A) & 0x0421)) >> 1 : c);
-            *out1++ = (E == B ? (C + E - ((C ^ E) & 0x0421)) >> 1 : c);
-            *out1++ = (E == D ? (C + E - ((C ^ E) & 0x0421)) >> 1 : c);
-         }
-         else
-         {
-            *out0++ = c;
-            *out0++ = c;
-            *out1++ = c;
-            *out1++ = c;
-         }
-      }
-
-      src += src_stride - width;
-      out0 += dst_stride + dst_stride - (width << 1);
-      out1 += dst_stride + dst_stride - (width << 1);
-   }
-}
+      const uint32_t *up   = (y == 0 && thr->first)
+         ? input : input - in_stride;
+      const uint32_t *down = (y == thr->height - 1 && thr->last)
+         ? input : input + in_stride;
 
-static void lq2x_work_cb_rgb565(void *data, void *thread_data)
-{
-   struct softfilter_thread_data *thr =
-      (struct softfilter_thread_data*)thread_data;
-   uint16_t *input = (uint16_t*)thr->in_data;
-   uint16_t *output = (uint16_t*)thr->out_data;
-   unsigned width = thr->width;
-   unsigned height = thr->height;
-
-   lq2x_generic_rgb565(width, height,
-         thr->first, thr->last, input,
-         (unsigned)(thr->in_pitch / SOFTFILTER_BPP_RGB565),
-         output,
-         (unsigned)(thr->out_pitch / SOFTFILTER_BPP_RGB565));
-}
+      filt->row_xrgb8888(output, output + out_stride,
+            up, input, down, thr->width);
 
-static void lq2x_work_cb_xrgb8888(void *data, void *thread_data)
-{
-   struct softfilter_thread_data *thr =
-      (struct softfilter_thread_data*)thread_data;
-   uint32_t *input = (uint32_t*)thr->in_data;
-   uint32_t *output = (uint32_t*)thr->out_data;
-   unsigned width = thr->width;
-   unsigned height = thr->height;
-
-   (void)data;
-
-   lq2x_generic_xrgb8888(width, height,
-         thr->first, thr->last, input,
-         (unsigned)(thr->in_pitch / SOFTFILTER_BPP_XRGB8888),
-         output,
-         (unsigned)(thr->out_pitch / SOFTFILTER_BPP_XRGB8888));
+      input  += in_stride;
+      output += out_stride * LQ2X_SCALE;
+   }
 }
 
 static void lq2x_generic_packets(void *data,
@@ -249,7 +437,7 @@ static void lq2x_generic_packets(void *data,
 
       /* Workers need to know if they can access pixels
        * outside their given buffer. */
-      thr->first = y_start;
+      thr->first = y_start == 0;
       thr->last = y_end == height;
 
       if (filt->in_fmt == SOFTFILTER_FMT_RGB565)
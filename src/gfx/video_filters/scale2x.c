@@ -20,12 +20,30 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define SCALE2X_HAVE_NEON
+#include <arm_neon.h>
+#endif
+
 #ifdef RARCH_INTERNAL
 #define softfilter_get_implementation scale2x_get_implementation
 #define softfilter_thread_data scale2x_softfilter_thread_data
 #define filter_data scale2x_filter_data
 #endif
 
+/* Expands one row of pixels into two. The rows above and below
+ * are the row itself at the top and bottom of the frame. */
+typedef void (*scale2x_row_xrgb8888_t)(uint32_t *out0, uint32_t *out1,
+      const uint32_t *up, const uint32_t *src, const uint32_t *down,
+      unsigned width);
+typedef void (*scale2x_row_rgb565_t)(uint16_t *out0, uint16_t *out1,
+      const uint16_t *up, const uint16_t *src, const uint16_t *down,
+      unsigned width);
+
 struct softfilter_thread_data
 {
    void *out_data;
@@ -44,6 +62,8 @@ struct filter_data
    unsigned threads;
    struct softfilter_thread_data *workers;
    unsigned in_fmt;
+   scale2x_row_xrgb8888_t row_xrgb8888;
+   scale2x_row_rgb565_t row_rgb565;
 };
 
 static unsigned scale2x_generic_input_fmts(void)
@@ -62,28 +82,236 @@ static unsigned scale2x_generic_threads(void *data)
    return filt->threads;
 }
 
+/* Expands pixels [x, end) of a row */
+#define SCALE2X_PIXELS(typename_t, out0, out1, up, src, down, x, end, width) \
+   for (; x < end; x++) \
+   { \
+      /* Get sample points */ \
+      typename_t A = up[x]; \
+      typename_t B = (x > 0)         ? src[x - 1] : src[x]; \
+      typename_t C = src[x]; \
+      typename_t D = (x < width - 1) ? src[x + 1] : src[x]; \
+      typename_t E = down[x]; \
+      \
+      /* Apply pixel expansion algorithm */ \
+      if (A != E && B != D) \
+      { \
+         out0[(x << 1)]     = (A == B ? A : C); \
+         out0[(x << 1) + 1] = (A == D ? A : C); \
+         out1[(x << 1)]     = (E == B ? E : C); \
+         out1[(x << 1) + 1] = (E == D ? E : C); \
+      } \
+      else \
+      { \
+         out0[(x << 1)]     = C; \
+         out0[(x << 1) + 1] = C; \
+         out1[(x << 1)]     = C; \
+         out1[(x << 1) + 1] = C; \
+      } \
+   }
+
+static void scale2x_row_xrgb8888(uint32_t *out0, uint32_t *out1,
+      const uint32_t *up, const uint32_t *src, const uint32_t *down,
+      unsigned width)
+{
+   unsigned x = 0;
+   SCALE2X_PIXELS(uint32_t, out0, out1, up, src, down, x, width, width)
+}
+
+static void scale2x_row_rgb565(uint16_t *out0, uint16_t *out1,
+      const uint16_t *up, const uint16_t *src, const uint16_t *down,
+      unsigned width)
+{
+   unsigned x = 0;
+   SCALE2X_PIXELS(uint16_t, out0, out1, up, src, down, x, width, width)
+}
+
+/* The SIMD rows do the first and last pixels, whose left or
+ * right neighbour is clamped, the plain way. In between, lanes
+ * where A == E or B == D keep C in all four outputs, and the
+ * others pick A or E where they match B or D. */
+
+#if defined(__SSE2__)
+/* (mask & a) | (~mask & b) */
+#define SCALE2X_SELECT_SSE2(mask, a, b) \
+   _mm_xor_si128(b, _mm_and_si128(mask, _mm_xor_si128(a, b)))
+
+static void scale2x_row_xrgb8888_sse2(uint32_t *out0, uint32_t *out1,
+      const uint32_t *up, const uint32_t *src, const uint32_t *down,
+      unsigned width)
+{
+   unsigned x   = 0;
+   unsigned end = 1;
+   SCALE2X_PIXELS(uint32_t, out0, out1, up, src, down, x, end, width)
+
+   for (; x + 4 < width; x += 4)
+   {
+      __m128i A    = _mm_loadu_si128((const __m128i*)(up   + x));
+      __m128i B    = _mm_loadu_si128((const __m128i*)(src  + x - 1));
+      __m128i C    = _mm_loadu_si128((const __m128i*)(src  + x));
+      __m128i D    = _mm_loadu_si128((const __m128i*)(src  + x + 1));
+      __m128i E    = _mm_loadu_si128((const __m128i*)(down + x));
+      __m128i keep = _mm_or_si128(_mm_cmpeq_epi32(A, E),
+            _mm_cmpeq_epi32(B, D));
+      __m128i p0   = SCALE2X_SELECT_SSE2(
+            _mm_andnot_si128(keep, _mm_cmpeq_epi32(A, B)), A, C);
+      __m128i p1   = SCALE2X_SELECT_SSE2(
+            _mm_andnot_si128(keep, _mm_cmpeq_epi32(A, D)), A, C);
+      __m128i p2   = SCALE2X_SELECT_SSE2(
+            _mm_andnot_si128(keep, _mm_cmpeq_epi32(E, B)), E, C);
+      __m128i p3   = SCALE2X_SELECT_SSE2(
+            _mm_andnot_si128(keep, _mm_cmpeq_epi32(E, D)), E, C);
+
+      _mm_storeu_si128((__m128i*)(out0 + (x << 1)),
+            _mm_unpacklo_epi32(p0, p1));
+      _mm_storeu_si128((__m128i*)(out0 + (x << 1) + 4),
+            _mm_unpackhi_epi32(p0, p1));
+      _mm_storeu_si128((__m128i*)(out1 + (x << 1)),
+            _mm_unpacklo_epi32(p2, p3));
+      _mm_storeu_si128((__m128i*)(out1 + (x << 1) + 4),
+            _mm_unpackhi_epi32(p2, p3));
+   }
+
+   SCALE2X_PIXELS(uint32_t, out0, out1, up, src, down, x, width, width)
+}
+
+static void scale2x_row_rgb565_sse2(uint16_t *out0, uint16_t *out1,
+      const uint16_t *up, const uint16_t *src, const uint16_t *down,
+      unsigned width)
+{
+   unsigned x   = 0;
+   unsigned end = 1;
+   SCALE2X_PIXELS(uint16_t, out0, out1, up, src, down, x, end, width)
+
+   for (; x + 8 < width; x += 8)
+   {
+      __m128i A    = _mm_loadu_si128((const __m128i*)(up   + x));
+      __m128i B    = _mm_loadu_si128((const __m128i*)(src  + x - 1));
+      __m128i C    = _mm_loadu_si128((const __m128i*)(src  + x));
+      __m128i D    = _mm_loadu_si128((const __m128i*)(src  + x + 1));
+      __m128i E    = _mm_loadu_si128((const __m128i*)(down + x));
+      __m128i keep = _mm_or_si128(_mm_cmpeq_epi16(A, E),
+            _mm_cmpeq_epi16(B, D));
+      __m128i p0   = SCALE2X_SELECT_SSE2(
+            _mm_andnot_si128(keep, _mm_cmpeq_epi16(A, B)), A, C);
+      __m128i p1   = SCALE2X_SELECT_SSE2(
+            _mm_andnot_si128(keep, _mm_cmpeq_epi16(A, D)), A, C);
+      __m128i p2   = SCALE2X_SELECT_SSE2(
+            _mm_andnot_si128(keep, _mm_cmpeq_epi16(E, B)), E, C);
+      __m128i p3   = SCALE2X_SELECT_SSE2(
+            _mm_andnot_si128(keep, _mm_cmpeq_epi16(E, D)), E, C);
+
+      _mm_storeu_si128((__m128i*)(out0 + (x << 1)),
+            _mm_unpacklo_epi16(p0, p1));
+      _mm_storeu_si128((__m128i*)(out0 + (x << 1) + 8),
+            _mm_unpackhi_epi16(p0, p1));
+      _mm_storeu_si128((__m128i*)(out1 + (x << 1)),
+            _mm_unpacklo_epi16(p2, p3));
+      _mm_storeu_si128((__m128i*)(out1 + (x << 1) + 8),
+            _mm_unpackhi_epi16(p2, p3));
+   }
+
+   SCALE2X_PIXELS(uint16_t, out0, out1, up, src, down, x, width, width)
+}
+#endif
+
+#ifdef SCALE2X_HAVE_NEON
+static void scale2x_row_xrgb8888_neon(uint32_t *out0, uint32_t *out1,
+      const uint32_t *up, const uint32_t *src, const uint32_t *down,
+      unsigned width)
+{
+   unsigned x   = 0;
+   unsigned end = 1;
+   SCALE2X_PIXELS(uint32_t, out0, out1, up, src, down, x, end, width)
+
+   for (; x + 4 < width; x += 4)
+   {
+      uint32x4x2_t row0, row1;
+      uint32x4_t A    = vld1q_u32(up   + x);
+      uint32x4_t B    = vld1q_u32(src  + x - 1);
+      uint32x4_t C    = vld1q_u32(src  + x);
+      uint32x4_t D    = vld1q_u32(src  + x + 1);
+      uint32x4_t E    = vld1q_u32(down + x);
+      uint32x4_t keep = vorrq_u32(vceqq_u32(A, E), vceqq_u32(B, D));
+
+      row0.val[0]     = vbslq_u32(vbicq_u32(vceqq_u32(A, B), keep), A, C);
+      row0.val[1]     = vbslq_u32(vbicq_u32(vceqq_u32(A, D), keep), A, C);
+      row1.val[0]     = vbslq_u32(vbicq_u32(vceqq_u32(E, B), keep), E, C);
+      row1.val[1]     = vbslq_u32(vbicq_u32(vceqq_u32(E, D), keep), E, C);
+
+      /* Interleaving stores put each pair side by side */
+      vst2q_u32(out0 + (x << 1), row0);
+      vst2q_u32(out1 + (x << 1), row1);
+   }
+
+   SCALE2X_PIXELS(uint32_t, out0, out1, up, src, down, x, width, width)
+}
+
+static void scale2x_row_rgb565_neon(uint16_t *out0, uint16_t *out1,
+      const uint16_t *up, const uint16_t *src, const uint16_t *down,
+      unsigned width)
+{
+   unsigned x   = 0;
+   unsigned end = 1;
+   SCALE2X_PIXELS(uint16_t, out0, out1, up, src, down, x, end, width)
+
+   for (; x + 8 < width; x += 8)
+   {
+      uint16x8x2_t row0, row1;
+      uint16x8_t A    = vld1q_u16(up   + x);
+      uint16x8_t B    = vld1q_u16(src  + x - 1);
+      uint16x8_t C    = vld1q_u16(src  + x);
+      uint16x8_t D    = vld1q_u16(src  + x + 1);
+      uint16x8_t E    = vld1q_u16(down + x);
+      uint16x8_t keep = vorrq_u16(vceqq_u16(A, E), vceqq_u16(B, D));
+
+      row0.val[0]     = vbslq_u16(vbicq_u16(vceqq_u16(A, B), keep), A, C);
+      row0.val[1]     = vbslq_u16(vbicq_u16(vceqq_u16(A, D), keep), A, C);
+      row1.val[0]     = vbslq_u16(vbicq_u16(vceqq_u16(E, B), keep), E, C);
+      row1.val[1]     = vbslq_u16(vbicq_u16(vceqq_u16(E, D), keep), E, C);
+
+      vst2q_u16(out0 + (x << 1), row0);
+      vst2q_u16(out1 + (x << 1), row1);
+   }
+
+   SCALE2X_PIXELS(uint16_t, out0, out1, up, src, down, x, width, width)
+}
+#endif
+
 static void *scale2x_generic_create(const struct softfilter_config *config,
       unsigned in_fmt, unsigned out_fmt,
       unsigned max_width, unsigned max_height,
       unsigned threads, softfilter_simd_mask_t simd, void *userdata)
 {
    struct filter_data *filt = (struct filter_data*)calloc(1, sizeof(*filt));
-   (void)simd;
    (void)config;
    (void)userdata;
 
    if (!filt) {
       return NULL;
    }
-   /* Apparently the code is not thread-safe,
-    * so force single threaded operation... */
-   filt->workers = (struct softfilter_thread_data*)calloc(1, sizeof(struct softfilter_thread_data));
-   filt->threads = 1;
+   filt->workers = (struct softfilter_thread_data*)calloc(threads, sizeof(struct softfilter_thread_data));
+   filt->threads = threads;
    filt->in_fmt  = in_fmt;
    if (!filt->workers) {
       free(filt);
       return NULL;
    }
+
+   filt->row_xrgb8888 = scale2x_row_xrgb8888;
+   filt->row_rgb565   = scale2x_row_rgb565;
+#if defined(__SSE2__)
+   if (simd & SOFTFILTER_SIMD_SSE2) {
+      filt->row_xrgb8888 = scale2x_row_xrgb8888_sse2;
+      filt->row_rgb565   = scale2x_row_rgb565_sse2;
+   }
+#endif
+#ifdef SCALE2X_HAVE_NEON
+   if (simd & SOFTFILTER_SIMD_NEON) {
+      filt->row_xrgb8888 = scale2x_row_xrgb8888_neon;
+      filt->row_rgb565   = scale2x_row_rgb565_neon;
+   }
+#endif
    return filt;
 }
 
@@ -107,97 +335,53 @@ static void scale2x_generic_destroy(void *data)
 
 static void scale2x_work_cb_xrgb8888(void *data, void *thread_data)
 {
+   struct filter_data *filt           = (struct filter_data*)data;
    struct softfilter_thread_data *thr = (struct softfilter_thread_data*)thread_data;
-   uint32_t in_stride                 = (uint32_t)(thr->in_pitch >> 2);
-   uint32_t out_stride                = (uint32_t)(thr->out_pitch >> 2);
+   size_t in_stride                   = thr->in_pitch >> 2;
+   size_t out_stride                  = thr->out_pitch >> 2;
    const uint32_t *input              = (const uint32_t*)thr->in_data;
-   uint32_t *output0                  = (uint32_t*)thr->out_data;
-   uint32_t *output1                  = (uint32_t*)thr->out_data + out_stride;
-   uint16_t x, y;
+   uint32_t *output                   = (uint32_t*)thr->out_data;
+   unsigned y;
 
    for (y = 0; y < thr->height; y++)
    {
-      /* Determine offsets of previous/next source lines */
-      uint32_t line_prev = (y == 0)               ? 0 : in_stride;
-      uint32_t line_next = (y == thr->height - 1) ? 0 : in_stride;
-
-      for (x = 0; x < thr->width; x++)
-      {
-         /* Get sample points */
-         uint32_t A = *(input - line_prev);
-         uint32_t B = (x > 0) ? *(input - 1) : *input;
-         uint32_t C = *input;
-         uint32_t D = (x < thr->width - 1) ? *(input + 1) : *input;
-         uint32_t E = *(input++ + line_next);
-
-         /* Apply pixel expansion algorithm */
-         if (A != E && B != D)
-         {
-            *output0++ = (A == B ? A : C);
-            *output0++ = (A == D ? A : C);
-            *output1++ = (E == B ? E : C);
-            *output1++ = (E == D ? E : C);
-         }
-         else
-         {
-            *output0++ = C;
-            *output0++ = C;
-            *output1++ = C;
-            *output1++ = C;
-         }
-      }
+      /* Rows at the edges of a slice read the neighbouring
+       * slices; only the edges of the frame are clamped */
+      const uint32_t *up   = (y == 0 && thr->first)
+         ? input : input - in_stride;
+      const uint32_t *down = (y == thr->height - 1 && thr->last)
+         ? input : input + in_stride;
+
+      filt->row_xrgb8888(output, output + out_stride,
+            up, input, down, thr->width);
 
-      input   += in_stride - thr->width;
-      output0 += (out_stride << 1) - (thr->width << 1);
-      output1 += (out_stride << 1) - (thr->width << 1);
+      input  += in_stride;
+      output += out_stride << 1;
    }
 }
 
 static void scale2x_work_cb_rgb565(void *data, void *thread_data)
 {
+   struct filter_data *filt           = (struct filter_data*)data;
    struct softfilter_thread_data *thr = (struct softfilter_thread_data*)thread_data;
-   uint32_t in_stride                 = (uint32_t)(thr->in_pitch >> 1);
-   uint32_t out_stride                = (uint32_t)(thr->out_pitch >> 1);
+   size_t in_stride                   = thr->in_pitch >> 1;
+   size_t out_stride                  = thr->out_pitch >> 1;
    const uint16_t *input              = (const uint16_t*)thr->in_data;
-   uint16_t *output0                  = (uint16_t*)thr->out_data;
-   uint16_t *output1                  = (uint16_t*)thr->out_data + out_stride;
-   uint16_t x, y;
+   uint16_t *output                   = (uint16_t*)thr->out_data;
+   unsigned y;
 
    for (y = 0; y < thr->height; y++)
    {
-      /* Determine offsets of previous/next source lines */
-      uint32_t line_prev = (y == 0)               ? 0 : in_stride;
-      uint32_t line_next = (y == thr->height - 1) ? 0 : in_stride;
-
-      for (x = 0; x < thr->width; x++)
-      {
-         /* Get sample points */
-         uint16_t A = *(input - line_prev);
-         uint16_t B = (x > 0) ? *(input - 1) : *input;
-         uint16_t C = *input;
-         uint16_t D = (x < thr->width - 1) ? *(input + 1) : *input;
-         uint16_t E = *(input++ + line_next);
-
-         /* Apply pixel expansion algorithm */
-         if (A != E && B != D)
-         {
-            *output0++ = (A == B ? A : C);
-            *output0++ = (A == D ? A : C);
-            *output1++ = (E == B ? E : C);
-            *output1++ = (E == D ? E : C);
-         }
-         else
-         {
-            *output0++ = C;
-            *output0++ = C;
-            *output1++ = C;
-            *output1++ = C;
-         }
-      }
+      const uint16_t *up   = (y == 0 && thr->first)
+         ? input : input - in_stride;
+      const uint16_t *down = (y == thr->height - 1 && thr->last)
+         ? input : input + in_stride;
+
+      filt->row_rgb565(output, output + out_stride,
+            up, input, down, thr->width);
 
-      input   += in_stride - thr->width;
-      output0 += (out_stride << 1) - (thr->width << 1);
-      output1 += (out_stride << 1) - (thr->width << 1);
+      input  += in_stride;
+      output += out_stride << 1;
    }
 }
 
@@ -206,27 +390,34 @@ static void scale2x_generic_packets(void *data,
       void *output, size_t output_stride,
       const void *input, unsigned width, unsigned height, size_t input_stride)
 {
-   /* We are guaranteed single threaded operation
-    * (filt->threads = 1) so we don't need to loop
-    * over threads and can cull some code. This only
-    * makes the tiniest performance difference, but
-    * every little helps when running on an o3DS... */
    struct filter_data *filt = (struct filter_data*)data;
-   struct softfilter_thread_data *thr = (struct softfilter_thread_data*)&filt->workers[0];
-
-   thr->out_data = (uint8_t*)output;
-   thr->in_data = (const uint8_t*)input;
-   thr->out_pitch = output_stride;
-   thr->in_pitch = input_stride;
-   thr->width = width;
-   thr->height = height;
-
-   if (filt->in_fmt == SOFTFILTER_FMT_XRGB8888) {
-      packets[0].work = scale2x_work_cb_xrgb8888;
-   } else if (filt->in_fmt == SOFTFILTER_FMT_RGB565) {
-      packets[0].work = scale2x_work_cb_rgb565;
+   unsigned i;
+
+   for (i = 0; i < filt->threads; i++)
+   {
+      struct softfilter_thread_data *thr = (struct softfilter_thread_data*)&filt->workers[i];
+      unsigned y_start = (height * i) / filt->threads;
+      unsigned y_end   = (height * (i + 1)) / filt->threads;
+
+      thr->out_data  = (uint8_t*)output + y_start * 2 * output_stride;
+      thr->in_data   = (const uint8_t*)input + y_start * input_stride;
+      thr->out_pitch = output_stride;
+      thr->in_pitch  = input_stride;
+      thr->width     = width;
+      thr->height    = y_end - y_start;
+
+      /* Workers need to know if they can access pixels
+       * outside their given buffer. */
+      thr->first     = y_start == 0;
+      thr->last      = y_end == height;
+
+      if (filt->in_fmt == SOFTFILTER_FMT_XRGB8888) {
+         packets[i].work = scale2x_work_cb_xrgb8888;
+      } else if (filt->in_fmt == SOFTFILTER_FMT_RGB565) {
+         packets[i].work = scale2x_work_cb_rgb565;
+      }
+      packets[i].thread_data = thr;
    }
-   packets[0].thread_data = thr;
 }
 
 static const struct softfilter_implementation scale2x_generic = {
@@ -161,7 +161,11 @@ typedef void (*softfilter_get_work_packets_t)(void *data,
 /* Returns the number of worker threads the filter will use.
  * This can differ from the value passed to create() instead the filter
  * cannot be parallelized, etc. The number of threads must be less-or-equal
- * compared to the value passed to create(). */
+ * compared to the value passed to create().
+ *
+ * Each thread is really a work packet. The host may ask for more packets
+ * than it has threads, to split a frame into slices that stay in cache,
+ * and packets of the same frame can run in any order. */
 typedef unsigned (*softfilter_query_num_threads_t)(void *data);
 
 struct softfilter_implementation
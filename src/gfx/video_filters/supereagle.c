@@ -36,8 +36,8 @@ struct softfilter_thread_data
    unsigned colfmt;
    unsigned width;
    unsigned height;
-   int first;
-   int last;
+   unsigned y_start;
+   unsigned frame_height;
 };
 
 struct filter_data
@@ -75,7 +75,7 @@ static void *supereagle_generic_create(const struct softfilter_config *config,
    if (!filt)
       return NULL;
    filt->workers = (struct softfilter_thread_data*)calloc(threads, sizeof(struct softfilter_thread_data));
-   filt->threads = 1;
+   filt->threads = threads;
    filt->in_fmt  = in_fmt;
    if (!filt->workers)
    {
@@ -113,10 +113,10 @@ static void supereagle_generic_destroy(void *data)
 
 #define supereagle_result(A, B, C, D) (((A) != (C) || (A) != (D)) - ((B) != (C) || (B) != (D)));
 
-#define supereagle_declare_variables(typename_t, in, nextline) \
+#define supereagle_declare_variables(typename_t, in, prevline, nextline, nextline2) \
          typename_t product1a, product1b, product2a, product2b; \
-         const typename_t colorB1 = *(in - nextline + 0); \
-         const typename_t colorB2 = *(in - nextline + 1); \
+         const typename_t colorB1 = *(in - prevline + 0); \
+         const typename_t colorB2 = *(in - prevline + 1); \
          const typename_t color4  = *(in - 1); \
          const typename_t color5  = *(in + 0); \
          const typename_t color6  = *(in + 1); \
@@ -125,8 +125,8 @@ static void supereagle_generic_destroy(void *data)
          const typename_t color2  = *(in + nextline + 0); \
          const typename_t color3  = *(in + nextline + 1); \
          const typename_t colorS1 = *(in + nextline + 2); \
-         const typename_t colorA1 = *(in + nextline + nextline + 0); \
-         const typename_t colorA2 = *(in + nextline + nextline + 1)
+         const typename_t colorA1 = *(in + nextline2 + 0); \
+         const typename_t colorA2 = *(in + nextline2 + 1)
 
 #ifndef supereagle_function
 #define supereagle_function(result_cb, interpolate_cb, interpolate2_cb) \
@@ -215,20 +215,24 @@ static void supereagle_generic_destroy(void *data)
 #endif
 
 static void supereagle_generic_xrgb8888(unsigned width, unsigned height,
-      int first, int last, uint32_t *src,
+      unsigned y, unsigned frame_height, uint32_t *src,
       unsigned src_stride, uint32_t *dst, unsigned dst_stride)
 {
    unsigned finish;
-   unsigned nextline = (last) ? 0 : src_stride;
 
-   for (; height; height--)
+   for (; height; height--, y++)
    {
+      /* Offsets of the rows around this one, clamped to the frame */
+      unsigned prevline  = (y > 0) ? src_stride : 0;
+      unsigned nextline  = (y + 1 < frame_height) ? src_stride : 0;
+      unsigned nextline2 = (y + 2 < frame_height)
+         ? nextline + src_stride : nextline;
       uint32_t *in  = (uint32_t*)src;
       uint32_t *out = (uint32_t*)dst;
 
       for (finish = width; finish; finish -= 1)
       {
-         supereagle_declare_variables(uint32_t, in, nextline);
+         supereagle_declare_variables(uint32_t, in, prevline, nextline, nextline2);
 
          supereagle_function(supereagle_result, supereagle_interpolate_xrgb8888, supereagle_interpolate2_xrgb8888);
       }
@@ -239,20 +243,24 @@ static void supereagle_generic_xrgb8888(unsigned width, unsigned height,
 }
 
 static void supereagle_generic_rgb565(unsigned width, unsigned height,
-      int first, int last, uint16_t *src,
+      unsigned y, unsigned frame_height, uint16_t *src,
       unsigned src_stride, uint16_t *dst, unsigned dst_stride)
 {
    unsigned finish;
-   unsigned nextline = (last) ? 0 : src_stride;
 
-   for (; height; height--)
+   for (; height; height--, y++)
    {
+      /* Offsets of the rows around this one, clamped to the frame */
+      unsigned prevline  = (y > 0) ? src_stride : 0;
+      unsigned nextline  = (y + 1 < frame_height) ? src_stride : 0;
+      unsigned nextline2 = (y + 2 < frame_height)
+         ? nextline + src_stride : nextline;
       uint16_t *in  = (uint16_t*)src;
       uint16_t *out = (uint16_t*)dst;
 
       for (finish = width; finish; finish -= 1)
       {
-         supereagle_declare_variables(uint16_t, in, nextline);
+         supereagle_declare_variables(uint16_t, in, prevline, nextline, nextline2);
 
          supereagle_function(supereagle_result, supereagle_interpolate_rgb565, supereagle_interpolate2_rgb565);
       }
@@ -271,7 +279,7 @@ static void supereagle_work_cb_rgb565(void *data, void *thread_data)
    unsigned height = thr->height;
 
    supereagle_generic_rgb565(width, height,
-         thr->first, thr->last, input,
+         thr->y_start, thr->frame_height, input,
             (unsigned)(thr->in_pitch / SOFTFILTER_BPP_RGB565),
             output,
             (unsigned)(thr->out_pitch / SOFTFILTER_BPP_RGB565));
@@ -286,7 +294,7 @@ static void supereagle_work_cb_xrgb8888(void *data, void *thread_data)
    unsigned height = thr->height;
 
    supereagle_generic_xrgb8888(width, height,
-         thr->first, thr->last, input,
+         thr->y_start, thr->frame_height, input,
         (unsigned)(thr->in_pitch / SOFTFILTER_BPP_XRGB8888),
         output,
         (unsigned)(thr->out_pitch / SOFTFILTER_BPP_XRGB8888));
@@ -313,9 +321,10 @@ static void supereagle_generic_packets(void *data,
       thr->width = width;
       thr->height = y_end - y_start;
 
-      /* Workers need to know if they can access pixels outside their given buffer. */
-      thr->first = y_start;
-      thr->last = y_end == height;
+      /* Workers read up to two rows past their slice,
+       * and need to know where the frame ends. */
+      thr->y_start      = y_start;
+      thr->frame_height = height;
 
       if (filt->in_fmt == SOFTFILTER_FMT_RGB565)
          packets[i].work = supereagle_work_cb_rgb565;
@@ -413,7 +413,14 @@ static void video_thread_loop(void *data)
 {
    thread_packet_t pkt;
    bool updated;
-   thread_video_t *thr = (thread_video_t*)data;
+   unsigned width             = 0;
+   unsigned height            = 0;
+   unsigned pitch             = 0;
+   uint64_t count             = 0;
+   char msg[NAME_MAX_LENGTH];
+   thread_video_t *thr        = (thread_video_t*)data;
+
+   msg[0]                     = '\0';
 
    for (;;)
    {
@@ -427,6 +434,28 @@ static void video_thread_loop(void *data)
        * right after the switch is checked. */
       pkt     = thr->cmd_data;
 
+      if (updated)
+      {
+         /* Take the newest published slot. Without a fresh
+          * frame (duped frames), 'read' is simply redrawn. */
+         if (thr->frame.fresh)
+         {
+            unsigned tmp       = thr->frame.read;
+            thr->frame.read    = thr->frame.ready;
+            thr->frame.ready   = tmp;
+            thr->frame.fresh   = false;
+         }
+
+         width                 = thr->frame.width;
+         height                = thr->frame.height;
+         pitch                 = thr->frame.pitch;
+         count                 = thr->frame.count;
+         strlcpy(msg, thr->frame.msg, sizeof(msg));
+
+         thr->frame.updated    = false;
+         thr->frame.busy       = true;
+      }
+
       slock_unlock(thr->lock);
 
       if (video_thread_handle_packet(thr, &pkt))
@@ -462,9 +491,8 @@ static void video_thread_loop(void *data)
                video_driver_build_info(&video_info);
 
                ret = thr->driver->frame(thr->driver_data,
-                  thr->frame.buffer, thr->frame.width, thr->frame.height,
-                  thr->frame.count, thr->frame.pitch,
-                  *thr->frame.msg ? thr->frame.msg : NULL,
+                  thr->frame.slots[thr->frame.read], width, height,
+                  count, pitch, *msg ? msg : NULL,
                   &video_info);
 
                slock_unlock(thr->frame.lock);
@@ -493,7 +521,7 @@ static void video_thread_loop(void *data)
          thr->focus         = focus;
          thr->has_windowed  = has_windowed;
          thr->vp            = vp;
-         thr->frame.updated = false;
+         thr->frame.busy    = false;
          scond_signal(thr->cond_cmd);
          slock_unlock(thr->lock);
       }
@@ -604,7 +632,7 @@ static bool video_thread_frame(void *data, const void *frame_,
       retro_time_t target            = thr->last_time + target_frame_time;
 
       /* Ideally, use absolute time, but that is only a good idea on POSIX. */
-      while (thr->frame.updated)
+      while (thr->frame.updated || thr->frame.busy)
       {
          retro_time_t current = cpu_features_get_time_usec();
          retro_time_t delta   = target - current;
@@ -617,48 +645,64 @@ static bool video_thread_frame(void *data, const void *frame_,
       }
    }
 
-   /* Drop frame if updated flag is still set, as thread is
-    * still working on last frame. */
-   if (!thr->frame.updated)
+   slock_unlock(thr->lock);
+
+   /* The 'write' slot belongs to this side alone, so it can be
+    * filled without holding the lock. If the core rendered into
+    * it directly, there is nothing to copy at all. */
    {
-      const uint8_t *src   = (const uint8_t*)frame_;
-      uint8_t       *dst   = thr->frame.buffer;
+      uint8_t *dst         = thr->frame.slots[thr->frame.write];
       unsigned copy_stride = width *
          (thr->info.rgb32 ? sizeof(uint32_t) : sizeof(uint16_t));
 
-      if (src)
+      if (frame_ == dst)
+         copy_stride       = pitch;
+      else if (frame_)
       {
-         int i; /* TODO/FIXME - increment counter never meaningfully used */
+         int i;
+         const uint8_t *src = (const uint8_t*)frame_;
          for (i = 0; i < (int)height; i++, src += pitch, dst += copy_stride)
             memcpy(dst, src, copy_stride);
       }
 
-      thr->frame.updated = true;
-      thr->frame.width   = width;
-      thr->frame.height  = height;
-      thr->frame.count   = frame_count;
-      thr->frame.pitch   = copy_stride;
+      slock_lock(thr->lock);
 
-      if (msg)
-         strlcpy(thr->frame.msg, msg, sizeof(thr->frame.msg));
-      else
-         *thr->frame.msg = '\0';
+      if (frame_)
+      {
+         unsigned tmp        = thr->frame.ready;
+         thr->frame.ready    = thr->frame.write;
+         thr->frame.write    = tmp;
+
+         /* Still not picked up, this newer frame replaces it. */
+         if (thr->frame.fresh)
+            thr->miss_count++;
+         thr->frame.fresh    = true;
+      }
+
+      thr->frame.updated     = true;
+      thr->frame.width       = width;
+      thr->frame.height      = height;
+      thr->frame.count       = frame_count;
+      thr->frame.pitch       = copy_stride;
+   }
 
-      scond_signal(thr->cond_thread);
+   if (msg)
+      strlcpy(thr->frame.msg, msg, sizeof(thr->frame.msg));
+   else
+      *thr->frame.msg = '\0';
+
+   scond_signal(thr->cond_thread);
 
 #ifdef HAVE_MENU
-      if (thr->texture.enable)
+   if (thr->texture.enable)
+   {
+      do
       {
-         do
-         {
-            scond_wait(thr->cond_cmd, thr->lock);
-         } while (thr->frame.updated);
-      }
-#endif
-      thr->hit_count++;
+         scond_wait(thr->cond_cmd, thr->lock);
+      } while (thr->frame.updated || thr->frame.busy);
    }
-   else
-      thr->miss_count++;
+#endif
+   thr->hit_count++;
 
    slock_unlock(thr->lock);
 
@@ -695,20 +739,28 @@ static bool video_thread_init(thread_video_t *thr,
       return false;
 
    {
+      unsigned i;
       size_t max_size        = info.input_scale * RARCH_SCALE_BASE;
       max_size              *= max_size;
       max_size              *= info.rgb32 ?
          sizeof(uint32_t) : sizeof(uint16_t);
 
+      for (i = 0; i < VIDEO_THREAD_FRAME_SLOTS; i++)
+      {
 #ifdef _3DS
-      thr->frame.buffer      = linearMemAlign(max_size, 0x80);
+         thr->frame.slots[i] = (uint8_t*)linearMemAlign(max_size, 0x80);
 #else
-      thr->frame.buffer      = (uint8_t*)malloc(max_size);
+         thr->frame.slots[i] = (uint8_t*)malloc(max_size);
 #endif
-      if (!thr->frame.buffer)
-         return false;
+         if (!thr->frame.slots[i])
+            return false;
+
+         memset(thr->frame.slots[i], 0x80, max_size);
+      }
 
-      memset(thr->frame.buffer, 0x80, max_size);
+      thr->frame.write       = 0;
+      thr->frame.ready       = 1;
+      thr->frame.read        = 2;
    }
 
    thr->input                = input;
@@ -818,6 +870,7 @@ static bool video_thread_read_viewport(void *data,
 
 static void video_thread_free(void *data)
 {
+   unsigned i;
    thread_video_t *thr = (thread_video_t*)data;
 
    if (thr)
@@ -840,11 +893,14 @@ static void video_thread_free(void *data)
       }
 
       free(thr->texture.frame);
+      for (i = 0; i < VIDEO_THREAD_FRAME_SLOTS; i++)
+      {
 #ifdef _3DS
-      linearFree(thr->frame.buffer);
+         linearFree(thr->frame.slots[i]);
 #else
-      free(thr->frame.buffer);
+         free(thr->frame.slots[i]);
 #endif
+      }
       free(thr->alpha_mod);
 
       slock_free(thr->frame.lock);
@@ -1258,6 +1314,43 @@ static uint32_t thread_get_flags(void *data)
    return 0;
 }
 
+static bool thread_get_current_software_framebuffer(void *data,
+      struct retro_framebuffer *framebuffer)
+{
+   video_driver_state_t *video_st = video_state_get_ptr();
+   thread_video_t *thr            = (thread_video_t*)data;
+   unsigned max_size              = 0;
+   enum retro_pixel_format format = RETRO_PIXEL_FORMAT_RGB565;
+
+   if (!thr || !framebuffer)
+      return false;
+
+   if (thr->info.rgb32)
+      format                      = RETRO_PIXEL_FORMAT_XRGB8888;
+
+   /* When the frame gets converted or filtered before it
+    * reaches us, the core must keep its own pixel format
+    * and the slot would just be an extra copy source. */
+   if (video_st->pix_fmt != format)
+      return false;
+#ifdef HAVE_VIDEO_FILTER
+   if (video_st->state_filter)
+      return false;
+#endif
+
+   max_size                       = thr->info.input_scale * RARCH_SCALE_BASE;
+   if (framebuffer->width > max_size || framebuffer->height > max_size)
+      return false;
+
+   framebuffer->data              = thr->frame.slots[thr->frame.write];
+   framebuffer->pitch             = framebuffer->width *
+      (thr->info.rgb32 ? sizeof(uint32_t) : sizeof(uint16_t));
+   framebuffer->format            = format;
+   framebuffer->memory_flags      = RETRO_MEMORY_TYPE_CACHED;
+
+   return true;
+}
+
 static const video_poke_interface_t thread_poke = {
    thread_get_flags,
    thread_load_texture,
@@ -1278,7 +1371,7 @@ static const video_poke_interface_t thread_poke = {
    thread_show_mouse,
    thread_grab_mouse_toggle,
    thread_get_current_shader,
-   NULL, /* get_current_software_framebuffer */
+   thread_get_current_software_framebuffer,
    NULL, /* get_hw_render_interface */
    thread_set_hdr_max_nits,
    thread_set_hdr_paper_white_nits,
@@ -28,6 +28,10 @@
 
 RETRO_BEGIN_DECLS
 
+/* One slot being filled by the core, one published and
+ * one being rendered by the video thread. */
+#define VIDEO_THREAD_FRAME_SLOTS 3
+
 enum thread_cmd
 {
    CMD_VIDEO_NONE = 0,
@@ -218,16 +222,27 @@ typedef struct thread_video
 
    bool alpha_update;
 
+   /* Frames are handed over through a pool of slots:
+    * the core side fills 'write' (possibly directly, through
+    * GET_CURRENT_SOFTWARE_FRAMEBUFFER), publishing swaps it
+    * with 'ready', and the video thread swaps 'ready' with
+    * 'read' before rendering from it. Only the indices move,
+    * frame data is never copied between slots. */
    struct
    {
       uint64_t count;
       slock_t *lock;
-      uint8_t *buffer;
+      uint8_t *slots[VIDEO_THREAD_FRAME_SLOTS];
+      unsigned write;
+      unsigned ready;
+      unsigned read;
       unsigned width;
       unsigned height;
       unsigned pitch;
       char msg[NAME_MAX_LENGTH];
-      bool updated;
+      bool updated;       /* Frame posted, not picked up yet. */
+      bool fresh;         /* 'ready' holds a frame not rendered yet. */
+      bool busy;          /* Video thread is rendering 'read'. */
       bool within_thread;
    } frame;
 
@@ -872,6 +872,7 @@ INPUT (HID)
 FIFO BUFFER
 ============================================================ */
 #include "../libretro-common/queues/fifo_queue.c"
+#include "../libretro-common/queues/spsc_queue.c"
 
 /*============================================================
 AUDIO RESAMPLER
@@ -881,6 +882,9 @@ AUDIO RESAMPLER
 #ifdef HAVE_NEAREST_RESAMPLER
 #include "../libretro-common/audio/resampler/drivers/nearest_resampler.c"
 #endif
+#ifdef HAVE_POLYPHASE_RESAMPLER
+#include "../libretro-common/audio/resampler/drivers/polyphase_resampler.c"
+#endif
 #ifdef HAVE_CC_RESAMPLER
 #include "../audio/drivers_resampler/cc_resampler.c"
 #endif
@@ -1163,6 +1167,7 @@ CONFIGURATION
 STATE MANAGER
 ============================================================ */
 #ifdef HAVE_REWIND
+#include "../state_manager_delta.c"
 #include "../state_manager.c"
 #endif
 
@@ -1348,6 +1353,7 @@ NETPLAY
 #ifdef HAVE_NETWORKING
 #include "../network/natt.c"
 #include "../network/netplay/netplay_frontend.c"
+#include "../network/netplay/netplay_delta.c"
 #include "../network/netplay/netplay_room_parse.c"
 #include "../libretro-common/net/net_compat.c"
 #include "../libretro-common/net/net_socket.c"
@@ -337,6 +337,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_AUTOSAVE_INTERVAL,
    "autosave_interval"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_AUTOSAVE_JOURNAL,
+   "autosave_journal"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_AUTO_OVERRIDES_ENABLE,
    "auto_overrides_enable"
@@ -3175,6 +3179,14 @@ MSG_HASH(
    MENU_ENUM_LABEL_REWIND_BUFFER_SIZE_STEP,
    "rewind_buffer_size_step"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_REWIND_THREADED,
+   "rewind_threaded"
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_REWIND_TIERED,
+   "rewind_tiered"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_REWIND_SETTINGS,
    "rewind_settings"
@@ -3409,6 +3421,14 @@ MSG_HASH(
    MENU_ENUM_LABEL_RUN_AHEAD_FRAMES,
    "run_ahead_frames"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_RUN_AHEAD_ADAPTIVE,
+   "run_ahead_adaptive"
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_RUN_AHEAD_ADAPTIVE_BUDGET,
+   "run_ahead_adaptive_budget"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_PREEMPT_ENABLE,
    "preemptive_frames_enable"
@@ -5556,6 +5576,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_PLAYLIST_COMPRESSION,
    "playlist_compression"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_PLAYLIST_BINARY_CACHE,
+   "playlist_binary_cache"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_MENU_SOUND_OK,
    "menu_sound_ok"
@@ -5704,6 +5728,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_SCAN_WITHOUT_CORE_MATCH,
    "scan_without_core_match"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_SCAN_CHD_CACHE_SIZE,
+   "scan_chd_cache_size"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_MENU_XMB_ANIMATION_HORIZONTAL_HIGHLIGHT,
    "xmb_menu_animation_horizontal_highlight"
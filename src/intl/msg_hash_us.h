@@ -3840,6 +3840,22 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_RUN_AHEAD_HIDE_WARNINGS,
    "Hide the warning message that appears when using Run-Ahead and the core does not support save states."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_RUN_AHEAD_ADAPTIVE,
+   "Adaptive Run-Ahead"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_RUN_AHEAD_ADAPTIVE,
+   "Measure how long Run-Ahead takes and use as many frames as the hardware can sustain, up to 'Number of Frames to Run-Ahead'."
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_RUN_AHEAD_ADAPTIVE_BUDGET,
+   "Adaptive Run-Ahead Budget"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_RUN_AHEAD_ADAPTIVE_BUDGET,
+   "Share of each frame, in percent, that Adaptive Run-Ahead may spend. Lower values leave more time for video and audio."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_PREEMPT_UNSUPPORTED,
    "[Preemptive Frames Unavailable]"
@@ -4135,6 +4151,14 @@ MSG_HASH(
    MENU_ENUM_LABEL_HELP_AUTOSAVE_INTERVAL,
    "Autosaves the non-volatile SRAM at a regular interval. This is disabled by default unless set otherwise. The interval is measured in seconds. A value of 0 disables autosave."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_AUTOSAVE_JOURNAL,
+   "SaveRAM Autosave Journal"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_AUTOSAVE_JOURNAL,
+   "Record the changes made by each autosave in a '.journal' file before writing them, so that a save interrupted by RetroArch crashing or being closed is completed the next time the SaveRAM is loaded. Does not apply when SaveRAM Compression is enabled."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_SAVESTATE_AUTO_INDEX,
    "Increment Save State Index Automatically"
@@ -4427,6 +4451,22 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_REWIND_BUFFER_SIZE_STEP,
    "Each time the rewind buffer size value is increased or decreased, it will change by this amount."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_REWIND_THREADED,
+   "Threaded Rewind"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_REWIND_THREADED,
+   "Compress rewind states on a separate thread. Reduces frame time spikes, but some rewind steps may be skipped if the thread cannot keep up. Takes effect when content is loaded."
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_REWIND_TIERED,
+   "Compressed Rewind History"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_REWIND_TIERED,
+   "Keep older rewind history compressed, with periodic keyframes. Allows rewinding much further back for the same buffer size, at a small CPU cost. Takes effect when content is loaded."
+   )
 
 /* Settings > Frame Throttle > Frame Time Counter */
 
@@ -6866,6 +6906,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_PLAYLIST_COMPRESSION,
    "Archive playlist data when writing to disk. Reduces file size and loading times at the expense of (negligibly) increased CPU usage. May be used with either old or new format playlists."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_PLAYLIST_BINARY_CACHE,
+   "Cache Playlists"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_PLAYLIST_BINARY_CACHE,
+   "Keep a binary copy of each playlist in a '.lplc' file next to it. Large playlists and the Explore view load much faster, at the cost of some disk space. The copy is rebuilt whenever the playlist changes."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_PLAYLIST_SHOW_INLINE_CORE_NAME,
    "Show Associated Cores in Playlists"
@@ -7002,6 +7050,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_SCAN_WITHOUT_CORE_MATCH,
    "Allow content to be scanned and added to a playlist without a core installed that supports it."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_SCAN_CHD_CACHE_SIZE,
+   "CHD Hunk Cache Size"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_SCAN_CHD_CACHE_SIZE,
+   "Number of decompressed hunks kept in memory for each CHD image read while scanning. A quarter of them are decompressed ahead of sequential reads."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_PLAYLIST_MANAGER_LIST,
    "Manage Playlists"
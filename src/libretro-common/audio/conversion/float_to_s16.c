@@ -21,6 +21,7 @@
  */
 #include <stdint.h>
 #include <stddef.h>
+#include <string.h>
 
 #if defined(__SSE2__)
 #include <emmintrin.h>
@@ -111,6 +112,24 @@ void convert_float_to_s16(int16_t *out,
       _mm_storeu_si128((__m128i *)out, packed);
    }
 
+   /* The scalar loop below truncates where cvtps rounds, so run
+    * the tail through a zero-padded vector as well; otherwise the
+    * result would depend on how the caller splits its buffer. */
+   if (i < samples)
+   {
+      float   tail_in[8]  = {0};
+      int16_t tail_out[8];
+      __m128i packed;
+
+      memcpy(tail_in, in, (samples - i) * sizeof(float));
+      packed = _mm_packs_epi32(
+            _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(tail_in + 0), factor)),
+            _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(tail_in + 4), factor)));
+      _mm_storeu_si128((__m128i *)tail_out, packed);
+      memcpy(out, tail_out, (samples - i) * sizeof(int16_t));
+      i                 = samples;
+   }
+
    samples           = samples - i;
    i                 = 0;
 #elif defined(__ALTIVEC__)
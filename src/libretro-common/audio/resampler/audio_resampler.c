@@ -44,6 +44,9 @@ retro_resampler_t null_resampler = {
 
 static const retro_resampler_t *resampler_drivers[] = {
    &sinc_resampler,
+#ifdef HAVE_POLYPHASE_RESAMPLER
+   &polyphase_resampler,
+#endif
 #ifdef HAVE_CC_RESAMPLER
    &CC_resampler,
 #endif
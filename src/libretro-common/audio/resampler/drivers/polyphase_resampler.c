@@ -0,0 +1,622 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (polyphase_resampler.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Polyphase windowed SINC implementation.
+ *
+ * The filter is the same Kaiser-windowed SINC as the "sinc" resampler,
+ * but the phase table is laid out for a rational ratio L/M picked at
+ * init time, with a multiple of L rows. At the nominal ratio every
+ * output lands on a precomputed row and no coefficient interpolation
+ * is needed.
+ *
+ * Dynamic rate control nudges the ratio on every flush, so the step
+ * between outputs is rounded to a whole number of rows whenever that
+ * changes the rate by less than POLYPHASE_RATIO_TOLERANCE. Rate
+ * control sees the difference as a slightly fuller or emptier buffer
+ * and corrects for it on the next flushes. Larger ratio changes fall
+ * back to interpolating between adjacent rows. */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+
+#include <boolean.h>
+#include <retro_environment.h>
+#include <retro_inline.h>
+#include <filters.h>
+#include <memalign.h>
+
+#include <audio/audio_resampler.h>
+
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON) || defined(HAVE_NEON)
+#define POLYPHASE_HAVE_NEON
+#include <arm_neon.h>
+#endif
+
+/* Sub-phase precision of the time accumulator. */
+#define POLYPHASE_FRAC_BITS 16
+#define POLYPHASE_FRAC_MASK ((1 << POLYPHASE_FRAC_BITS) - 1)
+
+/* Phases used when the ratio is not one of the known ones,
+ * and the least number of phases used for known ones. */
+#define POLYPHASE_GENERIC_PHASES      256
+#define POLYPHASE_GENERIC_PHASES_HIGH 1024
+
+/* Largest relative rate change accepted to stay on whole rows.
+ * 0.3% is about 5 cents, within the default 0.5% rate control
+ * range. With at least POLYPHASE_GENERIC_PHASES rows and up to
+ * 1.5x upsampling the step is at least 170 rows, so rounding it
+ * changes the rate by at most 0.3%. */
+#define POLYPHASE_RATIO_TOLERANCE 0.003
+
+/* Rows are padded to a multiple of this many floats (64 bytes),
+ * so every row starts on its own cache line. */
+#define POLYPHASE_ROW_ALIGN 16
+
+struct polyphase_rate
+{
+   unsigned in_rate;
+   unsigned out_rate;
+};
+
+/* Conversions common enough to deserve an exact table.
+ * 32040 Hz is the nominal SNES output rate. */
+static const struct polyphase_rate polyphase_rates[] = {
+   { 32040, 48000 },
+   { 32040, 44100 },
+   { 32000, 48000 },
+   { 32000, 44100 },
+   { 44100, 48000 },
+   { 48000, 44100 },
+   { 48000, 48000 },
+};
+
+struct rarch_polyphase_resampler;
+
+typedef size_t (*polyphase_run_t)(struct rarch_polyphase_resampler *re,
+      float *output, uint32_t phases, uint32_t ratio, bool exact);
+
+typedef struct rarch_polyphase_resampler
+{
+   /* A buffer for phase_table, buffer_l and buffer_r
+    * are created in a single allocation. */
+   float *main_buffer;
+   float *phase_table;
+   float *buffer_l;
+   float *buffer_r;
+   polyphase_run_t run;
+   unsigned phases;
+   unsigned stride;
+   unsigned taps;
+   unsigned ptr;
+   uint32_t time;
+   float kaiser_beta;
+} rarch_polyphase_resampler_t;
+
+/* All kernels assume that taps is a multiple of 8,
+ * and that coeff/next are aligned to POLYPHASE_ROW_ALIGN. */
+
+static INLINE void polyphase_dot_c(float *out,
+      const float *coeff, const float *left, const float *right,
+      unsigned taps)
+{
+   unsigned i;
+   float sum_l = 0.0f;
+   float sum_r = 0.0f;
+
+   for (i = 0; i < taps; i++)
+   {
+      sum_l += left[i]  * coeff[i];
+      sum_r += right[i] * coeff[i];
+   }
+
+   out[0] = sum_l;
+   out[1] = sum_r;
+}
+
+static INLINE void polyphase_dot_lerp_c(float *out,
+      const float *coeff, const float *next, float frac,
+      const float *left, const float *right, unsigned taps)
+{
+   unsigned i;
+   float sum_l = 0.0f;
+   float sum_r = 0.0f;
+
+   for (i = 0; i < taps; i++)
+   {
+      float sinc_val = coeff[i] + (next[i] - coeff[i]) * frac;
+      sum_l         += left[i]  * sinc_val;
+      sum_r         += right[i] * sinc_val;
+   }
+
+   out[0] = sum_l;
+   out[1] = sum_r;
+}
+
+#if defined(__SSE__)
+static INLINE void polyphase_store_sse(float *out, __m128 sum_l, __m128 sum_r)
+{
+   /* sum = { r1, r0, l1, l0 } + { r3, r2, l3, l2 } */
+   __m128 sum = _mm_add_ps(
+         _mm_shuffle_ps(sum_l, sum_r, _MM_SHUFFLE(1, 0, 1, 0)),
+         _mm_shuffle_ps(sum_l, sum_r, _MM_SHUFFLE(3, 2, 3, 2)));
+
+   /* sum = { X, R, X, L } */
+   sum    = _mm_add_ps(_mm_shuffle_ps(sum, sum, _MM_SHUFFLE(3, 3, 1, 1)), sum);
+
+   _mm_store_ss(out + 0, sum);
+   _mm_store_ss(out + 1, _mm_movehl_ps(sum, sum));
+}
+
+static INLINE void polyphase_dot_sse(float *out,
+      const float *coeff, const float *left, const float *right,
+      unsigned taps)
+{
+   unsigned i;
+   __m128 sum_l = _mm_setzero_ps();
+   __m128 sum_r = _mm_setzero_ps();
+
+   for (i = 0; i < taps; i += 4)
+   {
+      __m128 _sinc = _mm_load_ps(coeff + i);
+      sum_l        = _mm_add_ps(sum_l, _mm_mul_ps(_mm_loadu_ps(left + i),  _sinc));
+      sum_r        = _mm_add_ps(sum_r, _mm_mul_ps(_mm_loadu_ps(right + i), _sinc));
+   }
+
+   polyphase_store_sse(out, sum_l, sum_r);
+}
+
+static INLINE void polyphase_dot_lerp_sse(float *out,
+      const float *coeff, const float *next, float frac,
+      const float *left, const float *right, unsigned taps)
+{
+   unsigned i;
+   __m128 delta = _mm_set1_ps(frac);
+   __m128 sum_l = _mm_setzero_ps();
+   __m128 sum_r = _mm_setzero_ps();
+
+   for (i = 0; i < taps; i += 4)
+   {
+      __m128 c0    = _mm_load_ps(coeff + i);
+      __m128 c1    = _mm_load_ps(next + i);
+      __m128 _sinc = _mm_add_ps(c0, _mm_mul_ps(_mm_sub_ps(c1, c0), delta));
+      sum_l        = _mm_add_ps(sum_l, _mm_mul_ps(_mm_loadu_ps(left + i),  _sinc));
+      sum_r        = _mm_add_ps(sum_r, _mm_mul_ps(_mm_loadu_ps(right + i), _sinc));
+   }
+
+   polyphase_store_sse(out, sum_l, sum_r);
+}
+#endif
+
+#if defined(__AVX__)
+static INLINE void polyphase_store_avx(float *out, __m256 sum_l, __m256 sum_r)
+{
+   /* res_l = { l3 + l7, l2 + l6, l1 + l5, l0 + l4 }, same for r. */
+   __m128 res_l = _mm_add_ps(_mm256_castps256_ps128(sum_l),
+         _mm256_extractf128_ps(sum_l, 1));
+   __m128 res_r = _mm_add_ps(_mm256_castps256_ps128(sum_r),
+         _mm256_extractf128_ps(sum_r, 1));
+   /* { r1, r0, l1, l0 } + { r3, r2, l3, l2 } */
+   __m128 sum   = _mm_add_ps(
+         _mm_shuffle_ps(res_l, res_r, _MM_SHUFFLE(1, 0, 1, 0)),
+         _mm_shuffle_ps(res_l, res_r, _MM_SHUFFLE(3, 2, 3, 2)));
+
+   sum          = _mm_add_ps(_mm_shuffle_ps(sum, sum, _MM_SHUFFLE(3, 3, 1, 1)), sum);
+
+   _mm_store_ss(out + 0, sum);
+   _mm_store_ss(out + 1, _mm_movehl_ps(sum, sum));
+}
+
+static INLINE void polyphase_dot_avx(float *out,
+      const float *coeff, const float *left, const float *right,
+      unsigned taps)
+{
+   unsigned i;
+   __m256 sum_l = _mm256_setzero_ps();
+   __m256 sum_r = _mm256_setzero_ps();
+
+   for (i = 0; i < taps; i += 8)
+   {
+      __m256 _sinc = _mm256_load_ps(coeff + i);
+      sum_l        = _mm256_add_ps(sum_l,
+            _mm256_mul_ps(_mm256_loadu_ps(left + i),  _sinc));
+      sum_r        = _mm256_add_ps(sum_r,
+            _mm256_mul_ps(_mm256_loadu_ps(right + i), _sinc));
+   }
+
+   polyphase_store_avx(out, sum_l, sum_r);
+}
+
+static INLINE void polyphase_dot_lerp_avx(float *out,
+      const float *coeff, const float *next, float frac,
+      const float *left, const float *right, unsigned taps)
+{
+   unsigned i;
+   __m256 delta = _mm256_set1_ps(frac);
+   __m256 sum_l = _mm256_setzero_ps();
+   __m256 sum_r = _mm256_setzero_ps();
+
+   for (i = 0; i < taps; i += 8)
+   {
+      __m256 c0    = _mm256_load_ps(coeff + i);
+      __m256 c1    = _mm256_load_ps(next + i);
+      __m256 _sinc = _mm256_add_ps(c0,
+            _mm256_mul_ps(_mm256_sub_ps(c1, c0), delta));
+      sum_l        = _mm256_add_ps(sum_l,
+            _mm256_mul_ps(_mm256_loadu_ps(left + i),  _sinc));
+      sum_r        = _mm256_add_ps(sum_r,
+            _mm256_mul_ps(_mm256_loadu_ps(right + i), _sinc));
+   }
+
+   polyphase_store_avx(out, sum_l, sum_r);
+}
+#endif
+
+#if defined(POLYPHASE_HAVE_NEON)
+/* Intrinsics only, so these build for both ARMv7 and AArch64. */
+static INLINE void polyphase_store_neon(float *out,
+      float32x4_t sum_l, float32x4_t sum_r)
+{
+   float32x2_t l = vadd_f32(vget_low_f32(sum_l), vget_high_f32(sum_l));
+   float32x2_t r = vadd_f32(vget_low_f32(sum_r), vget_high_f32(sum_r));
+   vst1_f32(out, vpadd_f32(l, r));
+}
+
+static INLINE void polyphase_dot_neon(float *out,
+      const float *coeff, const float *left, const float *right,
+      unsigned taps)
+{
+   unsigned i;
+   float32x4_t sum_l = vdupq_n_f32(0.0f);
+   float32x4_t sum_r = vdupq_n_f32(0.0f);
+
+   for (i = 0; i < taps; i += 8)
+   {
+      float32x4_t c0 = vld1q_f32(coeff + i);
+      float32x4_t c1 = vld1q_f32(coeff + i + 4);
+      sum_l          = vmlaq_f32(sum_l, vld1q_f32(left + i),      c0);
+      sum_r          = vmlaq_f32(sum_r, vld1q_f32(right + i),     c0);
+      sum_l          = vmlaq_f32(sum_l, vld1q_f32(left + i + 4),  c1);
+      sum_r          = vmlaq_f32(sum_r, vld1q_f32(right + i + 4), c1);
+   }
+
+   polyphase_store_neon(out, sum_l, sum_r);
+}
+
+static INLINE void polyphase_dot_lerp_neon(float *out,
+      const float *coeff, const float *next, float frac,
+      const float *left, const float *right, unsigned taps)
+{
+   unsigned i;
+   float32x4_t delta = vdupq_n_f32(frac);
+   float32x4_t sum_l = vdupq_n_f32(0.0f);
+   float32x4_t sum_r = vdupq_n_f32(0.0f);
+
+   for (i = 0; i < taps; i += 8)
+   {
+      float32x4_t a0 = vld1q_f32(coeff + i);
+      float32x4_t a1 = vld1q_f32(coeff + i + 4);
+      float32x4_t c0 = vmlaq_f32(a0, vsubq_f32(vld1q_f32(next + i),     a0), delta);
+      float32x4_t c1 = vmlaq_f32(a1, vsubq_f32(vld1q_f32(next + i + 4), a1), delta);
+      sum_l          = vmlaq_f32(sum_l, vld1q_f32(left + i),      c0);
+      sum_r          = vmlaq_f32(sum_r, vld1q_f32(right + i),     c0);
+      sum_l          = vmlaq_f32(sum_l, vld1q_f32(left + i + 4),  c1);
+      sum_r          = vmlaq_f32(sum_r, vld1q_f32(right + i + 4), c1);
+   }
+
+   polyphase_store_neon(out, sum_l, sum_r);
+}
+#endif
+
+/* Computes every output frame that is due before the next
+ * input frame has to be pushed, with the kernels of @isa. */
+#define POLYPHASE_DEFINE_RUN(isa) \
+static size_t polyphase_run_##isa(rarch_polyphase_resampler_t *re, \
+      float *output, uint32_t phases, uint32_t ratio, bool exact) \
+{ \
+   size_t out_frames     = 0; \
+   uint32_t time         = re->time; \
+   unsigned taps         = re->taps; \
+   unsigned stride       = re->stride; \
+   const float *buffer_l = re->buffer_l + re->ptr; \
+   const float *buffer_r = re->buffer_r + re->ptr; \
+   \
+   if (exact) \
+   { \
+      for (; time < phases; time += ratio, out_frames++) \
+         polyphase_dot_##isa(output + 2 * out_frames, \
+               re->phase_table + (time >> POLYPHASE_FRAC_BITS) * stride, \
+               buffer_l, buffer_r, taps); \
+   } \
+   else \
+   { \
+      for (; time < phases; time += ratio, out_frames++) \
+      { \
+         const float *coeff = re->phase_table + \
+            (time >> POLYPHASE_FRAC_BITS) * stride; \
+         float frac         = (float)(time & POLYPHASE_FRAC_MASK) \
+            * (1.0f / (1 << POLYPHASE_FRAC_BITS)); \
+         polyphase_dot_lerp_##isa(output + 2 * out_frames, \
+               coeff, coeff + stride, frac, buffer_l, buffer_r, taps); \
+      } \
+   } \
+   \
+   re->time = time; \
+   return out_frames; \
+}
+
+POLYPHASE_DEFINE_RUN(c)
+#if defined(__SSE__)
+POLYPHASE_DEFINE_RUN(sse)
+#endif
+#if defined(__AVX__)
+POLYPHASE_DEFINE_RUN(avx)
+#endif
+#if defined(POLYPHASE_HAVE_NEON)
+POLYPHASE_DEFINE_RUN(neon)
+#endif
+
+static void resampler_polyphase_process(void *re_, struct resampler_data *data)
+{
+   rarch_polyphase_resampler_t *re = (rarch_polyphase_resampler_t*)re_;
+   uint32_t phases                 = re->phases << POLYPHASE_FRAC_BITS;
+   /* Rows to advance per output frame */
+   double step                     = re->phases / data->ratio;
+   uint32_t rows                   = (uint32_t)(step + 0.5);
+   bool exact                      = rows
+      && fabs(rows - step) <= step * POLYPHASE_RATIO_TOLERANCE;
+   uint32_t ratio                  = exact
+      ? rows << POLYPHASE_FRAC_BITS
+      : (uint32_t)(step * (1 << POLYPHASE_FRAC_BITS) + 0.5);
+   const float *input              = data->data_in;
+   float *output                   = data->data_out;
+   size_t frames                   = data->input_frames;
+   size_t out_frames               = 0;
+   unsigned taps                   = re->taps;
+
+   /* Coming back from a larger ratio change, snap to
+    * the previous row so we can stay on the exact path. */
+   if (exact)
+      re->time &= ~(uint32_t)POLYPHASE_FRAC_MASK;
+
+   while (frames)
+   {
+      while (frames && re->time >= phases)
+      {
+         /* Push in reverse to make filter more obvious. */
+         if (!re->ptr)
+            re->ptr = taps;
+         re->ptr--;
+
+         re->buffer_l[re->ptr + taps] =
+            re->buffer_l[re->ptr]     = *input++;
+
+         re->buffer_r[re->ptr + taps] =
+            re->buffer_r[re->ptr]     = *input++;
+
+         re->time                    -= phases;
+         frames--;
+      }
+
+      {
+         size_t produced = re->run(re, output, phases, ratio, exact);
+         output         += 2 * produced;
+         out_frames     += produced;
+      }
+   }
+
+   data->output_frames = out_frames;
+}
+
+static void resampler_polyphase_free(void *data)
+{
+   rarch_polyphase_resampler_t *re = (rarch_polyphase_resampler_t*)data;
+   if (re)
+      memalign_free(re->main_buffer);
+   free(re);
+}
+
+/* Builds phases + 1 rows; the extra row is phase 1.0,
+ * which the interpolating path needs for the last phase. */
+static void polyphase_init_table_kaiser(rarch_polyphase_resampler_t *re,
+      double cutoff)
+{
+   int i, j;
+   int phases        = (int)re->phases;
+   int taps          = (int)re->taps;
+   /* Kaiser window function - need to normalize w(0) to 1.0f */
+   double window_mod = besseli0(re->kaiser_beta);
+   double sidelobes  = taps / 2.0;
+
+   for (i = 0; i <= phases; i++)
+   {
+      float *row = re->phase_table + i * re->stride;
+
+      for (j = 0; j < taps; j++)
+      {
+         double sinc_phase;
+         int               n = j * phases + i;
+         double window_phase = (double)n / (phases * taps); /* [0, 1]. */
+         window_phase        = 2.0 * window_phase - 1.0;     /* [-1, 1] */
+         sinc_phase          = sidelobes * window_phase;
+         row[j]              = (float)(cutoff * sinc(M_PI * sinc_phase * cutoff) *
+               besseli0(re->kaiser_beta * sqrt(1 - window_phase * window_phase))
+               / window_mod);
+      }
+   }
+}
+
+/* Returns the number of phases to use for @bandwidth_mod:
+ * a multiple of the reduced numerator of one of the known
+ * ratios if it matches, at least @fallback, and @fallback
+ * otherwise. */
+static unsigned polyphase_find_phases(double bandwidth_mod, unsigned fallback)
+{
+   unsigned i;
+
+   for (i = 0; i < sizeof(polyphase_rates) / sizeof(polyphase_rates[0]); i++)
+   {
+      unsigned a     = polyphase_rates[i].out_rate;
+      unsigned b     = polyphase_rates[i].in_rate;
+      double ratio   = (double)a / b;
+
+      if (fabs(bandwidth_mod - ratio) > ratio * 1e-9)
+         continue;
+
+      /* Reduce out/in, the numerator is the phase count. */
+      while (b)
+      {
+         unsigned t = a % b;
+         a          = b;
+         b          = t;
+      }
+
+      /* More rows make for smaller steps when the
+       * ratio is rounded to whole rows */
+      a = polyphase_rates[i].out_rate / a;
+      return a * ((fallback + a - 1) / a);
+   }
+
+   return fallback;
+}
+
+static void *resampler_polyphase_new(const struct resampler_config *config,
+      double bandwidth_mod, enum resampler_quality quality,
+      resampler_simd_mask_t mask)
+{
+   double cutoff                   = 0.0;
+   size_t phase_elems              = 0;
+   size_t elems                    = 0;
+   unsigned sidelobes              = 0;
+   unsigned generic_phases         = POLYPHASE_GENERIC_PHASES;
+   rarch_polyphase_resampler_t *re = (rarch_polyphase_resampler_t*)
+      calloc(1, sizeof(*re));
+
+   if (!re)
+      return NULL;
+
+   switch (quality)
+   {
+      case RESAMPLER_QUALITY_LOWEST:
+         cutoff          = 0.90;
+         sidelobes       = 2;
+         re->kaiser_beta = 3.5;
+         break;
+      case RESAMPLER_QUALITY_LOWER:
+         cutoff          = 0.90;
+         sidelobes       = 4;
+         re->kaiser_beta = 4.5;
+         break;
+      case RESAMPLER_QUALITY_HIGHER:
+         cutoff          = 0.90;
+         sidelobes       = 32;
+         re->kaiser_beta = 10.5;
+         generic_phases  = POLYPHASE_GENERIC_PHASES_HIGH;
+         break;
+      case RESAMPLER_QUALITY_HIGHEST:
+         cutoff          = 0.962;
+         sidelobes       = 128;
+         re->kaiser_beta = 14.5;
+         generic_phases  = POLYPHASE_GENERIC_PHASES_HIGH;
+         break;
+      case RESAMPLER_QUALITY_NORMAL:
+      case RESAMPLER_QUALITY_DONTCARE:
+         cutoff          = 0.825;
+         sidelobes       = 8;
+         re->kaiser_beta = 5.5;
+         break;
+   }
+
+   re->taps   = sidelobes * 2;
+
+   /* Downsampling, must lower cutoff, and extend number of
+    * taps accordingly to keep same stopband attenuation. */
+   if (bandwidth_mod < 1.0)
+   {
+      cutoff  *= bandwidth_mod;
+      re->taps = (unsigned)ceil(re->taps / bandwidth_mod);
+   }
+
+   /* Be SIMD-friendly. */
+   re->taps        = (re->taps + 7) & ~7;
+   re->stride      = (re->taps + POLYPHASE_ROW_ALIGN - 1)
+      & ~(POLYPHASE_ROW_ALIGN - 1);
+   re->phases      = polyphase_find_phases(bandwidth_mod, generic_phases);
+
+   phase_elems     = (re->phases + 1) * re->stride;
+   elems           = phase_elems + 4 * re->taps;
+
+   re->main_buffer = (float*)memalign_alloc(128, sizeof(float) * elems);
+   if (!re->main_buffer)
+      goto error;
+
+   memset(re->main_buffer, 0, sizeof(float) * elems);
+
+   re->phase_table = re->main_buffer;
+   re->buffer_l    = re->main_buffer + phase_elems;
+   re->buffer_r    = re->buffer_l + 2 * re->taps;
+
+   polyphase_init_table_kaiser(re, cutoff);
+
+   /* Widest kernel that was both compiled in and is supported wins. */
+   re->run         = polyphase_run_c;
+#if defined(__SSE__)
+   if (mask & RESAMPLER_SIMD_SSE)
+      re->run      = polyphase_run_sse;
+#endif
+#if defined(__AVX__)
+   if (mask & RESAMPLER_SIMD_AVX)
+      re->run      = polyphase_run_avx;
+#endif
+#if defined(POLYPHASE_HAVE_NEON)
+   /* Advanced SIMD is mandatory on AArch64, but the CPU
+    * feature mask does not always report it there. */
+#if !defined(__aarch64__)
+   if (mask & RESAMPLER_SIMD_NEON)
+#endif
+      re->run      = polyphase_run_neon;
+#endif
+
+   return re;
+
+error:
+   resampler_polyphase_free(re);
+   return NULL;
+}
+
+retro_resampler_t polyphase_resampler = {
+   resampler_polyphase_new,
+   resampler_polyphase_process,
+   resampler_polyphase_free,
+   RESAMPLER_API_VERSION,
+   "polyphase",
+   "polyphase"
+};
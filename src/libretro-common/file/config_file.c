@@ -39,15 +39,190 @@
 
 #define MAX_INCLUDE_DEPTH 16
 
+/* Entries and keys are carved out of chunks of
+ * this size, rather than allocated one by one */
+#define CONFIG_FILE_CHUNK_SIZE 16384
+
+#define CONFIG_FILE_ALIGN(x) (((x) + sizeof(void*) - 1) & ~(sizeof(void*) - 1))
+
 struct config_include_list
 {
    char *path;
    struct config_include_list *next;
 };
 
+struct config_file_chunk
+{
+   struct config_file_chunk *next;
+   size_t size;
+   size_t used;
+};
+
 /* Forward declaration */
 static bool config_file_parse_line(config_file_t *conf,
-      struct config_entry_list *list, char *line, config_file_cb_t *cb);
+      char *line, config_file_cb_t *cb);
+
+static void *config_file_alloc(config_file_t *conf, size_t len)
+{
+   uint8_t *ptr                    = NULL;
+   struct config_file_chunk *chunk = conf->chunks;
+
+   len = CONFIG_FILE_ALIGN(len);
+
+   if (!chunk || chunk->size - chunk->used < len)
+   {
+      /* Anything too big to share a chunk gets one of
+       * its own, which goes behind the current chunk
+       * so that the rest of that still gets used */
+      size_t size = (len > CONFIG_FILE_CHUNK_SIZE / 4)
+         ? len : CONFIG_FILE_CHUNK_SIZE;
+
+      if (!(chunk = (struct config_file_chunk*)malloc(
+            CONFIG_FILE_ALIGN(sizeof(*chunk)) + size)))
+         return NULL;
+
+      chunk->size = size;
+      chunk->used = 0;
+
+      if (size == len && conf->chunks)
+      {
+         chunk->next        = conf->chunks->next;
+         conf->chunks->next = chunk;
+      }
+      else
+      {
+         chunk->next        = conf->chunks;
+         conf->chunks       = chunk;
+      }
+   }
+
+   ptr          = (uint8_t*)chunk + CONFIG_FILE_ALIGN(sizeof(*chunk))
+                + chunk->used;
+   chunk->used += len;
+   return ptr;
+}
+
+static char *config_file_alloc_string(config_file_t *conf, const char *str)
+{
+   size_t len = strlen(str) + 1;
+   char *s    = (char*)config_file_alloc(conf, len);
+   if (s)
+      memcpy(s, str, len);
+   return s;
+}
+
+static void config_file_free_chunks(struct config_file_chunk *chunk)
+{
+   while (chunk)
+   {
+      struct config_file_chunk *next = chunk->next;
+      free(chunk);
+      chunk = next;
+   }
+}
+
+/* Hands all chunks of 'src' over to 'dst' */
+static void config_file_move_chunks(config_file_t *dst, config_file_t *src)
+{
+   struct config_file_chunk *tail = src->chunks;
+
+   if (!tail)
+      return;
+
+   while (tail->next)
+      tail = tail->next;
+
+   tail->next   = dst->chunks;
+   dst->chunks  = src->chunks;
+   src->chunks  = NULL;
+}
+
+/* entries_map is keyed by hash only, entries whose
+ * keys share a hash are chained through map_next.
+ * The hash is checked first, then the (interned)
+ * key pointer, and only then the key string. */
+static struct config_entry_list *config_file_map_get(
+      const config_file_t *conf, uint32_t hash, const char *key)
+{
+   struct config_entry_list *entry = NULL;
+   ptrdiff_t idx                   = RHMAP_IDX(conf->entries_map, hash);
+
+   if (idx < 0)
+      return NULL;
+
+   for (entry = conf->entries_map[idx]; entry; entry = entry->map_next)
+      if (entry->key == key || string_is_equal(entry->key, key))
+         return entry;
+
+   return NULL;
+}
+
+/* Adds an entry whose key is not in the map yet */
+static void config_file_map_add(config_file_t *conf,
+      struct config_entry_list *entry)
+{
+   ptrdiff_t idx   = RHMAP_IDX(conf->entries_map, entry->hash);
+
+   entry->map_next = NULL;
+
+   if (idx < 0)
+      RHMAP_SET(conf->entries_map, entry->hash, entry);
+   else
+   {
+      struct config_entry_list *head = conf->entries_map[idx];
+      while (head->map_next)
+         head = head->map_next;
+      head->map_next = entry;
+   }
+}
+
+/* Returns the link pointing at 'entry' */
+static struct config_entry_list **config_file_map_link(
+      config_file_t *conf, struct config_entry_list *entry)
+{
+   struct config_entry_list **link = NULL;
+   ptrdiff_t idx                   = RHMAP_IDX(conf->entries_map, entry->hash);
+
+   if (idx < 0)
+      return NULL;
+
+   for (link = &conf->entries_map[idx]; *link; link = &(*link)->map_next)
+      if (*link == entry)
+         return link;
+
+   return NULL;
+}
+
+static void config_file_map_replace(config_file_t *conf,
+      struct config_entry_list *entry, struct config_entry_list *new_entry)
+{
+   struct config_entry_list **link = config_file_map_link(conf, entry);
+
+   if (!link)
+      return;
+
+   new_entry->map_next = entry->map_next;
+   *link               = new_entry;
+   entry->map_next     = NULL;
+}
+
+static void config_file_map_remove(config_file_t *conf,
+      struct config_entry_list *entry)
+{
+   ptrdiff_t idx                   = 0;
+   struct config_entry_list **link = config_file_map_link(conf, entry);
+
+   if (!link)
+      return;
+
+   *link           = entry->map_next;
+   entry->map_next = NULL;
+
+   /* Drop the hash once its last entry is gone */
+   idx             = RHMAP_IDX(conf->entries_map, entry->hash);
+   if (idx >= 0 && !conf->entries_map[idx])
+      (void)RHMAP_DEL(conf->entries_map, entry->hash);
+}
 
 static int config_file_sort_compare_func(struct config_entry_list *a,
       struct config_entry_list *b)
@@ -315,17 +490,20 @@ static void config_file_add_child_list(config_file_t *parent,
        * to the parent hash map */
       for (i = 0, cap = RHMAP_CAP(child->entries_map); i != cap; i++)
       {
-         uint32_t child_hash   = RHMAP_KEY(child->entries_map, i);
-         const char *child_key = RHMAP_KEY_STR(child->entries_map, i);
+         struct config_entry_list *entry = NULL;
+         struct config_entry_list *next  = NULL;
+
+         if (!RHMAP_KEY(child->entries_map, i))
+            continue;
 
-         if (child_hash &&
-             child_key &&
-             !RHMAP_HAS_FULL(parent->entries_map, child_hash, child_key))
+         for (entry = child->entries_map[i]; entry; entry = next)
          {
-            struct config_entry_list *entry = child->entries_map[i];
+            next = entry->map_next;
 
-            if (entry)
-               RHMAP_SET_FULL(parent->entries_map, child_hash, child_key, entry);
+            if (config_file_map_get(parent, entry->hash, entry->key))
+               entry->map_next = NULL;
+            else
+               config_file_map_add(parent, entry);
          }
       }
 
@@ -410,11 +588,34 @@ void config_file_add_reference(config_file_t *conf, char *path)
    path_linked_list_add_path(conf->references, short_path);
 }
 
+/* Splits 'lines' up in place, and parses each line */
+static void config_file_parse_lines(config_file_t *conf,
+      char *lines, config_file_cb_t *cb)
+{
+   while (*lines)
+   {
+      char *line = lines;
+      char *end  = strchr(lines, '\n');
+
+      if (end)
+      {
+         *end  = '\0';
+         lines = end + 1;
+      }
+      else
+         lines += strlen(lines);
+
+      if (*line)
+         config_file_parse_line(conf, line, cb);
+   }
+}
+
 static int config_file_load_internal(
       struct config_file *conf,
       const char *path, unsigned depth, config_file_cb_t *cb)
 {
-   RFILE         *file = NULL;
+   uint8_t *buf        = NULL;
+   int64_t length      = 0;
    char      *new_path = strdup(path);
    if (!new_path)
       return 1;
@@ -422,87 +623,32 @@ static int config_file_load_internal(
    conf->path          = new_path;
    conf->include_depth = depth;
 
-   if (!(file = filestream_open(path,
-         RETRO_VFS_FILE_ACCESS_READ,
-         RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+   /* Read the file in one go and parse it in place,
+    * rather than allocating every line separately */
+   if (!filestream_read_file(path, (void**)&buf, &length))
    {
       free(conf->path);
+      conf->path = NULL;
       return 1;
    }
 
-   while (!filestream_eof(file))
-   {
-      char *line                     = NULL;
-      struct config_entry_list *list = (struct config_entry_list*)
-         malloc(sizeof(*list));
-
-      if (!list)
-      {
-         filestream_close(file);
-         return -1;
-      }
-
-      list->readonly  = false;
-      list->key       = NULL;
-      list->value     = NULL;
-      list->next      = NULL;
-
-      line            = filestream_getline(file);
-
-      if (!line)
-      {
-         free(list);
-         continue;
-      }
-
-      if ( 
-              !string_is_empty(line) 
-            && config_file_parse_line(conf, list, line, cb))
-      {
-         if (conf->entries)
-            conf->tail->next = list;
-         else
-            conf->entries    = list;
-
-         conf->tail = list;
-
-         if (list->key)
-         {
-            /* Only add entry to the map if an entry
-             * with the specified value does not
-             * already exist */
-            uint32_t hash = rhmap_hash_string(list->key);
-
-            if (!RHMAP_HAS_FULL(conf->entries_map, hash, list->key))
-            {
-               RHMAP_SET_FULL(conf->entries_map, hash, list->key, list);
-
-               if (cb && list->value)
-                  cb->config_file_new_entry_cb(list->key, list->value);
-            }
-         }
-      }
-
-      free(line);
-
-      if (list != conf->tail)
-         free(list);
-   }
-
-   filestream_close(file);
+   config_file_parse_lines(conf, (char*)buf, cb);
+   free(buf);
 
    return 0;
 }
 
 static bool config_file_parse_line(config_file_t *conf,
-      struct config_entry_list *list, char *line, config_file_cb_t *cb)
+      char *line, config_file_cb_t *cb)
 {
-   size_t cur_size       = 32;
-   size_t idx            = 0;
-   char *key             = NULL;
-   char *key_tmp         = NULL;
+   uint32_t hash                   = 0;
+   char *key                       = NULL;
+   char *key_end                   = NULL;
+   char *value                     = NULL;
+   struct config_entry_list *entry = NULL;
+   struct config_entry_list *first = NULL;
    /* Remove any comment text */
-   char *comment         = config_file_strip_comment(line);
+   char *comment                   = config_file_strip_comment(line);
 
    /* Check whether entire line is a comment */
    if (comment)
@@ -546,6 +692,10 @@ static bool config_file_parse_line(config_file_t *conf,
 
          config_file_initialize(&sub_conf);
 
+         /* The sub-config allocates from our chunks, so
+          * that its entries can simply be taken over */
+         sub_conf.chunks = conf->chunks;
+
          switch (config_file_load_internal(&sub_conf, real_path,
             conf->include_depth + 1, cb))
          {
@@ -554,6 +704,8 @@ static bool config_file_parse_line(config_file_t *conf,
                config_file_add_child_list(conf, &sub_conf);
                /* fall-through to deinitialize */
             case -1:
+               conf->chunks    = sub_conf.chunks;
+               sub_conf.chunks = NULL;
                config_file_deinitialize(&sub_conf);
                break;
             case 1:
@@ -588,34 +740,11 @@ static bool config_file_parse_line(config_file_t *conf,
    while (ISSPACE((int)*line))
       line++;
 
-   /* Allocate storage for key */
-   if (!(key = (char*)malloc(cur_size + 1)))
-      return false;
-
-   /* Copy line contents into key until we
-    * reach the next space character */
+   /* The key runs until the next space character */
+   key = line;
    while (isgraph((int)*line))
-   {
-      /* If current key storage is too small,
-       * double its size */
-      if (idx == cur_size)
-      {
-         cur_size *= 2;
-         if (!(key_tmp   = (char*)realloc(key, cur_size + 1)))
-         {
-            free(key);
-            return false;
-         }
-
-         key     = key_tmp;
-      }
-
-      key[idx++] = *line++;
-   }
-   key[idx]      = '\0';
-
-   /* Add key and value entries to list */
-   list->key     = key;
+      line++;
+   key_end = line;
 
    /* An entry without a value is invalid */
    while (ISSPACE((int)*line))
@@ -624,22 +753,58 @@ static bool config_file_parse_line(config_file_t *conf,
    /* If we don't have an equal sign here,
     * we've got an invalid string. */
    if (*line != '=')
+      return false;
+
+   *key_end = '\0';
+
+   if (!(value = config_file_extract_value(line + 1)))
+      return false;
+
+   if (!(entry = (struct config_entry_list*)
+            config_file_alloc(conf, sizeof(*entry))))
    {
-      list->value = NULL;
-      goto error;
+      free(value);
+      return false;
    }
 
-   line++;
+   /* Keys are interned - an entry that repeats
+    * a key shares the string of the first one */
+   hash  = rhmap_hash_string(key);
+   first = config_file_map_get(conf, hash, key);
 
-   if (!(list->value   = config_file_extract_value(line)))
-      goto error;
+   if (first)
+      entry->key = first->key;
+   else if (!(entry->key = config_file_alloc_string(conf, key)))
+   {
+      free(value);
+      return false;
+   }
 
-   return true;
+   entry->value    = value;
+   entry->next     = NULL;
+   entry->map_next = NULL;
+   entry->hash     = hash;
+   entry->readonly = false;
 
-error:
-   list->key   = NULL;
-   free(key);
-   return false;
+   if (conf->entries)
+      conf->tail->next = entry;
+   else
+      conf->entries    = entry;
+
+   conf->tail          = entry;
+
+   /* Only add entry to the map if an entry
+    * with the specified key does not
+    * already exist */
+   if (!first)
+   {
+      config_file_map_add(conf, entry);
+
+      if (cb)
+         cb->config_file_new_entry_cb(entry->key, entry->value);
+   }
+
+   return true;
 }
 
 static int config_file_from_string_internal(
@@ -647,65 +812,16 @@ static int config_file_from_string_internal(
       char *from_string,
       const char *path)
 {
-   char *lines                    = from_string;
-   char *save_ptr                 = NULL;
-   char *line                     = NULL;
-
    if (!string_is_empty(path))
-      conf->path                  = strdup(path);
-   if (string_is_empty(lines))
+      conf->path = strdup(path);
+   if (string_is_empty(from_string))
       return 0;
 
-   /* Get first line of config file */
-   line = strtok_r(lines, "\n", &save_ptr);
+   config_file_parse_lines(conf, from_string, NULL);
 
-   while (line)
-   {
-      struct config_entry_list *list = (struct config_entry_list*)
-            malloc(sizeof(*list));
-
-      if (!list)
-         return -1;
-
-      list->readonly  = false;
-      list->key       = NULL;
-      list->value     = NULL;
-      list->next      = NULL;
-
-      /* Parse current line */
-      if (
-              !string_is_empty(line)
-            && config_file_parse_line(conf, list, line, NULL))
-      {
-         if (conf->entries)
-            conf->tail->next = list;
-         else
-            conf->entries    = list;
-
-         conf->tail          = list;
-
-         if (list->key)
-         {
-            /* Only add entry to the map if an entry
-             * with the specified value does not
-             * already exist */
-            uint32_t hash = rhmap_hash_string(list->key);
-            if (!RHMAP_HAS_FULL(conf->entries_map, hash, list->key))
-               RHMAP_SET_FULL(conf->entries_map, hash, list->key, list);
-         }
-      }
-
-      if (list != conf->tail)
-         free(list);
-
-      /* Get next line of config file */
-      line = strtok_r(NULL, "\n", &save_ptr);
-   }
-   
    return 0;
 }
 
-
 bool config_file_deinitialize(config_file_t *conf)
 {
    struct config_include_list *inc_tmp = NULL;
@@ -714,25 +830,18 @@ bool config_file_deinitialize(config_file_t *conf)
    if (!conf)
       return false;
 
-   tmp = conf->entries;
-   while (tmp)
+   /* Entries and keys live in the chunks,
+    * only the values need freeing */
+   for (tmp = conf->entries; tmp; tmp = tmp->next)
    {
-      struct config_entry_list *hold = NULL;
-      if (tmp->key)
-         free(tmp->key);
       if (tmp->value)
          free(tmp->value);
-
       tmp->value = NULL;
-      tmp->key   = NULL;
-
-      hold       = tmp;
-      tmp        = tmp->next;
-
-      if (hold)
-         free(hold);
    }
 
+   config_file_free_chunks(conf->chunks);
+   conf->chunks = NULL;
+
    inc_tmp = (struct config_include_list*)conf->includes;
    while (inc_tmp)
    {
@@ -783,15 +892,23 @@ bool config_append_file(config_file_t *conf, const char *path)
    /* Update hash map */
    for (i = 0, cap = RHMAP_CAP(new_conf->entries_map); i != cap; i++)
    {
-      uint32_t new_hash   = RHMAP_KEY(new_conf->entries_map, i);
-      const char *new_key = RHMAP_KEY_STR(new_conf->entries_map, i);
+      struct config_entry_list *entry = NULL;
+      struct config_entry_list *next  = NULL;
 
-      if (new_hash && new_key)
+      if (!RHMAP_KEY(new_conf->entries_map, i))
+         continue;
+
+      for (entry = new_conf->entries_map[i]; entry; entry = next)
       {
-         struct config_entry_list *entry = new_conf->entries_map[i];
+         struct config_entry_list *old_entry = config_file_map_get(
+               conf, entry->hash, entry->key);
+
+         next = entry->map_next;
 
-         if (entry)
-            RHMAP_SET_FULL(conf->entries_map, new_hash, new_key, entry);
+         if (old_entry)
+            config_file_map_replace(conf, old_entry, entry);
+         else
+            config_file_map_add(conf, entry);
       }
    }
 
@@ -802,6 +919,9 @@ bool config_append_file(config_file_t *conf, const char *path)
       new_conf->entries    = NULL;
    }
 
+   /* The pilfered entries live in the chunks of new_conf */
+   config_file_move_chunks(conf, new_conf);
+
    config_file_free(new_conf);
    return true;
 }
@@ -926,6 +1046,7 @@ void config_file_initialize(struct config_file *conf)
    conf->last                     = NULL;
    conf->references               = NULL;
    conf->includes                 = NULL;
+   conf->chunks                   = NULL;
    conf->include_depth            = 0;
    conf->guaranteed_no_duplicates = false;
    conf->modified                 = false;
@@ -949,7 +1070,8 @@ static struct config_entry_list *config_get_entry_internal(
       const config_file_t *conf,
       const char *key, struct config_entry_list **prev)
 {
-   struct config_entry_list *entry = RHMAP_GET_STR(conf->entries_map, key);
+   struct config_entry_list *entry = config_file_map_get(conf,
+         rhmap_hash_string(key), key);
 
    if (entry)
       return entry;
@@ -969,7 +1091,7 @@ static struct config_entry_list *config_get_entry_internal(
 struct config_entry_list *config_get_entry(
       const config_file_t *conf, const char *key)
 {
-   return RHMAP_GET_STR(conf->entries_map, key);
+   return config_file_map_get(conf, rhmap_hash_string(key), key);
 }
 
 /**
@@ -1226,8 +1348,10 @@ bool config_get_bool(config_file_t *conf, const char *key, bool *in)
 
 void config_set_string(config_file_t *conf, const char *key, const char *val)
 {
+   uint32_t hash                   = 0;
    struct config_entry_list *last  = NULL;
    struct config_entry_list *entry = NULL;
+   struct config_entry_list *first = NULL;
 
    if (!conf || !key || !val)
       return;
@@ -1268,13 +1392,25 @@ void config_set_string(config_file_t *conf, const char *key, const char *val)
 
    /* Entry corresponding to 'key' does not exist
     * > Create new entry */
-   if (!(entry = (struct config_entry_list*)malloc(sizeof(*entry))))
+   if (!(entry = (struct config_entry_list*)
+            config_file_alloc(conf, sizeof(*entry))))
+      return;
+
+   /* With guaranteed_no_duplicates the lookup above
+    * was skipped, so 'key' may still be present */
+   hash             = rhmap_hash_string(key);
+   first            = config_file_map_get(conf, hash, key);
+
+   if (first)
+      entry->key    = first->key;
+   else if (!(entry->key = config_file_alloc_string(conf, key)))
       return;
 
    entry->readonly  = false;
-   entry->key       = strdup(key);
    entry->value     = strdup(val);
    entry->next      = NULL;
+   entry->map_next  = NULL;
+   entry->hash      = hash;
    conf->modified   = true;
 
    if (last)
@@ -1284,7 +1420,10 @@ void config_set_string(config_file_t *conf, const char *key, const char *val)
 
    conf->last       = entry;
 
-   RHMAP_SET_STR(conf->entries_map, entry->key, entry);
+   if (first)
+      config_file_map_replace(conf, first, entry);
+   else
+      config_file_map_add(conf, entry);
 }
 
 void config_unset(config_file_t *conf, const char *key)
@@ -1300,11 +1439,10 @@ void config_unset(config_file_t *conf, const char *key)
    if (!(entry = config_get_entry_internal(conf, key, &last)))
       return;
 
-   (void)RHMAP_DEL_STR(conf->entries_map, entry->key);
-
-   if (entry->key)
-      free(entry->key);
+   config_file_map_remove(conf, entry);
 
+   /* The key belongs to the chunks, and may
+    * be shared with other entries */
    if (entry->value)
       free(entry->value);
 
@@ -26,6 +26,7 @@
 #include <string.h>
 
 #include <retro_inline.h>
+#include <features/features_cpu.h>
 
 #include <gfx/scaler/pixconv.h>
 
@@ -43,33 +44,278 @@
 #include <mmintrin.h>
 #endif
 
+/* The AVX2 paths are compiled with a per-function target
+ * where the compiler supports it, so that a generic x86
+ * build can still pick them at runtime. */
+#if defined(SCALER_NO_SIMD)
+#elif defined(__AVX2__)
+#define PIXCONV_HAVE_AVX2
+#define PIXCONV_AVX2_TARGET
+#elif (defined(__x86_64__) || defined(__i386__)) && (defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define PIXCONV_HAVE_AVX2
+#define PIXCONV_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+
+#ifdef PIXCONV_HAVE_AVX2
+#include <immintrin.h>
+#endif
+
+#if !defined(SCALER_NO_SIMD) && (defined(__ARM_NEON__) || defined(__ARM_NEON) || defined(HAVE_NEON) || defined(_M_ARM) || defined(_M_ARM64))
+#define PIXCONV_HAVE_NEON
+#include <arm_neon.h>
+#endif
+
+/* NEON is mandatory on AArch64 and on Windows on ARM,
+ * so there is nothing to detect at runtime there. */
+#if defined(__aarch64__) || defined(_M_ARM) || defined(_M_ARM64)
+#define PIXCONV_NEON_ALWAYS
+#endif
+
+/* A SIMD row converts as many whole vectors as fit in
+ * @width pixels and returns how many it did; the caller
+ * finishes the row in C. */
+typedef int (*pixconv_row_t)(void *output, const void *input, int width);
+
+#ifdef PIXCONV_HAVE_AVX2
+#define PIXCONV_AVX2(conv) conv##_avx2
+#else
+#define PIXCONV_AVX2(conv) NULL
+#endif
+
+#if defined(__SSE2__)
+#define PIXCONV_SSE2(conv) conv##_sse2
+#else
+#define PIXCONV_SSE2(conv) NULL
+#endif
+
+#if defined(__MMX__)
+#define PIXCONV_MMX(conv) conv##_mmx
+#else
+#define PIXCONV_MMX(conv) NULL
+#endif
+
+#ifdef PIXCONV_HAVE_NEON
+#define PIXCONV_NEON(conv) conv##_neon
+#else
+#define PIXCONV_NEON(conv) NULL
+#endif
+
+static uint64_t pixconv_simd     = 0;
+static int pixconv_simd_inited   = 0;
+
+static uint64_t pixconv_simd_available(void)
+{
+   uint64_t simd = 0;
+#if defined(__MMX__)
+   simd |= RETRO_SIMD_MMX;
+#endif
+#if defined(__SSE2__)
+   simd |= RETRO_SIMD_SSE2;
+#endif
+#ifdef PIXCONV_HAVE_AVX2
+   simd |= cpu_features_get() & RETRO_SIMD_AVX2;
+#endif
+#if defined(PIXCONV_NEON_ALWAYS)
+   simd |= RETRO_SIMD_NEON;
+#elif defined(PIXCONV_HAVE_NEON)
+   simd |= cpu_features_get() & RETRO_SIMD_NEON;
+#endif
+   return simd;
+}
+
+uint64_t pixconv_set_simd(uint64_t simd)
+{
+   pixconv_simd        = simd & pixconv_simd_available();
+   pixconv_simd_inited = 1;
+   return pixconv_simd;
+}
+
+uint64_t pixconv_get_simd(void)
+{
+   if (!pixconv_simd_inited)
+      pixconv_init_simd();
+   return pixconv_simd;
+}
+
+void pixconv_init_simd(void)
+{
+   pixconv_set_simd(~(uint64_t)0);
+}
+
+static pixconv_row_t pixconv_pick(pixconv_row_t avx2,
+      pixconv_row_t sse2, pixconv_row_t mmx, pixconv_row_t neon)
+{
+   uint64_t simd = pixconv_get_simd();
+   if (avx2 && (simd & RETRO_SIMD_AVX2))
+      return avx2;
+   if (sse2 && (simd & RETRO_SIMD_SSE2))
+      return sse2;
+   if (mmx  && (simd & RETRO_SIMD_MMX))
+      return mmx;
+   if (neon && (simd & RETRO_SIMD_NEON))
+      return neon;
+   return NULL;
+}
+
+#ifdef PIXCONV_HAVE_AVX2
+/* Interleaves 16 pixels worth of 16-bit B, G and R
+ * (each 0-255) into opaque ARGB8888. AVX2 unpacks stay
+ * within 128-bit lanes, so the halves get put back in
+ * order before storing. */
+static PIXCONV_AVX2_TARGET INLINE void pixconv_store_argb8888_avx2(
+      uint32_t *output, __m256i b, __m256i g, __m256i r)
+{
+   const __m256i a = _mm256_set1_epi16((int16_t)0xff00);
+   __m256i bg      = _mm256_or_si256(b, _mm256_slli_epi16(g, 8));
+   __m256i ra      = _mm256_or_si256(r, a);
+   __m256i lo      = _mm256_unpacklo_epi16(bg, ra);
+   __m256i hi      = _mm256_unpackhi_epi16(bg, ra);
+
+   _mm256_storeu_si256((__m256i*)(output + 0),
+         _mm256_permute2x128_si256(lo, hi, 0x20));
+   _mm256_storeu_si256((__m256i*)(output + 8),
+         _mm256_permute2x128_si256(lo, hi, 0x31));
+}
+
+/* Packs two vectors of 32-bit values that fit in 16 bits
+ * into one vector of 16-bit values, in order. */
+static PIXCONV_AVX2_TARGET INLINE __m256i pixconv_pack_epi32_avx2(
+      __m256i lo, __m256i hi)
+{
+   lo = _mm256_srai_epi32(_mm256_slli_epi32(lo, 16), 16);
+   hi = _mm256_srai_epi32(_mm256_slli_epi32(hi, 16), 16);
+   return _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi), 0xd8);
+}
+#endif
+
+#if defined(__SSE2__)
+/* Packs two vectors of 32-bit values that fit in 16 bits
+ * into one vector of 16-bit values. */
+static INLINE __m128i pixconv_pack_epi32_sse2(__m128i lo, __m128i hi)
+{
+   lo = _mm_srai_epi32(_mm_slli_epi32(lo, 16), 16);
+   hi = _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16);
+   return _mm_packs_epi32(lo, hi);
+}
+#endif
+
+#ifdef PIXCONV_HAVE_NEON
+/* Splits 16 RGB565 pixels, loaded with vld2q_u8 as low
+ * and high bytes, into 8-bit channels. The top bits are
+ * replicated into the low ones, like the C paths do. */
+static INLINE void pixconv_unpack_rgb565_neon(uint8x16x2_t in,
+      uint8x16_t *r, uint8x16_t *g, uint8x16_t *b)
+{
+   uint8x16_t rr = in.val[1];
+   uint8x16_t gg = vsriq_n_u8(vshlq_n_u8(in.val[1], 5), in.val[0], 3);
+   uint8x16_t bb = vshlq_n_u8(in.val[0], 3);
+   *r            = vsriq_n_u8(rr, rr, 5);
+   *g            = vsriq_n_u8(gg, gg, 6);
+   *b            = vsriq_n_u8(bb, bb, 5);
+}
+
+static INLINE void pixconv_unpack_0rgb1555_neon(uint8x16x2_t in,
+      uint8x16_t *r, uint8x16_t *g, uint8x16_t *b)
+{
+   uint8x16_t rr = vshlq_n_u8(in.val[1], 1);
+   uint8x16_t gg = vsriq_n_u8(vshlq_n_u8(in.val[1], 6), in.val[0], 2);
+   uint8x16_t bb = vshlq_n_u8(in.val[0], 3);
+   *r            = vsriq_n_u8(rr, rr, 5);
+   *g            = vsriq_n_u8(gg, gg, 5);
+   *b            = vsriq_n_u8(bb, bb, 5);
+}
+
+/* Packs 8-bit channels into RGB565 low and high bytes. */
+static INLINE uint8x16x2_t pixconv_pack_rgb565_neon(uint8x16_t r,
+      uint8x16_t g, uint8x16_t b)
+{
+   uint8x16x2_t out;
+   out.val[0] = vsriq_n_u8(vshlq_n_u8(g, 3), b, 3);
+   out.val[1] = vsriq_n_u8(r, g, 5);
+   return out;
+}
+#endif
+
+#if defined(__SSE2__)
+static int conv_rgb565_0rgb1555_sse2(void *output_, const void *input_,
+      int width)
+{
+   int w                 = 0;
+   const uint16_t *input = (const uint16_t*)input_;
+   uint16_t *output      = (uint16_t*)output_;
+   const __m128i hi_mask = _mm_set1_epi16(0x7fe0);
+   const __m128i lo_mask = _mm_set1_epi16(0x1f);
+
+   for (; w + 8 <= width; w += 8)
+   {
+      const __m128i in = _mm_loadu_si128((const __m128i*)(input + w));
+      __m128i hi = _mm_and_si128(_mm_srli_epi16(in, 1), hi_mask);
+      __m128i lo = _mm_and_si128(in, lo_mask);
+      _mm_storeu_si128((__m128i*)(output + w), _mm_or_si128(hi, lo));
+   }
+
+   return w;
+}
+#endif
+
+#ifdef PIXCONV_HAVE_AVX2
+static PIXCONV_AVX2_TARGET int conv_rgb565_0rgb1555_avx2(void *output_,
+      const void *input_, int width)
+{
+   int w                 = 0;
+   const uint16_t *input = (const uint16_t*)input_;
+   uint16_t *output      = (uint16_t*)output_;
+   const __m256i hi_mask = _mm256_set1_epi16(0x7fe0);
+   const __m256i lo_mask = _mm256_set1_epi16(0x1f);
+
+   for (; w + 16 <= width; w += 16)
+   {
+      const __m256i in = _mm256_loadu_si256((const __m256i*)(input + w));
+      __m256i hi = _mm256_and_si256(_mm256_srli_epi16(in, 1), hi_mask);
+      __m256i lo = _mm256_and_si256(in, lo_mask);
+      _mm256_storeu_si256((__m256i*)(output + w), _mm256_or_si256(hi, lo));
+   }
+
+   return w;
+}
+#endif
+
+#ifdef PIXCONV_HAVE_NEON
+static int conv_rgb565_0rgb1555_neon(void *output_, const void *input_,
+      int width)
+{
+   int w                    = 0;
+   const uint16_t *input    = (const uint16_t*)input_;
+   uint16_t *output         = (uint16_t*)output_;
+   const uint16x8_t lo_mask = vdupq_n_u16(0x1f);
+
+   for (; w + 8 <= width; w += 8)
+   {
+      uint16x8_t in = vld1q_u16(input + w);
+      vst1q_u16(output + w, vbslq_u16(lo_mask, in, vshrq_n_u16(in, 1)));
+   }
+
+   return w;
+}
+#endif
+
 void conv_rgb565_0rgb1555(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
 {
    int h;
    const uint16_t *input = (const uint16_t*)input_;
-   uint16_t *output = (uint16_t*)output_;
-
-#if defined(__SSE2__)
-   int max_width           = width - 7;
-   const __m128i hi_mask   = _mm_set1_epi16(0x7fe0);
-   const __m128i lo_mask   = _mm_set1_epi16(0x1f);
-#endif
+   uint16_t *output      = (uint16_t*)output_;
+   pixconv_row_t row     = pixconv_pick(
+         PIXCONV_AVX2(conv_rgb565_0rgb1555),
+         PIXCONV_SSE2(conv_rgb565_0rgb1555),
+         NULL,
+         PIXCONV_NEON(conv_rgb565_0rgb1555));
 
    for (h = 0; h < height;
          h++, output += out_stride >> 1, input += in_stride >> 1)
    {
-      int w = 0;
-#if defined(__SSE2__)
-      for (; w < max_width; w += 8)
-      {
-         const __m128i in = _mm_loadu_si128((const __m128i*)(input + w));
-         __m128i hi = _mm_and_si128(_mm_slli_epi16(in, 1), hi_mask);
-         __m128i lo = _mm_and_si128(in, lo_mask);
-         _mm_storeu_si128((__m128i*)(output + w), _mm_or_si128(hi, lo));
-      }
-#endif
+      int w = row ? row(output, input, width) : 0;
 
       for (; w < width; w++)
       {
@@ -81,38 +327,100 @@ void conv_rgb565_0rgb1555(void *output_, const void *input_,
    }
 }
 
-void conv_0rgb1555_rgb565(void *output_, const void *input_,
-      int width, int height,
-      int out_stride, int in_stride)
+#if defined(__SSE2__)
+static int conv_0rgb1555_rgb565_sse2(void *output_, const void *input_,
+      int width)
 {
-   int h;
+   int w                   = 0;
    const uint16_t *input   = (const uint16_t*)input_;
    uint16_t *output        = (uint16_t*)output_;
-
-#if defined(__SSE2__)
-   int max_width           = width - 7;
-
    const __m128i hi_mask   = _mm_set1_epi16(
          (int16_t)((0x1f << 11) | (0x1f << 6)));
    const __m128i lo_mask   = _mm_set1_epi16(0x1f);
    const __m128i glow_mask = _mm_set1_epi16(1 << 5);
+
+   for (; w + 8 <= width; w += 8)
+   {
+      const __m128i in = _mm_loadu_si128((const __m128i*)(input + w));
+      __m128i rg   = _mm_and_si128(_mm_slli_epi16(in, 1), hi_mask);
+      __m128i b    = _mm_and_si128(in, lo_mask);
+      __m128i glow = _mm_and_si128(_mm_srli_epi16(in, 4), glow_mask);
+      _mm_storeu_si128((__m128i*)(output + w),
+            _mm_or_si128(rg, _mm_or_si128(b, glow)));
+   }
+
+   return w;
+}
+#endif
+
+#ifdef PIXCONV_HAVE_AVX2
+static PIXCONV_AVX2_TARGET int conv_0rgb1555_rgb565_avx2(void *output_,
+      const void *input_, int width)
+{
+   int w                   = 0;
+   const uint16_t *input   = (const uint16_t*)input_;
+   uint16_t *output        = (uint16_t*)output_;
+   const __m256i hi_mask   = _mm256_set1_epi16(
+         (int16_t)((0x1f << 11) | (0x1f << 6)));
+   const __m256i lo_mask   = _mm256_set1_epi16(0x1f);
+   const __m256i glow_mask = _mm256_set1_epi16(1 << 5);
+
+   for (; w + 16 <= width; w += 16)
+   {
+      const __m256i in = _mm256_loadu_si256((const __m256i*)(input + w));
+      __m256i rg   = _mm256_and_si256(_mm256_slli_epi16(in, 1), hi_mask);
+      __m256i b    = _mm256_and_si256(in, lo_mask);
+      __m256i glow = _mm256_and_si256(_mm256_srli_epi16(in, 4), glow_mask);
+      _mm256_storeu_si256((__m256i*)(output + w),
+            _mm256_or_si256(rg, _mm256_or_si256(b, glow)));
+   }
+
+   return w;
+}
 #endif
 
+#ifdef PIXCONV_HAVE_NEON
+static int conv_0rgb1555_rgb565_neon(void *output_, const void *input_,
+      int width)
+{
+   int w                      = 0;
+   const uint16_t *input      = (const uint16_t*)input_;
+   uint16_t *output           = (uint16_t*)output_;
+   const uint16x8_t hi_mask   = vdupq_n_u16((0x1f << 11) | (0x1f << 6));
+   const uint16x8_t lo_mask   = vdupq_n_u16(0x1f);
+   const uint16x8_t glow_mask = vdupq_n_u16(1 << 5);
+
+   for (; w + 8 <= width; w += 8)
+   {
+      uint16x8_t in   = vld1q_u16(input + w);
+      uint16x8_t rg   = vshlq_n_u16(in, 1);
+      uint16x8_t glow = vandq_u16(vshrq_n_u16(in, 4), glow_mask);
+      uint16x8_t b    = vandq_u16(in, lo_mask);
+      vst1q_u16(output + w,
+            vorrq_u16(vbslq_u16(hi_mask, rg, b), glow));
+   }
+
+   return w;
+}
+#endif
+
+void conv_0rgb1555_rgb565(void *output_, const void *input_,
+      int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   const uint16_t *input   = (const uint16_t*)input_;
+   uint16_t *output        = (uint16_t*)output_;
+   pixconv_row_t row       = pixconv_pick(
+         PIXCONV_AVX2(conv_0rgb1555_rgb565),
+         PIXCONV_SSE2(conv_0rgb1555_rgb565),
+         NULL,
+         PIXCONV_NEON(conv_0rgb1555_rgb565));
+
    for (h = 0; h < height;
          h++, output += out_stride >> 1, input += in_stride >> 1)
    {
-      int w = 0;
-#if defined(__SSE2__)
-      for (; w < max_width; w += 8)
-      {
-         const __m128i in = _mm_loadu_si128((const __m128i*)(input + w));
-         __m128i rg   = _mm_and_si128(_mm_slli_epi16(in, 1), hi_mask);
-         __m128i b    = _mm_and_si128(in, lo_mask);
-         __m128i glow = _mm_and_si128(_mm_srli_epi16(in, 4), glow_mask);
-         _mm_storeu_si128((__m128i*)(output + w),
-               _mm_or_si128(rg, _mm_or_si128(b, glow)));
-      }
-#endif
+      int w = row ? row(output, input, width) : 0;
 
       for (; w < width; w++)
       {
@@ -125,57 +433,119 @@ void conv_0rgb1555_rgb565(void *output_, const void *input_,
    }
 }
 
-void conv_0rgb1555_argb8888(void *output_, const void *input_,
-      int width, int height,
-      int out_stride, int in_stride)
+#if defined(__SSE2__)
+static int conv_0rgb1555_argb8888_sse2(void *output_, const void *input_,
+      int width)
 {
-   int h;
-   const uint16_t *input = (const uint16_t*)input_;
-   uint32_t *output      = (uint32_t*)output_;
-
-#ifdef __SSE2__
+   int w                     = 0;
+   const uint16_t *input     = (const uint16_t*)input_;
+   uint32_t *output          = (uint32_t*)output_;
    const __m128i pix_mask_r  = _mm_set1_epi16(0x1f << 10);
    const __m128i pix_mask_gb = _mm_set1_epi16(0x1f <<  5);
    const __m128i mul15_mid   = _mm_set1_epi16(0x4200);
    const __m128i mul15_hi    = _mm_set1_epi16(0x0210);
    const __m128i a           = _mm_set1_epi16(0x00ff);
 
-   int max_width = width - 7;
+   for (; w + 8 <= width; w += 8)
+   {
+      __m128i res_lo_bg, res_hi_bg;
+      __m128i res_lo_ra, res_hi_ra;
+      __m128i res_lo, res_hi;
+      const __m128i in = _mm_loadu_si128((const __m128i*)(input + w));
+      __m128i r = _mm_and_si128(in, pix_mask_r);
+      __m128i g = _mm_and_si128(in, pix_mask_gb);
+      __m128i b = _mm_and_si128(_mm_slli_epi16(in, 5), pix_mask_gb);
+
+      r = _mm_mulhi_epi16(r, mul15_hi);
+      g = _mm_mulhi_epi16(g, mul15_mid);
+      b = _mm_mulhi_epi16(b, mul15_mid);
+
+      res_lo_bg = _mm_unpacklo_epi8(b, g);
+      res_hi_bg = _mm_unpackhi_epi8(b, g);
+      res_lo_ra = _mm_unpacklo_epi8(r, a);
+      res_hi_ra = _mm_unpackhi_epi8(r, a);
+
+      res_lo = _mm_or_si128(res_lo_bg,
+            _mm_slli_si128(res_lo_ra, 2));
+      res_hi = _mm_or_si128(res_hi_bg,
+            _mm_slli_si128(res_hi_ra, 2));
+
+      _mm_storeu_si128((__m128i*)(output + w + 0), res_lo);
+      _mm_storeu_si128((__m128i*)(output + w + 4), res_hi);
+   }
+
+   return w;
+}
 #endif
 
+#ifdef PIXCONV_HAVE_AVX2
+static PIXCONV_AVX2_TARGET int conv_0rgb1555_argb8888_avx2(void *output_,
+      const void *input_, int width)
+{
+   int w                     = 0;
+   const uint16_t *input     = (const uint16_t*)input_;
+   uint32_t *output          = (uint32_t*)output_;
+   const __m256i pix_mask_r  = _mm256_set1_epi16(0x1f << 10);
+   const __m256i pix_mask_gb = _mm256_set1_epi16(0x1f <<  5);
+   const __m256i mul15_mid   = _mm256_set1_epi16(0x4200);
+   const __m256i mul15_hi    = _mm256_set1_epi16(0x0210);
+
+   for (; w + 16 <= width; w += 16)
+   {
+      const __m256i in = _mm256_loadu_si256((const __m256i*)(input + w));
+      __m256i r = _mm256_and_si256(in, pix_mask_r);
+      __m256i g = _mm256_and_si256(in, pix_mask_gb);
+      __m256i b = _mm256_and_si256(_mm256_slli_epi16(in, 5), pix_mask_gb);
+
+      r = _mm256_mulhi_epi16(r, mul15_hi);
+      g = _mm256_mulhi_epi16(g, mul15_mid);
+      b = _mm256_mulhi_epi16(b, mul15_mid);
+
+      pixconv_store_argb8888_avx2(output + w, b, g, r);
+   }
+
+   return w;
+}
+#endif
+
+#ifdef PIXCONV_HAVE_NEON
+static int conv_0rgb1555_argb8888_neon(void *output_, const void *input_,
+      int width)
+{
+   int w                 = 0;
+   const uint16_t *input = (const uint16_t*)input_;
+   uint32_t *output      = (uint32_t*)output_;
+
+   for (; w + 16 <= width; w += 16)
+   {
+      uint8x16x4_t px;
+      pixconv_unpack_0rgb1555_neon(vld2q_u8((const uint8_t*)(input + w)),
+            &px.val[2], &px.val[1], &px.val[0]);
+      px.val[3] = vdupq_n_u8(0xff);
+      vst4q_u8((uint8_t*)(output + w), px);
+   }
+
+   return w;
+}
+#endif
+
+void conv_0rgb1555_argb8888(void *output_, const void *input_,
+      int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   const uint16_t *input = (const uint16_t*)input_;
+   uint32_t *output      = (uint32_t*)output_;
+   pixconv_row_t row     = pixconv_pick(
+         PIXCONV_AVX2(conv_0rgb1555_argb8888),
+         PIXCONV_SSE2(conv_0rgb1555_argb8888),
+         NULL,
+         PIXCONV_NEON(conv_0rgb1555_argb8888));
+
    for (h = 0; h < height;
          h++, output += out_stride >> 2, input += in_stride >> 1)
    {
-      int w = 0;
-#ifdef __SSE2__
-      for (; w < max_width; w += 8)
-      {
-         __m128i res_lo_bg, res_hi_bg;
-         __m128i res_lo_ra, res_hi_ra;
-         __m128i res_lo, res_hi;
-         const __m128i in = _mm_loadu_si128((const __m128i*)(input + w));
-         __m128i r = _mm_and_si128(in, pix_mask_r);
-         __m128i g = _mm_and_si128(in, pix_mask_gb);
-         __m128i b = _mm_and_si128(_mm_slli_epi16(in, 5), pix_mask_gb);
-
-         r = _mm_mulhi_epi16(r, mul15_hi);
-         g = _mm_mulhi_epi16(g, mul15_mid);
-         b = _mm_mulhi_epi16(b, mul15_mid);
-
-         res_lo_bg = _mm_unpacklo_epi8(b, g);
-         res_hi_bg = _mm_unpackhi_epi8(b, g);
-         res_lo_ra = _mm_unpacklo_epi8(r, a);
-         res_hi_ra = _mm_unpackhi_epi8(r, a);
-
-         res_lo = _mm_or_si128(res_lo_bg,
-               _mm_slli_si128(res_lo_ra, 2));
-         res_hi = _mm_or_si128(res_hi_bg,
-               _mm_slli_si128(res_hi_ra, 2));
-
-         _mm_storeu_si128((__m128i*)(output + w + 0), res_lo);
-         _mm_storeu_si128((__m128i*)(output + w + 4), res_hi);
-      }
-#endif
+      int w = row ? row(output, input, width) : 0;
 
       for (; w < width; w++)
       {
@@ -192,15 +562,13 @@ void conv_0rgb1555_argb8888(void *output_, const void *input_,
    }
 }
 
-void conv_rgb565_argb8888(void *output_, const void *input_,
-      int width, int height,
-      int out_stride, int in_stride)
+#if defined(__SSE2__)
+static int conv_rgb565_argb8888_sse2(void *output_, const void *input_,
+      int width)
 {
-   int h;
+   int w                    = 0;
    const uint16_t *input    = (const uint16_t*)input_;
    uint32_t *output         = (uint32_t*)output_;
-
-#if defined(__SSE2__)
    const __m128i pix_mask_r = _mm_set1_epi16(0x1f << 10);
    const __m128i pix_mask_g = _mm_set1_epi16(0x3f <<  5);
    const __m128i pix_mask_b = _mm_set1_epi16(0x1f <<  5);
@@ -209,8 +577,44 @@ void conv_rgb565_argb8888(void *output_, const void *input_,
    const __m128i mul16_b    = _mm_set1_epi16(0x4200);
    const __m128i a          = _mm_set1_epi16(0x00ff);
 
-   int max_width            = width - 7;
-#elif defined(__MMX__)
+   for (; w + 8 <= width; w += 8)
+   {
+      __m128i res_lo, res_hi;
+      __m128i res_lo_bg, res_hi_bg, res_lo_ra, res_hi_ra;
+      const __m128i in = _mm_loadu_si128((const __m128i*)(input + w));
+      __m128i        r = _mm_and_si128(_mm_srli_epi16(in, 1), pix_mask_r);
+      __m128i        g = _mm_and_si128(in, pix_mask_g);
+      __m128i        b = _mm_and_si128(_mm_slli_epi16(in, 5), pix_mask_b);
+
+      r                = _mm_mulhi_epi16(r, mul16_r);
+      g                = _mm_mulhi_epi16(g, mul16_g);
+      b                = _mm_mulhi_epi16(b, mul16_b);
+
+      res_lo_bg        = _mm_unpacklo_epi8(b, g);
+      res_hi_bg        = _mm_unpackhi_epi8(b, g);
+      res_lo_ra        = _mm_unpacklo_epi8(r, a);
+      res_hi_ra        = _mm_unpackhi_epi8(r, a);
+
+      res_lo           = _mm_or_si128(res_lo_bg,
+            _mm_slli_si128(res_lo_ra, 2));
+      res_hi           = _mm_or_si128(res_hi_bg,
+            _mm_slli_si128(res_hi_ra, 2));
+
+      _mm_storeu_si128((__m128i*)(output + w + 0), res_lo);
+      _mm_storeu_si128((__m128i*)(output + w + 4), res_hi);
+   }
+
+   return w;
+}
+#endif
+
+#if defined(__MMX__)
+static int conv_rgb565_argb8888_mmx(void *output_, const void *input_,
+      int width)
+{
+   int w                  = 0;
+   const uint16_t *input  = (const uint16_t*)input_;
+   uint32_t *output       = (uint32_t*)output_;
    const __m64 pix_mask_r = _mm_set1_pi16(0x1f << 10);
    const __m64 pix_mask_g = _mm_set1_pi16(0x3f << 5);
    const __m64 pix_mask_b = _mm_set1_pi16(0x1f << 5);
@@ -219,71 +623,109 @@ void conv_rgb565_argb8888(void *output_, const void *input_,
    const __m64 mul16_b    = _mm_set1_pi16(0x4200);
    const __m64 a          = _mm_set1_pi16(0x00ff);
 
-   int max_width            = width - 3;
+   for (; w + 4 <= width; w += 4)
+   {
+      __m64 res_lo, res_hi;
+      __m64 res_lo_bg, res_hi_bg, res_lo_ra, res_hi_ra;
+      const __m64 in = *((__m64*)(input + w));
+      __m64          r = _mm_and_si64(_mm_srli_pi16(in, 1), pix_mask_r);
+      __m64          g = _mm_and_si64(in, pix_mask_g);
+      __m64          b = _mm_and_si64(_mm_slli_pi16(in, 5), pix_mask_b);
+
+      r                = _mm_mulhi_pi16(r, mul16_r);
+      g                = _mm_mulhi_pi16(g, mul16_g);
+      b                = _mm_mulhi_pi16(b, mul16_b);
+
+      res_lo_bg        = _mm_unpacklo_pi8(b, g);
+      res_hi_bg        = _mm_unpackhi_pi8(b, g);
+      res_lo_ra        = _mm_unpacklo_pi8(r, a);
+      res_hi_ra        = _mm_unpackhi_pi8(r, a);
+
+      res_lo           = _mm_or_si64(res_lo_bg,
+            _mm_slli_si64(res_lo_ra, 16));
+      res_hi           = _mm_or_si64(res_hi_bg,
+            _mm_slli_si64(res_hi_ra, 16));
+
+      *((__m64*)(output + w + 0)) = res_lo;
+      *((__m64*)(output + w + 2)) = res_hi;
+   }
+
+   _mm_empty();
+   return w;
+}
 #endif
 
-   for (h = 0; h < height;
-         h++, output += out_stride >> 2, input += in_stride >> 1)
+#ifdef PIXCONV_HAVE_AVX2
+static PIXCONV_AVX2_TARGET int conv_rgb565_argb8888_avx2(void *output_,
+      const void *input_, int width)
+{
+   int w                    = 0;
+   const uint16_t *input    = (const uint16_t*)input_;
+   uint32_t *output         = (uint32_t*)output_;
+   const __m256i pix_mask_r = _mm256_set1_epi16(0x1f << 10);
+   const __m256i pix_mask_g = _mm256_set1_epi16(0x3f <<  5);
+   const __m256i pix_mask_b = _mm256_set1_epi16(0x1f <<  5);
+   const __m256i mul16_r    = _mm256_set1_epi16(0x0210);
+   const __m256i mul16_g    = _mm256_set1_epi16(0x2080);
+   const __m256i mul16_b    = _mm256_set1_epi16(0x4200);
+
+   for (; w + 16 <= width; w += 16)
    {
-      int w = 0;
-#if defined(__SSE2__)
-      for (; w < max_width; w += 8)
-      {
-         __m128i res_lo, res_hi;
-         __m128i res_lo_bg, res_hi_bg, res_lo_ra, res_hi_ra;
-         const __m128i in = _mm_loadu_si128((const __m128i*)(input + w));
-         __m128i        r = _mm_and_si128(_mm_srli_epi16(in, 1), pix_mask_r);
-         __m128i        g = _mm_and_si128(in, pix_mask_g);
-         __m128i        b = _mm_and_si128(_mm_slli_epi16(in, 5), pix_mask_b);
-
-         r                = _mm_mulhi_epi16(r, mul16_r);
-         g                = _mm_mulhi_epi16(g, mul16_g);
-         b                = _mm_mulhi_epi16(b, mul16_b);
-
-         res_lo_bg        = _mm_unpacklo_epi8(b, g);
-         res_hi_bg        = _mm_unpackhi_epi8(b, g);
-         res_lo_ra        = _mm_unpacklo_epi8(r, a);
-         res_hi_ra        = _mm_unpackhi_epi8(r, a);
-
-         res_lo           = _mm_or_si128(res_lo_bg,
-               _mm_slli_si128(res_lo_ra, 2));
-         res_hi           = _mm_or_si128(res_hi_bg,
-               _mm_slli_si128(res_hi_ra, 2));
-
-         _mm_storeu_si128((__m128i*)(output + w + 0), res_lo);
-         _mm_storeu_si128((__m128i*)(output + w + 4), res_hi);
-      }
-#elif defined(__MMX__)
-      for (; w < max_width; w += 4)
-      {
-         __m64 res_lo, res_hi;
-         __m64 res_lo_bg, res_hi_bg, res_lo_ra, res_hi_ra;
-         const __m64 in = *((__m64*)(input + w));
-         __m64          r = _mm_and_si64(_mm_srli_pi16(in, 1), pix_mask_r);
-         __m64          g = _mm_and_si64(in, pix_mask_g);
-         __m64          b = _mm_and_si64(_mm_slli_pi16(in, 5), pix_mask_b);
-
-         r                = _mm_mulhi_pi16(r, mul16_r);
-         g                = _mm_mulhi_pi16(g, mul16_g);
-         b                = _mm_mulhi_pi16(b, mul16_b);
-
-         res_lo_bg        = _mm_unpacklo_pi8(b, g);
-         res_hi_bg        = _mm_unpackhi_pi8(b, g);
-         res_lo_ra        = _mm_unpacklo_pi8(r, a);
-         res_hi_ra        = _mm_unpackhi_pi8(r, a);
-
-         res_lo           = _mm_or_si64(res_lo_bg,
-               _mm_slli_si64(res_lo_ra, 16));
-         res_hi           = _mm_or_si64(res_hi_bg,
-               _mm_slli_si64(res_hi_ra, 16));
-
-         *((__m64*)(output + w + 0)) = res_lo;
-         *((__m64*)(output + w + 2)) = res_hi;
-      }
+      const __m256i in = _mm256_loadu_si256((const __m256i*)(input + w));
+      __m256i r = _mm256_and_si256(_mm256_srli_epi16(in, 1), pix_mask_r);
+      __m256i g = _mm256_and_si256(in, pix_mask_g);
+      __m256i b = _mm256_and_si256(_mm256_slli_epi16(in, 5), pix_mask_b);
+
+      r = _mm256_mulhi_epi16(r, mul16_r);
+      g = _mm256_mulhi_epi16(g, mul16_g);
+      b = _mm256_mulhi_epi16(b, mul16_b);
 
-      _mm_empty();
+      pixconv_store_argb8888_avx2(output + w, b, g, r);
+   }
+
+   return w;
+}
+#endif
+
+#ifdef PIXCONV_HAVE_NEON
+static int conv_rgb565_argb8888_neon(void *output_, const void *input_,
+      int width)
+{
+   int w                 = 0;
+   const uint16_t *input = (const uint16_t*)input_;
+   uint32_t *output      = (uint32_t*)output_;
+
+   for (; w + 16 <= width; w += 16)
+   {
+      uint8x16x4_t px;
+      pixconv_unpack_rgb565_neon(vld2q_u8((const uint8_t*)(input + w)),
+            &px.val[2], &px.val[1], &px.val[0]);
+      px.val[3] = vdupq_n_u8(0xff);
+      vst4q_u8((uint8_t*)(output + w), px);
+   }
+
+   return w;
+}
 #endif
 
+void conv_rgb565_argb8888(void *output_, const void *input_,
+      int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   const uint16_t *input    = (const uint16_t*)input_;
+   uint32_t *output         = (uint32_t*)output_;
+   pixconv_row_t row        = pixconv_pick(
+         PIXCONV_AVX2(conv_rgb565_argb8888),
+         PIXCONV_SSE2(conv_rgb565_argb8888),
+         PIXCONV_MMX(conv_rgb565_argb8888),
+         PIXCONV_NEON(conv_rgb565_argb8888));
+
+   for (h = 0; h < height;
+         h++, output += out_stride >> 2, input += in_stride >> 1)
+   {
+      int w = row ? row(output, input, width) : 0;
+
       for (; w < width; w++)
       {
          uint32_t col = input[w];
@@ -299,14 +741,13 @@ void conv_rgb565_argb8888(void *output_, const void *input_,
    }
 }
 
-void conv_rgb565_abgr8888(void *output_, const void *input_,
-      int width, int height,
-      int out_stride, int in_stride)
+#if defined(__SSE2__)
+static int conv_rgb565_abgr8888_sse2(void *output_, const void *input_,
+      int width)
 {
-   int h;
+   int w                    = 0;
    const uint16_t *input    = (const uint16_t*)input_;
    uint32_t *output         = (uint32_t*)output_;
- #if defined(__SSE2__)
    const __m128i pix_mask_r = _mm_set1_epi16(0x1f << 10);
    const __m128i pix_mask_g = _mm_set1_epi16(0x3f <<  5);
    const __m128i pix_mask_b = _mm_set1_epi16(0x1f <<  5);
@@ -314,37 +755,106 @@ void conv_rgb565_abgr8888(void *output_, const void *input_,
    const __m128i mul16_g    = _mm_set1_epi16(0x2080);
    const __m128i mul16_b    = _mm_set1_epi16(0x4200);
    const __m128i a          = _mm_set1_epi16(0x00ff);
-    int max_width            = width - 7;
+
+   for (; w + 8 <= width; w += 8)
+   {
+      __m128i res_lo, res_hi;
+      __m128i res_lo_rg, res_hi_rg, res_lo_ba, res_hi_ba;
+      const __m128i in = _mm_loadu_si128((const __m128i*)(input + w));
+      __m128i        r = _mm_and_si128(_mm_srli_epi16(in, 1), pix_mask_r);
+      __m128i        g = _mm_and_si128(in, pix_mask_g);
+      __m128i        b = _mm_and_si128(_mm_slli_epi16(in, 5), pix_mask_b);
+      r                = _mm_mulhi_epi16(r, mul16_r);
+      g                = _mm_mulhi_epi16(g, mul16_g);
+      b                = _mm_mulhi_epi16(b, mul16_b);
+      res_lo_rg        = _mm_unpacklo_epi8(r, g);
+      res_hi_rg        = _mm_unpackhi_epi8(r, g);
+      res_lo_ba        = _mm_unpacklo_epi8(b, a);
+      res_hi_ba        = _mm_unpackhi_epi8(b, a);
+      res_lo           = _mm_or_si128(res_lo_rg,
+            _mm_slli_si128(res_lo_ba, 2));
+      res_hi           = _mm_or_si128(res_hi_rg,
+            _mm_slli_si128(res_hi_ba, 2));
+      _mm_storeu_si128((__m128i*)(output + w + 0), res_lo);
+      _mm_storeu_si128((__m128i*)(output + w + 4), res_hi);
+   }
+
+   return w;
+}
 #endif
-    for (h = 0; h < height;
-         h++, output += out_stride >> 2, input += in_stride >> 1)
+
+#ifdef PIXCONV_HAVE_AVX2
+static PIXCONV_AVX2_TARGET int conv_rgb565_abgr8888_avx2(void *output_,
+      const void *input_, int width)
+{
+   int w                    = 0;
+   const uint16_t *input    = (const uint16_t*)input_;
+   uint32_t *output         = (uint32_t*)output_;
+   const __m256i pix_mask_r = _mm256_set1_epi16(0x1f << 10);
+   const __m256i pix_mask_g = _mm256_set1_epi16(0x3f <<  5);
+   const __m256i pix_mask_b = _mm256_set1_epi16(0x1f <<  5);
+   const __m256i mul16_r    = _mm256_set1_epi16(0x0210);
+   const __m256i mul16_g    = _mm256_set1_epi16(0x2080);
+   const __m256i mul16_b    = _mm256_set1_epi16(0x4200);
+
+   for (; w + 16 <= width; w += 16)
    {
-      int w = 0;
-#if defined(__SSE2__)
-      for (; w < max_width; w += 8)
-      {
-         __m128i res_lo, res_hi;
-         __m128i res_lo_bg, res_hi_bg, res_lo_ra, res_hi_ra;
-         const __m128i in = _mm_loadu_si128((const __m128i*)(input + w));
-         __m128i        r = _mm_and_si128(_mm_srli_epi16(in, 1), pix_mask_r);
-         __m128i        g = _mm_and_si128(in, pix_mask_g);
-         __m128i        b = _mm_and_si128(_mm_slli_epi16(in, 5), pix_mask_b);
-         r                = _mm_mulhi_epi16(r, mul16_r);
-         g                = _mm_mulhi_epi16(g, mul16_g);
-         b                = _mm_mulhi_epi16(b, mul16_b);
-         res_lo_bg        = _mm_unpacklo_epi8(b, g);
-         res_hi_bg        = _mm_unpackhi_epi8(b, g);
-         res_lo_ra        = _mm_unpacklo_epi8(r, a);
-         res_hi_ra        = _mm_unpackhi_epi8(r, a);
-         res_lo           = _mm_or_si128(res_lo_bg,
-               _mm_slli_si128(res_lo_ra, 2));
-         res_hi           = _mm_or_si128(res_hi_bg,
-               _mm_slli_si128(res_hi_ra, 2));
-         _mm_storeu_si128((__m128i*)(output + w + 0), res_lo);
-         _mm_storeu_si128((__m128i*)(output + w + 4), res_hi);
-      }
+      const __m256i in = _mm256_loadu_si256((const __m256i*)(input + w));
+      __m256i r = _mm256_and_si256(_mm256_srli_epi16(in, 1), pix_mask_r);
+      __m256i g = _mm256_and_si256(in, pix_mask_g);
+      __m256i b = _mm256_and_si256(_mm256_slli_epi16(in, 5), pix_mask_b);
+
+      r = _mm256_mulhi_epi16(r, mul16_r);
+      g = _mm256_mulhi_epi16(g, mul16_g);
+      b = _mm256_mulhi_epi16(b, mul16_b);
+
+      pixconv_store_argb8888_avx2(output + w, r, g, b);
+   }
+
+   return w;
+}
 #endif
-       for (; w < width; w++)
+
+#ifdef PIXCONV_HAVE_NEON
+static int conv_rgb565_abgr8888_neon(void *output_, const void *input_,
+      int width)
+{
+   int w                 = 0;
+   const uint16_t *input = (const uint16_t*)input_;
+   uint32_t *output      = (uint32_t*)output_;
+
+   for (; w + 16 <= width; w += 16)
+   {
+      uint8x16x4_t px;
+      pixconv_unpack_rgb565_neon(vld2q_u8((const uint8_t*)(input + w)),
+            &px.val[0], &px.val[1], &px.val[2]);
+      px.val[3] = vdupq_n_u8(0xff);
+      vst4q_u8((uint8_t*)(output + w), px);
+   }
+
+   return w;
+}
+#endif
+
+void conv_rgb565_abgr8888(void *output_, const void *input_,
+      int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   const uint16_t *input    = (const uint16_t*)input_;
+   uint32_t *output         = (uint32_t*)output_;
+   pixconv_row_t row        = pixconv_pick(
+         PIXCONV_AVX2(conv_rgb565_abgr8888),
+         PIXCONV_SSE2(conv_rgb565_abgr8888),
+         NULL,
+         PIXCONV_NEON(conv_rgb565_abgr8888));
+
+   for (h = 0; h < height;
+         h++, output += out_stride >> 2, input += in_stride >> 1)
+   {
+      int w = row ? row(output, input, width) : 0;
+
+      for (; w < width; w++)
       {
          uint32_t col = input[w];
          uint32_t r   = (col >> 11) & 0x1f;
@@ -358,89 +868,227 @@ void conv_rgb565_abgr8888(void *output_, const void *input_,
    }
 }
 
+#if defined(__SSE2__)
+static int conv_argb8888_rgba4444_sse2(void *output_, const void *input_,
+      int width)
+{
+   int w                 = 0;
+   const uint32_t *input = (const uint32_t*)input_;
+   uint16_t *output      = (uint16_t*)output_;
+   const __m128i r_mask  = _mm_set1_epi32(0xf000);
+   const __m128i g_mask  = _mm_set1_epi32(0x0f00);
+   const __m128i b_mask  = _mm_set1_epi32(0x00f0);
+
+   for (; w + 8 <= width; w += 8)
+   {
+      __m128i c0  = _mm_loadu_si128((const __m128i*)(input + w + 0));
+      __m128i c1  = _mm_loadu_si128((const __m128i*)(input + w + 4));
+      __m128i rg0 = _mm_or_si128(
+            _mm_and_si128(_mm_srli_epi32(c0, 8), r_mask),
+            _mm_and_si128(_mm_srli_epi32(c0, 4), g_mask));
+      __m128i rg1 = _mm_or_si128(
+            _mm_and_si128(_mm_srli_epi32(c1, 8), r_mask),
+            _mm_and_si128(_mm_srli_epi32(c1, 4), g_mask));
+      __m128i ba0 = _mm_or_si128(
+            _mm_and_si128(c0, b_mask), _mm_srli_epi32(c0, 28));
+      __m128i ba1 = _mm_or_si128(
+            _mm_and_si128(c1, b_mask), _mm_srli_epi32(c1, 28));
+      _mm_storeu_si128((__m128i*)(output + w), pixconv_pack_epi32_sse2(
+               _mm_or_si128(rg0, ba0), _mm_or_si128(rg1, ba1)));
+   }
+
+   return w;
+}
+#endif
+
+#ifdef PIXCONV_HAVE_NEON
+static int conv_argb8888_rgba4444_neon(void *output_, const void *input_,
+      int width)
+{
+   int w                 = 0;
+   const uint32_t *input = (const uint32_t*)input_;
+   uint16_t *output      = (uint16_t*)output_;
+
+   for (; w + 16 <= width; w += 16)
+   {
+      uint8x16x2_t out;
+      uint8x16x4_t px = vld4q_u8((const uint8_t*)(input + w));
+      out.val[0]      = vsriq_n_u8(px.val[0], px.val[3], 4);
+      out.val[1]      = vsriq_n_u8(px.val[2], px.val[1], 4);
+      vst2q_u8((uint8_t*)(output + w), out);
+   }
+
+   return w;
+}
+#endif
+
 void conv_argb8888_rgba4444(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
 {
-   int h, w;
+   int h;
    const uint32_t *input = (const uint32_t*)input_;
    uint16_t *output      = (uint16_t*)output_;
+   pixconv_row_t row     = pixconv_pick(NULL,
+         PIXCONV_SSE2(conv_argb8888_rgba4444),
+         NULL,
+         PIXCONV_NEON(conv_argb8888_rgba4444));
 
    for (h = 0; h < height;
-         h++, output += out_stride >> 2, input += in_stride >> 1)
+         h++, output += out_stride >> 1, input += in_stride >> 2)
    {
-      for (w = 0; w < width; w++)
+      int w = row ? row(output, input, width) : 0;
+
+      for (; w < width; w++)
       {
          uint32_t col = input[w];
-         uint32_t r   = (col >> 16) & 0xf;
-         uint32_t g   = (col >>  8) & 0xf;
-         uint32_t b   = (col) & 0xf;
-         uint32_t a   = (col >>  24) & 0xf;
-         r            = (r >> 4) | r;
-         g            = (g >> 4) | g;
-         b            = (b >> 4) | b;
-         a            = (a >> 4) | a;
+         uint32_t r   = (col >> 20) & 0xf;
+         uint32_t g   = (col >> 12) & 0xf;
+         uint32_t b   = (col >>  4) & 0xf;
+         uint32_t a   = (col >> 28) & 0xf;
 
          output[w]    = (r << 12) | (g << 8) | (b << 4) | a;
       }
    }
 }
 
-void conv_rgba4444_argb8888(void *output_, const void *input_,
-      int width, int height,
-      int out_stride, int in_stride)
+#if defined(__SSE2__)
+static int conv_rgba4444_argb8888_sse2(void *output_, const void *input_,
+      int width)
 {
-   int h;
-   const uint16_t *input = (const uint16_t*)input_;
-   uint32_t *output      = (uint32_t*)output_;
+   int w                     = 0;
+   const uint16_t *input     = (const uint16_t*)input_;
+   uint32_t *output          = (uint32_t*)output_;
+   const __m128i pix_mask_r  = _mm_set1_epi16(0xf << 10);
+   const __m128i pix_mask_gb = _mm_set1_epi16(0xf << 8);
+   const __m128i pix_mask_a  = _mm_set1_epi16(0xf);
+   const __m128i mul16_r     = _mm_set1_epi16(0x0440);
+   const __m128i mul16_gb    = _mm_set1_epi16(0x1100);
+   const __m128i mul16_a     = _mm_set1_epi16(0x0011);
+
+   for (; w + 8 <= width; w += 8)
+   {
+      __m128i res_lo, res_hi;
+      __m128i res_lo_bg, res_hi_bg, res_lo_ra, res_hi_ra;
+      const __m128i in = _mm_loadu_si128((const __m128i*)(input + w));
+      __m128i        r = _mm_and_si128(_mm_srli_epi16(in, 2), pix_mask_r);
+      __m128i        g = _mm_and_si128(in, pix_mask_gb);
+      __m128i        b = _mm_and_si128(_mm_slli_epi16(in, 4), pix_mask_gb);
+      __m128i        a = _mm_and_si128(in, pix_mask_a);
+
+      r                = _mm_mulhi_epi16(r, mul16_r);
+      g                = _mm_mulhi_epi16(g, mul16_gb);
+      b                = _mm_mulhi_epi16(b, mul16_gb);
+      a                = _mm_mullo_epi16(a, mul16_a);
+
+      res_lo_bg        = _mm_unpacklo_epi8(b, g);
+      res_hi_bg        = _mm_unpackhi_epi8(b, g);
+      res_lo_ra        = _mm_unpacklo_epi8(r, a);
+      res_hi_ra        = _mm_unpackhi_epi8(r, a);
+
+      res_lo           = _mm_or_si128(res_lo_bg,
+            _mm_slli_si128(res_lo_ra, 2));
+      res_hi           = _mm_or_si128(res_hi_bg,
+            _mm_slli_si128(res_hi_ra, 2));
+
+      _mm_storeu_si128((__m128i*)(output + w + 0), res_lo);
+      _mm_storeu_si128((__m128i*)(output + w + 4), res_hi);
+   }
+
+   return w;
+}
+#endif
 
 #if defined(__MMX__)
+static int conv_rgba4444_argb8888_mmx(void *output_, const void *input_,
+      int width)
+{
+   int w                  = 0;
+   const uint16_t *input  = (const uint16_t*)input_;
+   uint32_t *output       = (uint32_t*)output_;
    const __m64 pix_mask_r = _mm_set1_pi16(0xf << 10);
    const __m64 pix_mask_g = _mm_set1_pi16(0xf << 8);
    const __m64 pix_mask_b = _mm_set1_pi16(0xf << 8);
+   const __m64 pix_mask_a = _mm_set1_pi16(0xf);
    const __m64 mul16_r    = _mm_set1_pi16(0x0440);
    const __m64 mul16_g    = _mm_set1_pi16(0x1100);
    const __m64 mul16_b    = _mm_set1_pi16(0x1100);
-   const __m64 a          = _mm_set1_pi16(0x00ff);
+   const __m64 mul16_a    = _mm_set1_pi16(0x0011);
 
-   int max_width            = width - 3;
+   for (; w + 4 <= width; w += 4)
+   {
+      __m64 res_lo, res_hi;
+      __m64 res_lo_bg, res_hi_bg, res_lo_ra, res_hi_ra;
+      const __m64 in = *((__m64*)(input + w));
+      __m64          r = _mm_and_si64(_mm_srli_pi16(in, 2), pix_mask_r);
+      __m64          g = _mm_and_si64(in, pix_mask_g);
+      __m64          b = _mm_and_si64(_mm_slli_pi16(in, 4), pix_mask_b);
+      __m64          a = _mm_and_si64(in, pix_mask_a);
+
+      r                = _mm_mulhi_pi16(r, mul16_r);
+      g                = _mm_mulhi_pi16(g, mul16_g);
+      b                = _mm_mulhi_pi16(b, mul16_b);
+      a                = _mm_mullo_pi16(a, mul16_a);
+
+      res_lo_bg        = _mm_unpacklo_pi8(b, g);
+      res_hi_bg        = _mm_unpackhi_pi8(b, g);
+      res_lo_ra        = _mm_unpacklo_pi8(r, a);
+      res_hi_ra        = _mm_unpackhi_pi8(r, a);
+
+      res_lo           = _mm_or_si64(res_lo_bg,
+            _mm_slli_si64(res_lo_ra, 16));
+      res_hi           = _mm_or_si64(res_hi_bg,
+            _mm_slli_si64(res_hi_ra, 16));
+
+      *((__m64*)(output + w + 0)) = res_lo;
+      *((__m64*)(output + w + 2)) = res_hi;
+   }
+
+   _mm_empty();
+   return w;
+}
 #endif
 
-   for (h = 0; h < height;
-         h++, output += out_stride >> 2, input += in_stride >> 1)
+#ifdef PIXCONV_HAVE_NEON
+static int conv_rgba4444_argb8888_neon(void *output_, const void *input_,
+      int width)
+{
+   int w                 = 0;
+   const uint16_t *input = (const uint16_t*)input_;
+   uint32_t *output      = (uint32_t*)output_;
+
+   for (; w + 16 <= width; w += 16)
    {
-      int w = 0;
-#if defined(__MMX__)
-      for (; w < max_width; w += 4)
-      {
-         __m64 res_lo, res_hi;
-         __m64 res_lo_bg, res_hi_bg, res_lo_ra, res_hi_ra;
-         const __m64 in = *((__m64*)(input + w));
-         __m64          r = _mm_and_si64(_mm_srli_pi16(in, 2), pix_mask_r);
-         __m64          g = _mm_and_si64(in, pix_mask_g);
-         __m64          b = _mm_and_si64(_mm_slli_pi16(in, 4), pix_mask_b);
-
-         r                = _mm_mulhi_pi16(r, mul16_r);
-         g                = _mm_mulhi_pi16(g, mul16_g);
-         b                = _mm_mulhi_pi16(b, mul16_b);
-
-         res_lo_bg        = _mm_unpacklo_pi8(b, g);
-         res_hi_bg        = _mm_unpackhi_pi8(b, g);
-         res_lo_ra        = _mm_unpacklo_pi8(r, a);
-         res_hi_ra        = _mm_unpackhi_pi8(r, a);
-
-         res_lo           = _mm_or_si64(res_lo_bg,
-               _mm_slli_si64(res_lo_ra, 16));
-         res_hi           = _mm_or_si64(res_hi_bg,
-               _mm_slli_si64(res_hi_ra, 16));
-
-         *((__m64*)(output + w + 0)) = res_lo;
-         *((__m64*)(output + w + 2)) = res_hi;
-      }
+      uint8x16x4_t px;
+      uint8x16x2_t in = vld2q_u8((const uint8_t*)(input + w));
+      px.val[0]       = vsriq_n_u8(in.val[0], in.val[0], 4);
+      px.val[1]       = vsliq_n_u8(in.val[1], in.val[1], 4);
+      px.val[2]       = vsriq_n_u8(in.val[1], in.val[1], 4);
+      px.val[3]       = vsliq_n_u8(in.val[0], in.val[0], 4);
+      vst4q_u8((uint8_t*)(output + w), px);
+   }
 
-      _mm_empty();
+   return w;
+}
 #endif
 
+void conv_rgba4444_argb8888(void *output_, const void *input_,
+      int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   const uint16_t *input = (const uint16_t*)input_;
+   uint32_t *output      = (uint32_t*)output_;
+   pixconv_row_t row     = pixconv_pick(NULL,
+         PIXCONV_SSE2(conv_rgba4444_argb8888),
+         PIXCONV_MMX(conv_rgba4444_argb8888),
+         PIXCONV_NEON(conv_rgba4444_argb8888));
+
+   for (h = 0; h < height;
+         h++, output += out_stride >> 2, input += in_stride >> 1)
+   {
+      int w = row ? row(output, input, width) : 0;
+
       for (; w < width; w++)
       {
          uint32_t col = input[w];
@@ -458,18 +1106,73 @@ void conv_rgba4444_argb8888(void *output_, const void *input_,
    }
 }
 
+#if defined(__SSE2__)
+static int conv_rgba4444_rgb565_sse2(void *output_, const void *input_,
+      int width)
+{
+   int w                 = 0;
+   const uint16_t *input = (const uint16_t*)input_;
+   uint16_t *output      = (uint16_t*)output_;
+   const __m128i r_mask  = _mm_set1_epi16((int16_t)0xf000);
+   const __m128i g_mask  = _mm_set1_epi16(0x0780);
+   const __m128i b_mask  = _mm_set1_epi16(0x001e);
+
+   for (; w + 8 <= width; w += 8)
+   {
+      const __m128i in = _mm_loadu_si128((const __m128i*)(input + w));
+      __m128i r = _mm_and_si128(in, r_mask);
+      __m128i g = _mm_and_si128(_mm_srli_epi16(in, 1), g_mask);
+      __m128i b = _mm_and_si128(_mm_srli_epi16(in, 3), b_mask);
+      _mm_storeu_si128((__m128i*)(output + w),
+            _mm_or_si128(r, _mm_or_si128(g, b)));
+   }
+
+   return w;
+}
+#endif
+
+#ifdef PIXCONV_HAVE_NEON
+static int conv_rgba4444_rgb565_neon(void *output_, const void *input_,
+      int width)
+{
+   int w                   = 0;
+   const uint16_t *input   = (const uint16_t*)input_;
+   uint16_t *output        = (uint16_t*)output_;
+   const uint16x8_t r_mask = vdupq_n_u16(0xf000);
+   const uint16x8_t g_mask = vdupq_n_u16(0x0780);
+   const uint16x8_t b_mask = vdupq_n_u16(0x001e);
+
+   for (; w + 8 <= width; w += 8)
+   {
+      uint16x8_t in = vld1q_u16(input + w);
+      uint16x8_t r  = vandq_u16(in, r_mask);
+      uint16x8_t g  = vandq_u16(vshrq_n_u16(in, 1), g_mask);
+      uint16x8_t b  = vandq_u16(vshrq_n_u16(in, 3), b_mask);
+      vst1q_u16(output + w, vorrq_u16(r, vorrq_u16(g, b)));
+   }
+
+   return w;
+}
+#endif
+
 void conv_rgba4444_rgb565(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
 {
-   int h, w;
+   int h;
    const uint16_t *input = (const uint16_t*)input_;
    uint16_t *output      = (uint16_t*)output_;
+   pixconv_row_t row     = pixconv_pick(NULL,
+         PIXCONV_SSE2(conv_rgba4444_rgb565),
+         NULL,
+         PIXCONV_NEON(conv_rgba4444_rgb565));
 
    for (h = 0; h < height;
          h++, output += out_stride >> 1, input += in_stride >> 1)
    {
-      for (w = 0; w < width; w++)
+      int w = row ? row(output, input, width) : 0;
+
+      for (; w < width; w++)
       {
          uint32_t col = input[w];
          uint32_t r   = (col >> 12) & 0xf;
@@ -526,77 +1229,104 @@ static INLINE void store_bgr24_sse2(void *output, __m128i a,
          _mm_or_si128(c0, _mm_or_si128(c1, _mm_or_si128(c2,
                   _mm_or_si128(c3, _mm_or_si128(c4, c5))))));
 }
-#endif
 
-void conv_0rgb1555_bgr24(void *output_, const void *input_,
-      int width, int height,
-      int out_stride, int in_stride)
+static int conv_0rgb1555_bgr24_sse2(void *output_, const void *input_,
+      int width)
 {
-   int h;
+   int w                     = 0;
    const uint16_t *input     = (const uint16_t*)input_;
-   uint8_t *output           = (uint8_t*)output_;
-
-#if defined(__SSE2__)
+   uint8_t *out              = (uint8_t*)output_;
    const __m128i pix_mask_r  = _mm_set1_epi16(0x1f << 10);
    const __m128i pix_mask_gb = _mm_set1_epi16(0x1f <<  5);
    const __m128i mul15_mid   = _mm_set1_epi16(0x4200);
    const __m128i mul15_hi    = _mm_set1_epi16(0x0210);
    const __m128i a           = _mm_set1_epi16(0x00ff);
 
-   int max_width             = width - 15;
+   for (; w + 16 <= width; w += 16, out += 48)
+   {
+      __m128i res_lo_bg0, res_lo_bg1, res_hi_bg0, res_hi_bg1,
+              res_lo_ra0, res_lo_ra1, res_hi_ra0, res_hi_ra1,
+              res_lo0, res_lo1, res_hi0, res_hi1;
+      const __m128i in0 = _mm_loadu_si128((const __m128i*)(input + w + 0));
+      const __m128i in1 = _mm_loadu_si128((const __m128i*)(input + w + 8));
+      __m128i r0        = _mm_and_si128(in0, pix_mask_r);
+      __m128i r1        = _mm_and_si128(in1, pix_mask_r);
+      __m128i g0        = _mm_and_si128(in0, pix_mask_gb);
+      __m128i g1        = _mm_and_si128(in1, pix_mask_gb);
+      __m128i b0        = _mm_and_si128(_mm_slli_epi16(in0, 5), pix_mask_gb);
+      __m128i b1        = _mm_and_si128(_mm_slli_epi16(in1, 5), pix_mask_gb);
+
+      r0                = _mm_mulhi_epi16(r0, mul15_hi);
+      r1                = _mm_mulhi_epi16(r1, mul15_hi);
+      g0                = _mm_mulhi_epi16(g0, mul15_mid);
+      g1                = _mm_mulhi_epi16(g1, mul15_mid);
+      b0                = _mm_mulhi_epi16(b0, mul15_mid);
+      b1                = _mm_mulhi_epi16(b1, mul15_mid);
+
+      res_lo_bg0        = _mm_unpacklo_epi8(b0, g0);
+      res_lo_bg1        = _mm_unpacklo_epi8(b1, g1);
+      res_hi_bg0        = _mm_unpackhi_epi8(b0, g0);
+      res_hi_bg1        = _mm_unpackhi_epi8(b1, g1);
+      res_lo_ra0        = _mm_unpacklo_epi8(r0, a);
+      res_lo_ra1        = _mm_unpacklo_epi8(r1, a);
+      res_hi_ra0        = _mm_unpackhi_epi8(r0, a);
+      res_hi_ra1        = _mm_unpackhi_epi8(r1, a);
+
+      res_lo0           = _mm_or_si128(res_lo_bg0,
+            _mm_slli_si128(res_lo_ra0, 2));
+      res_lo1           = _mm_or_si128(res_lo_bg1,
+            _mm_slli_si128(res_lo_ra1, 2));
+      res_hi0           = _mm_or_si128(res_hi_bg0,
+            _mm_slli_si128(res_hi_ra0, 2));
+      res_hi1           = _mm_or_si128(res_hi_bg1,
+            _mm_slli_si128(res_hi_ra1, 2));
+
+      /* Non-POT pixel sizes for the loss */
+      store_bgr24_sse2(out, res_lo0, res_hi0, res_lo1, res_hi1);
+   }
+
+   return w;
+}
 #endif
 
-   for (h = 0; h < height;
-         h++, output += out_stride, input += in_stride >> 1)
+#ifdef PIXCONV_HAVE_NEON
+static int conv_0rgb1555_bgr24_neon(void *output_, const void *input_,
+      int width)
+{
+   int w                 = 0;
+   const uint16_t *input = (const uint16_t*)input_;
+   uint8_t *output       = (uint8_t*)output_;
+
+   for (; w + 16 <= width; w += 16)
    {
-      uint8_t *out = output;
-      int   w = 0;
+      uint8x16x3_t px;
+      pixconv_unpack_0rgb1555_neon(vld2q_u8((const uint8_t*)(input + w)),
+            &px.val[2], &px.val[1], &px.val[0]);
+      vst3q_u8(output + w * 3, px);
+   }
 
-#if defined(__SSE2__)
-      for (; w < max_width; w += 16, out += 48)
-      {
-         __m128i res_lo_bg0, res_lo_bg1, res_hi_bg0, res_hi_bg1,
-                 res_lo_ra0, res_lo_ra1, res_hi_ra0, res_hi_ra1,
-                 res_lo0, res_lo1, res_hi0, res_hi1;
-         const __m128i in0 = _mm_loadu_si128((const __m128i*)(input + w + 0));
-         const __m128i in1 = _mm_loadu_si128((const __m128i*)(input + w + 8));
-         __m128i r0        = _mm_and_si128(in0, pix_mask_r);
-         __m128i r1        = _mm_and_si128(in1, pix_mask_r);
-         __m128i g0        = _mm_and_si128(in0, pix_mask_gb);
-         __m128i g1        = _mm_and_si128(in1, pix_mask_gb);
-         __m128i b0        = _mm_and_si128(_mm_slli_epi16(in0, 5), pix_mask_gb);
-         __m128i b1        = _mm_and_si128(_mm_slli_epi16(in1, 5), pix_mask_gb);
-
-         r0                = _mm_mulhi_epi16(r0, mul15_hi);
-         r1                = _mm_mulhi_epi16(r1, mul15_hi);
-         g0                = _mm_mulhi_epi16(g0, mul15_mid);
-         g1                = _mm_mulhi_epi16(g1, mul15_mid);
-         b0                = _mm_mulhi_epi16(b0, mul15_mid);
-         b1                = _mm_mulhi_epi16(b1, mul15_mid);
-
-         res_lo_bg0        = _mm_unpacklo_epi8(b0, g0);
-         res_lo_bg1        = _mm_unpacklo_epi8(b1, g1);
-         res_hi_bg0        = _mm_unpackhi_epi8(b0, g0);
-         res_hi_bg1        = _mm_unpackhi_epi8(b1, g1);
-         res_lo_ra0        = _mm_unpacklo_epi8(r0, a);
-         res_lo_ra1        = _mm_unpacklo_epi8(r1, a);
-         res_hi_ra0        = _mm_unpackhi_epi8(r0, a);
-         res_hi_ra1        = _mm_unpackhi_epi8(r1, a);
-
-         res_lo0           = _mm_or_si128(res_lo_bg0,
-               _mm_slli_si128(res_lo_ra0, 2));
-         res_lo1           = _mm_or_si128(res_lo_bg1,
-               _mm_slli_si128(res_lo_ra1, 2));
-         res_hi0           = _mm_or_si128(res_hi_bg0,
-               _mm_slli_si128(res_hi_ra0, 2));
-         res_hi1           = _mm_or_si128(res_hi_bg1,
-               _mm_slli_si128(res_hi_ra1, 2));
-
-         /* Non-POT pixel sizes for the loss */
-         store_bgr24_sse2(out, res_lo0, res_hi0, res_lo1, res_hi1);
-      }
+   return w;
+}
 #endif
 
+void conv_0rgb1555_bgr24(void *output_, const void *input_,
+      int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   const uint16_t *input     = (const uint16_t*)input_;
+   uint8_t *output           = (uint8_t*)output_;
+   pixconv_row_t row         = pixconv_pick(NULL,
+         PIXCONV_SSE2(conv_0rgb1555_bgr24),
+         NULL,
+         PIXCONV_NEON(conv_0rgb1555_bgr24));
+
+   for (h = 0; h < height;
+         h++, output += out_stride, input += in_stride >> 1)
+   {
+      int   w      = row ? row(output, input, width) : 0;
+      uint8_t *out = output + w * 3;
+
       for (; w < width; w++)
       {
          uint32_t col = input[w];
@@ -614,15 +1344,13 @@ void conv_0rgb1555_bgr24(void *output_, const void *input_,
    }
 }
 
-void conv_rgb565_bgr24(void *output_, const void *input_,
-      int width, int height,
-      int out_stride, int in_stride)
+#if defined(__SSE2__)
+static int conv_rgb565_bgr24_sse2(void *output_, const void *input_,
+      int width)
 {
-   int h;
+   int w                    = 0;
    const uint16_t *input    = (const uint16_t*)input_;
-   uint8_t *output          = (uint8_t*)output_;
-
-#if defined(__SSE2__)
+   uint8_t *out             = (uint8_t*)output_;
    const __m128i pix_mask_r = _mm_set1_epi16(0x1f << 10);
    const __m128i pix_mask_g = _mm_set1_epi16(0x3f <<  5);
    const __m128i pix_mask_b = _mm_set1_epi16(0x1f <<  5);
@@ -631,56 +1359,88 @@ void conv_rgb565_bgr24(void *output_, const void *input_,
    const __m128i mul16_b    = _mm_set1_epi16(0x4200);
    const __m128i a          = _mm_set1_epi16(0x00ff);
 
-   int max_width            = width - 15;
+   for (; w + 16 <= width; w += 16, out += 48)
+   {
+      __m128i res_lo_bg0, res_hi_bg0, res_lo_ra0, res_hi_ra0;
+      __m128i res_lo_bg1, res_hi_bg1, res_lo_ra1, res_hi_ra1;
+      __m128i res_lo0, res_hi0, res_lo1, res_hi1;
+      const __m128i in0 = _mm_loadu_si128((const __m128i*)(input + w));
+      const __m128i in1 = _mm_loadu_si128((const __m128i*)(input + w + 8));
+      __m128i r0 = _mm_and_si128(_mm_srli_epi16(in0, 1), pix_mask_r);
+      __m128i g0 = _mm_and_si128(in0, pix_mask_g);
+      __m128i b0 = _mm_and_si128(_mm_slli_epi16(in0, 5), pix_mask_b);
+      __m128i r1 = _mm_and_si128(_mm_srli_epi16(in1, 1), pix_mask_r);
+      __m128i g1 = _mm_and_si128(in1, pix_mask_g);
+      __m128i b1 = _mm_and_si128(_mm_slli_epi16(in1, 5), pix_mask_b);
+
+      r0         = _mm_mulhi_epi16(r0, mul16_r);
+      g0         = _mm_mulhi_epi16(g0, mul16_g);
+      b0         = _mm_mulhi_epi16(b0, mul16_b);
+      r1         = _mm_mulhi_epi16(r1, mul16_r);
+      g1         = _mm_mulhi_epi16(g1, mul16_g);
+      b1         = _mm_mulhi_epi16(b1, mul16_b);
+
+      res_lo_bg0 = _mm_unpacklo_epi8(b0, g0);
+      res_hi_bg0 = _mm_unpackhi_epi8(b0, g0);
+      res_lo_ra0 = _mm_unpacklo_epi8(r0, a);
+      res_hi_ra0 = _mm_unpackhi_epi8(r0, a);
+      res_lo_bg1 = _mm_unpacklo_epi8(b1, g1);
+      res_hi_bg1 = _mm_unpackhi_epi8(b1, g1);
+      res_lo_ra1 = _mm_unpacklo_epi8(r1, a);
+      res_hi_ra1 = _mm_unpackhi_epi8(r1, a);
+
+      res_lo0    = _mm_or_si128(res_lo_bg0,
+            _mm_slli_si128(res_lo_ra0, 2));
+      res_hi0    = _mm_or_si128(res_hi_bg0,
+            _mm_slli_si128(res_hi_ra0, 2));
+      res_lo1    = _mm_or_si128(res_lo_bg1,
+            _mm_slli_si128(res_lo_ra1, 2));
+      res_hi1    = _mm_or_si128(res_hi_bg1,
+            _mm_slli_si128(res_hi_ra1, 2));
+
+      store_bgr24_sse2(out, res_lo0, res_hi0, res_lo1, res_hi1);
+   }
+
+   return w;
+}
+#endif
+
+#ifdef PIXCONV_HAVE_NEON
+static int conv_rgb565_bgr24_neon(void *output_, const void *input_,
+      int width)
+{
+   int w                 = 0;
+   const uint16_t *input = (const uint16_t*)input_;
+   uint8_t *output       = (uint8_t*)output_;
+
+   for (; w + 16 <= width; w += 16)
+   {
+      uint8x16x3_t px;
+      pixconv_unpack_rgb565_neon(vld2q_u8((const uint8_t*)(input + w)),
+            &px.val[2], &px.val[1], &px.val[0]);
+      vst3q_u8(output + w * 3, px);
+   }
+
+   return w;
+}
 #endif
 
+void conv_rgb565_bgr24(void *output_, const void *input_,
+      int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   const uint16_t *input    = (const uint16_t*)input_;
+   uint8_t *output          = (uint8_t*)output_;
+   pixconv_row_t row        = pixconv_pick(NULL,
+         PIXCONV_SSE2(conv_rgb565_bgr24),
+         NULL,
+         PIXCONV_NEON(conv_rgb565_bgr24));
+
    for (h = 0; h < height; h++, output += out_stride, input += in_stride >> 1)
    {
-      uint8_t *out = output;
-      int        w = 0;
-#if defined(__SSE2__)
-      for (; w < max_width; w += 16, out += 48)
-      {
-         __m128i res_lo_bg0, res_hi_bg0, res_lo_ra0, res_hi_ra0;
-         __m128i res_lo_bg1, res_hi_bg1, res_lo_ra1, res_hi_ra1;
-         __m128i res_lo0, res_hi0, res_lo1, res_hi1;
-         const __m128i in0 = _mm_loadu_si128((const __m128i*)(input + w));
-         const __m128i in1 = _mm_loadu_si128((const __m128i*)(input + w + 8));
-         __m128i r0 = _mm_and_si128(_mm_srli_epi16(in0, 1), pix_mask_r);
-         __m128i g0 = _mm_and_si128(in0, pix_mask_g);
-         __m128i b0 = _mm_and_si128(_mm_slli_epi16(in0, 5), pix_mask_b);
-         __m128i r1 = _mm_and_si128(_mm_srli_epi16(in1, 1), pix_mask_r);
-         __m128i g1 = _mm_and_si128(in1, pix_mask_g);
-         __m128i b1 = _mm_and_si128(_mm_slli_epi16(in1, 5), pix_mask_b);
-
-         r0         = _mm_mulhi_epi16(r0, mul16_r);
-         g0         = _mm_mulhi_epi16(g0, mul16_g);
-         b0         = _mm_mulhi_epi16(b0, mul16_b);
-         r1         = _mm_mulhi_epi16(r1, mul16_r);
-         g1         = _mm_mulhi_epi16(g1, mul16_g);
-         b1         = _mm_mulhi_epi16(b1, mul16_b);
-
-         res_lo_bg0 = _mm_unpacklo_epi8(b0, g0);
-         res_hi_bg0 = _mm_unpackhi_epi8(b0, g0);
-         res_lo_ra0 = _mm_unpacklo_epi8(r0, a);
-         res_hi_ra0 = _mm_unpackhi_epi8(r0, a);
-         res_lo_bg1 = _mm_unpacklo_epi8(b1, g1);
-         res_hi_bg1 = _mm_unpackhi_epi8(b1, g1);
-         res_lo_ra1 = _mm_unpacklo_epi8(r1, a);
-         res_hi_ra1 = _mm_unpackhi_epi8(r1, a);
-
-         res_lo0    = _mm_or_si128(res_lo_bg0,
-               _mm_slli_si128(res_lo_ra0, 2));
-         res_hi0    = _mm_or_si128(res_hi_bg0,
-               _mm_slli_si128(res_hi_ra0, 2));
-         res_lo1    = _mm_or_si128(res_lo_bg1,
-               _mm_slli_si128(res_lo_ra1, 2));
-         res_hi1    = _mm_or_si128(res_hi_bg1,
-               _mm_slli_si128(res_hi_ra1, 2));
-
-         store_bgr24_sse2(out, res_lo0, res_hi0, res_lo1, res_hi1);
-      }
-#endif
+      int        w = row ? row(output, input, width) : 0;
+      uint8_t *out = output + w * 3;
 
       for (; w < width; w++)
       {
@@ -699,19 +1459,78 @@ void conv_rgb565_bgr24(void *output_, const void *input_,
    }
 }
 
+#ifdef PIXCONV_HAVE_AVX2
+static PIXCONV_AVX2_TARGET int conv_bgr24_argb8888_avx2(void *output_,
+      const void *input_, int width)
+{
+   int w                = 0;
+   const uint8_t *input = (const uint8_t*)input_;
+   uint32_t *output     = (uint32_t*)output_;
+   /* The upper lane is loaded 8 bytes in, so its 4 pixels
+    * start at byte 4 of the lane rather than byte 12. */
+   const __m256i shuf   = _mm256_setr_epi8(
+         0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+         4, 5, 6, -1, 7, 8, 9, -1, 10, 11, 12, -1, 13, 14, 15, -1);
+   const __m256i a      = _mm256_set1_epi32((int32_t)0xff000000);
+
+   for (; w + 8 <= width; w += 8)
+   {
+      const uint8_t *src = input + w * 3;
+      __m256i in         = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(
+               _mm_loadu_si128((const __m128i*)(src + 0))),
+            _mm_loadu_si128((const __m128i*)(src + 8)), 1);
+      _mm256_storeu_si256((__m256i*)(output + w),
+            _mm256_or_si256(_mm256_shuffle_epi8(in, shuf), a));
+   }
+
+   return w;
+}
+#endif
+
+#ifdef PIXCONV_HAVE_NEON
+static int conv_bgr24_argb8888_neon(void *output_, const void *input_,
+      int width)
+{
+   int w                = 0;
+   const uint8_t *input = (const uint8_t*)input_;
+   uint32_t *output     = (uint32_t*)output_;
+
+   for (; w + 16 <= width; w += 16)
+   {
+      uint8x16x4_t px;
+      uint8x16x3_t in = vld3q_u8(input + w * 3);
+      px.val[0]       = in.val[0];
+      px.val[1]       = in.val[1];
+      px.val[2]       = in.val[2];
+      px.val[3]       = vdupq_n_u8(0xff);
+      vst4q_u8((uint8_t*)(output + w), px);
+   }
+
+   return w;
+}
+#endif
+
 void conv_bgr24_argb8888(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
 {
-   int h, w;
+   int h;
    const uint8_t *input = (const uint8_t*)input_;
    uint32_t *output     = (uint32_t*)output_;
+   pixconv_row_t row    = pixconv_pick(
+         PIXCONV_AVX2(conv_bgr24_argb8888),
+         NULL,
+         NULL,
+         PIXCONV_NEON(conv_bgr24_argb8888));
 
    for (h = 0; h < height;
          h++, output += out_stride >> 2, input += in_stride)
    {
-      const uint8_t *inp = input;
-      for (w = 0; w < width; w++)
+      int              w = row ? row(output, input, width) : 0;
+      const uint8_t *inp = input + w * 3;
+
+      for (; w < width; w++)
       {
          uint32_t b = *inp++;
          uint32_t g = *inp++;
@@ -721,40 +1540,152 @@ void conv_bgr24_argb8888(void *output_, const void *input_,
    }
 }
 
+#ifdef PIXCONV_HAVE_NEON
+static int conv_bgr24_rgb565_neon(void *output_, const void *input_,
+      int width)
+{
+   int w                = 0;
+   const uint8_t *input = (const uint8_t*)input_;
+   uint16_t *output     = (uint16_t*)output_;
+
+   for (; w + 16 <= width; w += 16)
+   {
+      uint8x16x3_t in = vld3q_u8(input + w * 3);
+      vst2q_u8((uint8_t*)(output + w),
+            pixconv_pack_rgb565_neon(in.val[2], in.val[1], in.val[0]));
+   }
+
+   return w;
+}
+#endif
+
 void conv_bgr24_rgb565(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
 {
-   int h, w;
+   int h;
    const uint8_t *input = (const uint8_t*)input_;
    uint16_t *output     = (uint16_t*)output_;
+   pixconv_row_t row    = pixconv_pick(NULL, NULL, NULL,
+         PIXCONV_NEON(conv_bgr24_rgb565));
+
    for (h = 0; h < height;
-         h++, output += out_stride, input += in_stride)
+         h++, output += out_stride >> 1, input += in_stride)
    {
-      const uint8_t *inp = input;
-      for (w = 0; w < width; w++)
+      int              w = row ? row(output, input, width) : 0;
+      const uint8_t *inp = input + w * 3;
+
+      for (; w < width; w++)
       {
          uint16_t b = *inp++;
          uint16_t g = *inp++;
          uint16_t r = *inp++;
-    
+
          output[w] = ((r & 0x00F8) << 8) | ((g&0x00FC) << 3) | ((b&0x00F8) >> 3);
-      }  
+      }
+   }
+}
+
+#if defined(__SSE2__)
+static int conv_argb8888_0rgb1555_sse2(void *output_, const void *input_,
+      int width)
+{
+   int w                 = 0;
+   const uint32_t *input = (const uint32_t*)input_;
+   uint16_t *output      = (uint16_t*)output_;
+   const __m128i r_mask  = _mm_set1_epi32(0x1f << 10);
+   const __m128i g_mask  = _mm_set1_epi32(0x1f <<  5);
+   const __m128i b_mask  = _mm_set1_epi32(0x1f);
+
+   for (; w + 8 <= width; w += 8)
+   {
+      __m128i c0 = _mm_loadu_si128((const __m128i*)(input + w + 0));
+      __m128i c1 = _mm_loadu_si128((const __m128i*)(input + w + 4));
+      __m128i r0 = _mm_and_si128(_mm_srli_epi32(c0, 9), r_mask);
+      __m128i r1 = _mm_and_si128(_mm_srli_epi32(c1, 9), r_mask);
+      __m128i g0 = _mm_and_si128(_mm_srli_epi32(c0, 6), g_mask);
+      __m128i g1 = _mm_and_si128(_mm_srli_epi32(c1, 6), g_mask);
+      __m128i b0 = _mm_and_si128(_mm_srli_epi32(c0, 3), b_mask);
+      __m128i b1 = _mm_and_si128(_mm_srli_epi32(c1, 3), b_mask);
+      _mm_storeu_si128((__m128i*)(output + w), _mm_packs_epi32(
+               _mm_or_si128(r0, _mm_or_si128(g0, b0)),
+               _mm_or_si128(r1, _mm_or_si128(g1, b1))));
+   }
+
+   return w;
+}
+#endif
+
+#ifdef PIXCONV_HAVE_AVX2
+static PIXCONV_AVX2_TARGET int conv_argb8888_0rgb1555_avx2(void *output_,
+      const void *input_, int width)
+{
+   int w                 = 0;
+   const uint32_t *input = (const uint32_t*)input_;
+   uint16_t *output      = (uint16_t*)output_;
+   const __m256i r_mask  = _mm256_set1_epi32(0x1f << 10);
+   const __m256i g_mask  = _mm256_set1_epi32(0x1f <<  5);
+   const __m256i b_mask  = _mm256_set1_epi32(0x1f);
+
+   for (; w + 16 <= width; w += 16)
+   {
+      __m256i c0 = _mm256_loadu_si256((const __m256i*)(input + w + 0));
+      __m256i c1 = _mm256_loadu_si256((const __m256i*)(input + w + 8));
+      __m256i r0 = _mm256_and_si256(_mm256_srli_epi32(c0, 9), r_mask);
+      __m256i r1 = _mm256_and_si256(_mm256_srli_epi32(c1, 9), r_mask);
+      __m256i g0 = _mm256_and_si256(_mm256_srli_epi32(c0, 6), g_mask);
+      __m256i g1 = _mm256_and_si256(_mm256_srli_epi32(c1, 6), g_mask);
+      __m256i b0 = _mm256_and_si256(_mm256_srli_epi32(c0, 3), b_mask);
+      __m256i b1 = _mm256_and_si256(_mm256_srli_epi32(c1, 3), b_mask);
+      _mm256_storeu_si256((__m256i*)(output + w), pixconv_pack_epi32_avx2(
+               _mm256_or_si256(r0, _mm256_or_si256(g0, b0)),
+               _mm256_or_si256(r1, _mm256_or_si256(g1, b1))));
+   }
+
+   return w;
+}
+#endif
+
+#ifdef PIXCONV_HAVE_NEON
+static int conv_argb8888_0rgb1555_neon(void *output_, const void *input_,
+      int width)
+{
+   int w                 = 0;
+   const uint32_t *input = (const uint32_t*)input_;
+   uint16_t *output      = (uint16_t*)output_;
+
+   for (; w + 16 <= width; w += 16)
+   {
+      uint8x16x2_t out;
+      uint8x16x4_t px = vld4q_u8((const uint8_t*)(input + w));
+      out.val[0]      = vsriq_n_u8(vshlq_n_u8(px.val[1], 2), px.val[0], 3);
+      out.val[1]      = vsriq_n_u8(vshrq_n_u8(px.val[2], 1), px.val[1], 6);
+      vst2q_u8((uint8_t*)(output + w), out);
    }
+
+   return w;
 }
+#endif
 
 void conv_argb8888_0rgb1555(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
 {
-   int h, w;
+   int h;
    const uint32_t *input = (const uint32_t*)input_;
    uint16_t *output      = (uint16_t*)output_;
+   pixconv_row_t row     = pixconv_pick(
+         PIXCONV_AVX2(conv_argb8888_0rgb1555),
+         PIXCONV_SSE2(conv_argb8888_0rgb1555),
+         NULL,
+         PIXCONV_NEON(conv_argb8888_0rgb1555));
 
    for (h = 0; h < height;
          h++, output += out_stride >> 1, input += in_stride >> 2)
    {
-      for (w = 0; w < width; w++)
+      int w = row ? row(output, input, width) : 0;
+
+      for (; w < width; w++)
       {
          uint32_t col = input[w];
          uint16_t r   = (col >> 19) & 0x1f;
@@ -765,33 +1696,174 @@ void conv_argb8888_0rgb1555(void *output_, const void *input_,
    }
 }
 
-void conv_argb8888_bgr24(void *output_, const void *input_,
+#if defined(__SSE2__)
+static int conv_argb8888_rgb565_sse2(void *output_, const void *input_,
+      int width)
+{
+   int w                 = 0;
+   const uint32_t *input = (const uint32_t*)input_;
+   uint16_t *output      = (uint16_t*)output_;
+   const __m128i r_mask  = _mm_set1_epi32(0x1f << 11);
+   const __m128i g_mask  = _mm_set1_epi32(0x3f <<  5);
+   const __m128i b_mask  = _mm_set1_epi32(0x1f);
+
+   for (; w + 8 <= width; w += 8)
+   {
+      __m128i c0 = _mm_loadu_si128((const __m128i*)(input + w + 0));
+      __m128i c1 = _mm_loadu_si128((const __m128i*)(input + w + 4));
+      __m128i r0 = _mm_and_si128(_mm_srli_epi32(c0, 8), r_mask);
+      __m128i r1 = _mm_and_si128(_mm_srli_epi32(c1, 8), r_mask);
+      __m128i g0 = _mm_and_si128(_mm_srli_epi32(c0, 5), g_mask);
+      __m128i g1 = _mm_and_si128(_mm_srli_epi32(c1, 5), g_mask);
+      __m128i b0 = _mm_and_si128(_mm_srli_epi32(c0, 3), b_mask);
+      __m128i b1 = _mm_and_si128(_mm_srli_epi32(c1, 3), b_mask);
+      _mm_storeu_si128((__m128i*)(output + w), pixconv_pack_epi32_sse2(
+               _mm_or_si128(r0, _mm_or_si128(g0, b0)),
+               _mm_or_si128(r1, _mm_or_si128(g1, b1))));
+   }
+
+   return w;
+}
+#endif
+
+#ifdef PIXCONV_HAVE_AVX2
+static PIXCONV_AVX2_TARGET int conv_argb8888_rgb565_avx2(void *output_,
+      const void *input_, int width)
+{
+   int w                 = 0;
+   const uint32_t *input = (const uint32_t*)input_;
+   uint16_t *output      = (uint16_t*)output_;
+   const __m256i r_mask  = _mm256_set1_epi32(0x1f << 11);
+   const __m256i g_mask  = _mm256_set1_epi32(0x3f <<  5);
+   const __m256i b_mask  = _mm256_set1_epi32(0x1f);
+
+   for (; w + 16 <= width; w += 16)
+   {
+      __m256i c0 = _mm256_loadu_si256((const __m256i*)(input + w + 0));
+      __m256i c1 = _mm256_loadu_si256((const __m256i*)(input + w + 8));
+      __m256i r0 = _mm256_and_si256(_mm256_srli_epi32(c0, 8), r_mask);
+      __m256i r1 = _mm256_and_si256(_mm256_srli_epi32(c1, 8), r_mask);
+      __m256i g0 = _mm256_and_si256(_mm256_srli_epi32(c0, 5), g_mask);
+      __m256i g1 = _mm256_and_si256(_mm256_srli_epi32(c1, 5), g_mask);
+      __m256i b0 = _mm256_and_si256(_mm256_srli_epi32(c0, 3), b_mask);
+      __m256i b1 = _mm256_and_si256(_mm256_srli_epi32(c1, 3), b_mask);
+      _mm256_storeu_si256((__m256i*)(output + w), pixconv_pack_epi32_avx2(
+               _mm256_or_si256(r0, _mm256_or_si256(g0, b0)),
+               _mm256_or_si256(r1, _mm256_or_si256(g1, b1))));
+   }
+
+   return w;
+}
+#endif
+
+#ifdef PIXCONV_HAVE_NEON
+static int conv_argb8888_rgb565_neon(void *output_, const void *input_,
+      int width)
+{
+   int w                 = 0;
+   const uint32_t *input = (const uint32_t*)input_;
+   uint16_t *output      = (uint16_t*)output_;
+
+   for (; w + 16 <= width; w += 16)
+   {
+      uint8x16x4_t px = vld4q_u8((const uint8_t*)(input + w));
+      vst2q_u8((uint8_t*)(output + w),
+            pixconv_pack_rgb565_neon(px.val[2], px.val[1], px.val[0]));
+   }
+
+   return w;
+}
+#endif
+
+void conv_argb8888_rgb565(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
 {
    int h;
    const uint32_t *input = (const uint32_t*)input_;
-   uint8_t *output       = (uint8_t*)output_;
+   uint16_t *output      = (uint16_t*)output_;
+   pixconv_row_t row     = pixconv_pick(
+         PIXCONV_AVX2(conv_argb8888_rgb565),
+         PIXCONV_SSE2(conv_argb8888_rgb565),
+         NULL,
+         PIXCONV_NEON(conv_argb8888_rgb565));
+
+   for (h = 0; h < height;
+         h++, output += out_stride >> 1, input += in_stride >> 2)
+   {
+      int w = row ? row(output, input, width) : 0;
+
+      for (; w < width; w++)
+      {
+         uint32_t col = input[w];
+         uint16_t r   = (col >> 19) & 0x1f;
+         uint16_t g   = (col >> 10) & 0x3f;
+         uint16_t b   = (col >>  3) & 0x1f;
+         output[w]    = (r << 11) | (g << 5) | (b << 0);
+      }
+   }
+}
 
 #if defined(__SSE2__)
-   int max_width = width - 15;
+static int conv_argb8888_bgr24_sse2(void *output_, const void *input_,
+      int width)
+{
+   int w                 = 0;
+   const uint32_t *input = (const uint32_t*)input_;
+   uint8_t *out          = (uint8_t*)output_;
+
+   for (; w + 16 <= width; w += 16, out += 48)
+   {
+      __m128i l0 = _mm_loadu_si128((const __m128i*)(input + w +  0));
+      __m128i l1 = _mm_loadu_si128((const __m128i*)(input + w +  4));
+      __m128i l2 = _mm_loadu_si128((const __m128i*)(input + w +  8));
+      __m128i l3 = _mm_loadu_si128((const __m128i*)(input + w + 12));
+      store_bgr24_sse2(out, l0, l1, l2, l3);
+   }
+
+   return w;
+}
+#endif
+
+#ifdef PIXCONV_HAVE_NEON
+static int conv_argb8888_bgr24_neon(void *output_, const void *input_,
+      int width)
+{
+   int w                 = 0;
+   const uint32_t *input = (const uint32_t*)input_;
+   uint8_t *output       = (uint8_t*)output_;
+
+   for (; w + 16 <= width; w += 16)
+   {
+      uint8x16x3_t out;
+      uint8x16x4_t px = vld4q_u8((const uint8_t*)(input + w));
+      out.val[0]      = px.val[0];
+      out.val[1]      = px.val[1];
+      out.val[2]      = px.val[2];
+      vst3q_u8(output + w * 3, out);
+   }
+
+   return w;
+}
 #endif
 
+void conv_argb8888_bgr24(void *output_, const void *input_,
+      int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   const uint32_t *input = (const uint32_t*)input_;
+   uint8_t *output       = (uint8_t*)output_;
+   pixconv_row_t row     = pixconv_pick(NULL,
+         PIXCONV_SSE2(conv_argb8888_bgr24),
+         NULL,
+         PIXCONV_NEON(conv_argb8888_bgr24));
+
    for (h = 0; h < height;
          h++, output += out_stride, input += in_stride >> 2)
    {
-      uint8_t *out = output;
-      int        w = 0;
-#if defined(__SSE2__)
-      for (; w < max_width; w += 16, out += 48)
-      {
-         __m128i l0 = _mm_loadu_si128((const __m128i*)(input + w +  0));
-         __m128i l1 = _mm_loadu_si128((const __m128i*)(input + w +  4));
-         __m128i l2 = _mm_loadu_si128((const __m128i*)(input + w +  8));
-         __m128i l3 = _mm_loadu_si128((const __m128i*)(input + w + 12));
-         store_bgr24_sse2(out, l0, l1, l2, l3);
-      }
-#endif
+      int        w = row ? row(output, input, width) : 0;
+      uint8_t *out = output + w * 3;
 
       for (; w < width; w++)
       {
@@ -807,14 +1879,59 @@ void conv_argb8888_bgr24(void *output_, const void *input_,
 static INLINE __m128i conv_shuffle_rb_epi32(__m128i c)
 {
    /* SSSE3 plz */
-   const __m128i b_mask = _mm_set1_epi32(0x000000ff);
-   const __m128i g_mask = _mm_set1_epi32(0x0000ff00);
-   const __m128i r_mask = _mm_set1_epi32(0x00ff0000);
+   const __m128i b_mask  = _mm_set1_epi32(0x000000ff);
+   const __m128i ga_mask = _mm_set1_epi32((int)0xff00ff00);
+   const __m128i r_mask  = _mm_set1_epi32(0x00ff0000);
    __m128i sl = _mm_and_si128(_mm_slli_epi32(c, 16), r_mask);
    __m128i sr = _mm_and_si128(_mm_srli_epi32(c, 16), b_mask);
-   __m128i g  = _mm_and_si128(c, g_mask);
+   __m128i ga = _mm_and_si128(c, ga_mask);
    __m128i rb = _mm_or_si128(sl, sr);
-   return _mm_or_si128(g, rb);
+   return _mm_or_si128(ga, rb);
+}
+
+static int conv_abgr8888_bgr24_sse2(void *output_, const void *input_,
+      int width)
+{
+   int w                 = 0;
+   const uint32_t *input = (const uint32_t*)input_;
+   uint8_t *out          = (uint8_t*)output_;
+
+   for (; w + 16 <= width; w += 16, out += 48)
+   {
+      __m128i a = _mm_loadu_si128((const __m128i*)(input + w +  0));
+      __m128i b = _mm_loadu_si128((const __m128i*)(input + w +  4));
+      __m128i c = _mm_loadu_si128((const __m128i*)(input + w +  8));
+      __m128i d = _mm_loadu_si128((const __m128i*)(input + w + 12));
+      a = conv_shuffle_rb_epi32(a);
+      b = conv_shuffle_rb_epi32(b);
+      c = conv_shuffle_rb_epi32(c);
+      d = conv_shuffle_rb_epi32(d);
+      store_bgr24_sse2(out, a, b, c, d);
+   }
+
+   return w;
+}
+#endif
+
+#ifdef PIXCONV_HAVE_NEON
+static int conv_abgr8888_bgr24_neon(void *output_, const void *input_,
+      int width)
+{
+   int w                 = 0;
+   const uint32_t *input = (const uint32_t*)input_;
+   uint8_t *output       = (uint8_t*)output_;
+
+   for (; w + 16 <= width; w += 16)
+   {
+      uint8x16x3_t out;
+      uint8x16x4_t px = vld4q_u8((const uint8_t*)(input + w));
+      out.val[0]      = px.val[2];
+      out.val[1]      = px.val[1];
+      out.val[2]      = px.val[0];
+      vst3q_u8(output + w * 3, out);
+   }
+
+   return w;
 }
 #endif
 
@@ -825,30 +1942,16 @@ void conv_abgr8888_bgr24(void *output_, const void *input_,
    int h;
    const uint32_t *input = (const uint32_t*)input_;
    uint8_t *output       = (uint8_t*)output_;
-
-#if defined(__SSE2__)
-   int max_width = width - 15;
-#endif
+   pixconv_row_t row     = pixconv_pick(NULL,
+         PIXCONV_SSE2(conv_abgr8888_bgr24),
+         NULL,
+         PIXCONV_NEON(conv_abgr8888_bgr24));
 
    for (h = 0; h < height;
          h++, output += out_stride, input += in_stride >> 2)
    {
-      uint8_t *out = output;
-      int        w = 0;
-#if defined(__SSE2__)
-      for (; w < max_width; w += 16, out += 48)
-      {
-		 __m128i a = _mm_loadu_si128((const __m128i*)(input + w +  0));
-		 __m128i b = _mm_loadu_si128((const __m128i*)(input + w +  4));
-		 __m128i c = _mm_loadu_si128((const __m128i*)(input + w +  8));
-		 __m128i d = _mm_loadu_si128((const __m128i*)(input + w + 12));
-         a = conv_shuffle_rb_epi32(a);
-         b = conv_shuffle_rb_epi32(b);
-         c = conv_shuffle_rb_epi32(c);
-         d = conv_shuffle_rb_epi32(d);
-         store_bgr24_sse2(out, a, b, c, d);
-      }
-#endif
+      int        w = row ? row(output, input, width) : 0;
+      uint8_t *out = output + w * 3;
 
       for (; w < width; w++)
       {
@@ -860,18 +1963,81 @@ void conv_abgr8888_bgr24(void *output_, const void *input_,
    }
 }
 
+#if defined(__SSE2__)
+static int conv_argb8888_abgr8888_sse2(void *output_, const void *input_,
+      int width)
+{
+   int w                 = 0;
+   const uint32_t *input = (const uint32_t*)input_;
+   uint32_t *output      = (uint32_t*)output_;
+
+   for (; w + 4 <= width; w += 4)
+      _mm_storeu_si128((__m128i*)(output + w), conv_shuffle_rb_epi32(
+               _mm_loadu_si128((const __m128i*)(input + w))));
+
+   return w;
+}
+#endif
+
+#ifdef PIXCONV_HAVE_AVX2
+static PIXCONV_AVX2_TARGET int conv_argb8888_abgr8888_avx2(void *output_,
+      const void *input_, int width)
+{
+   int w                 = 0;
+   const uint32_t *input = (const uint32_t*)input_;
+   uint32_t *output      = (uint32_t*)output_;
+   const __m256i shuf    = _mm256_setr_epi8(
+         2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+         2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+
+   for (; w + 8 <= width; w += 8)
+      _mm256_storeu_si256((__m256i*)(output + w), _mm256_shuffle_epi8(
+               _mm256_loadu_si256((const __m256i*)(input + w)), shuf));
+
+   return w;
+}
+#endif
+
+#ifdef PIXCONV_HAVE_NEON
+static int conv_argb8888_abgr8888_neon(void *output_, const void *input_,
+      int width)
+{
+   int w                 = 0;
+   const uint32_t *input = (const uint32_t*)input_;
+   uint32_t *output      = (uint32_t*)output_;
+
+   for (; w + 16 <= width; w += 16)
+   {
+      uint8x16x4_t px = vld4q_u8((const uint8_t*)(input + w));
+      uint8x16_t b    = px.val[0];
+      px.val[0]       = px.val[2];
+      px.val[2]       = b;
+      vst4q_u8((uint8_t*)(output + w), px);
+   }
+
+   return w;
+}
+#endif
+
 void conv_argb8888_abgr8888(void *output_, const void *input_,
       int width, int height,
       int out_stride, int in_stride)
 {
-   int h, w;
+   int h;
    const uint32_t *input = (const uint32_t*)input_;
    uint32_t *output      = (uint32_t*)output_;
+   pixconv_row_t row     = pixconv_pick(
+         PIXCONV_AVX2(conv_argb8888_abgr8888),
+         PIXCONV_SSE2(conv_argb8888_abgr8888),
+         NULL,
+         PIXCONV_NEON(conv_argb8888_abgr8888));
 
    for (h = 0; h < height;
          h++, output += out_stride >> 2, input += in_stride >> 2)
    {
-      for (w = 0; w < width; w++)
+      int w = row ? row(output, input, width) : 0;
+
+      for (; w < width; w++)
       {
          uint32_t col = input[w];
          output[w]    = ((col << 16) & 0xff0000) |
@@ -888,15 +2054,13 @@ void conv_argb8888_abgr8888(void *output_, const void *input_,
 #define YUV_MAT_V_R (90)
 #define YUV_MAT_V_G (-46)
 
-void conv_yuyv_argb8888(void *output_, const void *input_,
-      int width, int height,
-      int out_stride, int in_stride)
-{
-   int h;
-   const uint8_t *input        = (const uint8_t*)input_;
-   uint32_t *output            = (uint32_t*)output_;
-
 #if defined(__SSE2__)
+static int conv_yuyv_argb8888_sse2(void *output_, const void *input_,
+      int width)
+{
+   int w                       = 0;
+   const uint8_t *src          = (const uint8_t*)input_;
+   uint32_t      *dst          = (uint32_t*)output_;
    const __m128i mask_y        = _mm_set1_epi16(0xffu);
    const __m128i mask_u        = _mm_set1_epi32(0xffu << 8);
    const __m128i mask_v        = _mm_set1_epi32(0xffu << 24);
@@ -910,99 +2074,220 @@ void conv_yuyv_argb8888(void *output_, const void *input_,
    const __m128i v_g_mul       = _mm_set1_epi16(YUV_MAT_V_G);
    const __m128i a             = _mm_cmpeq_epi16(
          _mm_setzero_si128(), _mm_setzero_si128());
+
+   /* Each loop processes 16 pixels. */
+   for (; w + 16 <= width; w += 16, src += 32, dst += 16)
+   {
+      __m128i u, v, u0_g, u1_g, u0_b, u1_b, v0_r, v1_r, v0_g, v1_g,
+              r0, g0, b0, r1, g1, b1;
+      __m128i res_lo_bg, res_hi_bg, res_lo_ra, res_hi_ra;
+      __m128i res0, res1, res2, res3;
+      __m128i yuv0 = _mm_loadu_si128((const __m128i*)(src +  0)); /* [Y0, U0, Y1, V0, Y2, U1, Y3, V1, ...] */
+      __m128i yuv1 = _mm_loadu_si128((const __m128i*)(src + 16)); /* [Y0, U0, Y1, V0, Y2, U1, Y3, V1, ...] */
+
+      __m128i _y0 = _mm_and_si128(yuv0, mask_y); /* [Y0, Y1, Y2, ...] (16-bit) */
+      __m128i u0 = _mm_and_si128(yuv0, mask_u); /* [0, U0, 0, 0, 0, U1, 0, 0, ...] */
+      __m128i v0 = _mm_and_si128(yuv0, mask_v); /* [0, 0, 0, V1, 0, , 0, V1, ...] */
+      __m128i _y1 = _mm_and_si128(yuv1, mask_y); /* [Y0, Y1, Y2, ...] (16-bit) */
+      __m128i u1 = _mm_and_si128(yuv1, mask_u); /* [0, U0, 0, 0, 0, U1, 0, 0, ...] */
+      __m128i v1 = _mm_and_si128(yuv1, mask_v); /* [0, 0, 0, V1, 0, , 0, V1, ...] */
+
+      /* Juggle around to get U and V in the same 16-bit format as Y. */
+      u0 = _mm_srli_si128(u0, 1);
+      v0 = _mm_srli_si128(v0, 3);
+      u1 = _mm_srli_si128(u1, 1);
+      v1 = _mm_srli_si128(v1, 3);
+      u = _mm_packs_epi32(u0, u1);
+      v = _mm_packs_epi32(v0, v1);
+
+      /* Apply YUV offsets (U, V) -= (-128, -128). */
+      u = _mm_sub_epi16(u, chroma_offset);
+      v = _mm_sub_epi16(v, chroma_offset);
+
+      /* Upscale chroma horizontally (nearest). */
+      u0 = _mm_unpacklo_epi16(u, u);
+      u1 = _mm_unpackhi_epi16(u, u);
+      v0 = _mm_unpacklo_epi16(v, v);
+      v1 = _mm_unpackhi_epi16(v, v);
+
+      /* Apply transformations. */
+      _y0 = _mm_mullo_epi16(_y0, yuv_mul);
+      _y1 = _mm_mullo_epi16(_y1, yuv_mul);
+      u0_g   = _mm_mullo_epi16(u0, u_g_mul);
+      u1_g   = _mm_mullo_epi16(u1, u_g_mul);
+      u0_b   = _mm_mullo_epi16(u0, u_b_mul);
+      u1_b   = _mm_mullo_epi16(u1, u_b_mul);
+      v0_r   = _mm_mullo_epi16(v0, v_r_mul);
+      v1_r   = _mm_mullo_epi16(v1, v_r_mul);
+      v0_g   = _mm_mullo_epi16(v0, v_g_mul);
+      v1_g   = _mm_mullo_epi16(v1, v_g_mul);
+
+      /* Add contibutions from the transformed components. */
+      r0 = _mm_srai_epi16(_mm_adds_epi16(_mm_adds_epi16(_y0, v0_r),
+               round_offset), YUV_SHIFT);
+      g0 = _mm_srai_epi16(_mm_adds_epi16(
+               _mm_adds_epi16(_mm_adds_epi16(_y0, v0_g), u0_g), round_offset), YUV_SHIFT);
+      b0 = _mm_srai_epi16(_mm_adds_epi16(
+               _mm_adds_epi16(_y0, u0_b), round_offset), YUV_SHIFT);
+
+      r1 = _mm_srai_epi16(_mm_adds_epi16(
+               _mm_adds_epi16(_y1, v1_r), round_offset), YUV_SHIFT);
+      g1 = _mm_srai_epi16(_mm_adds_epi16(
+               _mm_adds_epi16(_mm_adds_epi16(_y1, v1_g), u1_g), round_offset), YUV_SHIFT);
+      b1 = _mm_srai_epi16(_mm_adds_epi16(
+               _mm_adds_epi16(_y1, u1_b), round_offset), YUV_SHIFT);
+
+      /* Saturate into 8-bit. */
+      r0 = _mm_packus_epi16(r0, r1);
+      g0 = _mm_packus_epi16(g0, g1);
+      b0 = _mm_packus_epi16(b0, b1);
+
+      /* Interleave into ARGB. */
+      res_lo_bg = _mm_unpacklo_epi8(b0, g0);
+      res_hi_bg = _mm_unpackhi_epi8(b0, g0);
+      res_lo_ra = _mm_unpacklo_epi8(r0, a);
+      res_hi_ra = _mm_unpackhi_epi8(r0, a);
+      res0 = _mm_unpacklo_epi16(res_lo_bg, res_lo_ra);
+      res1 = _mm_unpackhi_epi16(res_lo_bg, res_lo_ra);
+      res2 = _mm_unpacklo_epi16(res_hi_bg, res_hi_ra);
+      res3 = _mm_unpackhi_epi16(res_hi_bg, res_hi_ra);
+
+      _mm_storeu_si128((__m128i*)(dst +  0), res0);
+      _mm_storeu_si128((__m128i*)(dst +  4), res1);
+      _mm_storeu_si128((__m128i*)(dst +  8), res2);
+      _mm_storeu_si128((__m128i*)(dst + 12), res3);
+   }
+
+   return w;
+}
 #endif
 
-   for (h = 0; h < height; h++, output += out_stride >> 2, input += in_stride)
+#ifdef PIXCONV_HAVE_AVX2
+static PIXCONV_AVX2_TARGET int conv_yuyv_argb8888_avx2(void *output_,
+      const void *input_, int width)
+{
+   int w                       = 0;
+   const uint8_t *src          = (const uint8_t*)input_;
+   uint32_t      *dst          = (uint32_t*)output_;
+   const __m256i mask_y        = _mm256_set1_epi16(0xff);
+   const __m256i chroma_offset = _mm256_set1_epi16(128);
+   const __m256i round_offset  = _mm256_set1_epi16(YUV_OFFSET);
+   const __m256i u_g_mul       = _mm256_set1_epi16(YUV_MAT_U_G);
+   const __m256i u_b_mul       = _mm256_set1_epi16(YUV_MAT_U_B);
+   const __m256i v_r_mul       = _mm256_set1_epi16(YUV_MAT_V_R);
+   const __m256i v_g_mul       = _mm256_set1_epi16(YUV_MAT_V_G);
+   const __m256i max           = _mm256_set1_epi16(0xff);
+   const __m256i zero          = _mm256_setzero_si256();
+
+   /* Each 32-bit word is [Y0, U, Y1, V]; spreading U and V
+    * over both 16-bit halves keeps every pixel in place,
+    * so no lane crossing is needed until the store. */
+   for (; w + 16 <= width; w += 16, src += 32, dst += 16)
    {
-      const uint8_t *src = input;
-      uint32_t      *dst = output;
-      int              w = 0;
+      __m256i r, g, b;
+      __m256i yuv = _mm256_loadu_si256((const __m256i*)src);
+      __m256i y   = _mm256_slli_epi16(
+            _mm256_and_si256(yuv, mask_y), YUV_SHIFT);
+      __m256i u   = _mm256_srli_epi32(_mm256_slli_epi32(yuv, 16), 24);
+      __m256i v   = _mm256_srli_epi32(yuv, 24);
+
+      u = _mm256_sub_epi16(
+            _mm256_or_si256(u, _mm256_slli_epi32(u, 16)), chroma_offset);
+      v = _mm256_sub_epi16(
+            _mm256_or_si256(v, _mm256_slli_epi32(v, 16)), chroma_offset);
+      y = _mm256_add_epi16(y, round_offset);
+
+      r = _mm256_add_epi16(y, _mm256_mullo_epi16(v, v_r_mul));
+      g = _mm256_add_epi16(_mm256_add_epi16(y,
+               _mm256_mullo_epi16(u, u_g_mul)),
+            _mm256_mullo_epi16(v, v_g_mul));
+      b = _mm256_add_epi16(y, _mm256_mullo_epi16(u, u_b_mul));
+
+      r = _mm256_max_epi16(_mm256_min_epi16(
+               _mm256_srai_epi16(r, YUV_SHIFT), max), zero);
+      g = _mm256_max_epi16(_mm256_min_epi16(
+               _mm256_srai_epi16(g, YUV_SHIFT), max), zero);
+      b = _mm256_max_epi16(_mm256_min_epi16(
+               _mm256_srai_epi16(b, YUV_SHIFT), max), zero);
+
+      pixconv_store_argb8888_avx2(dst, b, g, r);
+   }
 
-#if defined(__SSE2__)
-      /* Each loop processes 16 pixels. */
-      for (; w + 16 <= width; w += 16, src += 32, dst += 16)
-      {
-         __m128i u, v, u0_g, u1_g, u0_b, u1_b, v0_r, v1_r, v0_g, v1_g,
-                 r0, g0, b0, r1, g1, b1;
-         __m128i res_lo_bg, res_hi_bg, res_lo_ra, res_hi_ra;
-         __m128i res0, res1, res2, res3;
-         __m128i yuv0 = _mm_loadu_si128((const __m128i*)(src +  0)); /* [Y0, U0, Y1, V0, Y2, U1, Y3, V1, ...] */
-         __m128i yuv1 = _mm_loadu_si128((const __m128i*)(src + 16)); /* [Y0, U0, Y1, V0, Y2, U1, Y3, V1, ...] */
-
-         __m128i _y0 = _mm_and_si128(yuv0, mask_y); /* [Y0, Y1, Y2, ...] (16-bit) */
-         __m128i u0 = _mm_and_si128(yuv0, mask_u); /* [0, U0, 0, 0, 0, U1, 0, 0, ...] */
-         __m128i v0 = _mm_and_si128(yuv0, mask_v); /* [0, 0, 0, V1, 0, , 0, V1, ...] */
-         __m128i _y1 = _mm_and_si128(yuv1, mask_y); /* [Y0, Y1, Y2, ...] (16-bit) */
-         __m128i u1 = _mm_and_si128(yuv1, mask_u); /* [0, U0, 0, 0, 0, U1, 0, 0, ...] */
-         __m128i v1 = _mm_and_si128(yuv1, mask_v); /* [0, 0, 0, V1, 0, , 0, V1, ...] */
-
-         /* Juggle around to get U and V in the same 16-bit format as Y. */
-         u0 = _mm_srli_si128(u0, 1);
-         v0 = _mm_srli_si128(v0, 3);
-         u1 = _mm_srli_si128(u1, 1);
-         v1 = _mm_srli_si128(v1, 3);
-         u = _mm_packs_epi32(u0, u1);
-         v = _mm_packs_epi32(v0, v1);
-
-         /* Apply YUV offsets (U, V) -= (-128, -128). */
-         u = _mm_sub_epi16(u, chroma_offset);
-         v = _mm_sub_epi16(v, chroma_offset);
-
-         /* Upscale chroma horizontally (nearest). */
-         u0 = _mm_unpacklo_epi16(u, u);
-         u1 = _mm_unpackhi_epi16(u, u);
-         v0 = _mm_unpacklo_epi16(v, v);
-         v1 = _mm_unpackhi_epi16(v, v);
-
-         /* Apply transformations. */
-         _y0 = _mm_mullo_epi16(_y0, yuv_mul);
-         _y1 = _mm_mullo_epi16(_y1, yuv_mul);
-         u0_g   = _mm_mullo_epi16(u0, u_g_mul);
-         u1_g   = _mm_mullo_epi16(u1, u_g_mul);
-         u0_b   = _mm_mullo_epi16(u0, u_b_mul);
-         u1_b   = _mm_mullo_epi16(u1, u_b_mul);
-         v0_r   = _mm_mullo_epi16(v0, v_r_mul);
-         v1_r   = _mm_mullo_epi16(v1, v_r_mul);
-         v0_g   = _mm_mullo_epi16(v0, v_g_mul);
-         v1_g   = _mm_mullo_epi16(v1, v_g_mul);
-
-         /* Add contibutions from the transformed components. */
-         r0 = _mm_srai_epi16(_mm_adds_epi16(_mm_adds_epi16(_y0, v0_r),
-                  round_offset), YUV_SHIFT);
-         g0 = _mm_srai_epi16(_mm_adds_epi16(
-                  _mm_adds_epi16(_mm_adds_epi16(_y0, v0_g), u0_g), round_offset), YUV_SHIFT);
-         b0 = _mm_srai_epi16(_mm_adds_epi16(
-                  _mm_adds_epi16(_y0, u0_b), round_offset), YUV_SHIFT);
-
-         r1 = _mm_srai_epi16(_mm_adds_epi16(
-                  _mm_adds_epi16(_y1, v1_r), round_offset), YUV_SHIFT);
-         g1 = _mm_srai_epi16(_mm_adds_epi16(
-                  _mm_adds_epi16(_mm_adds_epi16(_y1, v1_g), u1_g), round_offset), YUV_SHIFT);
-         b1 = _mm_srai_epi16(_mm_adds_epi16(
-                  _mm_adds_epi16(_y1, u1_b), round_offset), YUV_SHIFT);
-
-         /* Saturate into 8-bit. */
-         r0 = _mm_packus_epi16(r0, r1);
-         g0 = _mm_packus_epi16(g0, g1);
-         b0 = _mm_packus_epi16(b0, b1);
-
-         /* Interleave into ARGB. */
-         res_lo_bg = _mm_unpacklo_epi8(b0, g0);
-         res_hi_bg = _mm_unpackhi_epi8(b0, g0);
-         res_lo_ra = _mm_unpacklo_epi8(r0, a);
-         res_hi_ra = _mm_unpackhi_epi8(r0, a);
-         res0 = _mm_unpacklo_epi16(res_lo_bg, res_lo_ra);
-         res1 = _mm_unpackhi_epi16(res_lo_bg, res_lo_ra);
-         res2 = _mm_unpacklo_epi16(res_hi_bg, res_hi_ra);
-         res3 = _mm_unpackhi_epi16(res_hi_bg, res_hi_ra);
-
-         _mm_storeu_si128((__m128i*)(dst +  0), res0);
-         _mm_storeu_si128((__m128i*)(dst +  4), res1);
-         _mm_storeu_si128((__m128i*)(dst +  8), res2);
-         _mm_storeu_si128((__m128i*)(dst + 12), res3);
-      }
+   return w;
+}
+#endif
+
+#ifdef PIXCONV_HAVE_NEON
+static int conv_yuyv_argb8888_neon(void *output_, const void *input_,
+      int width)
+{
+   int w                        = 0;
+   const uint8_t *src           = (const uint8_t*)input_;
+   uint32_t      *dst           = (uint32_t*)output_;
+   const int16x8_t chroma       = vdupq_n_s16(128);
+   const int16x8_t round_offset = vdupq_n_s16(YUV_OFFSET);
+
+   /* vld4 splits 8 [Y0, U, Y1, V] groups into even luma,
+    * U, odd luma and V; the results are zipped back into
+    * pixel order. */
+   for (; w + 16 <= width; w += 16, src += 32, dst += 16)
+   {
+      uint8x16x4_t px;
+      uint8x8x2_t r, g, b;
+      uint8x8x4_t yuv = vld4_u8(src);
+      int16x8_t y0    = vmulq_n_s16(vreinterpretq_s16_u16(
+               vmovl_u8(yuv.val[0])), YUV_MAT_Y);
+      int16x8_t y1    = vmulq_n_s16(vreinterpretq_s16_u16(
+               vmovl_u8(yuv.val[2])), YUV_MAT_Y);
+      int16x8_t u     = vsubq_s16(vreinterpretq_s16_u16(
+               vmovl_u8(yuv.val[1])), chroma);
+      int16x8_t v     = vsubq_s16(vreinterpretq_s16_u16(
+               vmovl_u8(yuv.val[3])), chroma);
+      int16x8_t rr    = vaddq_s16(vmulq_n_s16(v, YUV_MAT_V_R), round_offset);
+      int16x8_t gg    = vaddq_s16(vaddq_s16(vmulq_n_s16(u, YUV_MAT_U_G),
+               vmulq_n_s16(v, YUV_MAT_V_G)), round_offset);
+      int16x8_t bb    = vaddq_s16(vmulq_n_s16(u, YUV_MAT_U_B), round_offset);
+
+      r = vzip_u8(
+            vqmovun_s16(vshrq_n_s16(vaddq_s16(y0, rr), YUV_SHIFT)),
+            vqmovun_s16(vshrq_n_s16(vaddq_s16(y1, rr), YUV_SHIFT)));
+      g = vzip_u8(
+            vqmovun_s16(vshrq_n_s16(vaddq_s16(y0, gg), YUV_SHIFT)),
+            vqmovun_s16(vshrq_n_s16(vaddq_s16(y1, gg), YUV_SHIFT)));
+      b = vzip_u8(
+            vqmovun_s16(vshrq_n_s16(vaddq_s16(y0, bb), YUV_SHIFT)),
+            vqmovun_s16(vshrq_n_s16(vaddq_s16(y1, bb), YUV_SHIFT)));
+
+      px.val[0] = vcombine_u8(b.val[0], b.val[1]);
+      px.val[1] = vcombine_u8(g.val[0], g.val[1]);
+      px.val[2] = vcombine_u8(r.val[0], r.val[1]);
+      px.val[3] = vdupq_n_u8(0xff);
+      vst4q_u8((uint8_t*)dst, px);
+   }
+
+   return w;
+}
 #endif
 
+void conv_yuyv_argb8888(void *output_, const void *input_,
+      int width, int height,
+      int out_stride, int in_stride)
+{
+   int h;
+   const uint8_t *input        = (const uint8_t*)input_;
+   uint32_t *output            = (uint32_t*)output_;
+   pixconv_row_t row           = pixconv_pick(
+         PIXCONV_AVX2(conv_yuyv_argb8888),
+         PIXCONV_SSE2(conv_yuyv_argb8888),
+         NULL,
+         PIXCONV_NEON(conv_yuyv_argb8888));
+
+   for (h = 0; h < height; h++, output += out_stride >> 2, input += in_stride)
+   {
+      int              w = row ? row(output, input, width) : 0;
+      const uint8_t *src = input + w * 2;
+      uint32_t      *dst = output + w;
+
       /* Finish off the rest (if any) in C. */
       for (; w < width; w += 2, src += 4, dst += 2)
       {
@@ -1020,7 +2305,10 @@ void conv_yuyv_argb8888(void *output_, const void *input_,
          uint8_t b1 = clamp_8bit((YUV_MAT_Y * _y1 + YUV_MAT_U_B * u                   + YUV_OFFSET) >> YUV_SHIFT);
 
          dst[0]     = 0xff000000u | (r0 << 16) | (g0 << 8) | (b0 << 0);
-         dst[1]     = 0xff000000u | (r1 << 16) | (g1 << 8) | (b1 << 0);
+
+         /* An odd width ends on half a pair. */
+         if (w + 1 < width)
+            dst[1]  = 0xff000000u | (r1 << 16) | (g1 << 8) | (b1 << 0);
       }
    }
 }
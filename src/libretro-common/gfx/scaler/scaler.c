@@ -30,6 +30,27 @@
 #include <gfx/scaler/filter.h>
 #include <gfx/scaler/pixconv.h>
 
+#ifdef HAVE_THREADS
+#include <rthreads/tpool.h>
+
+/* One range of rows, for one thread */
+struct scaler_slice
+{
+   struct scaler_ctx *ctx;
+   void *output;
+   const void *input;
+   int first;
+   int last;
+};
+
+struct scaler_pool
+{
+   tpool_t *tp;
+   struct scaler_slice *slices;
+   unsigned num_slices;
+};
+#endif
+
 static bool allocate_frames(struct scaler_ctx *ctx)
 {
    uint64_t *scaled_frame = NULL;
@@ -74,11 +95,62 @@ static bool allocate_frames(struct scaler_ctx *ctx)
    return true;
 }
 
-bool scaler_ctx_gen_filter(struct scaler_ctx *ctx)
+#ifdef HAVE_THREADS
+static void scaler_pool_free(struct scaler_pool *pool)
 {
-   scaler_ctx_gen_reset(ctx);
+   if (!pool)
+      return;
+   if (pool->tp)
+      tpool_destroy(pool->tp);
+   free(pool->slices);
+   free(pool);
+}
+
+/* The calling thread takes the first slice, so the pool
+ * has one thread less than the slices. */
+static struct scaler_pool *scaler_pool_new(unsigned threads)
+{
+   struct scaler_pool *pool = (struct scaler_pool*)
+      calloc(1, sizeof(*pool));
+
+   if (!pool)
+      return NULL;
+
+   pool->num_slices = threads;
+
+   if (   !(pool->slices = (struct scaler_slice*)calloc(
+               threads, sizeof(*pool->slices)))
+       || !(pool->tp     = tpool_create(threads - 1)))
+   {
+      scaler_pool_free(pool);
+      return NULL;
+   }
+
+   return pool;
+}
+#endif
 
+static bool scaler_ctx_gen_cached(const struct scaler_ctx *ctx)
+{
+   return ctx->gen.valid
+      && ctx->gen.in_width    == ctx->in_width
+      && ctx->gen.in_height   == ctx->in_height
+      && ctx->gen.out_width   == ctx->out_width
+      && ctx->gen.out_height  == ctx->out_height
+      && ctx->gen.in_fmt      == ctx->in_fmt
+      && ctx->gen.out_fmt     == ctx->out_fmt
+      && ctx->gen.scaler_type == ctx->scaler_type
+      && ctx->gen.threads     == ctx->threads;
+}
+
+static bool scaler_ctx_gen(struct scaler_ctx *ctx)
+{
+   ctx->scaler_horiz   = NULL;
+   ctx->scaler_vert    = NULL;
    ctx->scaler_special = NULL;
+   ctx->in_pixconv     = NULL;
+   ctx->out_pixconv    = NULL;
+   ctx->direct_pixconv = NULL;
    ctx->unscaled       = false;
 
    if (!allocate_frames(ctx))
@@ -159,6 +231,9 @@ bool scaler_ctx_gen_filter(struct scaler_ctx *ctx)
                   case SCALER_FMT_RGBA4444:
                      ctx->direct_pixconv = conv_argb8888_rgba4444;
                      break;
+                  case SCALER_FMT_RGB565:
+                     ctx->direct_pixconv = conv_argb8888_rgb565;
+                     break;
                   default:
                      break;
                }
@@ -247,6 +322,10 @@ bool scaler_ctx_gen_filter(struct scaler_ctx *ctx)
             ctx->out_pixconv = conv_argb8888_0rgb1555;
             break;
 
+         case SCALER_FMT_RGB565:
+            ctx->out_pixconv = conv_argb8888_rgb565;
+            break;
+
          case SCALER_FMT_BGR24:
             ctx->out_pixconv = conv_argb8888_bgr24;
             break;
@@ -261,15 +340,52 @@ bool scaler_ctx_gen_filter(struct scaler_ctx *ctx)
 
       if (!scaler_gen_filter(ctx))
          return false;
+
+      /* The point scaler does both passes at once */
+      if (ctx->scaler_special)
+      {
+         ctx->scaler_horiz = NULL;
+         ctx->scaler_vert  = NULL;
+      }
+
+#ifdef HAVE_THREADS
+      if (ctx->threads > 1)
+         ctx->pool = scaler_pool_new(ctx->threads);
+#endif
    }
 
    return true;
 }
 
+bool scaler_ctx_gen_filter(struct scaler_ctx *ctx)
+{
+   if (scaler_ctx_gen_cached(ctx))
+      return true;
+
+   scaler_ctx_gen_reset(ctx);
+
+   if (!scaler_ctx_gen(ctx))
+      return false;
+
+   ctx->gen.in_width    = ctx->in_width;
+   ctx->gen.in_height   = ctx->in_height;
+   ctx->gen.out_width   = ctx->out_width;
+   ctx->gen.out_height  = ctx->out_height;
+   ctx->gen.in_fmt      = ctx->in_fmt;
+   ctx->gen.out_fmt     = ctx->out_fmt;
+   ctx->gen.scaler_type = ctx->scaler_type;
+   ctx->gen.threads     = ctx->threads;
+   ctx->gen.valid       = true;
+
+   return true;
+}
+
 void scaler_ctx_gen_reset(struct scaler_ctx *ctx)
 {
    if (ctx->horiz.filter)
       free(ctx->horiz.filter);
+   if (ctx->horiz.filter_bank)
+      free(ctx->horiz.filter_bank);
    if (ctx->horiz.filter_pos)
       free(ctx->horiz.filter_pos);
    if (ctx->vert.filter)
@@ -282,8 +398,12 @@ void scaler_ctx_gen_reset(struct scaler_ctx *ctx)
       free(ctx->input.frame);
    if (ctx->output.frame)
       free(ctx->output.frame);
+#ifdef HAVE_THREADS
+   scaler_pool_free(ctx->pool);
+#endif
 
    ctx->horiz.filter        = NULL;
+   ctx->horiz.filter_bank   = NULL;
    ctx->horiz.filter_len    = 0;
    ctx->horiz.filter_stride = 0;
    ctx->horiz.filter_pos    = NULL;
@@ -303,32 +423,49 @@ void scaler_ctx_gen_reset(struct scaler_ctx *ctx)
 
    ctx->output.frame        = NULL;
    ctx->output.stride       = 0;
+
+   ctx->pool                = NULL;
+   ctx->gen.valid           = false;
 }
 
-/**
- * scaler_ctx_scale:
- * @ctx          : pointer to scaler context object.
- * @output       : pointer to output image.
- * @input        : pointer to input image.
- *
- * Scales an input image to an output image.
- **/
-void scaler_ctx_scale(struct scaler_ctx *ctx,
-      void *output, const void *input)
+/* Scaling is done in two halves, each of which can be split
+ * by rows: the input conversion and the horizontal pass over
+ * the input rows, then the vertical pass (or the special
+ * scaler) and the output conversion over the output rows. */
+static void scaler_ctx_horiz_rows(struct scaler_ctx *ctx,
+      const void *input, int first, int last)
 {
    const void *input_frame = input;
-   void *output_frame      = output;
    int input_stride        = ctx->in_stride;
-   int output_stride       = ctx->out_stride;
 
    if (ctx->in_fmt != SCALER_FMT_ARGB8888)
    {
-      ctx->in_pixconv(ctx->input.frame, input,
-            ctx->in_width, ctx->in_height,
+      ctx->in_pixconv(
+            (uint8_t*)ctx->input.frame + first * ctx->input.stride,
+            (const uint8_t*)input + first * ctx->in_stride,
+            ctx->in_width, last - first,
             ctx->input.stride, ctx->in_stride);
 
-      input_frame       = ctx->input.frame;
-      input_stride      = ctx->input.stride;
+      input_frame  = ctx->input.frame;
+      input_stride = ctx->input.stride;
+   }
+
+   if (ctx->scaler_horiz)
+      ctx->scaler_horiz(ctx, input_frame, input_stride, first, last);
+}
+
+static void scaler_ctx_vert_rows(struct scaler_ctx *ctx,
+      void *output, const void *input, int first, int last)
+{
+   void *output_frame      = output;
+   const void *input_frame = input;
+   int output_stride       = ctx->out_stride;
+   int input_stride        = ctx->in_stride;
+
+   if (ctx->in_fmt != SCALER_FMT_ARGB8888)
+   {
+      input_frame   = ctx->input.frame;
+      input_stride  = ctx->input.stride;
    }
 
    if (ctx->out_fmt != SCALER_FMT_ARGB8888)
@@ -342,18 +479,93 @@ void scaler_ctx_scale(struct scaler_ctx *ctx,
       ctx->scaler_special(ctx, output_frame, input_frame,
             ctx->out_width, ctx->out_height,
             ctx->in_width, ctx->in_height,
-            output_stride, input_stride);
+            output_stride, input_stride, first, last);
    else
-   {
-      /* Take generic filter path. */
-      if (ctx->scaler_horiz)
-         ctx->scaler_horiz(ctx, input_frame, input_stride);
-      if (ctx->scaler_vert)
-         ctx->scaler_vert (ctx, output, output_stride);
-   }
+      ctx->scaler_vert(ctx, output_frame, output_stride, first, last);
 
    if (ctx->out_fmt != SCALER_FMT_ARGB8888)
-      ctx->out_pixconv(output, ctx->output.frame,
-            ctx->out_width, ctx->out_height,
+      ctx->out_pixconv(
+            (uint8_t*)output + first * ctx->out_stride,
+            (const uint8_t*)ctx->output.frame + first * ctx->output.stride,
+            ctx->out_width, last - first,
             ctx->out_stride, ctx->output.stride);
 }
+
+#ifdef HAVE_THREADS
+static void scaler_slice_horiz(void *data)
+{
+   struct scaler_slice *slice = (struct scaler_slice*)data;
+   scaler_ctx_horiz_rows(slice->ctx, slice->input,
+         slice->first, slice->last);
+}
+
+static void scaler_slice_vert(void *data)
+{
+   struct scaler_slice *slice = (struct scaler_slice*)data;
+   scaler_ctx_vert_rows(slice->ctx, slice->output, slice->input,
+         slice->first, slice->last);
+}
+
+/* Splits @rows evenly, hands all but the first slice to the
+ * pool and returns once every slice is done. */
+static void scaler_pool_run(struct scaler_ctx *ctx, thread_func_t func,
+      void *output, const void *input, int rows)
+{
+   unsigned i;
+   struct scaler_pool *pool = ctx->pool;
+   unsigned num_slices      = pool->num_slices;
+
+   for (i = 0; i < num_slices; i++)
+   {
+      struct scaler_slice *slice = &pool->slices[i];
+
+      slice->ctx    = ctx;
+      slice->output = output;
+      slice->input  = input;
+      slice->first  = (int)(rows * i / num_slices);
+      slice->last   = (int)(rows * (i + 1) / num_slices);
+   }
+
+   for (i = 1; i < num_slices; i++)
+      if (!tpool_add_work(pool->tp, func, &pool->slices[i]))
+         func(&pool->slices[i]);
+
+   func(&pool->slices[0]);
+   tpool_wait(pool->tp);
+}
+#endif
+
+/**
+ * scaler_ctx_scale:
+ * @ctx          : pointer to scaler context object.
+ * @output       : pointer to output image.
+ * @input        : pointer to input image.
+ *
+ * Scales an input image to an output image.
+ **/
+void scaler_ctx_scale(struct scaler_ctx *ctx,
+      void *output, const void *input)
+{
+   if (ctx->unscaled)
+   {
+      if (ctx->direct_pixconv)
+         ctx->direct_pixconv(output, input,
+               ctx->out_width,  ctx->out_height,
+               ctx->out_stride, ctx->in_stride);
+   }
+   else if (ctx->scaler_special || (ctx->scaler_horiz && ctx->scaler_vert))
+   {
+#ifdef HAVE_THREADS
+      if (ctx->pool)
+      {
+         scaler_pool_run(ctx, scaler_slice_horiz,
+               NULL, input, ctx->in_height);
+         scaler_pool_run(ctx, scaler_slice_vert,
+               output, input, ctx->out_height);
+         return;
+      }
+#endif
+      scaler_ctx_horiz_rows(ctx, input, 0, ctx->in_height);
+      scaler_ctx_vert_rows(ctx, output, input, 0, ctx->out_height);
+   }
+}
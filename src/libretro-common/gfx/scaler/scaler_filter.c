@@ -157,6 +157,32 @@ static void fixup_filter_sub(struct scaler_filter *filter,
    }
 }
 
+/* Repeats every coefficient for the four channels, so the
+ * SIMD horizontal pass loads them instead of building them
+ * for every pixel of every frame. */
+static bool gen_filter_bank(struct scaler_filter *filter, int out_len)
+{
+   int i, j, k;
+   int16_t *bank       = (int16_t*)calloc(sizeof(int16_t),
+         out_len * filter->filter_len * 4);
+
+   if (!bank)
+      return false;
+
+   filter->filter_bank = bank;
+
+   for (i = 0; i < out_len; i++)
+   {
+      const int16_t *coeffs = filter->filter + i * filter->filter_stride;
+
+      for (j = 0; j < filter->filter_len; j++)
+         for (k = 0; k < 4; k++)
+            *bank++ = coeffs[j];
+   }
+
+   return true;
+}
+
 bool scaler_gen_filter(struct scaler_ctx *ctx)
 {
    int x_pos, x_step, y_pos, y_step;
@@ -242,5 +268,8 @@ bool scaler_gen_filter(struct scaler_ctx *ctx)
    fixup_filter_sub(&ctx->horiz, ctx->out_width, ctx->in_width);
    fixup_filter_sub(&ctx->vert,  ctx->out_height, ctx->in_height);
 
-   return validate_filter(ctx);
+   if (!validate_filter(ctx))
+      return false;
+
+   return gen_filter_bank(&ctx->horiz, ctx->out_width);
 }
@@ -20,9 +20,17 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
+#include <string.h>
+
 #include <gfx/scaler/scaler_int.h>
+#include <gfx/scaler/pixconv.h>
 
 #include <retro_inline.h>
+#include <features/features_cpu.h>
+
+#if _MSC_VER && _MSC_VER <= 1800
+#define SCALER_NO_SIMD
+#endif
 
 #ifdef SCALER_NO_SIMD
 #undef __SSE2__
@@ -35,6 +43,27 @@
 #endif
 #endif
 
+/* As in pixconv.c, AVX2 gets a per-function target where
+ * the compiler supports it, and NEON is used wherever the
+ * compiler knows it. */
+#if defined(SCALER_NO_SIMD)
+#elif defined(__AVX2__)
+#define SCALER_HAVE_AVX2
+#define SCALER_AVX2_TARGET
+#elif (defined(__x86_64__) || defined(__i386__)) && (defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define SCALER_HAVE_AVX2
+#define SCALER_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+
+#ifdef SCALER_HAVE_AVX2
+#include <immintrin.h>
+#endif
+
+#if !defined(SCALER_NO_SIMD) && (defined(__ARM_NEON__) || defined(__ARM_NEON) || defined(HAVE_NEON) || defined(_M_ARM) || defined(_M_ARM64))
+#define SCALER_HAVE_NEON
+#include <arm_neon.h>
+#endif
+
 /* ARGB8888 scaler is split in two:
  *
  * First, horizontal scaler is applied.
@@ -60,174 +89,442 @@
  *
  * The C version of scalers perform the exact same operations as the
  * SIMD code for testing purposes.
+ *
+ * The SIMD rows work on whole vectors of output pixels and
+ * return how many they did; the C rows finish the rest.
+ * The horizontal rows load their coefficients from the
+ * filter bank, the vertical rows take one coefficient per
+ * input row for the whole output row.
  */
 
-void scaler_argb8888_vert(const struct scaler_ctx *ctx, void *output_, int stride)
+typedef int (*scaler_horiz_row_t)(const struct scaler_filter *filter,
+      uint64_t *output, const uint32_t *input, int width);
+typedef int (*scaler_vert_row_t)(const int16_t *filter, int filter_len,
+      uint32_t *output, const uint64_t *input, int stride, int width);
+
+static void scaler_argb8888_horiz_c(const struct scaler_filter *filter,
+      uint64_t *output, const uint32_t *input, int w, int width)
 {
-   int h, w, y;
-   const uint64_t      *input = ctx->scaled.frame;
-   uint32_t           *output = (uint32_t*)output_;
+   int x;
+   const int16_t *filter_horiz = filter->filter + w * filter->filter_stride;
 
-   const int16_t *filter_vert = ctx->vert.filter;
+   for (; w < width; w++, filter_horiz += filter->filter_stride)
+   {
+      const uint32_t *input_base_x = input + filter->filter_pos[w];
+      int16_t res_a = 0;
+      int16_t res_r = 0;
+      int16_t res_g = 0;
+      int16_t res_b = 0;
 
-   for (h = 0; h < ctx->out_height; h++,
-         filter_vert += ctx->vert.filter_stride, output += stride >> 2)
+      for (x = 0; x < filter->filter_len; x++)
+      {
+         uint32_t col   = input_base_x[x];
+
+         int16_t a      = (col >> (24 - 7)) & (0xff << 7);
+         int16_t r      = (col >> (16 - 7)) & (0xff << 7);
+         int16_t g      = (col >> ( 8 - 7)) & (0xff << 7);
+         int16_t b      = (col << ( 0 + 7)) & (0xff << 7);
+
+         int16_t coeff  = filter_horiz[x];
+
+         res_a         += (a * coeff) >> 16;
+         res_r         += (r * coeff) >> 16;
+         res_g         += (g * coeff) >> 16;
+         res_b         += (b * coeff) >> 16;
+      }
+
+      /* Through uint16_t, so that a negative channel (sinc
+       * rings below 0) doesn't sign extend over the others */
+      output[w]         = (
+            (uint64_t)(uint16_t)res_a  << 48)  |
+            ((uint64_t)(uint16_t)res_r << 32)  |
+            ((uint64_t)(uint16_t)res_g << 16)  |
+            ((uint64_t)(uint16_t)res_b << 0);
+   }
+}
+
+static void scaler_argb8888_vert_c(const int16_t *filter_vert,
+      int filter_len, uint32_t *output, const uint64_t *input,
+      int stride, int w, int width)
+{
+   int y;
+
+   for (; w < width; w++)
    {
-      const uint64_t *input_base = input + ctx->vert.filter_pos[h]
-         * (ctx->scaled.stride >> 3);
+      const uint64_t *input_base_y = input + w;
+      int16_t res_a = 0;
+      int16_t res_r = 0;
+      int16_t res_g = 0;
+      int16_t res_b = 0;
 
-      for (w = 0; w < ctx->out_width; w++)
+      for (y = 0; y < filter_len; y++, input_base_y += stride)
       {
-         const uint64_t *input_base_y = input_base + w;
+         uint64_t col   = *input_base_y;
+
+         int16_t a      = (col >> 48) & 0xffff;
+         int16_t r      = (col >> 32) & 0xffff;
+         int16_t g      = (col >> 16) & 0xffff;
+         int16_t b      = (col >>  0) & 0xffff;
+
+         int16_t coeff  = filter_vert[y];
+
+         res_a         += (a * coeff) >> 16;
+         res_r         += (r * coeff) >> 16;
+         res_g         += (g * coeff) >> 16;
+         res_b         += (b * coeff) >> 16;
+      }
+
+      res_a           >>= (7 - 2 - 2);
+      res_r           >>= (7 - 2 - 2);
+      res_g           >>= (7 - 2 - 2);
+      res_b           >>= (7 - 2 - 2);
+
+      output[w]         =
+         ((uint32_t)clamp_8bit(res_a) << 24) |
+         (clamp_8bit(res_r) << 16) |
+         (clamp_8bit(res_g) << 8)  |
+         (clamp_8bit(res_b) << 0);
+   }
+}
+
 #if defined(__SSE2__)
-         __m128i final;
-         __m128i res = _mm_setzero_si128();
-
-         for (y = 0; (y + 1) < ctx->vert.filter_len; y += 2,
-               input_base_y += (ctx->scaled.stride >> 2))
-         {
-            __m128i coeff = _mm_set_epi64x(filter_vert[y + 1] * 0x0001000100010001ll, filter_vert[y + 0] * 0x0001000100010001ll);
-            __m128i col   = _mm_set_epi64x(input_base_y[ctx->scaled.stride >> 3], input_base_y[0]);
-
-            res           = _mm_adds_epi16(_mm_mulhi_epi16(col, coeff), res);
-         }
-
-         for (; y < ctx->vert.filter_len; y++, input_base_y += (ctx->scaled.stride >> 3))
-         {
-            __m128i coeff = _mm_set_epi64x(0, filter_vert[y] * 0x0001000100010001ll);
-            __m128i col   = _mm_set_epi64x(0, input_base_y[0]);
-
-            res           = _mm_adds_epi16(_mm_mulhi_epi16(col, coeff), res);
-         }
-
-         res       = _mm_adds_epi16(_mm_srli_si128(res, 8), res);
-         res       = _mm_srai_epi16(res, (7 - 2 - 2));
-
-         final     = _mm_packus_epi16(res, res);
-
-         output[w] = _mm_cvtsi128_si32(final);
-#else
-         int16_t res_a = 0;
-         int16_t res_r = 0;
-         int16_t res_g = 0;
-         int16_t res_b = 0;
-
-         for (y = 0; y < ctx->vert.filter_len; y++,
-               input_base_y += (ctx->scaled.stride >> 3))
-         {
-            uint64_t col   = *input_base_y;
-
-            int16_t a      = (col >> 48) & 0xffff;
-            int16_t r      = (col >> 32) & 0xffff;
-            int16_t g      = (col >> 16) & 0xffff;
-            int16_t b      = (col >>  0) & 0xffff;
-
-            int16_t coeff  = filter_vert[y];
-
-            res_a         += (a * coeff) >> 16;
-            res_r         += (r * coeff) >> 16;
-            res_g         += (g * coeff) >> 16;
-            res_b         += (b * coeff) >> 16;
-         }
-
-         res_a           >>= (7 - 2 - 2);
-         res_r           >>= (7 - 2 - 2);
-         res_g           >>= (7 - 2 - 2);
-         res_b           >>= (7 - 2 - 2);
-
-         output[w]         =
-            (clamp_8bit(res_a) << 24) |
-            (clamp_8bit(res_r) << 16) |
-            (clamp_8bit(res_g) << 8)  |
-            (clamp_8bit(res_b) << 0);
+/* One output pixel per iteration, two taps per vector */
+static int scaler_argb8888_horiz_sse2(const struct scaler_filter *filter,
+      uint64_t *output, const uint32_t *input, int width)
+{
+   int w, x;
+   const int len       = filter->filter_len;
+   const int16_t *bank = filter->filter_bank;
+   const __m128i zero  = _mm_setzero_si128();
+
+   for (w = 0; w < width; w++, bank += len * 4)
+   {
+      const uint32_t *input_base_x = input + filter->filter_pos[w];
+      __m128i res                  = _mm_setzero_si128();
+
+      for (x = 0; (x + 1) < len; x += 2)
+      {
+         __m128i coeff = _mm_loadu_si128((const __m128i*)(bank + x * 4));
+         __m128i col   = _mm_unpacklo_epi8(_mm_loadl_epi64(
+                  (const __m128i*)(input_base_x + x)), zero);
+
+         col           = _mm_slli_epi16(col, 7);
+         res           = _mm_adds_epi16(_mm_mulhi_epi16(col, coeff), res);
+      }
+
+      if (x < len)
+      {
+         __m128i coeff = _mm_loadl_epi64((const __m128i*)(bank + x * 4));
+         __m128i col   = _mm_unpacklo_epi8(_mm_cvtsi32_si128(
+                  (int)input_base_x[x]), zero);
+
+         col           = _mm_slli_epi16(col, 7);
+         res           = _mm_adds_epi16(_mm_mulhi_epi16(col, coeff), res);
+      }
+
+      res              = _mm_adds_epi16(_mm_srli_si128(res, 8), res);
+      _mm_storel_epi64((__m128i*)(output + w), res);
+   }
+
+   return width;
+}
+
+/* Four output pixels per iteration */
+static int scaler_argb8888_vert_sse2(const int16_t *filter_vert,
+      int filter_len, uint32_t *output, const uint64_t *input,
+      int stride, int width)
+{
+   int w, y;
+
+   for (w = 0; (w + 4) <= width; w += 4)
+   {
+      const uint64_t *input_base_y = input + w;
+      __m128i res0                 = _mm_setzero_si128();
+      __m128i res1                 = _mm_setzero_si128();
+
+      for (y = 0; y < filter_len; y++, input_base_y += stride)
+      {
+         __m128i coeff = _mm_set1_epi16(filter_vert[y]);
+         __m128i col0  = _mm_loadu_si128((const __m128i*)(input_base_y + 0));
+         __m128i col1  = _mm_loadu_si128((const __m128i*)(input_base_y + 2));
+
+         res0          = _mm_adds_epi16(_mm_mulhi_epi16(col0, coeff), res0);
+         res1          = _mm_adds_epi16(_mm_mulhi_epi16(col1, coeff), res1);
+      }
+
+      res0 = _mm_srai_epi16(res0, (7 - 2 - 2));
+      res1 = _mm_srai_epi16(res1, (7 - 2 - 2));
+
+      _mm_storeu_si128((__m128i*)(output + w), _mm_packus_epi16(res0, res1));
+   }
+
+   return w;
+}
 #endif
+
+#ifdef SCALER_HAVE_AVX2
+/* Two output pixels per iteration, one in each 128-bit lane,
+ * two taps per lane */
+static SCALER_AVX2_TARGET int scaler_argb8888_horiz_avx2(
+      const struct scaler_filter *filter,
+      uint64_t *output, const uint32_t *input, int width)
+{
+   int w, x;
+   const int len       = filter->filter_len;
+   const int16_t *bank = filter->filter_bank;
+   const __m256i zero  = _mm256_setzero_si256();
+
+   for (w = 0; (w + 2) <= width; w += 2, bank += len * 8)
+   {
+      const uint32_t *input_base_x0 = input + filter->filter_pos[w + 0];
+      const uint32_t *input_base_x1 = input + filter->filter_pos[w + 1];
+      const int16_t *bank1          = bank + len * 4;
+      __m256i res                   = _mm256_setzero_si256();
+
+      for (x = 0; (x + 1) < len; x += 2)
+      {
+         __m256i coeff = _mm256_inserti128_si256(_mm256_castsi128_si256(
+                  _mm_loadu_si128((const __m128i*)(bank  + x * 4))),
+                  _mm_loadu_si128((const __m128i*)(bank1 + x * 4)), 1);
+         __m256i col   = _mm256_inserti128_si256(_mm256_castsi128_si256(
+                  _mm_loadl_epi64((const __m128i*)(input_base_x0 + x))),
+                  _mm_loadl_epi64((const __m128i*)(input_base_x1 + x)), 1);
+
+         col           = _mm256_slli_epi16(_mm256_unpacklo_epi8(col, zero), 7);
+         res           = _mm256_adds_epi16(_mm256_mulhi_epi16(col, coeff), res);
+      }
+
+      if (x < len)
+      {
+         __m256i coeff = _mm256_inserti128_si256(_mm256_castsi128_si256(
+                  _mm_loadl_epi64((const __m128i*)(bank  + x * 4))),
+                  _mm_loadl_epi64((const __m128i*)(bank1 + x * 4)), 1);
+         __m256i col   = _mm256_inserti128_si256(_mm256_castsi128_si256(
+                  _mm_cvtsi32_si128((int)input_base_x0[x])),
+                  _mm_cvtsi32_si128((int)input_base_x1[x]), 1);
+
+         col           = _mm256_slli_epi16(_mm256_unpacklo_epi8(col, zero), 7);
+         res           = _mm256_adds_epi16(_mm256_mulhi_epi16(col, coeff), res);
       }
+
+      res              = _mm256_adds_epi16(_mm256_srli_si256(res, 8), res);
+      _mm_storeu_si128((__m128i*)(output + w), _mm256_castsi256_si128(
+               _mm256_permute4x64_epi64(res, 0x08)));
    }
+
+   return w;
 }
 
-void scaler_argb8888_horiz(const struct scaler_ctx *ctx, const void *input_, int stride)
+/* Eight output pixels per iteration */
+static SCALER_AVX2_TARGET int scaler_argb8888_vert_avx2(
+      const int16_t *filter_vert, int filter_len,
+      uint32_t *output, const uint64_t *input, int stride, int width)
 {
-   int h, w, x;
-   const uint32_t *input = (uint32_t*)input_;
-   uint64_t *output      = ctx->scaled.frame;
+   int w, y;
 
-   for (h = 0; h < ctx->scaled.height; h++, input += stride >> 2,
-         output += ctx->scaled.stride >> 3)
+   for (w = 0; (w + 8) <= width; w += 8)
    {
-      const int16_t *filter_horiz = ctx->horiz.filter;
+      const uint64_t *input_base_y = input + w;
+      __m256i res0                 = _mm256_setzero_si256();
+      __m256i res1                 = _mm256_setzero_si256();
 
-      for (w = 0; w < ctx->scaled.width; w++,
-            filter_horiz += ctx->horiz.filter_stride)
+      for (y = 0; y < filter_len; y++, input_base_y += stride)
       {
-         const uint32_t *input_base_x = input + ctx->horiz.filter_pos[w];
+         __m256i coeff = _mm256_set1_epi16(filter_vert[y]);
+         __m256i col0  = _mm256_loadu_si256((const __m256i*)(input_base_y + 0));
+         __m256i col1  = _mm256_loadu_si256((const __m256i*)(input_base_y + 4));
+
+         res0          = _mm256_adds_epi16(_mm256_mulhi_epi16(col0, coeff), res0);
+         res1          = _mm256_adds_epi16(_mm256_mulhi_epi16(col1, coeff), res1);
+      }
+
+      res0 = _mm256_srai_epi16(res0, (7 - 2 - 2));
+      res1 = _mm256_srai_epi16(res1, (7 - 2 - 2));
+
+      /* packus works within lanes, put the pixels back in order */
+      _mm256_storeu_si256((__m256i*)(output + w), _mm256_permute4x64_epi64(
+               _mm256_packus_epi16(res0, res1), 0xd8));
+   }
+
+   return w;
+}
+#endif
+
+#ifdef SCALER_HAVE_NEON
+/* NEON has no 16-bit multiply high that isn't doubled,
+ * so widen, multiply and narrow back */
+static INLINE int16x8_t scaler_mulhi_neon(int16x8_t a, int16x8_t b)
+{
+   return vcombine_s16(
+         vshrn_n_s32(vmull_s16(vget_low_s16(a),  vget_low_s16(b)),  16),
+         vshrn_n_s32(vmull_s16(vget_high_s16(a), vget_high_s16(b)), 16));
+}
+
+static INLINE int16x8_t scaler_mulhi_n_neon(int16x8_t a, int16_t b)
+{
+   return vcombine_s16(
+         vshrn_n_s32(vmull_n_s16(vget_low_s16(a),  b), 16),
+         vshrn_n_s32(vmull_n_s16(vget_high_s16(a), b), 16));
+}
+
+/* One output pixel per iteration, two taps per vector */
+static int scaler_argb8888_horiz_neon(const struct scaler_filter *filter,
+      uint64_t *output, const uint32_t *input, int width)
+{
+   int w, x;
+   const int len       = filter->filter_len;
+   const int16_t *bank = filter->filter_bank;
+
+   for (w = 0; w < width; w++, bank += len * 4)
+   {
+      const uint32_t *input_base_x = input + filter->filter_pos[w];
+      int16x8_t res                = vdupq_n_s16(0);
+      int16x4_t sum;
+
+      for (x = 0; (x + 1) < len; x += 2)
+      {
+         int16x8_t coeff = vld1q_s16(bank + x * 4);
+         int16x8_t col   = vreinterpretq_s16_u16(vshlq_n_u16(vmovl_u8(
+                     vld1_u8((const uint8_t*)(input_base_x + x))), 7));
+
+         res             = vqaddq_s16(scaler_mulhi_neon(col, coeff), res);
+      }
+
+      sum = vqadd_s16(vget_low_s16(res), vget_high_s16(res));
+
+      if (x < len)
+      {
+         int16x4_t coeff = vld1_s16(bank + x * 4);
+         int16x4_t col   = vget_low_s16(vreinterpretq_s16_u16(vshlq_n_u16(
+                     vmovl_u8(vreinterpret_u8_u32(
+                           vld1_dup_u32(input_base_x + x))), 7)));
+
+         sum             = vqadd_s16(vshrn_n_s32(vmull_s16(col, coeff), 16), sum);
+      }
+
+      vst1_s16((int16_t*)(output + w), sum);
+   }
+
+   return width;
+}
+
+/* Four output pixels per iteration */
+static int scaler_argb8888_vert_neon(const int16_t *filter_vert,
+      int filter_len, uint32_t *output, const uint64_t *input,
+      int stride, int width)
+{
+   int w, y;
+
+   for (w = 0; (w + 4) <= width; w += 4)
+   {
+      const uint64_t *input_base_y = input + w;
+      int16x8_t res0               = vdupq_n_s16(0);
+      int16x8_t res1               = vdupq_n_s16(0);
+
+      for (y = 0; y < filter_len; y++, input_base_y += stride)
+      {
+         int16x8_t col0 = vld1q_s16((const int16_t*)(input_base_y + 0));
+         int16x8_t col1 = vld1q_s16((const int16_t*)(input_base_y + 2));
+
+         res0           = vqaddq_s16(scaler_mulhi_n_neon(col0, filter_vert[y]), res0);
+         res1           = vqaddq_s16(scaler_mulhi_n_neon(col1, filter_vert[y]), res1);
+      }
+
+      vst1q_u8((uint8_t*)(output + w), vcombine_u8(
+               vqmovun_s16(vshrq_n_s16(res0, (7 - 2 - 2))),
+               vqmovun_s16(vshrq_n_s16(res1, (7 - 2 - 2)))));
+   }
+
+   return w;
+}
+#endif
+
+/* The rows follow pixconv_get_simd(), so that one mask
+ * picks the paths for the whole scaler */
+static scaler_horiz_row_t scaler_pick_horiz(void)
+{
+   uint64_t simd = pixconv_get_simd();
+#ifdef SCALER_HAVE_AVX2
+   if (simd & RETRO_SIMD_AVX2)
+      return scaler_argb8888_horiz_avx2;
+#endif
 #if defined(__SSE2__)
-         __m128i res = _mm_setzero_si128();
-#ifndef __x86_64__
-         union
-         {
-            uint32_t *u32;
-            uint64_t *u64;
-         } u;
+   if (simd & RETRO_SIMD_SSE2)
+      return scaler_argb8888_horiz_sse2;
 #endif
-         for (x = 0; (x + 1) < ctx->horiz.filter_len; x += 2)
-         {
-            __m128i coeff = _mm_set_epi64x(filter_horiz[x + 1] * 0x0001000100010001ll, filter_horiz[x + 0] * 0x0001000100010001ll);
-
-            __m128i col   = _mm_unpacklo_epi8(_mm_set_epi64x(0,
-                     ((uint64_t)input_base_x[x + 1] << 32) | input_base_x[x + 0]), _mm_setzero_si128());
-
-            col           = _mm_slli_epi16(col, 7);
-            res           = _mm_adds_epi16(_mm_mulhi_epi16(col, coeff), res);
-         }
-
-         for (; x < ctx->horiz.filter_len; x++)
-         {
-            __m128i coeff = _mm_set_epi64x(0, filter_horiz[x] * 0x0001000100010001ll);
-            __m128i col   = _mm_unpacklo_epi8(_mm_set_epi32(0, 0, 0, input_base_x[x]), _mm_setzero_si128());
-
-            col           = _mm_slli_epi16(col, 7);
-            res           = _mm_adds_epi16(_mm_mulhi_epi16(col, coeff), res);
-         }
-
-         res              = _mm_adds_epi16(_mm_srli_si128(res, 8), res);
-
-#ifdef __x86_64__
-         output[w]        = _mm_cvtsi128_si64(res);
-#else /* 32-bit doesn't have si64. Do it in two steps. */
-         u.u64    = output + w;
-         u.u32[0] = _mm_cvtsi128_si32(res);
-         u.u32[1] = _mm_cvtsi128_si32(_mm_srli_si128(res, 4));
+#ifdef SCALER_HAVE_NEON
+   if (simd & RETRO_SIMD_NEON)
+      return scaler_argb8888_horiz_neon;
 #endif
-#else
-         int16_t res_a = 0;
-         int16_t res_r = 0;
-         int16_t res_g = 0;
-         int16_t res_b = 0;
-
-         for (x = 0; x < ctx->horiz.filter_len; x++)
-         {
-            uint32_t col   = input_base_x[x];
-
-            int16_t a      = (col >> (24 - 7)) & (0xff << 7);
-            int16_t r      = (col >> (16 - 7)) & (0xff << 7);
-            int16_t g      = (col >> ( 8 - 7)) & (0xff << 7);
-            int16_t b      = (col << ( 0 + 7)) & (0xff << 7);
-
-            int16_t coeff  = filter_horiz[x];
-
-            res_a         += (a * coeff) >> 16;
-            res_r         += (r * coeff) >> 16;
-            res_g         += (g * coeff) >> 16;
-            res_b         += (b * coeff) >> 16;
-         }
-
-         output[w]         = (
-               (uint64_t)res_a  << 48)  |
-               ((uint64_t)res_r << 32)  |
-               ((uint64_t)res_g << 16)  |
-               ((uint64_t)res_b << 0);
+   (void)simd;
+   return NULL;
+}
+
+static scaler_vert_row_t scaler_pick_vert(void)
+{
+   uint64_t simd = pixconv_get_simd();
+#ifdef SCALER_HAVE_AVX2
+   if (simd & RETRO_SIMD_AVX2)
+      return scaler_argb8888_vert_avx2;
 #endif
-      }
+#if defined(__SSE2__)
+   if (simd & RETRO_SIMD_SSE2)
+      return scaler_argb8888_vert_sse2;
+#endif
+#ifdef SCALER_HAVE_NEON
+   if (simd & RETRO_SIMD_NEON)
+      return scaler_argb8888_vert_neon;
+#endif
+   (void)simd;
+   return NULL;
+}
+
+void scaler_argb8888_vert(const struct scaler_ctx *ctx, void *output_,
+      int stride, int first, int last)
+{
+   int h;
+   const uint64_t *input        = ctx->scaled.frame;
+   uint32_t *output             = (uint32_t*)output_ + first * (stride >> 2);
+   int scaled_stride            = ctx->scaled.stride >> 3;
+   const int16_t *filter_vert   = ctx->vert.filter
+      + first * ctx->vert.filter_stride;
+   scaler_vert_row_t row        = scaler_pick_vert();
+
+   for (h = first; h < last; h++,
+         filter_vert += ctx->vert.filter_stride, output += stride >> 2)
+   {
+      int w                      = 0;
+      const uint64_t *input_base = input + ctx->vert.filter_pos[h]
+         * scaled_stride;
+
+      if (row)
+         w = row(filter_vert, ctx->vert.filter_len, output,
+               input_base, scaled_stride, ctx->out_width);
+
+      scaler_argb8888_vert_c(filter_vert, ctx->vert.filter_len, output,
+            input_base, scaled_stride, w, ctx->out_width);
+   }
+}
+
+void scaler_argb8888_horiz(const struct scaler_ctx *ctx, const void *input_,
+      int stride, int first, int last)
+{
+   int h;
+   const uint32_t *input  = (const uint32_t*)input_ + first * (stride >> 2);
+   uint64_t *output       = ctx->scaled.frame
+      + first * (ctx->scaled.stride >> 3);
+   scaler_horiz_row_t row = scaler_pick_horiz();
+
+   for (h = first; h < last; h++, input += stride >> 2,
+         output += ctx->scaled.stride >> 3)
+   {
+      int w = 0;
+
+      if (row)
+         w = row(&ctx->horiz, output, input, ctx->scaled.width);
+
+      scaler_argb8888_horiz_c(&ctx->horiz, output, input,
+            w, ctx->scaled.width);
    }
 }
 
@@ -235,7 +532,8 @@ void scaler_argb8888_point_special(const struct scaler_ctx *ctx,
       void *output_, const void *input_,
       int out_width, int out_height,
       int in_width, int in_height,
-      int out_stride, int in_stride)
+      int out_stride, int in_stride,
+      int first, int last)
 {
    int h, w;
    int x_pos             = (1 << 15) * in_width / out_width - (1 << 15);
@@ -250,11 +548,23 @@ void scaler_argb8888_point_special(const struct scaler_ctx *ctx,
    if (y_pos < 0)
       y_pos = 0;
 
-   for (h = 0; h < out_height; h++, y_pos += y_step, output += out_stride >> 2)
+   y_pos  += first * y_step;
+   output += first * (out_stride >> 2);
+
+   for (h = first; h < last; h++, y_pos += y_step, output += out_stride >> 2)
    {
       int               x = x_pos;
       const uint32_t *inp = input + (y_pos >> 16) * (in_stride >> 2);
 
+      /* When upscaling, rows that sample the same input row
+       * as the one above are copies of it */
+      if (h > first && (y_pos >> 16) == ((y_pos - y_step) >> 16))
+      {
+         memcpy(output, output - (out_stride >> 2),
+               out_width * sizeof(uint32_t));
+         continue;
+      }
+
       for (w = 0; w < out_width; w++, x += x_step)
          output[w] = inp[x >> 16];
    }
@@ -155,6 +155,9 @@ extern retro_resampler_t sinc_resampler;
 extern retro_resampler_t CC_resampler;
 #endif
 extern retro_resampler_t nearest_resampler;
+#ifdef HAVE_POLYPHASE_RESAMPLER
+extern retro_resampler_t polyphase_resampler;
+#endif
 
 /**
  * audio_resampler_driver_find_handle:
@@ -60,6 +60,9 @@ struct config_file
    struct config_entry_list *last;
    struct config_include_list *includes;
    struct path_linked_list *references;
+   /* Entries and their keys are allocated from
+    * these, and only released with the config file */
+   struct config_file_chunk *chunks;
    unsigned include_depth;
    bool guaranteed_no_duplicates;
    bool modified;
@@ -151,11 +154,18 @@ bool config_append_file(config_file_t *conf, const char *path);
 /* All extract functions return true when value is valid and exists.
  * Returns false otherwise. */
 
+/* 'key' belongs to the config file, and is shared by
+ * every entry with the same key. 'value' is allocated
+ * separately - callers may take it over, as long as
+ * they set it to NULL. */
 struct config_entry_list
 {
    char *key;
    char *value;
    struct config_entry_list *next;
+   /* Next entry in entries_map with the same hash */
+   struct config_entry_list *map_next;
+   uint32_t hash;
    /* If we got this from an #include,
     * do not allow overwrite. */
    bool readonly;
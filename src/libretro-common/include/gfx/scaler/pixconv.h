@@ -23,12 +23,42 @@
 #ifndef __LIBRETRO_SDK_SCALER_PIXCONV_H__
 #define __LIBRETRO_SDK_SCALER_PIXCONV_H__
 
+#include <stdint.h>
+
 #include <clamping.h>
 
 #include <retro_common_api.h>
 
 RETRO_BEGIN_DECLS
 
+/**
+ * pixconv_init_simd:
+ *
+ * Picks the fastest SIMD paths for the conv_* functions
+ * that this build and CPU support. Called on first use
+ * if the caller hasn't done so.
+ **/
+void pixconv_init_simd(void);
+
+/**
+ * pixconv_set_simd:
+ * @simd              : mask of RETRO_SIMD_* flags
+ *
+ * Restricts the conv_* functions, and the filter passes of the
+ * scaler, to the SIMD paths in @simd.
+ * Paths this build or CPU lacks are dropped; 0 means plain C.
+ *
+ * Returns: the mask now in use.
+ **/
+uint64_t pixconv_set_simd(uint64_t simd);
+
+/**
+ * pixconv_get_simd:
+ *
+ * Returns: the mask of RETRO_SIMD_* paths in use.
+ **/
+uint64_t pixconv_get_simd(void);
+
 void conv_0rgb1555_argb8888(void *output, const void *input,
       int width, int height,
       int out_stride, int in_stride);
@@ -54,19 +54,25 @@ enum scaler_type
 struct scaler_filter
 {
    int16_t *filter;
+   /* @filter with every coefficient repeated for the four
+    * channels, ready to load into SIMD registers */
+   int16_t *filter_bank;
    int     *filter_pos;
    int      filter_len;
    int      filter_stride;
 };
 
+struct scaler_pool;
+
 struct scaler_ctx
 {
+   /* These take a range of output rows [first, last) */
    void (*scaler_horiz)(const struct scaler_ctx*,
-         const void*, int);
+         const void*, int, int, int);
    void (*scaler_vert)(const struct scaler_ctx*,
-         void*, int);
+         void*, int, int, int);
    void (*scaler_special)(const struct scaler_ctx*,
-         void*, const void*, int, int, int, int, int, int);
+         void*, const void*, int, int, int, int, int, int, int, int);
 
    void (*in_pixconv)(void*, const void*, int, int, int, int);
    void (*out_pixconv)(void*, const void*, int, int, int, int);
@@ -105,11 +111,49 @@ struct scaler_ctx
    enum scaler_pix_fmt out_fmt;
    enum scaler_type scaler_type;
 
+   /* Threads to split the rows of the filter passes across,
+    * counting the calling thread. 0 or 1 scales on the
+    * calling thread. Set before scaler_ctx_gen_filter(). */
+   unsigned threads;
+   struct scaler_pool *pool;
+
+   /* What the filters were last generated for, so that
+    * scaler_ctx_gen_filter() can keep them */
+   struct
+   {
+      int in_width;
+      int in_height;
+      int out_width;
+      int out_height;
+      enum scaler_pix_fmt in_fmt;
+      enum scaler_pix_fmt out_fmt;
+      enum scaler_type scaler_type;
+      unsigned threads;
+      bool valid;
+   } gen;
+
    bool unscaled;
 };
 
+/**
+ * scaler_ctx_gen_filter:
+ * @ctx          : pointer to scaler context object.
+ *
+ * Sets up @ctx for its sizes, formats and scaler type.
+ * Calling it again with nothing changed keeps the filters
+ * and buffers already generated, so it is cheap to call
+ * every frame.
+ *
+ * Returns: true if @ctx can scale, otherwise false.
+ **/
 bool scaler_ctx_gen_filter(struct scaler_ctx *ctx);
 
+/**
+ * scaler_ctx_gen_reset:
+ * @ctx          : pointer to scaler context object.
+ *
+ * Frees everything scaler_ctx_gen_filter() allocated.
+ **/
 void scaler_ctx_gen_reset(struct scaler_ctx *ctx);
 
 /**
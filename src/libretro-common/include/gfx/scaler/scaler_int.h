@@ -30,16 +30,17 @@
 RETRO_BEGIN_DECLS
 
 void scaler_argb8888_vert(const struct scaler_ctx *ctx,
-      void *output, int stride);
+      void *output, int stride, int first, int last);
 
 void scaler_argb8888_horiz(const struct scaler_ctx *ctx,
-      const void *input, int stride);
+      const void *input, int stride, int first, int last);
 
 void scaler_argb8888_point_special(const struct scaler_ctx *ctx,
       void *output, const void *input,
       int out_width, int out_height,
       int in_width, int in_height,
-      int out_stride, int in_stride);
+      int out_stride, int in_stride,
+      int first, int last);
 
 RETRO_END_DECLS
 
@@ -0,0 +1,85 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (spsc_queue.h).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __LIBRETRO_SDK_SPSC_QUEUE_H
+#define __LIBRETRO_SDK_SPSC_QUEUE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <retro_common_api.h>
+#include <boolean.h>
+
+RETRO_BEGIN_DECLS
+
+/* Byte ring buffer for exactly one writer thread and one
+ * reader thread. Neither side ever takes a lock or waits;
+ * callers that want to block have to do so themselves,
+ * e.g. on a condition variable with a timeout. */
+typedef struct spsc_queue spsc_queue_t;
+
+/**
+ * spsc_queue_new:
+ * @size                : capacity in bytes
+ *
+ * Returns: new queue that can hold @size bytes,
+ * or NULL on allocation failure.
+ **/
+spsc_queue_t *spsc_queue_new(size_t size);
+
+void spsc_queue_free(spsc_queue_t *queue);
+
+/* Capacity given to spsc_queue_new(). */
+size_t spsc_queue_size(const spsc_queue_t *queue);
+
+/* Safe from either thread; the value may be stale by the
+ * time it is used, but only ever in the safe direction for
+ * the side that owns the queue end. */
+size_t spsc_queue_read_avail(const spsc_queue_t *queue);
+
+size_t spsc_queue_write_avail(const spsc_queue_t *queue);
+
+/**
+ * spsc_queue_write:
+ *
+ * Writer side. Copies as much of @buf as fits.
+ *
+ * Returns: number of bytes written.
+ **/
+size_t spsc_queue_write(spsc_queue_t *queue, const void *buf, size_t size);
+
+/**
+ * spsc_queue_read:
+ *
+ * Reader side. Copies up to @size bytes out of the queue.
+ *
+ * Returns: number of bytes read.
+ **/
+size_t spsc_queue_read(spsc_queue_t *queue, void *buf, size_t size);
+
+/* Empties the queue. Only safe while neither
+ * side is reading or writing. */
+void spsc_queue_clear(spsc_queue_t *queue);
+
+RETRO_END_DECLS
+
+#endif
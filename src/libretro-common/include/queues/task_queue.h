@@ -44,6 +44,24 @@ enum task_type
    TASK_TYPE_BLOCKING
 };
 
+/* Scheduling classes of the threaded task queue,
+ * highest priority first. Tasks of the same class
+ * never run concurrently with each other; tasks of
+ * different classes may run in parallel on separate
+ * workers. The regular (non-threaded) implementation
+ * ignores this. */
+enum task_priority
+{
+   /* user-facing work: downloads, content loading, etc. */
+   TASK_PRIORITY_INTERACTIVE = 0,
+   /* savestate and SRAM load/save */
+   TASK_PRIORITY_SAVESTATE,
+   /* long-running scans and playlist maintenance */
+   TASK_PRIORITY_BACKGROUND,
+
+   TASK_PRIORITY_LAST
+};
+
 typedef struct retro_task retro_task_t;
 typedef void (*retro_task_callback_t)(retro_task_t *task,
       void *task_data,
@@ -107,6 +125,11 @@ struct retro_task
    /* don't touch this. */
    retro_task_t *next;
 
+   /* don't touch these either, they belong to
+    * the threaded scheduler. */
+   retro_task_t *sched_next;
+   retro_time_t sched_time;
+
    /* -1 = unmetered/indeterminate, 0-100 = current progress percentage */
    int8_t progress;
 
@@ -115,6 +138,9 @@ struct retro_task
 
    enum task_type type;
 
+   /* scheduling class, TASK_PRIORITY_INTERACTIVE by default */
+   enum task_priority priority;
+
    /* if set to true, frontend will
    use an alternative look for the
    task progress display */
@@ -132,6 +158,24 @@ struct retro_task
    bool mute;
 };
 
+/* Scheduler statistics, see task_queue_get_stats().
+ * Times are in microseconds. */
+typedef struct task_queue_stats
+{
+   /* handler invocations per class */
+   uint64_t slices[TASK_PRIORITY_LAST];
+   /* time tasks spent ready to run before
+    * a worker picked them up */
+   retro_time_t wait_total[TASK_PRIORITY_LAST];
+   retro_time_t wait_max[TASK_PRIORITY_LAST];
+   /* tasks currently ready to run, and the peak */
+   unsigned depth[TASK_PRIORITY_LAST];
+   unsigned depth_max[TASK_PRIORITY_LAST];
+   /* tasks taken from another worker's queue */
+   uint64_t steals;
+   unsigned workers;
+} task_queue_stats_t;
+
 typedef struct task_finder_data
 {
    retro_task_finder_t func;
@@ -254,6 +298,11 @@ void task_queue_deinit(void);
  * This must only be called from the main thread. */
 void task_queue_init(bool threaded, retro_task_queue_msg_t msg_push);
 
+/* Copies the scheduler statistics into stats.
+ * Returns false if the threaded implementation
+ * is not the one currently running. */
+bool task_queue_get_stats(task_queue_stats_t *stats);
+
 /* Allocates and inits a new retro_task_t */
 retro_task_t *task_init(void);
 
@@ -32,6 +32,21 @@ RETRO_BEGIN_DECLS
 
 typedef struct chdstream chdstream_t;
 
+/* Hunk cache statistics of a stream */
+typedef struct chdstream_stats
+{
+   /* Hunks found in the cache */
+   uint64_t hits;
+   /* Hunks decoded on demand */
+   uint64_t misses;
+   /* Hits on hunks that were still being prefetched */
+   uint64_t waits;
+   /* Hunks decoded ahead by the prefetcher */
+   uint64_t prefetched;
+   /* Hits on prefetched hunks */
+   uint64_t prefetch_hits;
+} chdstream_stats_t;
+
 /* First data track */
 #define CHDSTREAM_TRACK_FIRST_DATA (-1)
 /* Last track */
@@ -63,6 +78,17 @@ uint32_t chdstream_get_frame_size(chdstream_t* stream);
 
 uint32_t chdstream_get_first_track_sector(chdstream_t* stream);
 
+void chdstream_get_stats(chdstream_t *stream, chdstream_stats_t *stats);
+
+/* Sets the number of decoded hunks each stream keeps
+ * in memory (at least 1), and how many hunks past
+ * a sequential read are decoded ahead on a worker
+ * thread (0 disables it, and it is always less than
+ * the cache size). Only applies to streams opened
+ * afterwards. Without HAVE_THREADS, nothing is
+ * decoded ahead. */
+void chdstream_set_cache_size(unsigned cache_hunks, unsigned prefetch_hunks);
+
 RETRO_END_DECLS
 
 #endif
@@ -108,6 +108,13 @@ uint32_t intfstream_get_frame_size(intfstream_internal_t *intf);
 
 uint32_t intfstream_get_first_sector(intfstream_internal_t* intf);
 
+struct chdstream_stats;
+
+/* Hunk cache statistics of a CHD stream.
+ * Returns false for other streams. */
+bool intfstream_get_chd_stats(intfstream_internal_t *intf,
+      struct chdstream_stats *stats);
+
 bool intfstream_is_compressed(intfstream_internal_t *intf);
 
 bool intfstream_get_crc(intfstream_internal_t *intf, uint32_t *crc);
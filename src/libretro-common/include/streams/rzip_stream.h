@@ -72,6 +72,18 @@ RETRO_BEGIN_DECLS
 /* Prevent direct access to rzipstream_t members */
 typedef struct rzipstream rzipstream_t;
 
+/* Threading */
+
+/* Sets the number of threads used to compress and
+ * decompress files of more than one chunk. Chunks
+ * are independent, so the file format is the same
+ * either way.
+ * > 0 (default): one per CPU core, up to 4
+ * > 1: no threads
+ * Only applies to streams opened afterwards, and
+ * has no effect without HAVE_THREADS */
+void rzipstream_set_num_threads(unsigned num_threads);
+
 /* File Open */
 
 /* Opens a new or existing RZIP file
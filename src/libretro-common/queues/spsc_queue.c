@@ -0,0 +1,203 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (spsc_queue.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <retro_common_api.h>
+#include <retro_inline.h>
+#include <boolean.h>
+
+#include <queues/spsc_queue.h>
+
+#if defined(_MSC_VER) && !defined(_XBOX)
+#include <windows.h>
+#endif
+
+/* The writer publishes 'head' with release semantics after
+ * copying the data in, the reader publishes 'tail' the same
+ * way after copying it out; each side loads the other index
+ * with acquire semantics. */
+#if defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7)))
+#define SPSC_LOAD_ACQUIRE(p)     __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define SPSC_STORE_RELEASE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#elif defined(__GNUC__)
+#define SPSC_LOAD_ACQUIRE(p)     spsc_load_acquire(p)
+#define SPSC_STORE_RELEASE(p, v) do { __sync_synchronize(); *(p) = (v); } while (0)
+static INLINE size_t spsc_load_acquire(volatile size_t *p)
+{
+   size_t v = *p;
+   __sync_synchronize();
+   return v;
+}
+#elif defined(_MSC_VER) && !defined(_XBOX)
+#define SPSC_LOAD_ACQUIRE(p)     spsc_load_acquire(p)
+#define SPSC_STORE_RELEASE(p, v) do { MemoryBarrier(); *(p) = (v); } while (0)
+static INLINE size_t spsc_load_acquire(volatile size_t *p)
+{
+   size_t v = *p;
+   MemoryBarrier();
+   return v;
+}
+#else
+/* Single-core targets; volatile is enough to keep
+ * the compiler from caching the indices. */
+#define SPSC_LOAD_ACQUIRE(p)     (*(p))
+#define SPSC_STORE_RELEASE(p, v) (*(p) = (v))
+#endif
+
+/* Keeps the two indices on separate cache lines
+ * so the threads do not keep stealing each other's. */
+#define SPSC_CACHE_LINE 64
+
+struct spsc_queue
+{
+   uint8_t *buffer;
+   size_t size;
+   uint8_t pad0[SPSC_CACHE_LINE];
+   /* Write index; owned by the writer. */
+   volatile size_t head;
+   uint8_t pad1[SPSC_CACHE_LINE];
+   /* Read index; owned by the reader. */
+   volatile size_t tail;
+   uint8_t pad2[SPSC_CACHE_LINE];
+};
+
+/* Both indices run over [0, 2 * size), so that a full
+ * queue (head - tail == size) can be told apart from an
+ * empty one without giving up a byte of capacity. */
+static INLINE size_t spsc_queue_used(const spsc_queue_t *queue,
+      size_t head, size_t tail)
+{
+   return (head >= tail) ? head - tail : head + 2 * queue->size - tail;
+}
+
+static INLINE size_t spsc_queue_advance(const spsc_queue_t *queue,
+      size_t idx, size_t len)
+{
+   idx += len;
+   if (idx >= 2 * queue->size)
+      idx -= 2 * queue->size;
+   return idx;
+}
+
+spsc_queue_t *spsc_queue_new(size_t size)
+{
+   spsc_queue_t *queue = NULL;
+
+   if (!size)
+      return NULL;
+
+   if (!(queue = (spsc_queue_t*)calloc(1, sizeof(*queue))))
+      return NULL;
+
+   if (!(queue->buffer = (uint8_t*)calloc(1, size)))
+   {
+      free(queue);
+      return NULL;
+   }
+
+   queue->size = size;
+   return queue;
+}
+
+void spsc_queue_free(spsc_queue_t *queue)
+{
+   if (!queue)
+      return;
+
+   free(queue->buffer);
+   free(queue);
+}
+
+size_t spsc_queue_size(const spsc_queue_t *queue)
+{
+   return queue->size;
+}
+
+size_t spsc_queue_read_avail(const spsc_queue_t *queue)
+{
+   spsc_queue_t *q = (spsc_queue_t*)queue;
+   size_t tail     = SPSC_LOAD_ACQUIRE(&q->tail);
+   return spsc_queue_used(q, SPSC_LOAD_ACQUIRE(&q->head), tail);
+}
+
+size_t spsc_queue_write_avail(const spsc_queue_t *queue)
+{
+   spsc_queue_t *q = (spsc_queue_t*)queue;
+   size_t head     = SPSC_LOAD_ACQUIRE(&q->head);
+   return q->size - spsc_queue_used(q, head, SPSC_LOAD_ACQUIRE(&q->tail));
+}
+
+size_t spsc_queue_write(spsc_queue_t *queue, const void *buf, size_t size)
+{
+   size_t pos, first;
+   size_t head  = queue->head;
+   size_t avail = queue->size - spsc_queue_used(queue, head,
+         SPSC_LOAD_ACQUIRE(&queue->tail));
+
+   if (size > avail)
+      size      = avail;
+   if (!size)
+      return 0;
+
+   pos          = (head >= queue->size) ? head - queue->size : head;
+   first        = queue->size - pos;
+   if (first > size)
+      first     = size;
+
+   memcpy(queue->buffer + pos, buf, first);
+   memcpy(queue->buffer, (const uint8_t*)buf + first, size - first);
+
+   SPSC_STORE_RELEASE(&queue->head, spsc_queue_advance(queue, head, size));
+   return size;
+}
+
+size_t spsc_queue_read(spsc_queue_t *queue, void *buf, size_t size)
+{
+   size_t pos, first;
+   size_t tail  = queue->tail;
+   size_t avail = spsc_queue_used(queue,
+         SPSC_LOAD_ACQUIRE(&queue->head), tail);
+
+   if (size > avail)
+      size      = avail;
+   if (!size)
+      return 0;
+
+   pos          = (tail >= queue->size) ? tail - queue->size : tail;
+   first        = queue->size - pos;
+   if (first > size)
+      first     = size;
+
+   memcpy(buf, queue->buffer + pos, first);
+   memcpy((uint8_t*)buf + first, queue->buffer, size - first);
+
+   SPSC_STORE_RELEASE(&queue->tail, spsc_queue_advance(queue, tail, size));
+   return size;
+}
+
+void spsc_queue_clear(spsc_queue_t *queue)
+{
+   queue->head = 0;
+   queue->tail = 0;
+}
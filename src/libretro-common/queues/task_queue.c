@@ -23,6 +23,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdarg.h>
+#include <string.h>
 
 #include <queues/task_queue.h>
 
@@ -66,10 +67,10 @@ static slock_t *running_lock                = NULL;
 static slock_t *finished_lock               = NULL;
 static slock_t *property_lock               = NULL;
 static slock_t *queue_lock                  = NULL;
+static slock_t *sched_lock                  = NULL;
 static scond_t *worker_cond                 = NULL;
-static sthread_t *worker_thread             = NULL;
 static bool worker_continue                 = true; 
-/* use running_lock when touching it */
+/* use sched_lock when touching it */
 #endif
 
 static void task_queue_msg_push(retro_task_t *task,
@@ -371,14 +372,216 @@ static void task_queue_remove(task_queue_t *queue, retro_task_t *task)
    }
 }
 
+/* The threaded implementation runs tasks on up to one
+ * worker per priority class. 'tasks_running' stays the
+ * registry used by find/retrieve/cancel; the scheduler
+ * keeps its own per-worker ready queues, linked through
+ * task->sched_next and guarded by 'sched_lock'.
+ *
+ * A worker takes the oldest ready task of the highest
+ * class that isn't already running somewhere, looking
+ * at every worker's queue so an idle worker steals from
+ * a busy one. A task that has been ready for longer than
+ * TASK_QUEUE_STARVATION_USEC is picked regardless of its
+ * class, so background work always makes progress. */
+#define TASK_QUEUE_MAX_WORKERS     TASK_PRIORITY_LAST
+#define TASK_QUEUE_STARVATION_USEC 100000
+/* allow half a millisecond for context switching */
+#define TASK_QUEUE_WAKEUP_SLACK    500
+
+typedef struct
+{
+   retro_task_t *front;
+   retro_task_t *back;
+   unsigned count;
+} task_sched_fifo_t;
+
+typedef struct
+{
+   task_sched_fifo_t queues[TASK_PRIORITY_LAST];
+   sthread_t *thread;
+} task_worker_t;
+
+/* TODO/FIXME - static globals */
+static task_worker_t task_workers[TASK_QUEUE_MAX_WORKERS];
+static unsigned task_worker_count                 = 0;
+static unsigned task_worker_next                  = 0;
+/* tasks whose 'when' lies in the future */
+static task_sched_fifo_t tasks_delayed            = {NULL, NULL, 0};
+static bool task_class_busy[TASK_PRIORITY_LAST];
+static task_queue_stats_t task_stats;
+
+static void task_sched_fifo_push(task_sched_fifo_t *fifo, retro_task_t *task)
+{
+   task->sched_next  = NULL;
+   if (fifo->back)
+      fifo->back->sched_next = task;
+   else
+      fifo->front    = task;
+   fifo->back        = task;
+   fifo->count++;
+}
+
+static retro_task_t *task_sched_fifo_pop(task_sched_fifo_t *fifo)
+{
+   retro_task_t *task = fifo->front;
+
+   if (task)
+   {
+      fifo->front      = task->sched_next;
+      if (!fifo->front)
+         fifo->back    = NULL;
+      task->sched_next = NULL;
+      fifo->count--;
+   }
+
+   return task;
+}
+
+/* 'sched_lock' must be held for the duration of this function */
+static void task_sched_enqueue(task_worker_t *worker,
+      retro_task_t *task, retro_time_t now)
+{
+   unsigned prio;
+
+   if ((unsigned)task->priority >= TASK_PRIORITY_LAST)
+      task->priority = TASK_PRIORITY_BACKGROUND;
+
+   if (task->when && task->when - TASK_QUEUE_WAKEUP_SLACK > now)
+   {
+      task_sched_fifo_push(&tasks_delayed, task);
+      return;
+   }
+
+   prio             = task->priority;
+   task->sched_time = now;
+   task_sched_fifo_push(&worker->queues[prio], task);
+
+   if (++task_stats.depth[prio] > task_stats.depth_max[prio])
+      task_stats.depth_max[prio] = task_stats.depth[prio];
+}
+
+/* Moves the delayed tasks that are due onto the queues
+ * of 'worker'. Returns how long until the next delayed
+ * task is due, or 0 if there is none.
+ *
+ * 'sched_lock' must be held for the duration of this function */
+static retro_time_t task_sched_release_delayed(
+      task_worker_t *worker, retro_time_t now)
+{
+   retro_time_t next     = 0;
+   retro_task_t *task    = NULL;
+   unsigned count        = tasks_delayed.count;
+
+   while (count-- && (task = task_sched_fifo_pop(&tasks_delayed)))
+   {
+      retro_time_t delay = task->when - TASK_QUEUE_WAKEUP_SLACK - now;
+
+      task_sched_enqueue(worker, task, now);
+
+      if (delay > 0 && (!next || delay < next))
+         next = delay;
+   }
+
+   return next;
+}
+
+/* Returns the queue holding the oldest ready task of
+ * class 'prio', or NULL if there is none. Queues of
+ * 'self' win ties so a worker keeps its own tasks.
+ *
+ * 'sched_lock' must be held for the duration of this function */
+static task_sched_fifo_t *task_sched_oldest(
+      task_worker_t *self, unsigned prio)
+{
+   unsigned i;
+   task_sched_fifo_t *best = self->queues[prio].front
+      ? &self->queues[prio] : NULL;
+
+   for (i = 0; i < task_worker_count; i++)
+   {
+      task_sched_fifo_t *fifo = &task_workers[i].queues[prio];
+
+      if (!fifo->front)
+         continue;
+      if (!best || fifo->front->sched_time < best->front->sched_time)
+         best = fifo;
+   }
+
+   return best;
+}
+
+/* 'sched_lock' must be held for the duration of this function */
+static retro_task_t *task_sched_pick(task_worker_t *self, retro_time_t now)
+{
+   unsigned prio;
+   retro_time_t wait;
+   retro_task_t *task            = NULL;
+   task_sched_fifo_t *fifo       = NULL;
+   task_sched_fifo_t *starving   = NULL;
+
+   /* Anything that has waited too long goes first,
+    * oldest of them across all classes */
+   for (prio = 0; prio < TASK_PRIORITY_LAST; prio++)
+   {
+      task_sched_fifo_t *cand = NULL;
+
+      if (task_class_busy[prio])
+         continue;
+      if (!(cand = task_sched_oldest(self, prio)))
+         continue;
+      if (now - cand->front->sched_time < TASK_QUEUE_STARVATION_USEC)
+         continue;
+      if (!starving || cand->front->sched_time < starving->front->sched_time)
+         starving = cand;
+   }
+
+   if (!(fifo = starving))
+   {
+      for (prio = 0; prio < TASK_PRIORITY_LAST; prio++)
+      {
+         if (task_class_busy[prio])
+            continue;
+         if ((fifo = task_sched_oldest(self, prio)))
+            break;
+      }
+   }
+
+   if (!fifo)
+      return NULL;
+
+   if (fifo < &self->queues[0] || fifo >= &self->queues[TASK_PRIORITY_LAST])
+      task_stats.steals++;
+
+   task  = task_sched_fifo_pop(fifo);
+   prio  = task->priority;
+   wait  = now - task->sched_time;
+
+   task_stats.depth[prio]--;
+   task_stats.slices[prio]++;
+   task_stats.wait_total[prio] += wait;
+   if (wait > task_stats.wait_max[prio])
+      task_stats.wait_max[prio] = wait;
+
+   return task;
+}
+
 static void retro_task_threaded_push_running(retro_task_t *task)
 {
+   task_worker_t *worker = NULL;
+
    slock_lock(running_lock);
    slock_lock(queue_lock);
    task_queue_put(&tasks_running, task);
-   scond_signal(worker_cond);
    slock_unlock(queue_lock);
    slock_unlock(running_lock);
+
+   slock_lock(sched_lock);
+   worker = &task_workers[task_worker_count
+      ? task_worker_next++ % task_worker_count : 0];
+   task_sched_enqueue(worker, task, cpu_features_get_time_usec());
+   scond_signal(worker_cond);
+   slock_unlock(sched_lock);
 }
 
 static void retro_task_threaded_cancel(void *task)
@@ -478,39 +681,32 @@ static void retro_task_threaded_retrieve(task_retriever_data_t *data)
 
 static void threaded_worker(void *userdata)
 {
-   (void)userdata;
+   task_worker_t *self = (task_worker_t*)userdata;
+
+   slock_lock(sched_lock);
 
-   for (;;)
+   while (worker_continue) /* should we keep running until all tasks finished? */
    {
+      unsigned prio;
+      retro_time_t delay;
       retro_task_t *task  = NULL;
       bool       finished = false;
+      retro_time_t now    = cpu_features_get_time_usec();
 
-      if (!worker_continue)
-         break; /* should we keep running until all tasks finished? */
-
-      slock_lock(running_lock);
-
-      /* Get first task to run */
-      if (!(task = tasks_running.front))
-      {
-         scond_wait(worker_cond, running_lock);
-         slock_unlock(running_lock);
-         continue;
-      }
+      delay = task_sched_release_delayed(self, now);
 
-      if (task->when)
+      if (!(task = task_sched_pick(self, now)))
       {
-         retro_time_t now   = cpu_features_get_time_usec();
-         retro_time_t delay = task->when - now - 500; /* allow half a millisecond for context switching */
          if (delay > 0)
-         {
-            scond_wait_timeout(worker_cond, running_lock, delay);
-            slock_unlock(running_lock);
-            continue;
-         }
+            scond_wait_timeout(worker_cond, sched_lock, delay);
+         else
+            scond_wait(worker_cond, sched_lock);
+         continue;
       }
 
-      slock_unlock(running_lock);
+      prio                  = task->priority;
+      task_class_busy[prio] = true;
+      slock_unlock(sched_lock);
 
       task->handler(task);
 
@@ -518,78 +714,120 @@ static void threaded_worker(void *userdata)
       finished = task->finished;
       slock_unlock(property_lock);
 
-      /* Update queue */
+      /* Update the registry; an unfinished task is put back
+       * since its 'when' may have changed */
+      slock_lock(running_lock);
+      slock_lock(queue_lock);
+      task_queue_remove(&tasks_running, task);
       if (!finished)
+         task_queue_put(&tasks_running, task);
+      slock_unlock(queue_lock);
+      slock_unlock(running_lock);
+
+      slock_lock(sched_lock);
+      task_class_busy[prio] = false;
+      if (!finished)
+         task_sched_enqueue(self, task, cpu_features_get_time_usec());
+      /* other workers may have been waiting on this class */
+      scond_broadcast(worker_cond);
+
+      if (finished)
       {
-         /* Move the task to the back of the queue */
-         /* mimics retro_task_threaded_push_running, 
-          * but also includes a task_queue_remove */
-         slock_lock(running_lock);
-         slock_lock(queue_lock);
-
-         /* do nothing if only item in queue */
-         if (task->next) 
-         {
-            task_queue_remove(&tasks_running, task);
-            task_queue_put(&tasks_running, task);
-            scond_signal(worker_cond);
-         }
-         slock_unlock(queue_lock);
-         slock_unlock(running_lock);
-      }
-      else
-      {
-         /* Remove task from running queue */
-         slock_lock(running_lock);
-         slock_lock(queue_lock);
-         task_queue_remove(&tasks_running, task);
-         slock_unlock(queue_lock);
-         slock_unlock(running_lock);
+         slock_unlock(sched_lock);
 
          /* Add task to finished queue */
          slock_lock(finished_lock);
          task_queue_put(&tasks_finished, task);
          slock_unlock(finished_lock);
+
+         slock_lock(sched_lock);
       }
    }
+
+   slock_unlock(sched_lock);
 }
 
 static void retro_task_threaded_init(void)
 {
+   unsigned i;
+   int cores;
+   retro_task_t *task = NULL;
+   retro_time_t now   = cpu_features_get_time_usec();
+
    running_lock    = slock_new();
    finished_lock   = slock_new();
    property_lock   = slock_new();
    queue_lock      = slock_new();
+   sched_lock      = slock_new();
    worker_cond     = scond_new();
 
-   slock_lock(running_lock);
-   worker_continue = true;
-   slock_unlock(running_lock);
+   cores           = cpu_features_get_core_amount();
+   if (cores < 1)
+      cores        = 1;
+   else if (cores > TASK_QUEUE_MAX_WORKERS)
+      cores        = TASK_QUEUE_MAX_WORKERS;
+
+   slock_lock(sched_lock);
+   worker_continue   = true;
+   task_worker_count = 0;
+   task_worker_next  = 0;
+   memset(task_workers,    0, sizeof(task_workers));
+   memset(&tasks_delayed,  0, sizeof(tasks_delayed));
+   memset(task_class_busy, 0, sizeof(task_class_busy));
+   memset(&task_stats,     0, sizeof(task_stats));
+
+   for (i = 0; i < (unsigned)cores; i++)
+   {
+      task_worker_t *worker = &task_workers[task_worker_count];
+      if (!(worker->thread = sthread_create(threaded_worker, worker)))
+         break;
+      task_worker_count++;
+   }
 
-   worker_thread   = sthread_create(threaded_worker, NULL);
+   /* The workers can't run before we release the lock,
+    * so it's fine to hand them the tasks left over from
+    * a previous implementation now */
+   if (task_worker_count)
+   {
+      slock_lock(running_lock);
+      for (task = tasks_running.front; task; task = task->next)
+         task_sched_enqueue(&task_workers[0], task, now);
+      slock_unlock(running_lock);
+   }
+
+   task_stats.workers = task_worker_count;
+   slock_unlock(sched_lock);
 }
 
 static void retro_task_threaded_deinit(void)
 {
-   slock_lock(running_lock);
+   unsigned i;
+
+   slock_lock(sched_lock);
    worker_continue = false;
-   scond_signal(worker_cond);
-   slock_unlock(running_lock);
+   scond_broadcast(worker_cond);
+   slock_unlock(sched_lock);
 
-   sthread_join(worker_thread);
+   for (i = 0; i < task_worker_count; i++)
+   {
+      sthread_join(task_workers[i].thread);
+      task_workers[i].thread = NULL;
+   }
+   task_worker_count = 0;
 
    scond_free(worker_cond);
    slock_free(running_lock);
    slock_free(finished_lock);
    slock_free(property_lock);
    slock_free(queue_lock);
+   slock_free(sched_lock);
 
-   worker_thread   = NULL;
    worker_cond     = NULL;
    running_lock    = NULL;
    finished_lock   = NULL;
    property_lock   = NULL;
    queue_lock      = NULL;
+   sched_lock      = NULL;
 }
 
 static struct retro_task_impl impl_threaded = {
@@ -650,6 +888,20 @@ bool task_queue_is_threaded(void)
    return task_threaded_enable;
 }
 
+bool task_queue_get_stats(task_queue_stats_t *stats)
+{
+#ifdef HAVE_THREADS
+   if (impl_current == &impl_threaded)
+   {
+      slock_lock(sched_lock);
+      memcpy(stats, &task_stats, sizeof(*stats));
+      slock_unlock(sched_lock);
+      return true;
+   }
+#endif
+   return false;
+}
+
 bool task_queue_find(task_finder_data_t *find_data)
 {
    return impl_current->find(find_data->func, find_data->userdata);
@@ -991,6 +1243,9 @@ retro_task_t *task_init(void)
    task->frontend_userdata = NULL;
    task->alternative_look  = false;
    task->next              = NULL;
+   task->sched_next        = NULL;
+   task->sched_time        = 0;
+   task->priority          = TASK_PRIORITY_INTERACTIVE;
    task->when              = 0;
 
    return task;
@@ -59,6 +59,108 @@ static void test_config_file_parse_contains(
    free(out);
 }
 
+static void test_config_file_entries(void)
+{
+   unsigned i;
+   char key[64];
+   char val[64];
+   char *cfgtext      = strdup(
+         "foo = \"first\"\n"
+         "bar = \"1\"\n"
+         "# comment line\n"
+         "foo = \"second\"\n");
+   config_file_t *cfg = config_file_new_from_string(cfgtext, NULL);
+   struct config_entry_list *a = NULL;
+   struct config_entry_list *b = NULL;
+
+   free(cfgtext);
+
+   if (!cfg)
+      abort();
+
+   /* The first of duplicate keys wins, and all
+    * of them share one key string */
+   a = config_get_entry(cfg, "foo");
+   if (!a || strcmp(a->value, "first") != 0)
+      abort();
+   for (b = a->next; b; b = b->next)
+      if (b->key && !strcmp(b->key, "foo") && b->key != a->key)
+         abort();
+
+   config_set_string(cfg, "foo", "third");
+   if (config_get_entry(cfg, "foo") != a || strcmp(a->value, "third") != 0)
+      abort();
+
+   config_unset(cfg, "bar");
+   if (config_get_entry(cfg, "bar"))
+      abort();
+   config_set_string(cfg, "bar", "2");
+   if (!(b = config_get_entry(cfg, "bar")) || strcmp(b->value, "2") != 0)
+      abort();
+
+   /* Enough keys to grow the map a few times */
+   for (i = 0; i < 5000; i++)
+   {
+      snprintf(key, sizeof(key), "key_%u", i);
+      snprintf(val, sizeof(val), "%u", i * 3);
+      config_set_string(cfg, key, val);
+   }
+   for (i = 0; i < 5000; i += 2)
+   {
+      snprintf(key, sizeof(key), "key_%u", i);
+      config_unset(cfg, key);
+   }
+   for (i = 0; i < 5000; i++)
+   {
+      unsigned out = 0;
+      snprintf(key, sizeof(key), "key_%u", i);
+      if (config_get_uint(cfg, key, &out) != (bool)(i & 1))
+         abort();
+      if ((i & 1) && out != i * 3)
+         abort();
+   }
+
+   config_file_free(cfg);
+   printf("[SUCCESS] Duplicate, set, unset and bulk entries\n");
+}
+
+static void test_config_file_append(void)
+{
+   const char *path   = "config_file_test_append.cfg";
+   char *cfgtext      = strdup(
+         "foo = \"base\"\n"
+         "bar = \"base\"\n");
+   config_file_t *cfg = config_file_new_from_string(cfgtext, NULL);
+   FILE *file         = fopen(path, "wb");
+   char *out          = NULL;
+
+   free(cfgtext);
+
+   if (!cfg || !file)
+      abort();
+
+   fputs("bar = \"override\"\nbaz = \"new\"\n", file);
+   fclose(file);
+
+   if (!config_append_file(cfg, path))
+      abort();
+   remove(path);
+
+   /* Appended keys take priority */
+   if (!config_get_string(cfg, "foo", &out) || strcmp(out, "base") != 0)
+      abort();
+   free(out);
+   if (!config_get_string(cfg, "bar", &out) || strcmp(out, "override") != 0)
+      abort();
+   free(out);
+   if (!config_get_string(cfg, "baz", &out) || strcmp(out, "new") != 0)
+      abort();
+   free(out);
+
+   config_file_free(cfg);
+   printf("[SUCCESS] Appended file overrides base\n");
+}
+
 int main(void)
 {
    test_config_file_parse_contains("foo = \"bar\"\n",   "foo", "bar");
@@ -75,4 +177,7 @@ int main(void)
    test_config_file_parse_contains("foo = \"\"",     "bar", NULL);
    test_config_file_parse_contains("foo = \"\"\r\n", "bar", NULL);
    test_config_file_parse_contains("foo = \"\"",     "bar", NULL);
+
+   test_config_file_entries();
+   test_config_file_append();
 }
@@ -31,23 +31,85 @@
 #include <libchdr/chd.h>
 #include <string/stdstring.h>
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
 #define SECTOR_SIZE 2352
 #define SUBCODE_SIZE 96
 #define TRACK_PAD 4
 
+/* Decoded hunks are kept in a small LRU cache. Once
+ * reads become sequential, a worker thread decodes
+ * the next few hunks ahead of them. */
+#define CHDSTREAM_DEFAULT_CACHE_HUNKS 16
+#define CHDSTREAM_DEFAULT_PREFETCH_HUNKS 4
+
+/* Set by chdstream_set_cache_size() */
+static unsigned chdstream_cache_hunks    = CHDSTREAM_DEFAULT_CACHE_HUNKS;
+static unsigned chdstream_prefetch_hunks = CHDSTREAM_DEFAULT_PREFETCH_HUNKS;
+
+enum chdstream_hunk_state
+{
+   CHDSTREAM_HUNK_EMPTY = 0,
+   CHDSTREAM_HUNK_LOADING,
+   CHDSTREAM_HUNK_READY
+};
+
+struct chdstream_hunk
+{
+   uint8_t *data;
+   /* Value of the stream use counter when last
+    * used, the lowest one is evicted first */
+   uint32_t last_used;
+   uint32_t hunknum;
+   /* enum chdstream_hunk_state */
+   uint8_t state;
+   /* Decoded ahead, not read yet */
+   bool prefetched;
+};
+
 struct chdstream
 {
    chd_file *chd;
-   /* Loaded hunk */
-   uint8_t *hunkmem;
+   /* Cached hunks */
+   struct chdstream_hunk *hunks;
+   /* Hunk being read from, never evicted by
+    * the prefetcher */
+   struct chdstream_hunk *current;
+#ifdef HAVE_THREADS
+   sthread_t *thread;
+   /* Protects the cache, the prefetch window
+    * and the statistics */
+   slock_t *lock;
+   /* Serialises every libchdr call once the prefetcher
+    * may be running, libchdr isn't thread safe */
+   slock_t *chd_lock;
+   scond_t *cond;
+   /* Hunks the prefetcher still has to decode */
+   uint32_t prefetch_next;
+   uint32_t prefetch_end;
+   /* Number of hunks in the chd */
+   uint32_t total_hunks;
+   /* Last hunk read, to detect sequential reads */
+   uint32_t last_hunk;
+   bool quit;
+#endif
+   chdstream_stats_t stats;
    /* Byte offset where track data starts (after pregap) */
    size_t track_start;
    /* Byte offset where track data ends */
    size_t track_end;
    /* Byte offset of read cursor */
    size_t offset;
-   /* Loaded hunk number */
-   int32_t hunknum;
+   /* Copied from the chd header */
+   uint32_t hunk_bytes;
+   uint32_t unit_bytes;
+   /* Number of cached hunks, and of hunks to prefetch */
+   uint32_t num_hunks;
+   uint32_t num_prefetch;
+   /* Incremented on every hunk access */
+   uint32_t use_count;
    /* Size of frame taken from each hunk */
    uint32_t frame_size;
    /* Offset of data within frame */
@@ -131,6 +193,24 @@ chdstream_get_meta(chd_file *chd, int idx, metadata_t *md)
    return false;
 }
 
+/* chdstream_get_meta() for an open stream, whose
+ * prefetcher may be decoding at the same time */
+static bool
+chdstream_get_stream_meta(chdstream_t *stream, int idx, metadata_t *md)
+{
+   bool ret;
+
+#ifdef HAVE_THREADS
+   slock_lock(stream->chd_lock);
+#endif
+   ret = chdstream_get_meta(stream->chd, idx, md);
+#ifdef HAVE_THREADS
+   slock_unlock(stream->chd_lock);
+#endif
+
+   return ret;
+}
+
 static bool
 chdstream_find_track_number(chd_file *fd, int32_t track, metadata_t *meta)
 {
@@ -206,8 +286,8 @@ chdstream_find_track(chd_file *fd, int32_t track, metadata_t *meta)
 chdstream_t *chdstream_open(const char *path, int32_t track)
 {
    metadata_t meta;
+   uint32_t i;
    uint32_t pregap         = 0;
-   uint8_t *hunkmem        = NULL;
    const chd_header *hd    = NULL;
    chdstream_t *stream     = NULL;
    chd_file *chd           = NULL;
@@ -232,15 +312,54 @@ chdstream_t *chdstream_open(const char *path, int32_t track)
    stream->track_start     = 0;
    stream->track_end       = 0;
    stream->offset          = 0;
-   stream->hunkmem         = NULL;
-   stream->hunknum         = -1;
+   stream->hunks           = NULL;
+   stream->current         = NULL;
+   stream->num_hunks       = chdstream_cache_hunks;
+   stream->num_prefetch    = chdstream_prefetch_hunks;
+   stream->use_count       = 0;
+   stream->hunk_bytes      = 0;
+   stream->unit_bytes      = 0;
+   memset(&stream->stats, 0, sizeof(stream->stats));
+#ifdef HAVE_THREADS
+   stream->thread          = NULL;
+   stream->lock            = NULL;
+   stream->chd_lock        = NULL;
+   stream->cond            = NULL;
+   stream->prefetch_next   = 0;
+   stream->prefetch_end    = 0;
+   stream->total_hunks     = 0;
+   stream->last_hunk       = 0;
+   stream->quit            = false;
+#else
+   stream->num_prefetch    = 0;
+#endif
 
    hd                      = chd_get_header(chd);
-   hunkmem                 = (uint8_t*)malloc(hd->hunkbytes);
-   if (!hunkmem)
+#ifdef HAVE_THREADS
+   stream->total_hunks     = hd->totalhunks;
+#endif
+
+   /* The prefetcher needs a hunk other than
+    * the current one to decode into */
+   if (stream->num_hunks < 1)
+      stream->num_hunks    = 1;
+   if (stream->num_prefetch > stream->num_hunks - 1)
+      stream->num_prefetch = stream->num_hunks - 1;
+
+   if (!(stream->hunks = (struct chdstream_hunk*)calloc(
+         stream->num_hunks, sizeof(*stream->hunks))))
       goto error;
 
-   stream->hunkmem         = hunkmem;
+   for (i = 0; i < stream->num_hunks; i++)
+      if (!(stream->hunks[i].data = (uint8_t*)malloc(hd->hunkbytes)))
+         goto error;
+
+#ifdef HAVE_THREADS
+   if (     !(stream->lock     = slock_new())
+         || !(stream->chd_lock = slock_new())
+         || !(stream->cond     = scond_new()))
+      goto error;
+#endif
 
    if (string_is_equal(meta.type, "MODE1_RAW"))
       stream->frame_size   = SECTOR_SIZE;
@@ -259,6 +378,8 @@ chdstream_t *chdstream_open(const char *path, int32_t track)
       pregap               = meta.pregap;
 
    stream->chd             = chd;
+   stream->hunk_bytes      = hd->hunkbytes;
+   stream->unit_bytes      = hd->unitbytes;
    stream->frames_per_hunk = hd->hunkbytes / hd->unitbytes;
    stream->track_frame     = meta.frame_offset;
    stream->track_start     = (size_t)pregap * stream->frame_size;
@@ -279,37 +400,271 @@ error:
 
 void chdstream_close(chdstream_t *stream)
 {
+   uint32_t i;
+
    if (!stream)
       return;
 
-   if (stream->hunkmem)
-      free(stream->hunkmem);
+#ifdef HAVE_THREADS
+   if (stream->thread)
+   {
+      slock_lock(stream->lock);
+      stream->quit = true;
+      scond_broadcast(stream->cond);
+      slock_unlock(stream->lock);
+      sthread_join(stream->thread);
+   }
+   if (stream->cond)
+      scond_free(stream->cond);
+   if (stream->chd_lock)
+      slock_free(stream->chd_lock);
+   if (stream->lock)
+      slock_free(stream->lock);
+#endif
+
+   if (stream->hunks)
+   {
+      for (i = 0; i < stream->num_hunks; i++)
+         if (stream->hunks[i].data)
+            free(stream->hunks[i].data);
+      free(stream->hunks);
+   }
    if (stream->chd)
       chd_close(stream->chd);
    free(stream);
 }
 
+static struct chdstream_hunk *
+chdstream_find_hunk(chdstream_t *stream, uint32_t hunknum)
+{
+   uint32_t i;
+
+   for (i = 0; i < stream->num_hunks; i++)
+   {
+      struct chdstream_hunk *hunk = &stream->hunks[i];
+      if (     hunk->state != CHDSTREAM_HUNK_EMPTY
+            && hunk->hunknum == hunknum)
+         return hunk;
+   }
+
+   return NULL;
+}
+
+/* Picks the least recently used hunk that isn't
+ * being decoded, and isn't 'keep' */
+static struct chdstream_hunk *
+chdstream_evict_hunk(chdstream_t *stream, const struct chdstream_hunk *keep)
+{
+   uint32_t i;
+   struct chdstream_hunk *victim = NULL;
+
+   for (i = 0; i < stream->num_hunks; i++)
+   {
+      struct chdstream_hunk *hunk = &stream->hunks[i];
+
+      if (hunk == keep || hunk->state == CHDSTREAM_HUNK_LOADING)
+         continue;
+      if (hunk->state == CHDSTREAM_HUNK_EMPTY)
+         return hunk;
+      if (!victim || hunk->last_used < victim->last_used)
+         victim = hunk;
+   }
+
+   return victim;
+}
+
+/* Decodes a hunk. Called without the
+ * stream lock held */
 static bool
-chdstream_load_hunk(chdstream_t *stream, uint32_t hunknum)
+chdstream_decode_hunk(chdstream_t *stream, uint32_t hunknum, uint8_t *data)
 {
-   uint16_t *array;
+   chd_error err;
 
-   if (hunknum == stream->hunknum)
-      return true;
+#ifdef HAVE_THREADS
+   slock_lock(stream->chd_lock);
+#endif
+   err = chd_read(stream->chd, hunknum, data);
+#ifdef HAVE_THREADS
+   slock_unlock(stream->chd_lock);
+#endif
 
-   if (chd_read(stream->chd, hunknum, stream->hunkmem) != CHDERR_NONE)
+   if (err != CHDERR_NONE)
       return false;
 
    if (stream->swab)
    {
       uint32_t i;
-      uint32_t count = chd_get_header(stream->chd)->hunkbytes / 2;
-      array          = (uint16_t*)stream->hunkmem;
+      uint32_t count  = stream->hunk_bytes / 2;
+      uint16_t *array = (uint16_t*)data;
       for (i = 0; i < count; ++i)
          array[i] = SWAP16(array[i]);
    }
 
-   stream->hunknum = hunknum;
+   return true;
+}
+
+#ifdef HAVE_THREADS
+static void chdstream_prefetch_thread(void *data)
+{
+   chdstream_t *stream = (chdstream_t*)data;
+
+   slock_lock(stream->lock);
+
+   for (;;)
+   {
+      bool ok;
+      uint32_t hunknum;
+      struct chdstream_hunk *hunk = NULL;
+
+      while (!stream->quit && stream->prefetch_next >= stream->prefetch_end)
+         scond_wait(stream->cond, stream->lock);
+
+      if (stream->quit)
+         break;
+
+      hunknum = stream->prefetch_next++;
+
+      if (chdstream_find_hunk(stream, hunknum))
+         continue;
+
+      if (!(hunk = chdstream_evict_hunk(stream, stream->current)))
+         continue;
+
+      hunk->hunknum    = hunknum;
+      hunk->state      = CHDSTREAM_HUNK_LOADING;
+      hunk->prefetched = true;
+      slock_unlock(stream->lock);
+
+      ok = chdstream_decode_hunk(stream, hunknum, hunk->data);
+
+      slock_lock(stream->lock);
+      hunk->state      = ok ? CHDSTREAM_HUNK_READY : CHDSTREAM_HUNK_EMPTY;
+      hunk->last_used  = ++stream->use_count;
+      if (ok)
+         stream->stats.prefetched++;
+      scond_broadcast(stream->cond);
+   }
+
+   slock_unlock(stream->lock);
+}
+
+/* Queues the hunks after 'hunknum' for decoding,
+ * starting the prefetcher if required. Called with
+ * the stream lock held */
+static void chdstream_prefetch(chdstream_t *stream, uint32_t hunknum)
+{
+   uint32_t end = hunknum + 1 + stream->num_prefetch;
+
+   if (end > stream->total_hunks)
+      end = stream->total_hunks;
+   if (hunknum + 1 >= end)
+      return;
+
+   if (!stream->thread)
+   {
+      if (!(stream->thread = sthread_create(
+            chdstream_prefetch_thread, stream)))
+      {
+         /* Carry on without */
+         stream->num_prefetch = 0;
+         return;
+      }
+   }
+
+   stream->prefetch_next = hunknum + 1;
+   stream->prefetch_end  = end;
+   scond_signal(stream->cond);
+}
+#endif
+
+static bool
+chdstream_load_hunk(chdstream_t *stream, uint32_t hunknum)
+{
+   struct chdstream_hunk *hunk = NULL;
+#ifdef HAVE_THREADS
+   bool sequential             = false;
+#endif
+
+   if (stream->current && stream->current->hunknum == hunknum)
+      return true;
+
+#ifdef HAVE_THREADS
+   slock_lock(stream->lock);
+   sequential        = (hunknum == stream->last_hunk + 1);
+   stream->last_hunk = hunknum;
+#endif
+
+   if ((hunk = chdstream_find_hunk(stream, hunknum)))
+   {
+#ifdef HAVE_THREADS
+      /* Being prefetched, wait for it */
+      if (hunk->state == CHDSTREAM_HUNK_LOADING)
+      {
+         stream->stats.waits++;
+         while (     hunk->state   == CHDSTREAM_HUNK_LOADING
+                  && hunk->hunknum == hunknum)
+            scond_wait(stream->cond, stream->lock);
+      }
+#endif
+      if (     hunk->state   != CHDSTREAM_HUNK_READY
+            || hunk->hunknum != hunknum)
+         hunk = NULL;
+   }
+
+   if (hunk)
+   {
+      stream->stats.hits++;
+      if (hunk->prefetched)
+         stream->stats.prefetch_hits++;
+   }
+   else
+   {
+      bool ok;
+
+      stream->stats.misses++;
+
+      /* The current hunk is about to be replaced anyway */
+      if (!(hunk = chdstream_evict_hunk(stream, NULL)))
+      {
+#ifdef HAVE_THREADS
+         slock_unlock(stream->lock);
+#endif
+         return false;
+      }
+
+      hunk->hunknum    = hunknum;
+      hunk->state      = CHDSTREAM_HUNK_LOADING;
+      if (stream->current == hunk)
+         stream->current = NULL;
+#ifdef HAVE_THREADS
+      slock_unlock(stream->lock);
+#endif
+
+      ok = chdstream_decode_hunk(stream, hunknum, hunk->data);
+
+#ifdef HAVE_THREADS
+      slock_lock(stream->lock);
+#endif
+      hunk->state      = ok ? CHDSTREAM_HUNK_READY : CHDSTREAM_HUNK_EMPTY;
+      if (!ok)
+      {
+#ifdef HAVE_THREADS
+         slock_unlock(stream->lock);
+#endif
+         return false;
+      }
+   }
+
+   hunk->prefetched  = false;
+   hunk->last_used   = ++stream->use_count;
+   stream->current   = hunk;
+
+#ifdef HAVE_THREADS
+   if (sequential && stream->num_prefetch)
+      chdstream_prefetch(stream, hunknum);
+   slock_unlock(stream->lock);
+#endif
+
    return true;
 }
 
@@ -317,7 +672,6 @@ ssize_t chdstream_read(chdstream_t *stream, void *data, size_t bytes)
 {
    size_t end;
    size_t data_offset   = 0;
-   const chd_header *hd = chd_get_header(stream->chd);
    uint8_t         *out = (uint8_t*)data;
 
    if (stream->track_end - stream->offset < bytes)
@@ -342,13 +696,13 @@ ssize_t chdstream_read(chdstream_t *stream, void *data, size_t bytes)
             (stream->offset - stream->track_start) / stream->frame_size);
          uint32_t hunk        = chd_frame / stream->frames_per_hunk;
          uint32_t hunk_offset = (chd_frame % stream->frames_per_hunk) 
-            * hd->unitbytes;
+            * stream->unit_bytes;
 
          if (!chdstream_load_hunk(stream, hunk))
             return -1;
 
          memcpy(out + data_offset,
-                stream->hunkmem + frame_offset
+                stream->current->data + frame_offset
                 + hunk_offset + stream->frame_offset, amount);
       }
 
@@ -434,7 +788,7 @@ uint32_t chdstream_get_track_start(chdstream_t *stream)
    metadata_t meta;
    uint32_t frame_offset = 0;
 
-   for (i = 0; chdstream_get_meta(stream->chd, i, &meta); ++i)
+   for (i = 0; chdstream_get_stream_meta(stream, i, &meta); ++i)
    {
       if (stream->track_frame == frame_offset)
          return meta.pregap * stream->frame_size;
@@ -457,7 +811,7 @@ uint32_t chdstream_get_first_track_sector(chdstream_t* stream)
    uint32_t frame_offset = 0;
    uint32_t sector_offset = 0;
 
-   for (i = 0; chdstream_get_meta(stream->chd, i, &meta); ++i)
+   for (i = 0; chdstream_get_stream_meta(stream, i, &meta); ++i)
    {
       if (stream->track_frame == frame_offset)
          return sector_offset;
@@ -468,3 +822,20 @@ uint32_t chdstream_get_first_track_sector(chdstream_t* stream)
 
    return 0;
 }
+
+void chdstream_get_stats(chdstream_t *stream, chdstream_stats_t *stats)
+{
+#ifdef HAVE_THREADS
+   slock_lock(stream->lock);
+#endif
+   *stats = stream->stats;
+#ifdef HAVE_THREADS
+   slock_unlock(stream->lock);
+#endif
+}
+
+void chdstream_set_cache_size(unsigned cache_hunks, unsigned prefetch_hunks)
+{
+   chdstream_cache_hunks    = cache_hunks;
+   chdstream_prefetch_hunks = prefetch_hunks;
+}
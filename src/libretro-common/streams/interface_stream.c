@@ -617,6 +617,23 @@ uint32_t intfstream_get_first_sector(intfstream_internal_t* intf)
    return 0;
 }
 
+bool intfstream_get_chd_stats(intfstream_internal_t *intf,
+      struct chdstream_stats *stats)
+{
+   if (intf)
+   {
+#ifdef HAVE_CHD
+      if (intf->type == INTFSTREAM_CHD)
+      {
+         chdstream_get_stats(intf->chd.fp, stats);
+         return true;
+      }
+#endif
+   }
+
+   return false;
+}
+
 bool intfstream_is_compressed(intfstream_internal_t *intf)
 {
    if (!intf)
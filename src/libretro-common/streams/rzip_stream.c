@@ -28,6 +28,12 @@
 
 #include <streams/rzip_stream.h>
 
+#ifdef HAVE_THREADS
+#include <features/features_cpu.h>
+#include <rthreads/rthreads.h>
+#include <rthreads/tpool.h>
+#endif
+
 /* Current RZIP file format version */
 #define RZIP_VERSION 1
 
@@ -44,6 +50,39 @@
 #define RZIP_HEADER_SIZE 20
 #define RZIP_CHUNK_HEADER_SIZE 4
 
+#ifdef HAVE_THREADS
+/* Files of more than one chunk are compressed and
+ * decompressed on a thread pool. Chunks are still
+ * written and consumed strictly in order, so the
+ * file format is unchanged.
+ * > By default one thread per CPU core is used,
+ *   up to RZIP_MAX_THREADS
+ * > Each thread has at most RZIP_CHUNKS_PER_THREAD
+ *   chunks in flight, which bounds the memory used
+ *   (every chunk needs an input and output buffer) */
+#define RZIP_MAX_THREADS 4
+#define RZIP_CHUNKS_PER_THREAD 2
+
+/* Compresses or decompresses one chunk */
+struct rzip_chunk_job
+{
+   struct rzipstream *stream;
+   void *trans_stream;
+   uint8_t *in_buf;
+   uint8_t *out_buf;
+   uint32_t in_buf_size;
+   uint32_t out_buf_size;
+   uint32_t in_size;
+   uint32_t out_size;
+   bool done;
+   bool ok;
+};
+#endif
+
+/* Set by rzipstream_set_num_threads()
+ * > 0: pick from the number of CPU cores */
+static unsigned rzip_num_threads = 0;
+
 /* Holds all metadata for an RZIP file stream */
 struct rzipstream
 {
@@ -64,6 +103,21 @@ struct rzipstream
    uint32_t out_buf_ptr;
    uint32_t out_buf_occupancy;
    uint32_t chunk_size;
+#ifdef HAVE_THREADS
+   tpool_t *pool;
+   slock_t *job_lock;
+   scond_t *job_cond;
+   struct rzip_chunk_job *jobs;
+   /* Number of chunks read from the file so far */
+   uint64_t chunks_queued;
+   unsigned num_jobs;
+   /* Oldest job in flight, and number of jobs in flight */
+   unsigned job_head;
+   unsigned job_count;
+   /* Cleared once parallel mode has been set up,
+    * or turned out to be unavailable */
+   bool try_parallel;
+#endif
    bool is_compressed;
    bool is_writing;
 };
@@ -327,6 +381,361 @@ static bool rzipstream_init_stream(
    return true;
 }
 
+/* Chunk IO */
+
+/* Reads the next compressed chunk from the RZIP file
+ * into '*buf', growing it if required */
+static bool rzipstream_read_compressed_chunk(rzipstream_t *stream,
+      uint8_t **buf, uint32_t *buf_size, uint32_t *len)
+{
+   unsigned i;
+   uint8_t chunk_header_bytes[RZIP_CHUNK_HEADER_SIZE];
+   uint32_t compressed_chunk_size;
+
+   for (i = 0; i < RZIP_CHUNK_HEADER_SIZE; i++)
+      chunk_header_bytes[i] = 0;
+
+   /* Attempt to read chunk header bytes */
+   if (filestream_read(
+         stream->file, chunk_header_bytes, sizeof(chunk_header_bytes)) !=
+         RZIP_CHUNK_HEADER_SIZE)
+      return false;
+
+   /* Get size of next compressed chunk */
+   compressed_chunk_size = ((uint32_t)chunk_header_bytes[3] << 24) |
+                           ((uint32_t)chunk_header_bytes[2] << 16) |
+                           ((uint32_t)chunk_header_bytes[1] <<  8) |
+                            (uint32_t)chunk_header_bytes[0];
+   if (compressed_chunk_size == 0)
+      return false;
+
+   /* Resize input buffer, if required */
+   if (compressed_chunk_size > *buf_size)
+   {
+      free(*buf);
+      *buf      = NULL;
+
+      *buf_size = compressed_chunk_size;
+      if (!(*buf = (uint8_t *)calloc(*buf_size, 1)))
+      {
+         *buf_size = 0;
+         return false;
+      }
+
+      /* Note: Uncompressed data size is fixed, and read
+       * from the file header - we therefore don't attempt
+       * to resize the output buffer (if it's too small, then
+       * that's an error condition) */
+   }
+
+   /* Read compressed chunk from file */
+   if (filestream_read(
+         stream->file, *buf, compressed_chunk_size) !=
+         compressed_chunk_size)
+      return false;
+
+   *len = compressed_chunk_size;
+   return true;
+}
+
+/* Writes a compressed chunk, preceded by its size,
+ * to the RZIP file */
+static bool rzipstream_write_compressed_chunk(rzipstream_t *stream,
+      const uint8_t *buf, uint32_t len)
+{
+   uint8_t chunk_header_bytes[RZIP_CHUNK_HEADER_SIZE];
+
+   /* Write compressed chunk size to file */
+   chunk_header_bytes[3] = (len >> 24) & 0xFF;
+   chunk_header_bytes[2] = (len >> 16) & 0xFF;
+   chunk_header_bytes[1] = (len >>  8) & 0xFF;
+   chunk_header_bytes[0] =  len        & 0xFF;
+
+   if (filestream_write(
+         stream->file, chunk_header_bytes, sizeof(chunk_header_bytes)) !=
+         RZIP_CHUNK_HEADER_SIZE)
+      return false;
+
+   /* Write compressed data to file */
+   return filestream_write(stream->file, buf, len) == len;
+}
+
+/* Parallel Mode */
+
+#ifdef HAVE_THREADS
+/* Runs on the thread pool */
+static void rzipstream_run_job(void *data)
+{
+   uint32_t trans_read                        = 0;
+   uint32_t trans_written                     = 0;
+   struct rzip_chunk_job *job                 = (struct rzip_chunk_job*)data;
+   rzipstream_t *stream                       = job->stream;
+   const struct trans_stream_backend *backend = stream->is_writing
+         ? stream->deflate_backend : stream->inflate_backend;
+   bool ok                                    = false;
+
+   backend->set_in(job->trans_stream, job->in_buf, job->in_size);
+   backend->set_out(job->trans_stream, job->out_buf, job->out_buf_size);
+
+   /* Same checks as the single-threaded path */
+   if (backend->trans(job->trans_stream, true,
+            &trans_read, &trans_written, NULL))
+      ok = (trans_read    == job->in_size)
+        && (trans_written >  0)
+        && (trans_written <= job->out_buf_size);
+
+   slock_lock(stream->job_lock);
+   job->out_size = trans_written;
+   job->ok       = ok;
+   job->done     = true;
+   scond_broadcast(stream->job_cond);
+   slock_unlock(stream->job_lock);
+}
+
+static void rzipstream_start_job(rzipstream_t *stream,
+      struct rzip_chunk_job *job)
+{
+   job->done = false;
+   job->ok   = false;
+   stream->job_count++;
+
+   /* If the pool can't take it, do it here */
+   if (!tpool_add_work(stream->pool, rzipstream_run_job, job))
+      rzipstream_run_job(job);
+}
+
+/* Waits for the oldest job in flight and
+ * takes it off the queue */
+static struct rzip_chunk_job *rzipstream_finish_job(rzipstream_t *stream)
+{
+   struct rzip_chunk_job *job = NULL;
+
+   if (stream->job_count == 0)
+      return NULL;
+
+   job = &stream->jobs[stream->job_head];
+
+   slock_lock(stream->job_lock);
+   while (!job->done)
+      scond_wait(stream->job_cond, stream->job_lock);
+   slock_unlock(stream->job_lock);
+
+   stream->job_head = (stream->job_head + 1) % stream->num_jobs;
+   stream->job_count--;
+
+   return job;
+}
+
+/* Drops everything in flight */
+static void rzipstream_reset_jobs(rzipstream_t *stream)
+{
+   while (stream->job_count > 0)
+      rzipstream_finish_job(stream);
+
+   stream->job_head      = 0;
+   stream->chunks_queued = 0;
+}
+
+static void rzipstream_free_jobs(rzipstream_t *stream)
+{
+   unsigned i;
+
+   /* Waits for any job that is still running */
+   if (stream->pool)
+      tpool_destroy(stream->pool);
+   stream->pool = NULL;
+
+   if (stream->jobs)
+   {
+      const struct trans_stream_backend *backend = stream->is_writing
+            ? stream->deflate_backend : stream->inflate_backend;
+
+      for (i = 0; i < stream->num_jobs; i++)
+      {
+         struct rzip_chunk_job *job = &stream->jobs[i];
+
+         if (job->trans_stream && backend)
+            backend->stream_free(job->trans_stream);
+         if (job->in_buf)
+            free(job->in_buf);
+         if (job->out_buf)
+            free(job->out_buf);
+      }
+
+      free(stream->jobs);
+   }
+   stream->jobs      = NULL;
+   stream->num_jobs  = 0;
+   stream->job_count = 0;
+
+   if (stream->job_cond)
+      scond_free(stream->job_cond);
+   stream->job_cond  = NULL;
+
+   if (stream->job_lock)
+      slock_free(stream->job_lock);
+   stream->job_lock  = NULL;
+}
+
+/* Sets up the thread pool and one buffer set
+ * plus transform stream per chunk in flight.
+ * Returns false if parallel mode is unavailable */
+static bool rzipstream_init_jobs(rzipstream_t *stream)
+{
+   unsigned i;
+   unsigned num_threads                       = rzip_num_threads;
+   const struct trans_stream_backend *backend = stream->is_writing
+         ? stream->deflate_backend : stream->inflate_backend;
+
+   stream->try_parallel = false;
+
+   if (num_threads == 0)
+   {
+      num_threads = cpu_features_get_core_amount();
+      if (num_threads > RZIP_MAX_THREADS)
+         num_threads = RZIP_MAX_THREADS;
+   }
+
+   if (num_threads < 2 || !backend)
+      return false;
+
+   stream->num_jobs = num_threads * RZIP_CHUNKS_PER_THREAD;
+
+   if (   !(stream->jobs     = (struct rzip_chunk_job*)calloc(
+               stream->num_jobs, sizeof(*stream->jobs)))
+       || !(stream->job_lock = slock_new())
+       || !(stream->job_cond = scond_new())
+       || !(stream->pool     = tpool_create(num_threads)))
+      goto error;
+
+   for (i = 0; i < stream->num_jobs; i++)
+   {
+      struct rzip_chunk_job *job = &stream->jobs[i];
+
+      job->stream       = stream;
+      job->in_buf_size  = stream->in_buf_size;
+      job->out_buf_size = stream->out_buf_size;
+
+      if (   !(job->trans_stream = backend->stream_new())
+          || !(job->in_buf       = (uint8_t *)calloc(job->in_buf_size, 1))
+          || !(job->out_buf      = (uint8_t *)calloc(job->out_buf_size, 1)))
+         goto error;
+
+      if (     stream->is_writing
+            && !backend->define(job->trans_stream,
+                  "level", RZIP_COMPRESSION_LEVEL))
+         goto error;
+   }
+
+   stream->job_head      = 0;
+   stream->job_count     = 0;
+   stream->chunks_queued = 0;
+   return true;
+
+error:
+   rzipstream_free_jobs(stream);
+   return false;
+}
+
+/* Hands the input buffer to a job, then carries
+ * on with that job's (empty) input buffer. If all
+ * jobs are in flight, the oldest is written first */
+static bool rzipstream_queue_write_chunk(rzipstream_t *stream)
+{
+   uint8_t *in_buf            = NULL;
+   struct rzip_chunk_job *job = NULL;
+
+   if (stream->job_count == stream->num_jobs)
+   {
+      if (!(job = rzipstream_finish_job(stream)) || !job->ok)
+         return false;
+
+      if (!rzipstream_write_compressed_chunk(stream,
+               job->out_buf, job->out_size))
+         return false;
+   }
+
+   job = &stream->jobs[
+         (stream->job_head + stream->job_count) % stream->num_jobs];
+
+   in_buf             = job->in_buf;
+   job->in_buf        = stream->in_buf;
+   job->in_size       = stream->in_buf_ptr;
+   stream->in_buf     = in_buf;
+   stream->in_buf_ptr = 0;
+
+   rzipstream_start_job(stream, job);
+   return true;
+}
+
+/* Writes every chunk still in flight, in order */
+static bool rzipstream_flush_jobs(rzipstream_t *stream)
+{
+   bool ret = true;
+
+   while (stream->job_count > 0)
+   {
+      struct rzip_chunk_job *job = rzipstream_finish_job(stream);
+
+      if (     ret
+            && (!job->ok || !rzipstream_write_compressed_chunk(stream,
+                  job->out_buf, job->out_size)))
+         ret = false;
+   }
+
+   return ret;
+}
+
+/* Reads compressed chunks ahead, until every
+ * job is busy or the file has no more chunks */
+static bool rzipstream_queue_read_chunks(rzipstream_t *stream)
+{
+   uint64_t num_chunks = (stream->size + stream->chunk_size - 1)
+         / stream->chunk_size;
+
+   while (   (stream->job_count     < stream->num_jobs)
+          && (stream->chunks_queued < num_chunks))
+   {
+      struct rzip_chunk_job *job = &stream->jobs[
+            (stream->job_head + stream->job_count) % stream->num_jobs];
+
+      if (!rzipstream_read_compressed_chunk(stream,
+               &job->in_buf, &job->in_buf_size, &job->in_size))
+         return false;
+
+      stream->chunks_queued++;
+      rzipstream_start_job(stream, job);
+   }
+
+   return true;
+}
+
+/* Takes the next decompressed chunk, swapping
+ * its buffer with the stream output buffer */
+static bool rzipstream_dequeue_read_chunk(rzipstream_t *stream)
+{
+   uint8_t *out_buf           = NULL;
+   struct rzip_chunk_job *job = NULL;
+
+   if (!rzipstream_queue_read_chunks(stream))
+      return false;
+
+   if (!(job = rzipstream_finish_job(stream)) || !job->ok)
+      return false;
+
+   out_buf                   = stream->out_buf;
+   stream->out_buf           = job->out_buf;
+   job->out_buf              = out_buf;
+
+   stream->out_buf_occupancy = job->out_size;
+   stream->out_buf_ptr       = 0;
+
+   /* Keep the threads busy while this
+    * chunk is being consumed */
+   return rzipstream_queue_read_chunks(stream);
+}
+#endif
+
 /* free()'s all members of an rzipstream_t struct
  * > Also closes associated file, if currently open */
 static int rzipstream_free_stream(rzipstream_t *stream)
@@ -336,6 +745,11 @@ static int rzipstream_free_stream(rzipstream_t *stream)
    if (!stream)
       return -1;
 
+#ifdef HAVE_THREADS
+   /* Before the transform backends go away */
+   rzipstream_free_jobs(stream);
+#endif
+
    /* Free transform streams */
    if (stream->deflate_stream && stream->deflate_backend)
       stream->deflate_backend->stream_free(stream->deflate_stream);
@@ -368,6 +782,17 @@ static int rzipstream_free_stream(rzipstream_t *stream)
    return ret;
 }
 
+/* Threading */
+
+/* Sets the number of threads used to compress and
+ * decompress files of more than one chunk
+ * > 0: one per CPU core, up to RZIP_MAX_THREADS
+ * > 1: no threads */
+void rzipstream_set_num_threads(unsigned num_threads)
+{
+   rzip_num_threads = num_threads;
+}
+
 /* File Open */
 
 /* Opens a new or existing RZIP file
@@ -416,6 +841,17 @@ rzipstream_t* rzipstream_open(const char *path, unsigned mode)
    stream->out_buf_size    = 0;
    stream->out_buf_ptr     = 0;
    stream->out_buf_occupancy = 0;
+#ifdef HAVE_THREADS
+   stream->pool            = NULL;
+   stream->job_lock        = NULL;
+   stream->job_cond        = NULL;
+   stream->jobs            = NULL;
+   stream->chunks_queued   = 0;
+   stream->num_jobs        = 0;
+   stream->job_head        = 0;
+   stream->job_count       = 0;
+   stream->try_parallel    = true;
+#endif
 
    /* Initialise stream */
    if (!rzipstream_init_stream(
@@ -435,8 +871,6 @@ rzipstream_t* rzipstream_open(const char *path, unsigned mode)
  * in the RZIP file */
 static bool rzipstream_read_chunk(rzipstream_t *stream)
 {
-   unsigned i;
-   uint8_t chunk_header_bytes[RZIP_CHUNK_HEADER_SIZE];
    uint32_t compressed_chunk_size;
    uint32_t inflate_read;
    uint32_t inflate_written;
@@ -444,44 +878,19 @@ static bool rzipstream_read_chunk(rzipstream_t *stream)
    if (!stream || !stream->inflate_backend || !stream->inflate_stream)
       return false;
 
-   for (i = 0; i < RZIP_CHUNK_HEADER_SIZE; i++)
-      chunk_header_bytes[i] = 0;
+#ifdef HAVE_THREADS
+   /* Only worth it when there is more than one chunk */
+   if (     stream->try_parallel
+         && (stream->size > stream->chunk_size))
+      rzipstream_init_jobs(stream);
 
-   /* Attempt to read chunk header bytes */
-   if (filestream_read(
-         stream->file, chunk_header_bytes, sizeof(chunk_header_bytes)) !=
-         RZIP_CHUNK_HEADER_SIZE)
-      return false;
+   if (stream->jobs)
+      return rzipstream_dequeue_read_chunk(stream);
+#endif
 
-   /* Get size of next compressed chunk */
-   compressed_chunk_size = ((uint32_t)chunk_header_bytes[3] << 24) |
-                           ((uint32_t)chunk_header_bytes[2] << 16) |
-                           ((uint32_t)chunk_header_bytes[1] <<  8) |
-                            (uint32_t)chunk_header_bytes[0];
-   if (compressed_chunk_size == 0)
-      return false;
-
-   /* Resize input buffer, if required */
-   if (compressed_chunk_size > stream->in_buf_size)
-   {
-      free(stream->in_buf);
-      stream->in_buf      = NULL;
-
-      stream->in_buf_size = compressed_chunk_size;
-      stream->in_buf      = (uint8_t *)calloc(stream->in_buf_size, 1);
-      if (!stream->in_buf)
-         return false;
-
-      /* Note: Uncompressed data size is fixed, and read
-       * from the file header - we therefore don't attempt
-       * to resize the output buffer (if it's too small, then
-       * that's an error condition) */
-   }
-
-   /* Read compressed chunk from file */
-   if (filestream_read(
-         stream->file, stream->in_buf, compressed_chunk_size) !=
-         compressed_chunk_size)
+   if (!rzipstream_read_compressed_chunk(stream,
+            &stream->in_buf, &stream->in_buf_size,
+            &compressed_chunk_size))
       return false;
 
    /* Decompress chunk data */
@@ -720,16 +1129,16 @@ error:
  * as the next RZIP file chunk */
 static bool rzipstream_write_chunk(rzipstream_t *stream)
 {
-   unsigned i;
-   uint8_t chunk_header_bytes[RZIP_CHUNK_HEADER_SIZE];
    uint32_t deflate_read;
    uint32_t deflate_written;
 
    if (!stream || !stream->deflate_backend || !stream->deflate_stream)
       return false;
 
-   for (i = 0; i < RZIP_CHUNK_HEADER_SIZE; i++)
-      chunk_header_bytes[i] = 0;
+#ifdef HAVE_THREADS
+   if (stream->jobs)
+      return rzipstream_queue_write_chunk(stream);
+#endif
 
    /* Compress data currently held in input buffer */
    stream->deflate_backend->set_in(
@@ -757,20 +1166,8 @@ static bool rzipstream_write_chunk(rzipstream_t *stream)
        (deflate_written > stream->out_buf_size))
       return false;
 
-   /* Write compressed chunk size to file */
-   chunk_header_bytes[3] = (deflate_written >> 24) & 0xFF;
-   chunk_header_bytes[2] = (deflate_written >> 16) & 0xFF;
-   chunk_header_bytes[1] = (deflate_written >>  8) & 0xFF;
-   chunk_header_bytes[0] =  deflate_written        & 0xFF;
-
-   if (filestream_write(
-         stream->file, chunk_header_bytes, sizeof(chunk_header_bytes)) !=
-         RZIP_CHUNK_HEADER_SIZE)
-      return false;
-
-   /* Write compressed data to file */
-   if (filestream_write(
-         stream->file, stream->out_buf, deflate_written) != deflate_written)
+   if (!rzipstream_write_compressed_chunk(stream,
+            stream->out_buf, deflate_written))
       return false;
 
    /* Reset input buffer pointer */
@@ -797,8 +1194,15 @@ int64_t rzipstream_write(rzipstream_t *stream, const void *data, int64_t len)
 
       /* If input buffer is full, compress and write to disk */
       if (stream->in_buf_ptr >= stream->in_buf_size)
+      {
+#ifdef HAVE_THREADS
+         /* There is more than one chunk to write */
+         if (stream->try_parallel)
+            rzipstream_init_jobs(stream);
+#endif
          if (!rzipstream_write_chunk(stream))
             return -1;
+      }
 
       /* Get amount of data to cache during this loop
        * > i.e. minimum of space remaining in input buffer
@@ -940,6 +1344,12 @@ void rzipstream_rewind(rzipstream_t *stream)
    /* Check whether we are reading or writing */
    if (stream->is_writing)
    {
+#ifdef HAVE_THREADS
+      /* Discard any chunks still being compressed */
+      if (stream->jobs)
+         rzipstream_reset_jobs(stream);
+#endif
+
       /* Reset file position to first chunk location */
       filestream_seek(stream->file, RZIP_HEADER_SIZE, SEEK_SET);
       if (filestream_error(stream->file))
@@ -969,6 +1379,12 @@ void rzipstream_rewind(rzipstream_t *stream)
          /* It isn't: Have to re-read the first chunk
           * from disk... */
 
+#ifdef HAVE_THREADS
+         /* Discard any chunks that were read ahead */
+         if (stream->jobs)
+            rzipstream_reset_jobs(stream);
+#endif
+
          /* Reset file position to first chunk location */
          filestream_seek(stream->file, RZIP_HEADER_SIZE, SEEK_SET);
          if (filestream_error(stream->file))
@@ -1054,6 +1470,11 @@ int rzipstream_close(rzipstream_t *stream)
          if (!rzipstream_write_chunk(stream))
             goto error;
 
+#ifdef HAVE_THREADS
+      if (stream->jobs && !rzipstream_flush_jobs(stream))
+         goto error;
+#endif
+
       if (!rzipstream_write_file_header(stream))
          goto error;
    }
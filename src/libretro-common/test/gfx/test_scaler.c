@@ -0,0 +1,264 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (test_scaler.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <check.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <retro_miscellaneous.h>
+#include <features/features_cpu.h>
+#include <gfx/scaler/scaler.h>
+#include <gfx/scaler/pixconv.h>
+
+#define SUITE_NAME "Scaler"
+
+/* Written to the output before scaling, so that
+ * writes past the end of a row are caught */
+#define GUARD 0xa5
+
+/* Rows are padded by this many bytes */
+#define ROW_PADDING 12
+
+#define THREADS 3
+
+static const uint64_t simd_paths[] = {
+   0,
+   RETRO_SIMD_MMX | RETRO_SIMD_SSE2,
+   RETRO_SIMD_MMX | RETRO_SIMD_SSE2 | RETRO_SIMD_AVX2,
+   RETRO_SIMD_NEON
+};
+
+static const struct
+{
+   enum scaler_pix_fmt fmt;
+   int bpp;
+} fmts[] = {
+   { SCALER_FMT_ARGB8888, 4 },
+   { SCALER_FMT_RGB565,   2 },
+   { SCALER_FMT_BGR24,    3 },
+};
+
+struct scaler_case
+{
+   int in_width;
+   int in_height;
+   int out_width;
+   int out_height;
+   unsigned in_fmt;
+   unsigned out_fmt;
+   enum scaler_type type;
+};
+
+/* Odd sizes, so that every vector tail is hit, and the
+ * sizes the frontend scales between */
+static const struct scaler_case cases[] = {
+   {  37,  23,  101,   67, 0, 0, SCALER_TYPE_BILINEAR },
+   {  37,  23,  101,   67, 1, 2, SCALER_TYPE_BILINEAR },
+   {  37,  23,  101,   67, 0, 0, SCALER_TYPE_SINC },
+   { 101,  67,   37,   23, 0, 0, SCALER_TYPE_SINC },
+   { 101,  67,   37,   23, 0, 1, SCALER_TYPE_BILINEAR },
+   {  37,  23,  101,   67, 1, 2, SCALER_TYPE_POINT },
+   { 256, 224,  640,  480, 1, 0, SCALER_TYPE_BILINEAR },
+   { 640, 480,  173,   97, 0, 2, SCALER_TYPE_SINC },
+   { 320, 240, 1920, 1080, 1, 2, SCALER_TYPE_POINT },
+   { 320, 240, 1920, 1080, 1, 2, SCALER_TYPE_BILINEAR },
+};
+
+static unsigned long rand_state = 1;
+
+static uint8_t test_rand(void)
+{
+   rand_state = rand_state * 1103515245 + 12345;
+   return (uint8_t)(rand_state >> 16);
+}
+
+static int row_stride(int width, unsigned fmt)
+{
+   return width * fmts[fmt].bpp + ROW_PADDING;
+}
+
+static size_t out_size(const struct scaler_case *sc)
+{
+   return (size_t)row_stride(sc->out_width, sc->out_fmt) * sc->out_height;
+}
+
+static bool gen_filter(struct scaler_ctx *ctx,
+      const struct scaler_case *sc, unsigned threads)
+{
+   ctx->in_width    = sc->in_width;
+   ctx->in_height   = sc->in_height;
+   ctx->in_stride   = row_stride(sc->in_width, sc->in_fmt);
+   ctx->in_fmt      = fmts[sc->in_fmt].fmt;
+   ctx->out_width   = sc->out_width;
+   ctx->out_height  = sc->out_height;
+   ctx->out_stride  = row_stride(sc->out_width, sc->out_fmt);
+   ctx->out_fmt     = fmts[sc->out_fmt].fmt;
+   ctx->scaler_type = sc->type;
+   ctx->threads     = threads;
+   return scaler_ctx_gen_filter(ctx);
+}
+
+static uint8_t *random_frame(const struct scaler_case *sc)
+{
+   size_t i;
+   size_t size = (size_t)row_stride(sc->in_width, sc->in_fmt)
+      * sc->in_height;
+   uint8_t *in = (uint8_t*)malloc(size);
+
+   ck_assert_ptr_nonnull(in);
+   for (i = 0; i < size; i++)
+      in[i] = test_rand();
+   return in;
+}
+
+/* Scales 'in' with the given SIMD path and number
+ * of threads, padding left as GUARD */
+static uint8_t *scale(const struct scaler_case *sc, uint64_t simd,
+      unsigned threads, const uint8_t *in)
+{
+   struct scaler_ctx ctx;
+   uint8_t *out = (uint8_t*)malloc(out_size(sc));
+
+   ck_assert_ptr_nonnull(out);
+   memset(&ctx, 0, sizeof(ctx));
+   memset(out, GUARD, out_size(sc));
+   pixconv_set_simd(simd);
+
+   ck_assert(gen_filter(&ctx, sc, threads));
+   scaler_ctx_scale(&ctx, out, in);
+   scaler_ctx_gen_reset(&ctx);
+   return out;
+}
+
+/* Every SIMD path the CPU has, on one thread and on
+ * several, must match plain C on one thread exactly,
+ * row padding included */
+static void check_case(const struct scaler_case *sc)
+{
+   unsigned p;
+   uint64_t available;
+   uint8_t *in;
+   uint8_t *ref;
+
+   pixconv_init_simd();
+   available = pixconv_get_simd();
+
+   in        = random_frame(sc);
+   ref       = scale(sc, 0, 1, in);
+
+   for (p = 0; p < ARRAY_SIZE(simd_paths); p++)
+   {
+      uint8_t *out;
+
+      if ((simd_paths[p] & available) != simd_paths[p])
+         continue;
+
+      out = scale(sc, simd_paths[p], 1, in);
+      ck_assert_msg(!memcmp(out, ref, out_size(sc)),
+            "%dx%d -> %dx%d, type %d, SIMD %#llx: differs from C",
+            sc->in_width, sc->in_height, sc->out_width, sc->out_height,
+            sc->type, (unsigned long long)simd_paths[p]);
+      free(out);
+
+      out = scale(sc, simd_paths[p], THREADS, in);
+      ck_assert_msg(!memcmp(out, ref, out_size(sc)),
+            "%dx%d -> %dx%d, type %d, SIMD %#llx, %u threads: "
+            "differs from C",
+            sc->in_width, sc->in_height, sc->out_width, sc->out_height,
+            sc->type, (unsigned long long)simd_paths[p], THREADS);
+      free(out);
+   }
+
+   free(in);
+   free(ref);
+}
+
+START_TEST (test_scaler_point)
+{
+   unsigned i;
+   for (i = 0; i < ARRAY_SIZE(cases); i++)
+      if (cases[i].type == SCALER_TYPE_POINT)
+         check_case(&cases[i]);
+}
+END_TEST
+
+START_TEST (test_scaler_bilinear)
+{
+   unsigned i;
+   for (i = 0; i < ARRAY_SIZE(cases); i++)
+      if (cases[i].type == SCALER_TYPE_BILINEAR)
+         check_case(&cases[i]);
+}
+END_TEST
+
+START_TEST (test_scaler_sinc)
+{
+   unsigned i;
+   for (i = 0; i < ARRAY_SIZE(cases); i++)
+      if (cases[i].type == SCALER_TYPE_SINC)
+         check_case(&cases[i]);
+}
+END_TEST
+
+START_TEST (test_scaler_filters_kept)
+{
+   int16_t *filter;
+   struct scaler_ctx ctx;
+
+   memset(&ctx, 0, sizeof(ctx));
+   pixconv_set_simd(0);
+   ck_assert(gen_filter(&ctx, &cases[2], 1));
+   filter = ctx.horiz.filter;
+
+   /* Nothing changed, so the filters aren't regenerated */
+   ck_assert(gen_filter(&ctx, &cases[2], 1));
+   ck_assert_ptr_eq(ctx.horiz.filter, filter);
+
+   scaler_ctx_gen_reset(&ctx);
+}
+END_TEST
+
+Suite *create_suite(void)
+{
+   Suite *s = suite_create(SUITE_NAME);
+
+   TCase *tc_core = tcase_create("Core");
+   tcase_add_test(tc_core, test_scaler_point);
+   tcase_add_test(tc_core, test_scaler_bilinear);
+   tcase_add_test(tc_core, test_scaler_sinc);
+   tcase_add_test(tc_core, test_scaler_filters_kept);
+   tcase_set_timeout(tc_core, 60);
+   suite_add_tcase(s, tc_core);
+
+   return s;
+}
+
+int main(void)
+{
+   int num_fail;
+   Suite *s = create_suite();
+   SRunner *sr = srunner_create(s);
+   srunner_run_all(sr, CK_NORMAL);
+   num_fail = srunner_ntests_failed(sr);
+   srunner_free(sr);
+   return (num_fail == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
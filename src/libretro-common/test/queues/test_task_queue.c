@@ -0,0 +1,279 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (test_task_queue.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <check.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <queues/task_queue.h>
+#include <rthreads/rthreads.h>
+#include <retro_timers.h>
+#include <features/features_cpu.h>
+
+#define SUITE_NAME "Task Queue"
+
+#define TEST_TASKS  12
+#define TEST_SLICES 5
+
+static slock_t *_lock;
+static int _running[TASK_PRIORITY_LAST];
+static int _overlap;
+static int _callbacks;
+static unsigned _once_count;
+static retro_time_t _ran_at;
+
+static void _slice_handler(retro_task_t *task)
+{
+   intptr_t slices = (intptr_t)task->state;
+   unsigned prio   = task->priority;
+
+   slock_lock(_lock);
+   if (_running[prio]++)
+      _overlap++;
+   slock_unlock(_lock);
+
+   retro_sleep(1);
+
+   slock_lock(_lock);
+   _running[prio]--;
+   slock_unlock(_lock);
+
+   task->state = (void*)--slices;
+   if (!slices)
+      task_set_finished(task, true);
+}
+
+static void _once_handler(retro_task_t *task)
+{
+   slock_lock(_lock);
+   _once_count++;
+   _ran_at = cpu_features_get_time_usec();
+   slock_unlock(_lock);
+   task_set_finished(task, true);
+}
+
+static void _callback(retro_task_t *task,
+      void *task_data, void *user_data, const char *error)
+{
+   _callbacks++;
+}
+
+static bool _find_handler(retro_task_t *task, void *userdata)
+{
+   return task->handler == (retro_task_handler_t)userdata;
+}
+
+static bool _retrieve_priority(retro_task_t *task, void *data)
+{
+   *(unsigned*)data = task->priority;
+   return true;
+}
+
+static void _reset(bool threaded)
+{
+   _lock        = slock_new();
+   _overlap     = 0;
+   _callbacks   = 0;
+   _once_count  = 0;
+   memset(_running, 0, sizeof(_running));
+   if (!threaded)
+      task_queue_unset_threaded();
+   task_queue_init(threaded, NULL);
+}
+
+static void _teardown(void)
+{
+   task_queue_deinit();
+   slock_free(_lock);
+}
+
+static retro_task_t *_new_task(retro_task_handler_t handler,
+      enum task_priority prio, intptr_t slices)
+{
+   retro_task_t *task = task_init();
+   task->handler      = handler;
+   task->callback     = _callback;
+   task->priority     = prio;
+   task->state        = (void*)slices;
+   return task;
+}
+
+START_TEST (test_task_queue_threaded_all_finish)
+{
+   unsigned i;
+   task_queue_stats_t stats;
+
+   _reset(true);
+
+   for (i = 0; i < TEST_TASKS; i++)
+      ck_assert(task_queue_push(_new_task(_slice_handler,
+                  (enum task_priority)(i % TASK_PRIORITY_LAST), TEST_SLICES)));
+
+   task_queue_wait(NULL, NULL);
+   task_queue_check();
+
+   ck_assert_int_eq(_callbacks, TEST_TASKS);
+   ck_assert_int_eq(_overlap, 0);
+
+   ck_assert(task_queue_get_stats(&stats));
+   ck_assert_uint_ge(stats.workers, 1);
+   for (i = 0; i < TASK_PRIORITY_LAST; i++)
+   {
+      ck_assert_uint_eq(stats.slices[i],
+            TEST_TASKS / TASK_PRIORITY_LAST * TEST_SLICES);
+      ck_assert_uint_eq(stats.depth[i], 0);
+      ck_assert_uint_ge(stats.depth_max[i], 1);
+   }
+
+   _teardown();
+}
+END_TEST
+
+START_TEST (test_task_queue_threaded_delayed)
+{
+   unsigned i;
+   retro_time_t when;
+   retro_task_t *task = NULL;
+
+   _reset(true);
+
+   when       = cpu_features_get_time_usec() + 20000;
+   task       = _new_task(_once_handler, TASK_PRIORITY_SAVESTATE, 0);
+   task->when = when;
+   task_queue_push(task);
+
+   /* Work pushed later must not wait for the delayed task */
+   task_queue_push(_new_task(_slice_handler, TASK_PRIORITY_SAVESTATE, 1));
+   task_queue_wait(NULL, NULL);
+   task_queue_check();
+   ck_assert_int_eq(_callbacks, 1);
+
+   for (i = 0; i < 1000 && _callbacks < 2; i++)
+   {
+      retro_sleep(1);
+      task_queue_check();
+   }
+
+   ck_assert_int_eq(_callbacks, 2);
+   ck_assert_uint_eq(_once_count, 1);
+   ck_assert(_ran_at >= when - 500);
+
+   _teardown();
+}
+END_TEST
+
+START_TEST (test_task_queue_threaded_find_retrieve)
+{
+   unsigned *prio;
+   unsigned count = 0;
+   task_finder_data_t find_data;
+   task_retriever_data_t retrieve_data;
+   task_retriever_info_t *link = NULL;
+
+   _reset(true);
+
+   task_queue_push(_new_task(_slice_handler, TASK_PRIORITY_BACKGROUND, 50));
+   task_queue_push(_new_task(_slice_handler, TASK_PRIORITY_SAVESTATE,  50));
+
+   find_data.func     = _find_handler;
+   find_data.userdata = (void*)_slice_handler;
+   ck_assert(task_queue_find(&find_data));
+   find_data.userdata = (void*)_once_handler;
+   ck_assert(!task_queue_find(&find_data));
+
+   retrieve_data.list         = NULL;
+   retrieve_data.handler      = _slice_handler;
+   retrieve_data.func         = _retrieve_priority;
+   retrieve_data.element_size = sizeof(unsigned);
+   task_queue_retrieve(&retrieve_data);
+
+   link = retrieve_data.list;
+   while ((prio = (unsigned*)task_queue_retriever_info_next(&link)))
+   {
+      ck_assert(*prio == TASK_PRIORITY_BACKGROUND
+            || *prio == TASK_PRIORITY_SAVESTATE);
+      count++;
+   }
+   task_queue_retriever_info_free(retrieve_data.list);
+   ck_assert_uint_eq(count, 2);
+
+   task_queue_reset();
+   task_queue_wait(NULL, NULL);
+   task_queue_check();
+   ck_assert_int_eq(_callbacks, 2);
+
+   _teardown();
+}
+END_TEST
+
+START_TEST (test_task_queue_switch_implementation)
+{
+   unsigned i;
+
+   _reset(false);
+
+   for (i = 0; i < TEST_TASKS; i++)
+      task_queue_push(_new_task(_slice_handler,
+               (enum task_priority)(i % TASK_PRIORITY_LAST), TEST_SLICES));
+
+   /* Run a slice of everything on the main thread,
+    * then hand the leftovers to the workers */
+   task_queue_check();
+   ck_assert(!task_queue_get_stats(NULL));
+
+   task_queue_set_threaded();
+   task_queue_check();
+   task_queue_wait(NULL, NULL);
+   task_queue_check();
+   task_queue_unset_threaded();
+
+   ck_assert_int_eq(_callbacks, TEST_TASKS);
+   ck_assert_int_eq(_overlap, 0);
+
+   _teardown();
+}
+END_TEST
+
+Suite *create_suite(void)
+{
+   Suite *s = suite_create(SUITE_NAME);
+
+   TCase *tc_core = tcase_create("Core");
+   tcase_add_test(tc_core, test_task_queue_threaded_all_finish);
+   tcase_add_test(tc_core, test_task_queue_threaded_delayed);
+   tcase_add_test(tc_core, test_task_queue_threaded_find_retrieve);
+   tcase_add_test(tc_core, test_task_queue_switch_implementation);
+   suite_add_tcase(s, tc_core);
+
+   return s;
+}
+
+int main(void)
+{
+	int num_fail;
+	Suite *s = create_suite();
+	SRunner *sr = srunner_create(s);
+	srunner_run_all(sr, CK_NORMAL);
+	num_fail = srunner_ntests_failed(sr);
+	srunner_free(sr);
+	return (num_fail == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,218 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (test_rzip_stream.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <check.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <retro_miscellaneous.h>
+#include <streams/file_stream.h>
+#include <streams/rzip_stream.h>
+
+#define SUITE_NAME "RZIP Stream"
+
+/* Same as task_save.c */
+#define WRITE_CHUNK (4096 * 10)
+
+/* Several chunks, so that compression is threaded */
+#define STATE_SIZE  (4 * 1024 * 1024)
+
+#define THREADS     4
+
+/* Something like a save state: runs of zeroes,
+ * repeated structures and some noise */
+static uint8_t *new_state(size_t size)
+{
+   size_t i;
+   uint32_t seed = 12345;
+   uint8_t *data = (uint8_t*)malloc(size);
+
+   ck_assert_ptr_nonnull(data);
+
+   for (i = 0; i < size; i++)
+   {
+      seed = seed * 1103515245 + 12345;
+
+      switch ((i >> 12) & 3)
+      {
+         case 0:
+            data[i] = 0;
+            break;
+         case 1:
+            data[i] = (uint8_t)(i * 7);
+            break;
+         case 2:
+            data[i] = (uint8_t)((i & 0xFF) ^ (seed >> 28));
+            break;
+         default:
+            data[i] = (uint8_t)(seed >> 16);
+            break;
+      }
+   }
+
+   return data;
+}
+
+/* Writes 'data' in save state sized pieces */
+static void write_state(const char *path, const uint8_t *data, size_t size)
+{
+   size_t pos           = 0;
+   rzipstream_t *stream = rzipstream_open(path, RETRO_VFS_FILE_ACCESS_WRITE);
+
+   ck_assert_ptr_nonnull(stream);
+
+   while (pos < size)
+   {
+      size_t len = MIN(size - pos, WRITE_CHUNK);
+      ck_assert(rzipstream_write(stream, data + pos, len) == (int64_t)len);
+      pos += len;
+   }
+
+   ck_assert_int_eq(rzipstream_close(stream), 0);
+}
+
+/* Reads it back the same way, rewinding once halfway,
+ * and compares it to 'data' */
+static void check_state(const char *path, const uint8_t *data, size_t size)
+{
+   size_t pos           = 0;
+   bool rewound         = false;
+   uint8_t *out         = (uint8_t*)malloc(size);
+   rzipstream_t *stream = rzipstream_open(path, RETRO_VFS_FILE_ACCESS_READ);
+
+   ck_assert_ptr_nonnull(out);
+   ck_assert_ptr_nonnull(stream);
+   ck_assert(rzipstream_get_size(stream) == (int64_t)size);
+
+   memset(out, 0xAA, size);
+
+   while (pos < size)
+   {
+      size_t len = MIN(size - pos, WRITE_CHUNK);
+      ck_assert(rzipstream_read(stream, out + pos, len) == (int64_t)len);
+      pos += len;
+
+      if (!rewound && pos >= size / 2)
+      {
+         rzipstream_rewind(stream);
+         rewound = true;
+         pos     = 0;
+      }
+   }
+
+   rzipstream_close(stream);
+   ck_assert(!memcmp(data, out, size));
+   free(out);
+}
+
+static void round_trip(unsigned threads, size_t size)
+{
+   char tmpfile[512];
+   uint8_t *data = new_state(size);
+
+   tmpnam(tmpfile);
+   rzipstream_set_num_threads(threads);
+   write_state(tmpfile, data, size);
+   check_state(tmpfile, data, size);
+   rzipstream_set_num_threads(0);
+
+   filestream_delete(tmpfile);
+   free(data);
+}
+
+START_TEST (test_rzip_stream_serial)
+{
+   round_trip(1, STATE_SIZE);
+}
+END_TEST
+
+START_TEST (test_rzip_stream_threaded)
+{
+   round_trip(THREADS, STATE_SIZE);
+}
+END_TEST
+
+/* Files of a single chunk never start threads */
+START_TEST (test_rzip_stream_small)
+{
+   round_trip(THREADS, 100000);
+}
+END_TEST
+
+START_TEST (test_rzip_stream_threaded_identical)
+{
+   char serial[512];
+   char threaded[512];
+   void *buf_a   = NULL;
+   void *buf_b   = NULL;
+   int64_t len_a = 0;
+   int64_t len_b = 0;
+   uint8_t *data = new_state(STATE_SIZE);
+
+   tmpnam(serial);
+   tmpnam(threaded);
+
+   rzipstream_set_num_threads(1);
+   write_state(serial, data, STATE_SIZE);
+   rzipstream_set_num_threads(THREADS);
+   write_state(threaded, data, STATE_SIZE);
+   rzipstream_set_num_threads(0);
+
+   ck_assert(filestream_read_file(serial,   &buf_a, &len_a));
+   ck_assert(filestream_read_file(threaded, &buf_b, &len_b));
+   ck_assert(len_a == len_b);
+   ck_assert(!memcmp(buf_a, buf_b, (size_t)len_a));
+
+   filestream_delete(serial);
+   filestream_delete(threaded);
+   free(buf_a);
+   free(buf_b);
+   free(data);
+}
+END_TEST
+
+Suite *create_suite(void)
+{
+   Suite *s = suite_create(SUITE_NAME);
+
+   TCase *tc_core = tcase_create("Core");
+   tcase_add_test(tc_core, test_rzip_stream_serial);
+   tcase_add_test(tc_core, test_rzip_stream_threaded);
+   tcase_add_test(tc_core, test_rzip_stream_small);
+   tcase_add_test(tc_core, test_rzip_stream_threaded_identical);
+   tcase_set_timeout(tc_core, 60);
+   suite_add_tcase(s, tc_core);
+
+   return s;
+}
+
+int main(void)
+{
+   int num_fail;
+   Suite *s = create_suite();
+   SRunner *sr = srunner_create(s);
+   srunner_run_all(sr, CK_NORMAL);
+   num_fail = srunner_ntests_failed(sr);
+   srunner_free(sr);
+   return (num_fail == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
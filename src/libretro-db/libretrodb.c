@@ -30,6 +30,7 @@
 #include <sys/stat.h>
 #include <stdlib.h>
 
+#include <boolean.h>
 #include <streams/file_stream.h>
 #include <retro_endianness.h>
 #include <string/stdstring.h>
@@ -605,3 +606,470 @@ void libretrodb_free(libretrodb_t *db)
 
    free(db);
 }
+
+/* Key index
+ *
+ * A sorted table of (hash of a field's value, record offset)
+ * pairs. Unlike the indexes written by libretrodb_create_index(),
+ * keys don't need to be unique nor of a fixed size, so it works
+ * for 'crc', 'serial' and 'name' alike. Hash collisions are
+ * resolved by comparing the field of the record itself. */
+
+#define INDEX_MAGIC_NUMBER "RARCHIX"
+
+struct libretrodb_key_index_entry
+{
+   uint64_t hash;
+   uint64_t offset;
+};
+
+struct libretrodb_key_index
+{
+   struct libretrodb_key_index_entry *entries;
+   uint64_t count;
+   char field_name[32];
+};
+
+/* Bytes hashed at each end of the database for 'db_sample' */
+#define INDEX_SAMPLE_SIZE (64 * 1024)
+
+/* Written in front of a cached index. Everything
+ * but the strings is stored big endian. The database
+ * fields are used to tell whether the cache is stale;
+ * 'db_sample' hashes the start and the end of the file,
+ * which hold the first records and the metadata. */
+typedef struct libretrodb_key_index_header
+{
+   char magic_number[sizeof(INDEX_MAGIC_NUMBER)];
+   char field_name[32];
+   uint64_t db_size;
+   uint64_t db_mtime;
+   uint64_t db_sample;
+   uint64_t db_count;
+   uint64_t db_first_index_offset;
+   uint64_t count;
+} libretrodb_key_index_header_t;
+
+/* FNV-1a */
+static uint64_t libretrodb_fnv1a(uint64_t hash, const void *key, size_t len)
+{
+   size_t i;
+   const uint8_t *data = (const uint8_t*)key;
+
+   for (i = 0; i < len; i++)
+   {
+      hash ^= data[i];
+      hash *= 0x100000001b3ULL;
+   }
+
+   return hash;
+}
+
+static uint64_t libretrodb_key_hash(const void *key, size_t len)
+{
+   return libretrodb_fnv1a(0xcbf29ce484222325ULL, key, len);
+}
+
+/* Modification time in nanoseconds where the
+ * platform keeps it, otherwise in whole seconds */
+static int64_t libretrodb_file_mtime(const char *path)
+{
+#if defined(_WIN32) && !defined(_XBOX)
+   struct _stat64 buf;
+   if (_stat64(path, &buf) != 0)
+      return 0;
+   return (int64_t)buf.st_mtime * 1000000000;
+#elif defined(__unix__) || defined(__APPLE__) || defined(__HAIKU__)
+   struct stat buf;
+   if (stat(path, &buf) != 0)
+      return 0;
+#if defined(__APPLE__)
+   return (int64_t)buf.st_mtimespec.tv_sec * 1000000000
+      + buf.st_mtimespec.tv_nsec;
+#elif defined(st_mtime)
+   /* Only a macro where it aliases st_mtim.tv_sec */
+   return (int64_t)buf.st_mtim.tv_sec * 1000000000
+      + buf.st_mtim.tv_nsec;
+#else
+   return (int64_t)buf.st_mtime * 1000000000;
+#endif
+#else
+   return 0;
+#endif
+}
+
+static uint64_t libretrodb_file_sample(libretrodb_t *db, int64_t size)
+{
+   int64_t len;
+   uint8_t *buf  = NULL;
+   uint64_t hash = 0xcbf29ce484222325ULL;
+   int64_t pos   = filestream_tell(db->fd);
+
+   if (!(buf = (uint8_t*)malloc(INDEX_SAMPLE_SIZE)))
+      return 0;
+
+   len  = size < INDEX_SAMPLE_SIZE ? size : INDEX_SAMPLE_SIZE;
+   if (     filestream_seek(db->fd, 0, RETRO_VFS_SEEK_POSITION_START) == 0
+         && filestream_read(db->fd, buf, len) == len)
+      hash = libretrodb_fnv1a(hash, buf, (size_t)len);
+
+   if (     filestream_seek(db->fd, size - len,
+               RETRO_VFS_SEEK_POSITION_START) == 0
+         && filestream_read(db->fd, buf, len) == len)
+      hash = libretrodb_fnv1a(hash, buf, (size_t)len);
+
+   filestream_seek(db->fd, pos, RETRO_VFS_SEEK_POSITION_START);
+   free(buf);
+   return hash;
+}
+
+static int libretrodb_key_index_entry_compare(const void *a, const void *b)
+{
+   const struct libretrodb_key_index_entry *left  =
+      (const struct libretrodb_key_index_entry*)a;
+   const struct libretrodb_key_index_entry *right =
+      (const struct libretrodb_key_index_entry*)b;
+
+   if (left->hash != right->hash)
+      return left->hash < right->hash ? -1 : 1;
+   if (left->offset != right->offset)
+      return left->offset < right->offset ? -1 : 1;
+   return 0;
+}
+
+/* Returns the raw bytes of a string or binary field,
+ * or NULL if @item doesn't have a usable @field_name. */
+static const char *libretrodb_key_index_field(
+      const struct rmsgpack_dom_value *item,
+      const char *field_name, uint32_t *len)
+{
+   struct rmsgpack_dom_value key;
+   struct rmsgpack_dom_value *field = NULL;
+
+   if (item->type != RDT_MAP)
+      return NULL;
+
+   key.type            = RDT_STRING;
+   key.val.string.len  = (uint32_t)strlen(field_name);
+   key.val.string.buff = (char *)field_name;
+
+   if (!(field = rmsgpack_dom_value_map_value(item, &key)))
+      return NULL;
+
+   if (field->type == RDT_STRING)
+   {
+      *len = field->val.string.len;
+      return field->val.string.buff;
+   }
+
+   if (field->type == RDT_BINARY)
+   {
+      *len = field->val.binary.len;
+      return field->val.binary.buff;
+   }
+
+   return NULL;
+}
+
+static void libretrodb_key_index_fill_header(libretrodb_t *db,
+      const libretrodb_key_index_t *idx,
+      libretrodb_key_index_header_t *header)
+{
+   int64_t size = filestream_get_size(db->fd);
+
+   memset(header, 0, sizeof(*header));
+   memcpy(header->magic_number, INDEX_MAGIC_NUMBER,
+         sizeof(INDEX_MAGIC_NUMBER)-1);
+   strlcpy(header->field_name, idx->field_name, sizeof(header->field_name));
+   header->db_size               = swap_if_little64((uint64_t)size);
+   header->db_mtime              = swap_if_little64(
+         (uint64_t)libretrodb_file_mtime(db->path));
+   header->db_sample             = swap_if_little64(
+         libretrodb_file_sample(db, size));
+   header->db_count              = swap_if_little64(db->count);
+   header->db_first_index_offset = swap_if_little64(db->first_index_offset);
+   header->count                 = swap_if_little64(idx->count);
+}
+
+static bool libretrodb_key_index_load(libretrodb_t *db,
+      libretrodb_key_index_t *idx, const char *path)
+{
+   uint64_t i;
+   libretrodb_key_index_header_t expected;
+   libretrodb_key_index_header_t header;
+   int64_t size;
+   RFILE *fd = filestream_open(path,
+         RETRO_VFS_FILE_ACCESS_READ,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!fd)
+      return false;
+
+   size = filestream_get_size(fd);
+
+   if (filestream_read(fd, &header, sizeof(header)) != sizeof(header))
+      goto error;
+
+   /* Everything but the entry count has to match */
+   idx->count = swap_if_little64(header.count);
+   libretrodb_key_index_fill_header(db, idx, &expected);
+
+   if (memcmp(&header, &expected, sizeof(header)))
+      goto error;
+   if (idx->count > db->count || size != (int64_t)(sizeof(header)
+            + idx->count * sizeof(struct libretrodb_key_index_entry)))
+      goto error;
+
+   if (idx->count)
+   {
+      size_t len    = (size_t)(idx->count
+            * sizeof(struct libretrodb_key_index_entry));
+
+      if (!(idx->entries = (struct libretrodb_key_index_entry*)malloc(len)))
+         goto error;
+      if (filestream_read(fd, idx->entries, len) != (int64_t)len)
+         goto error;
+
+      for (i = 0; i < idx->count; i++)
+      {
+         idx->entries[i].hash   = swap_if_little64(idx->entries[i].hash);
+         idx->entries[i].offset = swap_if_little64(idx->entries[i].offset);
+      }
+   }
+
+   filestream_close(fd);
+   return true;
+
+error:
+   if (idx->entries)
+      free(idx->entries);
+   idx->entries = NULL;
+   idx->count   = 0;
+   filestream_close(fd);
+   return false;
+}
+
+static void libretrodb_key_index_save(libretrodb_t *db,
+      const libretrodb_key_index_t *idx, const char *path)
+{
+   uint64_t i;
+   libretrodb_key_index_header_t header;
+   RFILE *fd = filestream_open(path,
+         RETRO_VFS_FILE_ACCESS_WRITE,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!fd)
+      return;
+
+   libretrodb_key_index_fill_header(db, idx, &header);
+   filestream_write(fd, &header, sizeof(header));
+
+   for (i = 0; i < idx->count; i++)
+   {
+      struct libretrodb_key_index_entry entry;
+      entry.hash   = swap_if_little64(idx->entries[i].hash);
+      entry.offset = swap_if_little64(idx->entries[i].offset);
+      filestream_write(fd, &entry, sizeof(entry));
+   }
+
+   filestream_close(fd);
+}
+
+static bool libretrodb_key_index_build(libretrodb_t *db,
+      libretrodb_key_index_t *idx)
+{
+   struct rmsgpack_dom_value item;
+   libretrodb_cursor_t cur = {0};
+   uint64_t capacity       = db->count;
+   bool ret                = false;
+
+   item.type               = RDT_NULL;
+
+   if (libretrodb_cursor_open(db, &cur, NULL) != 0)
+      return false;
+
+   if (capacity && !(idx->entries = (struct libretrodb_key_index_entry*)
+            malloc((size_t)capacity * sizeof(*idx->entries))))
+      goto end;
+
+   for (;;)
+   {
+      uint32_t len     = 0;
+      const char *key  = NULL;
+      uint64_t offset  = (uint64_t)filestream_tell(cur.fd);
+
+      if (libretrodb_cursor_read_item(&cur, &item) != 0)
+         break;
+
+      if ((key = libretrodb_key_index_field(&item, idx->field_name, &len))
+            && len)
+      {
+         /* The metadata count should be exact, but don't trust it */
+         if (idx->count == capacity)
+         {
+            struct libretrodb_key_index_entry *entries = NULL;
+            capacity = capacity ? capacity * 2 : 256;
+            if (!(entries = (struct libretrodb_key_index_entry*)realloc(
+                        idx->entries, (size_t)capacity * sizeof(*entries))))
+               goto end;
+            idx->entries = entries;
+         }
+
+         idx->entries[idx->count].hash   = libretrodb_key_hash(key, len);
+         idx->entries[idx->count].offset = offset;
+         idx->count++;
+      }
+
+      rmsgpack_dom_value_free(&item);
+      item.type = RDT_NULL;
+   }
+
+   if (idx->count)
+      qsort(idx->entries, (size_t)idx->count, sizeof(*idx->entries),
+            libretrodb_key_index_entry_compare);
+   ret = true;
+
+end:
+   rmsgpack_dom_value_free(&item);
+   libretrodb_cursor_close(&cur);
+   return ret;
+}
+
+/**
+ * libretrodb_key_index_new:
+ * @db                  : Handle to an open database.
+ * @field_name          : Field to index, e.g. "crc" or "serial".
+ * @cache_path          : Where to cache the index, or NULL.
+ *
+ * Loads the index of @field_name from @cache_path if it's
+ * there and still matches @db, otherwise walks the whole
+ * database once to build it and writes it to @cache_path.
+ *
+ * Returns: the index, or NULL on error.
+ **/
+libretrodb_key_index_t *libretrodb_key_index_new(libretrodb_t *db,
+      const char *field_name, const char *cache_path)
+{
+   libretrodb_key_index_t *idx = NULL;
+
+   if (!db || !db->fd || string_is_empty(field_name))
+      return NULL;
+
+   if (!(idx = (libretrodb_key_index_t*)calloc(1, sizeof(*idx))))
+      return NULL;
+
+   strlcpy(idx->field_name, field_name, sizeof(idx->field_name));
+
+   if (!string_is_empty(cache_path)
+         && libretrodb_key_index_load(db, idx, cache_path))
+      return idx;
+
+   if (!libretrodb_key_index_build(db, idx))
+   {
+      libretrodb_key_index_free(idx);
+      return NULL;
+   }
+
+   if (!string_is_empty(cache_path))
+      libretrodb_key_index_save(db, idx, cache_path);
+
+   return idx;
+}
+
+void libretrodb_key_index_free(libretrodb_key_index_t *idx)
+{
+   if (!idx)
+      return;
+
+   if (idx->entries)
+      free(idx->entries);
+   free(idx);
+}
+
+/* Index of the first entry whose hash is not below @hash */
+static size_t libretrodb_key_index_lower_bound(
+      const libretrodb_key_index_t *idx, uint64_t hash)
+{
+   size_t lo     = 0;
+   size_t hi     = (size_t)idx->count;
+
+   while (lo < hi)
+   {
+      size_t mid = lo + (hi - lo) / 2;
+      if (idx->entries[mid].hash < hash)
+         lo      = mid + 1;
+      else
+         hi      = mid;
+   }
+
+   return lo;
+}
+
+/**
+ * libretrodb_key_index_may_contain:
+ * @idx                 : Index to look in.
+ * @key                 : Value to look for.
+ * @len                 : Length of @key in bytes.
+ *
+ * Checks the index alone, without reading the database.
+ *
+ * Returns: false if no record has @key, true if one might.
+ **/
+bool libretrodb_key_index_may_contain(const libretrodb_key_index_t *idx,
+      const void *key, size_t len)
+{
+   uint64_t hash = libretrodb_key_hash(key, len);
+   size_t lo     = libretrodb_key_index_lower_bound(idx, hash);
+   return lo < idx->count && idx->entries[lo].hash == hash;
+}
+
+/**
+ * libretrodb_key_index_find:
+ * @db                  : Handle to the indexed database.
+ * @idx                 : Index of @db.
+ * @key                 : Value to look for.
+ * @len                 : Length of @key in bytes.
+ * @pos                 : Search position, set to 0 before the first call.
+ * @out                 : Record read from @db.
+ *
+ * Reads the next record whose indexed field equals @key.
+ * Call again with the same @pos to get further matches.
+ *
+ * Returns: 0 if a record was read into @out, EOF if
+ * there are no more matches, otherwise negative.
+ **/
+int libretrodb_key_index_find(libretrodb_t *db,
+      const libretrodb_key_index_t *idx, const void *key, size_t len,
+      size_t *pos, struct rmsgpack_dom_value *out)
+{
+   uint64_t hash = libretrodb_key_hash(key, len);
+   size_t lo     = libretrodb_key_index_lower_bound(idx, hash);
+
+   if (*pos < lo)
+      *pos = lo;
+
+   while (*pos < idx->count && idx->entries[*pos].hash == hash)
+   {
+      int rv;
+      uint32_t field_len = 0;
+      const char *field  = NULL;
+      uint64_t offset    = idx->entries[(*pos)++].offset;
+
+      if (filestream_seek(db->fd, (int64_t)offset,
+               RETRO_VFS_SEEK_POSITION_START) < 0)
+         return -1;
+
+      if ((rv = rmsgpack_dom_read(db->fd, out)) < 0)
+         return rv;
+
+      if (     (field = libretrodb_key_index_field(out,
+                  idx->field_name, &field_len))
+            && field_len == len
+            && !memcmp(field, key, len))
+         return 0;
+
+      rmsgpack_dom_value_free(out);
+   }
+
+   return EOF;
+}
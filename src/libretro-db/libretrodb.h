@@ -43,6 +43,8 @@ typedef struct libretrodb_cursor libretrodb_cursor_t;
 
 typedef struct libretrodb_index libretrodb_index_t;
 
+typedef struct libretrodb_key_index libretrodb_key_index_t;
+
 typedef int (*libretrodb_value_provider)(void *ctx, struct rmsgpack_dom_value *out);
 
 int libretrodb_create(RFILE *fd, libretrodb_value_provider value_provider, void *ctx);
@@ -105,6 +107,55 @@ void libretrodb_query_free(void *q);
 int libretrodb_cursor_read_item(libretrodb_cursor_t *cursor,
       struct rmsgpack_dom_value *out);
 
+/**
+ * libretrodb_key_index_new:
+ * @db                  : Handle to an open database.
+ * @field_name          : Field to index, e.g. "crc" or "serial".
+ * @cache_path          : Where to cache the index, or NULL.
+ *
+ * Loads the index of @field_name from @cache_path if it's
+ * there and still matches @db, otherwise walks the whole
+ * database once to build it and writes it to @cache_path.
+ *
+ * Returns: the index, or NULL on error.
+ **/
+libretrodb_key_index_t *libretrodb_key_index_new(libretrodb_t *db,
+      const char *field_name, const char *cache_path);
+
+void libretrodb_key_index_free(libretrodb_key_index_t *idx);
+
+/**
+ * libretrodb_key_index_may_contain:
+ * @idx                 : Index to look in.
+ * @key                 : Value to look for.
+ * @len                 : Length of @key in bytes.
+ *
+ * Checks the index alone, without reading the database.
+ *
+ * Returns: false if no record has @key, true if one might.
+ **/
+bool libretrodb_key_index_may_contain(const libretrodb_key_index_t *idx,
+      const void *key, size_t len);
+
+/**
+ * libretrodb_key_index_find:
+ * @db                  : Handle to the indexed database.
+ * @idx                 : Index of @db.
+ * @key                 : Value to look for.
+ * @len                 : Length of @key in bytes.
+ * @pos                 : Search position, set to 0 before the first call.
+ * @out                 : Record read from @db.
+ *
+ * Reads the next record whose indexed field equals @key.
+ * Call again with the same @pos to get further matches.
+ *
+ * Returns: 0 if a record was read into @out, EOF if
+ * there are no more matches, otherwise negative.
+ **/
+int libretrodb_key_index_find(libretrodb_t *db,
+      const libretrodb_key_index_t *idx, const void *key, size_t len,
+      size_t *pos, struct rmsgpack_dom_value *out);
+
 RETRO_END_DECLS
 
 #endif
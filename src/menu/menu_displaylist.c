@@ -2495,6 +2495,7 @@ static int menu_displaylist_parse_database_entry(menu_handle_t *menu,
    playlist_config.old_format          = settings->bools.playlist_use_old_format;
    playlist_config.compress            = settings->bools.playlist_compression;
    playlist_config.fuzzy_archive_match = settings->bools.playlist_fuzzy_archive_match;
+   playlist_config.binary_cache        = settings->bools.playlist_binary_cache;
    playlist_config_set_base_content_directory(&playlist_config, settings->bools.playlist_portable_paths ? settings->paths.directory_menu_content : NULL);
 
    database_info_build_query_enum(query, sizeof(query),
@@ -3291,6 +3292,7 @@ static void menu_displaylist_set_new_playlist(
    playlist_config.old_format          = settings->bools.playlist_use_old_format;
    playlist_config.compress            = settings->bools.playlist_compression;
    playlist_config.fuzzy_archive_match = settings->bools.playlist_fuzzy_archive_match;
+   playlist_config.binary_cache        = settings->bools.playlist_binary_cache;
    playlist_config_set_base_content_directory(&playlist_config, settings->bools.playlist_portable_paths ? settings->paths.directory_menu_content : NULL);
 
    menu->db_playlist_file[0]       = '\0';
@@ -6198,6 +6200,7 @@ unsigned menu_displaylist_build_list(
                {MENU_ENUM_LABEL_PLAYLIST_SORT_ALPHABETICAL,          PARSE_ONLY_BOOL, true},
                {MENU_ENUM_LABEL_PLAYLIST_USE_OLD_FORMAT,             PARSE_ONLY_BOOL, true},
                {MENU_ENUM_LABEL_PLAYLIST_COMPRESSION,                PARSE_ONLY_BOOL, true},
+               {MENU_ENUM_LABEL_PLAYLIST_BINARY_CACHE,               PARSE_ONLY_BOOL, true},
                {MENU_ENUM_LABEL_PLAYLIST_SHOW_INLINE_CORE_NAME,      PARSE_ONLY_UINT, true},
                {MENU_ENUM_LABEL_PLAYLIST_SHOW_HISTORY_ICONS,         PARSE_ONLY_UINT, true},
                {MENU_ENUM_LABEL_PLAYLIST_SHOW_ENTRY_IDX,             PARSE_ONLY_BOOL, true},
@@ -6206,6 +6209,9 @@ unsigned menu_displaylist_build_list(
                {MENU_ENUM_LABEL_PLAYLIST_SUBLABEL_LAST_PLAYED_STYLE, PARSE_ONLY_UINT, false},
                {MENU_ENUM_LABEL_PLAYLIST_FUZZY_ARCHIVE_MATCH,        PARSE_ONLY_BOOL, true},
                {MENU_ENUM_LABEL_SCAN_WITHOUT_CORE_MATCH,             PARSE_ONLY_BOOL, true},
+#ifdef HAVE_CHD
+               {MENU_ENUM_LABEL_SCAN_CHD_CACHE_SIZE,                 PARSE_ONLY_UINT, true},
+#endif
                {MENU_ENUM_LABEL_OZONE_TRUNCATE_PLAYLIST_NAME,        PARSE_ONLY_BOOL, true},
                {MENU_ENUM_LABEL_OZONE_SORT_AFTER_TRUNCATE_PLAYLIST_NAME, PARSE_ONLY_BOOL, false},
                {MENU_ENUM_LABEL_CONTENT_RUNTIME_LOG,                 PARSE_ONLY_BOOL, true},
@@ -9267,6 +9273,7 @@ unsigned menu_displaylist_build_list(
 #ifdef HAVE_RUNAHEAD
             bool runahead_supported       = true;
             bool runahead_enabled         = settings->bools.run_ahead_enabled;
+            bool runahead_adaptive        = settings->bools.run_ahead_adaptive;
             bool preempt_enabled          = settings->bools.preemptive_frames_enable;
 #endif
             menu_displaylist_build_info_selective_t build_list[] = {
@@ -9278,6 +9285,8 @@ unsigned menu_displaylist_build_list(
 #ifdef HAVE_RUNAHEAD
                {MENU_ENUM_LABEL_RUN_AHEAD_ENABLED,                     PARSE_ONLY_BOOL, false },
                {MENU_ENUM_LABEL_RUN_AHEAD_FRAMES,                      PARSE_ONLY_UINT, false },
+               {MENU_ENUM_LABEL_RUN_AHEAD_ADAPTIVE,                    PARSE_ONLY_BOOL, false },
+               {MENU_ENUM_LABEL_RUN_AHEAD_ADAPTIVE_BUDGET,             PARSE_ONLY_UINT, false },
                {MENU_ENUM_LABEL_RUN_AHEAD_SECONDARY_INSTANCE,          PARSE_ONLY_BOOL, false },
                {MENU_ENUM_LABEL_RUN_AHEAD_HIDE_WARNINGS,               PARSE_ONLY_BOOL, false },
                {MENU_ENUM_LABEL_PREEMPT_ENABLE,                        PARSE_ONLY_BOOL, false },
@@ -9340,11 +9349,16 @@ unsigned menu_displaylist_build_list(
                         build_list[i].checked = true;
                         break;
                      case MENU_ENUM_LABEL_RUN_AHEAD_FRAMES:
+                     case MENU_ENUM_LABEL_RUN_AHEAD_ADAPTIVE:
                      case MENU_ENUM_LABEL_RUN_AHEAD_SECONDARY_INSTANCE:
                      case MENU_ENUM_LABEL_RUN_AHEAD_HIDE_WARNINGS:
                         if (runahead_enabled)
                            build_list[i].checked = true;
                         break;
+                     case MENU_ENUM_LABEL_RUN_AHEAD_ADAPTIVE_BUDGET:
+                        if (runahead_enabled && runahead_adaptive)
+                           build_list[i].checked = true;
+                        break;
                      case MENU_ENUM_LABEL_PREEMPT_FRAMES:
                      case MENU_ENUM_LABEL_PREEMPT_HIDE_WARNINGS:
                         if (preempt_enabled)
@@ -9649,6 +9663,7 @@ unsigned menu_displaylist_build_list(
                {MENU_ENUM_LABEL_SORT_SAVESTATES_BY_CONTENT_ENABLE,  PARSE_ONLY_BOOL, true},
                {MENU_ENUM_LABEL_BLOCK_SRAM_OVERWRITE,               PARSE_ONLY_BOOL, true},
                {MENU_ENUM_LABEL_AUTOSAVE_INTERVAL,                  PARSE_ONLY_UINT, true},
+               {MENU_ENUM_LABEL_AUTOSAVE_JOURNAL,                   PARSE_ONLY_BOOL, true},
                {MENU_ENUM_LABEL_SAVESTATE_AUTO_INDEX,               PARSE_ONLY_BOOL, true},
                {MENU_ENUM_LABEL_SAVESTATE_MAX_KEEP,                 PARSE_ONLY_UINT, false},
                {MENU_ENUM_LABEL_SAVESTATE_AUTO_SAVE,                PARSE_ONLY_BOOL, true},
@@ -10288,6 +10303,8 @@ unsigned menu_displaylist_build_list(
                {MENU_ENUM_LABEL_REWIND_GRANULARITY,      PARSE_ONLY_UINT, false},
                {MENU_ENUM_LABEL_REWIND_BUFFER_SIZE,      PARSE_ONLY_SIZE, false},
                {MENU_ENUM_LABEL_REWIND_BUFFER_SIZE_STEP, PARSE_ONLY_UINT, false},
+               {MENU_ENUM_LABEL_REWIND_THREADED,         PARSE_ONLY_BOOL, false},
+               {MENU_ENUM_LABEL_REWIND_TIERED,           PARSE_ONLY_BOOL, false},
             };
 
             for (i = 0; i < ARRAY_SIZE(build_list); i++)
@@ -10297,6 +10314,8 @@ unsigned menu_displaylist_build_list(
                   case MENU_ENUM_LABEL_REWIND_GRANULARITY:
                   case MENU_ENUM_LABEL_REWIND_BUFFER_SIZE:
                   case MENU_ENUM_LABEL_REWIND_BUFFER_SIZE_STEP:
+                  case MENU_ENUM_LABEL_REWIND_THREADED:
+                  case MENU_ENUM_LABEL_REWIND_TIERED:
                      if (rewind_enable)
                         build_list[i].checked = true;
                      break;
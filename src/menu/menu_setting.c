@@ -8743,6 +8743,10 @@ static void runahead_change_handler(rarch_setting_t *setting)
             command_event(CMD_EVENT_CHEATS_APPLY, NULL);
 #endif
          break;
+      case MENU_ENUM_LABEL_RUN_AHEAD_ADAPTIVE:
+         /* Budget is only listed while adaptive mode is on */
+         menu_entries_ctl(MENU_ENTRIES_CTL_SET_REFRESH, &refresh);
+         break;
       default:
          break;
    }
@@ -11063,6 +11067,23 @@ static bool setting_append_list(
             SETTINGS_DATA_LIST_CURRENT_ADD_FLAGS(list, list_info, SD_FLAG_CMD_APPLY_AUTO);
             (*list)[list_info->index - 1].get_string_representation =
                &setting_get_string_representation_uint_autosave_interval;
+
+            CONFIG_BOOL(
+                  list, list_info,
+                  &settings->bools.autosave_journal,
+                  MENU_ENUM_LABEL_AUTOSAVE_JOURNAL,
+                  MENU_ENUM_LABEL_VALUE_AUTOSAVE_JOURNAL,
+                  DEFAULT_AUTOSAVE_JOURNAL,
+                  MENU_ENUM_LABEL_VALUE_OFF,
+                  MENU_ENUM_LABEL_VALUE_ON,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler,
+                  SD_FLAG_NONE);
+            MENU_SETTINGS_LIST_CURRENT_ADD_CMD(list, list_info, CMD_EVENT_AUTOSAVE_INIT);
+            SETTINGS_DATA_LIST_CURRENT_ADD_FLAGS(list, list_info, SD_FLAG_CMD_APPLY_AUTO);
 #endif
             CONFIG_BOOL(
                   list, list_info,
@@ -11174,6 +11195,23 @@ static bool setting_append_list(
                   general_read_handler,
                   SD_FLAG_NONE);
 
+#ifdef HAVE_CHD
+            CONFIG_UINT(
+                  list, list_info,
+                  &settings->uints.scan_chd_cache_size,
+                  MENU_ENUM_LABEL_SCAN_CHD_CACHE_SIZE,
+                  MENU_ENUM_LABEL_VALUE_SCAN_CHD_CACHE_SIZE,
+                  DEFAULT_SCAN_CHD_CACHE_SIZE,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler);
+            (*list)[list_info->index - 1].action_ok = &setting_action_ok_uint;
+            menu_settings_list_current_add_range(list, list_info, 1, 256, 1, true, true);
+            SETTINGS_DATA_LIST_CURRENT_ADD_FLAGS(list, list_info, SD_FLAG_ADVANCED);
+#endif
+
             END_SUB_GROUP(list, list_info, parent_group);
             END_GROUP(list, list_info, parent_group);
          }
@@ -11304,6 +11342,38 @@ static bool setting_append_list(
             (*list)[list_info->index - 1].offset_by     = 1;
             menu_settings_list_current_add_range(list, list_info, 1, 100, 1, true, true);
 
+#ifdef HAVE_THREADS
+            CONFIG_BOOL(
+                  list, list_info,
+                  &settings->bools.rewind_threaded,
+                  MENU_ENUM_LABEL_REWIND_THREADED,
+                  MENU_ENUM_LABEL_VALUE_REWIND_THREADED,
+                  DEFAULT_REWIND_THREADED,
+                  MENU_ENUM_LABEL_VALUE_OFF,
+                  MENU_ENUM_LABEL_VALUE_ON,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler,
+                  SD_FLAG_NONE);
+#endif
+
+            CONFIG_BOOL(
+                  list, list_info,
+                  &settings->bools.rewind_tiered,
+                  MENU_ENUM_LABEL_REWIND_TIERED,
+                  MENU_ENUM_LABEL_VALUE_REWIND_TIERED,
+                  DEFAULT_REWIND_TIERED,
+                  MENU_ENUM_LABEL_VALUE_OFF,
+                  MENU_ENUM_LABEL_VALUE_ON,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler,
+                  SD_FLAG_NONE);
+
          END_SUB_GROUP(list, list_info, parent_group);
          END_GROUP(list, list_info, parent_group);
          break;
@@ -14927,6 +14997,37 @@ static bool setting_append_list(
          (*list)[list_info->index - 1].change_handler = runahead_change_handler;
          menu_settings_list_current_add_range(list, list_info, 1, MAX_RUNAHEAD_FRAMES, 1, true, true);
 
+         CONFIG_BOOL(
+               list, list_info,
+               &settings->bools.run_ahead_adaptive,
+               MENU_ENUM_LABEL_RUN_AHEAD_ADAPTIVE,
+               MENU_ENUM_LABEL_VALUE_RUN_AHEAD_ADAPTIVE,
+               DEFAULT_RUN_AHEAD_ADAPTIVE,
+               MENU_ENUM_LABEL_VALUE_OFF,
+               MENU_ENUM_LABEL_VALUE_ON,
+               &group_info,
+               &subgroup_info,
+               parent_group,
+               general_write_handler,
+               general_read_handler,
+               SD_FLAG_NONE
+               );
+         (*list)[list_info->index - 1].change_handler = runahead_change_handler;
+
+         CONFIG_UINT(
+            list, list_info,
+            &settings->uints.run_ahead_adaptive_budget,
+            MENU_ENUM_LABEL_RUN_AHEAD_ADAPTIVE_BUDGET,
+            MENU_ENUM_LABEL_VALUE_RUN_AHEAD_ADAPTIVE_BUDGET,
+            DEFAULT_RUN_AHEAD_ADAPTIVE_BUDGET,
+            &group_info,
+            &subgroup_info,
+            parent_group,
+            general_write_handler,
+            general_read_handler);
+         (*list)[list_info->index - 1].action_ok = &setting_action_ok_uint;
+         menu_settings_list_current_add_range(list, list_info, 10, 90, 5, true, true);
+
 #if defined(HAVE_DYNAMIC) || defined(HAVE_DYLIB)
          CONFIG_BOOL(
                list, list_info,
@@ -19936,6 +20037,22 @@ static bool setting_append_list(
                );
 #endif
 
+         CONFIG_BOOL(
+               list, list_info,
+               &settings->bools.playlist_binary_cache,
+               MENU_ENUM_LABEL_PLAYLIST_BINARY_CACHE,
+               MENU_ENUM_LABEL_VALUE_PLAYLIST_BINARY_CACHE,
+               DEFAULT_PLAYLIST_BINARY_CACHE,
+               MENU_ENUM_LABEL_VALUE_OFF,
+               MENU_ENUM_LABEL_VALUE_ON,
+               &group_info,
+               &subgroup_info,
+               parent_group,
+               general_write_handler,
+               general_read_handler,
+               SD_FLAG_NONE
+               );
+
          CONFIG_BOOL(
                list, list_info,
                &settings->bools.playlist_show_sublabels,
@@ -555,6 +555,7 @@ enum msg_hash_enums
    MENU_LABEL(MENU_XMB_ANIMATION_MOVE_UP_DOWN),
    MENU_LABEL(MENU_XMB_ANIMATION_OPENING_MAIN_MENU),
    MENU_LABEL(SCAN_WITHOUT_CORE_MATCH),
+   MENU_LABEL(SCAN_CHD_CACHE_SIZE),
    MENU_LABEL(STREAMING_TITLE),
    MENU_LABEL(STREAMING_MODE),
    MENU_ENUM_LABEL_VALUE_VIDEO_STREAMING_MODE_TWITCH,
@@ -2127,6 +2128,8 @@ enum msg_hash_enums
    MENU_LABEL(REWIND_GRANULARITY),
    MENU_LABEL(REWIND_BUFFER_SIZE),
    MENU_LABEL(REWIND_BUFFER_SIZE_STEP),
+   MENU_LABEL(REWIND_THREADED),
+   MENU_LABEL(REWIND_TIERED),
    /* TODO/FIXME: INPUT_META_REWIND is incorrectly defined;
     * the LABEL/SUBLABEL enums should be entered 'manually',
     * like all the other hotkeys. Moreover, the resultant
@@ -2323,6 +2326,7 @@ enum msg_hash_enums
    MENU_LABEL(FRONTEND_LOG_LEVEL),
    MENU_LBL_H(LIBRETRO_LOG_LEVEL),
    MENU_LBL_H(AUTOSAVE_INTERVAL),
+   MENU_LABEL(AUTOSAVE_JOURNAL),
    MENU_LBL_H(CONFIG_SAVE_ON_EXIT),
    MENU_LABEL(REMAP_SAVE_ON_EXIT),
    MENU_LABEL(CONFIGURATION_LIST),
@@ -2513,6 +2517,8 @@ enum msg_hash_enums
    MENU_LABEL(RUN_AHEAD_SECONDARY_INSTANCE),
    MENU_LABEL(RUN_AHEAD_HIDE_WARNINGS),
    MENU_LABEL(RUN_AHEAD_FRAMES),
+   MENU_LABEL(RUN_AHEAD_ADAPTIVE),
+   MENU_LABEL(RUN_AHEAD_ADAPTIVE_BUDGET),
    MENU_LABEL(PREEMPT_UNSUPPORTED),
    MENU_LABEL(PREEMPT_ENABLE),
    MENU_LABEL(PREEMPT_FRAMES),
@@ -3809,6 +3815,7 @@ enum msg_hash_enums
 
    MENU_LABEL(PLAYLIST_USE_OLD_FORMAT),
    MENU_LABEL(PLAYLIST_COMPRESSION),
+   MENU_LABEL(PLAYLIST_BINARY_CACHE),
    MENU_LABEL(MENU_SOUNDS),
    MENU_LABEL(MENU_SOUND_OK),
    MENU_LABEL(MENU_SOUND_CANCEL),
@@ -0,0 +1,196 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *  Copyright (C) 2016-2017 - Gregor Richards
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include <retro_endianness.h>
+#include <encodings/crc32.h>
+
+#include "netplay_delta.h"
+
+/* A delta is a list of changed blocks, each one a big-endian
+ * header holding the block number (plus NETPLAY_DELTA_BLOCK_XOR),
+ * followed by the block. Blocks that aren't listed are the
+ * same as in the base state. */
+
+size_t netplay_delta_num_blocks(size_t state_size)
+{
+   return (state_size + NETPLAY_DELTA_BLOCK_SIZE - 1)
+      / NETPLAY_DELTA_BLOCK_SIZE;
+}
+
+size_t netplay_delta_max_size(size_t state_size)
+{
+   return state_size
+      + netplay_delta_num_blocks(state_size) * sizeof(uint32_t);
+}
+
+static size_t netplay_delta_block_len(size_t state_size, size_t block)
+{
+   size_t offset = block * NETPLAY_DELTA_BLOCK_SIZE;
+   size_t len    = state_size - offset;
+   if (len > NETPLAY_DELTA_BLOCK_SIZE)
+      len = NETPLAY_DELTA_BLOCK_SIZE;
+   return len;
+}
+
+void netplay_delta_hash_blocks(const void *state, size_t state_size,
+      uint32_t *hashes)
+{
+   size_t i;
+   size_t num_blocks  = netplay_delta_num_blocks(state_size);
+   const uint8_t *src = (const uint8_t*)state;
+
+   for (i = 0; i < num_blocks; i++)
+      hashes[i] = encoding_crc32(0L,
+            src + i * NETPLAY_DELTA_BLOCK_SIZE,
+            netplay_delta_block_len(state_size, i));
+}
+
+size_t netplay_delta_encode(const void *state, const void *base,
+      const uint32_t *peer_hashes, size_t state_size, uint8_t *out)
+{
+   size_t i, j;
+   size_t num_blocks  = netplay_delta_num_blocks(state_size);
+   const uint8_t *src = (const uint8_t*)state;
+   const uint8_t *ref = (const uint8_t*)base;
+   uint8_t *dst       = out;
+
+   for (i = 0; i < num_blocks; i++)
+   {
+      uint32_t header;
+      size_t offset = i * NETPLAY_DELTA_BLOCK_SIZE;
+      size_t len    = netplay_delta_block_len(state_size, i);
+
+      /* The peer already has this block */
+      if (encoding_crc32(0L, src + offset, len) == peer_hashes[i])
+         continue;
+
+      header = (uint32_t)i;
+      if (ref && encoding_crc32(0L, ref + offset, len) == peer_hashes[i])
+      {
+         header |= NETPLAY_DELTA_BLOCK_XOR;
+         for (j = 0; j < len; j++)
+            dst[sizeof(header) + j] = src[offset + j] ^ ref[offset + j];
+      }
+      else
+         memcpy(dst + sizeof(header), src + offset, len);
+
+      header = swap_if_little32(header);
+      memcpy(dst, &header, sizeof(header));
+      dst   += sizeof(header) + len;
+   }
+
+   return (size_t)(dst - out);
+}
+
+bool netplay_delta_decode(void *state, const void *base,
+      size_t state_size, const uint8_t *delta, size_t delta_size)
+{
+   size_t j;
+   size_t num_blocks  = netplay_delta_num_blocks(state_size);
+   uint8_t *dst       = (uint8_t*)state;
+   const uint8_t *end = delta + delta_size;
+
+   memcpy(state, base, state_size);
+
+   while (delta < end)
+   {
+      uint32_t header;
+      size_t block, offset, len;
+
+      if ((size_t)(end - delta) < sizeof(header))
+         return false;
+      memcpy(&header, delta, sizeof(header));
+      header = swap_if_little32(header);
+      delta += sizeof(header);
+
+      block  = header & ~NETPLAY_DELTA_BLOCK_XOR;
+      if (block >= num_blocks)
+         return false;
+      offset = block * NETPLAY_DELTA_BLOCK_SIZE;
+      len    = netplay_delta_block_len(state_size, block);
+      if ((size_t)(end - delta) < len)
+         return false;
+
+      if (header & NETPLAY_DELTA_BLOCK_XOR)
+      {
+         for (j = 0; j < len; j++)
+            dst[offset + j] ^= delta[j];
+      }
+      else
+         memcpy(dst + offset, delta, len);
+
+      delta += len;
+   }
+
+   return true;
+}
+
+size_t netplay_delta_request_size(size_t state_size)
+{
+   return (1 + netplay_delta_num_blocks(state_size)) * sizeof(uint32_t);
+}
+
+bool netplay_delta_write_request(netplay_delta_base_t *base,
+      const void *state, size_t state_size, uint32_t frame,
+      uint32_t *payload)
+{
+   size_t i;
+   size_t num_blocks = netplay_delta_num_blocks(state_size);
+
+   if (base->valid)
+      return false;
+
+   memcpy(base->state, state, state_size);
+   base->frame = frame;
+   base->valid = true;
+
+   payload[0]  = swap_if_little32(frame);
+   netplay_delta_hash_blocks(base->state, state_size, payload + 1);
+   for (i = 1; i <= num_blocks; i++)
+      payload[i] = swap_if_little32(payload[i]);
+
+   return true;
+}
+
+const uint32_t *netplay_delta_read_request(uint32_t *payload,
+      size_t state_size, uint32_t *frame)
+{
+   size_t i;
+   size_t num_blocks = netplay_delta_num_blocks(state_size);
+
+   for (i = 0; i <= num_blocks; i++)
+      payload[i] = swap_if_little32(payload[i]);
+
+   *frame = payload[0];
+   return payload + 1;
+}
+
+bool netplay_delta_base_matches(const netplay_delta_base_t *base,
+      uint32_t frame)
+{
+   return base->valid && base->frame == frame;
+}
+
+bool netplay_delta_apply(netplay_delta_base_t *base, void *state,
+      size_t state_size, const uint8_t *delta, size_t delta_size)
+{
+   base->valid = false;
+   return netplay_delta_decode(state, base->state, state_size,
+         delta, delta_size);
+}
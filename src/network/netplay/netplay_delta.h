@@ -0,0 +1,179 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *  Copyright (C) 2016-2017 - Gregor Richards
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __RARCH_NETPLAY_DELTA_H
+#define __RARCH_NETPLAY_DELTA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <boolean.h>
+#include <retro_common_api.h>
+
+RETRO_BEGIN_DECLS
+
+/* Savestates are compared in blocks of this size */
+#define NETPLAY_DELTA_BLOCK_SIZE 4096
+
+/* Set in a block header if the block is XORed against the
+ * base state rather than sent as is */
+#define NETPLAY_DELTA_BLOCK_XOR  (1U << 31)
+
+/* The client's copy of the frame it sent the block hashes of,
+ * which the delta the server answers with is applied to */
+typedef struct netplay_delta_base
+{
+   uint8_t *state;
+   uint32_t frame;
+   /* Set while a request with hashes is outstanding */
+   bool valid;
+} netplay_delta_base_t;
+
+/**
+ * netplay_delta_num_blocks
+ * @state_size           : size of the savestate
+ *
+ * Returns: the number of blocks in a savestate of this size.
+ */
+size_t netplay_delta_num_blocks(size_t state_size);
+
+/**
+ * netplay_delta_max_size
+ * @state_size           : size of the savestate
+ *
+ * Returns: the largest delta that can be encoded for a savestate
+ * of this size, i.e. every block plus its header.
+ */
+size_t netplay_delta_max_size(size_t state_size);
+
+/**
+ * netplay_delta_hash_blocks
+ * @state                : the savestate
+ * @state_size           : size of the savestate
+ * @hashes               : receives netplay_delta_num_blocks() hashes
+ *
+ * Hashes every block of a savestate.
+ */
+void netplay_delta_hash_blocks(const void *state, size_t state_size,
+      uint32_t *hashes);
+
+/**
+ * netplay_delta_encode
+ * @state                : the savestate to send
+ * @base                 : our copy of the frame the peer hashed, or NULL
+ * @peer_hashes          : the peer's block hashes of that frame
+ * @state_size           : size of the savestate
+ * @out                  : receives the delta, netplay_delta_max_size() bytes
+ *
+ * Encodes the blocks of @state that the peer doesn't have. Blocks of
+ * @base that the peer's hashes agree with are known to both sides,
+ * so the blocks that replace them are XORed against them. Any other
+ * changed blocks are sent as they are.
+ *
+ * Returns: the size of the delta.
+ */
+size_t netplay_delta_encode(const void *state, const void *base,
+      const uint32_t *peer_hashes, size_t state_size, uint8_t *out);
+
+/**
+ * netplay_delta_decode
+ * @state                : receives the savestate
+ * @base                 : the frame we sent the hashes of
+ * @state_size           : size of the savestate
+ * @delta                : the delta
+ * @delta_size           : size of the delta
+ *
+ * Rebuilds a savestate from our base frame and a delta.
+ *
+ * Returns: false if the delta is malformed.
+ */
+bool netplay_delta_decode(void *state, const void *base,
+      size_t state_size, const uint8_t *delta, size_t delta_size);
+
+/**
+ * netplay_delta_request_size
+ * @state_size           : size of the savestate
+ *
+ * Returns: the payload size of a savestate request with block
+ * hashes, i.e. the frame followed by one hash per block.
+ */
+size_t netplay_delta_request_size(size_t state_size);
+
+/**
+ * netplay_delta_write_request
+ * @base                 : the client's delta base
+ * @state                : the client's (wrong) savestate
+ * @state_size           : size of the savestate
+ * @frame                : the frame @state belongs to
+ * @payload              : receives netplay_delta_request_size() bytes
+ *
+ * Keeps a copy of @state in @base and writes the payload of a
+ * savestate request with its block hashes, in network byte order.
+ * The server answers every such request with a delta, so only one
+ * may be outstanding at a time.
+ *
+ * Returns: false if a request with hashes is still outstanding.
+ */
+bool netplay_delta_write_request(netplay_delta_base_t *base,
+      const void *state, size_t state_size, uint32_t frame,
+      uint32_t *payload);
+
+/**
+ * netplay_delta_read_request
+ * @payload              : the payload of a savestate request,
+ *                         netplay_delta_request_size() bytes
+ * @state_size           : size of the savestate
+ * @frame                : receives the frame the client hashed
+ *
+ * Converts a savestate request with block hashes to host byte
+ * order, in place.
+ *
+ * Returns: the client's block hashes, within @payload.
+ */
+const uint32_t *netplay_delta_read_request(uint32_t *payload,
+      size_t state_size, uint32_t *frame);
+
+/**
+ * netplay_delta_base_matches
+ * @base                 : the client's delta base
+ * @frame                : the base frame a delta names
+ *
+ * Returns: true if a delta against @frame answers our outstanding
+ * request.
+ */
+bool netplay_delta_base_matches(const netplay_delta_base_t *base,
+      uint32_t frame);
+
+/**
+ * netplay_delta_apply
+ * @base                 : the client's delta base
+ * @state                : receives the savestate
+ * @state_size           : size of the savestate
+ * @delta                : the delta
+ * @delta_size           : size of the delta
+ *
+ * Rebuilds a savestate from the base frame and a delta, which
+ * completes the outstanding request either way.
+ *
+ * Returns: false if the delta is malformed.
+ */
+bool netplay_delta_apply(netplay_delta_base_t *base, void *state,
+      size_t state_size, const uint8_t *delta, size_t delta_size);
+
+RETRO_END_DECLS
+
+#endif
@@ -38,6 +38,7 @@
 #include <encodings/base64.h>
 #include <features/features_cpu.h>
 #include <lrc_hash.h>
+#include <memalign.h>
 
 #ifdef HAVE_IFINFO
 #include <net/net_ifinfo.h>
@@ -76,6 +77,10 @@
 #endif
 
 #include "netplay_private.h"
+#include "netplay_delta.h"
+
+#define XXH_INLINE_ALL
+#include "../../deps/xxHash/xxhash.h"
 
 #ifdef TCP_NODELAY
 #define SET_TCP_NODELAY(fd) \
@@ -1058,6 +1063,10 @@ bool netplay_handshake_init(netplay_t *netplay,
    if (compression == -1)
       return false;
    connection->compression_supported = (uint32_t)compression;
+   if (ntohl(header[2]) & NETPLAY_COMPRESSION_DELTA)
+      connection->flags |= NETPLAY_CONN_FLAG_DELTA_STATE;
+   if (ntohl(header[2]) & NETPLAY_COMPRESSION_XXHASH)
+      connection->flags |= NETPLAY_CONN_FLAG_XXHASH;
 
    if (!netplay->is_server)
    {
@@ -1998,12 +2007,17 @@ bool netplay_delta_frame_ready(netplay_t *netplay, struct delta_frame *delta,
 
 /**
  * netplay_delta_frame_crc
+ * @xxhash               : true if the peer takes XXH3 hashes
  *
- * Get the CRC for the serialization of this frame.
+ * Get the hash for the serialization of this frame: the low half of its
+ * XXH3 hash, which is many times faster to compute, or its CRC-32 for
+ * peers that don't support it.
  */
 static uint32_t netplay_delta_frame_crc(netplay_t *netplay,
-      struct delta_frame *delta)
+      struct delta_frame *delta, bool xxhash)
 {
+   if (xxhash)
+      return (uint32_t)XXH3_64bits(delta->state, netplay->state_size);
    return encoding_crc32(0L, (const unsigned char*)delta->state,
          netplay->state_size);
 }
@@ -2033,11 +2047,8 @@ static void netplay_delta_frame_free(struct delta_frame *delta)
 {
    uint32_t i;
 
-   if (delta->state)
-   {
-      free(delta->state);
-      delta->state = NULL;
-   }
+   /* The state belongs to the state pool */
+   delta->state = NULL;
 
    for (i = 0; i < MAX_INPUT_DEVICES; i++)
    {
@@ -2532,43 +2543,81 @@ static bool netplay_banned(netplay_t *netplay, int fd, netplay_address_t *addr)
 /**
  * netplay_cmd_crc
  *
- * Send a CRC command to all active clients.
+ * Send a CRC command to all active clients. Each kind of hash is only
+ * computed if some client takes it.
  */
 static bool netplay_cmd_crc(netplay_t *netplay, struct delta_frame *delta)
 {
    size_t i;
    uint32_t payload[2];
-   bool success = true;
+   uint32_t crc[2];
+   bool have_crc[2] = {false, false};
+   bool success     = true;
 
    payload[0]   = htonl(delta->frame);
-   payload[1]   = htonl(delta->crc);
 
    for (i = 0; i < netplay->connections_size; i++)
    {
-      if (     (netplay->connections[i].flags & NETPLAY_CONN_FLAG_ACTIVE)
-            && (netplay->connections[i].mode >= NETPLAY_CONNECTION_CONNECTED))
-         success = netplay_send_raw_cmd(netplay, &netplay->connections[i],
-            NETPLAY_CMD_CRC, payload, sizeof(payload)) && success;
+      struct netplay_connection *connection = &netplay->connections[i];
+      int xxhash;
+
+      if (     !(connection->flags & NETPLAY_CONN_FLAG_ACTIVE)
+            ||  (connection->mode < NETPLAY_CONNECTION_CONNECTED))
+         continue;
+
+      xxhash = (connection->flags & NETPLAY_CONN_FLAG_XXHASH) ? 1 : 0;
+      if (!have_crc[xxhash])
+      {
+         crc[xxhash]      = netplay->state_size ?
+            netplay_delta_frame_crc(netplay, delta, xxhash == 1) : 0;
+         have_crc[xxhash] = true;
+      }
+
+      payload[1] = htonl(crc[xxhash]);
+      success    = netplay_send_raw_cmd(netplay, connection,
+         NETPLAY_CMD_CRC, payload, sizeof(payload)) && success;
    }
    return success;
 }
 
 /**
  * netplay_cmd_request_savestate
+ * @delta                : the frame that failed its CRC check
  *
- * Send a savestate request command.
+ * Send a savestate request command. If the server supports it, the block
+ * hashes of our (wrong) state for that frame go with it, so that it only
+ * has to send the blocks we got wrong.
  */
-static bool netplay_cmd_request_savestate(netplay_t *netplay)
+static bool netplay_cmd_request_savestate(netplay_t *netplay,
+      struct delta_frame *delta)
 {
+   uint32_t *payload;
+   struct netplay_connection *connection = &netplay->connections[0];
+
    if (     (netplay->connections_size == 0)
-       || (!(netplay->connections[0].flags & NETPLAY_CONN_FLAG_ACTIVE))
-       ||   (netplay->connections[0].mode  < NETPLAY_CONNECTION_CONNECTED))
+       || (!(connection->flags & NETPLAY_CONN_FLAG_ACTIVE))
+       ||   (connection->mode  < NETPLAY_CONNECTION_CONNECTED))
       return false;
-   if (netplay->savestate_request_outstanding)
+   /* The server answers every request with hashes with a delta, even if
+    * a full state (or reset) got to us first, so only one may be
+    * outstanding at a time. */
+   if (netplay->savestate_request_outstanding || netplay->delta_base.valid)
       return true;
    netplay->savestate_request_outstanding = true;
-   return netplay_send_raw_cmd(netplay, &netplay->connections[0],
-      NETPLAY_CMD_REQUEST_SAVESTATE, NULL, 0);
+
+   if (     !(connection->flags & NETPLAY_CONN_FLAG_DELTA_STATE)
+         || !delta || !delta->state || !netplay->delta_base.state)
+      return netplay_send_raw_cmd(netplay, connection,
+         NETPLAY_CMD_REQUEST_SAVESTATE, NULL, 0);
+
+   /* Keeps the frame around, the delta will be applied to it */
+   payload = (uint32_t*)netplay->delta_buffer;
+   netplay_delta_write_request(&netplay->delta_base, delta->state,
+      netplay->state_size, delta->frame, payload);
+
+   return netplay_send_raw_cmd(netplay, connection,
+      NETPLAY_CMD_REQUEST_SAVESTATE, payload,
+      netplay_delta_request_size(netplay->state_size));
 }
 
 /**
@@ -3061,11 +3110,7 @@ static void netplay_handle_frame_hash(netplay_t *netplay,
    if (netplay->is_server)
    {
       if (netplay->check_frames && (delta->frame % netplay->check_frames) == 0)
-      {
-         delta->crc = netplay->state_size ?
-            netplay_delta_frame_crc(netplay, delta) : 0;
          netplay_cmd_crc(netplay, delta);
-      }
    }
    else
    {
@@ -3073,7 +3118,9 @@ static void netplay_handle_frame_hash(netplay_t *netplay,
       {
          /* We have a remote CRC, so check it. */
          uint32_t local_crc = netplay->state_size ?
-            netplay_delta_frame_crc(netplay, delta) : 0;
+            netplay_delta_frame_crc(netplay, delta,
+               (netplay->connections[0].flags & NETPLAY_CONN_FLAG_XXHASH)
+               != 0) : 0;
 
          if (local_crc != delta->crc)
          {
@@ -3086,7 +3133,7 @@ static void netplay_handle_frame_hash(netplay_t *netplay,
             }
 
             if (netplay->check_frames)
-               netplay_cmd_request_savestate(netplay);
+               netplay_cmd_request_savestate(netplay, delta);
             else
                RARCH_WARN("[Netplay] Netplay CRCs mismatch!\n");
          }
@@ -3749,6 +3796,7 @@ static void netplay_sync_post_frame(netplay_t *netplay, bool stalled)
        netplay->replay_frame_count < netplay->run_frame_count)
    {
       retro_ctx_serialize_info_t serial_info;
+      bool loaded;
 
       /* Replay frames. */
       netplay->is_replay = true;
@@ -3778,7 +3826,7 @@ static void netplay_sync_post_frame(netplay_t *netplay, bool stalled)
       serial_info.data       = NULL;
       serial_info.data_const = netplay->buffer[netplay->replay_ptr].state;
       serial_info.size       = netplay->state_size;
-      if (!core_unserialize_special(&serial_info))
+      if (!(loaded = core_unserialize_special(&serial_info)))
          RARCH_ERR("[Netplay] Netplay savestate loading failed: Prepare for desync!\n");
 
       while (netplay->replay_frame_count < netplay->run_frame_count)
@@ -3792,9 +3840,14 @@ static void netplay_sync_post_frame(netplay_t *netplay, bool stalled)
 
          start                   = cpu_features_get_time_usec();
 
-         /* Remember the current state */
-         memset(serial_info.data, 0, serial_info.size);
-         core_serialize_special(&serial_info);
+         /* Remember the current state, unless it's the one we just
+          * loaded, which is already there */
+         if (!loaded)
+         {
+            memset(serial_info.data, 0, serial_info.size);
+            core_serialize_special(&serial_info);
+         }
+         loaded = false;
 
          if (netplay->replay_frame_count < netplay->unread_frame_count)
             netplay_handle_frame_hash(netplay, ptr);
@@ -3815,7 +3868,7 @@ static void netplay_sync_post_frame(netplay_t *netplay, bool stalled)
 #ifdef DEBUG_NONDETERMINISTIC_CORES
          if (ptr->have_remote && netplay_delta_frame_ready(netplay, &netplay->buffer[netplay->replay_ptr], netplay->replay_frame_count))
          {
-            RARCH_LOG("PRE  %u: %X\n", netplay->replay_frame_count-1, netplay->state_size ? netplay_delta_frame_crc(netplay, ptr) : 0);
+            RARCH_LOG("PRE  %u: %X\n", netplay->replay_frame_count-1, netplay->state_size ? netplay_delta_frame_crc(netplay, ptr, false) : 0);
             if (netplay->is_server)
                RARCH_LOG("INP  %X %X\n", ptr->real_input_state[0], ptr->self_state[0]);
             else
@@ -3826,7 +3879,7 @@ static void netplay_sync_post_frame(netplay_t *netplay, bool stalled)
             memset(serial_info.data, 0, serial_info.size);
             core_serialize_special(&serial_info);
 
-            RARCH_LOG("POST %u: %X\n", netplay->replay_frame_count-1, netplay->state_size ? netplay_delta_frame_crc(netplay, ptr) : 0);
+            RARCH_LOG("POST %u: %X\n", netplay->replay_frame_count-1, netplay->state_size ? netplay_delta_frame_crc(netplay, ptr, false) : 0);
          }
 #endif
 
@@ -4076,10 +4129,14 @@ static void netplay_hangup(netplay_t *netplay,
    connection->flags &= ~NETPLAY_CONN_FLAG_ACTIVE;
    netplay_deinit_socket_buffer(&connection->send_packet_buffer);
    netplay_deinit_socket_buffer(&connection->recv_packet_buffer);
+   free(connection->delta_request);
+   connection->delta_request = NULL;
+   connection->delta_hashes  = NULL;
 
    if (!netplay->is_server)
    {
       netplay->self_mode = NETPLAY_CONNECTION_NONE;
+      netplay->delta_base.valid = false;
       netplay->connected_players &= (1L<<netplay->self_client_num);
       for (i = 0; i < MAX_CLIENTS; i++)
       {
@@ -5757,11 +5814,13 @@ static bool netplay_get_cmd(netplay_t *netplay,
                uint32_t local_crc = 0;
                if (netplay->state_size)
                   local_crc       = netplay_delta_frame_crc(
-                        netplay, &netplay->buffer[tmp_ptr]);
+                        netplay, &netplay->buffer[tmp_ptr],
+                        (connection->flags & NETPLAY_CONN_FLAG_XXHASH) != 0);
 
                /* Problem! */
                if (buffer[1] != local_crc)
-                  netplay_cmd_request_savestate(netplay);
+                  netplay_cmd_request_savestate(netplay,
+                     &netplay->buffer[tmp_ptr]);
             }
             else
             {
@@ -5773,20 +5832,58 @@ static bool netplay_get_cmd(netplay_t *netplay,
          }
 
       case NETPLAY_CMD_REQUEST_SAVESTATE:
+         if (cmd_size)
+         {
+            /* The frame the client got wrong and its block hashes */
+            size_t request_size =
+               netplay_delta_request_size(netplay->state_size);
+
+            if (!netplay->is_server)
+            {
+               RARCH_ERR("[Netplay] NETPLAY_CMD_REQUEST_SAVESTATE with hashes from server.\n");
+               return netplay_cmd_nak(netplay, connection);
+            }
+
+            if (cmd_size != request_size)
+            {
+               RARCH_ERR("[Netplay] Received invalid payload size for NETPLAY_CMD_REQUEST_SAVESTATE.\n");
+               return netplay_cmd_nak(netplay, connection);
+            }
+
+            if (!connection->delta_request)
+            {
+               connection->delta_request = (uint32_t*)malloc(request_size);
+               if (!connection->delta_request)
+                  return false;
+            }
+
+            RECV(connection->delta_request, request_size)
+               return false;
+
+            connection->delta_hashes = netplay_delta_read_request(
+               connection->delta_request, netplay->state_size,
+               &connection->delta_frame);
+            connection->flags       |= NETPLAY_CONN_FLAG_DELTA_REQUEST;
+         }
+
          /* Delay until next frame so we don't send the savestate after the
           * input */
          netplay->force_send_savestate = true;
          break;
 
       case NETPLAY_CMD_LOAD_SAVESTATE:
+      case NETPLAY_CMD_LOAD_SAVESTATE_DELTA:
          {
             uint32_t i;
             uint32_t frame;
             uint32_t state_size, state_size_raw;
+            uint32_t base_frame = 0;
             size_t   load_ptr;
+            size_t   header_size;
             uint32_t load_frame_count;
             uint32_t rd, wn;
             struct compression_transcoder *ctrans = NULL;
+            bool is_delta = (cmd == NETPLAY_CMD_LOAD_SAVESTATE_DELTA);
 
             if (netplay->is_server)
             {
@@ -5794,7 +5891,12 @@ static bool netplay_get_cmd(netplay_t *netplay,
                return netplay_cmd_nak(netplay, connection);
             }
 
-            if (cmd_size < sizeof(frame) + sizeof(state_size))
+            /* A delta also names the frame it applies to */
+            header_size = sizeof(frame) + sizeof(state_size);
+            if (is_delta)
+               header_size += sizeof(base_frame);
+
+            if (cmd_size < header_size)
             {
                RARCH_ERR("[Netplay] Received invalid payload size for NETPLAY_CMD_LOAD_SAVESTATE.\n");
                return netplay_cmd_nak(netplay, connection);
@@ -5856,7 +5958,7 @@ static bool netplay_get_cmd(netplay_t *netplay,
             RECV(&state_size, sizeof(state_size))
                return false;
             state_size     = ntohl(state_size);
-            state_size_raw = cmd_size - (sizeof(frame) + sizeof(state_size));
+            state_size_raw = cmd_size - (uint32_t)header_size;
 
             if (state_size != netplay->state_size ||
                   state_size_raw > netplay->zbuffer_size)
@@ -5865,6 +5967,22 @@ static bool netplay_get_cmd(netplay_t *netplay,
                return netplay_cmd_nak(netplay, connection);
             }
 
+            if (is_delta)
+            {
+               RECV(&base_frame, sizeof(base_frame))
+                  return false;
+               base_frame = ntohl(base_frame);
+
+               /* We only ever have one request with hashes outstanding,
+                * so this must be the answer to it */
+               if (!netplay_delta_base_matches(&netplay->delta_base,
+                        base_frame))
+               {
+                  RARCH_ERR("[Netplay] Netplay state delta for a frame we didn't ask for.\n");
+                  return netplay_cmd_nak(netplay, connection);
+               }
+            }
+
             RECV(netplay->zbuffer, state_size_raw)
                return false;
 
@@ -5881,12 +5999,33 @@ static bool netplay_get_cmd(netplay_t *netplay,
             ctrans->decompression_backend->set_in(
                ctrans->decompression_stream,
                netplay->zbuffer, state_size_raw);
-            ctrans->decompression_backend->set_out(
-               ctrans->decompression_stream,
-               (uint8_t*)netplay->buffer[load_ptr].state, state_size);
-            ctrans->decompression_backend->trans(
-               ctrans->decompression_stream,
-               true, &rd, &wn, NULL);
+
+            if (is_delta)
+            {
+               ctrans->decompression_backend->set_out(
+                  ctrans->decompression_stream,
+                  netplay->delta_buffer,
+                  (uint32_t)netplay->delta_buffer_size);
+               if (     !ctrans->decompression_backend->trans(
+                           ctrans->decompression_stream,
+                           true, &rd, &wn, NULL)
+                     || !netplay_delta_apply(&netplay->delta_base,
+                           netplay->buffer[load_ptr].state, state_size,
+                           netplay->delta_buffer, wn))
+               {
+                  RARCH_ERR("[Netplay] Received a corrupt netplay state delta.\n");
+                  return netplay_cmd_nak(netplay, connection);
+               }
+            }
+            else
+            {
+               ctrans->decompression_backend->set_out(
+                  ctrans->decompression_stream,
+                  (uint8_t*)netplay->buffer[load_ptr].state, state_size);
+               ctrans->decompression_backend->trans(
+                  ctrans->decompression_stream,
+                  true, &rd, &wn, NULL);
+            }
 
             /* Force a rewind to the relevant frame. */
             netplay->force_rewind = true;
@@ -6739,7 +6878,7 @@ static bool netplay_init_socket_buffers(netplay_t *netplay)
 
 static bool netplay_init_serialization(netplay_t *netplay)
 {
-   size_t i;
+   size_t i, stride;
    retro_ctx_size_info_t info = {0};
 
    if (netplay->state_size)
@@ -6750,12 +6889,17 @@ static bool netplay_init_serialization(netplay_t *netplay)
       return false;
    netplay->state_size = info.size;
 
+   /* One cache line aligned block for every frame's state, rather than
+    * an allocation each */
+   stride              = (netplay->state_size + 63) & ~(size_t)63;
+   netplay->state_pool = (uint8_t*)memalign_alloc(64,
+         stride * netplay->buffer_size);
+   if (!netplay->state_pool)
+      return false;
+   memset(netplay->state_pool, 0, stride * netplay->buffer_size);
+
    for (i = 0; i < netplay->buffer_size; i++)
-   {
-      netplay->buffer[i].state = calloc(1, netplay->state_size);
-      if (!netplay->buffer[i].state)
-         return false;
-   }
+      netplay->buffer[i].state = netplay->state_pool + i * stride;
 
    netplay->zbuffer_size    = netplay->state_size * 2;
    netplay->zbuffer         = (uint8_t*)calloc(1, netplay->zbuffer_size);
@@ -6765,6 +6909,21 @@ static bool netplay_init_serialization(netplay_t *netplay)
       return false;
    }
 
+   netplay->delta_buffer_size = netplay_delta_max_size(netplay->state_size);
+   netplay->delta_buffer      = (uint8_t*)malloc(netplay->delta_buffer_size);
+   if (!netplay->delta_buffer)
+   {
+      netplay->delta_buffer_size = 0;
+      return false;
+   }
+
+   if (!netplay->is_server)
+   {
+      netplay->delta_base.state = (uint8_t*)malloc(netplay->state_size);
+      if (!netplay->delta_base.state)
+         return false;
+   }
+
    return true;
 }
 
@@ -6894,6 +7053,8 @@ static void netplay_free(netplay_t *netplay)
          netplay_deinit_socket_buffer(&connection->send_packet_buffer);
          netplay_deinit_socket_buffer(&connection->recv_packet_buffer);
       }
+
+      free(connection->delta_request);
    }
 
    free(netplay->connections);
@@ -6907,7 +7068,10 @@ static void netplay_free(netplay_t *netplay)
       free(netplay->buffer);
    }
 
+   memalign_free(netplay->state_pool);
    free(netplay->zbuffer);
+   free(netplay->delta_buffer);
+   free(netplay->delta_base.state);
 
    if (netplay->compress_nil.compression_stream)
       netplay->compress_nil.compression_backend->stream_free(
@@ -7060,42 +7224,104 @@ failure:
 }
 
 /**
- * netplay_send_savestate
+ * netplay_send_savestate_delta
  * @netplay              : pointer to netplay object
+ * @connection           : client that sent block hashes with its request
  * @serial_info          : the savestate being loaded
- * @cx                   : compression type
  * @z                    : compression backend to use
  *
- * Send a loaded savestate to those connected peers using the given compression
- * scheme.
+ * Send a savestate to a client as the blocks that differ from the frame it
+ * sent the hashes of. If we still have our own state for that frame, the
+ * blocks the client got right are XORed against it, which leaves mostly
+ * zeroes for the compressor.
+ *
+ * Returns true on success, false on failure.
  */
-static void netplay_send_savestate(netplay_t *netplay,
-   retro_ctx_serialize_info_t *serial_info, uint32_t cx,
+static bool netplay_send_savestate_delta(netplay_t *netplay,
+   struct netplay_connection *connection,
+   retro_ctx_serialize_info_t *serial_info,
    struct compression_transcoder *z)
 {
-   uint32_t header[4];
+   uint32_t header[5];
    uint32_t rd, wn;
    size_t i;
+   size_t delta_size;
+   const void *base = NULL;
+
+   if (connection->delta_frame <= netplay->run_frame_count)
+   {
+      for (i = 0; i < netplay->buffer_size; i++)
+      {
+         struct delta_frame *delta = &netplay->buffer[i];
+         if (     delta->used
+               && delta->frame == connection->delta_frame)
+         {
+            base = delta->state;
+            break;
+         }
+      }
+   }
+
+   delta_size = netplay_delta_encode(serial_info->data_const, base,
+      connection->delta_hashes, netplay->state_size, netplay->delta_buffer);
 
    /* Compress it */
    z->compression_backend->set_in(z->compression_stream,
-      (const uint8_t*)serial_info->data_const, (uint32_t)serial_info->size);
+      netplay->delta_buffer, (uint32_t)delta_size);
    z->compression_backend->set_out(z->compression_stream,
       netplay->zbuffer, (uint32_t)netplay->zbuffer_size);
    if (!z->compression_backend->trans(z->compression_stream, true, &rd,
          &wn, NULL))
-   {
-      /* Catastrophe! */
-      for (i = 0; i < netplay->connections_size; i++)
-         netplay_hangup(netplay, &netplay->connections[i]);
-      return;
-   }
+      return false;
 
-   /* Send it to relevant peers */
-   header[0] = htonl(NETPLAY_CMD_LOAD_SAVESTATE);
-   header[1] = htonl(wn + 2*sizeof(uint32_t));
+   header[0] = htonl(NETPLAY_CMD_LOAD_SAVESTATE_DELTA);
+   header[1] = htonl(wn + 3*sizeof(uint32_t));
    header[2] = htonl(netplay->run_frame_count);
    header[3] = htonl(serial_info->size);
+   header[4] = htonl(connection->delta_frame);
+
+   return netplay_send(&connection->send_packet_buffer, connection->fd,
+            header, sizeof(header))
+       && netplay_send(&connection->send_packet_buffer, connection->fd,
+            netplay->zbuffer, wn);
+}
+
+/**
+ * netplay_send_savestate
+ * @netplay              : pointer to netplay object
+ * @serial_info          : the savestate being loaded
+ * @cx                   : compression type
+ * @z                    : compression backend to use
+ *
+ * Send a loaded savestate to those connected peers using the given compression
+ * scheme. Clients that sent block hashes with their request get a delta, the
+ * full state is only compressed if anyone else needs it.
+ */
+static void netplay_send_savestate(netplay_t *netplay,
+   retro_ctx_serialize_info_t *serial_info, uint32_t cx,
+   struct compression_transcoder *z)
+{
+   uint32_t header[4];
+   uint32_t rd, wn;
+   size_t i;
+   bool compressed = false;
+
+   /* Deltas first, as they share zbuffer with the full state */
+   for (i = 0; i < netplay->connections_size; i++)
+   {
+      struct netplay_connection *connection = &netplay->connections[i];
+      if (  (!(connection->flags & NETPLAY_CONN_FLAG_ACTIVE)) 
+          ||  (connection->mode  < NETPLAY_CONNECTION_CONNECTED)
+          ||  (connection->compression_supported != cx)
+          || !(connection->flags & NETPLAY_CONN_FLAG_DELTA_REQUEST))
+         continue;
+
+      if (serial_info->size != netplay->state_size)
+         connection->flags &= ~NETPLAY_CONN_FLAG_DELTA_REQUEST;
+      else if (!netplay_send_savestate_delta(netplay, connection,
+            serial_info, z))
+         netplay_hangup(netplay, connection);
+   }
 
    for (i = 0; i < netplay->connections_size; i++)
    {
@@ -7105,6 +7331,37 @@ static void netplay_send_savestate(netplay_t *netplay,
           ||  (connection->compression_supported != cx))
          continue;
 
+      if (connection->flags & NETPLAY_CONN_FLAG_DELTA_REQUEST)
+      {
+         connection->flags &= ~NETPLAY_CONN_FLAG_DELTA_REQUEST;
+         continue;
+      }
+
+      if (!compressed)
+      {
+         /* Compress it */
+         z->compression_backend->set_in(z->compression_stream,
+            (const uint8_t*)serial_info->data_const,
+            (uint32_t)serial_info->size);
+         z->compression_backend->set_out(z->compression_stream,
+            netplay->zbuffer, (uint32_t)netplay->zbuffer_size);
+         if (!z->compression_backend->trans(z->compression_stream, true,
+               &rd, &wn, NULL))
+         {
+            /* Catastrophe! */
+            for (i = 0; i < netplay->connections_size; i++)
+               netplay_hangup(netplay, &netplay->connections[i]);
+            return;
+         }
+
+         header[0]  = htonl(NETPLAY_CMD_LOAD_SAVESTATE);
+         header[1]  = htonl(wn + 2*sizeof(uint32_t));
+         header[2]  = htonl(netplay->run_frame_count);
+         header[3]  = htonl(serial_info->size);
+         compressed = true;
+      }
+
+      /* Send it to relevant peers */
       if (!netplay_send(&connection->send_packet_buffer, connection->fd, header,
             sizeof(header)) ||
           !netplay_send(&connection->send_packet_buffer, connection->fd,
@@ -20,6 +20,7 @@
 
 #include "netplay.h"
 #include "netplay_protocol.h"
+#include "netplay_delta.h"
 
 #include <libretro.h>
 
@@ -72,11 +73,16 @@
 #define NETPLAY_QUIRK_PLATFORM_DEPENDENT (1 << 2)
 
 /* Compression protocols supported */
-#define NETPLAY_COMPRESSION_ZLIB (1<<0)
+#define NETPLAY_COMPRESSION_ZLIB  (1<<0)
+/* Not a protocol of its own: savestates may be sent as block deltas
+ * (NETPLAY_CMD_LOAD_SAVESTATE_DELTA), compressed with either of them */
+#define NETPLAY_COMPRESSION_DELTA (1<<1)
+/* Nor is this: frame hashes (NETPLAY_CMD_CRC) may be XXH3 rather than CRC-32 */
+#define NETPLAY_COMPRESSION_XXHASH (1<<2)
 #if HAVE_ZLIB
-#define NETPLAY_COMPRESSION_SUPPORTED NETPLAY_COMPRESSION_ZLIB
+#define NETPLAY_COMPRESSION_SUPPORTED (NETPLAY_COMPRESSION_ZLIB | NETPLAY_COMPRESSION_DELTA | NETPLAY_COMPRESSION_XXHASH)
 #else
-#define NETPLAY_COMPRESSION_SUPPORTED 0
+#define NETPLAY_COMPRESSION_SUPPORTED (NETPLAY_COMPRESSION_DELTA | NETPLAY_COMPRESSION_XXHASH)
 #endif
 
 /* The keys supported by netplay */
@@ -162,6 +168,10 @@ enum netplay_cmd
    /* Sends over cheats enabled on client (unsupported) */
    NETPLAY_CMD_CHEATS         = 0x0047,
 
+   /* Send a savestate for the client to load, as the blocks that differ
+    * from the frame it sent the hashes of in its savestate request */
+   NETPLAY_CMD_LOAD_SAVESTATE_DELTA = 0x0048,
+
    /* Misc. commands */
 
    /* Sends multiple config requests over,
@@ -306,7 +316,7 @@ struct delta_frame
 
    uint32_t frame;
 
-   /* The CRC-32 of the serialized state if we've calculated it, else 0 */
+   /* The hash of the serialized state if we've calculated it, else 0 */
    uint32_t crc;
 
    /* Have we read local input? */
@@ -348,7 +358,14 @@ enum netplay_connection_flags
    /* Is this connection allowed to play (server only)? */
    NETPLAY_CONN_FLAG_CAN_PLAY       = (1 << 2),
    /* Did we request a ping response? */
-   NETPLAY_CONN_FLAG_PING_REQUESTED = (1 << 3)
+   NETPLAY_CONN_FLAG_PING_REQUESTED = (1 << 3),
+   /* Does this peer support savestate deltas? */
+   NETPLAY_CONN_FLAG_DELTA_STATE    = (1 << 4),
+   /* Has this client sent block hashes with its savestate request
+    * (server only)? */
+   NETPLAY_CONN_FLAG_DELTA_REQUEST  = (1 << 5),
+   /* Are our frame hashes XXH3 rather than CRC-32? */
+   NETPLAY_CONN_FLAG_XXHASH         = (1 << 6)
 };
 
 /* Each connection gets a connection struct */
@@ -364,12 +381,20 @@ struct netplay_connection
    struct socket_buffer send_packet_buffer;
    struct socket_buffer recv_packet_buffer;
 
+   /* The savestate request with block hashes this client sent
+    * (server only), and the hashes within it */
+   uint32_t *delta_request;
+   const uint32_t *delta_hashes;
+
    /* What compression does this peer support? */
    uint32_t compression_supported;
 
    /* Salt associated with password transaction */
    uint32_t salt;
 
+   /* The frame delta_hashes belong to */
+   uint32_t delta_frame;
+
    /* Which netplay protocol is this connection running? */
    uint32_t netplay_protocol;
 
@@ -503,12 +528,23 @@ struct netplay
 
    struct delta_frame *buffer;
 
+   /* The states of every frame in the buffer, in one aligned block */
+   uint8_t *state_pool;
+
    /* A buffer into which to compress frames for transfer */
    uint8_t *zbuffer;
 
+   /* A buffer for savestate deltas before compression */
+   uint8_t *delta_buffer;
+
+   /* For the client: A copy of the frame we last sent block
+    * hashes of, to apply a savestate delta to */
+   netplay_delta_base_t delta_base;
+
    size_t connections_size;
    size_t buffer_size;
    size_t zbuffer_size;
+   size_t delta_buffer_size;
    /* The size of our packet buffers */
    size_t packet_buffer_size;
    /* Size of savestates */
@@ -19,6 +19,10 @@
 #include <string.h>
 #include <ctype.h>
 
+#if defined(_WIN32) && !defined(_XBOX) || defined(__unix__) || defined(__APPLE__) || defined(__HAIKU__)
+#include <sys/stat.h>
+#endif
+
 #include <libretro.h>
 #include <boolean.h>
 #include <retro_miscellaneous.h>
@@ -30,6 +34,21 @@
 #include <lists/string_list.h>
 #include <formats/rjson.h>
 #include <array/rbuf.h>
+#include <array/rhmap.h>
+#include <encodings/crc32.h>
+#include <streams/file_stream.h>
+
+#ifdef HAVE_MMAP
+#include <memmap.h>
+#endif
+
+#if defined(HAVE_MMAP) && defined(HAVE_MMAN)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#define XXH_INLINE_ALL
+#include "deps/xxHash/xxhash.h"
 
 #include "playlist.h"
 #include "verbosity.h"
@@ -68,6 +87,17 @@ typedef struct
    bool filter_dat_content;
 } playlist_manual_scan_record_t;
 
+/* Value of the path index, keyed by the
+ * real path hash of playlist entries */
+typedef struct
+{
+   /* Number of entries with this hash */
+   uint32_t count;
+   /* Rank of the topmost one,
+    * see playlist_path_index_find() */
+   uint32_t rank;
+} playlist_path_index_t;
+
 struct content_playlist
 {
    char *default_core_path;
@@ -76,6 +106,19 @@ struct content_playlist
 
    struct playlist_entry *entries;
 
+   /* Secondary index of 'entries', built on first
+    * use and dropped whenever entries are moved */
+   playlist_path_index_t *path_index;
+   /* Entry counts by parent archive hash, only
+    * needed to tell if fuzzy matching could apply */
+   uint32_t *archive_index;
+   uint32_t index_rank;
+
+   /* Contents of the binary cache the playlist was
+    * loaded from, entry strings point into it */
+   uint8_t *cache_data;
+   size_t cache_size;
+
    playlist_manual_scan_record_t scan_record; /* ptr alignment */
    playlist_config_t config;                  /* size_t alignment */
 
@@ -88,6 +131,8 @@ struct content_playlist
    bool old_format;
    bool compressed;
    bool cached_external;
+   bool index_valid;
+   bool cache_mapped;
 };
 
 typedef struct
@@ -177,6 +222,7 @@ bool playlist_config_copy(const playlist_config_t *src,
    dst->old_format          = src->old_format;
    dst->compress            = src->compress;
    dst->fuzzy_archive_match = src->fuzzy_archive_match;
+   dst->binary_cache        = src->binary_cache;
    dst->autofix_paths       = src->autofix_paths;
 
    return true;
@@ -571,33 +617,43 @@ void playlist_get_index(playlist_t *playlist,
    *entry = &playlist->entries[idx];
 }
 
+/* Frees an entry string, unless it belongs
+ * to the binary cache the playlist was loaded from */
+static void playlist_free_str(playlist_t *playlist, char *str)
+{
+   if (!str)
+      return;
+
+   if (     playlist->cache_data
+         && (uintptr_t)str >= (uintptr_t)playlist->cache_data
+         && (uintptr_t)str <  (uintptr_t)playlist->cache_data
+            + playlist->cache_size)
+      return;
+
+   free(str);
+}
+
 /**
  * playlist_free_entry:
+ * @playlist            : Playlist handle.
  * @entry               : Playlist entry handle.
  *
  * Frees playlist entry.
  **/
-static void playlist_free_entry(struct playlist_entry *entry)
+static void playlist_free_entry(playlist_t *playlist,
+      struct playlist_entry *entry)
 {
    if (!entry)
       return;
 
-   if (entry->path)
-      free(entry->path);
-   if (entry->label)
-      free(entry->label);
-   if (entry->core_path)
-      free(entry->core_path);
-   if (entry->core_name)
-      free(entry->core_name);
-   if (entry->db_name)
-      free(entry->db_name);
-   if (entry->crc32)
-      free(entry->crc32);
-   if (entry->subsystem_ident)
-      free(entry->subsystem_ident);
-   if (entry->subsystem_name)
-      free(entry->subsystem_name);
+   playlist_free_str(playlist, entry->path);
+   playlist_free_str(playlist, entry->label);
+   playlist_free_str(playlist, entry->core_path);
+   playlist_free_str(playlist, entry->core_name);
+   playlist_free_str(playlist, entry->db_name);
+   playlist_free_str(playlist, entry->crc32);
+   playlist_free_str(playlist, entry->subsystem_ident);
+   playlist_free_str(playlist, entry->subsystem_name);
    if (entry->runtime_str)
       free(entry->runtime_str);
    if (entry->last_played_str)
@@ -632,6 +688,264 @@ static void playlist_free_entry(struct playlist_entry *entry)
    entry->last_played_second = 0;
 }
 
+/* Path index
+ *
+ * Finding an entry by path used to mean comparing
+ * against every entry in the playlist, which makes
+ * scanning content into a large playlist quadratic.
+ * The index maps the real path hash of every entry
+ * to the number of entries having it, and to the
+ * position of the topmost one. Positions are stored
+ * as ranks counted from the bottom of the playlist,
+ * so pushing to the top (the common case) leaves
+ * the other entries alone. Deleting or bumping an
+ * entry only adjusts the ranks on the shorter side
+ * of it, and anything else invalidates the index so
+ * it gets rebuilt on next use. A stale rank is also
+ * detected and triggers a rebuild, so the index can
+ * never give a wrong answer, only a slow one. */
+
+static bool playlist_fuzzy_archive_match(const playlist_config_t *config)
+{
+#ifdef RARCH_INTERNAL
+   return config->fuzzy_archive_match;
+#else
+   return true;
+#endif
+}
+
+static void playlist_path_index_free(playlist_t *playlist)
+{
+   RHMAP_FREE(playlist->path_index);
+   RHMAP_FREE(playlist->archive_index);
+   playlist->index_rank  = 0;
+   playlist->index_valid = false;
+}
+
+static void playlist_path_index_add(playlist_t *playlist,
+      const playlist_path_id_t *path_id, uint32_t rank)
+{
+   ptrdiff_t idx;
+
+   if (!path_id)
+      return;
+
+   if (path_id->real_path_hash)
+   {
+      if ((idx = RHMAP_IDX(playlist->path_index,
+                  path_id->real_path_hash)) < 0)
+      {
+         playlist_path_index_t val;
+         val.count = 1;
+         val.rank  = rank;
+         RHMAP_SET(playlist->path_index, path_id->real_path_hash, val);
+      }
+      else
+      {
+         playlist->path_index[idx].count++;
+         playlist->path_index[idx].rank = rank;
+      }
+   }
+
+   if (path_id->archive_path_hash)
+   {
+      if ((idx = RHMAP_IDX(playlist->archive_index,
+                  path_id->archive_path_hash)) < 0)
+         RHMAP_SET(playlist->archive_index, path_id->archive_path_hash, 1);
+      else
+         playlist->archive_index[idx]++;
+   }
+}
+
+/* Adds 'delta' to the ranks of entries
+ * 'start' to 'end' (excluded) */
+static void playlist_path_index_shift(playlist_t *playlist,
+      size_t start, size_t end, int delta)
+{
+   size_t i;
+
+   for (i = start; i < end; i++)
+   {
+      ptrdiff_t idx;
+      const playlist_path_id_t *path_id = playlist->entries[i].path_id;
+
+      /* Ranks only matter for unique hashes */
+      if (     path_id
+            && path_id->real_path_hash
+            && (idx = RHMAP_IDX(playlist->path_index,
+                  path_id->real_path_hash)) >= 0
+            && playlist->path_index[idx].count == 1)
+         playlist->path_index[idx].rank += delta;
+   }
+}
+
+/* Must be called before entry 'pos' is deleted */
+static void playlist_path_index_delete(playlist_t *playlist, size_t pos)
+{
+   ptrdiff_t idx;
+   size_t len                        = RBUF_LEN(playlist->entries);
+   const playlist_path_id_t *path_id = playlist->entries[pos].path_id;
+
+   if (!playlist->index_valid)
+      return;
+
+   if (path_id)
+   {
+      if (     path_id->real_path_hash
+            && (idx = RHMAP_IDX(playlist->path_index,
+                  path_id->real_path_hash)) >= 0)
+      {
+         if (--playlist->path_index[idx].count == 0)
+            (void)RHMAP_DEL(playlist->path_index, path_id->real_path_hash);
+      }
+
+      if (     path_id->archive_path_hash
+            && (idx = RHMAP_IDX(playlist->archive_index,
+                  path_id->archive_path_hash)) >= 0)
+      {
+         if (--playlist->archive_index[idx] == 0)
+            (void)RHMAP_DEL(playlist->archive_index, path_id->archive_path_hash);
+      }
+   }
+
+   /* Entries below move up one position */
+   if (pos < len - 1 - pos)
+   {
+      playlist_path_index_shift(playlist, 0, pos, -1);
+      playlist->index_rank--;
+   }
+   else
+      playlist_path_index_shift(playlist, pos + 1, len, 1);
+}
+
+/* Must be called before entry 'pos' is moved to the top */
+static void playlist_path_index_bump(playlist_t *playlist, size_t pos)
+{
+   ptrdiff_t idx;
+   size_t len                        = RBUF_LEN(playlist->entries);
+   const playlist_path_id_t *path_id = playlist->entries[pos].path_id;
+
+   if (!playlist->index_valid)
+      return;
+
+   /* Entries above move down one position */
+   if (pos <= len - 1 - pos)
+      playlist_path_index_shift(playlist, 0, pos, -1);
+   else
+   {
+      playlist_path_index_shift(playlist, pos + 1, len, 1);
+      playlist->index_rank++;
+   }
+
+   if (     path_id
+         && path_id->real_path_hash
+         && (idx = RHMAP_IDX(playlist->path_index,
+               path_id->real_path_hash)) >= 0)
+      playlist->path_index[idx].rank = playlist->index_rank - 1;
+}
+
+static void playlist_path_index_build(playlist_t *playlist)
+{
+   size_t i;
+   size_t len = RBUF_LEN(playlist->entries);
+
+   playlist_path_index_free(playlist);
+
+   /* Bottom to top, so that the topmost entry
+    * of each hash is the last one recorded */
+   for (i = len; i-- > 0;)
+   {
+      struct playlist_entry *entry = &playlist->entries[i];
+
+      if (!entry->path_id)
+         entry->path_id = playlist_path_id_init(entry->path);
+
+      playlist_path_index_add(playlist, entry->path_id,
+            (uint32_t)(len - 1 - i));
+   }
+
+   playlist->index_rank  = (uint32_t)len;
+   playlist->index_valid = true;
+}
+
+/* Must be called right after 'path_id' has
+ * been pushed as the new top entry */
+static void playlist_path_index_push(playlist_t *playlist,
+      const playlist_path_id_t *path_id)
+{
+   if (playlist->index_valid)
+      playlist_path_index_add(playlist, path_id, playlist->index_rank++);
+}
+
+/**
+ * playlist_path_index_find:
+ * @playlist          : Playlist handle
+ * @path_id           : Path identity to search for
+ * @pos               : Position of the only entry that
+ *                      can match 'path_id', or size of
+ *                      the playlist if there is none
+ *
+ * Returns 'true' if the index could narrow the search
+ * down to at most one entry. Returns 'false' if every
+ * entry has to be checked; this happens when several
+ * entries share the same path hash, when fuzzy archive
+ * matching could apply, or for empty paths.
+ **/
+static bool playlist_path_index_find(playlist_t *playlist,
+      const playlist_path_id_t *path_id, size_t *pos)
+{
+   size_t len = RBUF_LEN(playlist->entries);
+   unsigned tries;
+
+   if (string_is_empty(path_id->real_path) || !path_id->real_path_hash)
+      return false;
+
+   for (tries = 0; tries < 2; tries++)
+   {
+      ptrdiff_t idx;
+      size_t i;
+
+      if (!playlist->index_valid)
+         playlist_path_index_build(playlist);
+
+      if (     path_id->archive_path_hash
+            && playlist_fuzzy_archive_match(&playlist->config)
+            && RHMAP_HAS(playlist->archive_index,
+               path_id->archive_path_hash))
+         return false;
+
+      if ((idx = RHMAP_IDX(playlist->path_index,
+                  path_id->real_path_hash)) < 0)
+      {
+         *pos = len;
+         return true;
+      }
+
+      if (playlist->path_index[idx].count > 1)
+         return false;
+
+      i = playlist->index_rank - 1 - playlist->path_index[idx].rank;
+
+      if (i < len)
+      {
+         const struct playlist_entry *entry = &playlist->entries[i];
+
+         if (     entry->path_id
+               && entry->path_id->real_path_hash == path_id->real_path_hash)
+         {
+            *pos = i;
+            return true;
+         }
+      }
+
+      /* Entries were moved without the index
+       * being told, start over */
+      playlist->index_valid = false;
+   }
+
+   return false;
+}
+
 /**
  * playlist_delete_index:
  * @playlist            : Playlist handle.
@@ -652,10 +966,12 @@ void playlist_delete_index(playlist_t *playlist,
    if (idx >= len)
       return;
 
+   playlist_path_index_delete(playlist, idx);
+
    /* Free unwanted entry */
    entry_to_delete = (struct playlist_entry *)(playlist->entries + idx);
    if (entry_to_delete)
-      playlist_free_entry(entry_to_delete);
+      playlist_free_entry(playlist, entry_to_delete);
 
    /* Shift remaining entries to fill the gap */
    memmove(playlist->entries + idx, playlist->entries + idx + 1,
@@ -686,6 +1002,17 @@ void playlist_delete_by_path(playlist_t *playlist,
    if (!(path_id = playlist_path_id_init(search_path)))
       return;
 
+   if (playlist_path_index_find(playlist, path_id, &i))
+   {
+      if (     i < RBUF_LEN(playlist->entries)
+            && playlist_path_matches_entry(path_id,
+               &playlist->entries[i], &playlist->config))
+         playlist_delete_index(playlist, i);
+
+      playlist_path_id_free(path_id);
+      return;
+   }
+
    while (i < RBUF_LEN(playlist->entries))
    {
       if (!playlist_path_matches_entry(path_id,
@@ -718,7 +1045,19 @@ void playlist_get_index_by_path(playlist_t *playlist,
    if (!(path_id = playlist_path_id_init(search_path)))
       return;
 
-   for (i = 0, len = RBUF_LEN(playlist->entries); i < len; i++)
+   len = RBUF_LEN(playlist->entries);
+
+   if (playlist_path_index_find(playlist, path_id, &i))
+   {
+      if (i < len && playlist_path_matches_entry(path_id,
+               &playlist->entries[i], &playlist->config))
+         *entry = &playlist->entries[i];
+
+      playlist_path_id_free(path_id);
+      return;
+   }
+
+   for (i = 0; i < len; i++)
    {
       if (!playlist_path_matches_entry(path_id,
             &playlist->entries[i], &playlist->config))
@@ -743,7 +1082,17 @@ bool playlist_entry_exists(playlist_t *playlist,
    if (!(path_id = playlist_path_id_init(path)))
       return false;
 
-   for (i = 0, len = RBUF_LEN(playlist->entries); i < len; i++)
+   len = RBUF_LEN(playlist->entries);
+
+   if (playlist_path_index_find(playlist, path_id, &i))
+   {
+      bool exists = i < len && playlist_path_matches_entry(path_id,
+            &playlist->entries[i], &playlist->config);
+      playlist_path_id_free(path_id);
+      return exists;
+   }
+
+   for (i = 0; i < len; i++)
    {
       if (playlist_path_matches_entry(path_id,
             &playlist->entries[i], &playlist->config))
@@ -769,8 +1118,7 @@ void playlist_update(playlist_t *playlist, size_t idx,
 
    if (update_entry->path && (update_entry->path != entry->path))
    {
-      if (entry->path)
-         free(entry->path);
+      playlist_free_str(playlist, entry->path);
       entry->path        = strdup(update_entry->path);
 
       if (entry->path_id)
@@ -779,21 +1127,20 @@ void playlist_update(playlist_t *playlist, size_t idx,
          entry->path_id  = NULL;
       }
 
-      playlist->modified = true;
+      playlist->modified    = true;
+      playlist->index_valid = false;
    }
 
    if (update_entry->label && (update_entry->label != entry->label))
    {
-      if (entry->label)
-         free(entry->label);
+      playlist_free_str(playlist, entry->label);
       entry->label       = strdup(update_entry->label);
       playlist->modified = true;
    }
 
    if (update_entry->core_path && (update_entry->core_path != entry->core_path))
    {
-      if (entry->core_path)
-         free(entry->core_path);
+      playlist_free_str(playlist, entry->core_path);
       entry->core_path   = NULL;
       entry->core_path   = strdup(update_entry->core_path);
       playlist->modified = true;
@@ -801,24 +1148,21 @@ void playlist_update(playlist_t *playlist, size_t idx,
 
    if (update_entry->core_name && (update_entry->core_name != entry->core_name))
    {
-      if (entry->core_name)
-         free(entry->core_name);
+      playlist_free_str(playlist, entry->core_name);
       entry->core_name   = strdup(update_entry->core_name);
       playlist->modified = true;
    }
 
    if (update_entry->db_name && (update_entry->db_name != entry->db_name))
    {
-      if (entry->db_name)
-         free(entry->db_name);
+      playlist_free_str(playlist, entry->db_name);
       entry->db_name     = strdup(update_entry->db_name);
       playlist->modified = true;
    }
 
    if (update_entry->crc32 && (update_entry->crc32 != entry->crc32))
    {
-      if (entry->crc32)
-         free(entry->crc32);
+      playlist_free_str(playlist, entry->crc32);
       entry->crc32       = strdup(update_entry->crc32);
       playlist->modified = true;
    }
@@ -837,8 +1181,7 @@ void playlist_update_runtime(playlist_t *playlist, size_t idx,
 
    if (update_entry->path && (update_entry->path != entry->path))
    {
-      if (entry->path)
-         free(entry->path);
+      playlist_free_str(playlist, entry->path);
       entry->path        = strdup(update_entry->path);
 
       if (entry->path_id)
@@ -847,13 +1190,13 @@ void playlist_update_runtime(playlist_t *playlist, size_t idx,
          entry->path_id  = NULL;
       }
 
-      playlist->modified = playlist->modified || register_update;
+      playlist->modified    = playlist->modified || register_update;
+      playlist->index_valid = false;
    }
 
    if (update_entry->core_path && (update_entry->core_path != entry->core_path))
    {
-      if (entry->core_path)
-         free(entry->core_path);
+      playlist_free_str(playlist, entry->core_path);
       entry->core_path   = NULL;
       entry->core_path   = strdup(update_entry->core_path);
       playlist->modified = playlist->modified || register_update;
@@ -942,7 +1285,7 @@ bool playlist_push_runtime(playlist_t *playlist,
       const struct playlist_entry *entry)
 {
    playlist_path_id_t *path_id = NULL;
-   size_t i, len;
+   size_t i, len, end;
    char real_core_path[PATH_MAX_LENGTH];
 
    if (!playlist || !entry)
@@ -972,7 +1315,14 @@ bool playlist_push_runtime(playlist_t *playlist,
    }
 
    len = RBUF_LEN(playlist->entries);
-   for (i = 0; i < len; i++)
+   i   = 0;
+   end = len;
+
+   /* Only look at the entry the index points to, if any */
+   if (playlist_path_index_find(playlist, path_id, &i))
+      end = (i < len) ? i + 1 : i;
+
+   for (; i < end; i++)
    {
       struct playlist_entry tmp;
       bool equal_path  = (string_is_empty(path_id->real_path) &&
@@ -995,6 +1345,7 @@ bool playlist_push_runtime(playlist_t *playlist,
          goto error;
 
       /* Seen it before, bump to top. */
+      playlist_path_index_bump(playlist, i);
       tmp = playlist->entries[i];
       memmove(playlist->entries + 1, playlist->entries,
             i * sizeof(struct playlist_entry));
@@ -1009,7 +1360,8 @@ bool playlist_push_runtime(playlist_t *playlist,
    if (len == playlist->config.capacity)
    {
       struct playlist_entry *last_entry = &playlist->entries[len - 1];
-      playlist_free_entry(last_entry);
+      playlist_path_index_delete(playlist, len - 1);
+      playlist_free_entry(playlist, last_entry);
       len--;
    }
    else
@@ -1032,6 +1384,7 @@ bool playlist_push_runtime(playlist_t *playlist,
          playlist->entries[0].path         = strdup(path_id->real_path);
       playlist->entries[0].path_id         = path_id;
       path_id                              = NULL;
+      playlist_path_index_push(playlist, playlist->entries[0].path_id);
 
       if (!string_is_empty(real_core_path))
          playlist->entries[0].core_path    = strdup(real_core_path);
@@ -1214,7 +1567,7 @@ bool playlist_content_path_is_valid(const char *path)
 bool playlist_push(playlist_t *playlist,
       const struct playlist_entry *entry)
 {
-   size_t i, len;
+   size_t i, len, end;
    char real_core_path[PATH_MAX_LENGTH];
    playlist_path_id_t *path_id = NULL;
    const char *core_name       = entry->core_name;
@@ -1262,7 +1615,14 @@ bool playlist_push(playlist_t *playlist,
    }
 
    len = RBUF_LEN(playlist->entries);
-   for (i = 0; i < len; i++)
+   i   = 0;
+   end = len;
+
+   /* Only look at the entry the index points to, if any */
+   if (playlist_path_index_find(playlist, path_id, &i))
+      end = (i < len) ? i + 1 : i;
+
+   for (; i < end; i++)
    {
       struct playlist_entry tmp;
       bool equal_path  = (string_is_empty(path_id->real_path) &&
@@ -1375,6 +1735,7 @@ bool playlist_push(playlist_t *playlist,
       }
 
       /* Seen it before, bump to top. */
+      playlist_path_index_bump(playlist, i);
       tmp = playlist->entries[i];
       memmove(playlist->entries + 1, playlist->entries,
             i * sizeof(struct playlist_entry));
@@ -1389,7 +1750,8 @@ bool playlist_push(playlist_t *playlist,
    if (len == playlist->config.capacity)
    {
       struct playlist_entry *last_entry = &playlist->entries[len - 1];
-      playlist_free_entry(last_entry);
+      playlist_path_index_delete(playlist, len - 1);
+      playlist_free_entry(playlist, last_entry);
       len--;
    }
    else
@@ -1432,6 +1794,7 @@ bool playlist_push(playlist_t *playlist,
          playlist->entries[0].path            = strdup(path_id->real_path);
       playlist->entries[0].path_id            = path_id;
       path_id                                 = NULL;
+      playlist_path_index_push(playlist, playlist->entries[0].path_id);
 
       playlist->entries[0].entry_slot         = entry->entry_slot;
 
@@ -1630,6 +1993,614 @@ end:
    free(file);
 }
 
+/* Binary playlist cache
+ * > Written next to the playlist file ('.lplc'),
+ *   tagged with the size, modification time and
+ *   hash of the playlist it was built from
+ * > Layout: header, one fixed size record per entry,
+ *   then a table of NUL terminated strings. Records
+ *   and header refer to strings by offset into the
+ *   table, identical strings are stored once
+ * > On load the file is mapped (or read in one go)
+ *   and entry strings point straight into it, so
+ *   there is no parsing and no per string allocation
+ * > Data is stored in native byte order - a cache
+ *   written by another platform fails the magic
+ *   check and is simply rebuilt */
+
+#define PLAYLIST_CACHE_MAGIC   0x43504C52 /* "RLPC" */
+#define PLAYLIST_CACHE_VERSION 2
+#define PLAYLIST_CACHE_NULL    0xFFFFFFFF
+
+/* Read size when hashing the playlist file */
+#define PLAYLIST_CACHE_HASH_CHUNK (64 * 1024)
+
+enum playlist_cache_flags
+{
+   /* All entries of the playlist file are present,
+    * none were discarded because of capacity */
+   PLAYLIST_CACHE_FLAG_COMPLETE           = (1 << 0),
+   PLAYLIST_CACHE_FLAG_OLD_FORMAT         = (1 << 1),
+   PLAYLIST_CACHE_FLAG_COMPRESSED         = (1 << 2),
+   PLAYLIST_CACHE_FLAG_SEARCH_RECURSIVELY = (1 << 3),
+   PLAYLIST_CACHE_FLAG_SEARCH_ARCHIVES    = (1 << 4),
+   PLAYLIST_CACHE_FLAG_FILTER_DAT_CONTENT = (1 << 5)
+};
+
+typedef struct
+{
+   uint32_t magic;
+   uint32_t version;
+   int64_t lpl_size;
+   int64_t lpl_mtime;     /* Nanoseconds */
+   uint64_t lpl_hash;
+   uint32_t crc;          /* Records + string table */
+   uint32_t flags;
+   uint32_t count;
+   uint32_t strings_size;
+   uint32_t label_display_mode;
+   uint32_t right_thumbnail_mode;
+   uint32_t left_thumbnail_mode;
+   uint32_t sort_mode;
+   uint32_t default_core_path;
+   uint32_t default_core_name;
+   uint32_t base_content_directory;
+   uint32_t scan_content_dir;
+   uint32_t scan_file_exts;
+   uint32_t scan_dat_file_path;
+} playlist_cache_header_t;
+
+typedef struct
+{
+   uint32_t path;
+   uint32_t label;
+   uint32_t core_path;
+   uint32_t core_name;
+   uint32_t db_name;
+   uint32_t crc32;
+   uint32_t subsystem_ident;
+   uint32_t subsystem_name;
+   /* 'roms_count' consecutive strings */
+   uint32_t roms;
+   uint32_t roms_count;
+   uint32_t entry_slot;
+   uint32_t reserved;
+} playlist_cache_record_t;
+
+typedef struct
+{
+   char *strings;       /* RBUF */
+   uint32_t *offsets;   /* RHMAP, string -> offset */
+   bool failed;
+} playlist_cache_writer_t;
+
+/* Identifies the playlist file a cache was built from */
+typedef struct
+{
+   int64_t size;
+   int64_t mtime;   /* Nanoseconds where the platform keeps them */
+   uint64_t hash;   /* XXH3 of the whole file */
+} playlist_file_id_t;
+
+/* The size and modification time alone miss a playlist
+ * rewritten to the same length within the timestamp
+ * granularity (or restored with its old timestamp), so
+ * the contents are hashed as well. XXH3 keeps this far
+ * cheaper than parsing them */
+static bool playlist_file_hash(const char *path, uint64_t *hash)
+{
+   int64_t len;
+   uint8_t *buf         = NULL;
+   XXH3_state_t *state  = NULL;
+   RFILE *file          = filestream_open(path,
+         RETRO_VFS_FILE_ACCESS_READ, RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!file)
+      return false;
+
+   if (     !(buf   = (uint8_t*)malloc(PLAYLIST_CACHE_HASH_CHUNK))
+         || !(state = XXH3_createState()))
+   {
+      free(buf);
+      filestream_close(file);
+      return false;
+   }
+
+   XXH3_64bits_reset(state);
+   while ((len = filestream_read(file, buf, PLAYLIST_CACHE_HASH_CHUNK)) > 0)
+      XXH3_64bits_update(state, buf, (size_t)len);
+   *hash = XXH3_64bits_digest(state);
+
+   XXH3_freeState(state);
+   free(buf);
+   filestream_close(file);
+   return len == 0;
+}
+
+static bool playlist_file_stat(const char *path, playlist_file_id_t *id)
+{
+#if defined(_WIN32) && !defined(_XBOX)
+   struct _stat64 buf;
+   if (_stat64(path, &buf) != 0)
+      return false;
+   id->size  = (int64_t)buf.st_size;
+   id->mtime = (int64_t)buf.st_mtime * 1000000000;
+#elif defined(__unix__) || defined(__APPLE__) || defined(__HAIKU__)
+   struct stat buf;
+   if (stat(path, &buf) != 0)
+      return false;
+   id->size  = (int64_t)buf.st_size;
+#if defined(__APPLE__)
+   id->mtime = (int64_t)buf.st_mtimespec.tv_sec * 1000000000
+      + buf.st_mtimespec.tv_nsec;
+#elif defined(st_mtime)
+   /* Only a macro where it aliases st_mtim.tv_sec */
+   id->mtime = (int64_t)buf.st_mtim.tv_sec * 1000000000
+      + buf.st_mtim.tv_nsec;
+#else
+   id->mtime = (int64_t)buf.st_mtime * 1000000000;
+#endif
+#else
+   /* Without a modification time the cache
+    * cannot be validated - never use it */
+   return false;
+#endif
+   return playlist_file_hash(path, &id->hash);
+}
+
+static void playlist_cache_get_path(const playlist_t *playlist,
+      char *s, size_t len)
+{
+   fill_pathname(s, playlist->config.path,
+         FILE_PATH_LPL_CACHE_EXTENSION, len);
+}
+
+static uint32_t playlist_cache_add_string(
+      playlist_cache_writer_t *writer, const char *str)
+{
+   size_t str_len;
+   uint32_t offset;
+
+   if (!str)
+      return PLAYLIST_CACHE_NULL;
+
+   if (RHMAP_HAS_STR(writer->offsets, str))
+      return RHMAP_GET_STR(writer->offsets, str);
+
+   str_len = strlen(str) + 1;
+   offset  = (uint32_t)RBUF_LEN(writer->strings);
+
+   if (!RBUF_TRYFIT(writer->strings, offset + str_len))
+   {
+      writer->failed = true;
+      return PLAYLIST_CACHE_NULL;
+   }
+
+   RBUF_RESIZE(writer->strings, offset + str_len);
+   memcpy(writer->strings + offset, str, str_len);
+   RHMAP_SET_STR(writer->offsets, str, offset);
+
+   return offset;
+}
+
+/* Writes the binary cache of the playlist
+ * file identified by 'lpl'. 'complete' must be
+ * false if entries of the playlist file were
+ * discarded */
+static void playlist_cache_write(playlist_t *playlist,
+      const playlist_file_id_t *lpl, bool complete)
+{
+   size_t i;
+   char cache_path[PATH_MAX_LENGTH];
+   char tmp_path[PATH_MAX_LENGTH];
+   playlist_cache_writer_t writer;
+   playlist_cache_header_t header;
+   playlist_cache_record_t *records = NULL;
+   uint8_t *data                    = NULL;
+   size_t count                     = RBUF_LEN(playlist->entries);
+   size_t records_size              = count * sizeof(*records);
+   size_t strings_size;
+
+   writer.strings = NULL;
+   writer.offsets = NULL;
+   writer.failed  = false;
+
+   if (count && !(records = (playlist_cache_record_t*)
+            malloc(records_size)))
+      return;
+
+   for (i = 0; i < count; i++)
+   {
+      const struct playlist_entry *entry = &playlist->entries[i];
+      playlist_cache_record_t *record    = &records[i];
+
+      record->path            = playlist_cache_add_string(&writer, entry->path);
+      record->label           = playlist_cache_add_string(&writer, entry->label);
+      record->core_path       = playlist_cache_add_string(&writer, entry->core_path);
+      record->core_name       = playlist_cache_add_string(&writer, entry->core_name);
+      record->db_name         = playlist_cache_add_string(&writer, entry->db_name);
+      record->crc32           = playlist_cache_add_string(&writer, entry->crc32);
+      record->subsystem_ident = playlist_cache_add_string(&writer, entry->subsystem_ident);
+      record->subsystem_name  = playlist_cache_add_string(&writer, entry->subsystem_name);
+      record->roms            = PLAYLIST_CACHE_NULL;
+      record->roms_count      = 0;
+      record->entry_slot      = entry->entry_slot;
+      record->reserved        = 0;
+
+      /* Subsystem roms are not deduplicated,
+       * they have to be stored back to back */
+      if (entry->subsystem_roms && entry->subsystem_roms->size > 0)
+      {
+         size_t j;
+
+         record->roms       = (uint32_t)RBUF_LEN(writer.strings);
+         record->roms_count = (uint32_t)entry->subsystem_roms->size;
+
+         for (j = 0; j < entry->subsystem_roms->size; j++)
+         {
+            const char *rom = entry->subsystem_roms->elems[j].data;
+            size_t rom_len  = strlen(rom ? rom : "") + 1;
+            size_t offset   = RBUF_LEN(writer.strings);
+
+            if (!RBUF_TRYFIT(writer.strings, offset + rom_len))
+               goto end;
+
+            RBUF_RESIZE(writer.strings, offset + rom_len);
+            memcpy(writer.strings + offset, rom ? rom : "", rom_len);
+         }
+      }
+   }
+
+   memset(&header, 0, sizeof(header));
+   header.magic                  = PLAYLIST_CACHE_MAGIC;
+   header.version                = PLAYLIST_CACHE_VERSION;
+   header.lpl_size               = lpl->size;
+   header.lpl_mtime              = lpl->mtime;
+   header.lpl_hash               = lpl->hash;
+   header.count                  = (uint32_t)count;
+   header.label_display_mode     = (uint32_t)playlist->label_display_mode;
+   header.right_thumbnail_mode   = (uint32_t)playlist->right_thumbnail_mode;
+   header.left_thumbnail_mode    = (uint32_t)playlist->left_thumbnail_mode;
+   header.sort_mode              = (uint32_t)playlist->sort_mode;
+   header.default_core_path      = playlist_cache_add_string(&writer,
+         playlist->default_core_path);
+   header.default_core_name      = playlist_cache_add_string(&writer,
+         playlist->default_core_name);
+   header.base_content_directory = playlist_cache_add_string(&writer,
+         playlist->base_content_directory);
+   header.scan_content_dir       = playlist_cache_add_string(&writer,
+         playlist->scan_record.content_dir);
+   header.scan_file_exts         = playlist_cache_add_string(&writer,
+         playlist->scan_record.file_exts);
+   header.scan_dat_file_path     = playlist_cache_add_string(&writer,
+         playlist->scan_record.dat_file_path);
+
+   if (complete)
+      header.flags |= PLAYLIST_CACHE_FLAG_COMPLETE;
+   if (playlist->old_format)
+      header.flags |= PLAYLIST_CACHE_FLAG_OLD_FORMAT;
+   if (playlist->compressed)
+      header.flags |= PLAYLIST_CACHE_FLAG_COMPRESSED;
+   if (playlist->scan_record.search_recursively)
+      header.flags |= PLAYLIST_CACHE_FLAG_SEARCH_RECURSIVELY;
+   if (playlist->scan_record.search_archives)
+      header.flags |= PLAYLIST_CACHE_FLAG_SEARCH_ARCHIVES;
+   if (playlist->scan_record.filter_dat_content)
+      header.flags |= PLAYLIST_CACHE_FLAG_FILTER_DAT_CONTENT;
+
+   /* A string that failed to fit would read back
+    * as NULL - never write an inaccurate cache */
+   strings_size = RBUF_LEN(writer.strings);
+   if (writer.failed || strings_size >= PLAYLIST_CACHE_NULL)
+      goto end;
+
+   header.strings_size = (uint32_t)strings_size;
+
+   if (!(data = (uint8_t*)malloc(sizeof(header)
+               + records_size + strings_size)))
+      goto end;
+
+   if (records_size)
+      memcpy(data + sizeof(header), records, records_size);
+   if (strings_size)
+      memcpy(data + sizeof(header) + records_size,
+            writer.strings, strings_size);
+
+   header.crc = encoding_crc32(0, data + sizeof(header),
+         records_size + strings_size);
+   memcpy(data, &header, sizeof(header));
+
+   playlist_cache_get_path(playlist, cache_path, sizeof(cache_path));
+   strlcpy(tmp_path, cache_path, sizeof(tmp_path));
+   strlcat(tmp_path, ".tmp", sizeof(tmp_path));
+
+   /* The previous cache may still be mapped by this
+    * or another playlist - replace the file instead
+    * of truncating it under the mapping */
+   if (!filestream_write_file(tmp_path, data,
+            (int64_t)(sizeof(header) + records_size + strings_size)))
+   {
+      RARCH_WARN("[Playlist]: Failed to write playlist cache: \"%s\".\n",
+            cache_path);
+      goto end;
+   }
+
+   if (filestream_rename(tmp_path, cache_path) != 0)
+   {
+      /* Platforms that cannot rename over an existing file */
+      filestream_delete(cache_path);
+      if (filestream_rename(tmp_path, cache_path) != 0)
+      {
+         filestream_delete(tmp_path);
+         RARCH_WARN("[Playlist]: Failed to write playlist cache: \"%s\".\n",
+               cache_path);
+      }
+   }
+
+end:
+   free(data);
+   free(records);
+   RBUF_FREE(writer.strings);
+   RHMAP_FREE(writer.offsets);
+}
+
+/* Returns the string at 'offset' of the cache
+ * string table. Sets 'valid' to false if the
+ * offset is out of bounds */
+static char *playlist_cache_get_string(char *strings,
+      uint32_t strings_size, uint32_t offset, bool *valid)
+{
+   if (offset == PLAYLIST_CACHE_NULL)
+      return NULL;
+   if (offset >= strings_size)
+   {
+      *valid = false;
+      return NULL;
+   }
+   return strings + offset;
+}
+
+static void playlist_cache_release(playlist_t *playlist)
+{
+   if (!playlist->cache_data)
+      return;
+
+#if defined(HAVE_MMAP) && defined(HAVE_MMAN)
+   if (playlist->cache_mapped)
+      munmap(playlist->cache_data, playlist->cache_size);
+   else
+#endif
+      free(playlist->cache_data);
+
+   playlist->cache_data   = NULL;
+   playlist->cache_size   = 0;
+   playlist->cache_mapped = false;
+}
+
+/* Attempts to populate the playlist from its
+ * binary cache. Returns false if there is no
+ * cache or it does not match the playlist file,
+ * in which case the playlist is left untouched */
+static bool playlist_cache_read(playlist_t *playlist,
+      const playlist_file_id_t *lpl)
+{
+   size_t i, count;
+   char cache_path[PATH_MAX_LENGTH];
+   playlist_cache_header_t header;
+   const playlist_cache_record_t *records;
+   struct playlist_entry *entries = NULL;
+   uint8_t *data                  = NULL;
+   size_t size                    = 0;
+   bool mapped                    = false;
+   bool valid                     = true;
+   const char *meta[6];
+   char *strings;
+
+   playlist_cache_get_path(playlist, cache_path, sizeof(cache_path));
+
+#if defined(HAVE_MMAP) && defined(HAVE_MMAN)
+   {
+      struct stat buf;
+      int fd = open(cache_path, O_RDONLY);
+
+      if (fd < 0)
+         return false;
+
+      if (     fstat(fd, &buf) == 0
+            && buf.st_size >= (off_t)sizeof(header))
+      {
+         /* Private writable mapping: entry strings are
+          * not const, pages are copied if written to */
+         void *addr = mmap(NULL, (size_t)buf.st_size,
+               PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+
+         if (addr != MAP_FAILED)
+         {
+            data   = (uint8_t*)addr;
+            size   = (size_t)buf.st_size;
+            mapped = true;
+         }
+      }
+
+      close(fd);
+   }
+#endif
+
+   if (!data)
+   {
+      void *buf   = NULL;
+      int64_t len = 0;
+
+      if (!path_is_valid(cache_path)
+            || !filestream_read_file(cache_path, &buf, &len))
+         return false;
+
+      data = (uint8_t*)buf;
+      size = (size_t)len;
+   }
+
+   if (size < sizeof(header))
+      goto error;
+
+   memcpy(&header, data, sizeof(header));
+
+   if (     header.magic     != PLAYLIST_CACHE_MAGIC
+         || header.version   != PLAYLIST_CACHE_VERSION
+         || header.lpl_size  != lpl->size
+         || header.lpl_mtime != lpl->mtime
+         || header.lpl_hash  != lpl->hash)
+      goto error;
+
+   if (     header.count > (size - sizeof(header)) / sizeof(*records)
+         || size - sizeof(header) - header.count * sizeof(*records)
+               != header.strings_size)
+      goto error;
+
+   records = (const playlist_cache_record_t*)(data + sizeof(header));
+   strings = (char*)data + sizeof(header) + header.count * sizeof(*records);
+
+   /* Every in-bounds offset is then a valid string */
+   if (header.strings_size && strings[header.strings_size - 1] != '\0')
+      goto error;
+
+   if (encoding_crc32(0, data + sizeof(header),
+            size - sizeof(header)) != header.crc)
+      goto error;
+
+   /* A cache built from a truncated playlist cannot
+    * serve a playlist with a larger capacity */
+   count = header.count;
+   if (     !(header.flags & PLAYLIST_CACHE_FLAG_COMPLETE)
+         && count < playlist->config.capacity)
+      goto error;
+   if (count > playlist->config.capacity)
+      count = playlist->config.capacity;
+
+   if (count)
+   {
+      if (!RBUF_TRYFIT(entries, count))
+         goto error;
+      RBUF_RESIZE(entries, count);
+      memset(entries, 0, count * sizeof(*entries));
+   }
+
+   for (i = 0; i < count && valid; i++)
+   {
+      const playlist_cache_record_t *record = &records[i];
+      struct playlist_entry *entry          = &entries[i];
+
+      entry->path            = playlist_cache_get_string(strings,
+            header.strings_size, record->path, &valid);
+      entry->label           = playlist_cache_get_string(strings,
+            header.strings_size, record->label, &valid);
+      entry->core_path       = playlist_cache_get_string(strings,
+            header.strings_size, record->core_path, &valid);
+      entry->core_name       = playlist_cache_get_string(strings,
+            header.strings_size, record->core_name, &valid);
+      entry->db_name         = playlist_cache_get_string(strings,
+            header.strings_size, record->db_name, &valid);
+      entry->crc32           = playlist_cache_get_string(strings,
+            header.strings_size, record->crc32, &valid);
+      entry->subsystem_ident = playlist_cache_get_string(strings,
+            header.strings_size, record->subsystem_ident, &valid);
+      entry->subsystem_name  = playlist_cache_get_string(strings,
+            header.strings_size, record->subsystem_name, &valid);
+      entry->entry_slot      = record->entry_slot;
+
+      if (record->roms_count)
+      {
+         size_t j;
+         uint32_t offset                    = record->roms;
+         union string_list_elem_attr attr   = {0};
+
+         if (!(entry->subsystem_roms = string_list_new()))
+            valid = false;
+
+         for (j = 0; j < record->roms_count && valid; j++)
+         {
+            if (offset >= header.strings_size)
+               valid = false;
+            else
+            {
+               const char *rom = strings + offset;
+               valid           = string_list_append(
+                     entry->subsystem_roms, rom, attr);
+               offset         += (uint32_t)strlen(rom) + 1;
+            }
+         }
+      }
+   }
+
+   meta[0] = playlist_cache_get_string(strings, header.strings_size,
+         header.default_core_path, &valid);
+   meta[1] = playlist_cache_get_string(strings, header.strings_size,
+         header.default_core_name, &valid);
+   meta[2] = playlist_cache_get_string(strings, header.strings_size,
+         header.base_content_directory, &valid);
+   meta[3] = playlist_cache_get_string(strings, header.strings_size,
+         header.scan_content_dir, &valid);
+   meta[4] = playlist_cache_get_string(strings, header.strings_size,
+         header.scan_file_exts, &valid);
+   meta[5] = playlist_cache_get_string(strings, header.strings_size,
+         header.scan_dat_file_path, &valid);
+
+   if (!valid)
+      goto error;
+
+   /* Metadata may be replaced at any time, keep
+    * it out of the cache */
+   playlist->default_core_path         = meta[0] ? strdup(meta[0]) : NULL;
+   playlist->default_core_name         = meta[1] ? strdup(meta[1]) : NULL;
+   playlist->base_content_directory    = meta[2] ? strdup(meta[2]) : NULL;
+   playlist->scan_record.content_dir   = meta[3] ? strdup(meta[3]) : NULL;
+   playlist->scan_record.file_exts     = meta[4] ? strdup(meta[4]) : NULL;
+   playlist->scan_record.dat_file_path = meta[5] ? strdup(meta[5]) : NULL;
+
+   playlist->scan_record.search_recursively =
+         (header.flags & PLAYLIST_CACHE_FLAG_SEARCH_RECURSIVELY) != 0;
+   playlist->scan_record.search_archives    =
+         (header.flags & PLAYLIST_CACHE_FLAG_SEARCH_ARCHIVES) != 0;
+   playlist->scan_record.filter_dat_content =
+         (header.flags & PLAYLIST_CACHE_FLAG_FILTER_DAT_CONTENT) != 0;
+   playlist->old_format = (header.flags & PLAYLIST_CACHE_FLAG_OLD_FORMAT) != 0;
+   playlist->compressed = (header.flags & PLAYLIST_CACHE_FLAG_COMPRESSED) != 0;
+
+   if (header.label_display_mode <= LABEL_DISPLAY_MODE_KEEP_REGION_AND_DISC_INDEX)
+      playlist->label_display_mode   = (enum playlist_label_display_mode)
+            header.label_display_mode;
+   if (header.right_thumbnail_mode <= PLAYLIST_THUMBNAIL_MODE_BOXARTS)
+      playlist->right_thumbnail_mode = (enum playlist_thumbnail_mode)
+            header.right_thumbnail_mode;
+   if (header.left_thumbnail_mode <= PLAYLIST_THUMBNAIL_MODE_BOXARTS)
+      playlist->left_thumbnail_mode  = (enum playlist_thumbnail_mode)
+            header.left_thumbnail_mode;
+   if (header.sort_mode <= PLAYLIST_SORT_MODE_OFF)
+      playlist->sort_mode            = (enum playlist_sort_mode)
+            header.sort_mode;
+
+   playlist->entries      = entries;
+   playlist->cache_data   = data;
+   playlist->cache_size   = size;
+   playlist->cache_mapped = mapped;
+
+   return true;
+
+error:
+   for (i = 0; i < RBUF_LEN(entries); i++)
+      if (entries[i].subsystem_roms)
+         string_list_free(entries[i].subsystem_roms);
+   RBUF_FREE(entries);
+
+#if defined(HAVE_MMAP) && defined(HAVE_MMAN)
+   if (mapped)
+      munmap(data, size);
+   else
+#endif
+      free(data);
+
+   return false;
+}
+
 void playlist_write_file(playlist_t *playlist)
 {
    size_t i, len;
@@ -2006,6 +2977,15 @@ void playlist_write_file(playlist_t *playlist)
 end:
    intfstream_close(file);
    free(file);
+
+   /* Refresh the cache against the file just written */
+   if (playlist->config.binary_cache && !playlist->modified)
+   {
+      playlist_file_id_t lpl;
+
+      if (playlist_file_stat(playlist->config.path, &lpl))
+         playlist_cache_write(playlist, &lpl, true);
+   }
 }
 
 /**
@@ -2052,12 +3032,16 @@ void playlist_free(playlist_t *playlist)
          struct playlist_entry *entry = &playlist->entries[i];
 
          if (entry)
-            playlist_free_entry(entry);
+            playlist_free_entry(playlist, entry);
       }
 
       RBUF_FREE(playlist->entries);
    }
 
+   playlist_cache_release(playlist);
+
+   playlist_path_index_free(playlist);
+
    free(playlist);
 }
 
@@ -2078,9 +3062,10 @@ void playlist_clear(playlist_t *playlist)
       struct playlist_entry *entry = &playlist->entries[i];
 
       if (entry)
-         playlist_free_entry(entry);
+         playlist_free_entry(playlist, entry);
    }
    RBUF_CLEAR(playlist->entries);
+   playlist_path_index_free(playlist);
 }
 
 /**
@@ -2449,16 +3434,26 @@ static bool playlist_read_file(playlist_t *playlist)
 {
    unsigned i;
    int test_char;
-   bool res = true;
+   intfstream_t *file;
+   bool res          = true;
+   playlist_file_id_t lpl;
+   /* Identify before reading, so that a playlist modified
+    * while being parsed leaves a stale cache behind */
+   bool cacheable    = playlist->config.binary_cache
+         && playlist_file_stat(playlist->config.path, &lpl);
+
+   if (cacheable && playlist_cache_read(playlist, &lpl))
+      return true;
+
 #if defined(HAVE_ZLIB)
-      /* Always use RZIP interface when reading playlists
-       * > this will automatically handle uncompressed
-       *   data */
-   intfstream_t *file   = intfstream_open_rzip_file(
+   /* Always use RZIP interface when reading playlists
+    * > this will automatically handle uncompressed
+    *   data */
+   file = intfstream_open_rzip_file(
          playlist->config.path,
          RETRO_VFS_FILE_ACCESS_READ);
 #else
-   intfstream_t *file   = intfstream_open_file(
+   file = intfstream_open_file(
          playlist->config.path,
          RETRO_VFS_FILE_ACCESS_READ,
          RETRO_VFS_FILE_ACCESS_HINT_NONE);
@@ -2514,7 +3509,13 @@ static bool playlist_read_file(playlist_t *playlist)
             JSONEndArrayHandler,
             JSONBoolHandler,
             NULL) /* Unused null handler */
-            != RJSON_DONE)
+            == RJSON_DONE)
+      {
+         if (cacheable)
+            playlist_cache_write(playlist, &lpl,
+                  !context.capacity_exceeded);
+      }
+      else
       {
          if (context.out_of_memory)
          {
@@ -2724,6 +3725,11 @@ static bool playlist_read_file(playlist_t *playlist)
             break;
          }
       }
+
+      /* Entries past capacity were never read */
+      if (cacheable)
+         playlist_cache_write(playlist, &lpl,
+               len < playlist->config.capacity);
    }
 
 end:
@@ -2789,6 +3795,13 @@ playlist_t *playlist_init(const playlist_config_t *config)
    playlist->default_core_path      = NULL;
    playlist->base_content_directory = NULL;
    playlist->entries                = NULL;
+   playlist->path_index             = NULL;
+   playlist->archive_index          = NULL;
+   playlist->index_rank             = 0;
+   playlist->index_valid            = false;
+   playlist->cache_data             = NULL;
+   playlist->cache_size             = 0;
+   playlist->cache_mapped           = false;
    playlist->label_display_mode     = LABEL_DISPLAY_MODE_DEFAULT;
    playlist->right_thumbnail_mode   = PLAYLIST_THUMBNAIL_MODE_DEFAULT;
    playlist->left_thumbnail_mode    = PLAYLIST_THUMBNAIL_MODE_DEFAULT;
@@ -2834,7 +3847,7 @@ playlist_t *playlist_init(const playlist_config_t *config)
                   playlist->base_content_directory, playlist->config.base_content_directory,
                   sizeof(tmp_entry_path));
 
-            free(entry->path);
+            playlist_free_str(playlist, entry->path);
             entry->path = strdup(tmp_entry_path);
 
             /* Fix subsystem roms paths*/
@@ -3001,6 +4014,8 @@ void playlist_qsort(playlist_t *playlist)
    qsort(playlist->entries, RBUF_LEN(playlist->entries),
          sizeof(struct playlist_entry),
          (int (*)(const void *, const void *))playlist_qsort_func);
+
+   playlist->index_valid = false;
 }
 
 void command_playlist_push_write(
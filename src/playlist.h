@@ -137,6 +137,7 @@ typedef struct
    bool compress;
    bool fuzzy_archive_match;
    bool autofix_paths;   
+   bool binary_cache;
    char path[PATH_MAX_LENGTH];
    char base_content_directory[PATH_MAX_LENGTH];
 } playlist_config_t;
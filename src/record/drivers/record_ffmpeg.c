@@ -469,6 +469,8 @@ static bool ffmpeg_init_video(ffmpeg_t* handle)
    video->codec->pix_fmt = video->pix_fmt;
 
    video->codec->thread_count = params->threads;
+   /* The in-house scaler splits its rows across as many threads */
+   video->scaler.threads      = params->threads;
 
    if (params->video_qscale)
    {
@@ -2706,6 +2706,8 @@ bool command_event(enum event_command cmd, void *data)
 #ifdef HAVE_REWIND
          {
             bool rewind_enable        = settings->bools.rewind_enable;
+            bool rewind_threaded      = settings->bools.rewind_threaded;
+            bool rewind_tiered        = settings->bools.rewind_tiered;
             size_t rewind_buf_size    = settings->sizes.rewind_buffer_size;
             bool core_type_is_dummy   = runloop_st->current_core_type == CORE_TYPE_DUMMY;
 
@@ -2725,7 +2727,8 @@ bool command_event(enum event_command cmd, void *data)
 #endif
                {
                   state_manager_event_init(&runloop_st->rewind_st,
-                        (unsigned)rewind_buf_size);
+                        (unsigned)rewind_buf_size, rewind_threaded,
+                        rewind_tiered);
                }
             }
          }
@@ -2928,6 +2931,8 @@ bool command_event(enum event_command cmd, void *data)
             playlist_config.old_format             = settings->bools.playlist_use_old_format;
             playlist_config.compress               = settings->bools.playlist_compression;
             playlist_config.fuzzy_archive_match    = settings->bools.playlist_fuzzy_archive_match;
+            /* histories are small and rewritten all the time */
+            playlist_config.binary_cache           = false;
             /* don't use relative paths for content, music, video, and image histories */
             playlist_config_set_base_content_directory(&playlist_config, NULL);
 
@@ -4375,6 +4380,31 @@ static void sdl_exit(void)
 }
 #endif
 
+static void retroarch_log_task_queue_stats(void)
+{
+   unsigned i;
+   task_queue_stats_t stats;
+   static const char *classes[TASK_PRIORITY_LAST] = {
+      "interactive", "savestate", "background" };
+
+   if (!task_queue_get_stats(&stats))
+      return;
+
+   RARCH_LOG("[Tasks]: %u worker(s), %u steal(s).\n",
+         stats.workers, (unsigned)stats.steals);
+
+   for (i = 0; i < TASK_PRIORITY_LAST; i++)
+   {
+      if (!stats.slices[i])
+         continue;
+      RARCH_LOG("[Tasks]: %-11s slices: %u, peak depth: %u, "
+            "wait avg: %.2f ms, max: %.2f ms.\n",
+            classes[i], (unsigned)stats.slices[i], stats.depth_max[i],
+            stats.wait_total[i] / (double)stats.slices[i] / 1000.0,
+            stats.wait_max[i] / 1000.0);
+   }
+}
+
 /**
  * main_exit:
  *
@@ -4429,6 +4459,7 @@ void main_exit(void *args)
    runloop_msg_queue_deinit();
    driver_uninit(DRIVERS_CMD_ALL);
 
+   retroarch_log_task_queue_stats();
    retro_main_log_file_deinit();
 
    retroarch_ctl(RARCH_CTL_STATE_FREE,  NULL);
@@ -7017,6 +7048,7 @@ void retroarch_favorites_init(void)
    playlist_config.old_format          = settings ? settings->bools.playlist_use_old_format : false;
    playlist_config.compress            = settings ? settings->bools.playlist_compression : false;
    playlist_config.fuzzy_archive_match = settings ? settings->bools.playlist_fuzzy_archive_match : false;
+   playlist_config.binary_cache        = settings ? settings->bools.playlist_binary_cache : false;
    playlist_config_set_base_content_directory(&playlist_config, NULL);
 
    if (!settings)
@@ -23,6 +23,8 @@
 #endif
 
 #include <encodings/utf.h>
+#include <features/features_cpu.h>
+#include <memalign.h>
 #include <string/stdstring.h>
 #include <streams/file_stream.h>
 #include <time/rtime.h>
@@ -37,6 +39,50 @@
 #include "runloop.h"
 #include "verbosity.h"
 
+/* Savestates are kept in one block that is allocated once and
+ * reused every frame. Each slot starts on its own cache line. */
+#define RUNAHEAD_STATE_ALIGN 64
+
+/* Per-phase costs, listed with the frontend performance counters.
+ * Preemptive frames report under the same names. */
+static struct retro_perf_counter runahead_perf_serialize   = {0};
+static struct retro_perf_counter runahead_perf_unserialize = {0};
+static struct retro_perf_counter runahead_perf_hidden      = {0};
+
+/* Time spent in the phases above, in microseconds, whether or
+ * not the counters are enabled. Adaptive run-ahead goes by this
+ * rather than by the whole frame, which includes presenting it. */
+static retro_time_t runahead_stage_begin = 0;
+static retro_time_t runahead_stage_usec  = 0;
+
+static void runahead_perf_init(void)
+{
+   performance_counter_init(runahead_perf_serialize,   "runahead_serialize");
+   performance_counter_init(runahead_perf_unserialize, "runahead_unserialize");
+   performance_counter_init(runahead_perf_hidden,      "runahead_hidden_frames");
+}
+
+static void runahead_stage_start(runloop_state_t *runloop_st,
+      struct retro_perf_counter *perf)
+{
+   performance_counter_start_plus(runloop_st->perfcnt_enable, (*perf));
+   runahead_stage_begin  = cpu_features_get_time_usec();
+}
+
+static void runahead_stage_stop(runloop_state_t *runloop_st,
+      struct retro_perf_counter *perf)
+{
+   runahead_stage_usec  += cpu_features_get_time_usec()
+                         - runahead_stage_begin;
+   performance_counter_stop_plus(runloop_st->perfcnt_enable, (*perf));
+}
+
+static size_t runahead_state_stride(size_t state_size)
+{
+   return (state_size + RUNAHEAD_STATE_ALIGN - 1)
+      & ~(size_t)(RUNAHEAD_STATE_ALIGN - 1);
+}
+
 static int16_t input_state_get_last(unsigned port,
       unsigned device, unsigned index, unsigned id)
 {
@@ -901,48 +947,29 @@ static void runahead_remove_input_state_hook(runloop_state_t *runloop_st)
    }
 }
 
-static void *runahead_save_state_alloc(void)
-{
-   runloop_state_t     *runloop_st       = runloop_state_get_ptr();
-   retro_ctx_serialize_info_t *savestate = (retro_ctx_serialize_info_t*)
-      malloc(sizeof(retro_ctx_serialize_info_t));
-
-   if (!savestate)
-      return NULL;
-
-   savestate->data          = NULL;
-   savestate->data_const    = NULL;
-   savestate->size          = 0;
-
-   if (     (runloop_st->runahead_save_state_size > 0)
-         && (runloop_st->flags & RUNLOOP_FLAG_RUNAHEAD_SAVE_STATE_SIZE_KNOWN))
-   {
-      savestate->data       = malloc(runloop_st->runahead_save_state_size);
-      savestate->data_const = savestate->data;
-      savestate->size       = runloop_st->runahead_save_state_size;
-   }
-
-   return savestate;
-}
-
-static void runahead_save_state_free(void *data)
+static void runahead_save_state_free(runloop_state_t *runloop_st)
 {
-   retro_ctx_serialize_info_t *savestate = (retro_ctx_serialize_info_t*)data;
-   if (!savestate)
-      return;
-   free(savestate->data);
-   free(savestate);
+   if (runloop_st->runahead_save_state)
+      memalign_free(runloop_st->runahead_save_state);
+   runloop_st->runahead_save_state = NULL;
 }
 
-static void runahead_save_state_list_init(
+static bool runahead_save_state_init(
       runloop_state_t *runloop_st,
       size_t save_state_size)
 {
    runloop_st->runahead_save_state_size  = save_state_size;
    runloop_st->flags                    |= RUNLOOP_FLAG_RUNAHEAD_SAVE_STATE_SIZE_KNOWN;
 
-   mylist_create(&runloop_st->runahead_save_state_list, 16,
-         runahead_save_state_alloc, runahead_save_state_free);
+   runahead_save_state_free(runloop_st);
+
+   if (!save_state_size)
+      return false;
+
+   runloop_st->runahead_save_state       = memalign_alloc(
+         RUNAHEAD_STATE_ALIGN, runahead_state_stride(save_state_size));
+
+   return runloop_st->runahead_save_state != NULL;
 }
 
 /* Hooks - Hooks to cleanup, and add dirty input hooks */
@@ -966,7 +993,7 @@ static void runahead_remove_hooks(runloop_state_t *runloop_st)
 
 static void runahead_destroy(runloop_state_t *runloop_st)
 {
-   mylist_destroy(&runloop_st->runahead_save_state_list);
+   runahead_save_state_free(runloop_st);
    runahead_remove_hooks(runloop_st);
    runahead_clear_variables(runloop_st);
 }
@@ -1016,7 +1043,7 @@ static void runahead_add_hooks(runloop_state_t *runloop_st)
 static void runahead_error(runloop_state_t *runloop_st)
 {
    runloop_st->flags &= ~RUNLOOP_FLAG_RUNAHEAD_AVAILABLE;
-   mylist_destroy(&runloop_st->runahead_save_state_list);
+   runahead_save_state_free(runloop_st);
    runahead_remove_hooks(runloop_st);
    runloop_st->runahead_save_state_size       = 0;
    runloop_st->flags                         |= RUNLOOP_FLAG_RUNAHEAD_SAVE_STATE_SIZE_KNOWN;
@@ -1030,37 +1057,40 @@ static bool runahead_create(runloop_state_t *runloop_st)
 
    core_serialize_size_special(&info);
 
-   runahead_save_state_list_init(runloop_st, info.size);
-   if (video_st->flags & VIDEO_FLAG_ACTIVE)
-      video_st->flags |=  VIDEO_FLAG_RUNAHEAD_IS_ACTIVE;
-   else
-      video_st->flags &= ~VIDEO_FLAG_RUNAHEAD_IS_ACTIVE;
-
-   if (      (runloop_st->runahead_save_state_size == 0)
-         || !(runloop_st->flags & RUNLOOP_FLAG_RUNAHEAD_SAVE_STATE_SIZE_KNOWN))
+   if (!runahead_save_state_init(runloop_st, info.size))
    {
       runahead_error(runloop_st);
       return false;
    }
 
+   if (video_st->flags & VIDEO_FLAG_ACTIVE)
+      video_st->flags |=  VIDEO_FLAG_RUNAHEAD_IS_ACTIVE;
+   else
+      video_st->flags &= ~VIDEO_FLAG_RUNAHEAD_IS_ACTIVE;
+
+   runahead_perf_init();
    runahead_add_hooks(runloop_st);
    runloop_st->flags |= RUNLOOP_FLAG_RUNAHEAD_FORCE_INPUT_DIRTY;
-   if (runloop_st->runahead_save_state_list)
-      mylist_resize(runloop_st->runahead_save_state_list, 1, true);
    return true;
 }
 
 static bool runahead_save_state(runloop_state_t *runloop_st)
 {
-   retro_ctx_serialize_info_t *serialize_info;
+   bool ret;
+   retro_ctx_serialize_info_t serialize_info;
 
-   if (!runloop_st->runahead_save_state_list)
+   if (!runloop_st->runahead_save_state)
       return false;
 
-   serialize_info                  =
-      (retro_ctx_serialize_info_t*)runloop_st->runahead_save_state_list->data[0];
+   serialize_info.data       = runloop_st->runahead_save_state;
+   serialize_info.data_const = runloop_st->runahead_save_state;
+   serialize_info.size       = runloop_st->runahead_save_state_size;
 
-   if (core_serialize_special(serialize_info))
+   runahead_stage_start(runloop_st, &runahead_perf_serialize);
+   ret                       = core_serialize_special(&serialize_info);
+   runahead_stage_stop(runloop_st, &runahead_perf_serialize);
+
+   if (ret)
       return true;
 
    runahead_error(runloop_st);
@@ -1069,11 +1099,18 @@ static bool runahead_save_state(runloop_state_t *runloop_st)
 
 static bool runahead_load_state(runloop_state_t *runloop_st)
 {
-   retro_ctx_serialize_info_t *serialize_info = 
-      (retro_ctx_serialize_info_t*)
-      runloop_st->runahead_save_state_list->data[0];
-   bool last_dirty                            = runloop_st->flags & RUNLOOP_FLAG_INPUT_IS_DIRTY;
-   bool ret                                   = core_unserialize_special(serialize_info);
+   bool ret;
+   retro_ctx_serialize_info_t serialize_info;
+   bool last_dirty                 = runloop_st->flags & RUNLOOP_FLAG_INPUT_IS_DIRTY;
+
+   serialize_info.data             = runloop_st->runahead_save_state;
+   serialize_info.data_const       = runloop_st->runahead_save_state;
+   serialize_info.size             = runloop_st->runahead_save_state_size;
+
+   runahead_stage_start(runloop_st, &runahead_perf_unserialize);
+   ret                             = core_unserialize_special(&serialize_info);
+   runahead_stage_stop(runloop_st, &runahead_perf_unserialize);
+
    if (last_dirty)
       runloop_st->flags                      |=  RUNLOOP_FLAG_INPUT_IS_DIRTY;
    else
@@ -1088,12 +1125,15 @@ static bool runahead_load_state(runloop_state_t *runloop_st)
 #if HAVE_DYNAMIC
 static bool runahead_load_state_secondary(runloop_state_t *runloop_st, settings_t *settings)
 {
-   retro_ctx_serialize_info_t *serialize_info =
-      (retro_ctx_serialize_info_t*)runloop_st->runahead_save_state_list->data[0];
+   bool ret;
 
-   if (!secondary_core_deserialize(runloop_st,
-            settings, serialize_info->data_const,
-            serialize_info->size))
+   runahead_stage_start(runloop_st, &runahead_perf_unserialize);
+   ret = secondary_core_deserialize(runloop_st,
+         settings, runloop_st->runahead_save_state,
+         runloop_st->runahead_save_state_size);
+   runahead_stage_stop(runloop_st, &runahead_perf_unserialize);
+
+   if (!ret)
    {
       runloop_st->flags &= ~RUNLOOP_FLAG_RUNAHEAD_SECONDARY_CORE_AVAILABLE;
       runahead_error(runloop_st);
@@ -1206,6 +1246,7 @@ void runahead_run(void *data,
          {
             audio_st->flags     |=  AUDIO_FLAG_SUSPENDED;
             video_st->flags     &= ~VIDEO_FLAG_ACTIVE;
+            runahead_stage_start(runloop_st, &runahead_perf_hidden);
          }
 
          if (frame_number == 0)
@@ -1215,6 +1256,7 @@ void runahead_run(void *data,
 
          if (suspended_frame)
          {
+            runahead_stage_stop(runloop_st, &runahead_perf_hidden);
             if (video_st->flags & VIDEO_FLAG_RUNAHEAD_IS_ACTIVE)
                video_st->flags |=  VIDEO_FLAG_ACTIVE;
             else
@@ -1264,7 +1306,9 @@ void runahead_run(void *data,
 
       /* run main core with video suspended */
       video_st->flags &= ~VIDEO_FLAG_ACTIVE;
+      runahead_stage_start(runloop_st, &runahead_perf_hidden);
       core_run();
+      runahead_stage_stop(runloop_st, &runahead_perf_hidden);
       if (video_st->flags & VIDEO_FLAG_RUNAHEAD_IS_ACTIVE)
          video_st->flags |=  VIDEO_FLAG_ACTIVE;
       else
@@ -1298,10 +1342,12 @@ void runahead_run(void *data,
             video_st->flags             &= ~VIDEO_FLAG_ACTIVE;
             audio_st->flags             |= AUDIO_FLAG_SUSPENDED
                                          | AUDIO_FLAG_HARD_DISABLE;
+            runahead_stage_start(runloop_st, &runahead_perf_hidden);
             if (secondary_core_run_use_last_input(runloop_st))
                runloop_st->flags        |=  RUNLOOP_FLAG_RUNAHEAD_SECONDARY_CORE_AVAILABLE;
             else
                runloop_st->flags        &= ~RUNLOOP_FLAG_RUNAHEAD_SECONDARY_CORE_AVAILABLE;
+            runahead_stage_stop(runloop_st, &runahead_perf_hidden);
             audio_st->flags             &= ~(AUDIO_FLAG_SUSPENDED
                                          | AUDIO_FLAG_HARD_DISABLE);
             if (video_st->flags & VIDEO_FLAG_RUNAHEAD_IS_ACTIVE)
@@ -1328,6 +1374,72 @@ force_input_dirty:
    runloop_st->flags |=  RUNLOOP_FLAG_RUNAHEAD_FORCE_INPUT_DIRTY;
 }
 
+/* Frames to average over before changing the adaptive depth. */
+#define RUNAHEAD_ADAPTIVE_WINDOW 30
+
+void runahead_run_adaptive(void *data,
+      unsigned max_frames,
+      unsigned budget,
+      bool runahead_hide_warnings,
+      bool use_secondary)
+{
+   runloop_state_t *runloop_st         = (runloop_state_t*)data;
+   video_driver_state_t *video_st      = video_state_get_ptr();
+   double fps                          = video_st->av_info.timing.fps;
+   unsigned frames                     = runloop_st->runahead_adaptive_frames;
+   retro_time_t cost, period, target, average, per_frame;
+
+   if (!frames || frames > max_frames)
+      frames                           = 1;
+
+   /* Only serializing, unserializing and the hidden frames
+    * count, the visible frame and waiting on vsync or audio
+    * would be there without run-ahead too. */
+   runahead_stage_usec = 0;
+   runahead_run(runloop_st, (int)frames,
+         runahead_hide_warnings, use_secondary);
+   cost                = runahead_stage_usec;
+
+   runloop_st->runahead_adaptive_frames  = frames;
+   runloop_st->runahead_adaptive_total  += cost;
+   if (cost > runloop_st->runahead_adaptive_peak)
+      runloop_st->runahead_adaptive_peak = cost;
+
+   if (++runloop_st->runahead_adaptive_samples < RUNAHEAD_ADAPTIVE_WINDOW)
+      return;
+
+   period    = (retro_time_t)(1000000.0 / (fps > 0.0 ? fps : 60.0));
+   target    = period * budget / 100;
+   average   = runloop_st->runahead_adaptive_total
+             / runloop_st->runahead_adaptive_samples;
+   /* Every step of depth costs roughly one more hidden frame. */
+   per_frame = average / frames;
+
+   /* Drop a frame as soon as the average goes over budget, or a
+    * single frame ate the whole period; only add one back when
+    * it would still leave some headroom. */
+   if (     frames > 1
+         && (     average > target
+               || runloop_st->runahead_adaptive_peak > period))
+      frames--;
+   else if (frames < max_frames
+         && (average + per_frame) * 10 < target * 9)
+      frames++;
+
+   if (frames != runloop_st->runahead_adaptive_frames)
+   {
+      RARCH_DBG("[Run-Ahead]: Adaptive depth %u -> %u "
+            "(%u us average, %u us budget).\n",
+            runloop_st->runahead_adaptive_frames, frames,
+            (unsigned)average, (unsigned)target);
+      runloop_st->runahead_adaptive_frames = frames;
+   }
+
+   runloop_st->runahead_adaptive_total   = 0;
+   runloop_st->runahead_adaptive_peak    = 0;
+   runloop_st->runahead_adaptive_samples = 0;
+}
+
 /* Preemptive Frames */
 
 static int16_t preempt_input_state(unsigned port,
@@ -1366,6 +1478,7 @@ static const char* preempt_allocate(runloop_state_t *runloop_st,
 {
    preempt_t *preempt          = (preempt_t*)calloc(1, sizeof(preempt_t));
    retro_ctx_size_info_t info;
+   size_t stride;
    uint8_t i;
 
    if (!(runloop_st->preempt_data = preempt))
@@ -1377,14 +1490,16 @@ static const char* preempt_allocate(runloop_state_t *runloop_st,
 
    preempt->state_size = info.size;
    preempt->frames     = frames;
+   stride              = runahead_state_stride(info.size);
+
+   if (!(preempt->arena = (uint8_t*)memalign_alloc(
+               RUNAHEAD_STATE_ALIGN, stride * frames)))
+      return msg_hash_to_str(MSG_PREEMPT_FAILED_TO_ALLOCATE);
 
    for (i = 0; i < frames; i++)
-   {
-      preempt->buffer[i] = malloc(preempt->state_size);
-      if (!preempt->buffer[i])
-         return msg_hash_to_str(MSG_PREEMPT_FAILED_TO_ALLOCATE);
-   }
+      preempt->buffer[i] = preempt->arena + i * stride;
 
+   runahead_perf_init();
    return NULL;
 }
 
@@ -1398,14 +1513,13 @@ void preempt_deinit(void *data)
    runloop_state_t *runloop_st       = (runloop_state_t*)data;
    preempt_t *preempt                = runloop_st->preempt_data;
    struct retro_core_t *current_core = &runloop_st->current_core;
-   size_t i;
 
    if (!preempt)
       return;
 
    /* Free memory */
-   for (i = 0; i < preempt->frames; i++)
-      free(preempt->buffer[i]);
+   if (preempt->arena)
+      memalign_free(preempt->arena);
 
    free(preempt);
    runloop_st->preempt_data = NULL;
@@ -1621,6 +1735,8 @@ void preempt_run(preempt_t *preempt, void *data)
    settings_t *settings              = config_get_ptr();
    audio_driver_state_t *audio_st    = audio_state_get_ptr();
    video_driver_state_t *video_st    = video_state_get_ptr();
+   bool perfcnt_enable               = runloop_st->perfcnt_enable;
+   bool ok;
    
    /* Poll and check for dirty input */
    preempt_input_poll(preempt, runloop_st, settings);
@@ -1634,26 +1750,38 @@ void preempt_run(preempt_t *preempt, void *data)
       audio_st->flags |=  AUDIO_FLAG_SUSPENDED;
       video_st->flags &= ~VIDEO_FLAG_ACTIVE;
 
-      if (!current_core->retro_unserialize(
-            preempt->buffer[preempt->start_ptr], preempt->state_size))
+      performance_counter_start_plus(perfcnt_enable, runahead_perf_unserialize);
+      ok = current_core->retro_unserialize(
+            preempt->buffer[preempt->start_ptr], preempt->state_size);
+      performance_counter_stop_plus(perfcnt_enable, runahead_perf_unserialize);
+
+      if (!ok)
       {
          failed_str = msg_hash_to_str(MSG_PREEMPT_FAILED_TO_LOAD_STATE);
          goto error;
       }
 
+      performance_counter_start_plus(perfcnt_enable, runahead_perf_hidden);
       current_core->retro_run();
+      performance_counter_stop_plus(perfcnt_enable, runahead_perf_hidden);
       preempt->replay_ptr = PREEMPT_NEXT_PTR(preempt->start_ptr);
 
       while (preempt->replay_ptr != preempt->start_ptr)
       {
-         if (!current_core->retro_serialize(
-               preempt->buffer[preempt->replay_ptr], preempt->state_size))
+         performance_counter_start_plus(perfcnt_enable, runahead_perf_serialize);
+         ok = current_core->retro_serialize(
+               preempt->buffer[preempt->replay_ptr], preempt->state_size);
+         performance_counter_stop_plus(perfcnt_enable, runahead_perf_serialize);
+
+         if (!ok)
          {
             failed_str = msg_hash_to_str(MSG_PREEMPT_FAILED_TO_SAVE_STATE);
             goto error;
          }
 
+         performance_counter_start_plus(perfcnt_enable, runahead_perf_hidden);
          current_core->retro_run();
+         performance_counter_stop_plus(perfcnt_enable, runahead_perf_hidden);
          preempt->replay_ptr = PREEMPT_NEXT_PTR(preempt->replay_ptr);
       }
 
@@ -1662,8 +1790,12 @@ void preempt_run(preempt_t *preempt, void *data)
    }
 
    /* Save current state and set start_ptr to oldest state */
-   if (!current_core->retro_serialize(
-         preempt->buffer[preempt->start_ptr], preempt->state_size))
+   performance_counter_start_plus(perfcnt_enable, runahead_perf_serialize);
+   ok = current_core->retro_serialize(
+         preempt->buffer[preempt->start_ptr], preempt->state_size);
+   performance_counter_stop_plus(perfcnt_enable, runahead_perf_serialize);
+
+   if (!ok)
    {
       failed_str = msg_hash_to_str(MSG_PREEMPT_FAILED_TO_SAVE_STATE);
       goto error;
@@ -1702,4 +1834,8 @@ void runahead_clear_variables(void *data)
                                           | RUNLOOP_FLAG_RUNAHEAD_SECONDARY_CORE_AVAILABLE
                                           | RUNLOOP_FLAG_RUNAHEAD_FORCE_INPUT_DIRTY;
    runloop_st->runahead_last_frame_count  = 0;
+   runloop_st->runahead_adaptive_frames   = 0;
+   runloop_st->runahead_adaptive_samples  = 0;
+   runloop_st->runahead_adaptive_total    = 0;
+   runloop_st->runahead_adaptive_peak     = 0;
 }
@@ -40,8 +40,10 @@ typedef struct my_list_t
 
 typedef struct preemptive_frames_data
 {
-   /* Savestate buffer */
+   /* Savestate buffer, with every slot
+    * pointing into the same allocation */
    void* buffer[MAX_RUNAHEAD_FRAMES];
+   uint8_t *arena;
    size_t state_size;
 
    /* Frame count since buffer init/reset */
@@ -74,6 +76,23 @@ void runahead_run(
       bool runahead_hide_warnings,
       bool use_secondary);
 
+/**
+ * runahead_run_adaptive:
+ * @max_frames    : upper bound for the run-ahead depth
+ * @budget        : share of the frame period, in percent,
+ *                  that run-ahead may take
+ *
+ * Same as runahead_run(), but picks the depth itself from
+ * how long the previous frames spent saving and loading
+ * states and running hidden frames.
+ **/
+void runahead_run_adaptive(
+      void *data,
+      unsigned max_frames,
+      unsigned budget,
+      bool runahead_hide_warnings,
+      bool use_secondary);
+
 void runahead_clear_variables(void *data);
 
 void runahead_remember_controller_port_device(void *data,
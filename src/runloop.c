@@ -6896,6 +6896,7 @@ int runloop_iterate(void)
       unsigned run_ahead_num_frames     = settings->uints.run_ahead_frames;
       bool run_ahead_hide_warnings      = settings->bools.run_ahead_hide_warnings;
       bool run_ahead_secondary_instance = settings->bools.run_ahead_secondary_instance;
+      bool run_ahead_adaptive           = settings->bools.run_ahead_adaptive;
       /* Run Ahead Feature replaces the call to core_run in this loop */
       bool want_runahead                = run_ahead_enabled
             && (run_ahead_num_frames > 0) 
@@ -6905,7 +6906,14 @@ int runloop_iterate(void)
             && !netplay_driver_ctl(RARCH_NETPLAY_CTL_IS_ENABLED, NULL);
 #endif
 
-      if (want_runahead)
+      if (want_runahead && run_ahead_adaptive)
+         runahead_run_adaptive(
+               runloop_st,
+               run_ahead_num_frames,
+               settings->uints.run_ahead_adaptive_budget,
+               run_ahead_hide_warnings,
+               run_ahead_secondary_instance);
+      else if (want_runahead)
          runahead_run(
                runloop_st,
                run_ahead_num_frames,
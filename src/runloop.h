@@ -176,6 +176,10 @@ struct runloop
    struct retro_core_t        current_core;     /* uint64_t alignment */
 #if defined(HAVE_RUNAHEAD)
    uint64_t runahead_last_frame_count;          /* uint64_t alignment */
+   /* Adaptive run-ahead: time spent in run-ahead
+    * over the current window, and its worst frame */
+   retro_time_t runahead_adaptive_total;        /* int64_t alignment */
+   retro_time_t runahead_adaptive_peak;         /* int64_t alignment */
 #if defined(HAVE_DYNAMIC) || defined(HAVE_DYLIB)
    struct retro_core_t secondary_core;          /* uint64_t alignment */
 #endif
@@ -183,7 +187,7 @@ struct runloop
 #if defined(HAVE_DYNAMIC) || defined(HAVE_DYLIB)
    char    *secondary_library_path;
 #endif
-   my_list *runahead_save_state_list;
+   void *runahead_save_state;
    my_list *input_state_list;
    preempt_t *preempt_data;
 #endif
@@ -254,6 +258,10 @@ struct runloop
    unsigned subsystem_current_count;
    unsigned entry_state_slot;
    unsigned video_swap_interval_auto;
+#if defined(HAVE_RUNAHEAD)
+   unsigned runahead_adaptive_frames;
+   unsigned runahead_adaptive_samples;
+#endif
 
    fastmotion_overrides_t fastmotion_override; /* float alignment */
 
@@ -24,10 +24,16 @@
 #include <string.h>
 
 #include <retro_inline.h>
+#include <retro_miscellaneous.h>
 #include <compat/strl.h>
-#include <compat/intrinsics.h>
+#include <streams/trans_stream.h>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
 
 #include "state_manager.h"
+#include "state_manager_delta.h"
 #include "msg_hash.h"
 #include "core.h"
 #include "core_info.h"
@@ -40,339 +46,661 @@
 #include "network/netplay/netplay.h"
 #endif
 
+/* Pushes to go without page hashes after most pages turned out dirty. */
+#define STATE_MANAGER_PAGE_BACKOFF 120
+
 /* This makes Valgrind throw errors if a core overflows its savestate size. */
 /* Keep it off unless you're chasing a core bug, it slows things down. */
 #define STRICT_BUF_SIZE 0
 
-#ifndef UINT16_MAX
-#define UINT16_MAX 0xffff
-#endif
+/* The start offsets point to 'nextstart' of any given compressed frame.
+ * Each uint16 is stored native endian; anything that claims any other
+ * endianness refers to the endianness of this specific item.
+ * The uint32 is stored little endian.
+ *
+ * Each size value is stored native endian if alignment is not enforced;
+ * if it is, they're little endian.
+ *
+ * The start of the buffer contains a size pointing to the end of the
+ * buffer; the end points to its start.
+ *
+ * Wrapping is handled by returning to the start of the buffer if the
+ * compressed data could potentially hit the edge;
+ *
+ * if the compressed data could potentially overwrite the tail pointer,
+ * the tail retreats until it can no longer collide.
+ *
+ * This means that on average, ~2 * maxcompsize is
+ * unused at any given moment. */
 
-#ifndef UINT32_MAX
-#define UINT32_MAX 0xffffffffu
-#endif
+/* These are called very few constant times per frame,
+ * keep it as simple as possible. */
+static INLINE void write_size_t(void *ptr, size_t val)
+{
+   memcpy(ptr, &val, sizeof(val));
+}
 
-#if defined(__x86_64__) || defined(__i386__) || defined(__i486__) || defined(__i686__) || defined(_M_IX86) || defined(_M_AMD64) || defined(_M_X64)
-#define CPU_X86
-#endif
+static INLINE size_t read_size_t(const void *ptr)
+{
+   size_t ret;
 
-/* Other arches SIGBUS (usually) on unaligned accesses. */
-#ifndef CPU_X86
-#define NO_UNALIGNED_MEM
-#endif
+   memcpy(&ret, ptr, sizeof(ret));
+   return ret;
+}
+
+/* Tiered mode.
+ *
+ * The ring above only holds the most recent patches. When it
+ * has to drop its oldest patch, the patch is appended to the
+ * newest 'cold' segment instead; once a segment has collected
+ * STATE_MANAGER_SEGMENT_SIZE bytes it is deflated as a whole,
+ * which packs the (already sparse) patches several times tighter.
+ * Segments are kept oldest first and form one chain with the ring,
+ * so popping past the ring simply continues in the cold tier.
+ *
+ * Every STATE_MANAGER_KEYFRAME_INTERVAL pushes, the full state is
+ * deflated into a keyframe as well, so seeking backwards only has
+ * to replay the patches between the target and the next keyframe.
+ * A keyframe is deflated STATE_MANAGER_KEYFRAME_SLICES pieces at a
+ * time, one per push, rather than stalling a single frame.
+ *
+ * Sequence numbers: 'seq' is the number of the state in thisblock,
+ * and the patch numbered N turns state N into state N - 1. */
+#define STATE_MANAGER_SEGMENT_SIZE       (256 * 1024)
+#define STATE_MANAGER_KEYFRAME_INTERVAL  300
+#define STATE_MANAGER_KEYFRAME_SLICES     32
+
+struct state_manager_segment
+{
+   uint8_t *data;
+   size_t size;          /* bytes held in 'data' */
+   size_t raw_size;      /* size once inflated */
+   uint64_t first_seq;   /* sequence number of the oldest patch */
+   unsigned count;       /* number of patches still valid */
+   bool sealed;          /* no more patches are appended */
+   bool deflated;
+};
+
+struct state_manager_keyframe
+{
+   uint8_t *data;
+   size_t size;
+   uint64_t seq;
+};
+
+struct state_manager_cold
+{
+   const struct trans_stream_backend *deflate_backend;
+   const struct trans_stream_backend *inflate_backend;
+   void *deflate_stream;
+   void *inflate_stream;
+
+   struct state_manager_segment *segments;   /* oldest first */
+   struct state_manager_keyframe *keyframes; /* oldest first */
+   size_t num_segments;
+   size_t cap_segments;
+   size_t num_keyframes;
+   size_t cap_keyframes;
+
+   /* Patch offsets of the segment being popped through,
+    * along with its inflated copy if it was deflated. */
+   uint8_t *cache;
+   size_t *offsets;
+   size_t cache_cap;
+   size_t offsets_cap;
+   size_t cached;        /* segment index + 1, 0 if none */
+
+   /* Deflate output, large enough for a whole segment. */
+   uint8_t *scratch;
+   size_t scratch_size;
+
+   /* Keyframe being deflated; 'key_in' is a copy of the
+    * state numbered 'key_seq', 'key_pos' how much of it
+    * went into 'key_stream' so far. */
+   void *key_stream;
+   uint8_t *key_in;
+   uint8_t *key_out;
+   size_t key_size;
+   size_t key_out_size;
+   size_t key_slice;
+   size_t key_pos;
+   size_t key_written;
+   uint64_t key_seq;
+   bool key_busy;
+
+   size_t used;
+   size_t budget;
+};
+
+static void state_manager_cold_free(struct state_manager_cold *cold)
+{
+   size_t i;
+
+   if (!cold)
+      return;
+
+   for (i = 0; i < cold->num_segments; i++)
+      free(cold->segments[i].data);
+   for (i = 0; i < cold->num_keyframes; i++)
+      free(cold->keyframes[i].data);
+
+   if (cold->deflate_stream)
+      cold->deflate_backend->stream_free(cold->deflate_stream);
+   if (cold->inflate_stream)
+      cold->inflate_backend->stream_free(cold->inflate_stream);
+   if (cold->key_stream)
+      cold->deflate_backend->stream_free(cold->key_stream);
+
+   free(cold->segments);
+   free(cold->keyframes);
+   free(cold->cache);
+   free(cold->offsets);
+   free(cold->scratch);
+   free(cold->key_in);
+   free(cold->key_out);
+   free(cold);
+}
 
-#if __SSE2__
-#include <emmintrin.h>
+/* Most bytes deflating 'size' bytes can produce. */
+static size_t state_manager_cold_bound(size_t size)
+{
+#ifdef HAVE_ZLIB
+   return deflateBound(NULL, (uLong)size);
+#else
+   return size;
 #endif
+}
 
-/* Format per frame (pseudocode): */
-#if 0
-size nextstart;
-repeat {
-   uint16 numchanged; /* everything is counted in units of uint16 */
-   if (numchanged)
+static void *state_manager_cold_stream_new(
+      const struct trans_stream_backend *backend)
+{
+   void *stream = backend->stream_new();
+   if (stream && backend->define)
+      backend->define(stream, "level", 1);
+   return stream;
+}
+
+/* zlib only resets a stream once it reaches its end, after
+ * an error it would be stuck halfway. Throws it away so that
+ * the next use starts over with a new one. */
+static void state_manager_cold_stream_reset(
+      const struct trans_stream_backend *backend, void **stream)
+{
+   if (*stream)
+      backend->stream_free(*stream);
+   *stream = NULL;
+}
+
+static struct state_manager_cold *state_manager_cold_new(
+      size_t block_size, size_t max_comp_size, size_t budget)
+{
+   struct state_manager_cold *cold = (struct state_manager_cold*)
+      calloc(1, sizeof(*cold));
+
+   if (!cold)
+      return NULL;
+
+   /* Without zlib this still works, it just stores
+    * the segments and keyframes as they are. */
+   if (!(cold->deflate_backend = trans_stream_get_zlib_deflate_backend()))
+      cold->deflate_backend    = trans_stream_get_pipe_backend();
+   cold->inflate_backend       = cold->deflate_backend->reverse;
+
+   /* A segment is sealed once it reaches STATE_MANAGER_SEGMENT_SIZE,
+    * so it can overshoot that by up to one patch. */
+   cold->scratch_size          = state_manager_cold_bound(
+         STATE_MANAGER_SEGMENT_SIZE + max_comp_size);
+   cold->scratch               = (uint8_t*)malloc(cold->scratch_size);
+   cold->key_size              = block_size;
+   cold->key_out_size          = state_manager_cold_bound(block_size);
+   cold->key_slice             = MAX(block_size
+         / STATE_MANAGER_KEYFRAME_SLICES, 4096);
+   cold->key_in                = (uint8_t*)malloc(block_size);
+   cold->key_out               = (uint8_t*)malloc(cold->key_out_size);
+   cold->budget                = budget;
+
+   if (     !cold->scratch
+         || !cold->key_in
+         || !cold->key_out)
    {
-      uint16 numunchanged; /* skip these before handling numchanged */
-      uint16[numchanged] changeddata;
+      state_manager_cold_free(cold);
+      return NULL;
    }
-   else
+
+   return cold;
+}
+
+/* Returns the number of bytes written to 'scratch', 0 on failure. */
+static size_t state_manager_cold_deflate(struct state_manager_cold *cold,
+      const uint8_t *in, size_t in_size)
+{
+   uint32_t rd, wn;
+   enum trans_stream_error err;
+
+   if (      !cold->deflate_stream
+         && !(cold->deflate_stream = state_manager_cold_stream_new(
+               cold->deflate_backend)))
+      return 0;
+
+   cold->deflate_backend->set_in(cold->deflate_stream,
+         in, (uint32_t)in_size);
+   cold->deflate_backend->set_out(cold->deflate_stream,
+         cold->scratch, (uint32_t)cold->scratch_size);
+
+   if (    !cold->deflate_backend->trans(cold->deflate_stream,
+            true, &rd, &wn, &err)
+         || err != TRANS_STREAM_ERROR_NONE
+         || rd  != in_size)
    {
-      uint32 numunchanged;
-      if (!numunchanged)
-         break;
+      state_manager_cold_stream_reset(cold->deflate_backend,
+            &cold->deflate_stream);
+      return 0;
    }
+   return wn;
 }
-size thisstart;
-#endif
 
-/* There's no equivalent in libc, you'd think so ...
- * std::mismatch exists, but it's not optimized at all. */
-static size_t find_change(const uint16_t *a, const uint16_t *b)
+static bool state_manager_cold_inflate(struct state_manager_cold *cold,
+      const uint8_t *in, size_t in_size, uint8_t *out, size_t out_size)
 {
-#if __SSE2__
-   const __m128i *a128 = (const __m128i*)a;
-   const __m128i *b128 = (const __m128i*)b;
+   uint32_t rd, wn;
+   enum trans_stream_error err;
 
-   for (;;)
+   if (      !cold->inflate_stream
+         && !(cold->inflate_stream = state_manager_cold_stream_new(
+               cold->inflate_backend)))
+      return false;
+
+   cold->inflate_backend->set_in(cold->inflate_stream,
+         in, (uint32_t)in_size);
+   cold->inflate_backend->set_out(cold->inflate_stream,
+         out, (uint32_t)out_size);
+
+   if (     !cold->inflate_backend->trans(cold->inflate_stream,
+            true, &rd, &wn, &err)
+         || err != TRANS_STREAM_ERROR_NONE
+         || wn  != out_size)
    {
-      __m128i v0    = _mm_loadu_si128(a128);
-      __m128i v1    = _mm_loadu_si128(b128);
-      __m128i c     = _mm_cmpeq_epi8(v0, v1);
-      uint32_t mask = _mm_movemask_epi8(c);
+      state_manager_cold_stream_reset(cold->inflate_backend,
+            &cold->inflate_stream);
+      return false;
+   }
+   return true;
+}
 
-      if (mask != 0xffff) /* Something has changed, figure out where. */
-      {
-         /* calculate the real offset to the differing byte */
-         size_t ret = (((uint8_t*)a128 - (uint8_t*)a) |
-               (compat_ctz(~mask)));
+/* Replaces 'data' with its deflated copy if that is any smaller. */
+static void state_manager_cold_shrink(struct state_manager_cold *cold,
+      uint8_t **data, size_t *size, bool *deflated)
+{
+   uint8_t *packed;
+   size_t packed_size = state_manager_cold_deflate(cold, *data, *size);
 
-         /* and convert that to the uint16_t offset */
-         return (ret >> 1);
-      }
+   *deflated          = false;
 
-      a128++;
-      b128++;
-   }
-#else
-   const uint16_t *a_org = a;
-#ifdef NO_UNALIGNED_MEM
-   while (((uintptr_t)a & (sizeof(size_t) - 1)) && *a == *b)
+   if (!packed_size || packed_size >= *size)
+      return;
+   if (!(packed = (uint8_t*)malloc(packed_size)))
+      return;
+
+   memcpy(packed, cold->scratch, packed_size);
+   free(*data);
+   cold->used        -= *size - packed_size;
+   *data              = packed;
+   *size              = packed_size;
+   *deflated          = true;
+}
+
+/* Oldest state that can still be reached. */
+static uint64_t state_manager_oldest_seq(state_manager_t *state)
+{
+   struct state_manager_cold *cold = state->cold;
+
+   if (cold && cold->num_segments)
+      return cold->segments[0].first_seq - 1;
+   if (state->head != state->tail)
+      return state->tail_seq - 1;
+   return state->seq;
+}
+
+static void state_manager_cold_drop_segment(struct state_manager_cold *cold)
+{
+   cold->used -= cold->segments[0].size;
+   free(cold->segments[0].data);
+   memmove(cold->segments, cold->segments + 1,
+         (cold->num_segments - 1) * sizeof(*cold->segments));
+   cold->num_segments--;
+   cold->cached = 0;
+}
+
+static void state_manager_cold_drop_keyframe(struct state_manager_cold *cold,
+      size_t idx)
+{
+   cold->used -= cold->keyframes[idx].size;
+   free(cold->keyframes[idx].data);
+   memmove(cold->keyframes + idx, cold->keyframes + idx + 1,
+         (cold->num_keyframes - idx - 1) * sizeof(*cold->keyframes));
+   cold->num_keyframes--;
+}
+
+/* Evicts the oldest data until the tier fits its budget again. */
+static void state_manager_cold_trim(state_manager_t *state)
+{
+   struct state_manager_cold *cold = state->cold;
+
+   for (;;)
    {
-      a++;
-      b++;
+      uint64_t oldest = state_manager_oldest_seq(state);
+
+      /* Keyframes older than anything reachable are useless. */
+      while (cold->num_keyframes && cold->keyframes[0].seq < oldest)
+         state_manager_cold_drop_keyframe(cold, 0);
+
+      if (cold->used <= cold->budget)
+         break;
+
+      if (cold->num_segments)
+         state_manager_cold_drop_segment(cold);
+      else if (cold->num_keyframes)
+         state_manager_cold_drop_keyframe(cold, 0);
+      else
+         break;
    }
-   if (*a == *b)
-#endif
+}
+
+/* Moves a patch dropped from the tail of the ring into the cold tier.
+ * While a segment is open, 'raw_size' is its allocated size. */
+static void state_manager_cold_push_patch(state_manager_t *state,
+      const uint8_t *patch, uint64_t seq)
+{
+   struct state_manager_segment *seg = NULL;
+   struct state_manager_cold *cold   = state->cold;
+   size_t size                       = state_manager_raw_patch_size(patch);
+
+   cold->cached                      = 0;
+
+   if (cold->num_segments)
    {
-      const size_t *a_big = (const size_t*)a;
-      const size_t *b_big = (const size_t*)b;
+      seg = &cold->segments[cold->num_segments - 1];
 
-      while (*a_big == *b_big)
+      /* The chain must stay contiguous; if a patch was lost
+       * on an allocation failure, forget everything older. */
+      if (seg->first_seq + seg->count != seq)
       {
-         a_big++;
-         b_big++;
+         while (cold->num_segments)
+            state_manager_cold_drop_segment(cold);
+         seg = NULL;
       }
-      a = (const uint16_t*)a_big;
-      b = (const uint16_t*)b_big;
+   }
 
-      while (*a == *b)
+   if (!seg || seg->sealed)
+   {
+      if (cold->num_segments == cold->cap_segments)
       {
-         a++;
-         b++;
+         size_t new_cap = cold->cap_segments ? cold->cap_segments * 2 : 16;
+         struct state_manager_segment *segments =
+            (struct state_manager_segment*)realloc(cold->segments,
+                  new_cap * sizeof(*segments));
+         if (!segments)
+            return;
+         cold->segments     = segments;
+         cold->cap_segments = new_cap;
       }
+
+      seg            = &cold->segments[cold->num_segments];
+      memset(seg, 0, sizeof(*seg));
+      seg->raw_size  = STATE_MANAGER_SEGMENT_SIZE + size;
+      if (!(seg->data = (uint8_t*)malloc(seg->raw_size)))
+         return;
+      seg->first_seq = seq;
+      cold->num_segments++;
    }
-   return a - a_org;
-#endif
+   else if (seg->size + size > seg->raw_size)
+   {
+      uint8_t *data = (uint8_t*)realloc(seg->data, seg->size + size);
+      if (!data)
+         return;
+      seg->data     = data;
+      seg->raw_size = seg->size + size;
+   }
+
+   memcpy(seg->data + seg->size, patch, size);
+   seg->size  += size;
+   seg->count++;
+   cold->used += size;
+
+   if (seg->size >= STATE_MANAGER_SEGMENT_SIZE)
+   {
+      seg->raw_size = seg->size;
+      seg->sealed   = true;
+      state_manager_cold_shrink(cold, &seg->data, &seg->size, &seg->deflated);
+   }
+
+   state_manager_cold_trim(state);
 }
 
-static size_t find_same(const uint16_t *a, const uint16_t *b)
+static void state_manager_cold_push_keyframe(state_manager_t *state,
+      const uint8_t *data, size_t size, uint64_t seq)
 {
-   const uint16_t *a_org = a;
-#ifdef NO_UNALIGNED_MEM
-   if (((uintptr_t)a & (sizeof(uint32_t) - 1)) && *a != *b)
+   struct state_manager_keyframe *key;
+   struct state_manager_cold *cold = state->cold;
+
+   if (cold->num_keyframes == cold->cap_keyframes)
    {
-      a++;
-      b++;
+      size_t new_cap = cold->cap_keyframes ? cold->cap_keyframes * 2 : 8;
+      struct state_manager_keyframe *keyframes =
+         (struct state_manager_keyframe*)realloc(cold->keyframes,
+               new_cap * sizeof(*keyframes));
+      if (!keyframes)
+         return;
+      cold->keyframes     = keyframes;
+      cold->cap_keyframes = new_cap;
    }
-   if (*a != *b)
-#endif
-   {
-      /* With this, it's random whether two consecutive identical
-       * words are caught.
-       *
-       * Luckily, compression rate is the same for both cases, and
-       * three is always caught.
-       *
-       * (We prefer to miss two-word blocks, anyways; fewer iterations
-       * of the outer loop, as well as in the decompressor.) */
-      const uint32_t *a_big = (const uint32_t*)a;
-      const uint32_t *b_big = (const uint32_t*)b;
-
-      while (*a_big != *b_big)
-      {
-         a_big++;
-         b_big++;
-      }
-      a = (const uint16_t*)a_big;
-      b = (const uint16_t*)b_big;
 
-      if (a != a_org && a[-1] == b[-1])
-      {
-         a--;
-         b--;
-      }
-   }
-   return a - a_org;
+   key = &cold->keyframes[cold->num_keyframes];
+   if (!(key->data = (uint8_t*)malloc(size)))
+      return;
+
+   memcpy(key->data, data, size);
+   key->size   = size;
+   key->seq    = seq;
+   cold->used += size;
+   cold->num_keyframes++;
+
+   state_manager_cold_trim(state);
 }
 
-/* Returns the maximum compressed size of a savestate.
- * It is very likely to compress to far less. */
-static size_t state_manager_raw_maxsize(size_t uncomp)
+static void state_manager_cold_cancel_keyframe(
+      struct state_manager_cold *cold)
 {
-   /* bytes covered by a compressed block */
-   const int maxcblkcover = UINT16_MAX * sizeof(uint16_t);
-   /* uncompressed size, rounded to 16 bits */
-   size_t uncomp16        = (uncomp + sizeof(uint16_t) - 1) & -sizeof(uint16_t);
-   /* number of blocks */
-   size_t maxcblks        = (uncomp + maxcblkcover - 1) / maxcblkcover;
-   return uncomp16 + maxcblks * sizeof(uint16_t) * 2 /* two u16 overhead per block */ + sizeof(uint16_t) *
-      3; /* three u16 to end it */
+   if (!cold->key_busy)
+      return;
+   state_manager_cold_stream_reset(cold->deflate_backend,
+         &cold->key_stream);
+   cold->key_busy = false;
 }
 
-/*
- * See state_manager_raw_compress for information about this.
- * When you're done with it, send it to free().
- */
-static void *state_manager_raw_alloc(size_t len, uint16_t uniq)
+/* Takes a copy of thisblock, which is deflated over the next
+ * pushes by state_manager_cold_step_keyframe(). */
+static void state_manager_cold_start_keyframe(state_manager_t *state)
 {
-   size_t  len16 = (len + sizeof(uint16_t) - 1) & -sizeof(uint16_t);
-   uint16_t *ret = (uint16_t*)calloc(len16 + sizeof(uint16_t) * 4 + 16, 1);
+   struct state_manager_cold *cold = state->cold;
 
-   if (!ret)
-      return NULL;
+   if (cold->key_busy)
+      return;
 
-   /* Force in a different byte at the end, so we don't need to check
-    * bounds in the innermost loop (it's expensive).
-    *
-    * There is also a large amount of data that's the same, to stop
-    * the other scan.
-    *
-    * There is also some padding at the end. This is so we don't
-    * read outside the buffer end if we're reading in large blocks;
-    *
-    * It doesn't make any difference to us, but sacrificing 16 bytes to get
-    * Valgrind happy is worth it. */
-   ret[len16/sizeof(uint16_t) + 3] = uniq;
+   if (      !cold->key_stream
+         && !(cold->key_stream = state_manager_cold_stream_new(
+               cold->deflate_backend)))
+      return;
 
-   return ret;
+   memcpy(cold->key_in, state->thisblock, cold->key_size);
+   cold->key_seq     = state->seq;
+   cold->key_pos     = 0;
+   cold->key_written = 0;
+   cold->key_busy    = true;
 }
 
-/*
- * Takes two savestates and creates a patch that turns 'src' into 'dst'.
- * Both 'src' and 'dst' must be returned from state_manager_raw_alloc(),
- * with the same 'len', and different 'uniq'.
- *
- * 'patch' must be size 'state_manager_raw_maxsize(len)' or more.
- * Returns the number of bytes actually written to 'patch'.
- */
-static size_t state_manager_raw_compress(const void *src,
-      const void *dst, size_t len, void *patch)
+/* Deflates the next slice of the pending keyframe, and
+ * stores the keyframe once the last one is done. */
+static void state_manager_cold_step_keyframe(state_manager_t *state)
 {
-   const uint16_t  *old16 = (const uint16_t*)src;
-   const uint16_t  *new16 = (const uint16_t*)dst;
-   uint16_t *compressed16 = (uint16_t*)patch;
-   size_t          num16s = (len + sizeof(uint16_t) - 1)
-      / sizeof(uint16_t);
+   uint32_t rd, wn;
+   enum trans_stream_error err;
+   bool last;
+   size_t len;
+   struct state_manager_cold *cold = state->cold;
+
+   if (!cold->key_busy)
+      return;
+
+   len  = MIN(cold->key_slice, cold->key_size - cold->key_pos);
+   last = cold->key_pos + len == cold->key_size;
 
-   while (num16s)
+   cold->deflate_backend->set_in(cold->key_stream,
+         cold->key_in + cold->key_pos, (uint32_t)len);
+   cold->deflate_backend->set_out(cold->key_stream,
+         cold->key_out + cold->key_written,
+         (uint32_t)(cold->key_out_size - cold->key_written));
+
+   if (     !cold->deflate_backend->trans(cold->key_stream,
+            last, &rd, &wn, &err)
+         || rd != len
+         || (last && err != TRANS_STREAM_ERROR_NONE))
    {
-      size_t i, changed;
-      size_t skip = find_change(old16, new16);
+      state_manager_cold_cancel_keyframe(cold);
+      return;
+   }
 
-      if (skip >= num16s)
-         break;
+   cold->key_pos     += len;
+   cold->key_written += wn;
 
-      old16  += skip;
-      new16  += skip;
-      num16s -= skip;
+   if (!last)
+      return;
 
-      if (skip > UINT16_MAX)
-      {
-         /* This will make it scan the entire thing again,
-          * but it only hits on 8GB unchanged data anyways,
-          * and if you're doing that, you've got bigger problems. */
-         if (skip > UINT32_MAX)
-            skip         = UINT32_MAX;
-
-         *compressed16++ = 0;
-         *compressed16++ = skip;
-         *compressed16++ = skip >> 16;
-         continue;
-      }
+   cold->key_busy     = false;
+   state_manager_cold_push_keyframe(state, cold->key_out,
+         cold->key_written, cold->key_seq);
+}
 
-      changed         = find_same(old16, new16);
-      if (changed > UINT16_MAX)
-         changed = UINT16_MAX;
+/* Points 'offsets' (and 'cache', if needed) at the newest segment. */
+static const uint8_t *state_manager_cold_prepare(
+      struct state_manager_cold *cold)
+{
+   size_t i, pos;
+   const uint8_t *src;
+   size_t idx                        = cold->num_segments - 1;
+   struct state_manager_segment *seg = &cold->segments[idx];
 
-      *compressed16++ = changed;
-      *compressed16++ = skip;
+   if (seg->deflated)
+   {
+      if (cold->cached != idx + 1)
+      {
+         if (cold->cache_cap < seg->raw_size)
+         {
+            uint8_t *cache = (uint8_t*)realloc(cold->cache, seg->raw_size);
+            if (!cache)
+               return NULL;
+            cold->cache     = cache;
+            cold->cache_cap = seg->raw_size;
+         }
+
+         if (!state_manager_cold_inflate(cold, seg->data, seg->size,
+                  cold->cache, seg->raw_size))
+            return NULL;
+      }
+      src = cold->cache;
+   }
+   else
+      src = seg->data;
 
-      for (i = 0; i < changed; i++)
-         compressed16[i] = old16[i];
+   if (cold->cached == idx + 1)
+      return src;
 
-      old16        += changed;
-      new16        += changed;
-      num16s       -= changed;
-      compressed16 += changed;
+   if (cold->offsets_cap < seg->count)
+   {
+      size_t *offsets = (size_t*)realloc(cold->offsets,
+            seg->count * sizeof(*offsets));
+      if (!offsets)
+         return NULL;
+      cold->offsets     = offsets;
+      cold->offsets_cap = seg->count;
    }
 
-   compressed16[0]  = 0;
-   compressed16[1]  = 0;
-   compressed16[2]  = 0;
+   for (i = 0, pos = 0; i < seg->count; i++)
+   {
+      cold->offsets[i] = pos;
+      pos             += state_manager_raw_patch_size(src + pos);
+   }
 
-   return (uint8_t*)(compressed16 + 3) - (uint8_t*)patch;
+   cold->cached = idx + 1;
+   return src;
 }
 
-/*
- * Takes 'patch' from a previous call to 'state_manager_raw_compress'
- * and applies it to 'data' ('src' from that call),
- * yielding 'dst' in that call.
- *
- * If the given arguments do not match a previous call to
- * state_manager_raw_compress(), anything at all can happen.
- */
-static void state_manager_raw_decompress(const void *patch,
-      size_t patchlen, void *data, size_t datalen)
+/* Removes the newest cold patch, applying it to thisblock if asked. */
+static bool state_manager_cold_take_patch(state_manager_t *state,
+      bool apply)
 {
-   uint16_t         *out16 = (uint16_t*)data;
-   const uint16_t *patch16 = (const uint16_t*)patch;
+   const uint8_t *src;
+   struct state_manager_segment *seg;
+   struct state_manager_cold *cold = state->cold;
 
-   for (;;)
-   {
-      uint16_t numchanged  = *(patch16++);
+   if (!cold->num_segments)
+      return false;
 
-      if (numchanged)
-      {
-         uint16_t i;
+   seg = &cold->segments[cold->num_segments - 1];
+
+   if (seg->first_seq + seg->count - 1 != state->seq)
+      return false;
 
-         out16       += *patch16++;
+   /* Sealed segments only need their count adjusted
+    * when the patch is dropped rather than applied. */
+   if (apply || !seg->sealed)
+   {
+      if (!(src = state_manager_cold_prepare(cold)))
+         return false;
 
-         /* We could do memcpy, but it seems that memcpy has a
-          * constant-per-call overhead that actually shows up.
-          *
-          * Our average size in here seems to be 8 or something.
-          * Therefore, we do something with lower overhead. */
-         for (i = 0; i < numchanged; i++)
-            out16[i]  = patch16[i];
+      if (apply)
+         state_manager_raw_decompress(src + cold->offsets[seg->count - 1],
+               state->maxcompsize, state->thisblock, state->blocksize);
 
-         patch16     += numchanged;
-         out16       += numchanged;
-      }
-      else
+      if (!seg->sealed)
       {
-         uint32_t numunchanged = patch16[0] | (patch16[1] << 16);
-
-         if (!numunchanged)
-            break;
-         patch16 += 2;
-         out16   += numunchanged;
+         cold->used -= seg->size - cold->offsets[seg->count - 1];
+         seg->size   = cold->offsets[seg->count - 1];
       }
    }
-}
 
-/* The start offsets point to 'nextstart' of any given compressed frame.
- * Each uint16 is stored native endian; anything that claims any other
- * endianness refers to the endianness of this specific item.
- * The uint32 is stored little endian.
- *
- * Each size value is stored native endian if alignment is not enforced;
- * if it is, they're little endian.
- *
- * The start of the buffer contains a size pointing to the end of the
- * buffer; the end points to its start.
- *
- * Wrapping is handled by returning to the start of the buffer if the
- * compressed data could potentially hit the edge;
- *
- * if the compressed data could potentially overwrite the tail pointer,
- * the tail retreats until it can no longer collide.
- *
- * This means that on average, ~2 * maxcompsize is
- * unused at any given moment. */
+   if (!--seg->count)
+   {
+      cold->used -= seg->size;
+      free(seg->data);
+      cold->num_segments--;
+      cold->cached = 0;
+   }
 
-/* These are called very few constant times per frame,
- * keep it as simple as possible. */
-static INLINE void write_size_t(void *ptr, size_t val)
+   return true;
+}
+
+/* Forgets the whole cold history, used when the chain breaks. */
+static void state_manager_cold_clear(struct state_manager_cold *cold)
 {
-   memcpy(ptr, &val, sizeof(val));
+   state_manager_cold_cancel_keyframe(cold);
+   while (cold->num_segments)
+      state_manager_cold_drop_segment(cold);
+   while (cold->num_keyframes)
+      state_manager_cold_drop_keyframe(cold, 0);
 }
 
-static INLINE size_t read_size_t(const void *ptr)
+/* Drops keyframes of states that will now be overwritten. */
+static void state_manager_cold_drop_future(state_manager_t *state)
 {
-   size_t ret;
+   struct state_manager_cold *cold = state->cold;
 
-   memcpy(&ret, ptr, sizeof(ret));
-   return ret;
+   if (cold->key_busy && cold->key_seq > state->seq)
+      state_manager_cold_cancel_keyframe(cold);
+
+   while (     cold->num_keyframes
+         && cold->keyframes[cold->num_keyframes - 1].seq > state->seq)
+      state_manager_cold_drop_keyframe(cold, cold->num_keyframes - 1);
 }
 
 static void state_manager_free(state_manager_t *state)
@@ -380,6 +708,44 @@ static void state_manager_free(state_manager_t *state)
    if (!state)
       return;
 
+#ifdef HAVE_THREADS
+   if (state->thread)
+   {
+      slock_lock(state->lock);
+      state->thread_quit = true;
+      scond_signal(state->cond);
+      slock_unlock(state->lock);
+      sthread_join(state->thread);
+
+      if (state->frames_dropped)
+         RARCH_LOG("[Rewind]: Worker fell behind, %u frames dropped.\n",
+               state->frames_dropped);
+   }
+   if (state->lock)
+      slock_free(state->lock);
+   if (state->cond)
+      scond_free(state->cond);
+   if (state->slots[0])
+      free(state->slots[0]);
+   if (state->slots[1])
+      free(state->slots[1]);
+   state->thread     = NULL;
+   state->lock       = NULL;
+   state->cond       = NULL;
+   state->slots[0]   = NULL;
+   state->slots[1]   = NULL;
+#endif
+
+   state_manager_cold_free(state->cold);
+   state->cold       = NULL;
+
+   if (state->page_hashes)
+      free(state->page_hashes);
+   if (state->page_dirty)
+      free(state->page_dirty);
+   state->page_hashes = NULL;
+   state->page_dirty  = NULL;
+
    if (state->data)
       free(state->data);
    if (state->thisblock)
@@ -396,10 +762,100 @@ static void state_manager_free(state_manager_t *state)
    state->nextblock  = NULL;
 }
 
+static void state_manager_push_block(state_manager_t *state);
+
+#ifdef HAVE_THREADS
+/* Compresses the serialized slots handed over by the main thread,
+ * oldest first. Once a slot is consumed it holds the previous
+ * 'thisblock' and can be reused for capture. */
+static void state_manager_thread(void *data)
+{
+   state_manager_t *state = (state_manager_t*)data;
+
+   slock_lock(state->lock);
+
+   for (;;)
+   {
+      unsigned slot;
+
+      while (!state->slot_count && !state->thread_quit)
+         scond_wait(state->cond, state->lock);
+
+      if (state->thread_quit)
+         break;
+
+      slot               = state->slot_read;
+      state->nextblock   = state->slots[slot];
+      slock_unlock(state->lock);
+
+      state_manager_push_block(state);
+
+      slock_lock(state->lock);
+      state->slots[slot] = state->nextblock;
+      state->nextblock   = NULL;
+      state->slot_read   = (slot + 1) & 1;
+      state->slot_count--;
+      scond_signal(state->cond);
+   }
+
+   slock_unlock(state->lock);
+}
+
+/* Waits until the worker has appended every pending slot,
+ * after which the main thread owns the buffer again. */
+static void state_manager_flush(state_manager_t *state)
+{
+   if (!state->thread)
+      return;
+
+   slock_lock(state->lock);
+   while (state->slot_count)
+      scond_wait(state->cond, state->lock);
+   slock_unlock(state->lock);
+}
+
+static bool state_manager_thread_init(state_manager_t *state,
+      size_t state_size)
+{
+   /* 'nextblock' becomes the first capture slot, the worker
+    * only borrows it while compressing. */
+   state->slots[0]  = state->nextblock;
+   state->slots[1]  = (uint8_t*)state_manager_raw_alloc(state_size, 2);
+   state->nextblock = NULL;
+
+   if (!state->slots[1])
+      return false;
+   if (!(state->lock = slock_new()))
+      return false;
+   if (!(state->cond = scond_new()))
+      return false;
+   if (!(state->thread = sthread_create(state_manager_thread, state)))
+      return false;
+
+   return true;
+}
+
+static void state_manager_thread_deinit(state_manager_t *state)
+{
+   if (state->cond)
+      scond_free(state->cond);
+   if (state->lock)
+      slock_free(state->lock);
+   if (state->slots[1])
+      free(state->slots[1]);
+   state->nextblock = state->slots[0];
+   state->cond      = NULL;
+   state->lock      = NULL;
+   state->slots[0]  = NULL;
+   state->slots[1]  = NULL;
+}
+#endif
+
 static state_manager_t *state_manager_new(
-      size_t state_size, size_t buffer_size)
+      size_t state_size, size_t buffer_size, bool threaded, bool tiered)
 {
    size_t max_comp_size, block_size;
+   size_t cold_size       = 0;
    uint8_t *next_block    = NULL;
    uint8_t *this_block    = NULL;
    uint8_t *state_data    = NULL;
@@ -411,6 +867,20 @@ static state_manager_t *state_manager_new(
    block_size         = (state_size + sizeof(uint16_t) - 1) & -sizeof(uint16_t);
    /* the compressed data is surrounded by pointers to the other side */
    max_comp_size      = state_manager_raw_maxsize(state_size) + sizeof(size_t) * 2;
+
+   /* In tiered mode the ring only keeps the last quarter
+    * of the budget, the rest goes to the compressed tier. */
+   if (tiered)
+   {
+      size_t hot_size = MAX(buffer_size / 4, max_comp_size * 4);
+      if (     hot_size < buffer_size
+            && buffer_size - hot_size >= 2 * STATE_MANAGER_SEGMENT_SIZE)
+      {
+         cold_size    = buffer_size - hot_size;
+         buffer_size  = hot_size;
+      }
+   }
+
    state_data         = (uint8_t*)malloc(buffer_size);
 
    if (!state_data)
@@ -432,9 +902,42 @@ static state_manager_t *state_manager_new(
    state->head        = state->data + sizeof(size_t);
    state->tail        = state->data + sizeof(size_t);
 
+   /* Dirty page tracking is only an optimization,
+    * carry on without it if this fails. */
+   state->num_pages   = state_manager_raw_num_pages(block_size);
+   state->page_hashes = (uint64_t*)calloc(state->num_pages, sizeof(uint64_t));
+   state->page_dirty  = (uint8_t*)malloc(state->num_pages);
+
+   if (!state->page_hashes || !state->page_dirty)
+   {
+      free(state->page_hashes);
+      free(state->page_dirty);
+      state->page_hashes = NULL;
+      state->page_dirty  = NULL;
+   }
+
+   if (cold_size)
+   {
+      if ((state->cold = state_manager_cold_new(block_size,
+                  max_comp_size, cold_size)))
+         RARCH_LOG("[Rewind]: Tiered buffer, %u KB recent, %u KB compressed.\n",
+               (unsigned)(buffer_size / 1024), (unsigned)(cold_size / 1024));
+      else
+         RARCH_WARN("[Rewind]: Failed to set up the compressed tier.\n");
+   }
+
 #if STRICT_BUF_SIZE
    state->debugsize   = state_size;
    state->debugblock  = (uint8_t*)malloc(state_size);
+#else
+#ifdef HAVE_THREADS
+   if (threaded && !state_manager_thread_init(state, state_size))
+   {
+      RARCH_WARN("[Rewind]: Failed to start worker thread, "
+            "compressing on the main thread.\n");
+      state_manager_thread_deinit(state);
+   }
+#endif
 #endif
 
    return state;
@@ -442,20 +945,63 @@ static state_manager_t *state_manager_new(
 error:
    if (state_data)
       free(state_data);
-   state_manager_free(state);
+   if (this_block)
+      free(this_block);
+   if (next_block)
+      free(next_block);
    free(state);
 
    return NULL;
 }
 
-static bool state_manager_pop(state_manager_t *state, const void **data)
+/* Removes the newest patch, from the ring or else from the
+ * compressed tier, and applies it to thisblock if asked. */
+static bool state_manager_take_patch(state_manager_t *state, bool apply)
+{
+   if (state->head != state->tail)
+   {
+      size_t start = read_size_t(state->head - sizeof(size_t));
+      state->head  = state->data + start;
+
+      if (apply)
+         state_manager_raw_decompress(state->data + start + sizeof(size_t),
+               state->maxcompsize, state->thisblock, state->blocksize);
+
+      state->entries--;
+   }
+   else if (!state->cold || !state_manager_cold_take_patch(state, apply))
+      return false;
+
+   if (apply)
+      state->page_hashes_valid = false;
+   state->seq--;
+   return true;
+}
+
+/* Drops the oldest patch of the ring, moving it to
+ * the compressed tier if there is one. */
+static void state_manager_evict_tail(state_manager_t *state)
 {
-   size_t start;
-   uint8_t *out                 = NULL;
-   const uint8_t *compressed    = NULL;
+   const uint8_t *patch = state->tail + sizeof(size_t);
+   uint64_t seq         = state->tail_seq;
+
+   state->tail          = state->data + read_size_t(state->tail);
+   state->tail_seq++;
+   state->entries--;
 
+   /* The patch itself is only overwritten by the next write. */
+   if (state->cold)
+      state_manager_cold_push_patch(state, patch, seq);
+}
+
+static bool state_manager_pop(state_manager_t *state, const void **data)
+{
    *data                        = NULL;
 
+#ifdef HAVE_THREADS
+   state_manager_flush(state);
+#endif
+
    if (state->thisblock_valid)
    {
       state->thisblock_valid    = false;
@@ -465,23 +1011,121 @@ static bool state_manager_pop(state_manager_t *state, const void **data)
    }
 
    *data                        = state->thisblock;
-   if (state->head == state->tail)
+   return state_manager_take_patch(state, true);
+}
+
+/* Goes back 'count' states at once, the same as calling
+ * state_manager_pop() that many times. With a compressed tier,
+ * it starts from the closest keyframe instead of applying
+ * every patch in between. */
+static bool state_manager_seek(state_manager_t *state,
+      unsigned count, const void **data)
+{
+   uint64_t oldest, target;
+   struct state_manager_cold *cold = state->cold;
+
+   *data                           = state->thisblock;
+
+   if (!count)
       return false;
 
-   start                        = read_size_t(state->head - sizeof(size_t));
-   state->head                  = state->data + start;
-   compressed                   = state->data + start + sizeof(size_t);
-   out                          = state->thisblock;
+#ifdef HAVE_THREADS
+   state_manager_flush(state);
+#endif
 
-   state_manager_raw_decompress(compressed,
-         state->maxcompsize, out, state->blocksize);
+   if (state->thisblock_valid)
+   {
+      state->thisblock_valid       = false;
+      state->entries--;
+      if (!--count)
+         return true;
+   }
+
+   oldest                          = state_manager_oldest_seq(state);
+   if (state->seq <= oldest)
+      return false;
+
+   target                          = (state->seq - oldest > count)
+      ? state->seq - count : oldest;
+
+   if (cold && cold->num_keyframes)
+   {
+      size_t i;
+      struct state_manager_keyframe *key = NULL;
+
+      for (i = 0; i < cold->num_keyframes; i++)
+      {
+         if (cold->keyframes[i].seq >= target)
+         {
+            if (cold->keyframes[i].seq < state->seq)
+               key = &cold->keyframes[i];
+            break;
+         }
+      }
+
+      if (key && cold->cache_cap < state->blocksize)
+      {
+         uint8_t *cache = (uint8_t*)realloc(cold->cache, state->blocksize);
+         if (cache)
+         {
+            cold->cache     = cache;
+            cold->cache_cap = state->blocksize;
+         }
+         else
+            key             = NULL;
+      }
+
+      cold->cached = 0;
+
+      if (key && state_manager_cold_inflate(cold, key->data, key->size,
+               cold->cache, state->blocksize))
+      {
+         uint64_t key_seq = key->seq;
+
+         /* The patches newer than the keyframe are not needed. */
+         while (state->seq > key_seq)
+            if (!state_manager_take_patch(state, false))
+               return false;
+
+         memcpy(state->thisblock, cold->cache, state->blocksize);
+         state->page_hashes_valid = false;
+      }
+   }
+
+   while (state->seq > target)
+      if (!state_manager_take_patch(state, true))
+         break;
 
-   state->entries--;
    return true;
 }
 
-static void state_manager_push_where(state_manager_t *state, void **data)
+/* Returns false if the frame should be skipped because the
+ * worker thread has not caught up with the previous ones. */
+static bool state_manager_push_where(state_manager_t *state, void **data)
 {
+#ifdef HAVE_THREADS
+   if (state->thread)
+   {
+      bool idle;
+
+      slock_lock(state->lock);
+      if (state->slot_count >= ARRAY_SIZE(state->slots))
+      {
+         state->frames_dropped++;
+         slock_unlock(state->lock);
+         return false;
+      }
+      idle  = !state->slot_count;
+      *data = state->slots[state->slot_write];
+      slock_unlock(state->lock);
+
+      /* Only after a rewind can 'thisblock' be stale, and the
+       * worker is always idle by then. */
+      if (!idle)
+         return true;
+   }
+#endif
+
    /* We need to ensure we have an uncompressed copy of the last
     * pushed state, or we could end up applying a 'patch' to wrong
     * savestate, and that'd blow up rather quickly. */
@@ -496,13 +1140,51 @@ static void state_manager_push_where(state_manager_t *state, void **data)
       }
    }
 
+#ifdef HAVE_THREADS
+   if (state->thread)
+      return true;
+#endif
+
    *data = state->nextblock;
 #if STRICT_BUF_SIZE
    *data = state->debugblock;
 #endif
+   return true;
 }
 
-static void state_manager_push_do(state_manager_t *state)
+/* Hashes the pages of nextblock, keeping the hashes for the next
+ * push. Returns true if page_dirty tells which pages differ from
+ * thisblock, which is not the case if thisblock was rewound. */
+static bool state_manager_hash_pages(state_manager_t *state)
+{
+   bool valid;
+   size_t num_dirty;
+
+   if (!state->page_hashes)
+      return false;
+
+   /* Hashing costs about as much as diffing the whole state,
+    * so stop for a while when most pages change anyway. */
+   if (state->page_backoff)
+   {
+      state->page_backoff--;
+      state->page_hashes_valid = false;
+      return false;
+   }
+
+   valid                    = state->page_hashes_valid;
+   num_dirty                = state_manager_raw_hash_pages(
+         state->nextblock, state->blocksize,
+         state->page_hashes, state->page_dirty);
+   state->page_hashes_valid = true;
+
+   if (valid && num_dirty * 2 > state->num_pages)
+      state->page_backoff   = STATE_MANAGER_PAGE_BACKOFF;
+
+   return valid;
+}
+
+static void state_manager_push_block(state_manager_t *state)
 {
    uint8_t *swap = NULL;
 
@@ -518,6 +1200,10 @@ static void state_manager_push_do(state_manager_t *state)
       if (state->capacity < sizeof(size_t) + state->maxcompsize)
          return;
 
+      /* Keyframes past this point belong to an overwritten future. */
+      if (state->cold)
+         state_manager_cold_drop_future(state);
+
 recheckcapacity:;
       headpos   = state->head - state->data;
       tailpos   = state->tail - state->data;
@@ -526,23 +1212,30 @@ recheckcapacity:;
 
       if (remaining <= state->maxcompsize)
       {
-         state->tail = state->data + read_size_t(state->tail);
-         state->entries--;
+         state_manager_evict_tail(state);
          goto recheckcapacity;
       }
 
+      if (state->head == state->tail)
+         state->tail_seq = state->seq + 1;
+
       oldb              = state->thisblock;
       newb              = state->nextblock;
       compressed        = state->head + sizeof(size_t);
 
-      compressed       += state_manager_raw_compress(oldb, newb,
-            state->blocksize, compressed);
+      if (state_manager_hash_pages(state))
+         compressed    += state_manager_raw_compress_pages(oldb,
+               state->nextblock, state->blocksize, compressed,
+               state->page_dirty);
+      else
+         compressed    += state_manager_raw_compress(oldb, newb,
+               state->blocksize, compressed);
 
       if (compressed - state->data + state->maxcompsize > state->capacity)
       {
          compressed     = state->data;
          if (state->tail == state->data + sizeof(size_t))
-            state->tail = state->data + read_size_t(state->tail);
+            state_manager_evict_tail(state);
       }
       write_size_t(compressed, state->head-state->data);
       compressed       += sizeof(size_t);
@@ -550,13 +1243,46 @@ recheckcapacity:;
       state->head       = compressed;
    }
    else
+   {
+      /* Nothing left to chain the older history to. */
+      if (state->cold)
+         state_manager_cold_clear(state->cold);
+      state_manager_hash_pages(state);
       state->thisblock_valid = true;
+   }
 
    swap                      = state->thisblock;
    state->thisblock          = state->nextblock;
    state->nextblock          = swap;
 
+   state->seq++;
    state->entries++;
+
+   if (state->cold)
+   {
+      if (!(state->seq % STATE_MANAGER_KEYFRAME_INTERVAL))
+         state_manager_cold_start_keyframe(state);
+      state_manager_cold_step_keyframe(state);
+   }
+}
+
+/* Appends the state serialized into the buffer returned by
+ * state_manager_push_where(), or queues it for the worker. */
+static void state_manager_push_do(state_manager_t *state)
+{
+#ifdef HAVE_THREADS
+   if (state->thread)
+   {
+      slock_lock(state->lock);
+      state->slot_write = (state->slot_write + 1) & 1;
+      state->slot_count++;
+      scond_signal(state->cond);
+      slock_unlock(state->lock);
+      return;
+   }
+#endif
+
+   state_manager_push_block(state);
 }
 
 #if 0
@@ -579,7 +1305,8 @@ static void state_manager_capacity(state_manager_t *state,
 
 void state_manager_event_init(
       struct state_manager_rewind_state *rewind_st,
-      unsigned rewind_buffer_size)
+      unsigned rewind_buffer_size, bool rewind_threaded,
+      bool rewind_tiered)
 {
    core_info_t *core_info = NULL;
    void *state            = NULL;
@@ -630,11 +1357,19 @@ void state_manager_event_init(
          msg_hash_to_str(MSG_REWIND_INIT),
          (unsigned)(rewind_buffer_size / 1000000));
 
+   state_manager_delta_init_simd();
+   RARCH_LOG("[Rewind]: Using \"%s\" delta kernel.\n",
+         state_manager_delta_kernel_name(
+            state_manager_delta_get_kernel()));
+
    rewind_st->state = state_manager_new(rewind_st->size,
-         rewind_buffer_size);
+         rewind_buffer_size, rewind_threaded, rewind_tiered);
 
    if (!rewind_st->state)
+   {
       RARCH_WARN("%s.\n", msg_hash_to_str(MSG_REWIND_INIT_FAILED));
+      return;
+   }
 
    state_manager_push_where(rewind_st->state, &state);
 
@@ -684,6 +1419,30 @@ void state_manager_event_deinit(
    }
 }
 
+bool state_manager_seek_back(
+      struct state_manager_rewind_state *rewind_st,
+      unsigned count)
+{
+   const void *buf = NULL;
+
+   if (!rewind_st || !rewind_st->state)
+      return false;
+
+   /* Both expect to see every rewound frame */
+#ifdef HAVE_NETWORKING
+   if (netplay_driver_ctl(RARCH_NETPLAY_CTL_IS_ENABLED, NULL))
+      return false;
+#endif
+   if (retroarch_ctl(RARCH_CTL_BSV_MOVIE_IS_INITED, NULL))
+      return false;
+
+   if (!state_manager_seek(rewind_st->state, count, &buf))
+      return false;
+
+   content_deserialize_state(buf, rewind_st->size);
+   return true;
+}
+
 /**
  * check_rewind:
  * @pressed              : was rewind key pressed or held?
@@ -801,11 +1560,18 @@ bool state_manager_check_rewind(
       {
          void *state = NULL;
 
-         state_manager_push_where(rewind_st->state, &state);
-
-         content_serialize_state(state, rewind_st->size);
+#ifdef HAVE_THREADS
+         /* Movies rewind one input frame per entry,
+          * so the worker must not skip any. */
+         if (retroarch_ctl(RARCH_CTL_BSV_MOVIE_IS_INITED, NULL))
+            state_manager_flush(rewind_st->state);
+#endif
 
-         state_manager_push_do(rewind_st->state);
+         if (state_manager_push_where(rewind_st->state, &state))
+         {
+            content_serialize_state(state, rewind_st->size);
+            state_manager_push_do(rewind_st->state);
+         }
       }
    }
 
@@ -24,10 +24,16 @@
 #include <boolean.h>
 #include <retro_common_api.h>
 
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
 #include "dynamic.h"
 
 RETRO_BEGIN_DECLS
 
+struct state_manager_cold;
+
 struct state_manager
 {
    uint8_t *data;
@@ -51,6 +57,37 @@ struct state_manager
     * (yes, the math is a bit ugly). */
    size_t maxcompsize;
 
+#ifdef HAVE_THREADS
+   /* Threaded capture: the main thread serializes into
+    * one of these, the worker thread diffs it against
+    * thisblock and appends the result to the buffer. */
+   uint8_t *slots[2];
+   sthread_t *thread;
+   slock_t *lock;
+   scond_t *cond;
+   unsigned slot_read;
+   unsigned slot_write;
+   unsigned slot_count;
+   unsigned frames_dropped;
+   bool thread_quit;
+#endif
+
+   /* Tiered mode: patches dropped from the ring and
+    * periodic keyframes, compressed. NULL if disabled. */
+   struct state_manager_cold *cold;
+   /* Sequence number of the state in thisblock,
+    * and of the oldest patch in the ring. */
+   uint64_t seq;
+   uint64_t tail_seq;
+
+   /* Page hashes of thisblock, so that only the pages
+    * that changed since need to be diffed. */
+   uint64_t *page_hashes;
+   uint8_t *page_dirty;
+   size_t num_pages;
+   unsigned page_backoff;
+   bool page_hashes_valid;
+
    unsigned entries;
    bool thisblock_valid;
 };
@@ -80,7 +117,23 @@ void state_manager_event_deinit(
       struct retro_core_t *current_core);
 
 void state_manager_event_init(struct state_manager_rewind_state *rewind_st,
-      unsigned rewind_buffer_size);
+      unsigned rewind_buffer_size, bool rewind_threaded,
+      bool rewind_tiered);
+
+/**
+ * state_manager_seek_back:
+ * @count                : number of states to go back
+ *
+ * Loads the state @count entries back in the rewind
+ * history, or the oldest one if there are fewer.
+ * Not available during netplay or movie playback.
+ * Used by the REWIND_SEEK network command.
+ *
+ * Returns: true if a state was loaded.
+ **/
+bool state_manager_seek_back(
+      struct state_manager_rewind_state *rewind_st,
+      unsigned count);
 
 /**
  * check_rewind:
@@ -0,0 +1,774 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *  Copyright (C) 2014-2017 - Alfred Agrell
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __STDC_LIMIT_MACROS
+#define __STDC_LIMIT_MACROS
+#endif
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <retro_inline.h>
+#include <retro_miscellaneous.h>
+#include <compat/intrinsics.h>
+#include <features/features_cpu.h>
+
+#define XXH_INLINE_ALL
+#include "deps/xxHash/xxhash.h"
+
+#include "state_manager_delta.h"
+
+#ifndef UINT16_MAX
+#define UINT16_MAX 0xffff
+#endif
+
+#ifndef UINT32_MAX
+#define UINT32_MAX 0xffffffffu
+#endif
+
+#if defined(__x86_64__) || defined(__i386__) || defined(__i486__) || defined(__i686__) || defined(_M_IX86) || defined(_M_AMD64) || defined(_M_X64)
+#define CPU_X86
+#endif
+
+/* Other arches SIGBUS (usually) on unaligned accesses. */
+#ifndef CPU_X86
+#define NO_UNALIGNED_MEM
+#endif
+
+#if __SSE2__
+#include <emmintrin.h>
+#endif
+
+/* The AVX2 kernels are compiled with a per-function target
+ * where the compiler supports it, so that a generic x86
+ * build can still pick them at runtime. */
+#if defined(__AVX2__)
+#define DELTA_HAVE_AVX2
+#define DELTA_AVX2_TARGET
+#elif (defined(__x86_64__) || defined(__i386__)) && (defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define DELTA_HAVE_AVX2
+#define DELTA_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+
+#ifdef DELTA_HAVE_AVX2
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON) || defined(HAVE_NEON) || defined(_M_ARM) || defined(_M_ARM64)
+#define DELTA_HAVE_NEON
+#include <arm_neon.h>
+#endif
+
+/* NEON is mandatory on AArch64 and on Windows on ARM,
+ * so there is nothing to detect at runtime there. */
+#if defined(__aarch64__) || defined(_M_ARM) || defined(_M_ARM64)
+#define DELTA_NEON_ALWAYS
+#endif
+
+/* Every kernel may read up to this many bytes past the point
+ * where it stops, so blocks carry this much zeroed padding. */
+#define DELTA_SCAN_OVERREAD 32
+
+typedef size_t (*delta_scan_t)(const uint16_t *a, const uint16_t *b);
+
+/* Format per frame (pseudocode): */
+#if 0
+size nextstart;
+repeat {
+   uint16 numchanged; /* everything is counted in units of uint16 */
+   if (numchanged)
+   {
+      uint16 numunchanged; /* skip these before handling numchanged */
+      uint16[numchanged] changeddata;
+   }
+   else
+   {
+      uint32 numunchanged;
+      if (!numunchanged)
+         break;
+   }
+}
+size thisstart;
+#endif
+
+/* find_change returns the offset (in uint16s) of the first word
+ * that differs; find_same returns the length of the run of
+ * differing words starting at 'a'.
+ *
+ * Neither checks bounds, they rely on the sentinel and padding
+ * placed by state_manager_raw_alloc() to terminate. */
+
+/* There's no equivalent in libc, you'd think so ...
+ * std::mismatch exists, but it's not optimized at all. */
+static size_t find_change_generic(const uint16_t *a, const uint16_t *b)
+{
+   const uint16_t *a_org = a;
+#ifdef NO_UNALIGNED_MEM
+   while (((uintptr_t)a & (sizeof(size_t) - 1)) && *a == *b)
+   {
+      a++;
+      b++;
+   }
+   if (*a == *b)
+#endif
+   {
+      const size_t *a_big = (const size_t*)a;
+      const size_t *b_big = (const size_t*)b;
+
+      while (*a_big == *b_big)
+      {
+         a_big++;
+         b_big++;
+      }
+      a = (const uint16_t*)a_big;
+      b = (const uint16_t*)b_big;
+
+      while (*a == *b)
+      {
+         a++;
+         b++;
+      }
+   }
+   return a - a_org;
+}
+
+static size_t find_same_generic(const uint16_t *a, const uint16_t *b)
+{
+   const uint16_t *a_org = a;
+#ifdef NO_UNALIGNED_MEM
+   if (((uintptr_t)a & (sizeof(uint32_t) - 1)) && *a != *b)
+   {
+      a++;
+      b++;
+   }
+   if (*a != *b)
+#endif
+   {
+      /* With this, it's random whether two consecutive identical
+       * words are caught.
+       *
+       * Luckily, compression rate is the same for both cases, and
+       * three is always caught.
+       *
+       * (We prefer to miss two-word blocks, anyways; fewer iterations
+       * of the outer loop, as well as in the decompressor.) */
+      const uint32_t *a_big = (const uint32_t*)a;
+      const uint32_t *b_big = (const uint32_t*)b;
+
+      while (*a_big != *b_big)
+      {
+         a_big++;
+         b_big++;
+      }
+      a = (const uint16_t*)a_big;
+      b = (const uint16_t*)b_big;
+
+      if (a != a_org && a[-1] == b[-1])
+      {
+         a--;
+         b--;
+      }
+   }
+   return a - a_org;
+}
+
+/* The SIMD find_same kernels below compare 32-bit pairs of words
+ * starting where find_same_generic() does: at 'a' on x86, and at
+ * the next 32-bit boundary where unaligned loads are avoided. So
+ * every kernel produces identical patches. */
+
+#if __SSE2__
+static size_t find_change_sse2(const uint16_t *a, const uint16_t *b)
+{
+   const __m128i *a128 = (const __m128i*)a;
+   const __m128i *b128 = (const __m128i*)b;
+
+   for (;;)
+   {
+      __m128i v0    = _mm_loadu_si128(a128);
+      __m128i v1    = _mm_loadu_si128(b128);
+      __m128i c     = _mm_cmpeq_epi8(v0, v1);
+      uint32_t mask = _mm_movemask_epi8(c);
+
+      if (mask != 0xffff) /* Something has changed, figure out where. */
+      {
+         /* calculate the real offset to the differing byte */
+         size_t ret = (((uint8_t*)a128 - (uint8_t*)a) |
+               (compat_ctz(~mask)));
+
+         /* and convert that to the uint16_t offset */
+         return (ret >> 1);
+      }
+
+      a128++;
+      b128++;
+   }
+}
+
+static size_t find_same_sse2(const uint16_t *a, const uint16_t *b)
+{
+   const uint16_t *a_org = a;
+
+   for (;;)
+   {
+      __m128i v0    = _mm_loadu_si128((const __m128i*)a);
+      __m128i v1    = _mm_loadu_si128((const __m128i*)b);
+      __m128i c     = _mm_cmpeq_epi32(v0, v1);
+      uint32_t mask = _mm_movemask_ps(_mm_castsi128_ps(c));
+
+      if (mask)
+      {
+         a += compat_ctz(mask) << 1;
+         b += compat_ctz(mask) << 1;
+         break;
+      }
+
+      a += 8;
+      b += 8;
+   }
+
+   if (a != a_org && a[-1] == b[-1])
+      a--;
+   return a - a_org;
+}
+#endif
+
+#ifdef DELTA_HAVE_AVX2
+static DELTA_AVX2_TARGET size_t find_change_avx2(const uint16_t *a, const uint16_t *b)
+{
+   const __m256i *a256 = (const __m256i*)a;
+   const __m256i *b256 = (const __m256i*)b;
+
+   for (;;)
+   {
+      __m256i v0    = _mm256_loadu_si256(a256);
+      __m256i v1    = _mm256_loadu_si256(b256);
+      __m256i c     = _mm256_cmpeq_epi8(v0, v1);
+      uint32_t mask = (uint32_t)_mm256_movemask_epi8(c);
+
+      if (mask != 0xffffffffu)
+      {
+         size_t ret = (((uint8_t*)a256 - (uint8_t*)a) |
+               (compat_ctz(~mask)));
+         return (ret >> 1);
+      }
+
+      a256++;
+      b256++;
+   }
+}
+
+static DELTA_AVX2_TARGET size_t find_same_avx2(const uint16_t *a, const uint16_t *b)
+{
+   const uint16_t *a_org = a;
+
+   for (;;)
+   {
+      __m256i v0    = _mm256_loadu_si256((const __m256i*)a);
+      __m256i v1    = _mm256_loadu_si256((const __m256i*)b);
+      __m256i c     = _mm256_cmpeq_epi32(v0, v1);
+      uint32_t mask = (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(c));
+
+      if (mask)
+      {
+         a += compat_ctz(mask) << 1;
+         b += compat_ctz(mask) << 1;
+         break;
+      }
+
+      a += 16;
+      b += 16;
+   }
+
+   if (a != a_org && a[-1] == b[-1])
+      a--;
+   return a - a_org;
+}
+#endif
+
+#ifdef DELTA_HAVE_NEON
+/* NEON has no movemask, so test two vectors at a time
+ * through a 64-bit lane and locate the word in scalar code;
+ * the run lengths here are short enough for that not to matter. */
+static size_t find_change_neon(const uint16_t *a, const uint16_t *b)
+{
+   const uint16_t *a_org = a;
+
+   for (;;)
+   {
+      uint16x8_t c0 = vceqq_u16(vld1q_u16(a),     vld1q_u16(b));
+      uint16x8_t c1 = vceqq_u16(vld1q_u16(a + 8), vld1q_u16(b + 8));
+      uint16x8_t c  = vandq_u16(c0, c1);
+      uint16x4_t c4 = vand_u16(vget_low_u16(c), vget_high_u16(c));
+
+      if (vget_lane_u64(vreinterpret_u64_u16(c4), 0) != ~(uint64_t)0)
+         break;
+
+      a += 16;
+      b += 16;
+   }
+
+   while (*a == *b)
+   {
+      a++;
+      b++;
+   }
+   return a - a_org;
+}
+
+static size_t find_same_neon(const uint16_t *a, const uint16_t *b)
+{
+   const uint16_t *a_org = a;
+
+#ifdef NO_UNALIGNED_MEM
+   /* Pair up the words the way find_same_generic() does */
+   if (((uintptr_t)a & (sizeof(uint32_t) - 1)) && *a != *b)
+   {
+      a++;
+      b++;
+   }
+   if (*a == *b)
+      return a - a_org;
+#endif
+
+   for (;;)
+   {
+      uint32x4_t c0 = vceqq_u32(
+            vreinterpretq_u32_u16(vld1q_u16(a)),
+            vreinterpretq_u32_u16(vld1q_u16(b)));
+      uint32x4_t c1 = vceqq_u32(
+            vreinterpretq_u32_u16(vld1q_u16(a + 8)),
+            vreinterpretq_u32_u16(vld1q_u16(b + 8)));
+      uint32x4_t c  = vorrq_u32(c0, c1);
+      uint32x2_t c2 = vorr_u32(vget_low_u32(c), vget_high_u32(c));
+
+      if (vget_lane_u64(vreinterpret_u64_u32(c2), 0))
+         break;
+
+      a += 16;
+      b += 16;
+   }
+
+   while (a[0] != b[0] || a[1] != b[1])
+   {
+      a += 2;
+      b += 2;
+   }
+
+   if (a != a_org && a[-1] == b[-1])
+      a--;
+   return a - a_org;
+}
+#endif
+
+#if __SSE2__
+static enum state_manager_delta_kernel delta_kernel = STATE_MANAGER_DELTA_KERNEL_SSE2;
+static delta_scan_t find_change                     = find_change_sse2;
+static delta_scan_t find_same                       = find_same_sse2;
+#else
+static enum state_manager_delta_kernel delta_kernel = STATE_MANAGER_DELTA_KERNEL_GENERIC;
+static delta_scan_t find_change                     = find_change_generic;
+static delta_scan_t find_same                       = find_same_generic;
+#endif
+
+bool state_manager_delta_kernel_supported(
+      enum state_manager_delta_kernel kernel)
+{
+   switch (kernel)
+   {
+      case STATE_MANAGER_DELTA_KERNEL_GENERIC:
+         return true;
+      case STATE_MANAGER_DELTA_KERNEL_SSE2:
+#if __SSE2__
+         return true;
+#else
+         break;
+#endif
+      case STATE_MANAGER_DELTA_KERNEL_AVX2:
+#ifdef DELTA_HAVE_AVX2
+         return (cpu_features_get() & RETRO_SIMD_AVX2) != 0;
+#else
+         break;
+#endif
+      case STATE_MANAGER_DELTA_KERNEL_NEON:
+#if defined(DELTA_NEON_ALWAYS)
+         return true;
+#elif defined(DELTA_HAVE_NEON)
+         return (cpu_features_get()
+               & (RETRO_SIMD_NEON | RETRO_SIMD_ASIMD)) != 0;
+#else
+         break;
+#endif
+      default:
+         break;
+   }
+
+   return false;
+}
+
+bool state_manager_delta_set_kernel(
+      enum state_manager_delta_kernel kernel)
+{
+   if (!state_manager_delta_kernel_supported(kernel))
+      return false;
+
+   switch (kernel)
+   {
+#if __SSE2__
+      case STATE_MANAGER_DELTA_KERNEL_SSE2:
+         find_change = find_change_sse2;
+         find_same   = find_same_sse2;
+         break;
+#endif
+#ifdef DELTA_HAVE_AVX2
+      case STATE_MANAGER_DELTA_KERNEL_AVX2:
+         find_change = find_change_avx2;
+         find_same   = find_same_avx2;
+         break;
+#endif
+#ifdef DELTA_HAVE_NEON
+      case STATE_MANAGER_DELTA_KERNEL_NEON:
+         find_change = find_change_neon;
+         find_same   = find_same_neon;
+         break;
+#endif
+      default:
+         find_change = find_change_generic;
+         find_same   = find_same_generic;
+         break;
+   }
+
+   delta_kernel = kernel;
+   return true;
+}
+
+enum state_manager_delta_kernel state_manager_delta_get_kernel(void)
+{
+   return delta_kernel;
+}
+
+void state_manager_delta_init_simd(void)
+{
+   if (state_manager_delta_set_kernel(STATE_MANAGER_DELTA_KERNEL_AVX2))
+      return;
+   if (state_manager_delta_set_kernel(STATE_MANAGER_DELTA_KERNEL_NEON))
+      return;
+   if (state_manager_delta_set_kernel(STATE_MANAGER_DELTA_KERNEL_SSE2))
+      return;
+   state_manager_delta_set_kernel(STATE_MANAGER_DELTA_KERNEL_GENERIC);
+}
+
+const char *state_manager_delta_kernel_name(
+      enum state_manager_delta_kernel kernel)
+{
+   switch (kernel)
+   {
+      case STATE_MANAGER_DELTA_KERNEL_GENERIC:
+         return "generic";
+      case STATE_MANAGER_DELTA_KERNEL_SSE2:
+         return "sse2";
+      case STATE_MANAGER_DELTA_KERNEL_AVX2:
+         return "avx2";
+      case STATE_MANAGER_DELTA_KERNEL_NEON:
+         return "neon";
+      default:
+         break;
+   }
+
+   return "unknown";
+}
+
+size_t state_manager_raw_maxsize(size_t uncomp)
+{
+   /* bytes covered by a compressed block */
+   const int maxcblkcover = UINT16_MAX * sizeof(uint16_t);
+   /* uncompressed size, rounded to 16 bits */
+   size_t uncomp16        = (uncomp + sizeof(uint16_t) - 1) & -sizeof(uint16_t);
+   /* number of blocks */
+   size_t maxcblks        = (uncomp + maxcblkcover - 1) / maxcblkcover;
+   return uncomp16 + maxcblks * sizeof(uint16_t) * 2 /* two u16 overhead per block */ + sizeof(uint16_t) *
+      3; /* three u16 to end it */
+}
+
+void *state_manager_raw_alloc(size_t len, uint16_t uniq)
+{
+   size_t  len16 = (len + sizeof(uint16_t) - 1) & -sizeof(uint16_t);
+   uint16_t *ret = (uint16_t*)calloc(len16
+         + sizeof(uint16_t) * 4 + DELTA_SCAN_OVERREAD, 1);
+
+   if (!ret)
+      return NULL;
+
+   /* Force in a different byte at the end, so we don't need to check
+    * bounds in the innermost loop (it's expensive).
+    *
+    * There is also a large amount of data that's the same, to stop
+    * the other scan.
+    *
+    * There is also some padding at the end. This is so we don't
+    * read outside the buffer end if we're reading in large blocks;
+    * the widest kernels load 32 bytes at a time.
+    *
+    * It doesn't make any difference to us, but sacrificing a few bytes
+    * to get Valgrind happy is worth it. */
+   ret[len16/sizeof(uint16_t) + 3] = uniq;
+
+   return ret;
+}
+
+size_t state_manager_raw_compress(const void *src,
+      const void *dst, size_t len, void *patch)
+{
+   const uint16_t  *old16 = (const uint16_t*)src;
+   const uint16_t  *new16 = (const uint16_t*)dst;
+   uint16_t *compressed16 = (uint16_t*)patch;
+   size_t          num16s = (len + sizeof(uint16_t) - 1)
+      / sizeof(uint16_t);
+
+   while (num16s)
+   {
+      size_t i, changed;
+      size_t skip = find_change(old16, new16);
+
+      if (skip >= num16s)
+         break;
+
+      old16  += skip;
+      new16  += skip;
+      num16s -= skip;
+
+      if (skip > UINT16_MAX)
+      {
+         /* This will make it scan the entire thing again,
+          * but it only hits on 8GB unchanged data anyways,
+          * and if you're doing that, you've got bigger problems. */
+         if (skip > UINT32_MAX)
+            skip         = UINT32_MAX;
+
+         *compressed16++ = 0;
+         *compressed16++ = skip;
+         *compressed16++ = skip >> 16;
+         continue;
+      }
+
+      changed         = find_same(old16, new16);
+      if (changed > UINT16_MAX)
+         changed = UINT16_MAX;
+
+      *compressed16++ = changed;
+      *compressed16++ = skip;
+
+      for (i = 0; i < changed; i++)
+         compressed16[i] = old16[i];
+
+      old16        += changed;
+      new16        += changed;
+      num16s       -= changed;
+      compressed16 += changed;
+   }
+
+   compressed16[0]  = 0;
+   compressed16[1]  = 0;
+   compressed16[2]  = 0;
+
+   return (uint8_t*)(compressed16 + 3) - (uint8_t*)patch;
+}
+
+void state_manager_raw_decompress(const void *patch,
+      size_t patchlen, void *data, size_t datalen)
+{
+   uint16_t         *out16 = (uint16_t*)data;
+   const uint16_t *patch16 = (const uint16_t*)patch;
+
+   for (;;)
+   {
+      uint16_t numchanged  = *(patch16++);
+
+      if (numchanged)
+      {
+         uint16_t i;
+
+         out16       += *patch16++;
+
+         /* We could do memcpy, but it seems that memcpy has a
+          * constant-per-call overhead that actually shows up.
+          *
+          * Our average size in here seems to be 8 or something.
+          * Therefore, we do something with lower overhead. */
+         for (i = 0; i < numchanged; i++)
+            out16[i]  = patch16[i];
+
+         patch16     += numchanged;
+         out16       += numchanged;
+      }
+      else
+      {
+         uint32_t numunchanged = patch16[0] | (patch16[1] << 16);
+
+         if (!numunchanged)
+            break;
+         patch16 += 2;
+         out16   += numunchanged;
+      }
+   }
+}
+
+size_t state_manager_raw_num_pages(size_t len)
+{
+   return (len + STATE_MANAGER_PAGE_SIZE - 1) / STATE_MANAGER_PAGE_SIZE;
+}
+
+size_t state_manager_raw_hash_pages(const void *data, size_t len,
+      uint64_t *hashes, uint8_t *dirty)
+{
+   size_t i;
+   size_t num_dirty     = 0;
+   const uint8_t *data8 = (const uint8_t*)data;
+   size_t num_pages     = state_manager_raw_num_pages(len);
+
+   for (i = 0; i < num_pages; i++)
+   {
+      size_t offset = i * STATE_MANAGER_PAGE_SIZE;
+      uint64_t hash = XXH3_64bits(data8 + offset,
+            MIN(len - offset, STATE_MANAGER_PAGE_SIZE));
+
+      dirty[i]      = (hash != hashes[i]);
+      hashes[i]     = hash;
+      num_dirty    += dirty[i];
+   }
+
+   return num_dirty;
+}
+
+size_t state_manager_raw_compress_pages(const void *src,
+      void *dst, size_t len, void *patch, const uint8_t *dirty)
+{
+   const uint16_t  *old16 = (const uint16_t*)src;
+   uint16_t        *new16 = (uint16_t*)dst;
+   uint16_t *compressed16 = (uint16_t*)patch;
+   size_t          num16s = (len + sizeof(uint16_t) - 1)
+      / sizeof(uint16_t);
+   size_t         page16s = STATE_MANAGER_PAGE_SIZE / sizeof(uint16_t);
+   size_t             pos = 0;
+   size_t            last = 0;
+
+   while (pos < num16s)
+   {
+      uint16_t saved = 0;
+      size_t run_end;
+      size_t page = pos / page16s;
+
+      /* Find the next run of dirty pages. */
+      while (page * page16s < num16s && !dirty[page])
+         page++;
+      if (page * page16s >= num16s)
+         break;
+
+      pos     = MAX(pos, page * page16s);
+      while ((page + 1) * page16s < num16s && dirty[page + 1])
+         page++;
+      run_end = MIN((page + 1) * page16s, num16s);
+
+      /* find_change() relies on a difference to stop at, so
+       * plant one where the clean pages start. find_same() is
+       * run on the real data, so that it pairs words the same
+       * way as in state_manager_raw_compress(); the clean page
+       * stops it right after the run. */
+      if (run_end < num16s)
+      {
+         saved            = new16[run_end];
+         new16[run_end]   = ~old16[run_end];
+      }
+
+      while (pos < run_end)
+      {
+         size_t i, changed, skip;
+
+         pos += find_change(old16 + pos, new16 + pos);
+         if (pos >= run_end)
+            break;
+
+         /* Same encoding as state_manager_raw_compress(),
+          * so the resulting patch is identical. */
+         skip = pos - last;
+         if (skip > UINT16_MAX)
+         {
+            if (skip > UINT32_MAX)
+               skip      = UINT32_MAX;
+
+            *compressed16++ = 0;
+            *compressed16++ = skip;
+            *compressed16++ = skip >> 16;
+            skip            = 0;
+         }
+
+         if (run_end < num16s)
+            new16[run_end] = saved;
+         changed         = find_same(old16 + pos, new16 + pos);
+         if (run_end < num16s)
+            new16[run_end] = ~old16[run_end];
+         if (changed > run_end - pos)
+            changed      = run_end - pos;
+         if (changed > UINT16_MAX)
+            changed      = UINT16_MAX;
+
+         *compressed16++ = changed;
+         *compressed16++ = skip;
+
+         for (i = 0; i < changed; i++)
+            compressed16[i] = old16[pos + i];
+
+         pos            += changed;
+         last            = pos;
+         compressed16   += changed;
+      }
+
+      if (run_end < num16s)
+         new16[run_end]  = saved;
+      pos                = run_end;
+   }
+
+   compressed16[0]  = 0;
+   compressed16[1]  = 0;
+   compressed16[2]  = 0;
+
+   return (uint8_t*)(compressed16 + 3) - (uint8_t*)patch;
+}
+
+size_t state_manager_raw_patch_size(const void *patch)
+{
+   const uint16_t *patch16 = (const uint16_t*)patch;
+
+   for (;;)
+   {
+      uint16_t numchanged  = *(patch16++);
+
+      if (numchanged)
+         patch16          += 1 + numchanged;
+      else
+      {
+         uint32_t numunchanged = patch16[0] | (patch16[1] << 16);
+
+         patch16 += 2;
+         if (!numunchanged)
+            break;
+      }
+   }
+
+   return (const uint8_t*)patch16 - (const uint8_t*)patch;
+}
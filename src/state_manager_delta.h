@@ -0,0 +1,146 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *  Copyright (C) 2014-2017 - Alfred Agrell
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __STATE_MANAGER_DELTA_H
+#define __STATE_MANAGER_DELTA_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <boolean.h>
+#include <retro_common_api.h>
+
+RETRO_BEGIN_DECLS
+
+/* Granularity of the dirty page tracking, in bytes. */
+#define STATE_MANAGER_PAGE_SIZE 4096
+
+/* Scan kernels used by the rewind delta encoder.
+ * Only the kernels compiled in for the target
+ * architecture can be selected; the rest report
+ * as unsupported. */
+enum state_manager_delta_kernel
+{
+   STATE_MANAGER_DELTA_KERNEL_GENERIC = 0,
+   STATE_MANAGER_DELTA_KERNEL_SSE2,
+   STATE_MANAGER_DELTA_KERNEL_AVX2,
+   STATE_MANAGER_DELTA_KERNEL_NEON,
+   STATE_MANAGER_DELTA_KERNEL_LAST
+};
+
+/**
+ * state_manager_delta_init_simd:
+ *
+ * Selects the fastest scan kernel supported
+ * by both the build and the running CPU.
+ **/
+void state_manager_delta_init_simd(void);
+
+/**
+ * state_manager_delta_kernel_supported:
+ * @kernel              : kernel to query
+ *
+ * Returns: true if @kernel was compiled in and
+ * the running CPU can execute it.
+ **/
+bool state_manager_delta_kernel_supported(
+      enum state_manager_delta_kernel kernel);
+
+/**
+ * state_manager_delta_set_kernel:
+ * @kernel              : kernel to select
+ *
+ * Forces a specific scan kernel.
+ *
+ * Returns: false if @kernel is not supported,
+ * in which case the current kernel is kept.
+ **/
+bool state_manager_delta_set_kernel(
+      enum state_manager_delta_kernel kernel);
+
+enum state_manager_delta_kernel state_manager_delta_get_kernel(void);
+
+const char *state_manager_delta_kernel_name(
+      enum state_manager_delta_kernel kernel);
+
+/* Returns the maximum compressed size of a savestate.
+ * It is very likely to compress to far less. */
+size_t state_manager_raw_maxsize(size_t uncomp);
+
+/*
+ * Allocates a block suitable for state_manager_raw_compress().
+ * When you're done with it, send it to free().
+ */
+void *state_manager_raw_alloc(size_t len, uint16_t uniq);
+
+/*
+ * Takes two savestates and creates a patch that turns 'dst' into 'src'.
+ * Both 'src' and 'dst' must be returned from state_manager_raw_alloc(),
+ * with the same 'len', and different 'uniq'.
+ *
+ * 'patch' must be size 'state_manager_raw_maxsize(len)' or more.
+ * Returns the number of bytes actually written to 'patch'.
+ */
+size_t state_manager_raw_compress(const void *src,
+      const void *dst, size_t len, void *patch);
+
+/*
+ * Takes 'patch' from a previous call to 'state_manager_raw_compress'
+ * and applies it to 'data' ('dst' from that call),
+ * yielding 'src' in that call.
+ *
+ * If the given arguments do not match a previous call to
+ * state_manager_raw_compress(), anything at all can happen.
+ */
+void state_manager_raw_decompress(const void *patch,
+      size_t patchlen, void *data, size_t datalen);
+
+/*
+ * Returns the number of STATE_MANAGER_PAGE_SIZE pages
+ * covering a savestate of 'len' bytes.
+ */
+size_t state_manager_raw_num_pages(size_t len);
+
+/*
+ * Hashes every page of 'data' and compares it with the hash
+ * already in 'hashes', which is then replaced. 'dirty' is set
+ * to nonzero for every page whose hash changed.
+ * Both arrays must have state_manager_raw_num_pages(len) entries.
+ * Returns the number of dirty pages.
+ */
+size_t state_manager_raw_hash_pages(const void *data, size_t len,
+      uint64_t *hashes, uint8_t *dirty);
+
+/*
+ * Same as state_manager_raw_compress(), but only looks at the
+ * pages flagged in 'dirty'; the others are assumed to be equal.
+ * The result is identical as long as that assumption holds.
+ *
+ * 'dst' is briefly written to while scanning, but is left unchanged.
+ */
+size_t state_manager_raw_compress_pages(const void *src,
+      void *dst, size_t len, void *patch, const uint8_t *dirty);
+
+/*
+ * Returns the size in bytes of a patch produced by
+ * state_manager_raw_compress(), including its terminator.
+ */
+size_t state_manager_raw_patch_size(const void *patch);
+
+RETRO_END_DECLS
+
+#endif
@@ -16,10 +16,17 @@
  */
 
 #include <math.h>
+
+#if defined(_WIN32) && !defined(_XBOX) || defined(__unix__) || defined(__APPLE__) || defined(__HAIKU__)
+#include <sys/stat.h>
+#endif
+
 #include <compat/strcasestr.h>
 #include <compat/strl.h>
 #include <retro_miscellaneous.h>
 #include <retro_endianness.h>
+#include <array/rhmap.h>
+#include <features/features_cpu.h>
 #include <string/stdstring.h>
 #include <lists/dir_list.h>
 #include <file/file_path.h>
@@ -27,6 +34,9 @@
 #include <streams/file_stream.h>
 #include <streams/chd_stream.h>
 #include <streams/interface_stream.h>
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
 #include "tasks_internal.h"
 
 #include "../core_info.h"
@@ -43,9 +53,43 @@
 #include "../verbosity.h"
 #include "task_database_cue.h"
 
+enum db_index_flags_enum
+{
+   DB_INDEX_FLAG_CRC_FAILED    = (1 << 0),
+   DB_INDEX_FLAG_SERIAL_FAILED = (1 << 1)
+};
+
+/* Lookup indexes of one database, built on first use */
+typedef struct database_state_index
+{
+   database_info_index_t *crc;
+   database_info_index_t *serial;
+   uint8_t flags;
+} database_state_index_t;
+
+/* What a file has to be looked up by. Filled in by
+ * task_database_probe(), which only reads the file
+ * and touches nothing else, so it can run on the
+ * hashing workers. */
+typedef struct database_probe
+{
+   char serial[4096];
+   uint32_t crc;
+   /* DATABASE_TYPE_NONE leaves the lookup type alone */
+   enum database_type type;
+   /* return value of the iteration step */
+   int ret;
+   /* read to compute 'crc', 0 if it came from the cache */
+   uint64_t bytes;
+   /* crc is the one of an archive, not of its contents */
+   bool archive;
+} database_probe_t;
+
 typedef struct database_state_handle
 {
    database_info_list_t *info;
+   /* one per element of 'list', in the same order */
+   database_state_index_t *indexes;
    struct string_list *list;
    uint8_t *buf;
    size_t list_index;
@@ -54,6 +98,7 @@ typedef struct database_state_handle
    uint32_t archive_crc;
    char archive_name[511];
    char serial[4096];
+   database_probe_t probe;
 } database_state_handle_t;
 
 enum db_flags_enum
@@ -67,9 +112,11 @@ enum db_flags_enum
 typedef struct db_handle
 {
    char *playlist_directory;
+   char *cache_directory;
    char *content_database_path;
    char *fullpath;
    database_info_handle_t *handle;
+   struct database_hasher *hasher;
    database_state_handle_t state;
    playlist_config_t playlist_config; /* size_t alignment */
    unsigned status;
@@ -282,6 +329,20 @@ static int task_database_gdi_get_serial(const char *name, char* serial, size_t s
    return intfstream_file_get_serial(track_path, 0, SIZE_MAX, serial, serial_len);
 }
 
+static void task_database_chd_close(intfstream_t *fd, const char *name)
+{
+   chdstream_stats_t stats;
+
+   if (intfstream_get_chd_stats(fd, &stats))
+      RARCH_LOG("[Database]: CHD hunk cache for \"%s\": "
+            "%u hits (%u prefetched, %u waited for), %u misses.\n",
+            name, (unsigned)stats.hits, (unsigned)stats.prefetch_hits,
+            (unsigned)stats.waits, (unsigned)stats.misses);
+
+   intfstream_close(fd);
+   free(fd);
+}
+
 static int task_database_chd_get_serial(const char *name, char* serial, size_t serial_len)
 {
    int result;
@@ -294,15 +355,45 @@ static int task_database_chd_get_serial(const char *name, char* serial, size_t s
       return 0;
 
    result = intfstream_get_serial(fd, serial, serial_len, name);
-   intfstream_close(fd);
-   free(fd);
+   task_database_chd_close(fd, name);
    return result;
 }
 
+/* Content is hashed in blocks this large, rather
+ * than the 4 KiB intfstream_get_crc() uses */
+#define DATABASE_CRC_BLOCK_SIZE (1024 * 1024)
+
+/* CRC of the rest of 'fd'. 'bytes' is increased
+ * by the amount read */
+static bool task_database_stream_crc(intfstream_t *fd,
+      uint32_t *crc, uint64_t *bytes)
+{
+   int64_t len;
+   uint32_t accumulator = 0;
+   uint8_t *buf         = (uint8_t*)malloc(DATABASE_CRC_BLOCK_SIZE);
+
+   if (!buf)
+      return false;
+
+   while ((len = intfstream_read(fd, buf, DATABASE_CRC_BLOCK_SIZE)) > 0)
+   {
+      accumulator = encoding_crc32(accumulator, buf, (size_t)len);
+      *bytes     += (uint64_t)len;
+   }
+
+   free(buf);
+
+   if (len < 0)
+      return false;
+
+   *crc = accumulator;
+   return true;
+}
+
 static bool intfstream_file_get_crc(const char *name,
-      uint64_t offset, size_t size, uint32_t *crc)
+      uint64_t offset, size_t size, uint32_t *crc, uint64_t *bytes)
 {
-   bool rv;
+   bool rv           = false;
    intfstream_t *fd  = intfstream_open_file(name,
          RETRO_VFS_FILE_ACCESS_READ, RETRO_VFS_FILE_ACCESS_HINT_NONE);
    uint8_t *data     = NULL;
@@ -312,53 +403,45 @@ static bool intfstream_file_get_crc(const char *name,
       return 0;
 
    if (intfstream_seek(fd, 0, SEEK_END) == -1)
-      goto error;
+      goto end;
 
    file_size = intfstream_tell(fd);
 
    if (intfstream_seek(fd, 0, SEEK_SET) == -1)
-      goto error;
+      goto end;
 
    if (file_size < 0)
-      goto error;
+      goto end;
 
    if (offset != 0 || size < (uint64_t) file_size)
    {
+      /* A track within the file, read in one go */
       if (intfstream_seek(fd, (int64_t)offset, SEEK_SET) == -1)
-         goto error;
+         goto end;
 
-      data = (uint8_t*)malloc(size);
+      if (!(data = (uint8_t*)malloc(size)))
+         goto end;
 
       if (intfstream_read(fd, data, size) != (int64_t) size)
-         goto error;
-
-      intfstream_close(fd);
-      free(fd);
-      fd = intfstream_open_memory(data, RETRO_VFS_FILE_ACCESS_READ,
-            RETRO_VFS_FILE_ACCESS_HINT_NONE, size);
+         goto end;
 
-      if (!fd)
-         goto error;
+      *crc    = encoding_crc32(0, data, size);
+      *bytes += size;
+      rv      = true;
    }
+   else
+      rv      = task_database_stream_crc(fd, crc, bytes);
 
-   rv = intfstream_get_crc(fd, crc);
+end:
    intfstream_close(fd);
    free(fd);
-   free(data);
-   return rv;
-
-error:
-   if (fd)
-   {
-      intfstream_close(fd);
-      free(fd);
-   }
    if (data)
       free(data);
-   return 0;
+   return rv;
 }
 
-static int task_database_cue_get_crc(const char *name, uint32_t *crc)
+static int task_database_cue_get_crc(const char *name, uint32_t *crc,
+      uint64_t *bytes)
 {
    char track_path[PATH_MAX_LENGTH];
    uint64_t offset  = 0;
@@ -376,10 +459,12 @@ static int task_database_cue_get_crc(const char *name, uint32_t *crc)
       return 0;
    }
 
-   return intfstream_file_get_crc(track_path, offset, (size_t)size, crc);
+   return intfstream_file_get_crc(track_path, offset, (size_t)size,
+         crc, bytes);
 }
 
-static int task_database_gdi_get_crc(const char *name, uint32_t *crc)
+static int task_database_gdi_get_crc(const char *name, uint32_t *crc,
+      uint64_t *bytes)
 {
    char track_path[PATH_MAX_LENGTH];
 
@@ -395,10 +480,11 @@ static int task_database_gdi_get_crc(const char *name, uint32_t *crc)
       return 0;
    }
 
-   return intfstream_file_get_crc(track_path, 0, SIZE_MAX, crc);
+   return intfstream_file_get_crc(track_path, 0, SIZE_MAX, crc, bytes);
 }
 
-static bool task_database_chd_get_crc(const char *name, uint32_t *crc)
+static bool task_database_chd_get_crc(const char *name, uint32_t *crc,
+      uint64_t *bytes)
 {
    bool found_crc   = false;
    intfstream_t *fd = intfstream_open_chd_track(
@@ -409,12 +495,8 @@ static bool task_database_chd_get_crc(const char *name, uint32_t *crc)
    if (!fd)
       return 0;
 
-   found_crc = intfstream_get_crc(fd, crc);
-   if (fd)
-   {
-      intfstream_close(fd);
-      free(fd);
-   }
+   found_crc = task_database_stream_crc(fd, crc, bytes);
+   task_database_chd_close(fd, name);
    return found_crc;
 }
 
@@ -528,43 +610,48 @@ static enum msg_file_type extension_to_file_type(const char *ext)
    return FILE_TYPE_NONE;
 }
 
-static int task_database_iterate_playlist(
-      database_state_handle_t *db_state,
-      database_info_handle_t *db, const char *name)
+static void task_database_probe(const char *name, database_probe_t *probe)
 {
+   probe->serial[0] = '\0';
+   probe->crc       = 0;
+   probe->type      = DATABASE_TYPE_NONE;
+   probe->ret       = 1;
+   probe->bytes     = 0;
+   probe->archive   = false;
+
    switch (extension_to_file_type(path_get_extension(name)))
    {
       case FILE_TYPE_COMPRESSED:
 #ifdef HAVE_COMPRESSION
-         db->type = DATABASE_TYPE_CRC_LOOKUP;
+         probe->type    = DATABASE_TYPE_CRC_LOOKUP;
+         probe->archive = true;
          /* first check crc of archive itself */
-         return intfstream_file_get_crc(name,
-               0, SIZE_MAX, &db_state->archive_crc);
-#else
-         break;
+         probe->ret     = intfstream_file_get_crc(name,
+               0, SIZE_MAX, &probe->crc, &probe->bytes);
 #endif
+         break;
       case FILE_TYPE_CUE:
-         task_database_cue_prune(db, name);
-         db_state->serial[0] = '\0';
-         if (task_database_cue_get_serial(name, db_state->serial, sizeof(db_state->serial)))
-            db->type = DATABASE_TYPE_SERIAL_LOOKUP;
+         if (task_database_cue_get_serial(name, probe->serial,
+                  sizeof(probe->serial)))
+            probe->type = DATABASE_TYPE_SERIAL_LOOKUP;
          else
          {
-            db->type = DATABASE_TYPE_CRC_LOOKUP;
-            return task_database_cue_get_crc(name, &db_state->crc);
+            probe->type = DATABASE_TYPE_CRC_LOOKUP;
+            probe->ret  = task_database_cue_get_crc(name, &probe->crc,
+                  &probe->bytes);
          }
          break;
       case FILE_TYPE_GDI:
-         gdi_prune(db, name);
-         db_state->serial[0] = '\0';
          /* There are no serial databases, so don't bother with
             serials at the moment */
-         if (0 && task_database_gdi_get_serial(name, db_state->serial, sizeof(db_state->serial)))
-            db->type = DATABASE_TYPE_SERIAL_LOOKUP;
+         if (0 && task_database_gdi_get_serial(name, probe->serial,
+                  sizeof(probe->serial)))
+            probe->type = DATABASE_TYPE_SERIAL_LOOKUP;
          else
          {
-            db->type = DATABASE_TYPE_CRC_LOOKUP;
-            return task_database_gdi_get_crc(name, &db_state->crc);
+            probe->type = DATABASE_TYPE_CRC_LOOKUP;
+            probe->ret  = task_database_gdi_get_crc(name, &probe->crc,
+                  &probe->bytes);
          }
          break;
       /* Consider WBFS, RVZ and WIA files similar to ISO files. */
@@ -572,30 +659,685 @@ static int task_database_iterate_playlist(
       case FILE_TYPE_RVZ:
       case FILE_TYPE_WIA:
       case FILE_TYPE_ISO:
-         db_state->serial[0] = '\0';
-         intfstream_file_get_serial(name, 0, SIZE_MAX, db_state->serial, sizeof(db_state->serial));
-         db->type            =  DATABASE_TYPE_SERIAL_LOOKUP;
+         intfstream_file_get_serial(name, 0, SIZE_MAX, probe->serial,
+               sizeof(probe->serial));
+         probe->type    = DATABASE_TYPE_SERIAL_LOOKUP;
          break;
       case FILE_TYPE_CHD:
-         db_state->serial[0] = '\0';
-         if (task_database_chd_get_serial(name, db_state->serial, sizeof(db_state->serial)))
-            db->type         = DATABASE_TYPE_SERIAL_LOOKUP;
+         if (task_database_chd_get_serial(name, probe->serial,
+                  sizeof(probe->serial)))
+            probe->type = DATABASE_TYPE_SERIAL_LOOKUP;
          else
          {
-            db->type         = DATABASE_TYPE_CRC_LOOKUP;
-            return task_database_chd_get_crc(name, &db_state->crc);
+            probe->type = DATABASE_TYPE_CRC_LOOKUP;
+            probe->ret  = task_database_chd_get_crc(name, &probe->crc,
+                  &probe->bytes);
          }
          break;
       case FILE_TYPE_LUTRO:
-         db->type            = DATABASE_TYPE_ITERATE_LUTRO;
+         probe->type    = DATABASE_TYPE_ITERATE_LUTRO;
          break;
       default:
-         db_state->serial[0] = '\0';
-         db->type            = DATABASE_TYPE_CRC_LOOKUP;
-         return intfstream_file_get_crc(name, 0, SIZE_MAX, &db_state->crc);
+         probe->type    = DATABASE_TYPE_CRC_LOOKUP;
+         probe->ret     = intfstream_file_get_crc(name,
+               0, SIZE_MAX, &probe->crc, &probe->bytes);
+         break;
    }
+}
 
-   return 1;
+/* Hashing stage
+ *
+ * Reading and hashing files is what a scan spends its
+ * time on, so the files following the current one are
+ * probed ahead of time by a few workers while the task
+ * matches the current one against the databases.
+ *
+ * Results are also kept in a cache keyed by path, size
+ * and modification time, which is saved to the cache
+ * directory so unchanged files are not read again on
+ * the next scan. Entries of files that no longer exist
+ * are dropped when it's saved. Cue and gdi sheets aren't
+ * cached since their result depends on the files they
+ * point to. */
+
+#define DATABASE_HASH_CACHE_FILE   "content_hash_cache.bin"
+#define DATABASE_HASH_CACHE_MAGIC  0x52414843 /* RAHC */
+#define DATABASE_HASH_CACHE_VER    1
+/* how many files are probed ahead of the matching stage */
+#define DATABASE_HASH_SLOTS        16
+#define DATABASE_HASH_MAX_WORKERS  4
+
+typedef struct database_hash_cache_entry
+{
+   char *serial;
+   int64_t size;
+   int64_t mtime;
+   uint32_t crc;
+   uint8_t type;
+   uint8_t ret;
+   bool archive;
+   /* hit or stored by this scan, so the file exists */
+   bool seen;
+} database_hash_cache_entry_t;
+
+enum database_hash_slot_state
+{
+   DATABASE_HASH_SLOT_EMPTY = 0,
+   DATABASE_HASH_SLOT_QUEUED,
+   DATABASE_HASH_SLOT_RUNNING,
+   DATABASE_HASH_SLOT_DONE
+};
+
+typedef struct database_hash_slot
+{
+   char *path;
+   size_t list_index;
+   int64_t size;
+   int64_t mtime;
+   database_probe_t probe;
+   enum database_hash_slot_state state;
+   bool cacheable;
+} database_hash_slot_t;
+
+typedef struct database_hasher
+{
+   char cache_path[PATH_MAX_LENGTH];
+   /* keyed by path, only touched by the task */
+   database_hash_cache_entry_t *cache;
+#ifdef HAVE_THREADS
+   database_hash_slot_t slots[DATABASE_HASH_SLOTS];
+   sthread_t *workers[DATABASE_HASH_MAX_WORKERS];
+   slock_t *lock;
+   scond_t *cond;
+   unsigned num_workers;
+   bool quit;
+#endif
+   retro_time_t start_time;
+   uint64_t bytes;
+   unsigned files;
+   unsigned cached;
+   bool cache_dirty;
+} database_hasher_t;
+
+static bool database_hash_stat(const char *path,
+      int64_t *size, int64_t *mtime)
+{
+#if defined(_WIN32) && !defined(_XBOX)
+   struct _stat64 buf;
+   if (_stat64(path, &buf) != 0)
+      return false;
+   *size  = (int64_t)buf.st_size;
+   *mtime = (int64_t)buf.st_mtime;
+   return true;
+#elif defined(__unix__) || defined(__APPLE__) || defined(__HAIKU__)
+   struct stat buf;
+   if (stat(path, &buf) != 0)
+      return false;
+   *size  = (int64_t)buf.st_size;
+   *mtime = (int64_t)buf.st_mtime;
+   return true;
+#else
+   /* No modification time, nothing can be cached */
+   return false;
+#endif
+}
+
+static bool database_hash_is_cacheable(const char *path)
+{
+   switch (extension_to_file_type(path_get_extension(path)))
+   {
+      case FILE_TYPE_CUE:
+      case FILE_TYPE_GDI:
+         return false;
+      default:
+         break;
+   }
+   return true;
+}
+
+static bool database_hash_cache_get(database_hasher_t *hasher,
+      const char *path, int64_t size, int64_t mtime,
+      database_probe_t *probe)
+{
+   database_hash_cache_entry_t *entry = NULL;
+   ptrdiff_t idx = RHMAP_IDX_STR(hasher->cache, path);
+
+   if (idx < 0)
+      return false;
+
+   entry = &hasher->cache[idx];
+   if (entry->size != size || entry->mtime != mtime)
+      return false;
+
+   entry->seen    = true;
+
+   if (entry->serial)
+      strlcpy(probe->serial, entry->serial, sizeof(probe->serial));
+   else
+      probe->serial[0] = '\0';
+   probe->crc     = entry->crc;
+   probe->type    = (enum database_type)entry->type;
+   probe->ret     = entry->ret;
+   probe->bytes   = 0;
+   probe->archive = entry->archive;
+   return true;
+}
+
+static void database_hash_cache_set(database_hasher_t *hasher,
+      const char *path, int64_t size, int64_t mtime,
+      const database_probe_t *probe)
+{
+   database_hash_cache_entry_t entry;
+   database_hash_cache_entry_t *old = NULL;
+   ptrdiff_t idx                    = RHMAP_IDX_STR(hasher->cache, path);
+
+   if (idx >= 0)
+   {
+      old = &hasher->cache[idx];
+      if (old->serial)
+         free(old->serial);
+      old->serial = NULL;
+   }
+
+   entry.serial  = string_is_empty(probe->serial)
+      ? NULL : strdup(probe->serial);
+   entry.size    = size;
+   entry.mtime   = mtime;
+   entry.crc     = probe->crc;
+   entry.type    = (uint8_t)probe->type;
+   entry.ret     = (uint8_t)probe->ret;
+   entry.archive = probe->archive;
+   entry.seen    = true;
+
+   RHMAP_SET_STR(hasher->cache, path, entry);
+   hasher->cache_dirty = true;
+}
+
+/* File layout, native byte order:
+ * magic, version, count, then per entry
+ * size, mtime, crc, type, ret, archive, path length,
+ * serial length, path, serial */
+static void database_hash_cache_load(database_hasher_t *hasher)
+{
+   uint32_t header[3];
+   uint32_t i;
+   RFILE *file = filestream_open(hasher->cache_path,
+         RETRO_VFS_FILE_ACCESS_READ,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!file)
+      return;
+
+   if (     filestream_read(file, header, sizeof(header)) != sizeof(header)
+         || header[0] != DATABASE_HASH_CACHE_MAGIC
+         || header[1] != DATABASE_HASH_CACHE_VER)
+      goto end;
+
+   for (i = 0; i < header[2]; i++)
+   {
+      database_hash_cache_entry_t entry;
+      char path[PATH_MAX_LENGTH];
+      char serial[4096];
+      uint8_t flags[3];
+      uint16_t lens[2];
+
+      if (     filestream_read(file, &entry.size,  sizeof(entry.size))
+               != sizeof(entry.size)
+            || filestream_read(file, &entry.mtime, sizeof(entry.mtime))
+               != sizeof(entry.mtime)
+            || filestream_read(file, &entry.crc,   sizeof(entry.crc))
+               != sizeof(entry.crc)
+            || filestream_read(file, flags, sizeof(flags)) != sizeof(flags)
+            || filestream_read(file, lens,  sizeof(lens))  != sizeof(lens)
+            || lens[0] >= sizeof(path)
+            || lens[1] >= sizeof(serial)
+            || filestream_read(file, path,   lens[0]) != lens[0]
+            || filestream_read(file, serial, lens[1]) != lens[1])
+         break;
+
+      path[lens[0]]   = '\0';
+      serial[lens[1]] = '\0';
+      entry.serial    = lens[1] ? strdup(serial) : NULL;
+      entry.type      = flags[0];
+      entry.ret       = flags[1];
+      entry.archive   = flags[2] != 0;
+      entry.seen      = false;
+
+      if (RHMAP_HAS_STR(hasher->cache, path))
+      {
+         if (entry.serial)
+            free(entry.serial);
+         continue;
+      }
+
+      RHMAP_SET_STR(hasher->cache, path, entry);
+   }
+
+end:
+   filestream_close(file);
+}
+
+/* Drops the entries of files that were deleted or
+ * moved. Entries this scan didn't touch may belong
+ * to other directories, so only those are checked */
+static void database_hash_cache_prune(database_hasher_t *hasher)
+{
+   size_t i   = 0;
+   size_t cap = RHMAP_CAP(hasher->cache);
+
+   while (i != cap)
+   {
+      const char *path                   = NULL;
+      database_hash_cache_entry_t *entry = NULL;
+
+      if (!RHMAP_KEY(hasher->cache, i))
+      {
+         i++;
+         continue;
+      }
+
+      path  = RHMAP_KEY_STR(hasher->cache, i);
+      entry = &hasher->cache[i];
+
+      if (entry->seen || path_is_valid(path))
+      {
+         i++;
+         continue;
+      }
+
+      /* Deleting may move a later entry into slot 'i',
+       * so it is looked at again */
+      if (entry->serial)
+         free(entry->serial);
+      (void)RHMAP_DEL_STR(hasher->cache, path);
+      hasher->cache_dirty = true;
+   }
+}
+
+static void database_hash_cache_save(database_hasher_t *hasher)
+{
+   size_t i, cap;
+   uint32_t header[3];
+   RFILE *file = NULL;
+
+   if (string_is_empty(hasher->cache_path))
+      return;
+
+   database_hash_cache_prune(hasher);
+
+   if (!hasher->cache_dirty)
+      return;
+
+   if (!(file = filestream_open(hasher->cache_path,
+         RETRO_VFS_FILE_ACCESS_WRITE,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+      return;
+
+   header[0] = DATABASE_HASH_CACHE_MAGIC;
+   header[1] = DATABASE_HASH_CACHE_VER;
+   header[2] = (uint32_t)RHMAP_LEN(hasher->cache);
+   filestream_write(file, header, sizeof(header));
+
+   for (i = 0, cap = RHMAP_CAP(hasher->cache); i != cap; i++)
+   {
+      uint8_t flags[3];
+      uint16_t lens[2];
+      const char *path                   = NULL;
+      database_hash_cache_entry_t *entry = NULL;
+
+      if (!RHMAP_KEY(hasher->cache, i))
+         continue;
+
+      path     = RHMAP_KEY_STR(hasher->cache, i);
+      entry    = &hasher->cache[i];
+      flags[0] = entry->type;
+      flags[1] = entry->ret;
+      flags[2] = entry->archive ? 1 : 0;
+      lens[0]  = (uint16_t)strlen(path);
+      lens[1]  = (uint16_t)(entry->serial ? strlen(entry->serial) : 0);
+
+      filestream_write(file, &entry->size,  sizeof(entry->size));
+      filestream_write(file, &entry->mtime, sizeof(entry->mtime));
+      filestream_write(file, &entry->crc,   sizeof(entry->crc));
+      filestream_write(file, flags, sizeof(flags));
+      filestream_write(file, lens,  sizeof(lens));
+      filestream_write(file, path,  lens[0]);
+      if (lens[1])
+         filestream_write(file, entry->serial, lens[1]);
+   }
+
+   filestream_close(file);
+   hasher->cache_dirty = false;
+}
+
+#ifdef HAVE_THREADS
+static void database_hash_worker(void *data)
+{
+   database_hasher_t *hasher = (database_hasher_t*)data;
+
+   slock_lock(hasher->lock);
+
+   while (!hasher->quit)
+   {
+      unsigned i;
+      database_hash_slot_t *slot = NULL;
+
+      /* Oldest queued file first, that's the one
+       * the task will want next */
+      for (i = 0; i < DATABASE_HASH_SLOTS; i++)
+      {
+         database_hash_slot_t *s = &hasher->slots[i];
+         if (     s->state == DATABASE_HASH_SLOT_QUEUED
+               && (!slot || s->list_index < slot->list_index))
+            slot = s;
+      }
+
+      if (!slot)
+      {
+         scond_wait(hasher->cond, hasher->lock);
+         continue;
+      }
+
+      slot->state = DATABASE_HASH_SLOT_RUNNING;
+      slock_unlock(hasher->lock);
+
+      task_database_probe(slot->path, &slot->probe);
+
+      slock_lock(hasher->lock);
+      slot->state = DATABASE_HASH_SLOT_DONE;
+      scond_broadcast(hasher->cond);
+   }
+
+   slock_unlock(hasher->lock);
+}
+
+/* 'lock' must be held, and 'slot' must not be running */
+static void database_hash_slot_clear(database_hash_slot_t *slot)
+{
+   if (slot->path)
+      free(slot->path);
+   slot->path  = NULL;
+   slot->state = DATABASE_HASH_SLOT_EMPTY;
+}
+
+/* Queues the files that follow 'list_ptr' */
+static void database_hash_fill(database_hasher_t *hasher,
+      database_info_handle_t *db)
+{
+   size_t i;
+   size_t end = db->list_ptr + 1 + DATABASE_HASH_SLOTS;
+   bool queued = false;
+
+   if (!hasher->num_workers)
+      return;
+
+   if (end > db->list->size)
+      end = db->list->size;
+
+   slock_lock(hasher->lock);
+
+   for (i = db->list_ptr + 1; i < end; i++)
+   {
+      database_hash_slot_t *slot = &hasher->slots[i % DATABASE_HASH_SLOTS];
+      const char *path           = db->list->elems[i].data;
+
+      /* Pruned by a cue/gdi sheet */
+      if (!path)
+         continue;
+
+      /* Sheets go first and may prune the files that follow,
+       * so don't read ahead of one that's still to be handled */
+      if (!database_hash_is_cacheable(path))
+         break;
+
+      /* Archive members are looked up by the CRC
+       * stored in the archive */
+      if (path_contains_compressed_file(path))
+         continue;
+
+      if (slot->state != DATABASE_HASH_SLOT_EMPTY)
+      {
+         if (     slot->list_index == i
+               && string_is_equal(slot->path, path))
+            continue;
+         /* Left behind by a file that was pruned or moved
+          * by an archive being expanded into the list */
+         if (slot->state == DATABASE_HASH_SLOT_RUNNING)
+            continue;
+         database_hash_slot_clear(slot);
+      }
+
+      slot->path       = strdup(path);
+      slot->list_index = i;
+      slot->cacheable  = database_hash_stat(path, &slot->size, &slot->mtime);
+      if (     slot->cacheable
+            && database_hash_cache_get(hasher, path,
+               slot->size, slot->mtime, &slot->probe))
+      {
+         slot->cacheable = false;
+         slot->state     = DATABASE_HASH_SLOT_DONE;
+         hasher->cached++;
+         continue;
+      }
+
+      slot->state = DATABASE_HASH_SLOT_QUEUED;
+      queued      = true;
+   }
+
+   if (queued)
+      scond_broadcast(hasher->cond);
+
+   slock_unlock(hasher->lock);
+}
+
+/* Returns the probe of 'path' if it was queued */
+static bool database_hash_take(database_hasher_t *hasher,
+      size_t list_index, const char *path, database_probe_t *probe)
+{
+   database_hash_slot_t *slot =
+      &hasher->slots[list_index % DATABASE_HASH_SLOTS];
+
+   if (!hasher->num_workers)
+      return false;
+
+   slock_lock(hasher->lock);
+
+   if (     slot->state == DATABASE_HASH_SLOT_EMPTY
+         || slot->list_index != list_index
+         || !string_is_equal(slot->path, path))
+   {
+      slock_unlock(hasher->lock);
+      return false;
+   }
+
+   /* Not picked up yet, quicker to do it here */
+   if (slot->state == DATABASE_HASH_SLOT_QUEUED)
+   {
+      slot->state = DATABASE_HASH_SLOT_RUNNING;
+      slock_unlock(hasher->lock);
+      task_database_probe(path, &slot->probe);
+      slock_lock(hasher->lock);
+      slot->state = DATABASE_HASH_SLOT_DONE;
+   }
+
+   while (slot->state != DATABASE_HASH_SLOT_DONE)
+      scond_wait(hasher->cond, hasher->lock);
+
+   memcpy(probe, &slot->probe, sizeof(*probe));
+
+   if (slot->cacheable)
+      database_hash_cache_set(hasher, path,
+            slot->size, slot->mtime, probe);
+
+   hasher->bytes += probe->bytes;
+   database_hash_slot_clear(slot);
+
+   slock_unlock(hasher->lock);
+   return true;
+}
+#endif
+
+static database_hasher_t *database_hasher_new(const char *cache_dir)
+{
+   database_hasher_t *hasher = (database_hasher_t*)
+      calloc(1, sizeof(*hasher));
+
+   if (!hasher)
+      return NULL;
+
+   if (!string_is_empty(cache_dir))
+   {
+      fill_pathname_join_special(hasher->cache_path, cache_dir,
+            DATABASE_HASH_CACHE_FILE, sizeof(hasher->cache_path));
+      database_hash_cache_load(hasher);
+   }
+
+#ifdef HAVE_THREADS
+   if ((hasher->lock = slock_new()) && (hasher->cond = scond_new()))
+   {
+      unsigned i;
+      int cores = cpu_features_get_core_amount();
+
+      if (cores > DATABASE_HASH_MAX_WORKERS)
+         cores  = DATABASE_HASH_MAX_WORKERS;
+
+      for (i = 0; i < (unsigned)cores; i++)
+      {
+         if (!(hasher->workers[i] = sthread_create(
+                     database_hash_worker, hasher)))
+            break;
+         hasher->num_workers++;
+      }
+   }
+#endif
+
+   hasher->start_time = cpu_features_get_time_usec();
+
+   return hasher;
+}
+
+static void database_hasher_free(database_hasher_t *hasher)
+{
+   size_t i, cap;
+   retro_time_t elapsed;
+
+   if (!hasher)
+      return;
+
+#ifdef HAVE_THREADS
+   if (hasher->lock)
+   {
+      slock_lock(hasher->lock);
+      hasher->quit = true;
+      if (hasher->cond)
+         scond_broadcast(hasher->cond);
+      slock_unlock(hasher->lock);
+   }
+
+   for (i = 0; i < hasher->num_workers; i++)
+      sthread_join(hasher->workers[i]);
+
+   for (i = 0; i < DATABASE_HASH_SLOTS; i++)
+      database_hash_slot_clear(&hasher->slots[i]);
+
+   if (hasher->cond)
+      scond_free(hasher->cond);
+   if (hasher->lock)
+      slock_free(hasher->lock);
+#endif
+
+   elapsed = cpu_features_get_time_usec() - hasher->start_time;
+   if (hasher->files && elapsed > 0)
+      RARCH_LOG("[Database]: Identified %u files (%u cached) in %.2f s: "
+            "%.1f files/s, %.1f MB/s.\n",
+            hasher->files, hasher->cached, elapsed / 1000000.0,
+            hasher->files / (elapsed / 1000000.0),
+            hasher->bytes / (double)elapsed);
+
+   database_hash_cache_save(hasher);
+
+   for (i = 0, cap = RHMAP_CAP(hasher->cache); i != cap; i++)
+      if (RHMAP_KEY(hasher->cache, i) && hasher->cache[i].serial)
+         free(hasher->cache[i].serial);
+   RHMAP_FREE(hasher->cache);
+
+   free(hasher);
+}
+
+/* Probes 'name', from the workers or the cache if possible */
+static void database_hasher_get(database_hasher_t *hasher,
+      database_info_handle_t *db, const char *name,
+      database_probe_t *probe)
+{
+   int64_t size  = 0;
+   int64_t mtime = 0;
+
+   hasher->files++;
+
+#ifdef HAVE_THREADS
+   if (!database_hash_take(hasher, db->list_ptr, name, probe))
+#endif
+   {
+      bool cacheable = database_hash_is_cacheable(name)
+         && database_hash_stat(name, &size, &mtime);
+
+      if (cacheable && database_hash_cache_get(hasher, name,
+               size, mtime, probe))
+         hasher->cached++;
+      else
+      {
+         task_database_probe(name, probe);
+         if (cacheable)
+            database_hash_cache_set(hasher, name, size, mtime, probe);
+      }
+
+      hasher->bytes += probe->bytes;
+   }
+
+#ifdef HAVE_THREADS
+   database_hash_fill(hasher, db);
+#endif
+}
+
+static int task_database_iterate_playlist(
+      db_handle_t *_db,
+      database_state_handle_t *db_state,
+      database_info_handle_t *db, const char *name)
+{
+   database_probe_t *probe = &db_state->probe;
+
+   /* Sheets drop the files they reference from the list,
+    * this has to happen here before anything reads ahead */
+   switch (extension_to_file_type(path_get_extension(name)))
+   {
+      case FILE_TYPE_CUE:
+         task_database_cue_prune(db, name);
+         break;
+      case FILE_TYPE_GDI:
+         gdi_prune(db, name);
+         break;
+      default:
+         break;
+   }
+
+   if (_db->hasher)
+      database_hasher_get(_db->hasher, db, name, probe);
+   else
+      task_database_probe(name, probe);
+
+   if (probe->type != DATABASE_TYPE_NONE)
+      db->type = probe->type;
+
+   if (probe->archive)
+      db_state->archive_crc = probe->crc;
+   else
+   {
+      strlcpy(db_state->serial, probe->serial, sizeof(db_state->serial));
+      if (probe->type == DATABASE_TYPE_CRC_LOOKUP)
+         db_state->crc      = probe->crc;
+   }
+
+   return probe->ret;
 }
 
 static int database_info_list_iterate_end_no_match(
@@ -674,6 +1416,80 @@ static int database_info_list_iterate_new(database_state_handle_t *db_state,
    return 0;
 }
 
+/* Fills db_state->info with the entries of the current
+ * database whose 'crc' (or 'serial') field equals one of
+ * the keys, using the database's index instead of walking
+ * all of its records. Returns false if no index could be
+ * built, in which case a query should be used instead. */
+static bool database_info_list_iterate_indexed(db_handle_t *_db,
+      database_state_handle_t *db_state, bool serial,
+      const void *key, size_t len,
+      const void *key2, size_t len2)
+{
+   database_state_index_t *entry  = NULL;
+   database_info_index_t **index  = NULL;
+   uint8_t failed_flag            = serial
+      ? DB_INDEX_FLAG_SERIAL_FAILED : DB_INDEX_FLAG_CRC_FAILED;
+   database_info_list_t *list     = NULL;
+
+   if (!db_state->indexes)
+      return false;
+
+   entry = &db_state->indexes[db_state->list_index];
+   index = serial ? &entry->serial : &entry->crc;
+
+   if (!*index)
+   {
+      if (entry->flags & failed_flag)
+         return false;
+
+      if (!(*index = database_info_index_new(
+               database_info_get_current_name(db_state),
+               serial ? "serial" : "crc",
+               _db->cache_directory)))
+      {
+         entry->flags |= failed_flag;
+         return false;
+      }
+   }
+
+   if (!(list = (database_info_list_t*)calloc(1, sizeof(*list))))
+      return false;
+
+   if (     !database_info_index_lookup(*index, key, len, list)
+         || (key2 && !database_info_index_lookup(*index, key2, len2, list)))
+   {
+      database_info_list_free(list);
+      free(list);
+      return false;
+   }
+
+   if (db_state->info)
+   {
+      database_info_list_free(db_state->info);
+      free(db_state->info);
+   }
+   db_state->info = list;
+   return true;
+}
+
+static void database_state_indexes_free(database_state_handle_t *db_state)
+{
+   size_t i;
+
+   if (!db_state->indexes)
+      return;
+
+   for (i = 0; i < db_state->list->size; i++)
+   {
+      database_info_index_free(db_state->indexes[i].crc);
+      database_info_index_free(db_state->indexes[i].serial);
+   }
+
+   free(db_state->indexes);
+   db_state->indexes = NULL;
+}
+
 static int database_info_list_iterate_found_match(
       db_handle_t *_db,
       database_state_handle_t *db_state,
@@ -827,6 +1643,16 @@ static int database_info_list_iterate_found_match(
               &db_state->list->elems[0],
               sizeof(entry) * db_state->list_index);
       db_state->list->elems[0] = entry;
+
+      if (db_state->indexes)
+      {
+         database_state_index_t index =
+            db_state->indexes[db_state->list_index];
+         memmove(&db_state->indexes[1],
+                 &db_state->indexes[0],
+                 sizeof(index) * db_state->list_index);
+         db_state->indexes[0] = index;
+      }
    }
 
    free(db_crc);
@@ -879,6 +1705,7 @@ static int task_database_iterate_crc_lookup(
    if (db_state->entry_index == 0)
    {
       char query[50];
+      uint32_t crc_be, archive_be;
 
       query[0] = '\0';
 
@@ -901,11 +1728,21 @@ static int task_database_iterate_crc_lookup(
          }
       }
 
-      snprintf(query, sizeof(query),
-            "{crc:or(b\"%08lX\",b\"%08lX\")}",
-            (unsigned long)db_state->crc, (unsigned long)db_state->archive_crc);
+      /* The database stores CRCs as big endian binaries */
+      crc_be     = swap_if_little32(db_state->crc);
+      archive_be = swap_if_little32(db_state->archive_crc);
 
-      database_info_list_iterate_new(db_state, query);
+      if (!database_info_list_iterate_indexed(_db, db_state, false,
+               &crc_be, sizeof(crc_be),
+               (db_state->archive_crc && db_state->archive_crc != db_state->crc)
+               ? &archive_be : NULL, sizeof(archive_be)))
+      {
+         snprintf(query, sizeof(query),
+               "{crc:or(b\"%08lX\",b\"%08lX\")}",
+               (unsigned long)db_state->crc, (unsigned long)db_state->archive_crc);
+
+         database_info_list_iterate_new(db_state, query);
+      }
    }
 
    if (db_state->info)
@@ -1023,7 +1860,9 @@ static int task_database_iterate_serial_lookup(
       return database_info_list_iterate_end_no_match(db, db_state, name,
             path_contains_compressed_file);
 
-   if (db_state->entry_index == 0)
+   if (db_state->entry_index == 0 &&
+         !database_info_list_iterate_indexed(_db, db_state, true,
+            db_state->serial, strlen(db_state->serial), NULL, 0))
    {
       size_t _len;
       char query[50];
@@ -1090,7 +1929,7 @@ static int task_database_iterate(
    switch (db->type)
    {
       case DATABASE_TYPE_ITERATE:
-         return task_database_iterate_playlist(db_state, db, name);
+         return task_database_iterate_playlist(_db, db_state, db, name);
       case DATABASE_TYPE_ITERATE_ARCHIVE:
 #ifdef HAVE_COMPRESSION
          return task_database_iterate_crc_lookup(
@@ -1218,6 +2057,13 @@ static void task_database_handler(retro_task_t *task)
                   }
                }
             }
+
+            if (dbstate->list && dbstate->list->size)
+               dbstate->indexes = (database_state_index_t*)calloc(
+                     dbstate->list->size, sizeof(*dbstate->indexes));
+
+            if (!db->hasher)
+               db->hasher = database_hasher_new(db->cache_directory);
          }
          dbinfo->status = DATABASE_STATUS_ITERATE_START;
          break;
@@ -1289,13 +2135,19 @@ task_finished:
    if (dbstate)
    {
       if (dbstate->list)
+      {
+         database_state_indexes_free(dbstate);
          dir_list_free(dbstate->list);
+      }
    }
 
    if (db)
    {
+      database_hasher_free(db->hasher);
       if (!string_is_empty(db->playlist_directory))
          free(db->playlist_directory);
+      if (!string_is_empty(db->cache_directory))
+         free(db->cache_directory);
       if (!string_is_empty(db->content_database_path))
          free(db->content_database_path);
       if (!string_is_empty(db->fullpath))
@@ -1339,6 +2191,7 @@ bool task_push_dbscan(
       goto error;
 
    t->handler                              = task_database_handler;
+   t->priority                             = TASK_PRIORITY_BACKGROUND;
    t->state                                = db;
    t->callback                             = cb;
    t->title                                = strdup(msg_hash_to_str(
@@ -1353,12 +2206,20 @@ bool task_push_dbscan(
    db->playlist_config.old_format          = settings->bools.playlist_use_old_format;
    db->playlist_config.compress            = settings->bools.playlist_compression;
    db->playlist_config.fuzzy_archive_match = settings->bools.playlist_fuzzy_archive_match;
+   db->playlist_config.binary_cache        = settings->bools.playlist_binary_cache;
    playlist_config_set_base_content_directory(&db->playlist_config, settings->bools.playlist_portable_paths ? settings->paths.directory_menu_content : NULL);
+   if (!string_is_empty(settings->paths.directory_cache))
+      db->cache_directory                  = strdup(settings->paths.directory_cache);
+#ifdef HAVE_CHD
+   chdstream_set_cache_size(settings->uints.scan_chd_cache_size,
+         settings->uints.scan_chd_cache_size / 4);
+#endif
 #else
    db->playlist_config.capacity            = COLLECTION_SIZE;
    db->playlist_config.old_format          = false;
    db->playlist_config.compress            = false;
    db->playlist_config.fuzzy_archive_match = false;
+   db->playlist_config.binary_cache        = false;
    playlist_config_set_base_content_directory(&db->playlist_config, NULL);
 #endif
    if (db_dir_show_hidden_files)
@@ -798,6 +798,8 @@ bool task_push_netplay_crc_scan(uint32_t crc, const char *content,
       settings->bools.playlist_compression;
    data->playlist_config.fuzzy_archive_match =
       settings->bools.playlist_fuzzy_archive_match;
+   data->playlist_config.binary_cache        =
+      settings->bools.playlist_binary_cache;
    playlist_config_set_base_content_directory(&data->playlist_config,
       settings->bools.playlist_portable_paths ?
          settings->paths.directory_menu_content : NULL);
@@ -325,6 +325,7 @@ bool task_push_pl_manager_reset_cores(const playlist_config_t *playlist_config)
    strlcat(task_title, playlist_name, sizeof(task_title));
    
    task->handler                 = task_pl_manager_reset_cores_handler;
+   task->priority                = TASK_PRIORITY_BACKGROUND;
    task->state                   = pl_manager;
    task->title                   = strdup(task_title);
    task->alternative_look        = true;
@@ -750,6 +751,7 @@ bool task_push_pl_manager_clean_playlist(
    strlcat(task_title, playlist_name, sizeof(task_title));
    
    task->handler                 = task_pl_manager_clean_playlist_handler;
+   task->priority                = TASK_PRIORITY_BACKGROUND;
    task->state                   = pl_manager;
    task->title                   = strdup(task_title);
    task->alternative_look        = true;
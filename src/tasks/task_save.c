@@ -26,6 +26,7 @@
 #endif
 
 #include <compat/strl.h>
+#include <encodings/crc32.h>
 #include <lists/string_list.h>
 #include <streams/interface_stream.h>
 #include <streams/file_stream.h>
@@ -73,6 +74,25 @@
 #define RASTATE_CHEEVOS_BLOCK "ACHV"
 #define RASTATE_END_BLOCK "END "
 
+/* Autosave only writes the blocks of SRAM that changed
+ * since the last save, optionally journalling them first
+ * so that an interrupted save can be completed at load.
+ * Nothing is synced to disk between the journal and the
+ * in-place writes, so this covers the process being
+ * killed or crashing, not power loss or an OS crash.
+ * Journal layout (all values little endian):
+ * > Header: magic, version, SRAM file size, record count
+ * > Records: offset, length, data
+ * > Trailer: CRC32 of everything before it, end magic */
+#define AUTOSAVE_BLOCK_SIZE 4096
+
+#define SRAM_JOURNAL_VERSION 1
+#define SRAM_JOURNAL_MAGIC "RASJ"
+#define SRAM_JOURNAL_END "END "
+#define SRAM_JOURNAL_HEADER_SIZE 16
+#define SRAM_JOURNAL_RECORD_SIZE 8
+#define SRAM_JOURNAL_TRAILER_SIZE 8
+
 struct ram_type
 {
    const char *path;
@@ -138,7 +158,8 @@ struct autosave_st
 enum autosave_flags
 {
    AUTOSAVE_FLAG_QUIT           = (1 << 0),
-   AUTOSAVE_FLAG_COMPRESS_FILES = (1 << 1)
+   AUTOSAVE_FLAG_COMPRESS_FILES = (1 << 1),
+   AUTOSAVE_FLAG_JOURNAL        = (1 << 2)
 };
 
 struct autosave
@@ -146,13 +167,23 @@ struct autosave
    void *buffer;
    const void *retro_buffer;
    const char *path;
+   /* One flag per AUTOSAVE_BLOCK_SIZE block of 'buffer',
+    * set until that block has been written */
+   uint8_t *dirty;
    slock_t *lock;
    slock_t *cond_lock;
    scond_t *cond;
    sthread_t *thread;
    size_t bufsize;
+   size_t num_blocks;
    unsigned interval;
    uint8_t flags;
+   /* Set (under 'cond_lock') when the file was written
+    * elsewhere, so the next save rewrites all of it */
+   bool full_write;
+   /* Only touched by the autosave thread: the file
+    * holds 'buffer', uncompressed, at full size */
+   bool file_valid;
 };
 #endif
 
@@ -186,7 +217,215 @@ typedef struct rastate_size_info
 #endif
 } rastate_size_info_t;
 
+static void sram_journal_put_u32(uint8_t *data, uint32_t val)
+{
+   data[0] =  val        & 0xFF;
+   data[1] = (val >>  8) & 0xFF;
+   data[2] = (val >> 16) & 0xFF;
+   data[3] = (val >> 24) & 0xFF;
+}
+
+static uint32_t sram_journal_get_u32(const uint8_t *data)
+{
+   return ((uint32_t)data[3] << 24) |
+          ((uint32_t)data[2] << 16) |
+          ((uint32_t)data[1] <<  8) |
+           (uint32_t)data[0];
+}
+
+static void sram_journal_get_path(char *s, size_t len, const char *path)
+{
+   size_t _len = strlcpy(s, path, len);
+   strlcpy(s + _len, FILE_PATH_JOURNAL_EXTENSION, len - _len);
+}
+
+/* Called whenever the whole SRAM file has been written,
+ * as a leftover journal would revert blocks at load */
+static void sram_journal_delete(const char *path)
+{
+   char journal_path[PATH_MAX_LENGTH];
+   sram_journal_get_path(journal_path, sizeof(journal_path), path);
+   if (path_is_valid(journal_path))
+      filestream_delete(journal_path);
+}
+
 #ifdef HAVE_THREADS
+/* Finds the next run of dirty blocks, starting at '*block'.
+ * Returns false once there are none left */
+static bool autosave_next_dirty_run(const autosave_t *save,
+      size_t *block, size_t *offset, size_t *len)
+{
+   size_t i = *block;
+
+   while (i < save->num_blocks && !save->dirty[i])
+      i++;
+
+   if (i >= save->num_blocks)
+      return false;
+
+   *offset = i * AUTOSAVE_BLOCK_SIZE;
+
+   while (i < save->num_blocks && save->dirty[i])
+      i++;
+
+   *len    = MIN(i * AUTOSAVE_BLOCK_SIZE, save->bufsize) - *offset;
+   *block  = i;
+   return true;
+}
+
+/* Copies every block of SRAM that changed into the
+ * autosave buffer and marks it dirty. Must be called
+ * with the autosave lock held.
+ * Returns the number of dirty blocks. */
+static size_t autosave_update_blocks(autosave_t *save)
+{
+   size_t i;
+   size_t num_dirty            = 0;
+   uint8_t *buffer             = (uint8_t*)save->buffer;
+   const uint8_t *retro_buffer = (const uint8_t*)save->retro_buffer;
+
+   for (i = 0; i < save->num_blocks; i++)
+   {
+      size_t offset = i * AUTOSAVE_BLOCK_SIZE;
+      size_t len    = MIN(save->bufsize - offset, AUTOSAVE_BLOCK_SIZE);
+
+      if (memcmp(buffer + offset, retro_buffer + offset, len))
+      {
+         memcpy(buffer + offset, retro_buffer + offset, len);
+         save->dirty[i] = 1;
+      }
+
+      if (save->dirty[i])
+         num_dirty++;
+   }
+
+   return num_dirty;
+}
+
+/* Rewrites the whole file, the way a regular save does */
+static bool autosave_write_full(autosave_t *save)
+{
+   int64_t written    = 0;
+   intfstream_t *file = NULL;
+
+   /* Should probably deal with this more elegantly. */
+   if (save->flags & AUTOSAVE_FLAG_COMPRESS_FILES)
+      file = intfstream_open_rzip_file(save->path,
+            RETRO_VFS_FILE_ACCESS_WRITE);
+   else
+      file = intfstream_open_file(save->path,
+            RETRO_VFS_FILE_ACCESS_WRITE, RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!file)
+      return false;
+
+   written = intfstream_write(file, save->buffer, save->bufsize);
+   intfstream_flush(file);
+   intfstream_close(file);
+   free(file);
+
+   if (written != (int64_t)save->bufsize)
+      return false;
+
+   sram_journal_delete(save->path);
+   return true;
+}
+
+/* Writes the dirty blocks to a journal next to the
+ * SRAM file, in a single write */
+static bool autosave_write_journal(const autosave_t *save,
+      const char *journal_path)
+{
+   size_t offset, len;
+   bool ret             = false;
+   size_t block         = 0;
+   size_t size          = SRAM_JOURNAL_HEADER_SIZE
+         + SRAM_JOURNAL_TRAILER_SIZE;
+   uint32_t num_records = 0;
+   const uint8_t *buf   = (const uint8_t*)save->buffer;
+   uint8_t *journal     = NULL;
+   uint8_t *ptr         = NULL;
+
+   while (autosave_next_dirty_run(save, &block, &offset, &len))
+   {
+      size += SRAM_JOURNAL_RECORD_SIZE + len;
+      num_records++;
+   }
+
+   if (!(journal = (uint8_t*)malloc(size)))
+      return false;
+
+   memcpy(journal, SRAM_JOURNAL_MAGIC, 4);
+   sram_journal_put_u32(journal + 4,  SRAM_JOURNAL_VERSION);
+   sram_journal_put_u32(journal + 8,  (uint32_t)save->bufsize);
+   sram_journal_put_u32(journal + 12, num_records);
+   ptr   = journal + SRAM_JOURNAL_HEADER_SIZE;
+
+   block = 0;
+   while (autosave_next_dirty_run(save, &block, &offset, &len))
+   {
+      sram_journal_put_u32(ptr,     (uint32_t)offset);
+      sram_journal_put_u32(ptr + 4, (uint32_t)len);
+      memcpy(ptr + SRAM_JOURNAL_RECORD_SIZE, buf + offset, len);
+      ptr += SRAM_JOURNAL_RECORD_SIZE + len;
+   }
+
+   sram_journal_put_u32(ptr,
+         encoding_crc32(0, journal, (size_t)(ptr - journal)));
+   memcpy(ptr + 4, SRAM_JOURNAL_END, 4);
+
+   ret = filestream_write_file(journal_path, journal, (int64_t)size);
+   free(journal);
+   return ret;
+}
+
+/* Writes only the dirty blocks, in place. With the
+ * journal enabled they are journalled first, and the
+ * journal is deleted once the file is complete */
+static bool autosave_write_blocks(autosave_t *save)
+{
+   size_t offset, len;
+   char journal_path[PATH_MAX_LENGTH];
+   bool ret           = true;
+   size_t block       = 0;
+   bool journal       = (save->flags & AUTOSAVE_FLAG_JOURNAL) != 0;
+   const uint8_t *buf = (const uint8_t*)save->buffer;
+   RFILE *file        = NULL;
+
+   if (journal)
+   {
+      sram_journal_get_path(journal_path, sizeof(journal_path),
+            save->path);
+      if (!autosave_write_journal(save, journal_path))
+         return false;
+   }
+
+   if (!(file = filestream_open(save->path,
+         RETRO_VFS_FILE_ACCESS_READ_WRITE
+         | RETRO_VFS_FILE_ACCESS_UPDATE_EXISTING,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+      return false;
+
+   while (ret && autosave_next_dirty_run(save, &block, &offset, &len))
+   {
+      if (     filestream_seek(file, (int64_t)offset,
+                  RETRO_VFS_SEEK_POSITION_START) < 0
+            || filestream_write(file, buf + offset, (int64_t)len)
+                  != (int64_t)len)
+         ret = false;
+   }
+
+   if (filestream_close(file) != 0)
+      ret = false;
+
+   /* On failure the journal stays, it still
+    * holds everything the file is missing */
+   if (ret && journal)
+      filestream_delete(journal_path);
+
+   return ret;
+}
+
 /**
  * autosave_thread:
  * @data            : pointer to autosave object
@@ -199,34 +438,37 @@ static void autosave_thread(void *data)
 
    for (;;)
    {
-      bool differ;
+      size_t num_dirty;
 
       slock_lock(save->lock);
-      differ = memcmp(save->buffer, save->retro_buffer,
-            save->bufsize) != 0;
-      if (differ)
-         memcpy(save->buffer, save->retro_buffer, save->bufsize);
+      num_dirty = autosave_update_blocks(save);
       slock_unlock(save->lock);
 
-      if (differ)
-      {
-         intfstream_t *file = NULL;
+      slock_lock(save->cond_lock);
+      if (save->full_write)
+         save->file_valid = false;
+      save->full_write    = false;
+      slock_unlock(save->cond_lock);
 
-         /* Should probably deal with this more elegantly. */
-         if (save->flags & AUTOSAVE_FLAG_COMPRESS_FILES)
-            file = intfstream_open_rzip_file(save->path,
-                  RETRO_VFS_FILE_ACCESS_WRITE);
-         else
-            file = intfstream_open_file(save->path,
-                  RETRO_VFS_FILE_ACCESS_WRITE, RETRO_VFS_FILE_ACCESS_HINT_NONE);
+      if (num_dirty)
+      {
+         bool written = false;
 
-         if (file)
+         /* Compressed files can't be patched in place,
+          * and the first save replaces whatever is on disk */
+         if (     (save->flags & AUTOSAVE_FLAG_COMPRESS_FILES)
+               || !save->file_valid)
          {
-            intfstream_write(file, save->buffer, save->bufsize);
-            intfstream_flush(file);
-            intfstream_close(file);
-            free(file);
+            written          = autosave_write_full(save);
+            save->file_valid = written
+               && !(save->flags & AUTOSAVE_FLAG_COMPRESS_FILES);
          }
+         else if (!(written = autosave_write_blocks(save)))
+            save->file_valid = false;
+
+         /* Otherwise the blocks stay dirty and are retried */
+         if (written)
+            memset(save->dirty, 0, save->num_blocks);
       }
 
       slock_lock(save->cond_lock);
@@ -264,7 +506,7 @@ static void autosave_thread(void *data)
  **/
 static autosave_t *autosave_new(const char *path,
       const void *data, size_t size,
-      unsigned interval, bool compress)
+      unsigned interval, bool compress, bool journal)
 {
    void       *buf               = NULL;
    autosave_t *handle            = (autosave_t*)malloc(sizeof(*handle));
@@ -273,11 +515,17 @@ static autosave_t *autosave_new(const char *path,
 
    handle->flags                 = 0;
    handle->bufsize               = size;
+   handle->num_blocks            = (size + AUTOSAVE_BLOCK_SIZE - 1)
+                                 / AUTOSAVE_BLOCK_SIZE;
    handle->interval              = interval;
    if (compress)
       handle->flags             |= AUTOSAVE_FLAG_COMPRESS_FILES;
+   if (journal)
+      handle->flags             |= AUTOSAVE_FLAG_JOURNAL;
    handle->retro_buffer          = data;
    handle->path                  = path;
+   handle->full_write            = false;
+   handle->file_valid            = false;
 
    if (!(buf = malloc(size)))
    {
@@ -285,6 +533,13 @@ static autosave_t *autosave_new(const char *path,
       return NULL;
    }
 
+   if (!(handle->dirty = (uint8_t*)calloc(handle->num_blocks, 1)))
+   {
+      free(buf);
+      free(handle);
+      return NULL;
+   }
+
    handle->buffer                = buf;
 
    memcpy(handle->buffer, handle->retro_buffer, handle->bufsize);
@@ -318,6 +573,9 @@ static void autosave_free(autosave_t *handle)
    if (handle->buffer)
       free(handle->buffer);
    handle->buffer = NULL;
+
+   free(handle->dirty);
+   handle->dirty  = NULL;
 }
 
 bool autosave_init(void)
@@ -326,6 +584,7 @@ bool autosave_init(void)
    autosave_t **list          = NULL;
    settings_t *settings       = config_get_ptr();
    unsigned autosave_interval = settings->uints.autosave_interval;
+   bool autosave_journal      = settings->bools.autosave_journal;
 #if defined(HAVE_ZLIB)
    bool compress_files        = settings->bools.save_file_compression;
 #else
@@ -361,7 +620,8 @@ bool autosave_init(void)
             mem_info.data,
             mem_info.size,
             autosave_interval,
-            compress_files)))
+            compress_files,
+            autosave_journal)))
       {
          RARCH_WARN("%s\n", msg_hash_to_str(MSG_AUTOSAVE_FAILED));
          continue;
@@ -427,6 +687,30 @@ void autosave_unlock(void)
          slock_unlock(handle->lock);
    }
 }
+
+/**
+ * autosave_invalidate:
+ * @slot            : index of the save file
+ *
+ * Makes the next autosave of @slot rewrite the whole
+ * file, after it was written by something else.
+ **/
+static void autosave_invalidate(unsigned slot)
+{
+   autosave_t *handle = NULL;
+
+   if (slot >= autosave_state.num)
+      return;
+
+   if (!(handle = autosave_state.list[slot]))
+      return;
+
+   /* Not 'lock', which the runloop holds
+    * while the core is running */
+   slock_lock(handle->cond_lock);
+   handle->full_write = true;
+   slock_unlock(handle->cond_lock);
+}
 #endif
 
 /**
@@ -861,6 +1145,7 @@ static bool task_push_undo_save_state(const char *path, void *data, size_t size)
       state->flags              |= SAVE_TASK_FLAG_COMPRESS_FILES;
 #endif
    task->type                    = TASK_TYPE_BLOCKING;
+   task->priority                = TASK_PRIORITY_SAVESTATE;
    task->state                   = state;
    task->handler                 = task_save_handler;
    task->callback                = undo_save_state_cb;
@@ -1361,6 +1646,7 @@ static void task_push_save_state(const char *path, void *data, size_t size, bool
 #endif
 
    task->type                    = TASK_TYPE_BLOCKING;
+   task->priority                = TASK_PRIORITY_SAVESTATE;
    task->state                   = state;
    task->handler                 = task_save_handler;
    task->callback                = save_state_cb;
@@ -1465,6 +1751,7 @@ static void task_push_load_and_save_state(const char *path, void *data,
 
    task->state                   = state;
    task->type                    = TASK_TYPE_BLOCKING;
+   task->priority                = TASK_PRIORITY_SAVESTATE;
    task->handler                 = task_load_handler;
    task->callback                = content_load_and_save_state_cb;
    task->title                   = strdup(msg_hash_to_str(MSG_LOADING_STATE));
@@ -1653,6 +1940,7 @@ bool content_load_state(const char *path,
 #endif
 
    task->type                   = TASK_TYPE_BLOCKING;
+   task->priority               = TASK_PRIORITY_SAVESTATE;
    task->state                  = state;
    task->handler                = task_load_handler;
    task->callback               = content_load_state_cb;
@@ -1745,6 +2033,137 @@ static bool content_get_memory(retro_ctx_memory_info_t *mem_info,
    return true;
 }
 
+/**
+ * sram_journal_is_valid:
+ * @journal          : journal data
+ * @len              : size of @journal
+ * @file_size        : size of the SRAM file
+ *
+ * Checks that the journal is complete and that all of
+ * its records fit in a file of @file_size bytes.
+ **/
+static bool sram_journal_is_valid(const uint8_t *journal, int64_t len,
+      int64_t file_size)
+{
+   uint32_t i, num_records;
+   const uint8_t *ptr = NULL;
+   const uint8_t *end = NULL;
+
+   if (     len < SRAM_JOURNAL_HEADER_SIZE + SRAM_JOURNAL_TRAILER_SIZE
+         || memcmp(journal, SRAM_JOURNAL_MAGIC, 4)
+         || sram_journal_get_u32(journal + 4) != SRAM_JOURNAL_VERSION
+         || sram_journal_get_u32(journal + 8) != (uint64_t)file_size)
+      return false;
+
+   /* A torn write leaves a bad trailer */
+   end = journal + len - SRAM_JOURNAL_TRAILER_SIZE;
+   if (     memcmp(end + 4, SRAM_JOURNAL_END, 4)
+         || sram_journal_get_u32(end) != encoding_crc32(0,
+               journal, (size_t)(end - journal)))
+      return false;
+
+   num_records = sram_journal_get_u32(journal + 12);
+   ptr         = journal + SRAM_JOURNAL_HEADER_SIZE;
+
+   for (i = 0; i < num_records; i++)
+   {
+      uint32_t offset, size;
+
+      if (end - ptr < SRAM_JOURNAL_RECORD_SIZE)
+         return false;
+
+      offset = sram_journal_get_u32(ptr);
+      size   = sram_journal_get_u32(ptr + 4);
+      ptr   += SRAM_JOURNAL_RECORD_SIZE;
+
+      if (     offset > file_size
+            || size   > file_size - offset
+            || (uint64_t)(end - ptr) < size)
+         return false;
+
+      ptr += size;
+   }
+
+   return ptr == end;
+}
+
+/**
+ * sram_journal_replay:
+ * @path             : path of the SRAM file
+ *
+ * Completes an autosave that was interrupted after
+ * its journal was written, then deletes the journal.
+ **/
+static void sram_journal_replay(const char *path)
+{
+   uint32_t i;
+   char journal_path[PATH_MAX_LENGTH];
+   int64_t len        = 0;
+   void *journal      = NULL;
+   const uint8_t *ptr = NULL;
+   RFILE *file        = NULL;
+   bool applied       = true;
+
+   sram_journal_get_path(journal_path, sizeof(journal_path), path);
+
+   if (!path_is_valid(journal_path))
+      return;
+
+   if (!filestream_read_file(journal_path, &journal, &len))
+      return;
+
+   if (!sram_journal_is_valid((const uint8_t*)journal, len,
+            path_get_size(path)))
+   {
+      RARCH_WARN("[SRAM]: Discarding incomplete autosave journal \"%s\".\n",
+            journal_path);
+      free(journal);
+      filestream_delete(journal_path);
+      return;
+   }
+
+   if (!(file = filestream_open(path,
+         RETRO_VFS_FILE_ACCESS_READ_WRITE
+         | RETRO_VFS_FILE_ACCESS_UPDATE_EXISTING,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+      applied = false;
+   else
+   {
+      ptr = (const uint8_t*)journal + SRAM_JOURNAL_HEADER_SIZE;
+
+      for (i = sram_journal_get_u32((const uint8_t*)journal + 12);
+            applied && i > 0; i--)
+      {
+         uint32_t offset = sram_journal_get_u32(ptr);
+         uint32_t size   = sram_journal_get_u32(ptr + 4);
+         ptr            += SRAM_JOURNAL_RECORD_SIZE;
+
+         if (     filestream_seek(file, offset,
+                     RETRO_VFS_SEEK_POSITION_START) < 0
+               || filestream_write(file, ptr, size) != (int64_t)size)
+            applied = false;
+
+         ptr += size;
+      }
+
+      if (filestream_close(file) != 0)
+         applied = false;
+   }
+
+   free(journal);
+
+   /* Otherwise keep it for the next attempt */
+   if (!applied)
+   {
+      RARCH_ERR("[SRAM]: Failed to apply autosave journal \"%s\".\n",
+            journal_path);
+      return;
+   }
+
+   RARCH_LOG("[SRAM]: Completed interrupted autosave of \"%s\".\n", path);
+   filestream_delete(journal_path);
+}
+
 /**
  * content_load_ram_file:
  * @path             : path of RAM state that will be loaded from.
@@ -1770,6 +2189,8 @@ bool content_load_ram_file(unsigned slot)
        || !path_is_valid(ram.path))
       return false;
 
+   sram_journal_replay(ram.path);
+
 #if defined(HAVE_ZLIB)
    /* Always use RZIP interface when reading SRAM
     * files - this will automatically handle uncompressed
@@ -2057,6 +2478,12 @@ bool content_save_ram_file(unsigned slot, bool compress)
          msg_hash_to_str(MSG_SAVED_SUCCESSFULLY_TO),
          ram.path);
 
+   sram_journal_delete(ram.path);
+
+#ifdef HAVE_THREADS
+   autosave_invalidate(slot);
+#endif
+
    return true;
 
 fail:
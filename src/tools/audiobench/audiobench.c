@@ -0,0 +1,285 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Runs the audio flush pipeline (s16 to float with volume,
+ * resampling, float to s16) over synthetic input, once the way
+ * audio_driver_flush() used to do it - one full pass per stage -
+ * and once in blocks of AUDIO_FLUSH_BLOCK_FRAMES, checks that
+ * both produce the same samples and reports ns per input frame. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <features/features_cpu.h>
+#include <memalign.h>
+#include <audio/audio_resampler.h>
+#include <audio/conversion/s16_to_float.h>
+#include <audio/conversion/float_to_s16.h>
+
+#include "audio/audio_defines.h"
+
+extern retro_resampler_t sinc_resampler;
+extern retro_resampler_t nearest_resampler;
+extern retro_resampler_t polyphase_resampler;
+
+struct bench_config
+{
+   const char *name;
+   retro_resampler_t *backend;
+   enum resampler_quality quality;
+   double ratio;
+   bool use_float;
+   /* Largest change made to the ratio on each flush,
+    * the way dynamic rate control does */
+   double drc;
+};
+
+struct bench_buffers
+{
+   int16_t *in;
+   float *input_data;
+   float *output;
+   int16_t *output_s16;
+   size_t out_max;
+};
+
+/* Mirrors the old audio_driver_flush(). */
+static size_t flush_passes(struct bench_buffers *b,
+      const retro_resampler_t *backend, void *re,
+      const int16_t *data, size_t samples, double ratio, bool use_float)
+{
+   struct resampler_data src_data;
+
+   convert_s16_to_float(b->input_data, data, samples, 0.8f);
+
+   src_data.data_in       = b->input_data;
+   src_data.input_frames  = samples >> 1;
+   src_data.data_out      = b->output;
+   src_data.output_frames = 0;
+   src_data.ratio         = ratio;
+
+   backend->process(re, &src_data);
+
+   if (!use_float)
+      convert_float_to_s16(b->output_s16, b->output,
+            src_data.output_frames * 2);
+
+   return src_data.output_frames;
+}
+
+/* Mirrors the blocked audio_driver_flush(). */
+static size_t flush_blocked(struct bench_buffers *b,
+      const retro_resampler_t *backend, void *re,
+      const int16_t *data, size_t samples, double ratio, bool use_float)
+{
+   struct resampler_data src_data;
+   size_t frames        = samples >> 1;
+   size_t output_frames = 0;
+
+   src_data.ratio       = ratio;
+
+   while (frames)
+   {
+      size_t block     = (frames > AUDIO_FLUSH_BLOCK_FRAMES)
+         ? AUDIO_FLUSH_BLOCK_FRAMES
+         : frames;
+      float *block_out = b->output + (output_frames << 1);
+
+      convert_s16_to_float(b->input_data, data, block << 1, 0.8f);
+
+      src_data.data_in       = b->input_data;
+      src_data.input_frames  = block;
+      src_data.data_out      = block_out;
+      src_data.output_frames = 0;
+
+      backend->process(re, &src_data);
+
+      if (!use_float)
+         convert_float_to_s16(b->output_s16 + (output_frames << 1),
+               block_out, src_data.output_frames << 1);
+
+      output_frames += src_data.output_frames;
+      data          += block << 1;
+      frames        -= block;
+   }
+
+   return output_frames;
+}
+
+typedef size_t (*flush_fn_t)(struct bench_buffers *b,
+      const retro_resampler_t *backend, void *re,
+      const int16_t *data, size_t samples, double ratio, bool use_float);
+
+/* Runs 'chunks' flushes of 'samples' each, keeping the output of
+ * the first 'keep_frames' frames in 'keep' for comparison. */
+static double run(struct bench_buffers *b, const struct bench_config *c,
+      flush_fn_t fn, size_t samples, unsigned chunks,
+      float *keep, size_t keep_frames)
+{
+   unsigned i;
+   retro_time_t t0, total = 0;
+   size_t kept            = 0;
+   const retro_resampler_t *backend = c->backend;
+   void *re               = backend->init(NULL, c->ratio, c->quality,
+         (resampler_simd_mask_t)cpu_features_get());
+
+   if (!re)
+      return -1.0;
+
+   for (i = 0; i < chunks; i++)
+   {
+      size_t k, out_frames;
+      const int16_t *data = b->in + (size_t)(i & 63) * samples;
+      double ratio        = c->ratio * (1.0 + c->drc * sin(i * 0.05));
+
+      t0          = cpu_features_get_time_usec();
+      out_frames  = fn(b, backend, re, data, samples, ratio, c->use_float);
+      total      += cpu_features_get_time_usec() - t0;
+
+      for (k = 0; k < out_frames * 2 && kept < keep_frames * 2; k++)
+         keep[kept++] = c->use_float
+            ? b->output[k] : (float)b->output_s16[k];
+   }
+
+   backend->free(re);
+   return total * 1000.0 / ((double)chunks * (samples >> 1));
+}
+
+static void usage(const char *argv0)
+{
+   fprintf(stderr,
+         "Usage: %s [-n flushes] [-s samples]\n"
+         "\n"
+         "Each flush pushes 'samples' interleaved stereo samples\n"
+         "(default %d, the non-blocking chunk size).\n",
+         argv0, AUDIO_CHUNK_SIZE_NONBLOCKING);
+}
+
+int main(int argc, char *argv[])
+{
+   int i;
+   unsigned k;
+   struct bench_buffers b;
+   float *keep_passes    = NULL;
+   float *keep_blocked   = NULL;
+   unsigned chunks       = 20000;
+   size_t samples        = AUDIO_CHUNK_SIZE_NONBLOCKING;
+   size_t keep_frames    = 1 << 15;
+   int ret               = 1;
+   const struct bench_config configs[] = {
+      { "sinc normal  s16",   &sinc_resampler,    RESAMPLER_QUALITY_NORMAL, 48000.0 / 32040.0, false },
+      { "sinc normal  float", &sinc_resampler,    RESAMPLER_QUALITY_NORMAL, 48000.0 / 32040.0, true  },
+      { "sinc lower   s16",   &sinc_resampler,    RESAMPLER_QUALITY_LOWER,  48000.0 / 32040.0, false },
+      { "sinc normal  1:1",   &sinc_resampler,    RESAMPLER_QUALITY_NORMAL, 1.0,               false },
+      { "poly normal  s16",   &polyphase_resampler, RESAMPLER_QUALITY_NORMAL,  48000.0 / 32040.0, false },
+      { "poly higher  s16",   &polyphase_resampler, RESAMPLER_QUALITY_HIGHER,  48000.0 / 32040.0, false },
+      { "poly highest s16",   &polyphase_resampler, RESAMPLER_QUALITY_HIGHEST, 48000.0 / 44100.0, false },
+      { "sinc normal  drc",   &sinc_resampler,    RESAMPLER_QUALITY_NORMAL, 48000.0 / 32040.0, false, 0.005 },
+      { "poly normal  drc",   &polyphase_resampler, RESAMPLER_QUALITY_NORMAL,  48000.0 / 32040.0, false, 0.005 },
+      { "sinc higher  drc",   &sinc_resampler,    RESAMPLER_QUALITY_HIGHER, 48000.0 / 44100.0, false, 0.005 },
+      { "poly higher  drc",   &polyphase_resampler, RESAMPLER_QUALITY_HIGHER,  48000.0 / 44100.0, false, 0.005 },
+      { "nearest      s16",   &nearest_resampler, RESAMPLER_QUALITY_LOWEST, 48000.0 / 32040.0, false },
+      { "nearest      1:1",   &nearest_resampler, RESAMPLER_QUALITY_LOWEST, 1.0,               false },
+   };
+
+   memset(&b, 0, sizeof(b));
+
+   for (i = 1; i < argc; i++)
+   {
+      if (!strcmp(argv[i], "-n") && i + 1 < argc)
+         chunks  = (unsigned)strtoul(argv[++i], NULL, 0);
+      else if (!strcmp(argv[i], "-s") && i + 1 < argc)
+         samples = (size_t)strtoul(argv[++i], NULL, 0) & ~(size_t)1;
+      else
+      {
+         usage(argv[0]);
+         return 1;
+      }
+   }
+
+   if (!chunks || !samples || samples > AUDIO_CHUNK_SIZE_NONBLOCKING * 8)
+   {
+      usage(argv[0]);
+      return 1;
+   }
+
+   convert_s16_to_float_init_simd();
+   convert_float_to_s16_init_simd();
+
+   b.out_max      = samples * AUDIO_MAX_RATIO;
+   b.in           = (int16_t*)malloc(samples * 64 * sizeof(int16_t));
+   b.input_data   = (float*)memalign_alloc(64, samples * sizeof(float));
+   b.output       = (float*)memalign_alloc(64, b.out_max * sizeof(float));
+   b.output_s16   = (int16_t*)memalign_alloc(64, b.out_max * sizeof(int16_t));
+   keep_passes    = (float*)calloc(keep_frames * 2, sizeof(float));
+   keep_blocked   = (float*)calloc(keep_frames * 2, sizeof(float));
+
+   if (!b.in || !b.input_data || !b.output || !b.output_s16
+         || !keep_passes || !keep_blocked)
+      goto end;
+
+   /* Two detuned tones, so the resampler has something to chew on. */
+   for (k = 0; k < samples * 32; k++)
+   {
+      b.in[2 * k + 0] = (int16_t)(12000.0 * sin(k * 0.0371));
+      b.in[2 * k + 1] = (int16_t)(12000.0 * sin(k * 0.0517 + 1.0));
+   }
+
+   printf("%u flushes of %u samples, block size %u frames\n",
+         chunks, (unsigned)samples, (unsigned)AUDIO_FLUSH_BLOCK_FRAMES);
+
+   ret = 0;
+
+   for (k = 0; k < sizeof(configs) / sizeof(configs[0]); k++)
+   {
+      double ns_passes, ns_blocked;
+
+      memset(keep_passes,  0, keep_frames * 2 * sizeof(float));
+      memset(keep_blocked, 0, keep_frames * 2 * sizeof(float));
+
+      ns_passes  = run(&b, &configs[k], flush_passes,  samples, chunks,
+            keep_passes, keep_frames);
+      ns_blocked = run(&b, &configs[k], flush_blocked, samples, chunks,
+            keep_blocked, keep_frames);
+
+      if (ns_passes < 0.0 || ns_blocked < 0.0)
+      {
+         fprintf(stderr, "%s: failed to create resampler.\n", configs[k].name);
+         ret = 1;
+         continue;
+      }
+
+      printf("%-20s passes: %7.2f ns/frame  blocked: %7.2f ns/frame  %s\n",
+            configs[k].name, ns_passes, ns_blocked,
+            memcmp(keep_passes, keep_blocked,
+               keep_frames * 2 * sizeof(float)) ? "MISMATCH" : "ok");
+
+      if (memcmp(keep_passes, keep_blocked, keep_frames * 2 * sizeof(float)))
+         ret = 1;
+   }
+
+end:
+   free(b.in);
+   memalign_free(b.input_data);
+   memalign_free(b.output);
+   memalign_free(b.output_s16);
+   free(keep_passes);
+   free(keep_blocked);
+
+   return ret;
+}
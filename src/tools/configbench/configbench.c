@@ -0,0 +1,393 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Generates a main config plus core, content directory
+ * and game overrides, a remap file and a core options
+ * file, then times loading them the way a content load
+ * does, checking every value along the way. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#include <retro_miscellaneous.h>
+#include <features/features_cpu.h>
+#include <file/config_file.h>
+#include <file/file_path.h>
+#include <streams/file_stream.h>
+#include <string/stdstring.h>
+
+#define BENCH_DIR      "configbench_files"
+#define BENCH_MAIN     BENCH_DIR "/retroarch.cfg"
+#define BENCH_INCLUDE  BENCH_DIR "/included.cfg"
+#define BENCH_CORE     BENCH_DIR "/core.cfg"
+#define BENCH_DIR_OVR  BENCH_DIR "/content_dir.cfg"
+#define BENCH_GAME     BENCH_DIR "/game.cfg"
+#define BENCH_REMAP    BENCH_DIR "/game.rmp"
+#define BENCH_OPTIONS  BENCH_DIR "/core.opt"
+
+#define MAIN_KEYS      1200
+#define INCLUDE_KEYS   100
+#define REMAP_KEYS     256
+#define OPTION_KEYS    150
+
+#ifdef __GLIBC__
+/* Count every allocation made while loading,
+ * including those made by strdup() */
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+static unsigned long alloc_count = 0;
+
+void *malloc(size_t size)
+{
+   alloc_count++;
+   return __libc_malloc(size);
+}
+
+void *calloc(size_t nmemb, size_t size)
+{
+   alloc_count++;
+   return __libc_calloc(nmemb, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+   alloc_count++;
+   return __libc_realloc(ptr, size);
+}
+
+static size_t heap_in_use(void)
+{
+   struct mallinfo2 mi = mallinfo2();
+   return mi.uordblks + mi.hblkhd;
+}
+#else
+static unsigned long alloc_count = 0;
+
+static size_t heap_in_use(void)
+{
+   return 0;
+}
+#endif
+
+static const char *prefixes[] = {
+   "video_", "audio_", "input_", "menu_", "network_",
+   "content_", "savestate_", "rewind_", "cheevos_", "netplay_"
+};
+
+static double elapsed_sec(retro_time_t t0)
+{
+   return (cpu_features_get_time_usec() - t0) / 1000000.0;
+}
+
+static void make_key(char *s, size_t len, unsigned i)
+{
+   snprintf(s, len, "%ssetting_number_%u",
+         prefixes[i % ARRAY_SIZE(prefixes)], i);
+}
+
+/* Every override replaces a different slice of the main
+ * config, and the game override wins over the others */
+static const char *expected_source(unsigned i)
+{
+   if (i % 61 == 0)
+      return "game";
+   if (i % 37 == 0)
+      return "dir";
+   if (i % 23 == 0)
+      return "core";
+   return "main";
+}
+
+static bool write_buffer(const char *path, char **s, size_t *len)
+{
+   bool ret = filestream_write_file(path, *s, *len);
+   free(*s);
+   *s   = NULL;
+   *len = 0;
+   return ret;
+}
+
+static void append_line(char **s, size_t *len, const char *line)
+{
+   size_t line_len = strlen(line);
+   *s    = (char*)realloc(*s, *len + line_len + 1);
+   memcpy(*s + *len, line, line_len + 1);
+   *len += line_len;
+}
+
+static void append(char **s, size_t *len, const char *key, const char *val)
+{
+   char line[320];
+   snprintf(line, sizeof(line), "%s = \"%s\"\n", key, val);
+   append_line(s, len, line);
+}
+
+static bool generate_files(void)
+{
+   unsigned i;
+   char key[128];
+   char val[128];
+   char *s    = NULL;
+   size_t len = 0;
+
+   path_mkdir(BENCH_DIR);
+
+   for (i = 0; i < MAIN_KEYS; i++)
+   {
+      make_key(key, sizeof(key), i);
+      snprintf(val, sizeof(val), "main %u", i);
+      append(&s, &len, key, val);
+   }
+   append_line(&s, &len, "#include \"included.cfg\"\n");
+   if (!write_buffer(BENCH_MAIN, &s, &len))
+      return false;
+
+   for (i = 0; i < INCLUDE_KEYS; i++)
+   {
+      snprintf(key, sizeof(key), "included_setting_%u", i);
+      snprintf(val, sizeof(val), "included %u", i);
+      append(&s, &len, key, val);
+   }
+   if (!write_buffer(BENCH_INCLUDE, &s, &len))
+      return false;
+
+   for (i = 0; i < MAIN_KEYS; i++)
+   {
+      if (i % 23 == 0)
+      {
+         make_key(key, sizeof(key), i);
+         snprintf(val, sizeof(val), "core %u", i);
+         append(&s, &len, key, val);
+      }
+   }
+   if (!write_buffer(BENCH_CORE, &s, &len))
+      return false;
+
+   for (i = 0; i < MAIN_KEYS; i++)
+   {
+      if (i % 37 == 0)
+      {
+         make_key(key, sizeof(key), i);
+         snprintf(val, sizeof(val), "dir %u", i);
+         append(&s, &len, key, val);
+      }
+   }
+   if (!write_buffer(BENCH_DIR_OVR, &s, &len))
+      return false;
+
+   for (i = 0; i < MAIN_KEYS; i++)
+   {
+      if (i % 61 == 0)
+      {
+         make_key(key, sizeof(key), i);
+         snprintf(val, sizeof(val), "game %u", i);
+         append(&s, &len, key, val);
+      }
+   }
+   if (!write_buffer(BENCH_GAME, &s, &len))
+      return false;
+
+   for (i = 0; i < REMAP_KEYS; i++)
+   {
+      snprintf(key, sizeof(key), "input_player%u_btn_%u",
+            i / 16 + 1, i % 16);
+      snprintf(val, sizeof(val), "%u", i % 16);
+      append(&s, &len, key, val);
+   }
+   if (!write_buffer(BENCH_REMAP, &s, &len))
+      return false;
+
+   for (i = 0; i < OPTION_KEYS; i++)
+   {
+      snprintf(key, sizeof(key), "benchcore_option_%u", i);
+      snprintf(val, sizeof(val), "value %u", i);
+      append(&s, &len, key, val);
+   }
+   return write_buffer(BENCH_OPTIONS, &s, &len);
+}
+
+static void remove_files(void)
+{
+   filestream_delete(BENCH_MAIN);
+   filestream_delete(BENCH_INCLUDE);
+   filestream_delete(BENCH_CORE);
+   filestream_delete(BENCH_DIR_OVR);
+   filestream_delete(BENCH_GAME);
+   filestream_delete(BENCH_REMAP);
+   filestream_delete(BENCH_OPTIONS);
+   filestream_delete(BENCH_DIR);
+}
+
+/* Reads back every key, checking the values if asked to */
+static unsigned read_config(config_file_t *conf, bool check)
+{
+   unsigned i;
+   char key[128];
+   char val[128];
+   char expected[128];
+   unsigned errors = 0;
+
+   for (i = 0; i < MAIN_KEYS; i++)
+   {
+      make_key(key, sizeof(key), i);
+      if (!config_get_array(conf, key, val, sizeof(val)))
+         errors++;
+      else if (check)
+      {
+         snprintf(expected, sizeof(expected), "%s %u",
+               expected_source(i), i);
+         if (!string_is_equal(val, expected))
+            errors++;
+      }
+   }
+
+   for (i = 0; i < INCLUDE_KEYS; i++)
+   {
+      snprintf(key, sizeof(key), "included_setting_%u", i);
+      if (!config_get_array(conf, key, val, sizeof(val)))
+         errors++;
+   }
+
+   if (config_get_entry(conf, "missing_setting"))
+      errors++;
+
+   return errors;
+}
+
+/* The main config with the override stack appended,
+ * followed by the remap and the core options */
+static unsigned load_stack(bool check)
+{
+   unsigned i;
+   unsigned errors     = 0;
+   config_file_t *conf = config_file_new(BENCH_MAIN);
+
+   if (!conf)
+      return 1;
+
+   if (     !config_append_file(conf, BENCH_CORE)
+         || !config_append_file(conf, BENCH_DIR_OVR)
+         || !config_append_file(conf, BENCH_GAME))
+      errors++;
+
+   errors += read_config(conf, check);
+   config_file_free(conf);
+
+   if (!(conf = config_file_new_from_path_to_string(BENCH_REMAP)))
+      return errors + 1;
+
+   for (i = 0; i < REMAP_KEYS; i++)
+   {
+      char key[128];
+      unsigned val = 0;
+      snprintf(key, sizeof(key), "input_player%u_btn_%u",
+            i / 16 + 1, i % 16);
+      if (!config_get_uint(conf, key, &val) || (check && val != i % 16))
+         errors++;
+   }
+   config_file_free(conf);
+
+   if (!(conf = config_file_new_from_path_to_string(BENCH_OPTIONS)))
+      return errors + 1;
+
+   for (i = 0; i < OPTION_KEYS; i++)
+   {
+      char key[128];
+      char val[128];
+      snprintf(key, sizeof(key), "benchcore_option_%u", i);
+      if (!config_get_array(conf, key, val, sizeof(val)))
+         errors++;
+   }
+   config_file_free(conf);
+
+   return errors;
+}
+
+int main(int argc, char *argv[])
+{
+   unsigned i;
+   retro_time_t t0;
+   double t;
+   size_t heap;
+   unsigned long allocs;
+   unsigned runs       = 200;
+   unsigned errors     = 0;
+   config_file_t *conf = NULL;
+
+   if (argc > 1)
+      runs = (unsigned)strtoul(argv[1], NULL, 0);
+
+   if (!runs)
+   {
+      fprintf(stderr, "Usage: %s [runs]\n", argv[0]);
+      return 1;
+   }
+
+   if (!generate_files())
+   {
+      fprintf(stderr, "Failed to create " BENCH_DIR "\n");
+      remove_files();
+      return 1;
+   }
+
+   errors += load_stack(true);
+
+   /* The main config with its overrides, as it is
+    * held while the settings are applied */
+   heap   = heap_in_use();
+   allocs = alloc_count;
+   if ((conf = config_file_new(BENCH_MAIN)))
+   {
+      config_append_file(conf, BENCH_CORE);
+      config_append_file(conf, BENCH_DIR_OVR);
+      config_append_file(conf, BENCH_GAME);
+      heap   = heap_in_use() - heap;
+      allocs = alloc_count - allocs;
+      config_file_free(conf);
+   }
+   else
+      errors++;
+
+   printf("config + overrides: %lu allocations, %.1f KiB heap\n",
+         allocs, heap / 1024.0);
+
+   allocs = alloc_count;
+   t0     = cpu_features_get_time_usec();
+   for (i = 0; i < runs; i++)
+      errors += load_stack(false);
+   t      = elapsed_sec(t0) / runs;
+   allocs = (alloc_count - allocs) / runs;
+
+   printf("full stack:         %9.3f ms  %lu allocations per load\n",
+         t * 1000.0, allocs);
+
+   remove_files();
+
+   if (errors)
+   {
+      fprintf(stderr, "%u wrong results\n", errors);
+      return 1;
+   }
+
+   return 0;
+}
@@ -0,0 +1,565 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Runs a netplay host and client in one process, connected over
+ * TCP loopback, and times the resyncs after the client desyncs:
+ * once with full zlib compressed savestates, once with savestate
+ * deltas. Checks that the client ends up with the host's state.
+ *
+ * The requests and deltas are built, parsed and gated with the
+ * same netplay_delta functions netplay_frontend.c uses. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#include <features/features_cpu.h>
+#include <rthreads/rthreads.h>
+#include <streams/trans_stream.h>
+
+#include "network/netplay/netplay_private.h"
+
+/* How many frames the host is ahead of the frame the client
+ * found to be wrong by the time it answers */
+#define LATENCY 4
+
+struct bench_peer
+{
+   const struct trans_stream_backend *backend;
+   void *stream;
+   uint8_t *zbuffer;
+   uint8_t *delta_buffer;
+   uint32_t *request;
+   size_t zbuffer_size;
+   size_t bytes;
+   int fd;
+};
+
+struct bench_client
+{
+   struct bench_peer peer;
+   netplay_delta_base_t base;
+   /* Did the host advertise NETPLAY_COMPRESSION_DELTA? */
+   bool delta_state;
+};
+
+struct bench_host
+{
+   struct bench_peer peer;
+   /* The host's states, from the frame the client got wrong
+    * to the one it is on now */
+   uint8_t *states[LATENCY + 1];
+   uint32_t first_frame;
+   size_t state_size;
+   bool failed;
+};
+
+static unsigned long rand_state = 1;
+
+static uint32_t bench_rand(void)
+{
+   rand_state = rand_state * 1103515245 + 12345;
+   return (uint32_t)(rand_state >> 16);
+}
+
+static double elapsed_sec(retro_time_t t0)
+{
+   return (cpu_features_get_time_usec() - t0) / 1000000.0;
+}
+
+static bool send_all(struct bench_peer *peer, const void *buf, size_t len)
+{
+   const uint8_t *p = (const uint8_t*)buf;
+
+   peer->bytes += len;
+   while (len)
+   {
+      ssize_t sent = send(peer->fd, p, len, 0);
+      if (sent <= 0)
+         return false;
+      p   += sent;
+      len -= sent;
+   }
+   return true;
+}
+
+static bool recv_all(struct bench_peer *peer, void *buf, size_t len)
+{
+   uint8_t *p = (uint8_t*)buf;
+
+   while (len)
+   {
+      ssize_t recvd = recv(peer->fd, p, len, 0);
+      if (recvd <= 0)
+         return false;
+      p   += recvd;
+      len -= recvd;
+   }
+   return true;
+}
+
+static bool init_peer(struct bench_peer *peer, size_t state_size,
+      bool deflate)
+{
+   peer->backend      = trans_stream_get_zlib_deflate_backend();
+   if (!deflate)
+      peer->backend   = peer->backend->reverse;
+   peer->stream       = peer->backend->stream_new();
+   peer->zbuffer_size = state_size * 2;
+   peer->zbuffer      = (uint8_t*)malloc(peer->zbuffer_size);
+   peer->delta_buffer = (uint8_t*)malloc(
+         netplay_delta_max_size(state_size));
+   peer->request      = (uint32_t*)malloc(
+         netplay_delta_request_size(state_size));
+   peer->bytes        = 0;
+
+   return peer->stream && peer->zbuffer && peer->delta_buffer
+      && peer->request;
+}
+
+static void deinit_peer(struct bench_peer *peer)
+{
+   if (peer->stream)
+      peer->backend->stream_free(peer->stream);
+   free(peer->zbuffer);
+   free(peer->delta_buffer);
+   free(peer->request);
+}
+
+static bool transcode(struct bench_peer *peer, const uint8_t *in,
+      size_t in_size, uint8_t *out, size_t out_size, uint32_t *wn)
+{
+   uint32_t rd;
+   peer->backend->set_in(peer->stream, in, (uint32_t)in_size);
+   peer->backend->set_out(peer->stream, out, (uint32_t)out_size);
+   return peer->backend->trans(peer->stream, true, &rd, wn, NULL);
+}
+
+/* Answers savestate requests the way netplay_get_cmd() and
+ * netplay_send_savestate() do, until the client disconnects */
+static void host_thread(void *data)
+{
+   struct bench_host *host = (struct bench_host*)data;
+   struct bench_peer *peer = &host->peer;
+   const uint8_t *state    = host->states[LATENCY];
+   uint32_t compression    = htonl(NETPLAY_COMPRESSION_SUPPORTED);
+
+   /* The compression field of the handshake header */
+   if (!send_all(peer, &compression, sizeof(compression)))
+   {
+      host->failed = true;
+      return;
+   }
+
+   for (;;)
+   {
+      uint32_t cmd[2];
+      uint32_t header[5];
+      uint32_t wn;
+
+      if (!recv_all(peer, cmd, sizeof(cmd)))
+         break;
+      if (ntohl(cmd[0]) == NETPLAY_CMD_DISCONNECT)
+         return;
+      if (ntohl(cmd[0]) != NETPLAY_CMD_REQUEST_SAVESTATE)
+         break;
+
+      if (ntohl(cmd[1]) == 0)
+      {
+         if (!transcode(peer, state, host->state_size,
+                  peer->zbuffer, peer->zbuffer_size, &wn))
+            break;
+
+         header[0] = htonl(NETPLAY_CMD_LOAD_SAVESTATE);
+         header[1] = htonl(wn + 2 * sizeof(uint32_t));
+         header[2] = htonl(host->first_frame + LATENCY);
+         header[3] = htonl((uint32_t)host->state_size);
+         if (     !send_all(peer, header, 4 * sizeof(uint32_t))
+               || !send_all(peer, peer->zbuffer, wn))
+            break;
+      }
+      else
+      {
+         uint32_t frame;
+         size_t delta_size;
+         const uint32_t *hashes;
+         const uint8_t *base = NULL;
+
+         if (ntohl(cmd[1]) != netplay_delta_request_size(host->state_size))
+            break;
+         if (!recv_all(peer, peer->request, ntohl(cmd[1])))
+            break;
+
+         hashes = netplay_delta_read_request(peer->request,
+               host->state_size, &frame);
+         if (     frame >= host->first_frame
+               && frame <= host->first_frame + LATENCY)
+            base = host->states[frame - host->first_frame];
+
+         delta_size = netplay_delta_encode(state, base, hashes,
+               host->state_size, peer->delta_buffer);
+         if (!transcode(peer, peer->delta_buffer, delta_size,
+                  peer->zbuffer, peer->zbuffer_size, &wn))
+            break;
+
+         header[0] = htonl(NETPLAY_CMD_LOAD_SAVESTATE_DELTA);
+         header[1] = htonl(wn + 3 * sizeof(uint32_t));
+         header[2] = htonl(host->first_frame + LATENCY);
+         header[3] = htonl((uint32_t)host->state_size);
+         header[4] = htonl(frame);
+         if (     !send_all(peer, header, sizeof(header))
+               || !send_all(peer, peer->zbuffer, wn))
+            break;
+      }
+   }
+
+   host->failed = true;
+}
+
+/* As netplay_handshake_init() */
+static void client_handshake(struct bench_client *client,
+      uint32_t compression)
+{
+   client->delta_state = !!(compression & NETPLAY_COMPRESSION_DELTA);
+}
+
+/* Requests a savestate the way netplay_cmd_request_savestate()
+ * does, with the block hashes of the client's (wrong) state if
+ * 'delta' is set, and loads the answer */
+static bool client_resync(struct bench_client *client, uint8_t *state,
+      const uint8_t *wrong, uint32_t frame, size_t state_size,
+      bool delta)
+{
+   uint32_t cmd[2];
+   uint32_t header[5];
+   uint32_t size, wn;
+   struct bench_peer *peer = &client->peer;
+   size_t header_size      = 4 * sizeof(uint32_t);
+   size_t request_size     = 0;
+
+   if (delta && client->delta_state)
+   {
+      if (!netplay_delta_write_request(&client->base, wrong, state_size,
+               frame, peer->request))
+         return false;
+      request_size = netplay_delta_request_size(state_size);
+      header_size += sizeof(uint32_t);
+   }
+
+   cmd[0] = htonl(NETPLAY_CMD_REQUEST_SAVESTATE);
+   cmd[1] = htonl((uint32_t)request_size);
+
+   if (!send_all(peer, cmd, sizeof(cmd)))
+      return false;
+   if (request_size && !send_all(peer, peer->request, request_size))
+      return false;
+
+   if (!recv_all(peer, header, header_size))
+      return false;
+   if (ntohl(header[0]) != (request_size
+            ? NETPLAY_CMD_LOAD_SAVESTATE_DELTA : NETPLAY_CMD_LOAD_SAVESTATE))
+      return false;
+   if (ntohl(header[3]) != state_size)
+      return false;
+
+   size = ntohl(header[1]) - (uint32_t)(header_size - 2 * sizeof(uint32_t));
+   if (size > peer->zbuffer_size || !recv_all(peer, peer->zbuffer, size))
+      return false;
+
+   if (!request_size)
+      return transcode(peer, peer->zbuffer, size, state, state_size, &wn)
+         && wn == state_size;
+
+   return netplay_delta_base_matches(&client->base, ntohl(header[4]))
+      && transcode(peer, peer->zbuffer, size, peer->delta_buffer,
+            netplay_delta_max_size(state_size), &wn)
+      && netplay_delta_apply(&client->base, state, state_size,
+            peer->delta_buffer, wn);
+}
+
+/* The client side rules of a resync that don't need a host */
+static unsigned check_client(struct bench_client *client,
+      const uint8_t *wrong, size_t state_size)
+{
+   uint8_t header[4];
+   unsigned errors = 0;
+
+   /* Older hosts don't advertise deltas */
+   client_handshake(client, NETPLAY_COMPRESSION_ZLIB);
+   if (client->delta_state)
+   {
+      fprintf(stderr, "delta resync with an older host\n");
+      errors++;
+   }
+   client_handshake(client, NETPLAY_COMPRESSION_SUPPORTED);
+   if (!client->delta_state)
+   {
+      fprintf(stderr, "no delta resync with a current host\n");
+      errors++;
+   }
+
+   /* One request with hashes at a time, and only a delta
+    * against that frame answers it */
+   if (!netplay_delta_write_request(&client->base, wrong, state_size,
+            7, client->peer.request))
+      errors++;
+   if (netplay_delta_write_request(&client->base, wrong, state_size,
+            8, client->peer.request))
+   {
+      fprintf(stderr, "second request with hashes while one is outstanding\n");
+      errors++;
+   }
+   if (     netplay_delta_base_matches(&client->base, 8)
+         || !netplay_delta_base_matches(&client->base, 7))
+   {
+      fprintf(stderr, "delta accepted for a frame that wasn't requested\n");
+      errors++;
+   }
+
+   /* A block header with no block is malformed, and completes
+    * the request anyway */
+   memset(header, 0, sizeof(header));
+   if (netplay_delta_apply(&client->base, client->peer.delta_buffer,
+            state_size, header, sizeof(header)))
+   {
+      fprintf(stderr, "truncated delta accepted\n");
+      errors++;
+   }
+   if (netplay_delta_base_matches(&client->base, 7))
+   {
+      fprintf(stderr, "request still outstanding after its delta\n");
+      errors++;
+   }
+
+   return errors;
+}
+
+/* Something shaped like a core's state: some of it is
+ * zeroes, the rest small values */
+static void fill_state(uint8_t *state, size_t state_size)
+{
+   size_t i;
+   for (i = 0; i < state_size; i++)
+      state[i] = ((i / NETPLAY_DELTA_BLOCK_SIZE) & 1)
+         ? 0 : (uint8_t)(bench_rand() & 0x3f);
+}
+
+/* Runs a frame: scattered writes to the first half (work RAM)
+ * and a redrawn framebuffer at the end */
+static void run_frame(uint8_t *state, size_t state_size)
+{
+   size_t i, j;
+   size_t ram = state_size / 2;
+   size_t fb  = state_size / 64;
+
+   for (i = 0; i < 64; i++)
+   {
+      size_t offset = bench_rand() % (ram - 256);
+      for (j = 0; j < 256; j++)
+         state[offset + j] = (uint8_t)bench_rand();
+   }
+
+   for (i = state_size - fb; i < state_size; i++)
+      state[i] = (uint8_t)(state[i] + 1);
+}
+
+/* A nondeterministic core gets a few things wrong */
+static void desync(uint8_t *state, size_t state_size)
+{
+   size_t i;
+   for (i = 0; i < 4; i++)
+      state[bench_rand() % state_size] ^= 0x55;
+}
+
+static bool connect_loopback(int *client_fd, int *host_fd)
+{
+   struct sockaddr_in addr;
+   socklen_t addr_len = sizeof(addr);
+   int one            = 1;
+   int listen_fd      = socket(AF_INET, SOCK_STREAM, 0);
+
+   *client_fd = -1;
+   *host_fd   = -1;
+
+   if (listen_fd < 0)
+      return false;
+
+   memset(&addr, 0, sizeof(addr));
+   addr.sin_family      = AF_INET;
+   addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+   addr.sin_port        = 0;
+
+   if (     bind(listen_fd, (struct sockaddr*)&addr, sizeof(addr)) < 0
+         || listen(listen_fd, 1) < 0
+         || getsockname(listen_fd, (struct sockaddr*)&addr, &addr_len) < 0
+         || (*client_fd = socket(AF_INET, SOCK_STREAM, 0)) < 0
+         || connect(*client_fd, (struct sockaddr*)&addr, sizeof(addr)) < 0
+         || (*host_fd = accept(listen_fd, NULL, NULL)) < 0)
+   {
+      close(listen_fd);
+      return false;
+   }
+
+   close(listen_fd);
+   setsockopt(*client_fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+   setsockopt(*host_fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+   return true;
+}
+
+int main(int argc, char *argv[])
+{
+   unsigned i, r;
+   struct bench_host host;
+   struct bench_client client;
+   uint32_t compression;
+   sthread_t *thread     = NULL;
+   uint8_t *wrong        = NULL;
+   uint8_t *loaded       = NULL;
+   size_t state_size     = 4 * 1024 * 1024;
+   unsigned rounds       = 20;
+   unsigned errors       = 0;
+   double times[2]       = {0, 0};
+   size_t bytes[2]       = {0, 0};
+   static const char *names[2] = {"full:", "delta:"};
+
+   if (argc > 1)
+      state_size = (size_t)strtoul(argv[1], NULL, 0) * 1024;
+   if (argc > 2)
+      rounds     = (unsigned)strtoul(argv[2], NULL, 0);
+
+   if (state_size < 64 * 1024 || !rounds)
+   {
+      fprintf(stderr, "Usage: %s [state KiB, at least 64] [resyncs]\n",
+            argv[0]);
+      return 1;
+   }
+
+   memset(&host, 0, sizeof(host));
+   memset(&client, 0, sizeof(client));
+   host.state_size = state_size;
+
+   for (i = 0; i <= LATENCY; i++)
+      if (!(host.states[i] = (uint8_t*)malloc(state_size)))
+         return 1;
+   wrong             = (uint8_t*)malloc(state_size);
+   loaded            = (uint8_t*)malloc(state_size);
+   client.base.state = (uint8_t*)malloc(state_size);
+
+   if (     !wrong || !loaded || !client.base.state
+         || !init_peer(&host.peer, state_size, true)
+         || !init_peer(&client.peer, state_size, false)
+         || !connect_loopback(&client.peer.fd, &host.peer.fd))
+   {
+      fprintf(stderr, "Failed to set up the host and client\n");
+      return 1;
+   }
+
+   fill_state(host.states[LATENCY], state_size);
+   fill_state(wrong, state_size);
+   errors += check_client(&client, wrong, state_size);
+
+   if (!(thread = sthread_create(host_thread, &host)))
+      return 1;
+
+   if (!recv_all(&client.peer, &compression, sizeof(compression)))
+   {
+      errors++;
+      goto end;
+   }
+   client_handshake(&client, ntohl(compression));
+
+   printf("%u KiB state, %u resyncs, host %u frames ahead\n",
+         (unsigned)(state_size / 1024), rounds, LATENCY);
+
+   for (r = 0; r < rounds; r++)
+   {
+      unsigned mode;
+
+      /* Both sides are in sync at the frame the host was on,
+       * then the client gets it wrong and the host runs on */
+      memcpy(host.states[0], host.states[LATENCY], state_size);
+      run_frame(host.states[0], state_size);
+      host.first_frame += LATENCY + 1;
+      memcpy(wrong, host.states[0], state_size);
+      desync(wrong, state_size);
+      for (i = 1; i <= LATENCY; i++)
+      {
+         memcpy(host.states[i], host.states[i - 1], state_size);
+         run_frame(host.states[i], state_size);
+      }
+
+      for (mode = 0; mode < 2; mode++)
+      {
+         size_t before    = host.peer.bytes + client.peer.bytes;
+         retro_time_t t0  = cpu_features_get_time_usec();
+
+         if (!client_resync(&client, loaded, wrong, host.first_frame,
+                  state_size, mode == 1))
+         {
+            fprintf(stderr, "%s resync failed\n", names[mode]);
+            errors++;
+            goto end;
+         }
+
+         times[mode] += elapsed_sec(t0);
+         bytes[mode] += host.peer.bytes + client.peer.bytes - before;
+
+         if (memcmp(loaded, host.states[LATENCY], state_size))
+            errors++;
+      }
+   }
+
+   for (i = 0; i < 2; i++)
+      printf("%-7s %10lu bytes  %9.3f ms per resync\n", names[i],
+            (unsigned long)(bytes[i] / rounds),
+            times[i] * 1000.0 / rounds);
+
+end:
+   {
+      uint32_t cmd[2];
+      cmd[0] = htonl(NETPLAY_CMD_DISCONNECT);
+      cmd[1] = 0;
+      send_all(&client.peer, cmd, sizeof(cmd));
+   }
+   sthread_join(thread);
+   if (host.failed)
+      errors++;
+
+   close(client.peer.fd);
+   close(host.peer.fd);
+   deinit_peer(&host.peer);
+   deinit_peer(&client.peer);
+   free(client.base.state);
+   for (i = 0; i <= LATENCY; i++)
+      free(host.states[i]);
+   free(wrong);
+   free(loaded);
+
+   if (errors)
+   {
+      fprintf(stderr, "%u errors\n", errors);
+      return 1;
+   }
+
+   return 0;
+}
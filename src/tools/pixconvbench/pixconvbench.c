@@ -0,0 +1,508 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Checks every pixconv routine, with every SIMD path this
+ * build and CPU have, against a per-pixel reference written
+ * straight from the pixel formats, then times each path at
+ * 640x480. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <retro_miscellaneous.h>
+#include <features/features_cpu.h>
+#include <gfx/scaler/pixconv.h>
+
+#define GUARD 0xa5
+
+typedef void (*conv_t)(void *output, const void *input,
+      int width, int height, int out_stride, int in_stride);
+typedef void (*ref_t)(uint8_t *out, const uint8_t *in, int width);
+
+static unsigned long rand_state = 1;
+
+static uint32_t bench_rand(void)
+{
+   rand_state = rand_state * 1103515245 + 12345;
+   return (uint32_t)(rand_state >> 16);
+}
+
+static double elapsed_sec(retro_time_t t0)
+{
+   return (cpu_features_get_time_usec() - t0) / 1000000.0;
+}
+
+static uint16_t rd16(const uint8_t *p) { return p[0] | (p[1] << 8); }
+static void wr16(uint8_t *p, unsigned v) { p[0] = v; p[1] = v >> 8; }
+static void wr32(uint8_t *p, uint32_t v)
+{
+   p[0] = v; p[1] = v >> 8; p[2] = v >> 16; p[3] = v >> 24;
+}
+
+/* Widens an n-bit channel to 8 bits by repeating its top bits */
+static unsigned expand(unsigned c, unsigned bits)
+{
+   c <<= 8 - bits;
+   return c | (c >> bits);
+}
+
+static unsigned clamp8(int c)
+{
+   return c < 0 ? 0 : c > 255 ? 255 : c;
+}
+
+static void ref_rgb565_0rgb1555(uint8_t *out, const uint8_t *in, int width)
+{
+   int x;
+   for (x = 0; x < width; x++)
+   {
+      unsigned c = rd16(in + x * 2);
+      wr16(out + x * 2, ((c >> 11) << 10) | (((c >> 6) & 0x1f) << 5)
+            | (c & 0x1f));
+   }
+}
+
+/* The 6-bit green takes the top bit of 5-bit green as its
+ * low bit, rather than leaving it 0 */
+static void ref_0rgb1555_rgb565(uint8_t *out, const uint8_t *in, int width)
+{
+   int x;
+   for (x = 0; x < width; x++)
+   {
+      unsigned c = rd16(in + x * 2);
+      unsigned g = (c >> 5) & 0x1f;
+      wr16(out + x * 2, (((c >> 10) & 0x1f) << 11)
+            | (((g << 1) | (g >> 4)) << 5) | (c & 0x1f));
+   }
+}
+
+static void ref_0rgb1555_argb8888(uint8_t *out, const uint8_t *in, int width)
+{
+   int x;
+   for (x = 0; x < width; x++)
+   {
+      unsigned c = rd16(in + x * 2);
+      wr32(out + x * 4, 0xff000000u
+            | (expand((c >> 10) & 0x1f, 5) << 16)
+            | (expand((c >>  5) & 0x1f, 5) <<  8)
+            |  expand( c        & 0x1f, 5));
+   }
+}
+
+static void ref_rgb565_argb8888(uint8_t *out, const uint8_t *in, int width)
+{
+   int x;
+   for (x = 0; x < width; x++)
+   {
+      unsigned c = rd16(in + x * 2);
+      wr32(out + x * 4, 0xff000000u
+            | (expand((c >> 11) & 0x1f, 5) << 16)
+            | (expand((c >>  5) & 0x3f, 6) <<  8)
+            |  expand( c        & 0x1f, 5));
+   }
+}
+
+static void ref_rgb565_abgr8888(uint8_t *out, const uint8_t *in, int width)
+{
+   int x;
+   for (x = 0; x < width; x++)
+   {
+      unsigned c = rd16(in + x * 2);
+      wr32(out + x * 4, 0xff000000u
+            | (expand( c        & 0x1f, 5) << 16)
+            | (expand((c >>  5) & 0x3f, 6) <<  8)
+            |  expand((c >> 11) & 0x1f, 5));
+   }
+}
+
+static void ref_argb8888_rgba4444(uint8_t *out, const uint8_t *in, int width)
+{
+   int x;
+   for (x = 0; x < width; x++)
+   {
+      const uint8_t *p = in + x * 4;
+      wr16(out + x * 2, ((p[2] >> 4) << 12) | ((p[1] >> 4) << 8)
+            | ((p[0] >> 4) << 4) | (p[3] >> 4));
+   }
+}
+
+static void ref_rgba4444_argb8888(uint8_t *out, const uint8_t *in, int width)
+{
+   int x;
+   for (x = 0; x < width; x++)
+   {
+      unsigned c = rd16(in + x * 2);
+      wr32(out + x * 4, (expand(c & 0xf, 4) << 24)
+            | (expand( c >> 12,       4) << 16)
+            | (expand((c >>  8) & 0xf, 4) <<  8)
+            |  expand((c >>  4) & 0xf, 4));
+   }
+}
+
+/* Green keeps its 4 bits at the top of the 6-bit field */
+static void ref_rgba4444_rgb565(uint8_t *out, const uint8_t *in, int width)
+{
+   int x;
+   for (x = 0; x < width; x++)
+   {
+      unsigned c = rd16(in + x * 2);
+      wr16(out + x * 2, ((c >> 12) << 12) | (((c >> 8) & 0xf) << 7)
+            | (((c >> 4) & 0xf) << 1));
+   }
+}
+
+static void ref_0rgb1555_bgr24(uint8_t *out, const uint8_t *in, int width)
+{
+   int x;
+   for (x = 0; x < width; x++)
+   {
+      unsigned c = rd16(in + x * 2);
+      out[x * 3 + 0] = expand( c        & 0x1f, 5);
+      out[x * 3 + 1] = expand((c >>  5) & 0x1f, 5);
+      out[x * 3 + 2] = expand((c >> 10) & 0x1f, 5);
+   }
+}
+
+static void ref_rgb565_bgr24(uint8_t *out, const uint8_t *in, int width)
+{
+   int x;
+   for (x = 0; x < width; x++)
+   {
+      unsigned c = rd16(in + x * 2);
+      out[x * 3 + 0] = expand( c        & 0x1f, 5);
+      out[x * 3 + 1] = expand((c >>  5) & 0x3f, 6);
+      out[x * 3 + 2] = expand((c >> 11) & 0x1f, 5);
+   }
+}
+
+static void ref_bgr24_argb8888(uint8_t *out, const uint8_t *in, int width)
+{
+   int x;
+   for (x = 0; x < width; x++)
+   {
+      const uint8_t *p = in + x * 3;
+      wr32(out + x * 4, 0xff000000u | (p[2] << 16) | (p[1] << 8) | p[0]);
+   }
+}
+
+static void ref_bgr24_rgb565(uint8_t *out, const uint8_t *in, int width)
+{
+   int x;
+   for (x = 0; x < width; x++)
+   {
+      const uint8_t *p = in + x * 3;
+      wr16(out + x * 2, ((p[2] >> 3) << 11) | ((p[1] >> 2) << 5)
+            | (p[0] >> 3));
+   }
+}
+
+static void ref_argb8888_0rgb1555(uint8_t *out, const uint8_t *in, int width)
+{
+   int x;
+   for (x = 0; x < width; x++)
+   {
+      const uint8_t *p = in + x * 4;
+      wr16(out + x * 2, ((p[2] >> 3) << 10) | ((p[1] >> 3) << 5)
+            | (p[0] >> 3));
+   }
+}
+
+static void ref_argb8888_rgb565(uint8_t *out, const uint8_t *in, int width)
+{
+   int x;
+   for (x = 0; x < width; x++)
+   {
+      const uint8_t *p = in + x * 4;
+      wr16(out + x * 2, ((p[2] >> 3) << 11) | ((p[1] >> 2) << 5)
+            | (p[0] >> 3));
+   }
+}
+
+static void ref_argb8888_bgr24(uint8_t *out, const uint8_t *in, int width)
+{
+   int x;
+   for (x = 0; x < width; x++)
+   {
+      out[x * 3 + 0] = in[x * 4 + 0];
+      out[x * 3 + 1] = in[x * 4 + 1];
+      out[x * 3 + 2] = in[x * 4 + 2];
+   }
+}
+
+static void ref_abgr8888_bgr24(uint8_t *out, const uint8_t *in, int width)
+{
+   int x;
+   for (x = 0; x < width; x++)
+   {
+      out[x * 3 + 0] = in[x * 4 + 2];
+      out[x * 3 + 1] = in[x * 4 + 1];
+      out[x * 3 + 2] = in[x * 4 + 0];
+   }
+}
+
+static void ref_argb8888_abgr8888(uint8_t *out, const uint8_t *in, int width)
+{
+   int x;
+   for (x = 0; x < width; x++)
+   {
+      out[x * 4 + 0] = in[x * 4 + 2];
+      out[x * 4 + 1] = in[x * 4 + 1];
+      out[x * 4 + 2] = in[x * 4 + 0];
+      out[x * 4 + 3] = in[x * 4 + 3];
+   }
+}
+
+/* Fixed point BT.601 with 6 fractional bits, chroma shared
+ * by each pair of pixels */
+static void ref_yuyv_argb8888(uint8_t *out, const uint8_t *in, int width)
+{
+   int x;
+   for (x = 0; x < width; x++)
+   {
+      int y = in[x * 2];
+      int u = in[(x & ~1) * 2 + 1] - 128;
+      int v = in[(x & ~1) * 2 + 3] - 128;
+      int r = (64 * y + 90 * v + 32) >> 6;
+      int g = (64 * y - 22 * u - 46 * v + 32) >> 6;
+      int b = (64 * y + 113 * u + 32) >> 6;
+      wr32(out + x * 4, 0xff000000u
+            | (clamp8(r) << 16) | (clamp8(g) << 8) | clamp8(b));
+   }
+}
+
+static void ref_copy(uint8_t *out, const uint8_t *in, int width)
+{
+   memcpy(out, in, width * 4);
+}
+
+static const struct
+{
+   const char *name;
+   conv_t conv;
+   ref_t ref;
+   int in_bpp;
+   int out_bpp;
+} convs[] = {
+   { "rgb565_0rgb1555",   conv_rgb565_0rgb1555,   ref_rgb565_0rgb1555,   2, 2 },
+   { "0rgb1555_rgb565",   conv_0rgb1555_rgb565,   ref_0rgb1555_rgb565,   2, 2 },
+   { "0rgb1555_argb8888", conv_0rgb1555_argb8888, ref_0rgb1555_argb8888, 2, 4 },
+   { "rgb565_argb8888",   conv_rgb565_argb8888,   ref_rgb565_argb8888,   2, 4 },
+   { "rgb565_abgr8888",   conv_rgb565_abgr8888,   ref_rgb565_abgr8888,   2, 4 },
+   { "argb8888_rgba4444", conv_argb8888_rgba4444, ref_argb8888_rgba4444, 4, 2 },
+   { "rgba4444_argb8888", conv_rgba4444_argb8888, ref_rgba4444_argb8888, 2, 4 },
+   { "rgba4444_rgb565",   conv_rgba4444_rgb565,   ref_rgba4444_rgb565,   2, 2 },
+   { "0rgb1555_bgr24",    conv_0rgb1555_bgr24,    ref_0rgb1555_bgr24,    2, 3 },
+   { "rgb565_bgr24",      conv_rgb565_bgr24,      ref_rgb565_bgr24,      2, 3 },
+   { "bgr24_argb8888",    conv_bgr24_argb8888,    ref_bgr24_argb8888,    3, 4 },
+   { "bgr24_rgb565",      conv_bgr24_rgb565,      ref_bgr24_rgb565,      3, 2 },
+   { "argb8888_0rgb1555", conv_argb8888_0rgb1555, ref_argb8888_0rgb1555, 4, 2 },
+   { "argb8888_rgb565",   conv_argb8888_rgb565,   ref_argb8888_rgb565,   4, 2 },
+   { "argb8888_bgr24",    conv_argb8888_bgr24,    ref_argb8888_bgr24,    4, 3 },
+   { "abgr8888_bgr24",    conv_abgr8888_bgr24,    ref_abgr8888_bgr24,    4, 3 },
+   { "argb8888_abgr8888", conv_argb8888_abgr8888, ref_argb8888_abgr8888, 4, 4 },
+   { "yuyv_argb8888",     conv_yuyv_argb8888,     ref_yuyv_argb8888,     2, 4 },
+   { "copy",              conv_copy,              ref_copy,              4, 4 },
+};
+
+/* Each x86 path keeps the older ones to fall back on for
+ * conversions it has no code for, as it would at runtime */
+static const struct
+{
+   const char *name;
+   uint64_t simd;
+} paths[] = {
+   { "C",    0 },
+   { "MMX",  RETRO_SIMD_MMX },
+   { "SSE2", RETRO_SIMD_MMX | RETRO_SIMD_SSE2 },
+   { "AVX2", RETRO_SIMD_MMX | RETRO_SIMD_SSE2 | RETRO_SIMD_AVX2 },
+   { "NEON", RETRO_SIMD_NEON },
+};
+
+/* Row pitch for @width pixels plus @pad bytes, kept a whole
+ * number of the widest pixel so every stride stays aligned
+ * the way the conv_* functions expect. */
+static int row_stride(int width, int bpp, int pad)
+{
+   return (width * bpp + pad + 3) & ~3;
+}
+
+/* Converts a frame with both strides padded, and checks every
+ * row against the reference and every padding byte for
+ * stray writes. */
+static unsigned check(unsigned c, const char *path,
+      int width, int height, int pad)
+{
+   int x, y;
+   unsigned errors = 0;
+   int in_stride   = row_stride(width, convs[c].in_bpp, pad);
+   int out_stride  = row_stride(width, convs[c].out_bpp, pad);
+   int row_bytes   = width * convs[c].out_bpp;
+   /* An odd YUYV width reads the chroma of a half pair */
+   uint8_t *in     = (uint8_t*)malloc(in_stride * height + 4);
+   uint8_t *out    = (uint8_t*)malloc(out_stride * height);
+   uint8_t *ref    = (uint8_t*)malloc(out_stride);
+
+   /* conv_copy copies whole strides */
+   if (convs[c].conv == conv_copy)
+   {
+      out_stride = in_stride;
+      row_bytes  = in_stride;
+      out        = (uint8_t*)realloc(out, out_stride * height);
+      ref        = (uint8_t*)realloc(ref, out_stride);
+   }
+
+   for (x = 0; x < in_stride * height + 4; x++)
+      in[x] = (uint8_t)bench_rand();
+   memset(out, GUARD, out_stride * height);
+
+   convs[c].conv(out, in, width, height, out_stride, in_stride);
+
+   for (y = 0; y < height; y++)
+   {
+      const uint8_t *row = out + y * out_stride;
+
+      if (convs[c].conv == conv_copy)
+         memcpy(ref, in + y * in_stride, row_bytes);
+      else
+         convs[c].ref(ref, in + y * in_stride, width);
+
+      if (memcmp(row, ref, row_bytes))
+      {
+         for (x = 0; x < row_bytes && row[x] == ref[x]; x++);
+         if (errors < 8)
+            fprintf(stderr, "%s %s %dx%d: row %d differs at byte %d "
+                  "(%02x, expected %02x)\n", convs[c].name,
+                  path,
+                  width, height, y, x, row[x], ref[x]);
+         errors++;
+      }
+
+      for (x = row_bytes; x < out_stride; x++)
+      {
+         if (row[x] != GUARD)
+         {
+            if (errors < 8)
+               fprintf(stderr, "%s %s %dx%d: row %d written past its end\n",
+                     convs[c].name, path, width, height, y);
+            errors++;
+            break;
+         }
+      }
+   }
+
+   free(in);
+   free(out);
+   free(ref);
+   return errors;
+}
+
+static double mpix_per_sec(unsigned c, unsigned frames)
+{
+   unsigned i;
+   retro_time_t t0;
+   const int width  = 640;
+   const int height = 480;
+   int in_stride    = row_stride(width, convs[c].in_bpp, 0);
+   int out_stride   = row_stride(width, convs[c].out_bpp, 0);
+   uint8_t *in      = (uint8_t*)calloc(height, in_stride);
+   uint8_t *out     = (uint8_t*)calloc(height, out_stride);
+
+   if (convs[c].conv == conv_copy)
+      out_stride = in_stride;
+
+   for (i = 0; i < (unsigned)(in_stride * height); i++)
+      in[i] = (uint8_t)bench_rand();
+
+   convs[c].conv(out, in, width, height, out_stride, in_stride);
+
+   t0 = cpu_features_get_time_usec();
+   for (i = 0; i < frames; i++)
+      convs[c].conv(out, in, width, height, out_stride, in_stride);
+
+   free(in);
+   free(out);
+   return (double)width * height * frames / elapsed_sec(t0) / 1000000.0;
+}
+
+int main(int argc, char *argv[])
+{
+   unsigned c, p;
+   int width;
+   unsigned frames    = 200;
+   unsigned errors    = 0;
+   uint64_t available = 0;
+
+   if (argc > 1)
+      frames = (unsigned)strtoul(argv[1], NULL, 0);
+
+   if (!frames)
+   {
+      fprintf(stderr, "Usage: %s [frames]\n", argv[0]);
+      return 1;
+   }
+
+   pixconv_init_simd();
+   available = pixconv_get_simd();
+
+   /* Every width up to a few vectors, to cover each tail,
+    * with and without padding between rows */
+   for (p = 0; p < ARRAY_SIZE(paths); p++)
+   {
+      if ((paths[p].simd & available) != paths[p].simd)
+         continue;
+
+      pixconv_set_simd(paths[p].simd);
+
+      for (c = 0; c < ARRAY_SIZE(convs); c++)
+      {
+         for (width = 1; width <= 72; width++)
+         {
+            errors += check(c, paths[p].name, width, 3, 0);
+            errors += check(c, paths[p].name, width, 3, 13);
+         }
+         errors += check(c, paths[p].name, 640, 4, 0);
+      }
+   }
+
+   printf("640x480, megapixels per second:\n");
+   printf("%-18s", "conversion");
+   for (p = 0; p < ARRAY_SIZE(paths); p++)
+      if ((paths[p].simd & available) == paths[p].simd)
+         printf(" %8s", paths[p].name);
+   printf("\n");
+
+   for (c = 0; c < ARRAY_SIZE(convs); c++)
+   {
+      printf("%-18s", convs[c].name);
+      for (p = 0; p < ARRAY_SIZE(paths); p++)
+      {
+         if ((paths[p].simd & available) != paths[p].simd)
+            continue;
+         pixconv_set_simd(paths[p].simd);
+         printf(" %8.1f", mpix_per_sec(c, frames));
+      }
+      printf("\n");
+   }
+
+   if (errors)
+   {
+      fprintf(stderr, "%u errors\n", errors);
+      return 1;
+   }
+
+   return 0;
+}
@@ -0,0 +1,363 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Fills a playlist the way a content scan does, then times
+ * the path lookups done by scans and the playlist manager,
+ * checking every answer along the way. Finally times loading
+ * the playlist back from disk, with and without the binary
+ * playlist cache. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
+
+#include <features/features_cpu.h>
+#include <file/archive_file.h>
+#include <string/stdstring.h>
+#include <streams/file_stream.h>
+
+#include "playlist.h"
+#include "core_info.h"
+#include "verbosity.h"
+
+/* playlist.c only needs these for things
+ * this benchmark doesn't do */
+void RARCH_LOG(const char *fmt, ...)  { }
+void RARCH_WARN(const char *fmt, ...) { }
+void RARCH_ERR(const char *fmt, ...)
+{
+   va_list ap;
+   va_start(ap, fmt);
+   vfprintf(stderr, fmt, ap);
+   va_end(ap);
+}
+
+bool core_info_find(const char *core_path, core_info_t **core_info)
+{
+   return false;
+}
+
+bool core_info_core_file_id_is_equal(const char *core_path_a,
+      const char *core_path_b)
+{
+   return false;
+}
+
+struct string_list *file_archive_get_file_list(const char *path,
+      const char *ext)
+{
+   return NULL;
+}
+
+#define CORE_PATH "/cores/bench_libretro.so"
+
+static void make_path(char *s, size_t len, unsigned i)
+{
+   snprintf(s, len, "/roms/Collection %u/Game %06u (World).bin",
+         i % 97, i);
+}
+
+static double elapsed_sec(retro_time_t t0)
+{
+   return (cpu_features_get_time_usec() - t0) / 1000000.0;
+}
+
+static unsigned compare_playlists(playlist_t *a, playlist_t *b)
+{
+   size_t i;
+   unsigned errors = 0;
+
+   if (playlist_size(a) != playlist_size(b))
+      return 1;
+
+   for (i = 0; i < playlist_size(a); i++)
+   {
+      const struct playlist_entry *ea = NULL;
+      const struct playlist_entry *eb = NULL;
+
+      playlist_get_index(a, i, &ea);
+      playlist_get_index(b, i, &eb);
+
+      if (     !ea || !eb
+            || !string_is_equal(ea->path,      eb->path)
+            || !string_is_equal(ea->label,     eb->label)
+            || !string_is_equal(ea->core_path, eb->core_path)
+            || !string_is_equal(ea->core_name, eb->core_name)
+            || !string_is_equal(ea->crc32,     eb->crc32)
+            || !string_is_equal(ea->db_name,   eb->db_name))
+         errors++;
+   }
+
+   if (!string_is_equal(playlist_get_default_core_path(a),
+            playlist_get_default_core_path(b)))
+      errors++;
+
+   return errors;
+}
+
+/* Changes the first character of the first label in
+ * the playlist file, keeping its size and (where
+ * possible) its modification time, so that only the
+ * contents tell the cache is stale */
+static bool edit_playlist_file(const char *path)
+{
+   void *buf   = NULL;
+   int64_t len = 0;
+   char *label;
+   bool ret    = false;
+#if defined(__linux__)
+   struct stat st;
+   struct timespec times[2];
+
+   if (stat(path, &st) != 0)
+      return false;
+#endif
+
+   if (!filestream_read_file(path, &buf, &len))
+      return false;
+
+   if ((label = strstr((char*)buf, "\"label\": \"")))
+   {
+      label[STRLEN_CONST("\"label\": \"")] = 'X';
+      ret = filestream_write_file(path, buf, len);
+   }
+   free(buf);
+
+#if defined(__linux__)
+   times[0] = st.st_atim;
+   times[1] = st.st_mtim;
+   if (ret && utimensat(AT_FDCWD, path, times, 0) != 0)
+      ret = false;
+#endif
+   return ret;
+}
+
+/* Loads the playlist at 'config' and checks it
+ * against 'ref' (if any) */
+static playlist_t *load_playlist(const char *name,
+      playlist_config_t *config, playlist_t *ref, unsigned *errors)
+{
+   double t;
+   playlist_t *pl;
+   retro_time_t t0 = cpu_features_get_time_usec();
+
+   if (!(pl = playlist_init(config)))
+   {
+      (*errors)++;
+      return NULL;
+   }
+
+   t = elapsed_sec(t0);
+   printf("%-10s %9.3f s  %12.0f entries/s\n", name, t,
+         playlist_size(pl) / t);
+
+   if (ref)
+      *errors += compare_playlists(ref, pl);
+
+   return pl;
+}
+
+int main(int argc, char *argv[])
+{
+   unsigned i;
+   retro_time_t t0;
+   double t;
+   char path[PATH_MAX_LENGTH];
+   playlist_config_t config;
+   struct playlist_entry entry;
+   unsigned count     = 50000;
+   unsigned lookups   = 50000;
+   unsigned deletes   = 1000;
+   unsigned errors    = 0;
+   playlist_t *pl     = NULL;
+   playlist_t *json   = NULL;
+   playlist_t *cached = NULL;
+
+   if (argc > 1)
+      count   = (unsigned)strtoul(argv[1], NULL, 0);
+   if (argc > 2)
+      lookups = (unsigned)strtoul(argv[2], NULL, 0);
+
+   if (!count || !lookups)
+   {
+      fprintf(stderr, "Usage: %s [entries] [lookups]\n", argv[0]);
+      return 1;
+   }
+
+   if (deletes > count / 2)
+      deletes = count / 2;
+
+   memset(&config, 0, sizeof(config));
+   config.capacity            = count;
+   config.fuzzy_archive_match = false;
+   config.autofix_paths       = false;
+   playlist_config_set_path(&config, "playlistbench.lpl");
+
+   if (!(pl = playlist_init(&config)))
+      return 1;
+
+   memset(&entry, 0, sizeof(entry));
+   entry.path      = path;
+   entry.core_path = (char*)CORE_PATH;
+   entry.core_name = (char*)"Bench";
+   entry.db_name   = (char*)"Bench.lpl";
+   entry.crc32     = (char*)"00000000|crc";
+
+   printf("%u entries, %u lookups\n", count, lookups);
+
+   /* A scan checks for each file before adding it */
+   t0 = cpu_features_get_time_usec();
+   for (i = 0; i < count; i++)
+   {
+      make_path(path, sizeof(path), i);
+      if (playlist_entry_exists(pl, path))
+         errors++;
+      entry.label = path + 10;
+      if (!playlist_push(pl, &entry))
+         errors++;
+   }
+   t = elapsed_sec(t0);
+   printf("build:     %9.3f s  %12.0f entries/s\n", t, count / t);
+
+   if (playlist_size(pl) != count)
+   {
+      fprintf(stderr, "playlist has %u entries, expected %u\n",
+            (unsigned)playlist_size(pl), count);
+      errors++;
+   }
+
+   /* Entries were pushed to the top, so entry 'n'
+    * ends up at position count - 1 - n */
+   t0 = cpu_features_get_time_usec();
+   for (i = 0; i < lookups; i++)
+   {
+      const struct playlist_entry *found = NULL;
+      unsigned n = (unsigned)(((uint64_t)i * 2654435761u) % count);
+
+      make_path(path, sizeof(path), n);
+      playlist_get_index_by_path(pl, path, &found);
+      if (!found || !string_is_equal(found->path, path))
+         errors++;
+   }
+   t = elapsed_sec(t0);
+   printf("hit:       %9.3f s  %12.0f lookups/s\n", t, lookups / t);
+
+   t0 = cpu_features_get_time_usec();
+   for (i = 0; i < lookups; i++)
+   {
+      make_path(path, sizeof(path), count + i);
+      if (playlist_entry_exists(pl, path))
+         errors++;
+   }
+   t = elapsed_sec(t0);
+   printf("miss:      %9.3f s  %12.0f lookups/s\n", t, lookups / t);
+
+   /* Pushing existing content bumps it to the top */
+   t0 = cpu_features_get_time_usec();
+   for (i = 0; i < deletes; i++)
+   {
+      const struct playlist_entry *top = NULL;
+
+      make_path(path, sizeof(path), i * 7 % count);
+      entry.label = path + 10;
+      playlist_push(pl, &entry);
+      playlist_get_index(pl, 0, &top);
+      if (!top || !string_is_equal(top->path, path))
+         errors++;
+   }
+   t = elapsed_sec(t0);
+   printf("bump:      %9.3f s  %12.0f pushes/s\n", t, deletes / t);
+
+   t0 = cpu_features_get_time_usec();
+   for (i = 0; i < deletes; i++)
+   {
+      make_path(path, sizeof(path), i * 2 + 1);
+      playlist_delete_by_path(pl, path);
+      if (playlist_entry_exists(pl, path))
+         errors++;
+   }
+   t = elapsed_sec(t0);
+   printf("delete:    %9.3f s  %12.0f deletes/s\n", t, deletes / t);
+
+   if (playlist_size(pl) != count - deletes)
+   {
+      fprintf(stderr, "playlist has %u entries after deleting, expected %u\n",
+            (unsigned)playlist_size(pl), count - deletes);
+      errors++;
+   }
+
+   /* Load it back: plain JSON, JSON plus writing the
+    * cache, then from the cache */
+   playlist_set_default_core_path(pl, CORE_PATH);
+   playlist_write_file(pl);
+   playlist_free(pl);
+   filestream_delete("playlistbench.lplc");
+
+   if ((json = load_playlist("load:", &config, NULL, &errors)))
+   {
+      config.binary_cache = true;
+
+      if ((pl = load_playlist("load+lplc:", &config, json, &errors)))
+         playlist_free(pl);
+      if ((cached = load_playlist("lplc:", &config, json, &errors)))
+      {
+         /* Entries point into the cache, these have
+          * to replace and free them correctly */
+         make_path(path, sizeof(path), 2);
+         entry.label = (char*)"Renamed";
+         playlist_update(cached, 0, &entry);
+         playlist_delete_by_path(cached, path);
+         if (playlist_entry_exists(cached, path))
+            errors++;
+         playlist_free(cached);
+      }
+
+      /* A playlist edited behind the cache's back is
+       * parsed again, not served from the cache */
+      if (!edit_playlist_file("playlistbench.lpl"))
+         errors++;
+      else if ((cached = load_playlist("edited:", &config, NULL, &errors)))
+      {
+         const struct playlist_entry *first = NULL;
+
+         playlist_get_index(cached, 0, &first);
+         if (!first || !first->label || first->label[0] != 'X')
+         {
+            fprintf(stderr, "stale playlist cache used\n");
+            errors++;
+         }
+         playlist_free(cached);
+      }
+
+      playlist_free(json);
+   }
+
+   filestream_delete("playlistbench.lpl");
+   filestream_delete("playlistbench.lplc");
+
+   if (errors)
+   {
+      fprintf(stderr, "%u wrong results\n", errors);
+      return 1;
+   }
+
+   return 0;
+}
@@ -0,0 +1,402 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *  Copyright (C) 2014-2017 - Alfred Agrell
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Replays consecutive savestates through the rewind delta
+ * encoder with every scan kernel available on this machine,
+ * checks that each patch round-trips, and reports throughput. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <features/features_cpu.h>
+
+#include "state_manager_delta.h"
+
+struct bench_state
+{
+   uint8_t **states;
+   uint8_t **patches;
+   size_t   *patch_sizes;
+   uint8_t  *scratch;
+   size_t    size;
+   unsigned  count;
+};
+
+static uint8_t *load_state(const char *path, size_t *size, uint16_t uniq)
+{
+   long len;
+   uint8_t *buf = NULL;
+   FILE *fp     = fopen(path, "rb");
+
+   if (!fp)
+   {
+      perror(path);
+      return NULL;
+   }
+
+   fseek(fp, 0, SEEK_END);
+   len = ftell(fp);
+   fseek(fp, 0, SEEK_SET);
+
+   if (len <= 0 || (*size && (size_t)len != *size))
+   {
+      fprintf(stderr, "%s: all states must be non-empty and "
+            "of the same size.\n", path);
+      fclose(fp);
+      return NULL;
+   }
+
+   *size = (size_t)len;
+
+   if (!(buf = (uint8_t*)state_manager_raw_alloc(*size, uniq)))
+   {
+      fclose(fp);
+      return NULL;
+   }
+
+   if (fread(buf, 1, *size, fp) != *size)
+   {
+      perror(path);
+      free(buf);
+      buf = NULL;
+   }
+
+   fclose(fp);
+   return buf;
+}
+
+/* Generates a run of states where a few short bursts of words
+ * change each frame, roughly what a big-state core looks like. */
+static bool make_synthetic(struct bench_state *b,
+      size_t size, unsigned count, unsigned bursts)
+{
+   unsigned i, j;
+   uint32_t seed = 0x1234567u;
+
+   b->size       = size;
+   b->count      = count;
+
+   for (i = 0; i < count; i++)
+   {
+      uint16_t *words;
+      size_t num16s = size / sizeof(uint16_t);
+
+      if (!(b->states[i] = (uint8_t*)state_manager_raw_alloc(size, i & 1)))
+         return false;
+
+      words = (uint16_t*)b->states[i];
+
+      if (i == 0)
+      {
+         for (j = 0; j < num16s; j++)
+         {
+            seed     = seed * 1103515245u + 12345u;
+            words[j] = seed >> 16;
+         }
+         continue;
+      }
+
+      memcpy(words, b->states[i - 1], size);
+
+      for (j = 0; j < bursts; j++)
+      {
+         size_t k, pos, run;
+         seed = seed * 1103515245u + 12345u;
+         pos  = (seed >> 8) % num16s;
+         seed = seed * 1103515245u + 12345u;
+         run  = 1 + ((seed >> 16) & 31);
+         for (k = pos; k < pos + run && k < num16s; k++)
+            words[k] ^= (uint16_t)(seed | 1);
+      }
+   }
+
+   return true;
+}
+
+static bool run_kernel(struct bench_state *b,
+      enum state_manager_delta_kernel kernel,
+      unsigned iterations, bool reference)
+{
+   unsigned i, j;
+   retro_time_t t0, t_comp, t_decomp;
+   size_t total_patch = 0;
+   double mbytes      = 0.0;
+   size_t blocksize   = (b->size + 1) & ~(size_t)1;
+   uint8_t *patch     = (uint8_t*)malloc(state_manager_raw_maxsize(b->size));
+
+   if (!patch)
+      return false;
+
+   state_manager_delta_set_kernel(kernel);
+
+   /* Compress */
+   t0 = cpu_features_get_time_usec();
+   for (j = 0; j < iterations; j++)
+   {
+      for (i = 0; i + 1 < b->count; i++)
+      {
+         size_t len = state_manager_raw_compress(
+               b->states[i], b->states[i + 1], blocksize, patch);
+
+         if (j)
+            continue;
+
+         total_patch += len;
+
+         if (reference)
+         {
+            b->patch_sizes[i] = len;
+            memcpy(b->patches[i], patch, len);
+         }
+         else if (len != b->patch_sizes[i]
+               || memcmp(patch, b->patches[i], len))
+         {
+            fprintf(stderr, "%s: patch %u differs from the reference kernel.\n",
+                  state_manager_delta_kernel_name(kernel), i);
+            free(patch);
+            return false;
+         }
+      }
+   }
+   t_comp = cpu_features_get_time_usec() - t0;
+
+   /* Decompress, applying every patch onto the newer state. */
+   t_decomp = 0;
+   for (j = 0; j < iterations; j++)
+   {
+      for (i = 0; i + 1 < b->count; i++)
+      {
+         memcpy(b->scratch, b->states[i + 1], b->size);
+
+         t0        = cpu_features_get_time_usec();
+         state_manager_raw_decompress(b->patches[i],
+               b->patch_sizes[i], b->scratch, blocksize);
+         t_decomp += cpu_features_get_time_usec() - t0;
+
+         if (!j && memcmp(b->scratch, b->states[i], b->size))
+         {
+            fprintf(stderr, "%s: patch %u does not round-trip.\n",
+                  state_manager_delta_kernel_name(kernel), i);
+            free(patch);
+            return false;
+         }
+      }
+   }
+
+   mbytes = (double)b->size * (b->count - 1) * iterations / 1000000.0;
+
+   printf("%-8s compress: %9.1f MB/s  decompress: %9.1f MB/s  ratio: %6.2f%%\n",
+         state_manager_delta_kernel_name(kernel),
+         t_comp   ? mbytes / (t_comp   / 1000000.0) : 0.0,
+         t_decomp ? mbytes / (t_decomp / 1000000.0) : 0.0,
+         100.0 * total_patch / ((double)b->size * (b->count - 1)));
+
+   free(patch);
+   return true;
+}
+
+/* Same as the compress pass of run_kernel(), but hashes pages
+ * first and only diffs the dirty ones, like the rewind buffer. */
+static bool run_pages(struct bench_state *b, unsigned iterations)
+{
+   unsigned i, j;
+   retro_time_t t0, t_comp;
+   size_t dirty_pages = 0;
+   bool ret           = false;
+   double mbytes      = 0.0;
+   size_t blocksize   = (b->size + 1) & ~(size_t)1;
+   size_t num_pages   = state_manager_raw_num_pages(blocksize);
+   uint8_t *patch     = (uint8_t*)malloc(state_manager_raw_maxsize(b->size));
+   uint64_t *hashes   = (uint64_t*)calloc(num_pages, sizeof(*hashes));
+   uint8_t *dirty     = (uint8_t*)malloc(num_pages);
+
+   if (!patch || !hashes || !dirty)
+      goto end;
+
+   t_comp = 0;
+   for (j = 0; j < iterations; j++)
+   {
+      state_manager_raw_hash_pages(b->states[0], blocksize, hashes, dirty);
+
+      t0 = cpu_features_get_time_usec();
+      for (i = 0; i + 1 < b->count; i++)
+      {
+         size_t k, len;
+
+         state_manager_raw_hash_pages(b->states[i + 1], blocksize,
+               hashes, dirty);
+         len = state_manager_raw_compress_pages(b->states[i],
+               b->states[i + 1], blocksize, patch, dirty);
+
+         if (j)
+            continue;
+
+         for (k = 0; k < num_pages; k++)
+            dirty_pages += dirty[k] ? 1 : 0;
+
+         if (len != b->patch_sizes[i] || memcmp(patch, b->patches[i], len))
+         {
+            fprintf(stderr, "pages: patch %u differs from the reference kernel.\n", i);
+            goto end;
+         }
+      }
+      t_comp += cpu_features_get_time_usec() - t0;
+   }
+
+   mbytes = (double)b->size * (b->count - 1) * iterations / 1000000.0;
+
+   printf("%-8s compress: %9.1f MB/s  dirty pages: %6.2f%%\n",
+         "pages",
+         t_comp ? mbytes / (t_comp / 1000000.0) : 0.0,
+         100.0 * dirty_pages / ((double)num_pages * (b->count - 1)));
+   ret = true;
+
+end:
+   free(patch);
+   free(hashes);
+   free(dirty);
+   return ret;
+}
+
+static void usage(const char *argv0)
+{
+   fprintf(stderr,
+         "Usage: %s [-n iterations] state0 state1 [state2 ...]\n"
+         "       %s [-n iterations] -s size [-c count] [-b bursts]\n"
+         "\n"
+         "Consecutive savestates are diffed the same way the rewind\n"
+         "buffer does it. With -s, 'count' synthetic states of 'size'\n"
+         "bytes are generated instead, each one changing 'bursts'\n"
+         "short runs of the previous one.\n", argv0, argv0);
+}
+
+int main(int argc, char *argv[])
+{
+   int i;
+   unsigned k;
+   struct bench_state b;
+   bool have_reference = false;
+   unsigned iterations = 20;
+   size_t synth_size   = 0;
+   unsigned synth_cnt  = 16;
+   unsigned bursts     = 0;
+   int first_file      = 0;
+   int ret             = 1;
+
+   memset(&b, 0, sizeof(b));
+
+   for (i = 1; i < argc; i++)
+   {
+      if (!strcmp(argv[i], "-n") && i + 1 < argc)
+         iterations = (unsigned)strtoul(argv[++i], NULL, 0);
+      else if (!strcmp(argv[i], "-s") && i + 1 < argc)
+         synth_size = (size_t)strtoul(argv[++i], NULL, 0);
+      else if (!strcmp(argv[i], "-c") && i + 1 < argc)
+         synth_cnt  = (unsigned)strtoul(argv[++i], NULL, 0);
+      else if (!strcmp(argv[i], "-b") && i + 1 < argc)
+         bursts     = (unsigned)strtoul(argv[++i], NULL, 0);
+      else if (argv[i][0] == '-')
+      {
+         usage(argv[0]);
+         return 1;
+      }
+      else
+      {
+         first_file = i;
+         break;
+      }
+   }
+
+   b.count = synth_size ? synth_cnt : (first_file ? (unsigned)(argc - first_file) : 0);
+
+   if (b.count < 2 || !iterations)
+   {
+      usage(argv[0]);
+      return 1;
+   }
+
+   b.states      = (uint8_t**)calloc(b.count, sizeof(*b.states));
+   b.patches     = (uint8_t**)calloc(b.count, sizeof(*b.patches));
+   b.patch_sizes = (size_t*)calloc(b.count, sizeof(*b.patch_sizes));
+
+   if (!b.states || !b.patches || !b.patch_sizes)
+      goto end;
+
+   if (synth_size)
+   {
+      if (!bursts)
+         bursts = (unsigned)(synth_size / sizeof(uint16_t) / 512);
+      if (!make_synthetic(&b, synth_size, synth_cnt, bursts))
+         goto end;
+   }
+   else
+   {
+      for (k = 0; k < b.count; k++)
+         if (!(b.states[k] = load_state(argv[first_file + k], &b.size, k & 1)))
+            goto end;
+   }
+
+   if (!(b.scratch = (uint8_t*)malloc(b.size + 1)))
+      goto end;
+
+   for (k = 0; k + 1 < b.count; k++)
+      if (!(b.patches[k] = (uint8_t*)malloc(
+                  state_manager_raw_maxsize(b.size))))
+         goto end;
+
+   printf("%u states of %u bytes, %u iterations\n",
+         b.count, (unsigned)b.size, iterations);
+
+   ret = 0;
+
+   for (k = 0; k < STATE_MANAGER_DELTA_KERNEL_LAST; k++)
+   {
+      enum state_manager_delta_kernel kernel =
+         (enum state_manager_delta_kernel)k;
+
+      if (!state_manager_delta_kernel_supported(kernel))
+      {
+         printf("%-8s not available\n",
+               state_manager_delta_kernel_name(kernel));
+         continue;
+      }
+
+      if (!run_kernel(&b, kernel, iterations, !have_reference))
+         ret = 1;
+      have_reference = true;
+   }
+
+   state_manager_delta_init_simd();
+   if (!run_pages(&b, iterations))
+      ret = 1;
+
+end:
+   for (k = 0; k < b.count; k++)
+   {
+      if (b.states)
+         free(b.states[k]);
+      if (b.patches)
+         free(b.patches[k]);
+   }
+   free(b.states);
+   free(b.patches);
+   free(b.patch_sizes);
+   free(b.scratch);
+
+   return ret;
+}
@@ -0,0 +1,368 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2010-2014 - Hans-Kristian Arntzen
+ *  Copyright (C) 2011-2017 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Times softfilters at common core resolutions, once run the
+ * way they used to be (plain C, one packet on the calling
+ * thread) and twice through the softfilter host (SIMD where
+ * the CPU has it, cache sized slices, one thread and then the
+ * shared thread pool). Checks that the host's output matches
+ * the plain C output. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+
+#include <retro_miscellaneous.h>
+#include <features/features_cpu.h>
+#include <streams/file_stream.h>
+#include <string/stdstring.h>
+
+#include "gfx/video_filter.h"
+#include "gfx/video_filters/softfilter.h"
+#include "verbosity.h"
+
+#define BENCH_FILT "softfilterbench.filt"
+
+/* video_filter.c only needs these for logging */
+void RARCH_LOG(const char *fmt, ...)  { }
+void RARCH_WARN(const char *fmt, ...) { }
+void RARCH_ERR(const char *fmt, ...)
+{
+   va_list ap;
+   va_start(ap, fmt);
+   vfprintf(stderr, fmt, ap);
+   va_end(ap);
+}
+
+extern const struct softfilter_implementation *scale2x_get_implementation(softfilter_simd_mask_t simd);
+extern const struct softfilter_implementation *lq2x_get_implementation(softfilter_simd_mask_t simd);
+extern const struct softfilter_implementation *twoxsai_get_implementation(softfilter_simd_mask_t simd);
+extern const struct softfilter_implementation *supertwoxsai_get_implementation(softfilter_simd_mask_t simd);
+extern const struct softfilter_implementation *supereagle_get_implementation(softfilter_simd_mask_t simd);
+extern const struct softfilter_implementation *blargg_ntsc_snes_get_implementation(softfilter_simd_mask_t simd);
+
+static const struct
+{
+   const char *ident;
+   softfilter_get_implementation_t get_implementation;
+} filters[] = {
+   { "scale2x",          scale2x_get_implementation },
+   { "lq2x",             lq2x_get_implementation },
+   { "2xsai",            twoxsai_get_implementation },
+   { "super2xsai",       supertwoxsai_get_implementation },
+   { "supereagle",       supereagle_get_implementation },
+   { "blargg_ntsc_snes", blargg_ntsc_snes_get_implementation },
+};
+
+/* Game Boy, Game Boy Advance, SNES, PlayStation, 480p */
+static const unsigned sizes[][2] = {
+   { 160, 144 },
+   { 240, 160 },
+   { 256, 224 },
+   { 320, 240 },
+   { 640, 480 },
+};
+
+static unsigned long rand_state = 1;
+
+static uint32_t bench_rand(void)
+{
+   rand_state = rand_state * 1103515245 + 12345;
+   return (uint32_t)(rand_state >> 16);
+}
+
+static double elapsed_sec(retro_time_t t0)
+{
+   return (cpu_features_get_time_usec() - t0) / 1000000.0;
+}
+
+/* Config callbacks for the plain C runs, returning the defaults */
+static int bench_get_float(void *userdata, const char *key,
+      float *value, float default_value)
+{
+   *value = default_value;
+   return 0;
+}
+
+static int bench_get_int(void *userdata, const char *key,
+      int *value, int default_value)
+{
+   *value = default_value;
+   return 0;
+}
+
+static int bench_get_hex(void *userdata, const char *key,
+      unsigned *value, unsigned default_value)
+{
+   *value = default_value;
+   return 0;
+}
+
+static int bench_get_float_array(void *userdata, const char *key,
+      float **values, unsigned *out_num_values,
+      const float *default_values, unsigned num_default_values)
+{
+   *values         = NULL;
+   *out_num_values = 0;
+   return 0;
+}
+
+static int bench_get_int_array(void *userdata, const char *key,
+      int **values, unsigned *out_num_values,
+      const int *default_values, unsigned num_default_values)
+{
+   *values         = NULL;
+   *out_num_values = 0;
+   return 0;
+}
+
+static int bench_get_string(void *userdata, const char *key,
+      char **output, const char *default_output)
+{
+   *output = strdup(default_output);
+   return 0;
+}
+
+static const struct softfilter_config bench_config = {
+   bench_get_float,
+   bench_get_int,
+   bench_get_hex,
+   bench_get_float_array,
+   bench_get_int_array,
+   bench_get_string,
+   free,
+};
+
+/* Runs of a few colours, so that neighbouring pixels are
+ * often equal, as they are in pixel art */
+static void fill_frame(void *frame, unsigned width, unsigned height,
+      size_t pitch, unsigned fmt)
+{
+   static const uint32_t xrgb[]  = {
+      0x000000, 0xffffff, 0x3060c0, 0xc03020, 0x20a040, 0x808080 };
+   static const uint16_t rgb565[] = {
+      0x0000, 0xffff, 0x331c, 0xc184, 0x2508, 0x8410 };
+   unsigned x, y;
+
+   for (y = 0; y < height; y++)
+   {
+      uint8_t *row = (uint8_t*)frame + y * pitch;
+      unsigned c   = 0;
+
+      for (x = 0; x < width; x++)
+      {
+         if (!(bench_rand() & 3))
+            c = bench_rand() % 6;
+         if (fmt == SOFTFILTER_FMT_XRGB8888)
+            ((uint32_t*)row)[x] = xrgb[c];
+         else
+            ((uint16_t*)row)[x] = rgb565[c];
+      }
+   }
+}
+
+/* The plain C filter, run on the calling thread */
+struct bench_plain
+{
+   const struct softfilter_implementation *impl;
+   void *data;
+   struct softfilter_work_packet packet;
+};
+
+static bool plain_init(struct bench_plain *plain,
+      softfilter_get_implementation_t get_implementation,
+      unsigned fmt, unsigned width, unsigned height)
+{
+   plain->impl = get_implementation(0);
+   plain->data = plain->impl->create(&bench_config, fmt, fmt,
+         width, height, 1, 0, NULL);
+   return plain->data && plain->impl->query_num_threads(plain->data) == 1;
+}
+
+static void plain_process(struct bench_plain *plain,
+      void *output, size_t output_stride,
+      const void *input, unsigned width, unsigned height,
+      size_t input_stride)
+{
+   plain->impl->get_work_packets(plain->data, &plain->packet,
+         output, output_stride, input, width, height, input_stride);
+   plain->packet.work(plain->data, plain->packet.thread_data);
+}
+
+static bool write_filt(const char *ident)
+{
+   char s[128];
+   snprintf(s, sizeof(s), "filter = \"%s\"\n", ident);
+   return filestream_write_file(BENCH_FILT, s, strlen(s));
+}
+
+static unsigned compare(const void *a, const void *b,
+      unsigned width, unsigned height, size_t pitch, size_t bpp)
+{
+   unsigned y;
+   unsigned errors = 0;
+
+   for (y = 0; y < height; y++)
+      if (memcmp((const uint8_t*)a + y * pitch,
+               (const uint8_t*)b + y * pitch, width * bpp))
+         errors++;
+
+   return errors;
+}
+
+static unsigned run(unsigned f, unsigned width, unsigned height,
+      unsigned fmt, unsigned frames, unsigned threads)
+{
+   unsigned i, t;
+   size_t pitch, out_pitch;
+   double fps[3];
+   unsigned out_width        = 0;
+   unsigned out_height       = 0;
+   unsigned errors           = 0;
+   size_t bpp                = (fmt == SOFTFILTER_FMT_XRGB8888) ? 4 : 2;
+   enum retro_pixel_format pix_fmt = (fmt == SOFTFILTER_FMT_XRGB8888)
+      ? RETRO_PIXEL_FORMAT_XRGB8888 : RETRO_PIXEL_FORMAT_RGB565;
+   uint8_t *in_buf           = NULL;
+   uint8_t *ref              = NULL;
+   uint8_t *out              = NULL;
+   const uint8_t *input      = NULL;
+   struct bench_plain plain  = {0};
+
+   if (!plain_init(&plain, filters[f].get_implementation,
+            fmt, width, height))
+   {
+      fprintf(stderr, "%s: failed to create filter\n", filters[f].ident);
+      return 1;
+   }
+
+   plain.impl->query_output_size(plain.data, &out_width, &out_height,
+         width, height);
+
+   /* Some filters read a pixel or two past the ends of the frame */
+   pitch     = width * bpp;
+   out_pitch = out_width * bpp;
+   in_buf    = (uint8_t*)calloc(height + 4, pitch);
+   ref       = (uint8_t*)calloc(out_height, out_pitch);
+   out       = (uint8_t*)malloc(out_height * out_pitch);
+   input     = in_buf + 2 * pitch;
+
+   fill_frame((void*)input, width, height, pitch, fmt);
+
+   plain_process(&plain, ref, out_pitch, input, width, height, pitch);
+
+   {
+      retro_time_t t0 = cpu_features_get_time_usec();
+      for (i = 0; i < frames; i++)
+         plain_process(&plain, out, out_pitch, input, width, height, pitch);
+      fps[0] = frames / elapsed_sec(t0);
+   }
+
+   for (t = 0; t < 2; t++)
+   {
+      retro_time_t t0;
+      rarch_softfilter_t *filt = rarch_softfilter_new(BENCH_FILT,
+            t ? threads : 1, pix_fmt, width, height);
+
+      if (!filt)
+      {
+         errors++;
+         fps[t + 1] = 0.0;
+         continue;
+      }
+
+      memset(out, 0, out_height * out_pitch);
+      rarch_softfilter_process(filt, out, out_pitch,
+            input, width, height, pitch);
+      errors += compare(ref, out, out_width, out_height, out_pitch, bpp);
+
+      t0 = cpu_features_get_time_usec();
+      for (i = 0; i < frames; i++)
+         rarch_softfilter_process(filt, out, out_pitch,
+               input, width, height, pitch);
+      fps[t + 1] = frames / elapsed_sec(t0);
+
+      rarch_softfilter_free(filt);
+   }
+
+   printf("%-17s %4ux%-4u %-9s %9.1f %9.1f %9.1f\n",
+         filters[f].ident, width, height,
+         fmt == SOFTFILTER_FMT_XRGB8888 ? "XRGB8888" : "RGB565",
+         fps[0], fps[1], fps[2]);
+
+   plain.impl->destroy(plain.data);
+   free(in_buf);
+   free(ref);
+   free(out);
+
+   return errors;
+}
+
+int main(int argc, char *argv[])
+{
+   unsigned f, s;
+   unsigned frames  = 200;
+   unsigned errors  = 0;
+   unsigned threads = cpu_features_get_core_amount();
+
+   if (argc > 1)
+      frames  = (unsigned)strtoul(argv[1], NULL, 0);
+   if (argc > 2)
+      threads = (unsigned)strtoul(argv[2], NULL, 0);
+
+   if (!frames || !threads)
+   {
+      fprintf(stderr, "Usage: %s [frames] [threads]\n", argv[0]);
+      return 1;
+   }
+
+   printf("%u threads, frames per second:\n", threads);
+   printf("%-17s %-9s %-9s %9s %9s %9s\n",
+         "filter", "size", "format", "plain C", "host 1T", "host");
+
+   for (f = 0; f < ARRAY_SIZE(filters); f++)
+   {
+      const struct softfilter_implementation *impl =
+         filters[f].get_implementation(0);
+      unsigned fmts = impl->query_input_formats();
+
+      if (!write_filt(filters[f].ident))
+      {
+         fprintf(stderr, "Failed to write " BENCH_FILT "\n");
+         return 1;
+      }
+
+      for (s = 0; s < ARRAY_SIZE(sizes); s++)
+      {
+         if (fmts & SOFTFILTER_FMT_RGB565)
+            errors += run(f, sizes[s][0], sizes[s][1],
+                  SOFTFILTER_FMT_RGB565, frames, threads);
+         if (fmts & SOFTFILTER_FMT_XRGB8888)
+            errors += run(f, sizes[s][0], sizes[s][1],
+                  SOFTFILTER_FMT_XRGB8888, frames, threads);
+      }
+   }
+
+   filestream_delete(BENCH_FILT);
+
+   if (errors)
+   {
+      fprintf(stderr, "%u errors\n", errors);
+      return 1;
+   }
+
+   return 0;
+}